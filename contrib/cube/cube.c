@@ -1270,11 +1270,32 @@ cube_distance(PG_FUNCTION_ARGS)
 	}
 
 	distance = 0.0;
-	/* compute within the dimensions of (b) */
-	for (i = 0; i < DIM(b); i++)
+
+	/*
+	 * Fast path for two points, which is the common case when cubes are used
+	 * as plain vectors.  This avoids the point check in UR_COORD() and the
+	 * interval logic of distance_1D() for every coordinate.  distance_1D()
+	 * treats NaN coordinates as overlapping, so skip those to give the same
+	 * result.
+	 */
+	if (IS_POINT(a) && IS_POINT(b))
 	{
-		d = distance_1D(LL_COORD(a, i), UR_COORD(a, i), LL_COORD(b, i), UR_COORD(b, i));
-		distance += d * d;
+		for (i = 0; i < DIM(b); i++)
+		{
+			if (unlikely(isnan(a->x[i]) || isnan(b->x[i])))
+				continue;
+			d = a->x[i] - b->x[i];
+			distance += d * d;
+		}
+	}
+	else
+	{
+		/* compute within the dimensions of (b) */
+		for (i = 0; i < DIM(b); i++)
+		{
+			d = distance_1D(LL_COORD(a, i), UR_COORD(a, i), LL_COORD(b, i), UR_COORD(b, i));
+			distance += d * d;
+		}
 	}
 
 	/* compute distance to zero for those dimensions in (a) absent in (b) */
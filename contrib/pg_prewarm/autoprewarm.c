@@ -10,11 +10,18 @@
  *		and we need to lock the relations so that we don't try to prewarm
  *		pages from a relation that is in the process of being dropped.
  *
- *		While prewarming, autoprewarm will use two workers.  There's a
- *		leader worker that reads and sorts the list of blocks to be
- *		prewarmed and then launches a per-database worker for each
- *		relevant database in turn.  The former keeps running after the
- *		initial prewarm is complete to update the dump file periodically.
+ *		While prewarming, there's a leader worker that reads and sorts the
+ *		list of blocks to be prewarmed and then launches per-database
+ *		workers for each relevant database in turn.  The leader keeps
+ *		running after the initial prewarm is complete to update the dump
+ *		file periodically.
+ *
+ *		Each block's usage count is recorded along with it, and blocks are
+ *		reloaded from the most to the least used, so that if the blocks
+ *		don't all fit or prewarming is interrupted, we've at least loaded
+ *		the hottest ones.  pg_prewarm.autoprewarm_workers workers load
+ *		each database's blocks concurrently, taking them in batches from a
+ *		shared position that advances in that order.
  *
  *	Copyright (c) 2016-2024, PostgreSQL Global Development Group
  *
@@ -35,6 +42,7 @@
 #include "pgstat.h"
 #include "postmaster/bgworker.h"
 #include "postmaster/interrupt.h"
+#include "postmaster/postmaster.h"
 #include "storage/buf_internals.h"
 #include "storage/dsm.h"
 #include "storage/dsm_registry.h"
@@ -57,6 +65,9 @@
 
 #define AUTOPREWARM_FILE "autoprewarm.blocks"
 
+/* Number of blocks a per-database worker claims at a time */
+#define AUTOPREWARM_BATCH_SIZE	256
+
 /* Metadata for each block we dump. */
 typedef struct BlockInfoRecord
 {
@@ -65,6 +76,7 @@ typedef struct BlockInfoRecord
 	RelFileNumber filenumber;
 	ForkNumber	forknum;
 	BlockNumber blocknum;
+	uint32		usage_count;
 } BlockInfoRecord;
 
 /* Shared state information for autoprewarm bgworker. */
@@ -79,6 +91,7 @@ typedef struct AutoPrewarmSharedState
 	Oid			database;
 	int			prewarm_start_idx;
 	int			prewarm_stop_idx;
+	int			prewarm_next_idx;	/* next block to be claimed by a worker */
 	int			prewarmed_blocks;
 } AutoPrewarmSharedState;
 
@@ -91,7 +104,7 @@ PG_FUNCTION_INFO_V1(autoprewarm_dump_now);
 static void apw_load_buffers(void);
 static int	apw_dump_now(bool is_bgworker, bool dump_unlogged);
 static void apw_start_leader_worker(void);
-static void apw_start_database_worker(void);
+static void apw_start_database_workers(void);
 static bool apw_init_shmem(void);
 static void apw_detach_shmem(int code, Datum arg);
 static int	apw_compare_blockinfo(const void *p, const void *q);
@@ -102,6 +115,7 @@ static AutoPrewarmSharedState *apw_state = NULL;
 /* GUC variables. */
 static bool autoprewarm = true; /* start worker? */
 static int	autoprewarm_interval = 300; /* dump interval */
+static int	autoprewarm_workers = 1;	/* workers per database */
 
 /*
  * Module load callback.
@@ -121,6 +135,18 @@ _PG_init(void)
 							NULL,
 							NULL);
 
+	DefineCustomIntVariable("pg_prewarm.autoprewarm_workers",
+							"Sets the number of workers that prewarm each database.",
+							NULL,
+							&autoprewarm_workers,
+							1,
+							1, MAX_BACKENDS,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
 	if (!process_shared_preload_libraries_in_progress)
 		return;
 
@@ -329,14 +355,25 @@ apw_load_buffers(void)
 	seg = dsm_create(sizeof(BlockInfoRecord) * num_elements, 0);
 	blkinfo = (BlockInfoRecord *) dsm_segment_address(seg);
 
-	/* Read records, one per line. */
+	/*
+	 * Read records, one per line.  Files written by older versions don't
+	 * have the usage count; treat their blocks as equally hot.
+	 */
 	for (i = 0; i < num_elements; i++)
 	{
+		char		line[128];
 		unsigned	forknum;
+		int			nfields;
 
-		if (fscanf(file, "%u,%u,%u,%u,%u\n", &blkinfo[i].database,
-				   &blkinfo[i].tablespace, &blkinfo[i].filenumber,
-				   &forknum, &blkinfo[i].blocknum) != 5)
+		blkinfo[i].usage_count = 0;
+		if (fgets(line, sizeof(line), file) == NULL)
+			nfields = 0;
+		else
+			nfields = sscanf(line, "%u,%u,%u,%u,%u,%u", &blkinfo[i].database,
+							 &blkinfo[i].tablespace, &blkinfo[i].filenumber,
+							 &forknum, &blkinfo[i].blocknum,
+							 &blkinfo[i].usage_count);
+		if (nfields != 5 && nfields != 6)
 			ereport(ERROR,
 					(errmsg("autoprewarm block dump file is corrupted at line %d",
 							i + 1)));
@@ -406,10 +443,11 @@ apw_load_buffers(void)
 			break;
 
 		/*
-		 * Start a per-database worker to load blocks for this database; this
-		 * function will return once the per-database worker exits.
+		 * Start the per-database workers to load blocks for this database;
+		 * this function will return once they have all exited.
 		 */
-		apw_start_database_worker();
+		apw_state->prewarm_next_idx = apw_state->prewarm_start_idx;
+		apw_start_database_workers();
 
 		/* Prepare for next database. */
 		apw_state->prewarm_start_idx = apw_state->prewarm_stop_idx;
@@ -436,7 +474,9 @@ apw_load_buffers(void)
 void
 autoprewarm_database_main(Datum main_arg)
 {
-	int			pos;
+	int			pos = 0;
+	int			batch_end = 0;
+	int			prewarmed_blocks = 0;
 	BlockInfoRecord *block_info;
 	Relation	rel = NULL;
 	BlockNumber nblocks = 0;
@@ -456,19 +496,34 @@ autoprewarm_database_main(Datum main_arg)
 				 errmsg("could not map dynamic shared memory segment")));
 	BackgroundWorkerInitializeConnectionByOid(apw_state->database, InvalidOid, 0);
 	block_info = (BlockInfoRecord *) dsm_segment_address(seg);
-	pos = apw_state->prewarm_start_idx;
 
 	/*
 	 * Loop until we run out of blocks to prewarm or until we run out of free
-	 * buffers.
+	 * buffers.  Other workers may be prewarming the same database, so claim
+	 * the blocks in batches.  A relation that's still open from the previous
+	 * batch is reused if the next batch continues with it.
 	 */
-	while (pos < apw_state->prewarm_stop_idx && have_free_buffer())
+	while (have_free_buffer())
 	{
-		BlockInfoRecord *blk = &block_info[pos++];
+		BlockInfoRecord *blk;
 		Buffer		buf;
 
 		CHECK_FOR_INTERRUPTS();
 
+		if (pos >= batch_end)
+		{
+			LWLockAcquire(&apw_state->lock, LW_EXCLUSIVE);
+			pos = apw_state->prewarm_next_idx;
+			batch_end = Min(pos + AUTOPREWARM_BATCH_SIZE,
+							apw_state->prewarm_stop_idx);
+			apw_state->prewarm_next_idx = Max(pos, batch_end);
+			LWLockRelease(&apw_state->lock);
+
+			if (pos >= batch_end)
+				break;
+		}
+		blk = &block_info[pos++];
+
 		/*
 		 * Quit if we've reached records for another database. If previous
 		 * blocks are of some global objects, then continue pre-warming.
@@ -543,13 +598,17 @@ autoprewarm_database_main(Datum main_arg)
 								 NULL);
 		if (BufferIsValid(buf))
 		{
-			apw_state->prewarmed_blocks++;
+			prewarmed_blocks++;
 			ReleaseBuffer(buf);
 		}
 
 		old_blk = blk;
 	}
 
+	LWLockAcquire(&apw_state->lock, LW_EXCLUSIVE);
+	apw_state->prewarmed_blocks += prewarmed_blocks;
+	LWLockRelease(&apw_state->lock);
+
 	dsm_detach(seg);
 
 	/* Release lock on previous relation. */
@@ -626,6 +685,8 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 			block_info_array[num_blocks].forknum =
 				BufTagGetForkNum(&bufHdr->tag);
 			block_info_array[num_blocks].blocknum = bufHdr->tag.blockNum;
+			block_info_array[num_blocks].usage_count =
+				BUF_STATE_GET_USAGECOUNT(buf_state);
 			++num_blocks;
 		}
 
@@ -658,12 +719,13 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 	{
 		CHECK_FOR_INTERRUPTS();
 
-		ret = fprintf(file, "%u,%u,%u,%u,%u\n",
+		ret = fprintf(file, "%u,%u,%u,%u,%u,%u\n",
 					  block_info_array[i].database,
 					  block_info_array[i].tablespace,
 					  block_info_array[i].filenumber,
 					  (uint32) block_info_array[i].forknum,
-					  block_info_array[i].blocknum);
+					  block_info_array[i].blocknum,
+					  block_info_array[i].usage_count);
 		if (ret < 0)
 		{
 			int			save_errno = errno;
@@ -842,13 +904,17 @@ apw_start_leader_worker(void)
 }
 
 /*
- * Start autoprewarm per-database worker process.
+ * Start autoprewarm per-database worker processes, and wait for them to exit.
+ *
+ * We start up to pg_prewarm.autoprewarm_workers workers, but carry on with
+ * fewer if we run out of background worker slots after the first one.
  */
 static void
-apw_start_database_worker(void)
+apw_start_database_workers(void)
 {
 	BackgroundWorker worker;
-	BackgroundWorkerHandle *handle;
+	BackgroundWorkerHandle **handles;
+	int			nworkers = 0;
 
 	MemSet(&worker, 0, sizeof(BackgroundWorker));
 	worker.bgw_flags =
@@ -863,17 +929,31 @@ apw_start_database_worker(void)
 	/* must set notify PID to wait for shutdown */
 	worker.bgw_notify_pid = MyProcPid;
 
-	if (!RegisterDynamicBackgroundWorker(&worker, &handle))
-		ereport(ERROR,
-				(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
-				 errmsg("registering dynamic bgworker autoprewarm failed"),
-				 errhint("Consider increasing configuration parameter max_worker_processes.")));
+	handles = palloc(sizeof(BackgroundWorkerHandle *) * autoprewarm_workers);
+	while (nworkers < autoprewarm_workers)
+	{
+		if (!RegisterDynamicBackgroundWorker(&worker, &handles[nworkers]))
+		{
+			if (nworkers == 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+						 errmsg("registering dynamic bgworker autoprewarm failed"),
+						 errhint("Consider increasing configuration parameter max_worker_processes.")));
+			break;
+		}
+		nworkers++;
+	}
 
 	/*
 	 * Ignore return value; if it fails, postmaster has died, but we have
 	 * checks for that elsewhere.
 	 */
-	WaitForBackgroundWorkerShutdown(handle);
+	for (int i = 0; i < nworkers; i++)
+	{
+		WaitForBackgroundWorkerShutdown(handles[i]);
+		pfree(handles[i]);
+	}
+	pfree(handles);
 }
 
 /* Compare member elements to check whether they are not equal. */
@@ -890,9 +970,10 @@ do { \
  *
  * We depend on all records for a particular database being consecutive
  * in the dump file; each per-database worker will preload blocks until
- * it sees a block for some other database.  Sorting by tablespace,
- * filenumber, forknum, and blocknum isn't critical for correctness, but
- * helps us get a sequential I/O pattern.
+ * it sees a block for some other database.  Within a database, the blocks
+ * with the highest usage counts come first, so that they are prewarmed
+ * first.  Sorting by tablespace, filenumber, forknum, and blocknum isn't
+ * critical for correctness, but helps us get a sequential I/O pattern.
  */
 static int
 apw_compare_blockinfo(const void *p, const void *q)
@@ -901,6 +982,8 @@ apw_compare_blockinfo(const void *p, const void *q)
 	const BlockInfoRecord *b = (const BlockInfoRecord *) q;
 
 	cmp_member_elem(database);
+	if (a->usage_count != b->usage_count)
+		return (a->usage_count > b->usage_count) ? -1 : 1;
 	cmp_member_elem(tablespace);
 	cmp_member_elem(filenumber);
 	cmp_member_elem(forknum);
@@ -16,7 +16,8 @@ $node->append_conf(
 	'postgresql.conf',
 	qq{shared_preload_libraries = 'pg_prewarm'
     pg_prewarm.autoprewarm = true
-    pg_prewarm.autoprewarm_interval = 0});
+    pg_prewarm.autoprewarm_interval = 0
+    pg_prewarm.autoprewarm_workers = 2});
 $node->start;
 
 # setup
@@ -0,0 +1,806 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_stat_plans.c
+ *		Track execution statistics of the plans used by each statement.
+ *
+ * pg_stat_statements aggregates executions by query identifier, so a change
+ * in the plan chosen for a statement goes unnoticed until it shows up as a
+ * change in the statement's overall timing.  This module keeps separate
+ * statistics for every plan a statement has been executed with, identified
+ * by a plan identifier computed from the plan tree, together with the
+ * EXPLAIN output of the plan when it was first seen.
+ *
+ * The plan identifier covers the shape of the plan: the types of the plan
+ * nodes and how they are nested, the relations and indexes that are scanned
+ * and the join, aggregation and set operation strategies.  It deliberately
+ * leaves out cost estimates, row counts and expressions, so that plans that
+ * differ only in the values of constants are counted together.
+ *
+ * Only top-level statements are tracked.  When the hash table is full, the
+ * entry that was used least recently is discarded to make room.
+ *
+ * Locking: to create or delete an entry, one must hold pgsp->lock
+ * exclusively.  To look up an entry, one must hold it shared.  The counters
+ * of an entry are protected by its mutex spinlock.
+ *
+ *	Copyright (c) 2024, PostgreSQL Global Development Group
+ *
+ *	IDENTIFICATION
+ *		contrib/pg_stat_plans/pg_stat_plans.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/parallel.h"
+#include "catalog/pg_authid.h"
+#include "commands/explain.h"
+#include "common/hashfn.h"
+#include "executor/executor.h"
+#include "executor/instrument.h"
+#include "funcapi.h"
+#include "mb/pg_wchar.h"
+#include "miscadmin.h"
+#include "nodes/queryjumble.h"
+#include "parser/parsetree.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "tcop/utility.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/timestamp.h"
+
+PG_MODULE_MAGIC;
+
+#define DEALLOC_PERCENT			5	/* free this % of entries at once */
+
+/* Hash table key: one entry per user, database, statement and plan. */
+typedef struct pgspHashKey
+{
+	Oid			userid;			/* user OID */
+	Oid			dbid;			/* database OID */
+	uint64		queryid;		/* query identifier */
+	uint64		planid;			/* plan identifier */
+} pgspHashKey;
+
+/* Statistics of one plan. */
+typedef struct pgspEntry
+{
+	pgspHashKey key;			/* hash key of entry - MUST BE FIRST */
+	slock_t		mutex;			/* protects the counters below */
+	int64		calls;			/* # of times executed */
+	double		total_time;		/* total execution time, in msec */
+	double		min_time;		/* minimum execution time, in msec */
+	double		max_time;		/* maximum execution time, in msec */
+	int64		rows;			/* total # of retrieved or affected rows */
+	TimestampTz first_call;		/* time of first execution */
+	TimestampTz last_call;		/* time of last execution */
+	char		plan[FLEXIBLE_ARRAY_MEMBER];	/* EXPLAIN output, clipped to
+												 * max_plan_length */
+} pgspEntry;
+
+/* Global shared state */
+typedef struct pgspSharedState
+{
+	LWLock	   *lock;			/* protects hashtable search/modification */
+} pgspSharedState;
+
+PG_FUNCTION_INFO_V1(pg_stat_plans);
+PG_FUNCTION_INFO_V1(pg_stat_plans_reset);
+
+/* Current nesting depth of ExecutorRun/ExecutorFinish/ProcessUtility calls */
+static int	nesting_level = 0;
+
+/* Saved hook values in case of unload */
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+static ExecutorStart_hook_type prev_ExecutorStart = NULL;
+static ExecutorRun_hook_type prev_ExecutorRun = NULL;
+static ExecutorFinish_hook_type prev_ExecutorFinish = NULL;
+static ExecutorEnd_hook_type prev_ExecutorEnd = NULL;
+static ProcessUtility_hook_type prev_ProcessUtility = NULL;
+
+/* Links to shared memory state */
+static pgspSharedState *pgsp = NULL;
+static HTAB *pgsp_hash = NULL;
+
+/* GUC variables */
+static int	pgsp_max = 1000;	/* max # plans to track */
+static int	pgsp_max_plan_length = 2048;	/* max bytes of plan text kept */
+static bool pgsp_enabled = true;	/* whether to track plans */
+
+/* Track top-level statements only, and none in parallel workers */
+#define pgsp_tracking() \
+	(pgsp_enabled && nesting_level == 0 && !IsParallelWorker())
+
+static void pgsp_shmem_request(void);
+static void pgsp_shmem_startup(void);
+static Size pgsp_entry_size(void);
+static void pgsp_ExecutorStart(QueryDesc *queryDesc, int eflags);
+static void pgsp_ExecutorRun(QueryDesc *queryDesc, ScanDirection direction,
+							 uint64 count, bool execute_once);
+static void pgsp_ExecutorFinish(QueryDesc *queryDesc);
+static void pgsp_ExecutorEnd(QueryDesc *queryDesc);
+static void pgsp_ProcessUtility(PlannedStmt *pstmt, const char *queryString,
+								bool readOnlyTree,
+								ProcessUtilityContext context,
+								ParamListInfo params, QueryEnvironment *queryEnv,
+								DestReceiver *dest, QueryCompletion *qc);
+static uint64 pgsp_plan_id(PlannedStmt *stmt);
+static uint64 pgsp_hash_plan(Plan *plan, List *rtable, uint64 hash);
+static char *pgsp_explain_plan(QueryDesc *queryDesc);
+static void pgsp_store(QueryDesc *queryDesc, double total_time, uint64 rows);
+static pgspEntry *pgsp_entry_alloc(pgspHashKey *key, const char *plan);
+static void pgsp_entry_dealloc(void);
+
+/*
+ * Module load callback
+ */
+void
+_PG_init(void)
+{
+	/*
+	 * We can only set up the shared memory and the hooks when loaded via
+	 * shared_preload_libraries.
+	 */
+	if (!process_shared_preload_libraries_in_progress)
+		return;
+
+	/* Plans are recorded per query identifier. */
+	EnableQueryId();
+
+	DefineCustomIntVariable("pg_stat_plans.max",
+							"Sets the maximum number of plans tracked by pg_stat_plans.",
+							NULL,
+							&pgsp_max,
+							1000,
+							100,
+							INT_MAX / 2,
+							PGC_POSTMASTER,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("pg_stat_plans.max_plan_length",
+							"Sets the maximum length of the plan text kept by pg_stat_plans.",
+							NULL,
+							&pgsp_max_plan_length,
+							2048,
+							0,
+							1024 * 1024,
+							PGC_POSTMASTER,
+							GUC_UNIT_BYTE,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable("pg_stat_plans.enabled",
+							 "Selects whether plans are tracked by pg_stat_plans.",
+							 NULL,
+							 &pgsp_enabled,
+							 true,
+							 PGC_SUSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	MarkGUCPrefixReserved("pg_stat_plans");
+
+	/*
+	 * Install hooks.
+	 */
+	prev_shmem_request_hook = shmem_request_hook;
+	shmem_request_hook = pgsp_shmem_request;
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = pgsp_shmem_startup;
+	prev_ExecutorStart = ExecutorStart_hook;
+	ExecutorStart_hook = pgsp_ExecutorStart;
+	prev_ExecutorRun = ExecutorRun_hook;
+	ExecutorRun_hook = pgsp_ExecutorRun;
+	prev_ExecutorFinish = ExecutorFinish_hook;
+	ExecutorFinish_hook = pgsp_ExecutorFinish;
+	prev_ExecutorEnd = ExecutorEnd_hook;
+	ExecutorEnd_hook = pgsp_ExecutorEnd;
+	prev_ProcessUtility = ProcessUtility_hook;
+	ProcessUtility_hook = pgsp_ProcessUtility;
+}
+
+/*
+ * Size of one hash table entry, including room for the plan text.
+ */
+static Size
+pgsp_entry_size(void)
+{
+	return MAXALIGN(add_size(offsetof(pgspEntry, plan),
+							 pgsp_max_plan_length + 1));
+}
+
+/*
+ * shmem_request hook: request additional shared resources.  We'll allocate or
+ * attach to the shared resources in pgsp_shmem_startup().
+ */
+static void
+pgsp_shmem_request(void)
+{
+	if (prev_shmem_request_hook)
+		prev_shmem_request_hook();
+
+	RequestAddinShmemSpace(add_size(MAXALIGN(sizeof(pgspSharedState)),
+									hash_estimate_size(pgsp_max,
+													   pgsp_entry_size())));
+	RequestNamedLWLockTranche("pg_stat_plans", 1);
+}
+
+/*
+ * shmem_startup hook: allocate or attach to shared memory.
+ */
+static void
+pgsp_shmem_startup(void)
+{
+	bool		found;
+	HASHCTL		info;
+
+	if (prev_shmem_startup_hook)
+		prev_shmem_startup_hook();
+
+	/* reset in case this is a restart within the postmaster */
+	pgsp = NULL;
+	pgsp_hash = NULL;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	pgsp = ShmemInitStruct("pg_stat_plans", sizeof(pgspSharedState), &found);
+	if (!found)
+		pgsp->lock = &(GetNamedLWLockTranche("pg_stat_plans"))->lock;
+
+	info.keysize = sizeof(pgspHashKey);
+	info.entrysize = pgsp_entry_size();
+	pgsp_hash = ShmemInitHash("pg_stat_plans hash",
+							  pgsp_max, pgsp_max,
+							  &info,
+							  HASH_ELEM | HASH_BLOBS);
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+/*
+ * ExecutorStart hook: set up to track the execution time
+ */
+static void
+pgsp_ExecutorStart(QueryDesc *queryDesc, int eflags)
+{
+	if (prev_ExecutorStart)
+		prev_ExecutorStart(queryDesc, eflags);
+	else
+		standard_ExecutorStart(queryDesc, eflags);
+
+	if (pgsp_tracking() &&
+		queryDesc->plannedstmt->queryId != UINT64CONST(0) &&
+		(eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+	{
+		/*
+		 * Set up to track total elapsed time in ExecutorRun.  The structure
+		 * may be shared with other modules, such as pg_stat_statements, so
+		 * ask for all the instrumentation any of them might want.
+		 */
+		if (queryDesc->totaltime == NULL)
+		{
+			MemoryContext oldcxt;
+
+			oldcxt = MemoryContextSwitchTo(queryDesc->estate->es_query_cxt);
+			queryDesc->totaltime = InstrAlloc(1, INSTRUMENT_ALL, false);
+			MemoryContextSwitchTo(oldcxt);
+		}
+	}
+}
+
+/*
+ * ExecutorRun hook: all we need do is track nesting depth
+ */
+static void
+pgsp_ExecutorRun(QueryDesc *queryDesc, ScanDirection direction, uint64 count,
+				 bool execute_once)
+{
+	nesting_level++;
+	PG_TRY();
+	{
+		if (prev_ExecutorRun)
+			prev_ExecutorRun(queryDesc, direction, count, execute_once);
+		else
+			standard_ExecutorRun(queryDesc, direction, count, execute_once);
+	}
+	PG_FINALLY();
+	{
+		nesting_level--;
+	}
+	PG_END_TRY();
+}
+
+/*
+ * ExecutorFinish hook: all we need do is track nesting depth
+ */
+static void
+pgsp_ExecutorFinish(QueryDesc *queryDesc)
+{
+	nesting_level++;
+	PG_TRY();
+	{
+		if (prev_ExecutorFinish)
+			prev_ExecutorFinish(queryDesc);
+		else
+			standard_ExecutorFinish(queryDesc);
+	}
+	PG_FINALLY();
+	{
+		nesting_level--;
+	}
+	PG_END_TRY();
+}
+
+/*
+ * ExecutorEnd hook: store results if needed
+ */
+static void
+pgsp_ExecutorEnd(QueryDesc *queryDesc)
+{
+	if (pgsp_tracking() && pgsp &&
+		queryDesc->plannedstmt->queryId != UINT64CONST(0) &&
+		queryDesc->totaltime && queryDesc->planstate)
+	{
+		/*
+		 * Make sure stats accumulation is done.  (Note: it's okay if several
+		 * levels of hook all do this.)
+		 */
+		InstrEndLoop(queryDesc->totaltime);
+
+		pgsp_store(queryDesc,
+				   queryDesc->totaltime->total * 1000.0,	/* convert to msec */
+				   queryDesc->estate->es_total_processed);
+	}
+
+	if (prev_ExecutorEnd)
+		prev_ExecutorEnd(queryDesc);
+	else
+		standard_ExecutorEnd(queryDesc);
+}
+
+/*
+ * ProcessUtility hook: all we need do is track nesting depth, so that
+ * statements run by utility commands, e.g. in procedures, aren't counted as
+ * top-level statements.
+ */
+static void
+pgsp_ProcessUtility(PlannedStmt *pstmt, const char *queryString,
+					bool readOnlyTree,
+					ProcessUtilityContext context,
+					ParamListInfo params, QueryEnvironment *queryEnv,
+					DestReceiver *dest, QueryCompletion *qc)
+{
+	nesting_level++;
+	PG_TRY();
+	{
+		if (prev_ProcessUtility)
+			prev_ProcessUtility(pstmt, queryString, readOnlyTree,
+								context, params, queryEnv,
+								dest, qc);
+		else
+			standard_ProcessUtility(pstmt, queryString, readOnlyTree,
+									context, params, queryEnv,
+									dest, qc);
+	}
+	PG_FINALLY();
+	{
+		nesting_level--;
+	}
+	PG_END_TRY();
+}
+
+/*
+ * Compute the plan identifier of a planned statement.
+ */
+static uint64
+pgsp_plan_id(PlannedStmt *stmt)
+{
+	uint64		hash = 0;
+	ListCell   *lc;
+
+	hash = pgsp_hash_plan(stmt->planTree, stmt->rtable, hash);
+	foreach(lc, stmt->subplans)
+		hash = pgsp_hash_plan((Plan *) lfirst(lc), stmt->rtable, hash);
+
+	return hash;
+}
+
+/* Mix one more value into a plan identifier. */
+#define PGSP_HASH(hash, value) \
+	((hash) = hash_bytes_uint32_extended((uint32) (value), (hash)))
+
+/*
+ * Add the shape of a plan tree to a plan identifier.
+ */
+static uint64
+pgsp_hash_plan(Plan *plan, List *rtable, uint64 hash)
+{
+	Index		scanrelid = 0;
+	ListCell   *lc;
+
+	/* Subplans that were removed by setrefs.c are NULL */
+	if (plan == NULL)
+		return PGSP_HASH(hash, T_Invalid);
+
+	/* Guard against stack overflow due to overly complex plans */
+	check_stack_depth();
+
+	PGSP_HASH(hash, nodeTag(plan));
+
+	switch (nodeTag(plan))
+	{
+		case T_SeqScan:
+		case T_SampleScan:
+		case T_BitmapHeapScan:
+		case T_TidScan:
+		case T_TidRangeScan:
+		case T_ForeignScan:
+		case T_CustomScan:
+			scanrelid = ((Scan *) plan)->scanrelid;
+			break;
+		case T_IndexScan:
+			scanrelid = ((Scan *) plan)->scanrelid;
+			PGSP_HASH(hash, ((IndexScan *) plan)->indexid);
+			break;
+		case T_IndexOnlyScan:
+			scanrelid = ((Scan *) plan)->scanrelid;
+			PGSP_HASH(hash, ((IndexOnlyScan *) plan)->indexid);
+			break;
+		case T_BitmapIndexScan:
+			PGSP_HASH(hash, ((BitmapIndexScan *) plan)->indexid);
+			break;
+		case T_NestLoop:
+		case T_MergeJoin:
+		case T_HashJoin:
+			PGSP_HASH(hash, ((Join *) plan)->jointype);
+			break;
+		case T_Agg:
+			PGSP_HASH(hash, ((Agg *) plan)->aggstrategy);
+			break;
+		case T_SetOp:
+			PGSP_HASH(hash, ((SetOp *) plan)->strategy);
+			break;
+		case T_ModifyTable:
+			PGSP_HASH(hash, ((ModifyTable *) plan)->operation);
+			break;
+		default:
+			break;
+	}
+
+	if (scanrelid > 0)
+	{
+		RangeTblEntry *rte = rt_fetch(scanrelid, rtable);
+
+		if (rte->rtekind == RTE_RELATION)
+			PGSP_HASH(hash, rte->relid);
+	}
+
+	/* Now the children */
+	hash = pgsp_hash_plan(plan->lefttree, rtable, hash);
+	hash = pgsp_hash_plan(plan->righttree, rtable, hash);
+
+	switch (nodeTag(plan))
+	{
+		case T_Append:
+			foreach(lc, ((Append *) plan)->appendplans)
+				hash = pgsp_hash_plan((Plan *) lfirst(lc), rtable, hash);
+			break;
+		case T_MergeAppend:
+			foreach(lc, ((MergeAppend *) plan)->mergeplans)
+				hash = pgsp_hash_plan((Plan *) lfirst(lc), rtable, hash);
+			break;
+		case T_BitmapAnd:
+			foreach(lc, ((BitmapAnd *) plan)->bitmapplans)
+				hash = pgsp_hash_plan((Plan *) lfirst(lc), rtable, hash);
+			break;
+		case T_BitmapOr:
+			foreach(lc, ((BitmapOr *) plan)->bitmapplans)
+				hash = pgsp_hash_plan((Plan *) lfirst(lc), rtable, hash);
+			break;
+		case T_SubqueryScan:
+			hash = pgsp_hash_plan(((SubqueryScan *) plan)->subplan,
+								  rtable, hash);
+			break;
+		case T_CustomScan:
+			foreach(lc, ((CustomScan *) plan)->custom_plans)
+				hash = pgsp_hash_plan((Plan *) lfirst(lc), rtable, hash);
+			break;
+		default:
+			break;
+	}
+
+	/* Mark the end of the children, so that nesting counts */
+	return PGSP_HASH(hash, T_Invalid);
+}
+
+/*
+ * Produce the EXPLAIN output for a plan, clipped to max_plan_length.
+ */
+static char *
+pgsp_explain_plan(QueryDesc *queryDesc)
+{
+	ExplainState *es = NewExplainState();
+	int			len;
+
+	es->costs = false;
+	es->format = EXPLAIN_FORMAT_TEXT;
+
+	ExplainBeginOutput(es);
+	ExplainPrintPlan(es, queryDesc);
+	ExplainEndOutput(es);
+
+	/* Remove last line break */
+	if (es->str->len > 0 && es->str->data[es->str->len - 1] == '\n')
+		es->str->data[--es->str->len] = '\0';
+
+	len = pg_mbcliplen(es->str->data, es->str->len, pgsp_max_plan_length);
+	es->str->data[len] = '\0';
+
+	return es->str->data;
+}
+
+/*
+ * Count one execution of a plan.
+ */
+static void
+pgsp_store(QueryDesc *queryDesc, double total_time, uint64 rows)
+{
+	pgspHashKey key;
+	pgspEntry  *entry;
+	char	   *plan = NULL;
+	TimestampTz now = GetCurrentTimestamp();
+
+	/* clear padding */
+	memset(&key, 0, sizeof(pgspHashKey));
+
+	key.userid = GetUserId();
+	key.dbid = MyDatabaseId;
+	key.queryid = queryDesc->plannedstmt->queryId;
+	key.planid = pgsp_plan_id(queryDesc->plannedstmt);
+
+	/* Lookup the hash table entry with shared lock. */
+	LWLockAcquire(pgsp->lock, LW_SHARED);
+
+	entry = (pgspEntry *) hash_search(pgsp_hash, &key, HASH_FIND, NULL);
+
+	/* Create new entry, if not present */
+	if (!entry)
+	{
+		/* Run EXPLAIN before taking the exclusive lock */
+		LWLockRelease(pgsp->lock);
+		plan = pgsp_explain_plan(queryDesc);
+		LWLockAcquire(pgsp->lock, LW_EXCLUSIVE);
+
+		entry = pgsp_entry_alloc(&key, plan);
+	}
+
+	SpinLockAcquire(&entry->mutex);
+	if (entry->calls == 0)
+	{
+		entry->min_time = total_time;
+		entry->max_time = total_time;
+		entry->first_call = now;
+	}
+	else
+	{
+		if (entry->min_time > total_time)
+			entry->min_time = total_time;
+		if (entry->max_time < total_time)
+			entry->max_time = total_time;
+	}
+	entry->calls++;
+	entry->total_time += total_time;
+	entry->rows += rows;
+	entry->last_call = now;
+	SpinLockRelease(&entry->mutex);
+
+	LWLockRelease(pgsp->lock);
+
+	if (plan)
+		pfree(plan);
+}
+
+/*
+ * Allocate a new hashtable entry, discarding the least recently used ones if
+ * the table is full.
+ *
+ * Caller must hold an exclusive lock on pgsp->lock.
+ */
+static pgspEntry *
+pgsp_entry_alloc(pgspHashKey *key, const char *plan)
+{
+	pgspEntry  *entry;
+	bool		found;
+
+	if (hash_get_num_entries(pgsp_hash) >= pgsp_max &&
+		hash_search(pgsp_hash, key, HASH_FIND, NULL) == NULL)
+		pgsp_entry_dealloc();
+
+	/* Find or create an entry with desired hash code */
+	entry = (pgspEntry *) hash_search(pgsp_hash, key, HASH_ENTER, &found);
+
+	if (!found)
+	{
+		/* New entry, initialize it */
+		SpinLockInit(&entry->mutex);
+		entry->calls = 0;
+		entry->total_time = 0;
+		entry->min_time = 0;
+		entry->max_time = 0;
+		entry->rows = 0;
+		entry->first_call = 0;
+		entry->last_call = 0;
+		strlcpy(entry->plan, plan, pgsp_max_plan_length + 1);
+	}
+
+	return entry;
+}
+
+/*
+ * qsort comparator for sorting into increasing last_call order
+ */
+static int
+pgsp_entry_cmp(const void *lhs, const void *rhs)
+{
+	TimestampTz l_last = (*(pgspEntry *const *) lhs)->last_call;
+	TimestampTz r_last = (*(pgspEntry *const *) rhs)->last_call;
+
+	if (l_last < r_last)
+		return -1;
+	else if (l_last > r_last)
+		return +1;
+	else
+		return 0;
+}
+
+/*
+ * Deallocate the least recently used entries.  A batch of them is freed at
+ * once, so that a workload with more plans than pg_stat_plans.max doesn't
+ * have to scan the whole table for every new entry.
+ *
+ * Caller must hold an exclusive lock on pgsp->lock.
+ */
+static void
+pgsp_entry_dealloc(void)
+{
+	HASH_SEQ_STATUS hash_seq;
+	pgspEntry **entries;
+	pgspEntry  *entry;
+	int			nvictims;
+	int			i;
+
+	entries = palloc(hash_get_num_entries(pgsp_hash) * sizeof(pgspEntry *));
+
+	i = 0;
+	hash_seq_init(&hash_seq, pgsp_hash);
+	while ((entry = hash_seq_search(&hash_seq)) != NULL)
+		entries[i++] = entry;
+
+	/* Sort into increasing order by time of last execution */
+	qsort(entries, i, sizeof(pgspEntry *), pgsp_entry_cmp);
+
+	/* Now zap an appropriate fraction of least recently used entries */
+	nvictims = Max(10, i * DEALLOC_PERCENT / 100);
+	nvictims = Min(nvictims, i);
+
+	for (i = 0; i < nvictims; i++)
+		hash_search(pgsp_hash, &entries[i]->key, HASH_REMOVE, NULL);
+
+	pfree(entries);
+}
+
+/*
+ * Return the statistics of all tracked plans.
+ */
+Datum
+pg_stat_plans(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_PLANS_COLS	13
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	Oid			userid = GetUserId();
+	bool		is_allowed_role;
+	HASH_SEQ_STATUS hash_seq;
+	pgspEntry  *entry;
+
+	/*
+	 * Superusers or roles with the privileges of pg_read_all_stats members
+	 * are allowed to see the plans of other users' statements.
+	 */
+	is_allowed_role = has_privs_of_role(userid, ROLE_PG_READ_ALL_STATS);
+
+	if (!pgsp || !pgsp_hash)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_stat_plans must be loaded via \"shared_preload_libraries\"")));
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	LWLockAcquire(pgsp->lock, LW_SHARED);
+
+	hash_seq_init(&hash_seq, pgsp_hash);
+	while ((entry = hash_seq_search(&hash_seq)) != NULL)
+	{
+		Datum		values[PG_STAT_PLANS_COLS] = {0};
+		bool		nulls[PG_STAT_PLANS_COLS] = {0};
+		int64		calls;
+		double		total_time;
+		double		min_time;
+		double		max_time;
+		int64		rows;
+		TimestampTz first_call;
+		TimestampTz last_call;
+		int			i = 0;
+
+		SpinLockAcquire(&entry->mutex);
+		calls = entry->calls;
+		total_time = entry->total_time;
+		min_time = entry->min_time;
+		max_time = entry->max_time;
+		rows = entry->rows;
+		first_call = entry->first_call;
+		last_call = entry->last_call;
+		SpinLockRelease(&entry->mutex);
+
+		values[i++] = ObjectIdGetDatum(entry->key.userid);
+		values[i++] = ObjectIdGetDatum(entry->key.dbid);
+		values[i++] = Int64GetDatumFast((int64) entry->key.queryid);
+		values[i++] = Int64GetDatumFast((int64) entry->key.planid);
+		values[i++] = Int64GetDatumFast(calls);
+		values[i++] = Float8GetDatumFast(total_time);
+		values[i++] = Float8GetDatumFast(min_time);
+		values[i++] = Float8GetDatumFast(max_time);
+		values[i++] = Float8GetDatumFast(calls > 0 ? total_time / calls : 0);
+		values[i++] = Int64GetDatumFast(rows);
+		values[i++] = TimestampTzGetDatum(first_call);
+		values[i++] = TimestampTzGetDatum(last_call);
+		if (is_allowed_role || entry->key.userid == userid)
+			values[i++] = CStringGetTextDatum(entry->plan);
+		else
+			values[i++] = CStringGetTextDatum("<insufficient privilege>");
+
+		Assert(i == PG_STAT_PLANS_COLS);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	LWLockRelease(pgsp->lock);
+
+	return (Datum) 0;
+}
+
+/*
+ * Discard the statistics of all plans.
+ */
+Datum
+pg_stat_plans_reset(PG_FUNCTION_ARGS)
+{
+	HASH_SEQ_STATUS hash_seq;
+	pgspEntry  *entry;
+
+	if (!pgsp || !pgsp_hash)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_stat_plans must be loaded via \"shared_preload_libraries\"")));
+
+	LWLockAcquire(pgsp->lock, LW_EXCLUSIVE);
+
+	hash_seq_init(&hash_seq, pgsp_hash);
+	while ((entry = hash_seq_search(&hash_seq)) != NULL)
+		hash_search(pgsp_hash, &entry->key, HASH_REMOVE, NULL);
+
+	LWLockRelease(pgsp->lock);
+
+	PG_RETURN_VOID();
+}
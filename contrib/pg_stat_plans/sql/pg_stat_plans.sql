@@ -0,0 +1,37 @@
+CREATE EXTENSION pg_stat_plans;
+
+CREATE TABLE plan_test (a int PRIMARY KEY, b text);
+INSERT INTO plan_test SELECT g, 'row ' || g FROM generate_series(1, 1000) g;
+ANALYZE plan_test;
+SELECT pg_stat_plans_reset();
+
+-- The same statement run with two different plans gets two entries
+SET enable_indexscan = off;
+SET enable_bitmapscan = off;
+SELECT b FROM plan_test WHERE a = 42;
+SELECT b FROM plan_test WHERE a = 43;
+RESET enable_indexscan;
+RESET enable_bitmapscan;
+SELECT b FROM plan_test WHERE a = 44;
+
+SELECT calls, rows, split_part(plan, E'\n', 1) AS plan FROM pg_stat_plans
+  WHERE plan ~ '^(Index|Seq) Scan' ORDER BY plan COLLATE "C";
+SELECT count(DISTINCT queryid) AS queries, count(DISTINCT planid) AS plans
+  FROM pg_stat_plans WHERE plan ~ '^(Index|Seq) Scan';
+
+-- Parallel workers don't count executions of their own
+SELECT pg_stat_plans_reset();
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+SELECT count(*) FROM plan_test;
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+
+SELECT calls, rows FROM pg_stat_plans WHERE plan ~ 'on plan_test';
+
+DROP TABLE plan_test;
+DROP EXTENSION pg_stat_plans;
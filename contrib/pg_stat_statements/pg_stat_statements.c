@@ -33,6 +33,13 @@
  * requires holding pgss->lock exclusively; this allows individual entries
  * in the file to be read or written while holding only shared lock.
  *
+ * If pg_stat_statements.flush_interval is set, each backend accumulates the
+ * counters of statements executed again within the interval in a local hash
+ * table, which is added to the shared entries once the interval has passed,
+ * or when the backend goes idle.
+ * That saves taking the lock and spinlock for every execution of a popular
+ * statement, at the cost of other sessions seeing the statistics late.
+ *
  *
  * Copyright (c) 2008-2024, PostgreSQL Global Development Group
  *
@@ -48,6 +55,7 @@
 #include <unistd.h>
 
 #include "access/parallel.h"
+#include "access/xact.h"
 #include "catalog/pg_authid.h"
 #include "common/hashfn.h"
 #include "common/int.h"
@@ -249,6 +257,17 @@ typedef struct pgssSharedState
 	pgssGlobalStats stats;		/* global statistics for pgss */
 } pgssSharedState;
 
+/*
+ * Statistics accumulated by this backend but not yet added to the shared
+ * entry, when pg_stat_statements.flush_interval is set.  Having one of these
+ * means the shared entry existed when the current flush cycle started.
+ */
+typedef struct pgssPendingEntry
+{
+	pgssHashKey key;			/* hash key of entry - MUST BE FIRST */
+	Counters	counters;		/* the statistics not yet flushed */
+} pgssPendingEntry;
+
 /*---- Local variables ----*/
 
 /* Current nesting depth of planner/ExecutorRun/ProcessUtility calls */
@@ -264,11 +283,16 @@ static ExecutorRun_hook_type prev_ExecutorRun = NULL;
 static ExecutorFinish_hook_type prev_ExecutorFinish = NULL;
 static ExecutorEnd_hook_type prev_ExecutorEnd = NULL;
 static ProcessUtility_hook_type prev_ProcessUtility = NULL;
+static pgstat_report_stat_hook_type prev_pgstat_report_stat = NULL;
 
 /* Links to shared memory state */
 static pgssSharedState *pgss = NULL;
 static HTAB *pgss_hash = NULL;
 
+/* Backend-local statistics waiting to be flushed, and last flush time */
+static HTAB *pgss_pending_hash = NULL;
+static TimestampTz pgss_last_flush = 0;
+
 /*---- GUC variables ----*/
 
 typedef enum
@@ -292,6 +316,8 @@ static bool pgss_track_utility = true;	/* whether to track utility commands */
 static bool pgss_track_planning = false;	/* whether to track planning
 											 * duration */
 static bool pgss_save = true;	/* whether to save stats across shutdown */
+static int	pgss_flush_interval = 0;	/* how long to batch counter updates,
+										 * in ms */
 
 
 #define pgss_enabled(level) \
@@ -349,6 +375,16 @@ static void pgss_store(const char *query, uint64 queryId,
 					   const WalUsage *walusage,
 					   const struct JitInstrumentation *jitusage,
 					   JumbleState *jstate);
+static void pgss_accum_counters(Counters *c, pgssStoreKind kind,
+								double total_time, uint64 rows,
+								const BufferUsage *bufusage,
+								const WalUsage *walusage,
+								const struct JitInstrumentation *jitusage);
+static void pgss_merge_counters(Counters *dst, const Counters *src);
+static void pgss_create_pending_hash(void);
+static void pgss_flush_pending(bool force);
+static void pgss_flush_at_exit(int code, Datum arg);
+static long pgss_report_stat(bool force);
 static void pg_stat_statements_internal(FunctionCallInfo fcinfo,
 										pgssVersion api_version,
 										bool showtext);
@@ -455,6 +491,19 @@ _PG_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomIntVariable("pg_stat_statements.flush_interval",
+							"Sets how long each backend accumulates statistics before adding them to pg_stat_statements.",
+							"Zero updates the shared statistics after every statement.",
+							&pgss_flush_interval,
+							0,
+							0,
+							60 * 1000,
+							PGC_SUSET,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
 	MarkGUCPrefixReserved("pg_stat_statements");
 
 	/*
@@ -478,6 +527,8 @@ _PG_init(void)
 	ExecutorEnd_hook = pgss_ExecutorEnd;
 	prev_ProcessUtility = ProcessUtility_hook;
 	ProcessUtility_hook = pgss_ProcessUtility;
+	prev_pgstat_report_stat = pgstat_report_stat_hook;
+	pgstat_report_stat_hook = pgss_report_stat;
 }
 
 /*
@@ -1315,6 +1366,25 @@ pgss_store(const char *query, uint64 queryId,
 	key.queryid = queryId;
 	key.toplevel = (nesting_level == 0);
 
+	/*
+	 * If we already know in this flush cycle that the entry exists, just add
+	 * to the local counters; no need to touch shared memory at all.
+	 */
+	if (!jstate && pgss_pending_hash != NULL)
+	{
+		pgssPendingEntry *pending;
+
+		pending = (pgssPendingEntry *) hash_search(pgss_pending_hash, &key,
+												   HASH_FIND, NULL);
+		if (pending)
+		{
+			pgss_accum_counters(&pending->counters, kind, total_time, rows,
+								bufusage, walusage, jitusage);
+			pgss_flush_pending(false);
+			return;
+		}
+	}
+
 	/* Lookup the hash table entry with shared lock. */
 	LWLockAcquire(pgss->lock, LW_SHARED);
 
@@ -1390,108 +1460,352 @@ pgss_store(const char *query, uint64 queryId,
 		 * Grab the spinlock while updating the counters (see comment about
 		 * locking rules at the head of the file)
 		 */
-		volatile pgssEntry *e = (volatile pgssEntry *) entry;
-
 		Assert(kind == PGSS_PLAN || kind == PGSS_EXEC);
 
-		SpinLockAcquire(&e->mutex);
+		SpinLockAcquire(&entry->mutex);
 
 		/* "Unstick" entry if it was previously sticky */
-		if (IS_STICKY(e->counters))
-			e->counters.usage = USAGE_INIT;
+		if (IS_STICKY(entry->counters))
+			entry->counters.usage = USAGE_INIT;
 
-		e->counters.calls[kind] += 1;
-		e->counters.total_time[kind] += total_time;
+		pgss_accum_counters(&entry->counters, kind, total_time, rows,
+							bufusage, walusage, jitusage);
 
-		if (e->counters.calls[kind] == 1)
+		SpinLockRelease(&entry->mutex);
+
+		/*
+		 * Now that we know the entry exists, accumulate further executions
+		 * locally until the next flush, if asked to.
+		 */
+		if (pgss_flush_interval > 0)
 		{
-			e->counters.min_time[kind] = total_time;
-			e->counters.max_time[kind] = total_time;
-			e->counters.mean_time[kind] = total_time;
+			pgssPendingEntry *pending;
+			bool		found;
+
+			if (pgss_pending_hash == NULL)
+				pgss_create_pending_hash();
+
+			pending = (pgssPendingEntry *) hash_search(pgss_pending_hash, &key,
+													   HASH_ENTER, &found);
+			if (!found)
+				memset(&pending->counters, 0, sizeof(Counters));
+		}
+	}
+
+done:
+	LWLockRelease(pgss->lock);
+
+	/* We postpone this clean-up until we're out of the lock */
+	if (norm_query)
+		pfree(norm_query);
+
+	pgss_flush_pending(false);
+}
+
+/*
+ * Add the statistics of one execution to a set of counters.
+ */
+static void
+pgss_accum_counters(Counters *c, pgssStoreKind kind,
+					double total_time, uint64 rows,
+					const BufferUsage *bufusage,
+					const WalUsage *walusage,
+					const struct JitInstrumentation *jitusage)
+{
+	c->calls[kind] += 1;
+	c->total_time[kind] += total_time;
+
+	if (c->calls[kind] == 1)
+	{
+		c->min_time[kind] = total_time;
+		c->max_time[kind] = total_time;
+		c->mean_time[kind] = total_time;
+	}
+	else
+	{
+		/*
+		 * Welford's method for accurately computing variance. See
+		 * <http://www.johndcook.com/blog/standard_deviation/>
+		 */
+		double		old_mean = c->mean_time[kind];
+
+		c->mean_time[kind] +=
+			(total_time - old_mean) / c->calls[kind];
+		c->sum_var_time[kind] +=
+			(total_time - old_mean) * (total_time - c->mean_time[kind]);
+
+		/*
+		 * Calculate min and max time. min = 0 and max = 0 means that the
+		 * min/max statistics were reset
+		 */
+		if (c->min_time[kind] == 0
+			&& c->max_time[kind] == 0)
+		{
+			c->min_time[kind] = total_time;
+			c->max_time[kind] = total_time;
 		}
 		else
 		{
-			/*
-			 * Welford's method for accurately computing variance. See
-			 * <http://www.johndcook.com/blog/standard_deviation/>
-			 */
-			double		old_mean = e->counters.mean_time[kind];
+			if (c->min_time[kind] > total_time)
+				c->min_time[kind] = total_time;
+			if (c->max_time[kind] < total_time)
+				c->max_time[kind] = total_time;
+		}
+	}
+	c->rows += rows;
+	c->shared_blks_hit += bufusage->shared_blks_hit;
+	c->shared_blks_read += bufusage->shared_blks_read;
+	c->shared_blks_dirtied += bufusage->shared_blks_dirtied;
+	c->shared_blks_written += bufusage->shared_blks_written;
+	c->local_blks_hit += bufusage->local_blks_hit;
+	c->local_blks_read += bufusage->local_blks_read;
+	c->local_blks_dirtied += bufusage->local_blks_dirtied;
+	c->local_blks_written += bufusage->local_blks_written;
+	c->temp_blks_read += bufusage->temp_blks_read;
+	c->temp_blks_written += bufusage->temp_blks_written;
+	c->shared_blk_read_time += INSTR_TIME_GET_MILLISEC(bufusage->shared_blk_read_time);
+	c->shared_blk_write_time += INSTR_TIME_GET_MILLISEC(bufusage->shared_blk_write_time);
+	c->local_blk_read_time += INSTR_TIME_GET_MILLISEC(bufusage->local_blk_read_time);
+	c->local_blk_write_time += INSTR_TIME_GET_MILLISEC(bufusage->local_blk_write_time);
+	c->temp_blk_read_time += INSTR_TIME_GET_MILLISEC(bufusage->temp_blk_read_time);
+	c->temp_blk_write_time += INSTR_TIME_GET_MILLISEC(bufusage->temp_blk_write_time);
+	c->usage += USAGE_EXEC(total_time);
+	c->wal_records += walusage->wal_records;
+	c->wal_fpi += walusage->wal_fpi;
+	c->wal_bytes += walusage->wal_bytes;
+	if (jitusage)
+	{
+		c->jit_functions += jitusage->created_functions;
+		c->jit_generation_time += INSTR_TIME_GET_MILLISEC(jitusage->generation_counter);
 
-			e->counters.mean_time[kind] +=
-				(total_time - old_mean) / e->counters.calls[kind];
-			e->counters.sum_var_time[kind] +=
-				(total_time - old_mean) * (total_time - e->counters.mean_time[kind]);
+		if (INSTR_TIME_GET_MILLISEC(jitusage->deform_counter))
+			c->jit_deform_count++;
+		c->jit_deform_time += INSTR_TIME_GET_MILLISEC(jitusage->deform_counter);
 
-			/*
-			 * Calculate min and max time. min = 0 and max = 0 means that the
-			 * min/max statistics were reset
-			 */
-			if (e->counters.min_time[kind] == 0
-				&& e->counters.max_time[kind] == 0)
-			{
-				e->counters.min_time[kind] = total_time;
-				e->counters.max_time[kind] = total_time;
-			}
-			else
-			{
-				if (e->counters.min_time[kind] > total_time)
-					e->counters.min_time[kind] = total_time;
-				if (e->counters.max_time[kind] < total_time)
-					e->counters.max_time[kind] = total_time;
-			}
+		if (INSTR_TIME_GET_MILLISEC(jitusage->inlining_counter))
+			c->jit_inlining_count++;
+		c->jit_inlining_time += INSTR_TIME_GET_MILLISEC(jitusage->inlining_counter);
+
+		if (INSTR_TIME_GET_MILLISEC(jitusage->optimization_counter))
+			c->jit_optimization_count++;
+		c->jit_optimization_time += INSTR_TIME_GET_MILLISEC(jitusage->optimization_counter);
+
+		if (INSTR_TIME_GET_MILLISEC(jitusage->emission_counter))
+			c->jit_emission_count++;
+		c->jit_emission_time += INSTR_TIME_GET_MILLISEC(jitusage->emission_counter);
+	}
+}
+
+/*
+ * Add the counters accumulated in "src" to "dst".
+ *
+ * Means and variances are combined using the pairwise form of Welford's
+ * method, so the result is the same as if each execution had been added to
+ * "dst" individually, except for rounding.
+ */
+static void
+pgss_merge_counters(Counters *dst, const Counters *src)
+{
+	for (int kind = 0; kind < PGSS_NUMKIND; kind++)
+	{
+		int64		n1 = dst->calls[kind];
+		int64		n2 = src->calls[kind];
+		double		delta;
+
+		if (n2 == 0)
+			continue;
+
+		/* "Unstick" entry if it was previously sticky */
+		if (IS_STICKY((*dst)))
+			dst->usage = USAGE_INIT;
+
+		dst->calls[kind] = n1 + n2;
+		dst->total_time[kind] += src->total_time[kind];
+
+		if (n1 == 0)
+		{
+			dst->min_time[kind] = src->min_time[kind];
+			dst->max_time[kind] = src->max_time[kind];
+			dst->mean_time[kind] = src->mean_time[kind];
+			dst->sum_var_time[kind] = src->sum_var_time[kind];
+			continue;
 		}
-		e->counters.rows += rows;
-		e->counters.shared_blks_hit += bufusage->shared_blks_hit;
-		e->counters.shared_blks_read += bufusage->shared_blks_read;
-		e->counters.shared_blks_dirtied += bufusage->shared_blks_dirtied;
-		e->counters.shared_blks_written += bufusage->shared_blks_written;
-		e->counters.local_blks_hit += bufusage->local_blks_hit;
-		e->counters.local_blks_read += bufusage->local_blks_read;
-		e->counters.local_blks_dirtied += bufusage->local_blks_dirtied;
-		e->counters.local_blks_written += bufusage->local_blks_written;
-		e->counters.temp_blks_read += bufusage->temp_blks_read;
-		e->counters.temp_blks_written += bufusage->temp_blks_written;
-		e->counters.shared_blk_read_time += INSTR_TIME_GET_MILLISEC(bufusage->shared_blk_read_time);
-		e->counters.shared_blk_write_time += INSTR_TIME_GET_MILLISEC(bufusage->shared_blk_write_time);
-		e->counters.local_blk_read_time += INSTR_TIME_GET_MILLISEC(bufusage->local_blk_read_time);
-		e->counters.local_blk_write_time += INSTR_TIME_GET_MILLISEC(bufusage->local_blk_write_time);
-		e->counters.temp_blk_read_time += INSTR_TIME_GET_MILLISEC(bufusage->temp_blk_read_time);
-		e->counters.temp_blk_write_time += INSTR_TIME_GET_MILLISEC(bufusage->temp_blk_write_time);
-		e->counters.usage += USAGE_EXEC(total_time);
-		e->counters.wal_records += walusage->wal_records;
-		e->counters.wal_fpi += walusage->wal_fpi;
-		e->counters.wal_bytes += walusage->wal_bytes;
-		if (jitusage)
+
+		delta = src->mean_time[kind] - dst->mean_time[kind];
+		dst->mean_time[kind] += delta * n2 / (n1 + n2);
+		dst->sum_var_time[kind] += src->sum_var_time[kind] +
+			delta * delta * ((double) n1 * n2) / (n1 + n2);
+
+		/* min = 0 and max = 0 means that the min/max statistics were reset */
+		if (dst->min_time[kind] == 0 && dst->max_time[kind] == 0)
 		{
-			e->counters.jit_functions += jitusage->created_functions;
-			e->counters.jit_generation_time += INSTR_TIME_GET_MILLISEC(jitusage->generation_counter);
+			dst->min_time[kind] = src->min_time[kind];
+			dst->max_time[kind] = src->max_time[kind];
+		}
+		else
+		{
+			if (dst->min_time[kind] > src->min_time[kind])
+				dst->min_time[kind] = src->min_time[kind];
+			if (dst->max_time[kind] < src->max_time[kind])
+				dst->max_time[kind] = src->max_time[kind];
+		}
+	}
+
+	dst->rows += src->rows;
+	dst->shared_blks_hit += src->shared_blks_hit;
+	dst->shared_blks_read += src->shared_blks_read;
+	dst->shared_blks_dirtied += src->shared_blks_dirtied;
+	dst->shared_blks_written += src->shared_blks_written;
+	dst->local_blks_hit += src->local_blks_hit;
+	dst->local_blks_read += src->local_blks_read;
+	dst->local_blks_dirtied += src->local_blks_dirtied;
+	dst->local_blks_written += src->local_blks_written;
+	dst->temp_blks_read += src->temp_blks_read;
+	dst->temp_blks_written += src->temp_blks_written;
+	dst->shared_blk_read_time += src->shared_blk_read_time;
+	dst->shared_blk_write_time += src->shared_blk_write_time;
+	dst->local_blk_read_time += src->local_blk_read_time;
+	dst->local_blk_write_time += src->local_blk_write_time;
+	dst->temp_blk_read_time += src->temp_blk_read_time;
+	dst->temp_blk_write_time += src->temp_blk_write_time;
+	dst->usage += src->usage;
+	dst->wal_records += src->wal_records;
+	dst->wal_fpi += src->wal_fpi;
+	dst->wal_bytes += src->wal_bytes;
+	dst->jit_functions += src->jit_functions;
+	dst->jit_generation_time += src->jit_generation_time;
+	dst->jit_inlining_count += src->jit_inlining_count;
+	dst->jit_inlining_time += src->jit_inlining_time;
+	dst->jit_deform_count += src->jit_deform_count;
+	dst->jit_deform_time += src->jit_deform_time;
+	dst->jit_optimization_count += src->jit_optimization_count;
+	dst->jit_optimization_time += src->jit_optimization_time;
+	dst->jit_emission_count += src->jit_emission_count;
+	dst->jit_emission_time += src->jit_emission_time;
+}
 
-			if (INSTR_TIME_GET_MILLISEC(jitusage->deform_counter))
-				e->counters.jit_deform_count++;
-			e->counters.jit_deform_time += INSTR_TIME_GET_MILLISEC(jitusage->deform_counter);
+/*
+ * Set up the hash table of statistics waiting to be flushed.
+ */
+static void
+pgss_create_pending_hash(void)
+{
+	HASHCTL		info;
 
-			if (INSTR_TIME_GET_MILLISEC(jitusage->inlining_counter))
-				e->counters.jit_inlining_count++;
-			e->counters.jit_inlining_time += INSTR_TIME_GET_MILLISEC(jitusage->inlining_counter);
+	info.keysize = sizeof(pgssHashKey);
+	info.entrysize = sizeof(pgssPendingEntry);
+	info.hcxt = TopMemoryContext;
+	pgss_pending_hash = hash_create("pg_stat_statements pending entries",
+									64, &info,
+									HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 
-			if (INSTR_TIME_GET_MILLISEC(jitusage->optimization_counter))
-				e->counters.jit_optimization_count++;
-			e->counters.jit_optimization_time += INSTR_TIME_GET_MILLISEC(jitusage->optimization_counter);
+	before_shmem_exit(pgss_flush_at_exit, (Datum) 0);
+}
+
+/*
+ * Add the statistics accumulated by this backend to the shared entries.
+ *
+ * Unless "force" is true, this does nothing if less than
+ * pg_stat_statements.flush_interval has passed since the last flush.  Each
+ * flush starts a new cycle: the next execution of each statement updates
+ * the shared entry directly again, which also recreates the entry if it has
+ * been evicted meanwhile.  The statistics of an entry that was evicted
+ * while they were pending are lost, as they would have been anyway.
+ */
+static void
+pgss_flush_pending(bool force)
+{
+	HASH_SEQ_STATUS hash_seq;
+	pgssPendingEntry *pending;
+	TimestampTz now;
+
+	if (pgss_pending_hash == NULL ||
+		hash_get_num_entries(pgss_pending_hash) == 0)
+		return;
 
-			if (INSTR_TIME_GET_MILLISEC(jitusage->emission_counter))
-				e->counters.jit_emission_count++;
-			e->counters.jit_emission_time += INSTR_TIME_GET_MILLISEC(jitusage->emission_counter);
+	/*
+	 * The statement start time is good enough here, and is much cheaper to
+	 * get than the current time.
+	 */
+	now = GetCurrentStatementStartTimestamp();
+	if (!force && pgss_flush_interval > 0 &&
+		!TimestampDifferenceExceeds(pgss_last_flush, now, pgss_flush_interval))
+		return;
+	pgss_last_flush = now;
+
+	LWLockAcquire(pgss->lock, LW_SHARED);
+
+	hash_seq_init(&hash_seq, pgss_pending_hash);
+	while ((pending = hash_seq_search(&hash_seq)) != NULL)
+	{
+		pgssEntry  *entry;
+
+		if (!IS_STICKY(pending->counters))
+		{
+			entry = (pgssEntry *) hash_search(pgss_hash, &pending->key,
+											  HASH_FIND, NULL);
+			if (entry)
+			{
+				SpinLockAcquire(&entry->mutex);
+				pgss_merge_counters(&entry->counters, &pending->counters);
+				SpinLockRelease(&entry->mutex);
+			}
 		}
 
-		SpinLockRelease(&e->mutex);
+		hash_search(pgss_pending_hash, &pending->key, HASH_REMOVE, NULL);
 	}
 
-done:
 	LWLockRelease(pgss->lock);
+}
 
-	/* We postpone this clean-up until we're out of the lock */
-	if (norm_query)
-		pfree(norm_query);
+/*
+ * before_shmem_exit hook: flush the statistics of an exiting backend.
+ */
+static void
+pgss_flush_at_exit(int code, Datum arg)
+{
+	/* Can't do it if we errored out while holding the lock */
+	if (LWLockHeldByMe(pgss->lock))
+		return;
+
+	pgss_flush_pending(true);
+}
+
+/*
+ * pgstat_report_stat hook: flush the statistics of a backend that is going
+ * idle, so that they don't stay pending for as long as the session sits
+ * idle.  If it's too soon for that, ask to be called again once
+ * pg_stat_statements.flush_interval has passed, which is then forced from
+ * the idle statistics update timeout.
+ */
+static long
+pgss_report_stat(bool force)
+{
+	long		timeout = 0;
+
+	if (prev_pgstat_report_stat)
+		timeout = prev_pgstat_report_stat(force);
+
+	if (pgss_pending_hash == NULL ||
+		hash_get_num_entries(pgss_pending_hash) == 0 ||
+		LWLockHeldByMe(pgss->lock))
+		return timeout;
+
+	pgss_flush_pending(force);
+
+	if (hash_get_num_entries(pgss_pending_hash) > 0)
+	{
+		long		delay;
+
+		delay = TimestampDifferenceMilliseconds(GetCurrentTransactionStopTimestamp(),
+												TimestampTzPlusMilliseconds(pgss_last_flush,
+																			pgss_flush_interval));
+		delay = Max(delay, 1);
+		if (timeout == 0 || delay < timeout)
+			timeout = delay;
+	}
+
+	return timeout;
 }
 
 /*
@@ -1662,6 +1976,9 @@ pg_stat_statements_internal(FunctionCallInfo fcinfo,
 				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 				 errmsg("pg_stat_statements must be loaded via shared_preload_libraries")));
 
+	/* Make our own statistics visible, at least. */
+	pgss_flush_pending(true);
+
 	InitMaterializedSRF(fcinfo, 0);
 
 	/*
@@ -2673,6 +2990,9 @@ entry_reset(Oid userid, Oid dbid, uint64 queryid, bool minmax_only)
 				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 				 errmsg("pg_stat_statements must be loaded via shared_preload_libraries")));
 
+	/* Don't let our pending statistics survive the reset. */
+	pgss_flush_pending(true);
+
 	LWLockAcquire(pgss->lock, LW_EXCLUSIVE);
 	num_entries = hash_get_num_entries(pgss_hash);
 
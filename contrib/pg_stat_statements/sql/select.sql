@@ -147,3 +147,13 @@ SELECT (
 
 SELECT COUNT(*) FROM pg_stat_statements WHERE query LIKE '%SELECT GROUPING%';
 SELECT pg_stat_statements_reset() IS NOT NULL AS t;
+
+-- Statistics accumulated locally with flush_interval
+SET pg_stat_statements.flush_interval = '1min';
+SELECT 1 AS "batched";
+SELECT 1 AS "batched";
+SELECT 1 AS "batched";
+SELECT calls, rows, query FROM pg_stat_statements
+  WHERE query LIKE '%batched%' AND query NOT LIKE '%pg_stat_statements%';
+RESET pg_stat_statements.flush_interval;
+SELECT pg_stat_statements_reset() IS NOT NULL AS t;
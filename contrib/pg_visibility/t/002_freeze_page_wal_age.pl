@@ -0,0 +1,74 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check that VACUUM freezes the pages that have gone unmodified for at least
+# vacuum_freeze_page_wal_age megabytes of WAL, and only those.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+# Keep checkpoints away: the pages must not need full-page images, which
+# would get them frozen anyway
+$node->append_conf(
+	'postgresql.conf', q{
+autovacuum = off
+checkpoint_timeout = 1h
+max_wal_size = 1GB
+});
+$node->start;
+
+# Two tables that go cold, separated by a few megabytes of WAL from one
+# that is still warm.  The rows are inserted after the tables are created,
+# in separate transactions, so that the pages get WAL-logged and have an
+# LSN even with wal_level = minimal.
+$node->safe_psql(
+	'postgres', q{
+	CREATE EXTENSION pg_visibility;
+	CREATE TABLE cold1 (a int);
+	CREATE TABLE cold2 (a int);
+	CREATE TABLE filler (a int, b text);
+	CREATE TABLE warm (a int);
+	CHECKPOINT;
+	INSERT INTO cold1 SELECT g FROM generate_series(1, 1000) g;
+	INSERT INTO cold2 SELECT g FROM generate_series(1, 1000) g;
+	INSERT INTO filler SELECT g, repeat('x', 100) FROM generate_series(1, 20000) g;
+	INSERT INTO warm SELECT g FROM generate_series(1, 1000) g;
+});
+
+# Whether all pages of the table are all-visible, and how many are frozen
+sub vm_state
+{
+	my ($table) = @_;
+
+	return $node->safe_psql(
+		'postgres', qq{
+		SELECT all_visible = pg_relation_size('$table') / current_setting('block_size')::int,
+			   all_frozen = pg_relation_size('$table') / current_setting('block_size')::int,
+			   all_frozen = 0
+		FROM pg_visibility_map_summary('$table')});
+}
+
+# By default, VACUUM only marks the cold pages all-visible
+$node->safe_psql('postgres', 'VACUUM cold1');
+is(vm_state('cold1'), 't|f|t', 'cold pages not frozen by default');
+
+# With the setting, it freezes pages as old as it asks for but not newer
+# ones
+$node->safe_psql(
+	'postgres', q{
+	SET vacuum_freeze_page_wal_age = 1;
+	VACUUM cold2;
+	VACUUM warm;
+});
+is(vm_state('cold2'), 't|t|f', 'cold pages frozen');
+is(vm_state('warm'), 't|f|t', 'warm pages not frozen');
+
+is($node->safe_psql('postgres', "SELECT * FROM pg_check_frozen('cold2')"),
+	'', 'pg_check_frozen() detects no errors');
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,35 @@
+/* contrib/pg_wait_history/pg_wait_history--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION pg_wait_history" to load this file. \quit
+
+-- Register functions.
+CREATE FUNCTION pg_wait_history(
+    OUT sample_time timestamptz,
+    OUT pid integer,
+    OUT backend_type text,
+    OUT datid oid,
+    OUT wait_event_type text,
+    OUT wait_event text,
+    OUT query_id bigint
+)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'pg_wait_history'
+LANGUAGE C STRICT VOLATILE PARALLEL SAFE;
+
+CREATE FUNCTION pg_wait_history_reset()
+RETURNS void
+AS 'MODULE_PATHNAME', 'pg_wait_history_reset'
+LANGUAGE C STRICT VOLATILE PARALLEL SAFE;
+
+-- Register a view on the function for ease of use.
+CREATE VIEW pg_wait_history AS
+  SELECT * FROM pg_wait_history();
+
+-- Don't want these to be available to public.
+REVOKE ALL ON FUNCTION pg_wait_history() FROM PUBLIC;
+REVOKE ALL ON pg_wait_history FROM PUBLIC;
+REVOKE ALL ON FUNCTION pg_wait_history_reset() FROM PUBLIC;
+
+GRANT EXECUTE ON FUNCTION pg_wait_history() TO pg_read_all_stats;
+GRANT SELECT ON pg_wait_history TO pg_read_all_stats;
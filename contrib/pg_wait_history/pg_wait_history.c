@@ -0,0 +1,370 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_wait_history.c
+ *		Keep a sampled history of what backends are waiting on.
+ *
+ * A background worker wakes up every pg_wait_history.sample_interval
+ * milliseconds, looks at the wait event and query ID of every active
+ * process, and appends one sample per process to a fixed-size ring buffer in
+ * shared memory.  The oldest samples are overwritten once the buffer is full.
+ * The pg_wait_history view returns the samples currently in the buffer.
+ *
+ * Client backends are sampled only while they are running a query, so that
+ * idle sessions don't fill the buffer with ClientRead waits.  Other processes
+ * don't report a state; they are sampled unless they are waiting in their
+ * main loop, as shown by a wait event of the Activity class.
+ *
+ *	Copyright (c) 2024, PostgreSQL Global Development Group
+ *
+ *	IDENTIFICATION
+ *		contrib/pg_wait_history/pg_wait_history.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lwlock.h"
+#include "storage/proc.h"
+#include "storage/procsignal.h"
+#include "storage/shmem.h"
+#include "utils/backend_status.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/timestamp.h"
+#include "utils/wait_event.h"
+
+PG_MODULE_MAGIC;
+
+#define UINT32_ACCESS_ONCE(var)		 ((uint32)(*((volatile uint32 *)&(var))))
+
+/* One sample of one process. */
+typedef struct WaitHistoryEntry
+{
+	TimestampTz sample_time;
+	uint64		query_id;
+	int			pid;
+	BackendType backend_type;
+	Oid			datid;
+	uint32		wait_event_info;
+} WaitHistoryEntry;
+
+/* Shared state: the ring buffer of samples. */
+typedef struct WaitHistorySharedState
+{
+	LWLock	   *lock;			/* protects the fields below */
+	uint64		nsamples;		/* number of samples ever written */
+	WaitHistoryEntry samples[FLEXIBLE_ARRAY_MEMBER];
+} WaitHistorySharedState;
+
+PGDLLEXPORT void pg_wait_history_main(Datum main_arg);
+
+PG_FUNCTION_INFO_V1(pg_wait_history);
+PG_FUNCTION_INFO_V1(pg_wait_history_reset);
+
+static void pgwh_shmem_request(void);
+static void pgwh_shmem_startup(void);
+static Size pgwh_memsize(void);
+static void pgwh_take_samples(void);
+
+/* Saved hook values in case of unload */
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+/* Pointer to shared-memory state. */
+static WaitHistorySharedState *pgwh = NULL;
+
+/* GUC variables. */
+static int	pgwh_max_samples = 100000;	/* size of the ring buffer */
+static int	pgwh_sample_interval = 10;	/* sampling interval, in ms */
+
+/*
+ * Module load callback.
+ */
+void
+_PG_init(void)
+{
+	BackgroundWorker worker;
+
+	/*
+	 * We can only set up the shared memory and the worker when loaded via
+	 * shared_preload_libraries.
+	 */
+	if (!process_shared_preload_libraries_in_progress)
+		return;
+
+	DefineCustomIntVariable("pg_wait_history.max_samples",
+							"Sets the number of samples kept by pg_wait_history.",
+							NULL,
+							&pgwh_max_samples,
+							100000,
+							1000,
+							MaxAllocSize / sizeof(WaitHistoryEntry),
+							PGC_POSTMASTER,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("pg_wait_history.sample_interval",
+							"Sets the time between samples taken by pg_wait_history.",
+							NULL,
+							&pgwh_sample_interval,
+							10,
+							1,
+							60 * 1000,
+							PGC_SIGHUP,
+							GUC_UNIT_MS,
+							NULL,
+							NULL,
+							NULL);
+
+	MarkGUCPrefixReserved("pg_wait_history");
+
+	prev_shmem_request_hook = shmem_request_hook;
+	shmem_request_hook = pgwh_shmem_request;
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = pgwh_shmem_startup;
+
+	MemSet(&worker, 0, sizeof(BackgroundWorker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+	worker.bgw_restart_time = 1;
+	strcpy(worker.bgw_library_name, "pg_wait_history");
+	strcpy(worker.bgw_function_name, "pg_wait_history_main");
+	strcpy(worker.bgw_name, "pg_wait_history sampler");
+	strcpy(worker.bgw_type, "pg_wait_history sampler");
+	RegisterBackgroundWorker(&worker);
+}
+
+/*
+ * Estimate shared memory space needed.
+ */
+static Size
+pgwh_memsize(void)
+{
+	return add_size(offsetof(WaitHistorySharedState, samples),
+					mul_size(pgwh_max_samples, sizeof(WaitHistoryEntry)));
+}
+
+/*
+ * shmem_request hook: request additional shared resources.  We'll allocate or
+ * attach to the shared resources in pgwh_shmem_startup().
+ */
+static void
+pgwh_shmem_request(void)
+{
+	if (prev_shmem_request_hook)
+		prev_shmem_request_hook();
+
+	RequestAddinShmemSpace(pgwh_memsize());
+	RequestNamedLWLockTranche("pg_wait_history", 1);
+}
+
+/*
+ * shmem_startup hook: allocate or attach to shared memory.
+ */
+static void
+pgwh_shmem_startup(void)
+{
+	bool		found;
+
+	if (prev_shmem_startup_hook)
+		prev_shmem_startup_hook();
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	pgwh = ShmemInitStruct("pg_wait_history", pgwh_memsize(), &found);
+	if (!found)
+	{
+		pgwh->lock = &(GetNamedLWLockTranche("pg_wait_history"))->lock;
+		pgwh->nsamples = 0;
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
+/*
+ * Main entry point for the sampler process.
+ */
+void
+pg_wait_history_main(Datum main_arg)
+{
+	/* Establish signal handlers; once that's done, unblock signals. */
+	pqsignal(SIGTERM, SignalHandlerForShutdownRequest);
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGUSR1, procsignal_sigusr1_handler);
+	BackgroundWorkerUnblockSignals();
+
+	while (!ShutdownRequestPending)
+	{
+		/* In case of a SIGHUP, just reload the configuration. */
+		if (ConfigReloadPending)
+		{
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		pgwh_take_samples();
+
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 pgwh_sample_interval,
+						 WAIT_EVENT_EXTENSION);
+		ResetLatch(MyLatch);
+	}
+}
+
+/*
+ * Append one sample for each interesting process to the ring buffer.
+ */
+static void
+pgwh_take_samples(void)
+{
+	TimestampTz now = GetCurrentTimestamp();
+	int			nbackends;
+
+	/* Start from a fresh snapshot of the backend status array. */
+	pgstat_clear_backend_activity_snapshot();
+	nbackends = pgstat_fetch_stat_numbackends();
+
+	LWLockAcquire(pgwh->lock, LW_EXCLUSIVE);
+
+	for (int i = 1; i <= nbackends; i++)
+	{
+		LocalPgBackendStatus *local = pgstat_get_local_beentry_by_index(i);
+		PgBackendStatus *beentry = &local->backendStatus;
+		PGPROC	   *proc;
+		uint32		wait_event_info;
+		WaitHistoryEntry *entry;
+
+		if (beentry->st_procpid == MyProcPid)
+			continue;
+
+		proc = GetPGProcByNumber(local->proc_number);
+		wait_event_info = UINT32_ACCESS_ONCE(proc->wait_event_info);
+
+		if (beentry->st_state != STATE_UNDEFINED)
+		{
+			if (beentry->st_state != STATE_RUNNING &&
+				beentry->st_state != STATE_FASTPATH)
+				continue;
+		}
+		else if ((wait_event_info & 0xFF000000) == PG_WAIT_ACTIVITY)
+			continue;
+
+		entry = &pgwh->samples[pgwh->nsamples % pgwh_max_samples];
+		entry->sample_time = now;
+		entry->query_id = beentry->st_query_id;
+		entry->pid = beentry->st_procpid;
+		entry->backend_type = beentry->st_backendType;
+		entry->datid = beentry->st_databaseid;
+		entry->wait_event_info = wait_event_info;
+		pgwh->nsamples++;
+	}
+
+	LWLockRelease(pgwh->lock);
+}
+
+/*
+ * Return the samples currently in the ring buffer, oldest first.
+ */
+Datum
+pg_wait_history(PG_FUNCTION_ARGS)
+{
+#define PG_WAIT_HISTORY_COLS	7
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	WaitHistoryEntry *samples;
+	uint64		nsamples;
+	int			count;
+	int			first;
+
+	if (!pgwh)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_wait_history must be loaded via \"shared_preload_libraries\"")));
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	/*
+	 * Copy the samples out, so that we don't hold up the sampler while
+	 * building the result.
+	 */
+	samples = palloc(mul_size(pgwh_max_samples, sizeof(WaitHistoryEntry)));
+
+	LWLockAcquire(pgwh->lock, LW_SHARED);
+	nsamples = pgwh->nsamples;
+	count = Min(nsamples, pgwh_max_samples);
+	first = (nsamples - count) % pgwh_max_samples;
+	memcpy(samples, pgwh->samples, count * sizeof(WaitHistoryEntry));
+	LWLockRelease(pgwh->lock);
+
+	for (int i = 0; i < count; i++)
+	{
+		WaitHistoryEntry *entry = &samples[(first + i) % pgwh_max_samples];
+		Datum		values[PG_WAIT_HISTORY_COLS] = {0};
+		bool		nulls[PG_WAIT_HISTORY_COLS] = {0};
+		const char *wait_event_type = NULL;
+		const char *wait_event = NULL;
+		int			j = 0;
+
+		if (entry->wait_event_info != 0)
+		{
+			wait_event_type = pgstat_get_wait_event_type(entry->wait_event_info);
+			wait_event = pgstat_get_wait_event(entry->wait_event_info);
+		}
+
+		values[j++] = TimestampTzGetDatum(entry->sample_time);
+		values[j++] = Int32GetDatum(entry->pid);
+		values[j++] = CStringGetTextDatum(GetBackendTypeDesc(entry->backend_type));
+		if (OidIsValid(entry->datid))
+			values[j++] = ObjectIdGetDatum(entry->datid);
+		else
+			nulls[j++] = true;
+		if (wait_event_type)
+			values[j++] = CStringGetTextDatum(wait_event_type);
+		else
+			nulls[j++] = true;
+		if (wait_event)
+			values[j++] = CStringGetTextDatum(wait_event);
+		else
+			nulls[j++] = true;
+		if (entry->query_id != 0)
+			values[j++] = Int64GetDatum((int64) entry->query_id);
+		else
+			nulls[j++] = true;
+
+		Assert(j == PG_WAIT_HISTORY_COLS);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	pfree(samples);
+
+	return (Datum) 0;
+}
+
+/*
+ * Discard all samples.
+ */
+Datum
+pg_wait_history_reset(PG_FUNCTION_ARGS)
+{
+	if (!pgwh)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_wait_history must be loaded via \"shared_preload_libraries\"")));
+
+	LWLockAcquire(pgwh->lock, LW_EXCLUSIVE);
+	pgwh->nsamples = 0;
+	LWLockRelease(pgwh->lock);
+
+	PG_RETURN_VOID();
+}
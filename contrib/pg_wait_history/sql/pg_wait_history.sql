@@ -0,0 +1,9 @@
+CREATE EXTENSION pg_wait_history;
+
+-- The sampler should catch this backend sleeping.
+SELECT pg_sleep(0.5);
+SELECT count(*) > 0 AS sampled
+  FROM pg_wait_history
+ WHERE pid = pg_backend_pid() AND wait_event = 'PgSleep';
+
+DROP EXTENSION pg_wait_history;
@@ -854,6 +854,38 @@ pgfdw_get_result(PGconn *conn)
 	return libpqsrv_get_result_last(conn, pgfdw_we_get_result);
 }
 
+/*
+ * Discard the remaining results of a pipeline up to and including its sync
+ * point, and leave pipeline mode.
+ *
+ * Returns false if the connection failed, so that callers can report either
+ * that or an error they already got from an earlier command.
+ */
+bool
+pgfdw_finish_pipeline(PGconn *conn)
+{
+	for (;;)
+	{
+		PGresult   *res = libpqsrv_get_result(conn, pgfdw_we_get_result);
+		ExecStatusType status;
+
+		if (res == NULL)
+		{
+			/* Just the end of one command's results, unless we lost it */
+			if (PQstatus(conn) == CONNECTION_BAD)
+				return false;
+			continue;
+		}
+
+		status = PQresultStatus(res);
+		PQclear(res);
+		if (status == PGRES_PIPELINE_SYNC)
+			break;
+	}
+
+	return PQexitPipelineMode(conn) != 0;
+}
+
 /*
  * Report an error we got from the remote server.
  *
@@ -1605,6 +1637,14 @@ pgfdw_abort_cleanup(ConnCacheEntry *entry, bool toplevel)
 	/* Assume we might have lost track of prepared statements */
 	entry->have_error = true;
 
+	/*
+	 * If we errored out in the middle of a pipeline, we don't know which of
+	 * its commands have been processed.  Treat the connection as
+	 * unsalvageable rather than trying to sort that out.
+	 */
+	if (PQpipelineStatus(entry->conn) != PQ_PIPELINE_OFF)
+		return;
+
 	/*
 	 * If a command has been submitted to the remote server by using an
 	 * asynchronous execution function, the command might not have yet
@@ -1678,6 +1718,10 @@ pgfdw_abort_cleanup_begin(ConnCacheEntry *entry, bool toplevel,
 	/* Assume we might have lost track of prepared statements */
 	entry->have_error = true;
 
+	/* See pgfdw_abort_cleanup */
+	if (PQpipelineStatus(entry->conn) != PQ_PIPELINE_OFF)
+		return false;
+
 	/*
 	 * If a command has been submitted to the remote server by using an
 	 * asynchronous execution function, the command might not have yet
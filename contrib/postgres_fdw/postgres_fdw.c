@@ -151,6 +151,9 @@ typedef struct PgFdwScanState
 	PgFdwConnState *conn_state; /* extra per-connection state */
 	unsigned int cursor_number; /* quasi-unique ID for my cursor */
 	bool		cursor_exists;	/* have we created the cursor? */
+	bool		close_pending;	/* must an old cursor be closed first? */
+	bool		fetch_pending;	/* was the first FETCH pipelined with the
+								 * DECLARE CURSOR? */
 	int			numParams;		/* number of parameters passed to query */
 	FmgrInfo   *param_flinfo;	/* output conversion functions for them */
 	List	   *param_exprs;	/* executable expressions for param values */
@@ -1665,17 +1668,30 @@ postgresReScanForeignScan(ForeignScanState *node)
 	 * better destroy and recreate the cursor.  Otherwise, rewinding it should
 	 * be good enough.  If we've only fetched zero or one batch, we needn't
 	 * even rewind the cursor, just rescan what we have.
+	 *
+	 * We don't close the cursor right away, but leave that to
+	 * create_cursor, which can send the CLOSE together with the new DECLARE
+	 * CURSOR.  That saves a round trip per rescan of a parameterized scan,
+	 * such as the inner side of a nested loop.
 	 */
 	if (node->ss.ps.chgParam != NULL)
 	{
 		fsstate->cursor_exists = false;
-		snprintf(sql, sizeof(sql), "CLOSE c%u",
-				 fsstate->cursor_number);
+		fsstate->close_pending = true;
 	}
 	else if (fsstate->fetch_ct_2 > 1)
 	{
 		snprintf(sql, sizeof(sql), "MOVE BACKWARD ALL IN c%u",
 				 fsstate->cursor_number);
+
+		/*
+		 * We don't use a PG_TRY block here, so be careful not to throw error
+		 * without releasing the PGresult.
+		 */
+		res = pgfdw_exec_query(fsstate->conn, sql, fsstate->conn_state);
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			pgfdw_report_error(ERROR, res, fsstate->conn, true, sql);
+		PQclear(res);
 	}
 	else
 	{
@@ -1684,15 +1700,6 @@ postgresReScanForeignScan(ForeignScanState *node)
 		return;
 	}
 
-	/*
-	 * We don't use a PG_TRY block here, so be careful not to throw error
-	 * without releasing the PGresult.
-	 */
-	res = pgfdw_exec_query(fsstate->conn, sql, fsstate->conn_state);
-	if (PQresultStatus(res) != PGRES_COMMAND_OK)
-		pgfdw_report_error(ERROR, res, fsstate->conn, true, sql);
-	PQclear(res);
-
 	/* Now force a fresh FETCH. */
 	fsstate->tuples = NULL;
 	fsstate->num_tuples = 0;
@@ -1715,7 +1722,7 @@ postgresEndForeignScan(ForeignScanState *node)
 		return;
 
 	/* Close the cursor if open, to prevent accumulation of cursors */
-	if (fsstate->cursor_exists)
+	if (fsstate->cursor_exists || fsstate->close_pending)
 		close_cursor(fsstate->conn, fsstate->cursor_number,
 					 fsstate->conn_state);
 
@@ -3703,6 +3710,12 @@ ec_member_matches_foreign(PlannerInfo *root, RelOptInfo *rel,
 
 /*
  * Create cursor for node's query with current parameter values.
+ *
+ * In sync mode, the caller is about to fetch from the cursor anyway, so we
+ * use libpq's pipeline mode to send the first FETCH along with the DECLARE
+ * CURSOR, as well as the CLOSE of the previous cursor if a rescan left one
+ * behind.  All of that then takes a single round trip to the remote server.
+ * fetch_more_data collects the result of the FETCH.
  */
 static void
 create_cursor(ForeignScanState *node)
@@ -3712,13 +3725,23 @@ create_cursor(ForeignScanState *node)
 	int			numParams = fsstate->numParams;
 	const char **values = fsstate->param_values;
 	PGconn	   *conn = fsstate->conn;
+	bool		pipeline = !fsstate->async_capable;
 	StringInfoData buf;
 	PGresult   *res;
+	char		close_sql[64];
+	char		fetch_sql[64];
 
 	/* First, process a pending asynchronous request, if any. */
 	if (fsstate->conn_state->pendingAreq)
 		process_pending_request(fsstate->conn_state->pendingAreq);
 
+	/* Close the cursor left behind by a rescan, unless we can pipeline it */
+	if (fsstate->close_pending && !pipeline)
+	{
+		close_cursor(conn, fsstate->cursor_number, fsstate->conn_state);
+		fsstate->close_pending = false;
+	}
+
 	/*
 	 * Construct array of query parameter values in text format.  We do the
 	 * conversions in the short-lived per-tuple context, so as not to cause a
@@ -3743,6 +3766,25 @@ create_cursor(ForeignScanState *node)
 	appendStringInfo(&buf, "DECLARE c%u CURSOR FOR\n%s",
 					 fsstate->cursor_number, fsstate->query);
 
+	/*
+	 * Enter pipeline mode only now that nothing but sending the commands is
+	 * left to do, so that an error above can't leave the connection in
+	 * pipeline mode with results nobody is going to read.
+	 */
+	if (pipeline)
+	{
+		if (!PQenterPipelineMode(conn))
+			pgfdw_report_error(ERROR, NULL, conn, false, fsstate->query);
+
+		if (fsstate->close_pending)
+		{
+			snprintf(close_sql, sizeof(close_sql), "CLOSE c%u",
+					 fsstate->cursor_number);
+			if (!PQsendQueryParams(conn, close_sql, 0, NULL, NULL, NULL, NULL, 0))
+				pgfdw_report_error(ERROR, NULL, conn, false, close_sql);
+		}
+	}
+
 	/*
 	 * Notice that we pass NULL for paramTypes, thus forcing the remote server
 	 * to infer types for all parameters.  Since we explicitly cast every
@@ -3754,19 +3796,47 @@ create_cursor(ForeignScanState *node)
 						   NULL, values, NULL, NULL, 0))
 		pgfdw_report_error(ERROR, NULL, conn, false, buf.data);
 
+	if (pipeline)
+	{
+		snprintf(fetch_sql, sizeof(fetch_sql), "FETCH %d FROM c%u",
+				 fsstate->fetch_size, fsstate->cursor_number);
+		if (!PQsendQueryParams(conn, fetch_sql, 0, NULL, NULL, NULL, NULL, 0) ||
+			!PQpipelineSync(conn))
+			pgfdw_report_error(ERROR, NULL, conn, false, fsstate->query);
+	}
+
 	/*
-	 * Get the result, and check for success.
+	 * Get the results, and check for success.  If a command failed, the
+	 * rest of the pipeline was skipped, and we must consume what's left of it
+	 * before reporting the error.
 	 *
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	if (pipeline && fsstate->close_pending)
+	{
+		res = pgfdw_get_result(conn);
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		{
+			(void) pgfdw_finish_pipeline(conn);
+			pgfdw_report_error(ERROR, res, conn, true, close_sql);
+		}
+		PQclear(res);
+		fsstate->close_pending = false;
+	}
+
 	res = pgfdw_get_result(conn);
 	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+	{
+		if (pipeline)
+			(void) pgfdw_finish_pipeline(conn);
 		pgfdw_report_error(ERROR, res, conn, true, fsstate->query);
+	}
 	PQclear(res);
 
 	/* Mark the cursor as created, and show no tuples have been retrieved */
 	fsstate->cursor_exists = true;
+	fsstate->fetch_pending = pipeline;
 	fsstate->tuples = NULL;
 	fsstate->num_tuples = 0;
 	fsstate->next_tuple = 0;
@@ -3818,6 +3888,20 @@ fetch_more_data(ForeignScanState *node)
 			/* Reset per-connection state */
 			fsstate->conn_state->pendingAreq = NULL;
 		}
+		else if (fsstate->fetch_pending)
+		{
+			/*
+			 * create_cursor already sent the FETCH in a pipeline, so fetch
+			 * its result and leave pipeline mode.
+			 */
+			res = pgfdw_get_result(conn);
+			fsstate->fetch_pending = false;
+			if (!pgfdw_finish_pipeline(conn))
+				pgfdw_report_error(ERROR, NULL, conn, false, fsstate->query);
+			/* On error, report the original query, not the FETCH. */
+			if (PQresultStatus(res) != PGRES_TUPLES_OK)
+				pgfdw_report_error(ERROR, res, conn, false, fsstate->query);
+		}
 		else
 		{
 			char		sql[64];
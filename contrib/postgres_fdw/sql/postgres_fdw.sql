@@ -4213,3 +4213,41 @@ ANALYZE analyze_table;
 -- cleanup
 DROP FOREIGN TABLE analyze_ftable;
 DROP TABLE analyze_table;
+
+-- ===================================================================
+-- test rescans, which pipeline the CLOSE of the old cursor with the
+-- DECLARE CURSOR and first FETCH of the new one
+-- ===================================================================
+CREATE TABLE rescan_rtable (a int, b int);
+INSERT INTO rescan_rtable SELECT g, g * 2 FROM generate_series(1, 100) g;
+CREATE FOREIGN TABLE rescan_ftable (a int, b int)
+  SERVER loopback OPTIONS (table_name 'rescan_rtable');
+CREATE VIEW rescan_pid AS SELECT pg_backend_pid() AS pid;
+CREATE FOREIGN TABLE rescan_ftable_pid (pid int)
+  SERVER loopback OPTIONS (table_name 'rescan_pid');
+CREATE TABLE rescan_outer (x int);
+INSERT INTO rescan_outer VALUES (1), (2), (3), (0);
+
+SELECT x, (SELECT b FROM rescan_ftable WHERE a = 60 / x) AS b
+  FROM rescan_outer WHERE x > 0 ORDER BY x;
+
+-- a failure while opening the new cursor leaves the connection usable
+BEGIN;
+SELECT pid AS remote_pid FROM rescan_ftable_pid \gset
+SAVEPOINT s;
+\set VERBOSITY terse
+SELECT x, (SELECT b FROM rescan_ftable WHERE a = 60 / x) AS b
+  FROM rescan_outer;
+\set VERBOSITY default
+ROLLBACK TO s;
+SELECT pid = :remote_pid AS same_connection FROM rescan_ftable_pid;
+SELECT x, (SELECT b FROM rescan_ftable WHERE a = 60 / x) AS b
+  FROM rescan_outer WHERE x > 0 ORDER BY x DESC;
+COMMIT;
+
+-- cleanup
+DROP FOREIGN TABLE rescan_ftable;
+DROP FOREIGN TABLE rescan_ftable_pid;
+DROP VIEW rescan_pid;
+DROP TABLE rescan_rtable;
+DROP TABLE rescan_outer;
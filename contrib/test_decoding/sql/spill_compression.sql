@@ -0,0 +1,51 @@
+-- predictability
+SET synchronous_commit = on;
+
+-- Compress changes spilled to disk, with lz4 if available
+SET logical_decoding_spill_compression = pglz;
+DO $$
+BEGIN
+  IF 'lz4' = ANY ((SELECT enumvals FROM pg_settings
+                   WHERE name = 'logical_decoding_spill_compression')::text[]) THEN
+    SET logical_decoding_spill_compression = lz4;
+  END IF;
+END;
+$$;
+
+SELECT 'init' FROM pg_create_logical_replication_slot('regression_slot', 'test_decoding');
+
+CREATE TABLE spill_compression_test(data text);
+
+-- consume DDL
+SELECT data FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1');
+
+-- spilling main xact, with compressible data
+BEGIN;
+INSERT INTO spill_compression_test SELECT 'compress--1:' || g.i || ':' || repeat('x', 200) FROM generate_series(1, 5000) g(i);
+COMMIT;
+SELECT count(*), count(DISTINCT substring(data FROM 'compress--1:(\d+):')),
+       bool_and(data LIKE '%:' || repeat('x', 200) || '''')
+FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL) WHERE data ~ 'INSERT';
+
+-- spilling subxact and main xact, mixing compressible data, data that
+-- doesn't compress, and changes too small to be worth compressing
+BEGIN;
+SAVEPOINT s;
+INSERT INTO spill_compression_test SELECT 'compress--2:' || g.i || ':' || repeat('y', 200) FROM generate_series(1, 5000) g(i);
+RELEASE SAVEPOINT s;
+INSERT INTO spill_compression_test SELECT 'compress--3:' || g.i || ':' || md5(g.i::text) || md5((g.i + 1)::text) || md5((g.i + 2)::text) || md5((g.i + 3)::text) FROM generate_series(1, 2000) g(i);
+INSERT INTO spill_compression_test SELECT 'compress--4:' || g.i FROM generate_series(1, 2000) g(i);
+COMMIT;
+SELECT substring(data FROM 'compress--(\d):'), count(*),
+       bool_and(CASE substring(data FROM 'compress--(\d):')
+                WHEN '2' THEN data LIKE '%:' || repeat('y', 200) || ''''
+                WHEN '3' THEN length(data) > 128
+                ELSE data ~ ':''compress--4:\d+''$' END)
+FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL) WHERE data ~ 'INSERT'
+GROUP BY 1 ORDER BY 1;
+
+RESET logical_decoding_spill_compression;
+
+DROP TABLE spill_compression_test;
+
+SELECT pg_drop_replication_slot('regression_slot');
@@ -33,6 +33,7 @@
 #include "postmaster/autovacuum.h"
 #include "storage/bufmgr.h"
 #include "storage/freespace.h"
+#include "storage/lmgr.h"
 #include "tcop/tcopprot.h"		/* pgrminclude ignore */
 #include "utils/acl.h"
 #include "utils/datum.h"
@@ -394,17 +395,48 @@ brininsert(Relation idxRel, Datum *values, bool *nulls,
 										 NULL, BUFFER_LOCK_SHARE);
 			if (!lastPageTuple)
 			{
-				bool		recorded;
+				bool		recorded = false;
 
-				recorded = AutoVacuumRequestWork(AVW_BRINSummarizeRange,
-												 RelationGetRelid(idxRel),
-												 lastPageRange);
+				/*
+				 * Autovacuum can't see temporary relations, and won't process
+				 * the request at all if it is disabled, so don't bother
+				 * sending one in those cases.
+				 */
+				if (AutoVacuumingActive() &&
+					!RelationUsesLocalBuffers(idxRel))
+					recorded = AutoVacuumRequestWork(AVW_BRINSummarizeRange,
+													 RelationGetRelid(idxRel),
+													 lastPageRange);
+
+				/*
+				 * If the request could not be recorded, summarize the range
+				 * ourselves, so that it doesn't stay unsummarized until the
+				 * next vacuum.  We need the same lock on the table that
+				 * brin_summarize_range() and vacuum take, to avoid
+				 * summarizing the range concurrently with them; if somebody
+				 * already holds it, they are likely to take care of the
+				 * range anyway.  The lock is released as soon as we're done,
+				 * since the summary tuple is already WAL-logged by then.
+				 */
 				if (!recorded)
-					ereport(LOG,
-							(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
-							 errmsg("request for BRIN range summarization for index \"%s\" page %u was not recorded",
-									RelationGetRelationName(idxRel),
-									lastPageRange)));
+				{
+					if (ConditionalLockRelation(heapRel,
+												ShareUpdateExclusiveLock))
+					{
+						double		numSummarized = 0;
+						double		numExisting = 0;
+
+						brinsummarize(idxRel, heapRel, lastPageRange, false,
+									  &numSummarized, &numExisting);
+						UnlockRelation(heapRel, ShareUpdateExclusiveLock);
+					}
+					else
+						ereport(LOG,
+								(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+								 errmsg("request for BRIN range summarization for index \"%s\" page %u was not recorded",
+										RelationGetRelationName(idxRel),
+										lastPageRange)));
+				}
 			}
 			else
 				LockBuffer(buf, BUFFER_LOCK_UNLOCK);
@@ -911,17 +943,14 @@ bringetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 		/* add the pages in the range to the output bitmap, if needed */
 		if (addrange)
 		{
-			BlockNumber pageno;
+			BlockNumber npages;
 
-			for (pageno = heapBlk;
-				 pageno <= Min(nblocks, heapBlk + opaque->bo_pagesPerRange) - 1;
-				 pageno++)
-			{
-				MemoryContextSwitchTo(oldcxt);
-				tbm_add_page(tbm, pageno);
-				totalpages++;
-				MemoryContextSwitchTo(perRangeCxt);
-			}
+			npages = Min(nblocks, heapBlk + opaque->bo_pagesPerRange) - heapBlk;
+
+			MemoryContextSwitchTo(oldcxt);
+			tbm_add_page_range(tbm, heapBlk, npages);
+			totalpages += npages;
+			MemoryContextSwitchTo(perRangeCxt);
 		}
 	}
 
@@ -18,9 +18,12 @@
 #include "access/printtup.h"
 #include "libpq/pqformat.h"
 #include "tcop/pquery.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
+#include "utils/uuid.h"
 
 
 static void printtup_startup(DestReceiver *self, int operation,
@@ -41,12 +44,32 @@ static void printtup_destroy(DestReceiver *self);
  * we are using for this column.
  * ----------------
  */
+/*
+ * Columns whose output function is one of a few very common built-in ones
+ * are serialized directly into the message buffer, bypassing the fmgr call
+ * and the palloc'd intermediate result.  The bytes sent are exactly what
+ * the output function would have produced.
+ */
+typedef enum PrinttupFastPath
+{
+	PRINTTUP_FAST_NONE,			/* call the output function */
+	PRINTTUP_FAST_INT2_TEXT,
+	PRINTTUP_FAST_INT4_TEXT,
+	PRINTTUP_FAST_INT8_TEXT,
+	PRINTTUP_FAST_TEXT,			/* text, varchar, bpchar; text or binary */
+	PRINTTUP_FAST_INT2_BINARY,
+	PRINTTUP_FAST_INT4_BINARY,
+	PRINTTUP_FAST_INT8_BINARY,	/* also timestamp and timestamptz */
+	PRINTTUP_FAST_UUID_BINARY,
+} PrinttupFastPath;
+
 typedef struct
 {								/* Per-attribute information */
 	Oid			typoutput;		/* Oid for the type's text output fn */
 	Oid			typsend;		/* Oid for the type's binary output fn */
 	bool		typisvarlena;	/* is it varlena (ie possibly toastable)? */
 	int16		format;			/* format code for this column */
+	PrinttupFastPath fastpath;	/* direct serialization, if any */
 	FmgrInfo	finfo;			/* Precomputed call info for output fn */
 } PrinttupAttrInfo;
 
@@ -62,6 +85,10 @@ typedef struct
 	MemoryContext tmpcontext;	/* Memory context for per-row workspace */
 } DR_printtup;
 
+static PrinttupFastPath printtup_choose_fastpath(Oid fnoid);
+static void printtup_send_fast(StringInfo buf, PrinttupFastPath fastpath,
+							   Datum attr);
+
 /* ----------------
  *		Initialize: create a DestReceiver for printtup
  * ----------------
@@ -289,6 +316,102 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 			ereport(ERROR,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 					 errmsg("unsupported format code: %d", format)));
+
+		thisState->fastpath = printtup_choose_fastpath(thisState->finfo.fn_oid);
+	}
+}
+
+/*
+ * Pick a direct serialization for an output or send function, if we have one.
+ */
+static PrinttupFastPath
+printtup_choose_fastpath(Oid fnoid)
+{
+	switch (fnoid)
+	{
+		case F_INT2OUT:
+			return PRINTTUP_FAST_INT2_TEXT;
+		case F_INT4OUT:
+			return PRINTTUP_FAST_INT4_TEXT;
+		case F_INT8OUT:
+			return PRINTTUP_FAST_INT8_TEXT;
+		case F_TEXTOUT:
+		case F_VARCHAROUT:
+		case F_BPCHAROUT:
+		case F_TEXTSEND:
+		case F_VARCHARSEND:
+		case F_BPCHARSEND:
+			return PRINTTUP_FAST_TEXT;
+		case F_INT2SEND:
+			return PRINTTUP_FAST_INT2_BINARY;
+		case F_INT4SEND:
+			return PRINTTUP_FAST_INT4_BINARY;
+		case F_INT8SEND:
+		case F_TIMESTAMP_SEND:
+		case F_TIMESTAMPTZ_SEND:
+			return PRINTTUP_FAST_INT8_BINARY;
+		case F_UUID_SEND:
+			return PRINTTUP_FAST_UUID_BINARY;
+		default:
+			return PRINTTUP_FAST_NONE;
+	}
+}
+
+/*
+ * Send one non-null attribute using its fast path.
+ *
+ * Digits are the same in every client encoding, so integer output needs no
+ * conversion; text still goes through pq_sendcountedtext() for that.
+ */
+static void
+printtup_send_fast(StringInfo buf, PrinttupFastPath fastpath, Datum attr)
+{
+	char		digits[MAXINT8LEN + 1];
+	int			len;
+
+	switch (fastpath)
+	{
+		case PRINTTUP_FAST_INT2_TEXT:
+			len = pg_itoa(DatumGetInt16(attr), digits);
+			pq_sendint32(buf, len);
+			pq_sendbytes(buf, digits, len);
+			break;
+		case PRINTTUP_FAST_INT4_TEXT:
+			len = pg_ltoa(DatumGetInt32(attr), digits);
+			pq_sendint32(buf, len);
+			pq_sendbytes(buf, digits, len);
+			break;
+		case PRINTTUP_FAST_INT8_TEXT:
+			len = pg_lltoa(DatumGetInt64(attr), digits);
+			pq_sendint32(buf, len);
+			pq_sendbytes(buf, digits, len);
+			break;
+		case PRINTTUP_FAST_TEXT:
+			{
+				text	   *t = DatumGetTextPP(attr);
+
+				pq_sendcountedtext(buf, VARDATA_ANY(t), VARSIZE_ANY_EXHDR(t));
+			}
+			break;
+		case PRINTTUP_FAST_INT2_BINARY:
+			pq_sendint32(buf, sizeof(int16));
+			pq_sendint16(buf, DatumGetInt16(attr));
+			break;
+		case PRINTTUP_FAST_INT4_BINARY:
+			pq_sendint32(buf, sizeof(int32));
+			pq_sendint32(buf, DatumGetInt32(attr));
+			break;
+		case PRINTTUP_FAST_INT8_BINARY:
+			pq_sendint32(buf, sizeof(int64));
+			pq_sendint64(buf, DatumGetInt64(attr));
+			break;
+		case PRINTTUP_FAST_UUID_BINARY:
+			pq_sendint32(buf, UUID_LEN);
+			pq_sendbytes(buf, DatumGetPointer(attr), UUID_LEN);
+			break;
+		case PRINTTUP_FAST_NONE:
+			Assert(false);
+			break;
 	}
 }
 
@@ -351,7 +474,9 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 			VALGRIND_CHECK_MEM_IS_DEFINED(DatumGetPointer(attr),
 										  VARSIZE_ANY(attr));
 
-		if (thisState->format == 0)
+		if (thisState->fastpath != PRINTTUP_FAST_NONE)
+			printtup_send_fast(buf, thisState->fastpath, attr);
+		else if (thisState->format == 0)
 		{
 			/* Text output */
 			char	   *outputstr;
@@ -41,6 +41,13 @@ int			gin_pending_list_limit = 0;
 #define GIN_PAGE_FREESIZE \
 	( BLCKSZ - MAXALIGN(SizeOfPageHeaderData) - MAXALIGN(sizeof(GinPageOpaqueData)) )
 
+/*
+ * When autovacuum has been asked to clean up the pending list, inserters
+ * leave it alone until it grows to this many times the cleanup size, so that
+ * a backlog can't build up without bound if autovacuum falls behind.
+ */
+#define GIN_PENDING_LIST_FOREGROUND_FACTOR	4
+
 typedef struct KeyArray
 {
 	Datum	   *keys;			/* expansible array */
@@ -214,9 +221,13 @@ makeSublist(Relation index, IndexTuple *tuples, int32 ntuples,
  *
  * Function guarantees that all these tuples will be inserted consecutively,
  * preserving order
+ *
+ * heapRel is the indexed table, consulted only to see whether autovacuum
+ * may be asked to clean up the pending list.
  */
 void
-ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
+ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector,
+					   Relation heapRel)
 {
 	Relation	index = ginstate->index;
 	Buffer		metabuffer;
@@ -227,6 +238,7 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	ginxlogUpdateMeta data;
 	bool		separateList = false;
 	bool		needCleanup = false;
+	int64		pendingSize;
 	int			cleanupSize;
 	bool		needWal;
 
@@ -456,7 +468,8 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	 * ginInsertCleanup() should not be called inside our CRIT_SECTION.
 	 */
 	cleanupSize = GinGetPendingListCleanupSize(index);
-	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * 1024L)
+	pendingSize = (int64) metadata->nPendingPages * GIN_PAGE_FREESIZE;
+	if (pendingSize > cleanupSize * (int64) 1024)
 		needCleanup = true;
 
 	UnlockReleaseBuffer(metabuffer);
@@ -464,11 +477,28 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	END_CRIT_SECTION();
 
 	/*
+	 * Rather than make this insertion pay for merging the whole pending list
+	 * into the index, ask autovacuum to do it in the background.  Clean up
+	 * here only if autovacuum isn't running, is disabled for the table, or
+	 * can't see the index (it's temporary), if the request can't be queued,
+	 * or if the list has grown well past the limit since autovacuum was
+	 * asked.
+	 *
 	 * Since it could contend with concurrent cleanup process we cleanup
 	 * pending list not forcibly.
 	 */
 	if (needCleanup)
-		ginInsertCleanup(ginstate, false, true, false, NULL);
+	{
+		if (pendingSize > cleanupSize * (int64) 1024 * GIN_PENDING_LIST_FOREGROUND_FACTOR ||
+			!AutoVacuumingActive() ||
+			(heapRel->rd_options &&
+			 !((StdRdOptions *) heapRel->rd_options)->autovacuum.enabled) ||
+			RelationUsesLocalBuffers(index) ||
+			!AutoVacuumRequestWork(AVW_GINCleanPendingList,
+								   RelationGetRelid(index),
+								   InvalidBlockNumber))
+			ginInsertCleanup(ginstate, false, true, false, NULL);
+	}
 }
 
 /*
@@ -519,7 +519,7 @@ gininsert(Relation index, Datum *values, bool *isnull,
 									values[i], isnull[i],
 									ht_ctid);
 
-		ginHeapTupleFastInsert(ginstate, &collector);
+		ginHeapTupleFastInsert(ginstate, &collector, heapRel);
 	}
 	else
 	{
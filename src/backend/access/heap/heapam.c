@@ -53,6 +53,7 @@
 #include "catalog/catalog.h"
 #include "commands/vacuum.h"
 #include "miscadmin.h"
+#include "nodes/tidbitmap.h"
 #include "pgstat.h"
 #include "port/atomics.h"
 #include "port/pg_bitutils.h"
@@ -64,6 +65,7 @@
 #include "storage/standby.h"
 #include "utils/datum.h"
 #include "utils/inval.h"
+#include "utils/memutils.h"
 #include "utils/relcache.h"
 #include "utils/snapmgr.h"
 #include "utils/spccache.h"
@@ -285,6 +287,89 @@ heap_scan_stream_read_next_serial(ReadStream *stream,
 	return scan->rs_prefetch_block;
 }
 
+/*
+ * Size of the per-buffer data of a bitmap heap scan's read stream: a copy of
+ * the TBMIterateResult for the block, with room for any number of offsets.
+ */
+#define BITMAPHEAP_PER_BUFFER_DATA_SIZE \
+	MAXALIGN(offsetof(TBMIterateResult, offsets) + \
+			 MaxHeapTuplesPerPage * sizeof(OffsetNumber))
+
+/*
+ * Streaming read API callback for bitmap heap scans.  Returns the next block
+ * in the bitmap that actually needs to be read, or InvalidBlockNumber when
+ * the bitmap is exhausted, and copies its TBMIterateResult into
+ * per_buffer_data for heapam_scan_bitmap_next_block().
+ *
+ * Blocks that don't need to be read are consumed here, so that they don't
+ * occupy space in the stream's lookahead window.
+ */
+static BlockNumber
+bitmapheap_stream_read_next(ReadStream *stream,
+							void *callback_private_data,
+							void *per_buffer_data)
+{
+	HeapScanDesc scan = (HeapScanDesc) callback_private_data;
+	TableScanDesc sscan = &scan->rs_base;
+
+	for (;;)
+	{
+		TBMIterateResult *tbmres;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (sscan->rs_shared_tbmiterator)
+			tbmres = tbm_shared_iterate(sscan->rs_shared_tbmiterator);
+		else
+			tbmres = tbm_iterate(sscan->rs_tbmiterator);
+
+		/* no more entries in the bitmap */
+		if (tbmres == NULL)
+			return InvalidBlockNumber;
+
+		Assert(tbmres->ntuples <= MaxHeapTuplesPerPage);
+
+		if (tbmres->ntuples >= 0)
+			scan->rs_exact_pages++;
+		else
+			scan->rs_lossy_pages++;
+
+		/*
+		 * Ignore any claimed entries past what we think is the end of the
+		 * relation. It may have been extended after the start of our scan (we
+		 * only hold an AccessShareLock, and it could be inserts from this
+		 * backend).  We don't take this optimization in SERIALIZABLE
+		 * isolation though, as we need to examine all invisible tuples
+		 * reachable by the index.
+		 */
+		if (!IsolationIsSerializable() && tbmres->blockno >= scan->rs_nblocks)
+			continue;
+
+		/*
+		 * We can skip fetching the heap page if we don't need any fields from
+		 * the heap, the bitmap entries don't need rechecking, and all tuples
+		 * on the page are visible to our transaction.
+		 */
+		if (!(sscan->rs_flags & SO_NEED_TUPLES) &&
+			!tbmres->recheck &&
+			VM_ALL_VISIBLE(sscan->rs_rd, tbmres->blockno, &scan->rs_vmbuffer))
+		{
+			/* can't be lossy in the skip_fetch case */
+			Assert(tbmres->ntuples >= 0);
+			Assert(scan->rs_empty_tuples_pending >= 0);
+
+			scan->rs_empty_tuples_pending += tbmres->ntuples;
+			continue;
+		}
+
+		memcpy(per_buffer_data, tbmres,
+			   offsetof(TBMIterateResult, offsets) +
+			   Max(tbmres->ntuples, 0) * sizeof(OffsetNumber));
+
+		return tbmres->blockno;
+	}
+}
+
 /* ----------------
  *		initscan - scan code common to heap_beginscan and heap_rescan
  * ----------------
@@ -483,11 +568,65 @@ page_collect_tuples(HeapScanDesc scan, Snapshot snapshot,
 	return ntup;
 }
 
+/*
+ * page_filter_tuples -- remove tuples failing the scan keys from rs_vistuples
+ *
+ * In page-at-a-time mode the keys are tested in one pass over the page's
+ * visible tuples, so heapgettup_pagemode() only ever sees qualifying ones.
+ * The number of tuples removed is added to rs_nfiltered.
+ *
+ * The key functions run in rs_keycxt, which is reset after every tuple, so
+ * that whatever they leak doesn't pile up for the rest of the scan.  It is
+ * made a child of the context holding the scan descriptor, to share its
+ * lifetime.
+ */
+static void
+page_filter_tuples(HeapScanDesc scan, Page page, BlockNumber block)
+{
+	TupleDesc	tupdesc = RelationGetDescr(scan->rs_base.rs_rd);
+	int			nkeys = scan->rs_base.rs_nkeys;
+	ScanKey		key = scan->rs_base.rs_key;
+	HeapTupleData loctup;
+	int			nkept = 0;
+	MemoryContext oldcxt;
+
+	if (scan->rs_keycxt == NULL)
+		scan->rs_keycxt = AllocSetContextCreate(GetMemoryChunkContext(scan),
+												"HeapScan keys",
+												ALLOCSET_SMALL_SIZES);
+	oldcxt = MemoryContextSwitchTo(scan->rs_keycxt);
+
+	loctup.t_tableOid = RelationGetRelid(scan->rs_base.rs_rd);
+
+	for (int i = 0; i < scan->rs_ntuples; i++)
+	{
+		OffsetNumber lineoff = scan->rs_vistuples[i];
+		ItemId		lpp = PageGetItemId(page, lineoff);
+
+		Assert(ItemIdIsNormal(lpp));
+
+		loctup.t_data = (HeapTupleHeader) PageGetItem(page, lpp);
+		loctup.t_len = ItemIdGetLength(lpp);
+		ItemPointerSet(&(loctup.t_self), block, lineoff);
+
+		if (HeapKeyTest(&loctup, tupdesc, nkeys, key))
+			scan->rs_vistuples[nkept++] = lineoff;
+
+		MemoryContextReset(scan->rs_keycxt);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	scan->rs_base.rs_nfiltered += scan->rs_ntuples - nkept;
+	scan->rs_ntuples = nkept;
+}
+
 /*
  * heap_prepare_pagescan - Prepare current scan page to be scanned in pagemode
  *
- * Preparation currently consists of 1. prune the scan's rs_cbuf page, and 2.
- * fill the rs_vistuples[] array with the OffsetNumbers of visible tuples.
+ * Preparation currently consists of 1. prune the scan's rs_cbuf page, 2.
+ * fill the rs_vistuples[] array with the OffsetNumbers of visible tuples, and
+ * 3. remove those that don't satisfy the scan keys.
  */
 void
 heap_prepare_pagescan(TableScanDesc sscan)
@@ -572,6 +711,14 @@ heap_prepare_pagescan(TableScanDesc sscan)
 	}
 
 	LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+
+	/*
+	 * Apply the scan keys, if any, to all the visible tuples at once.  This
+	 * is done after releasing the content lock, since the key functions can
+	 * be arbitrarily expensive; the pin keeps the visible tuples in place.
+	 */
+	if (scan->rs_base.rs_nkeys > 0)
+		page_filter_tuples(scan, page, block);
 }
 
 /*
@@ -905,7 +1052,10 @@ continue_page:
 			if (key != NULL &&
 				!HeapKeyTest(tuple, RelationGetDescr(scan->rs_base.rs_rd),
 							 nkeys, key))
+			{
+				scan->rs_base.rs_nfiltered++;
 				continue;
+			}
 
 			LockBuffer(scan->rs_cbuf, BUFFER_LOCK_UNLOCK);
 			scan->rs_coffset = lineoff;
@@ -938,16 +1088,15 @@ continue_page:
  * The internal logic is much the same as heapgettup's too, but there are some
  * differences: we do not take the buffer content lock (that only needs to
  * happen inside heap_prepare_pagescan), and we iterate through just the
- * tuples listed in rs_vistuples[] rather than all tuples on the page.  Notice
- * that lineindex is 0-based, where the corresponding loop variable lineoff in
- * heapgettup is 1-based.
+ * tuples listed in rs_vistuples[] rather than all tuples on the page.  Those
+ * have already been checked against the scan keys, so unlike heapgettup we
+ * don't need them here.  Notice that lineindex is 0-based, where the
+ * corresponding loop variable lineoff in heapgettup is 1-based.
  * ----------------
  */
 static void
 heapgettup_pagemode(HeapScanDesc scan,
-					ScanDirection dir,
-					int nkeys,
-					ScanKey key)
+					ScanDirection dir)
 {
 	HeapTuple	tuple = &(scan->rs_ctup);
 	Page		page;
@@ -1005,12 +1154,6 @@ continue_page:
 			tuple->t_len = ItemIdGetLength(lpp);
 			ItemPointerSet(&(tuple->t_self), scan->rs_cblock, lineoff);
 
-			/* skip any tuples that don't match the scan key */
-			if (key != NULL &&
-				!HeapKeyTest(tuple, RelationGetDescr(scan->rs_base.rs_rd),
-							 nkeys, key))
-				continue;
-
 			scan->rs_cindex = lineindex;
 			return;
 		}
@@ -1058,11 +1201,15 @@ heap_beginscan(Relation relation, Snapshot snapshot,
 	scan->rs_base.rs_rd = relation;
 	scan->rs_base.rs_snapshot = snapshot;
 	scan->rs_base.rs_nkeys = nkeys;
+	scan->rs_base.rs_nfiltered = 0;
 	scan->rs_base.rs_flags = flags;
 	scan->rs_base.rs_parallel = parallel_scan;
 	scan->rs_strategy = NULL;	/* set in initscan */
 	scan->rs_vmbuffer = InvalidBuffer;
 	scan->rs_empty_tuples_pending = 0;
+	scan->rs_lossy_pages = 0;
+	scan->rs_exact_pages = 0;
+	scan->rs_keycxt = NULL;
 
 	/*
 	 * Disable page-at-a-time mode if it's not a MVCC-safe snapshot.
@@ -1142,6 +1289,22 @@ heap_beginscan(Relation relation, Snapshot snapshot,
 														  scan,
 														  0);
 	}
+	else if (scan->rs_base.rs_flags & SO_TYPE_BITMAPSCAN)
+	{
+		/*
+		 * Bitmap scans visit ascending but not necessarily adjacent blocks,
+		 * so let the read stream ramp up its distance as it sees I/O, using
+		 * the tablespace's effective_io_concurrency for the number of
+		 * concurrent reads.
+		 */
+		scan->rs_read_stream = read_stream_begin_relation(READ_STREAM_DEFAULT,
+														  scan->rs_strategy,
+														  scan->rs_base.rs_rd,
+														  MAIN_FORKNUM,
+														  bitmapheap_stream_read_next,
+														  scan,
+														  BITMAPHEAP_PER_BUFFER_DATA_SIZE);
+	}
 
 
 	return (TableScanDesc) scan;
@@ -1184,7 +1347,14 @@ heap_rescan(TableScanDesc sscan, ScanKey key, bool set_params,
 		scan->rs_vmbuffer = InvalidBuffer;
 	}
 
-	Assert(scan->rs_empty_tuples_pending == 0);
+	/*
+	 * A bitmap scan may be rescanned before it has returned all the tuples
+	 * it found through the "skip fetch" optimization, or reported all the
+	 * pages it consumed from the bitmap.
+	 */
+	scan->rs_empty_tuples_pending = 0;
+	scan->rs_lossy_pages = 0;
+	scan->rs_exact_pages = 0;
 
 	/*
 	 * The read stream is reset on rescan. This must be done before
@@ -1216,8 +1386,6 @@ heap_endscan(TableScanDesc sscan)
 	if (BufferIsValid(scan->rs_vmbuffer))
 		ReleaseBuffer(scan->rs_vmbuffer);
 
-	Assert(scan->rs_empty_tuples_pending == 0);
-
 	/*
 	 * Must free the read stream before freeing the BufferAccessStrategy.
 	 */
@@ -1238,6 +1406,9 @@ heap_endscan(TableScanDesc sscan)
 	if (scan->rs_parallelworkerdata != NULL)
 		pfree(scan->rs_parallelworkerdata);
 
+	if (scan->rs_keycxt != NULL)
+		MemoryContextDelete(scan->rs_keycxt);
+
 	if (scan->rs_base.rs_flags & SO_TEMP_SNAPSHOT)
 		UnregisterSnapshot(scan->rs_base.rs_snapshot);
 
@@ -1274,8 +1445,7 @@ heap_getnext(TableScanDesc sscan, ScanDirection direction)
 	/* Note: no locking manipulations needed */
 
 	if (scan->rs_base.rs_flags & SO_ALLOW_PAGEMODE)
-		heapgettup_pagemode(scan, direction,
-							scan->rs_base.rs_nkeys, scan->rs_base.rs_key);
+		heapgettup_pagemode(scan, direction);
 	else
 		heapgettup(scan, direction,
 				   scan->rs_base.rs_nkeys, scan->rs_base.rs_key);
@@ -1301,7 +1471,7 @@ heap_getnextslot(TableScanDesc sscan, ScanDirection direction, TupleTableSlot *s
 	/* Note: no locking manipulations needed */
 
 	if (sscan->rs_flags & SO_ALLOW_PAGEMODE)
-		heapgettup_pagemode(scan, direction, sscan->rs_nkeys, sscan->rs_key);
+		heapgettup_pagemode(scan, direction);
 	else
 		heapgettup(scan, direction, sscan->rs_nkeys, sscan->rs_key);
 
@@ -1408,7 +1578,7 @@ heap_getnextslot_tidrange(TableScanDesc sscan, ScanDirection direction,
 	for (;;)
 	{
 		if (sscan->rs_flags & SO_ALLOW_PAGEMODE)
-			heapgettup_pagemode(scan, direction, sscan->rs_nkeys, sscan->rs_key);
+			heapgettup_pagemode(scan, direction);
 		else
 			heapgettup(scan, direction, sscan->rs_nkeys, sscan->rs_key);
 
@@ -2120,10 +2120,13 @@ heapam_estimate_rel_size(Relation rel, int32 *attr_widths,
 
 static bool
 heapam_scan_bitmap_next_block(TableScanDesc scan,
-							  TBMIterateResult *tbmres)
+							  bool *recheck,
+							  uint64 *lossy_pages,
+							  uint64 *exact_pages)
 {
 	HeapScanDesc hscan = (HeapScanDesc) scan;
-	BlockNumber block = tbmres->blockno;
+	TBMIterateResult *tbmres;
+	BlockNumber block;
 	Buffer		buffer;
 	Snapshot	snapshot;
 	int			ntup;
@@ -2131,129 +2134,154 @@ heapam_scan_bitmap_next_block(TableScanDesc scan,
 	hscan->rs_cindex = 0;
 	hscan->rs_ntuples = 0;
 
+	/* Release the buffer of the previous block, if any */
+	if (BufferIsValid(hscan->rs_cbuf))
+	{
+		ReleaseBuffer(hscan->rs_cbuf);
+		hscan->rs_cbuf = InvalidBuffer;
+	}
+
 	/*
-	 * We can skip fetching the heap page if we don't need any fields from the
-	 * heap, the bitmap entries don't need rechecking, and all tuples on the
-	 * page are visible to our transaction.
+	 * Blocks are read through the read stream, whose callback consumes the
+	 * bitmap ahead of us.  Loop until we find a block with visible tuples.
 	 */
-	if (!(scan->rs_flags & SO_NEED_TUPLES) &&
-		!tbmres->recheck &&
-		VM_ALL_VISIBLE(scan->rs_rd, tbmres->blockno, &hscan->rs_vmbuffer))
+	for (;;)
 	{
-		/* can't be lossy in the skip_fetch case */
-		Assert(tbmres->ntuples >= 0);
-		Assert(hscan->rs_empty_tuples_pending >= 0);
+		/*
+		 * If the stream callback has found all-visible pages whose tuples
+		 * needn't be fetched, return those first, as NULL-filled tuples.  They
+		 * never need rechecking.
+		 */
+		if (hscan->rs_empty_tuples_pending > 0)
+		{
+			hscan->rs_cblock = InvalidBlockNumber;
+			*recheck = false;
+			break;
+		}
 
-		hscan->rs_empty_tuples_pending += tbmres->ntuples;
+		CHECK_FOR_INTERRUPTS();
 
-		return true;
-	}
+		hscan->rs_cbuf = read_stream_next_buffer(hscan->rs_read_stream,
+												 (void **) &tbmres);
 
-	/*
-	 * Ignore any claimed entries past what we think is the end of the
-	 * relation. It may have been extended after the start of our scan (we
-	 * only hold an AccessShareLock, and it could be inserts from this
-	 * backend).  We don't take this optimization in SERIALIZABLE isolation
-	 * though, as we need to examine all invisible tuples reachable by the
-	 * index.
-	 */
-	if (!IsolationIsSerializable() && block >= hscan->rs_nblocks)
-		return false;
+		/* Report the bitmap pages the callback consumed meanwhile */
+		*lossy_pages += hscan->rs_lossy_pages;
+		*exact_pages += hscan->rs_exact_pages;
+		hscan->rs_lossy_pages = 0;
+		hscan->rs_exact_pages = 0;
 
-	/*
-	 * Acquire pin on the target heap page, trading in any pin we held before.
-	 */
-	hscan->rs_cbuf = ReleaseAndReadBuffer(hscan->rs_cbuf,
-										  scan->rs_rd,
-										  block);
-	hscan->rs_cblock = block;
-	buffer = hscan->rs_cbuf;
-	snapshot = scan->rs_snapshot;
+		if (!BufferIsValid(hscan->rs_cbuf))
+		{
+			/*
+			 * The bitmap is exhausted, but the callback may have added some
+			 * skipped tuples on its way to the end.
+			 */
+			if (hscan->rs_empty_tuples_pending > 0)
+				continue;
+			return false;
+		}
 
-	ntup = 0;
+		block = tbmres->blockno;
+		Assert(BufferGetBlockNumber(hscan->rs_cbuf) == block);
 
-	/*
-	 * Prune and repair fragmentation for the whole page, if possible.
-	 */
-	heap_page_prune_opt(scan->rs_rd, buffer);
+		hscan->rs_cblock = block;
+		buffer = hscan->rs_cbuf;
+		snapshot = scan->rs_snapshot;
+		*recheck = tbmres->recheck;
 
-	/*
-	 * We must hold share lock on the buffer content while examining tuple
-	 * visibility.  Afterwards, however, the tuples we have found to be
-	 * visible are guaranteed good as long as we hold the buffer pin.
-	 */
-	LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		ntup = 0;
 
-	/*
-	 * We need two separate strategies for lossy and non-lossy cases.
-	 */
-	if (tbmres->ntuples >= 0)
-	{
 		/*
-		 * Bitmap is non-lossy, so we just look through the offsets listed in
-		 * tbmres; but we have to follow any HOT chain starting at each such
-		 * offset.
+		 * Prune and repair fragmentation for the whole page, if possible.
 		 */
-		int			curslot;
+		heap_page_prune_opt(scan->rs_rd, buffer);
 
-		for (curslot = 0; curslot < tbmres->ntuples; curslot++)
-		{
-			OffsetNumber offnum = tbmres->offsets[curslot];
-			ItemPointerData tid;
-			HeapTupleData heapTuple;
+		/*
+		 * We must hold share lock on the buffer content while examining tuple
+		 * visibility.  Afterwards, however, the tuples we have found to be
+		 * visible are guaranteed good as long as we hold the buffer pin.
+		 */
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
 
-			ItemPointerSet(&tid, block, offnum);
-			if (heap_hot_search_buffer(&tid, scan->rs_rd, buffer, snapshot,
-									   &heapTuple, NULL, true))
-				hscan->rs_vistuples[ntup++] = ItemPointerGetOffsetNumber(&tid);
-		}
-	}
-	else
-	{
 		/*
-		 * Bitmap is lossy, so we must examine each line pointer on the page.
-		 * But we can ignore HOT chains, since we'll check each tuple anyway.
+		 * We need two separate strategies for lossy and non-lossy cases.
 		 */
-		Page		page = BufferGetPage(buffer);
-		OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
-		OffsetNumber offnum;
+		if (tbmres->ntuples >= 0)
+		{
+			/*
+			 * Bitmap is non-lossy, so we just look through the offsets listed
+			 * in tbmres; but we have to follow any HOT chain starting at each
+			 * such offset.
+			 */
+			int			curslot;
 
-		for (offnum = FirstOffsetNumber; offnum <= maxoff; offnum = OffsetNumberNext(offnum))
+			for (curslot = 0; curslot < tbmres->ntuples; curslot++)
+			{
+				OffsetNumber offnum = tbmres->offsets[curslot];
+				ItemPointerData tid;
+				HeapTupleData heapTuple;
+
+				ItemPointerSet(&tid, block, offnum);
+				if (heap_hot_search_buffer(&tid, scan->rs_rd, buffer,
+										   snapshot, &heapTuple, NULL, true))
+					hscan->rs_vistuples[ntup++] =
+						ItemPointerGetOffsetNumber(&tid);
+			}
+		}
+		else
 		{
-			ItemId		lp;
-			HeapTupleData loctup;
-			bool		valid;
+			/*
+			 * Bitmap is lossy, so we must examine each line pointer on the
+			 * page. But we can ignore HOT chains, since we'll check each
+			 * tuple anyway.
+			 */
+			Page		page = BufferGetPage(buffer);
+			OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
+			OffsetNumber offnum;
 
-			lp = PageGetItemId(page, offnum);
-			if (!ItemIdIsNormal(lp))
-				continue;
-			loctup.t_data = (HeapTupleHeader) PageGetItem(page, lp);
-			loctup.t_len = ItemIdGetLength(lp);
-			loctup.t_tableOid = scan->rs_rd->rd_id;
-			ItemPointerSet(&loctup.t_self, block, offnum);
-			valid = HeapTupleSatisfiesVisibility(&loctup, snapshot, buffer);
-			if (valid)
+			for (offnum = FirstOffsetNumber; offnum <= maxoff; offnum = OffsetNumberNext(offnum))
 			{
-				hscan->rs_vistuples[ntup++] = offnum;
-				PredicateLockTID(scan->rs_rd, &loctup.t_self, snapshot,
-								 HeapTupleHeaderGetXmin(loctup.t_data));
+				ItemId		lp;
+				HeapTupleData loctup;
+				bool		valid;
+
+				lp = PageGetItemId(page, offnum);
+				if (!ItemIdIsNormal(lp))
+					continue;
+				loctup.t_data = (HeapTupleHeader) PageGetItem(page, lp);
+				loctup.t_len = ItemIdGetLength(lp);
+				loctup.t_tableOid = scan->rs_rd->rd_id;
+				ItemPointerSet(&loctup.t_self, block, offnum);
+				valid = HeapTupleSatisfiesVisibility(&loctup, snapshot, buffer);
+				if (valid)
+				{
+					hscan->rs_vistuples[ntup++] = offnum;
+					PredicateLockTID(scan->rs_rd, &loctup.t_self, snapshot,
+									 HeapTupleHeaderGetXmin(loctup.t_data));
+				}
+				HeapCheckForSerializableConflictOut(valid, scan->rs_rd,
+													&loctup, buffer, snapshot);
 			}
-			HeapCheckForSerializableConflictOut(valid, scan->rs_rd, &loctup,
-												buffer, snapshot);
 		}
-	}
 
-	LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+		LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
 
-	Assert(ntup <= MaxHeapTuplesPerPage);
-	hscan->rs_ntuples = ntup;
+		Assert(ntup <= MaxHeapTuplesPerPage);
+		hscan->rs_ntuples = ntup;
 
-	return ntup > 0;
+		if (ntup > 0)
+			break;
+
+		/* nothing visible on this page, move on */
+		ReleaseBuffer(hscan->rs_cbuf);
+		hscan->rs_cbuf = InvalidBuffer;
+	}
+
+	return true;
 }
 
 static bool
 heapam_scan_bitmap_next_tuple(TableScanDesc scan,
-							  TBMIterateResult *tbmres,
 							  TupleTableSlot *slot)
 {
 	HeapScanDesc hscan = (HeapScanDesc) scan;
@@ -2261,11 +2289,15 @@ heapam_scan_bitmap_next_tuple(TableScanDesc scan,
 	Page		page;
 	ItemId		lp;
 
-	if (hscan->rs_empty_tuples_pending > 0)
+	if (!BlockNumberIsValid(hscan->rs_cblock))
 	{
 		/*
-		 * If we don't have to fetch the tuple, just return nulls.
+		 * This "block" stands for pages skipped by the read stream callback.
+		 * We don't have to fetch the tuples, just return nulls.
 		 */
+		if (hscan->rs_empty_tuples_pending == 0)
+			return false;
+
 		ExecStoreAllNullTuple(slot);
 		hscan->rs_empty_tuples_pending--;
 		return true;
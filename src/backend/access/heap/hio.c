@@ -23,6 +23,12 @@
 #include "storage/freespace.h"
 #include "storage/lmgr.h"
 
+/*
+ * How many times RelationGetBufferForTuple() asks the FSM for another page
+ * when the target page is locked by someone else, before it waits.
+ */
+#define MAX_CONTENDED_PAGE_SKIPS	4
+
 
 /*
  * RelationPutHeapTuple - place tuple at specified page
@@ -516,6 +522,7 @@ RelationGetBufferForTuple(Relation relation, Size len,
 				otherBlock;
 	bool		unlockedTargetBuffer;
 	bool		recheckVmPins;
+	int			contended_skips = 0;
 
 	len = MAXALIGN(len);		/* be conservative */
 
@@ -627,7 +634,35 @@ loop:
 				(PageGetMaxOffsetNumber(BufferGetPage(buffer)) == 0))
 				visibilitymap_pin(relation, targetBlock, vmbuffer);
 
-			LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+			/*
+			 * If another backend holds the lock on this page, it's most
+			 * likely inserting into it too, and with many concurrent
+			 * inserters into one table they would otherwise all queue up on
+			 * the same page.  Rather than wait, ask the FSM for another page;
+			 * its search starts where the last one left off, so concurrent
+			 * requests are handed different pages.  We keep our cached
+			 * target block unless we end up using another one.  Give up
+			 * after a few tries, or when the FSM offers the same page again,
+			 * and just wait for the lock.
+			 */
+			if (!ConditionalLockBuffer(buffer))
+			{
+				BlockNumber altBlock = InvalidBlockNumber;
+
+				if (use_fsm && bistate == NULL &&
+					contended_skips < MAX_CONTENDED_PAGE_SKIPS)
+					altBlock = GetPageWithFreeSpace(relation, targetFreeSpace);
+
+				if (altBlock != InvalidBlockNumber && altBlock != targetBlock)
+				{
+					ReleaseBuffer(buffer);
+					contended_skips++;
+					targetBlock = altBlock;
+					continue;
+				}
+
+				LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+			}
 		}
 		else if (otherBlock == targetBlock)
 		{
@@ -714,6 +714,18 @@ heap_page_prune_and_freeze(Relation relation, Buffer buffer,
 						if (XLogHintBitIsNeeded() && XLogCheckBufferNeedsBackup(buffer))
 							do_freeze = true;
 					}
+
+					/*
+					 * Also freeze if the page hasn't been modified for a
+					 * long time, as measured in WAL written since.  A page
+					 * that has stayed untouched that long is unlikely to be
+					 * modified again soon, so freezing it now is likely to
+					 * save a later aggressive VACUUM from having to do it.
+					 */
+					if (!do_freeze && vacuum_freeze_page_wal_age >= 0 &&
+						PageGetLSN(page) + (XLogRecPtr) vacuum_freeze_page_wal_age * 1024 * 1024 <
+						GetXLogInsertRecPtr())
+						do_freeze = true;
 				}
 			}
 		}
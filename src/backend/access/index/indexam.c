@@ -24,6 +24,8 @@
  *		index_parallelscan_initialize - initialize parallel scan
  *		index_parallelrescan  - (re)start a parallel scan of an index
  *		index_beginscan_parallel - join parallel index scan
+ *		index_enable_heap_prefetch - prefetch heap blocks of upcoming TIDs
+ *		index_heap_prefetch_batch - supply a batch of TIDs to prefetch from
  *		index_getnext_tid	- get the next TID from a scan
  *		index_fetch_heap		- get the scan's next heap tuple
  *		index_getnext_slot	- get the next tuple from a scan
@@ -52,10 +54,13 @@
 #include "catalog/pg_type.h"
 #include "nodes/execnodes.h"
 #include "pgstat.h"
+#include "storage/bufmgr.h"
 #include "storage/lmgr.h"
 #include "storage/predicate.h"
+#include "utils/rel.h"
 #include "utils/ruleutils.h"
 #include "utils/snapmgr.h"
+#include "utils/spccache.h"
 #include "utils/syscache.h"
 
 
@@ -366,6 +371,10 @@ index_rescan(IndexScanDesc scan,
 	scan->kill_prior_tuple = false; /* for safety */
 	scan->xs_heap_continue = false;
 
+	/* Forget TIDs of the previous scan */
+	if (scan->xs_prefetch)
+		scan->xs_prefetch->ntids = 0;
+
 	scan->indexRelation->rd_indam->amrescan(scan, keys, nkeys,
 											orderbys, norderbys);
 }
@@ -390,6 +399,14 @@ index_endscan(IndexScanDesc scan)
 	/* End the AM's scan */
 	scan->indexRelation->rd_indam->amendscan(scan);
 
+	if (scan->xs_prefetch)
+	{
+		if (scan->xs_prefetch->tids)
+			pfree(scan->xs_prefetch->tids);
+		pfree(scan->xs_prefetch);
+		scan->xs_prefetch = NULL;
+	}
+
 	/* Release index refcount acquired by index_beginscan */
 	RelationDecrementReferenceCount(scan->indexRelation);
 
@@ -563,6 +580,114 @@ index_beginscan_parallel(Relation heaprel, Relation indexrel, int nkeys,
 	return scan;
 }
 
+/* ----------------
+ * index_enable_heap_prefetch - prefetch heap blocks of upcoming TIDs
+ *
+ * Ask an amgettuple-based scan to prefetch the heap blocks that the TIDs it
+ * is about to return point to, as far as the AM supplies them through
+ * index_heap_prefetch_batch().  How far ahead to look is determined by the
+ * heap's tablespace's effective_io_concurrency.  This is worthwhile for scans
+ * that fetch most of their heap tuples, i.e. plain index scans.
+ * ----------------
+ */
+void
+index_enable_heap_prefetch(IndexScanDesc scan)
+{
+#ifdef USE_PREFETCH
+	int			distance;
+
+	SCAN_CHECKS;
+	Assert(scan->heapRelation != NULL);
+
+	if (scan->xs_prefetch)
+		return;
+
+	distance =
+		get_tablespace_io_concurrency(scan->heapRelation->rd_rel->reltablespace);
+	if (distance <= 0)
+		return;
+
+	scan->xs_prefetch = palloc0(sizeof(IndexHeapPrefetchData));
+	scan->xs_prefetch->distance = distance;
+	scan->xs_prefetch->last_block = InvalidBlockNumber;
+#endif							/* USE_PREFETCH */
+}
+
+/* ----------------
+ * index_heap_prefetch_batch - supply a batch of TIDs to prefetch from
+ *
+ * Called by the index AM when it has loaded the index entries that its next
+ * amgettuple calls will return, if scan->xs_prefetch is set.  Returns an
+ * array with room for ntids TIDs, which the AM is to fill in the order in
+ * which the scan will return them, before returning the first of them.  The
+ * array remains owned by the scan.
+ * ----------------
+ */
+ItemPointer
+index_heap_prefetch_batch(IndexScanDesc scan, int ntids)
+{
+	IndexHeapPrefetchData *prefetch = scan->xs_prefetch;
+
+	Assert(prefetch != NULL);
+	Assert(ntids >= 0);
+
+	if (ntids > prefetch->maxtids)
+	{
+		int			newmax = Max(ntids, Max(prefetch->maxtids * 2, 64));
+
+		if (prefetch->tids)
+			pfree(prefetch->tids);
+		prefetch->tids = palloc(sizeof(ItemPointerData) * newmax);
+		prefetch->maxtids = newmax;
+	}
+
+	prefetch->ntids = ntids;
+	prefetch->nreturned = 0;
+	prefetch->nprefetched = 0;
+
+	return prefetch->tids;
+}
+
+/*
+ * Account for the TID that the AM just returned, and prefetch the heap
+ * blocks of the batch's TIDs up to prefetch->distance ahead of it.  TIDs
+ * pointing to the same block as their predecessor, as is common in
+ * well-correlated indexes, do not cause repeated prefetch requests.
+ */
+static inline void
+index_heap_prefetch_advance(IndexScanDesc scan)
+{
+	IndexHeapPrefetchData *prefetch = scan->xs_prefetch;
+	int			limit;
+
+	if (prefetch->nreturned >= prefetch->ntids)
+		return;
+
+	/* the TID being returned is read right away, so never prefetch it */
+	prefetch->nreturned++;
+	if (prefetch->nprefetched < prefetch->nreturned)
+	{
+		prefetch->nprefetched = prefetch->nreturned;
+		prefetch->last_block =
+			ItemPointerGetBlockNumber(&prefetch->tids[prefetch->nreturned - 1]);
+	}
+
+	limit = Min(prefetch->ntids, prefetch->nreturned + prefetch->distance);
+	while (prefetch->nprefetched < limit)
+	{
+		BlockNumber blkno;
+
+		blkno = ItemPointerGetBlockNumber(&prefetch->tids[prefetch->nprefetched]);
+		prefetch->nprefetched++;
+
+		if (blkno == prefetch->last_block)
+			continue;
+
+		PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+		prefetch->last_block = blkno;
+	}
+}
+
 /* ----------------
  * index_getnext_tid - get the next TID from a scan
  *
@@ -604,6 +729,9 @@ index_getnext_tid(IndexScanDesc scan, ScanDirection direction)
 	}
 	Assert(ItemPointerIsValid(&scan->xs_heaptid));
 
+	if (scan->xs_prefetch)
+		index_heap_prefetch_advance(scan);
+
 	pgstat_count_index_tuples(scan->indexRelation, 1);
 
 	/* Return the TID of the tuple we found. */
@@ -21,6 +21,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/predicate.h"
+#include "utils/fmgrprotos.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 
@@ -39,6 +40,7 @@ static int	_bt_setuppostingitems(BTScanOpaque so, int itemIndex,
 static inline void _bt_savepostingitem(BTScanOpaque so, int itemIndex,
 									   OffsetNumber offnum,
 									   ItemPointer heapTid, int tupleOffset);
+static void _bt_heap_prefetch_batch(IndexScanDesc scan, ScanDirection dir);
 static bool _bt_steppage(IndexScanDesc scan, ScanDirection dir);
 static bool _bt_readnextpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir);
 static bool _bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno,
@@ -755,11 +757,31 @@ _bt_compare(Relation rel,
 			 * _bt_compare as comparing the scankey to the index item, we have
 			 * to flip the sign of the comparison result.  (Unless it's a DESC
 			 * column, in which case we *don't* flip the sign.)
+			 *
+			 * A descent calls us for every probe of every page's binary
+			 * search, so for the common integer opclasses, compare inline
+			 * instead of going through the fmgr interface.  The results are
+			 * the same as those of btint4cmp() and btint8cmp().
 			 */
-			result = DatumGetInt32(FunctionCall2Coll(&scankey->sk_func,
-													 scankey->sk_collation,
-													 datum,
-													 scankey->sk_argument));
+			if (scankey->sk_func.fn_addr == btint4cmp)
+			{
+				int32		a = DatumGetInt32(datum);
+				int32		b = DatumGetInt32(scankey->sk_argument);
+
+				result = (a > b) - (a < b);
+			}
+			else if (scankey->sk_func.fn_addr == btint8cmp)
+			{
+				int64		a = DatumGetInt64(datum);
+				int64		b = DatumGetInt64(scankey->sk_argument);
+
+				result = (a > b) - (a < b);
+			}
+			else
+				result = DatumGetInt32(FunctionCall2Coll(&scankey->sk_func,
+														 scankey->sk_collation,
+														 datum,
+														 scankey->sk_argument));
 
 			if (!(scankey->sk_flags & SK_BT_DESC))
 				INVERT_COMPARE_RESULT(result);
@@ -1584,6 +1606,25 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum,
 			pstate.prev_scan_page = BufferGetBlockNumber(so->currPos.buf);
 
 		_bt_parallel_release(scan, pstate.prev_scan_page);
+
+		/*
+		 * Whichever backend seizes the scan next must read the sibling page
+		 * before it can release the scan in turn, so a read that misses
+		 * shared buffers stalls every participant.  Start reading it now;
+		 * the time we spend processing this page then overlaps the I/O.
+		 */
+		if (ScanDirectionIsForward(dir))
+		{
+			if (opaque->btpo_next != P_NONE)
+				PrefetchBuffer(scan->indexRelation, MAIN_FORKNUM,
+							   opaque->btpo_next);
+		}
+		else
+		{
+			if (opaque->btpo_prev != P_NONE)
+				PrefetchBuffer(scan->indexRelation, MAIN_FORKNUM,
+							   opaque->btpo_prev);
+		}
 	}
 
 	indnatts = IndexRelationGetNumberOfAttributes(scan->indexRelation);
@@ -1932,9 +1973,34 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum,
 		so->currPos.itemIndex = MaxTIDsPerBTreePage - 1;
 	}
 
+	if (scan->xs_prefetch)
+		_bt_heap_prefetch_batch(scan, dir);
+
 	return (so->currPos.firstItem <= so->currPos.lastItem);
 }
 
+/*
+ * Pass the heap TIDs of the items just loaded into so->currPos to the heap
+ * prefetching logic of indexam.c, in the order they will be returned.
+ */
+static void
+_bt_heap_prefetch_batch(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	int			nitems = so->currPos.lastItem - so->currPos.firstItem + 1;
+	ItemPointer tids;
+
+	tids = index_heap_prefetch_batch(scan, Max(nitems, 0));
+
+	for (int i = 0; i < nitems; i++)
+	{
+		if (ScanDirectionIsForward(dir))
+			tids[i] = so->currPos.items[so->currPos.firstItem + i].heapTid;
+		else
+			tids[i] = so->currPos.items[so->currPos.lastItem - i].heapTid;
+	}
+}
+
 /* Save an index item into so->currPos.items[itemIndex] */
 static void
 _bt_saveitem(BTScanOpaque so, int itemIndex,
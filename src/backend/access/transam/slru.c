@@ -133,6 +133,12 @@ typedef struct SlruWriteAllData *SlruWriteAll;
  */
 #define SlotGetBankNumber(slotno)	((slotno) >> SLRU_BANK_BITSHIFT)
 
+/*
+ * Number of pages to read ahead once a backend is found to be reading an
+ * SLRU sequentially, as VACUUM does with pg_xact.
+ */
+#define SLRU_READ_AHEAD_PAGES	8
+
 
 /*
  * Populate a file tag describing a segment file.  We only use the segment
@@ -329,6 +335,8 @@ SimpleLruInit(SlruCtl ctl, const char *name, int nslots, int nlsns,
 	ctl->sync_handler = sync_handler;
 	ctl->long_segment_names = long_segment_names;
 	ctl->bank_mask = (nslots / SLRU_BANK_SIZE) - 1;
+	ctl->last_read_pageno = -1;
+	ctl->prefetched_upto = -1;
 	strlcpy(ctl->Dir, subdir, sizeof(ctl->Dir));
 }
 
@@ -818,6 +826,27 @@ SlruPhysicalReadPage(SlruCtl ctl, int64 pageno, int slotno)
 		return true;
 	}
 
+#ifdef USE_PREFETCH
+
+	/*
+	 * If we're reading pages one after another, ask the kernel to read the
+	 * following pages of the segment too, so that we don't have to wait for
+	 * each of them separately.  This is only a hint, so ignore errors.
+	 */
+	if (pageno == ctl->last_read_pageno + 1 &&
+		pageno + 1 >= ctl->prefetched_upto &&
+		rpageno + 1 < SLRU_PAGES_PER_SEGMENT)
+	{
+		int			npages = Min(SLRU_READ_AHEAD_PAGES,
+								 SLRU_PAGES_PER_SEGMENT - rpageno - 1);
+
+		(void) posix_fadvise(fd, offset + BLCKSZ, (off_t) npages * BLCKSZ,
+							 POSIX_FADV_WILLNEED);
+		ctl->prefetched_upto = pageno + 1 + npages;
+	}
+#endif
+	ctl->last_read_pageno = pageno;
+
 	errno = 0;
 	pgstat_report_wait_start(WAIT_EVENT_SLRU_READ);
 	if (pg_pread(fd, shared->page_buffer[slotno], BLCKSZ, offset) != BLCKSZ)
@@ -31,6 +31,7 @@
 #include "access/slru.h"
 #include "access/subtrans.h"
 #include "access/transam.h"
+#include "access/xlog.h"
 #include "miscadmin.h"
 #include "pg_trace.h"
 #include "utils/guc_hooks.h"
@@ -73,6 +74,29 @@ static SlruCtlData SubTransCtlData;
 
 #define SubTransCtl  (&SubTransCtlData)
 
+/*
+ * Backend-local cache of SubTransGetTopmostTransaction() results.  Once a
+ * snapshot has overflowed, every visibility check of a tuple written by a
+ * subtransaction asks for its topmost parent, usually for the same few xids
+ * over and over, and each of those lookups would otherwise have to go to the
+ * SLRU.  A subxact's parent never changes, so an entry stays correct for as
+ * long as the xid can be asked about; we clear the cache whenever
+ * TransactionXmin changes, so that entries can't outlive wraparound.
+ *
+ * During recovery, a subxact's parent link only shows up once the startup
+ * process has replayed its assignment record, so we don't cache anything
+ * there.
+ */
+#define SUBTRANS_TOPMOST_CACHE_SIZE 256
+
+typedef struct SubTransTopmostCacheEntry
+{
+	TransactionId xid;
+	TransactionId topxid;
+} SubTransTopmostCacheEntry;
+
+static SubTransTopmostCacheEntry SubTransTopmostCache[SUBTRANS_TOPMOST_CACHE_SIZE];
+static TransactionId SubTransTopmostCacheXmin = InvalidTransactionId;
 
 static int	ZeroSUBTRANSPage(int64 pageno);
 static bool SubTransPagePrecedes(int64 page1, int64 page2);
@@ -164,10 +188,24 @@ SubTransGetTopmostTransaction(TransactionId xid)
 {
 	TransactionId parentXid = xid,
 				previousXid = xid;
+	SubTransTopmostCacheEntry *entry = NULL;
 
 	/* Can't ask about stuff that might not be around anymore */
 	Assert(TransactionIdFollowsOrEquals(xid, TransactionXmin));
 
+	if (!RecoveryInProgress())
+	{
+		if (SubTransTopmostCacheXmin != TransactionXmin)
+		{
+			memset(SubTransTopmostCache, 0, sizeof(SubTransTopmostCache));
+			SubTransTopmostCacheXmin = TransactionXmin;
+		}
+
+		entry = &SubTransTopmostCache[xid % SUBTRANS_TOPMOST_CACHE_SIZE];
+		if (entry->xid == xid && TransactionIdIsValid(xid))
+			return entry->topxid;
+	}
+
 	while (TransactionIdIsValid(parentXid))
 	{
 		previousXid = parentXid;
@@ -187,6 +225,12 @@ SubTransGetTopmostTransaction(TransactionId xid)
 
 	Assert(TransactionIdIsValid(previousXid));
 
+	if (entry != NULL)
+	{
+		entry->xid = xid;
+		entry->topxid = previousXid;
+	}
+
 	return previousXid;
 }
 
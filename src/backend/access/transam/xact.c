@@ -61,6 +61,7 @@
 #include "storage/sinvaladt.h"
 #include "storage/smgr.h"
 #include "utils/builtins.h"
+#include "utils/catcache.h"
 #include "utils/combocid.h"
 #include "utils/guc.h"
 #include "utils/inval.h"
@@ -858,6 +859,7 @@ SetParallelStartTimestamps(TimestampTz xact_ts, TimestampTz stmt_ts)
 	Assert(IsParallelWorker());
 	xactStartTimestamp = xact_ts;
 	stmtStartTimestamp = stmt_ts;
+	SetCatCacheClock(stmt_ts);
 }
 
 /*
@@ -914,6 +916,9 @@ SetCurrentStatementStartTimestamp(void)
 		stmtStartTimestamp = GetCurrentTimestamp();
 	else
 		Assert(stmtStartTimestamp != 0);
+
+	/* also advance the clock used to age catcache entries */
+	SetCatCacheClock(stmtStartTimestamp);
 }
 
 /*
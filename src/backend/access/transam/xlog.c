@@ -73,6 +73,7 @@
 #include "pg_trace.h"
 #include "pgstat.h"
 #include "port/atomics.h"
+#include "port/pg_bitutils.h"
 #include "port/pg_iovec.h"
 #include "postmaster/bgwriter.h"
 #include "postmaster/startup.h"
@@ -115,6 +116,8 @@ int			max_wal_size_mb = 1024; /* 1 GB */
 int			min_wal_size_mb = 80;	/* 80 MB */
 int			wal_keep_size_mb = 0;
 int			XLOGbuffers = -1;
+int			wal_preallocate_segments = 1;
+int			wal_insert_locks = -1;
 int			XLogArchiveTimeout = 0;
 int			XLogArchiveMode = ARCHIVE_MODE_OFF;
 char	   *XLogArchiveCommand = NULL;
@@ -122,6 +125,7 @@ bool		EnableHotStandby = false;
 bool		fullPageWrites = true;
 bool		wal_log_hints = false;
 int			wal_compression = WAL_COMPRESSION_NONE;
+int			wal_record_compression_threshold = -1;
 char	   *wal_consistency_checking_string = NULL;
 bool	   *wal_consistency_checking = NULL;
 bool		wal_init_zero = true;
@@ -129,7 +133,7 @@ bool		wal_recycle = true;
 bool		log_checkpoints = true;
 int			wal_sync_method = DEFAULT_WAL_SYNC_METHOD;
 int			wal_level = WAL_LEVEL_REPLICA;
-int			CommitDelay = 0;	/* precommit delay in microseconds */
+int			CommitDelay = 0;	/* precommit delay in microseconds, or -1 */
 int			CommitSiblings = 5; /* # concurrent xacts needed to sleep */
 int			wal_retrieve_retry_interval = 5000;
 int			max_slot_wal_keep_size_mb = -1;
@@ -142,13 +146,6 @@ bool		XLOG_DEBUG = false;
 
 int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
 
-/*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
- */
-#define NUM_XLOGINSERT_LOCKS  8
-
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
  * checkpoint.
@@ -467,6 +464,20 @@ typedef struct XLogCtlData
 	pg_time_t	lastSegSwitchTime;
 	XLogRecPtr	lastSegSwitchLSN;
 
+	/*
+	 * Group commit bookkeeping.  flushRequests counts the XLogFlush() calls
+	 * that found the WAL not yet flushed far enough, since the last flush
+	 * performed by XLogFlush(); it's accessed using atomics.  The remaining
+	 * fields are protected by WALWriteLock, and are only maintained when
+	 * commit_delay = -1: the time of the last such flush, and moving
+	 * averages, in microseconds, of how long those flushes take and of the
+	 * interval between flush requests.  See XLogFlushAdaptiveDelay().
+	 */
+	pg_atomic_uint32 flushRequests;
+	instr_time	lastGroupFlushTime;
+	double		groupFlushTimeAvg;
+	double		flushRequestIntervalAvg;
+
 	/* These are accessed using atomics -- info_lck not needed */
 	pg_atomic_uint64 logInsertResult;	/* last byte + 1 inserted to buffers */
 	pg_atomic_uint64 logWriteResult;	/* last byte + 1 written out */
@@ -560,6 +571,14 @@ typedef enum
 
 static XLogCtlData *XLogCtl = NULL;
 
+/*
+ * Weight of a new sample in the group commit moving averages, as a
+ * fraction 1/GROUP_FLUSH_AVG_WEIGHT, and the longest adaptive commit delay,
+ * which is the same as the maximum commit_delay.
+ */
+#define GROUP_FLUSH_AVG_WEIGHT	8
+#define MAX_COMMIT_DELAY		100000
+
 /* a private copy of XLogCtl->Insert.WALInsertLocks, for convenience */
 static WALInsertLockPadded *WALInsertLocks = NULL;
 
@@ -667,6 +686,8 @@ static XLogRecPtr XLogGetReplicationSlotMinimumLSN(void);
 static void AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli,
 								  bool opportunistic);
 static void XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible);
+static void XLogFlushUpdateAverages(instr_time start, uint32 batch);
+static int	XLogFlushAdaptiveDelay(void);
 static bool InstallXLogFileSegment(XLogSegNo *segno, char *tmppath,
 								   bool find_free, XLogSegNo max_segno,
 								   TimeLineID tli);
@@ -796,10 +817,10 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * To keep track of which insertions are still in-progress, each concurrent
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
-	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
-	 * boundary, it updates the value stored in the lock to the how far it has
-	 * inserted, to allow the previous buffer to be flushed.
+	 * has progressed. There is a fixed number of insertion locks, set by
+	 * wal_insert_locks. When an inserter crosses a page boundary, it updates
+	 * the value stored in the lock to the how far it has inserted, to allow
+	 * the previous buffer to be flushed.
 	 *
 	 * Holding onto an insertion lock also protects RedoRecPtr and
 	 * fullPageWrites from changing until the insertion is finished.
@@ -811,6 +832,8 @@ XLogInsertRecord(XLogRecData *rdata,
 	 *
 	 *----------
 	 */
+	TRACE_POSTGRESQL_WAL_INSERT_RECORD_START(rechdr->xl_tot_len);
+
 	START_CRIT_SECTION();
 
 	if (likely(class == WALINSERT_NORMAL))
@@ -850,6 +873,8 @@ XLogInsertRecord(XLogRecData *rdata,
 			 */
 			WALInsertLockRelease();
 			END_CRIT_SECTION();
+			TRACE_POSTGRESQL_WAL_INSERT_RECORD_DONE(InvalidXLogRecPtr,
+													InvalidXLogRecPtr);
 			return InvalidXLogRecPtr;
 		}
 
@@ -1023,10 +1048,7 @@ XLogInsertRecord(XLogRecData *rdata,
 		for (; rdata != NULL; rdata = rdata->next)
 			appendBinaryStringInfo(&recordBuf, rdata->data, rdata->len);
 
-		/* We also need temporary space to decode the record. */
 		record = (XLogRecord *) recordBuf.data;
-		decoded = (DecodedXLogRecord *)
-			palloc(DecodeXLogRecordRequiredSpace(record->xl_tot_len));
 
 		if (!debug_reader)
 			debug_reader = XLogReaderAllocate(wal_segment_size, NULL,
@@ -1034,10 +1056,23 @@ XLogInsertRecord(XLogRecData *rdata,
 														 .segment_open = NULL,
 														 .segment_close = NULL),
 											  NULL);
+		if (debug_reader && (record->xl_info & XLR_COMPRESSED))
+			record = DecompressXLogRecord(debug_reader, record, EndPos,
+										  &errormsg);
+
+		/* We also need temporary space to decode the record. */
+		decoded = (DecodedXLogRecord *)
+			palloc(DecodeXLogRecordRequiredSpace(record ? record->xl_tot_len : 0));
+
 		if (!debug_reader)
 		{
 			appendStringInfoString(&buf, "error decoding record: out of memory while allocating a WAL reading processor");
 		}
+		else if (record == NULL)
+		{
+			appendStringInfo(&buf, "error decompressing record: %s",
+							 errormsg ? errormsg : "no error message");
+		}
 		else if (!DecodeXLogRecord(debug_reader,
 								   decoded,
 								   record,
@@ -1078,6 +1113,8 @@ XLogInsertRecord(XLogRecData *rdata,
 		pgWalUsage.wal_fpi += num_fpi;
 	}
 
+	TRACE_POSTGRESQL_WAL_INSERT_RECORD_DONE(StartPos, EndPos);
+
 	return EndPos;
 }
 
@@ -1381,7 +1418,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProcNumber % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProcNumber % wal_insert_locks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1399,7 +1436,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % wal_insert_locks;
 	}
 }
 
@@ -1417,7 +1454,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < wal_insert_locks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1443,7 +1480,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < wal_insert_locks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1471,8 +1508,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-						&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[wal_insert_locks - 1].l.lock,
+						&WALInsertLocks[wal_insert_locks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1548,7 +1585,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < wal_insert_locks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -2821,6 +2858,9 @@ XLogFlush(XLogRecPtr record)
 
 	START_CRIT_SECTION();
 
+	/* Count ourselves in the batch that the next flush will satisfy */
+	pg_atomic_fetch_add_u32(&XLogCtl->flushRequests, 1);
+
 	/*
 	 * Since fsync is usually a horribly expensive operation, we try to
 	 * piggyback as much data as we can on each fsync: if we see any more data
@@ -2839,6 +2879,9 @@ XLogFlush(XLogRecPtr record)
 	for (;;)
 	{
 		XLogRecPtr	insertpos;
+		int			delay;
+		uint32		batch;
+		instr_time	start;
 
 		/* done already? */
 		RefreshXLogWriteResult(LogwrtResult);
@@ -2888,11 +2931,14 @@ XLogFlush(XLogRecPtr record)
 		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
 		 * fewer than CommitSiblings other backends with active transactions.
+		 * With commit_delay = -1, the length of the sleep is derived from
+		 * the recent flush latency and commit rate.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
+		delay = CommitDelay >= 0 ? CommitDelay : XLogFlushAdaptiveDelay();
+		if (delay > 0 && enableFsync &&
 			MinimumActiveBackends(CommitSiblings))
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -2911,9 +2957,23 @@ XLogFlush(XLogRecPtr record)
 		WriteRqst.Write = insertpos;
 		WriteRqst.Flush = insertpos;
 
+		/*
+		 * Everyone who has asked for a flush so far will be satisfied by
+		 * this one, near enough.
+		 */
+		batch = pg_atomic_exchange_u32(&XLogCtl->flushRequests, 0);
+
+		if (CommitDelay < 0)
+			INSTR_TIME_SET_CURRENT(start);
+
 		XLogWrite(WriteRqst, insertTLI, false);
 
+		if (CommitDelay < 0)
+			XLogFlushUpdateAverages(start, batch);
+
 		LWLockRelease(WALWriteLock);
+
+		pgstat_count_wal_flush_batch(batch);
 		/* done */
 		break;
 	}
@@ -2951,6 +3011,70 @@ XLogFlush(XLogRecPtr record)
 			 LSN_FORMAT_ARGS(LogwrtResult.Flush));
 }
 
+/*
+ * Update the moving averages used by XLogFlushAdaptiveDelay(), after a flush
+ * that began at 'start' and satisfied 'batch' flush requests.
+ *
+ * Caller must hold WALWriteLock.
+ */
+static void
+XLogFlushUpdateAverages(instr_time start, uint32 batch)
+{
+	instr_time	end;
+	double		flush_time;
+
+	INSTR_TIME_SET_CURRENT(end);
+	flush_time = INSTR_TIME_GET_MICROSEC(end) - INSTR_TIME_GET_MICROSEC(start);
+
+	if (XLogCtl->groupFlushTimeAvg == 0)
+		XLogCtl->groupFlushTimeAvg = flush_time;
+	else
+		XLogCtl->groupFlushTimeAvg +=
+			(flush_time - XLogCtl->groupFlushTimeAvg) / GROUP_FLUSH_AVG_WEIGHT;
+
+	/*
+	 * The time since the previous flush, divided by the number of requests
+	 * that arrived in it, estimates the interval between requests.
+	 */
+	if (!INSTR_TIME_IS_ZERO(XLogCtl->lastGroupFlushTime))
+	{
+		double		interval;
+
+		interval = (INSTR_TIME_GET_MICROSEC(start) -
+					INSTR_TIME_GET_MICROSEC(XLogCtl->lastGroupFlushTime)) /
+			Max(batch, 1);
+
+		if (XLogCtl->flushRequestIntervalAvg == 0)
+			XLogCtl->flushRequestIntervalAvg = interval;
+		else
+			XLogCtl->flushRequestIntervalAvg +=
+				(interval - XLogCtl->flushRequestIntervalAvg) / GROUP_FLUSH_AVG_WEIGHT;
+	}
+	XLogCtl->lastGroupFlushTime = end;
+}
+
+/*
+ * Choose how long to sleep before flushing, with commit_delay = -1.
+ *
+ * Waiting for about half of a flush's duration is known to give a good
+ * trade-off between throughput and latency, but it's only worth doing when
+ * at least one more backend can be expected to request a flush during the
+ * sleep.  Otherwise, the sleep would only add latency.
+ *
+ * Caller must hold WALWriteLock.
+ */
+static int
+XLogFlushAdaptiveDelay(void)
+{
+	double		delay = XLogCtl->groupFlushTimeAvg / 2;
+
+	if (delay < 1 || XLogCtl->flushRequestIntervalAvg <= 0 ||
+		XLogCtl->flushRequestIntervalAvg > delay)
+		return 0;
+
+	return (int) Min(delay, MAX_COMMIT_DELAY);
+}
+
 /*
  * Write & flush xlog, but without specifying exactly where to.
  *
@@ -3700,6 +3824,55 @@ PreallocXlogFiles(XLogRecPtr endptr, TimeLineID tli)
 	}
 }
 
+/*
+ * Make sure that the wal_preallocate_segments segments following the one
+ * currently being inserted into exist, creating them if necessary, so that
+ * backends crossing a segment boundary find the next segment ready rather
+ * than having to zero-fill it while holding WALWriteLock.  Segments
+ * recycled at checkpoints are counted along with ones created here.
+ *
+ * This is called by the walwriter in each cycle.
+ */
+void
+XLogPreallocateSegments(void)
+{
+	static XLogSegNo lastSegNo = 0; /* highest segment known to exist */
+	static TimeLineID lastTLI = 0;
+	XLogSegNo	insertSegNo;
+	XLogSegNo	segno;
+	TimeLineID	tli;
+
+	if (wal_preallocate_segments <= 0 || RecoveryInProgress())
+		return;
+	if (!XLogCtl->InstallXLogFileSegmentActive)
+		return;					/* unlocked check says no */
+
+	tli = XLogCtl->InsertTimeLineID;
+	if (tli != lastTLI)
+	{
+		lastSegNo = 0;
+		lastTLI = tli;
+	}
+
+	XLByteToSeg(GetXLogInsertRecPtr(), insertSegNo, wal_segment_size);
+
+	for (segno = Max(insertSegNo, lastSegNo) + 1;
+		 segno <= insertSegNo + wal_preallocate_segments;
+		 segno++)
+	{
+		char		path[MAXPGPATH];
+		bool		added;
+		int			lf;
+
+		lf = XLogFileInitInternal(segno, tli, &added, path);
+		if (lf >= 0)
+			close(lf);
+		else if (!added)
+			break;				/* no need for it after all */
+		lastSegNo = segno;
+	}
+}
+
 /*
  * Throws an error if the given log segment has already been removed or
  * recycled. The caller should only pass a segment that it knows to have
@@ -4597,6 +4770,58 @@ XLOGChooseNumBuffers(void)
 	return xbuffers;
 }
 
+/*
+ * Auto-tune the number of WAL insertion locks.
+ *
+ * A higher number allows more insertions to happen concurrently, but adds
+ * some CPU overhead to flushing the WAL, which needs to iterate all the
+ * locks.  The traditional 8 locks are plenty for a few dozen concurrent
+ * writers; beyond that, we allow for one lock per 16 connections, up to
+ * 128.
+ *
+ * This should not be called until MaxConnections has received its final
+ * value.
+ */
+static int
+XLOGChooseNumInsertLocks(void)
+{
+	int			nlocks;
+
+	nlocks = pg_nextpower2_32(Max(MaxConnections / 16, 1));
+	if (nlocks < 8)
+		nlocks = 8;
+	if (nlocks > MAX_WAL_INSERT_LOCKS)
+		nlocks = MAX_WAL_INSERT_LOCKS;
+	return nlocks;
+}
+
+StaticAssertDecl(MAX_WAL_INSERT_LOCKS < MAX_SIMUL_LWLOCKS,
+				 "MAX_WAL_INSERT_LOCKS must be less than MAX_SIMUL_LWLOCKS");
+
+/*
+ * GUC check_hook for wal_insert_locks
+ */
+bool
+check_wal_insert_locks(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * -1 indicates a request for auto-tune.  As with wal_buffers, leave the
+	 * boot_val default alone; XLOGShmemSize will fix it up.
+	 */
+	if (*newval == -1)
+	{
+		if (wal_insert_locks == -1)
+			return true;
+		*newval = XLOGChooseNumInsertLocks();
+	}
+
+	/* Treat 0 as a request for the minimum, like wal_buffers does */
+	if (*newval < 1)
+		*newval = 1;
+
+	return true;
+}
+
 /*
  * GUC check_hook for wal_buffers
  */
@@ -4860,11 +5085,25 @@ XLOGShmemSize(void)
 	}
 	Assert(XLOGbuffers > 0);
 
+	/* Likewise for wal_insert_locks, which needs MaxConnections */
+	if (wal_insert_locks == -1)
+	{
+		char		buf[32];
+
+		snprintf(buf, sizeof(buf), "%d", XLOGChooseNumInsertLocks());
+		SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER,
+						PGC_S_DYNAMIC_DEFAULT);
+		if (wal_insert_locks == -1) /* failed to apply it? */
+			SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER,
+							PGC_S_OVERRIDE);
+	}
+	Assert(wal_insert_locks > 0);
+
 	/* XLogCtl */
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), wal_insert_locks + 1));
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(pg_atomic_uint64), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -4957,9 +5196,9 @@ XLOGShmemInit(void)
 		((uintptr_t) allocptr) % sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * wal_insert_locks;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < wal_insert_locks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
 		pg_atomic_init_u64(&WALInsertLocks[i].l.insertingAt, InvalidXLogRecPtr);
@@ -4990,6 +5229,7 @@ XLOGShmemInit(void)
 	pg_atomic_init_u64(&XLogCtl->logWriteResult, InvalidXLogRecPtr);
 	pg_atomic_init_u64(&XLogCtl->logFlushResult, InvalidXLogRecPtr);
 	pg_atomic_init_u64(&XLogCtl->unloggedLSN, InvalidXLogRecPtr);
+	pg_atomic_init_u32(&XLogCtl->flushRequests, 0);
 }
 
 /*
@@ -6495,7 +6735,7 @@ GetLastImportantRecPtr(void)
 	XLogRecPtr	res = InvalidXLogRecPtr;
 	int			i;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < wal_insert_locks; i++)
 	{
 		XLogRecPtr	last_important;
 
@@ -8507,7 +8747,7 @@ xlog_redo(XLogReaderState *record)
 
 /*
  * Return the extra open flags used for opening a file, depending on the
- * value of the GUCs wal_sync_method, fsync and debug_io_direct.
+ * value of the GUCs wal_sync_method, fsync and io_direct.
  */
 static int
 get_sync_bit(int method)
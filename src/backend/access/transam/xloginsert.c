@@ -129,6 +129,24 @@ static XLogRecData *rdatas;
 static int	num_rdatas;			/* entries currently used */
 static int	max_rdatas;			/* allocated size */
 
+/*
+ * Working space for compressing whole records, see XLogCompressRecord().
+ * The record is copied into 'record_compress_src' in one piece, compressed
+ * into 'record_compress_dest', and 'compressed_rdt' points to the result.
+ * These are allocated on demand, inside a critical section, so the memory
+ * context they live in permits that and allocation failures just mean the
+ * record is written uncompressed.  Buffers grown past
+ * RECORD_COMPRESS_KEEP_SIZE are released after each record.
+ */
+static MemoryContext record_compress_cxt;
+static char *record_compress_src;
+static char *record_compress_dest;
+static size_t record_compress_src_size;
+static size_t record_compress_dest_size;
+static XLogRecData compressed_rdt;
+
+#define RECORD_COMPRESS_KEEP_SIZE	(64 * BLCKSZ)
+
 static bool begininsert_called = false;
 
 /* Memory context to hold the registered buffer and data references. */
@@ -140,6 +158,9 @@ static XLogRecData *XLogRecordAssemble(RmgrId rmid, uint8 info,
 									   bool *topxid_included);
 static bool XLogCompressBackupBlock(char *page, uint16 hole_offset,
 									uint16 hole_length, char *dest, uint16 *dlen);
+static bool XLogCompressRecord(uint64 *total_len);
+static void XLogFindZeroHole(const char *page, uint16 *hole_offset,
+							 uint16 *hole_length);
 
 /*
  * Begin constructing a WAL record. This must be called before the
@@ -232,6 +253,20 @@ XLogResetInsertion(void)
 	mainrdata_last = (XLogRecData *) &mainrdata_head;
 	curinsert_flags = 0;
 	begininsert_called = false;
+
+	/* don't hang on to the space used for an unusually large record */
+	if (record_compress_src_size > RECORD_COMPRESS_KEEP_SIZE)
+	{
+		pfree(record_compress_src);
+		record_compress_src = NULL;
+		record_compress_src_size = 0;
+	}
+	if (record_compress_dest_size > RECORD_COMPRESS_KEEP_SIZE)
+	{
+		pfree(record_compress_dest);
+		record_compress_dest = NULL;
+		record_compress_dest_size = 0;
+	}
 }
 
 /*
@@ -677,9 +712,12 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 			}
 			else
 			{
-				/* Not a standard page header, don't try to eliminate "hole" */
-				bimg.hole_offset = 0;
-				cbimg.hole_length = 0;
+				/*
+				 * Not a standard page header, so there is no "hole" we know
+				 * of.  But pages like these are often largely zeroes, so use
+				 * the longest run of them as the "hole" instead.
+				 */
+				XLogFindZeroHole(page, &bimg.hole_offset, &cbimg.hole_length);
 			}
 
 			/*
@@ -892,6 +930,21 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	hdr_rdt.len = (scratch - hdr_scratch);
 	total_len += hdr_rdt.len;
 
+	/*
+	 * Compress the whole record, if it is big enough.  XLOG records are left
+	 * alone: they are small, except for full-page images that are compressed
+	 * on their own already, and some of them are inspected in raw form.
+	 * Records that are too large are left for the check below to complain
+	 * about.
+	 */
+	if (wal_compression != WAL_COMPRESSION_NONE &&
+		wal_record_compression_threshold >= 0 &&
+		rmid != RM_XLOG_ID &&
+		total_len >= wal_record_compression_threshold &&
+		total_len <= XLogRecordMaxSize &&
+		XLogCompressRecord(&total_len))
+		info |= XLR_COMPRESSED;
+
 	/*
 	 * Calculate CRC of the data
 	 *
@@ -933,6 +986,199 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	return &hdr_rdt;
 }
 
+/*
+ * Find the longest run of zero bytes in a page without a standard layout,
+ * for use as the "hole" of its full-page image.  Since redo fills the hole
+ * with zeroes, any run of zeroes will do.
+ *
+ * The page is examined a word at a time, which is plenty precise for this
+ * purpose.  The hole may not start at the beginning of the page, because
+ * that is how the absence of a hole is represented.  Runs shorter than
+ * MIN_ZERO_HOLE_WORDS words are not worth the extra header bytes a
+ * compressed image with a hole needs.
+ */
+#define MIN_ZERO_HOLE_WORDS	4
+
+static void
+XLogFindZeroHole(const char *page, uint16 *hole_offset, uint16 *hole_length)
+{
+	const uint64 *words = (const uint64 *) page;
+	int			nwords = BLCKSZ / sizeof(uint64);
+	int			best_start = 0;
+	int			best_len = 0;
+	int			run_start = -1;
+
+	*hole_offset = 0;
+	*hole_length = 0;
+
+	if ((uintptr_t) page % sizeof(uint64) != 0)
+		return;
+
+	for (int i = 0; i <= nwords; i++)
+	{
+		if (i < nwords && words[i] == 0)
+		{
+			if (run_start < 0)
+				run_start = Max(i, 1);
+			continue;
+		}
+		if (run_start >= 0 && i - run_start > best_len)
+		{
+			best_start = run_start;
+			best_len = i - run_start;
+		}
+		run_start = -1;
+	}
+
+	if (best_len >= MIN_ZERO_HOLE_WORDS)
+	{
+		*hole_offset = best_start * sizeof(uint64);
+		*hole_length = best_len * sizeof(uint64);
+	}
+}
+
+/*
+ * Make sure that *buf is at least 'needed' bytes, for XLogCompressRecord().
+ */
+static bool
+record_compress_reserve(char **buf, size_t *size, size_t needed)
+{
+	if (*size >= needed)
+		return true;
+
+	if (*buf)
+		pfree(*buf);
+	*size = 0;
+	*buf = MemoryContextAllocExtended(record_compress_cxt, needed,
+									  MCXT_ALLOC_HUGE | MCXT_ALLOC_NO_OOM);
+	if (*buf == NULL)
+		return false;
+	*size = needed;
+	return true;
+}
+
+/*
+ * Replace the body of the record assembled in hdr_rdt by a compressed
+ * version of it, using the method selected with wal_compression.
+ *
+ * Returns false, leaving the record as it was, if compression fails or does
+ * not make the record smaller.  Otherwise the rdata chain is changed to
+ * consist of the XLogRecord header, an XLogRecordCompressHeader and the
+ * compressed data, *total_len is set to the new length of the record, and
+ * true is returned.
+ */
+static bool
+XLogCompressRecord(uint64 *total_len)
+{
+	uint32		orig_len = (uint32) (*total_len - SizeOfXLogRecord);
+	size_t		bound = 0;
+	int32		len = -1;
+	uint8		method = 0;
+	char	   *ptr;
+	XLogRecData *rdt;
+	XLogRecordCompressHeader chdr;
+
+	switch ((WalCompression) wal_compression)
+	{
+		case WAL_COMPRESSION_PGLZ:
+			bound = PGLZ_MAX_OUTPUT(orig_len);
+			method = XLR_COMPRESS_PGLZ;
+			break;
+
+		case WAL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			bound = LZ4_compressBound(orig_len);
+#endif
+			method = XLR_COMPRESS_LZ4;
+			break;
+
+		case WAL_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			bound = ZSTD_compressBound(orig_len);
+#endif
+			method = XLR_COMPRESS_ZSTD;
+			break;
+
+		case WAL_COMPRESSION_NONE:
+			Assert(false);		/* cannot happen */
+			break;
+			/* no default case, so that compiler will warn */
+	}
+
+	if (bound == 0 ||
+		!record_compress_reserve(&record_compress_src,
+								 &record_compress_src_size, orig_len) ||
+		!record_compress_reserve(&record_compress_dest,
+								 &record_compress_dest_size, bound))
+		return false;
+
+	/* Flatten everything following the XLogRecord struct */
+	ptr = record_compress_src;
+	memcpy(ptr, hdr_scratch + SizeOfXLogRecord, hdr_rdt.len - SizeOfXLogRecord);
+	ptr += hdr_rdt.len - SizeOfXLogRecord;
+	for (rdt = hdr_rdt.next; rdt != NULL; rdt = rdt->next)
+	{
+		memcpy(ptr, rdt->data, rdt->len);
+		ptr += rdt->len;
+	}
+	Assert(ptr - record_compress_src == orig_len);
+
+	switch ((WalCompression) wal_compression)
+	{
+		case WAL_COMPRESSION_PGLZ:
+			len = pglz_compress(record_compress_src, orig_len,
+								record_compress_dest, PGLZ_strategy_default);
+			break;
+
+		case WAL_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			len = LZ4_compress_default(record_compress_src,
+									   record_compress_dest,
+									   orig_len, bound);
+			if (len <= 0)
+				len = -1;		/* failure */
+#endif
+			break;
+
+		case WAL_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			{
+				size_t		zlen;
+
+				zlen = ZSTD_compress(record_compress_dest, bound,
+									 record_compress_src, orig_len,
+									 ZSTD_CLEVEL_DEFAULT);
+				len = ZSTD_isError(zlen) ? -1 : (int32) zlen;
+			}
+#endif
+			break;
+
+		case WAL_COMPRESSION_NONE:
+			Assert(false);		/* cannot happen */
+			break;
+	}
+
+	if (len < 0 || len + SizeOfXLogRecordCompressHeader >= orig_len)
+		return false;
+
+	/*
+	 * The block and data headers in hdr_scratch have been copied, so the
+	 * compression header can go in their place.
+	 */
+	chdr.length = orig_len;
+	chdr.method = method;
+	memcpy(hdr_scratch + SizeOfXLogRecord, &chdr, SizeOfXLogRecordCompressHeader);
+	hdr_rdt.len = SizeOfXLogRecord + SizeOfXLogRecordCompressHeader;
+
+	compressed_rdt.data = record_compress_dest;
+	compressed_rdt.len = len;
+	compressed_rdt.next = NULL;
+	hdr_rdt.next = &compressed_rdt;
+
+	*total_len = hdr_rdt.len + len;
+	return true;
+}
+
 /*
  * Create a compressed version of a backup block image.
  *
@@ -1369,6 +1615,14 @@ InitXLogInsert(void)
 											   ALLOCSET_DEFAULT_SIZES);
 	}
 
+	if (record_compress_cxt == NULL)
+	{
+		record_compress_cxt = AllocSetContextCreate(xloginsert_cxt,
+													"WAL record compression",
+													ALLOCSET_DEFAULT_SIZES);
+		MemoryContextAllowInCriticalSection(record_compress_cxt, true);
+	}
+
 	if (registered_buffers == NULL)
 	{
 		registered_buffers = (registered_buffer *)
@@ -169,6 +169,10 @@ XLogReaderFree(XLogReaderState *state)
 	pfree(state->errormsg_buf);
 	if (state->readRecordBuf)
 		pfree(state->readRecordBuf);
+	if (state->decompressBuf)
+		pfree(state->decompressBuf);
+	if (state->readAheadBuf)
+		pfree(state->readAheadBuf);
 	pfree(state->readBuf);
 	pfree(state);
 }
@@ -870,6 +874,25 @@ restart:
 		state->NextRecPtr -= XLogSegmentOffset(state->NextRecPtr, state->segcxt.ws_segsize);
 	}
 
+	/*
+	 * If the record is compressed, decompress it and decode that instead.
+	 * The space reserved above was sized for the compressed length, so give
+	 * it up and allocate again for the real one.
+	 */
+	if (record->xl_info & XLR_COMPRESSED)
+	{
+		record = DecompressXLogRecord(state, record, RecPtr, &errormsg);
+		if (record == NULL)
+			goto err;
+
+		if (decoded && decoded->oversized)
+			pfree(decoded);
+		decoded = XLogReadRecordAlloc(state,
+									  record->xl_tot_len,
+									  true /* allow_oversized */ );
+		Assert(decoded != NULL);
+	}
+
 	/*
 	 * If we got here without a DecodedXLogRecord, it means we needed to
 	 * validate total_len before trusting it, but by now we've done that.
@@ -1115,6 +1138,7 @@ XLogReaderInvalReadState(XLogReaderState *state)
 	state->seg.ws_segno = 0;
 	state->segoff = 0;
 	state->readLen = 0;
+	state->readAheadLen = 0;
 }
 
 /*
@@ -1582,6 +1606,66 @@ WALRead(XLogReaderState *state,
 	return true;
 }
 
+/*
+ * Like WALRead(), but reads ahead in large chunks and satisfies later calls
+ * from memory when possible.  This is meant for page_read callbacks, which
+ * are otherwise asked for one page at a time, so that reading WAL
+ * sequentially doesn't take a system call per page.
+ *
+ * The caller promises that all WAL in [startptr, upto) on timeline 'tli' is
+ * valid and won't change anymore, e.g. because it's been flushed; this
+ * function may read and keep any of it.  The read-ahead is forgotten when
+ * the read state is invalidated after a decoding failure, so a caller
+ * retrying at the same position always gets to see fresh data.
+ */
+bool
+WALReadBuffered(XLogReaderState *state,
+				char *buf, XLogRecPtr startptr, Size count,
+				XLogRecPtr upto, TimeLineID tli,
+				WALReadError *errinfo)
+{
+	Size		len;
+	XLogSegNo	segno;
+	XLogRecPtr	segend;
+
+	Assert(startptr + count <= upto);
+
+	/* Can we satisfy it from what we have read already? */
+	if (state->readAheadLen > 0 &&
+		tli == state->readAheadTLI &&
+		startptr >= state->readAheadPtr &&
+		startptr + count <= state->readAheadPtr + state->readAheadLen)
+	{
+		memcpy(buf, state->readAheadBuf + (startptr - state->readAheadPtr),
+			   count);
+		return true;
+	}
+
+	/* Requests larger than the buffer are not worth keeping */
+	if (count >= XLOGREADER_READ_AHEAD_SIZE)
+		return WALRead(state, buf, startptr, count, tli, errinfo);
+
+	if (state->readAheadBuf == NULL)
+		state->readAheadBuf = palloc(XLOGREADER_READ_AHEAD_SIZE);
+
+	/* Read as much as is allowed, without crossing a segment boundary */
+	XLByteToSeg(startptr, segno, state->segcxt.ws_segsize);
+	XLogSegNoOffsetToRecPtr(segno + 1, 0, state->segcxt.ws_segsize, segend);
+	len = Min(upto, segend) - startptr;
+	len = Max(len, count);
+	len = Min(len, XLOGREADER_READ_AHEAD_SIZE);
+
+	state->readAheadLen = 0;
+	if (!WALRead(state, state->readAheadBuf, startptr, len, tli, errinfo))
+		return false;
+	state->readAheadPtr = startptr;
+	state->readAheadLen = len;
+	state->readAheadTLI = tli;
+
+	memcpy(buf, state->readAheadBuf, count);
+	return true;
+}
+
 /* ----------------------------------------
  * Functions for decoding the data and block references in a record.
  * ----------------------------------------
@@ -1646,6 +1730,130 @@ DecodeXLogRecordRequiredSpace(size_t xl_tot_len)
 	return size;
 }
 
+/*
+ * Decompress a record stored with XLR_COMPRESSED.  The record's CRC must
+ * already have been checked.
+ *
+ * Returns a pointer to the record as it would have been written without
+ * compression, which DecodeXLogRecord() can be used on.  It is kept in a
+ * buffer owned by the XLogReaderState, and is only valid until the next
+ * call.  On error, a human-readable error message is returned in *errormsg,
+ * and the return value is NULL.
+ */
+XLogRecord *
+DecompressXLogRecord(XLogReaderState *state,
+					 XLogRecord *record,
+					 XLogRecPtr lsn,
+					 char **errormsg)
+{
+	XLogRecordCompressHeader chdr;
+	XLogRecord *result;
+	char	   *source;
+	uint32		srclen;
+	uint32		rawlen;
+	bool		decomp_success = true;
+
+	Assert(record->xl_info & XLR_COMPRESSED);
+
+	if (record->xl_tot_len < SizeOfXLogRecord + SizeOfXLogRecordCompressHeader)
+	{
+		report_invalid_record(state,
+							  "compressed record at %X/%X is too short",
+							  LSN_FORMAT_ARGS(lsn));
+		*errormsg = state->errormsg_buf;
+		return NULL;
+	}
+	memcpy(&chdr, (char *) record + SizeOfXLogRecord,
+		   SizeOfXLogRecordCompressHeader);
+	source = (char *) record + SizeOfXLogRecord + SizeOfXLogRecordCompressHeader;
+	srclen = record->xl_tot_len - SizeOfXLogRecord - SizeOfXLogRecordCompressHeader;
+	rawlen = chdr.length;
+
+	if (rawlen == 0 || rawlen > XLogRecordMaxSize - SizeOfXLogRecord)
+	{
+		report_invalid_record(state,
+							  "invalid uncompressed length %u in record at %X/%X",
+							  rawlen, LSN_FORMAT_ARGS(lsn));
+		*errormsg = state->errormsg_buf;
+		return NULL;
+	}
+
+	if (state->decompressBufSize < SizeOfXLogRecord + rawlen)
+	{
+		uint32		newSize = SizeOfXLogRecord + rawlen;
+
+		newSize += XLOG_BLCKSZ - (newSize % XLOG_BLCKSZ);
+		if (state->decompressBuf)
+			pfree(state->decompressBuf);
+		state->decompressBuf = (char *) palloc(newSize);
+		state->decompressBufSize = newSize;
+	}
+	result = (XLogRecord *) state->decompressBuf;
+
+	switch (chdr.method)
+	{
+		case XLR_COMPRESS_PGLZ:
+			if (pglz_decompress(source, srclen,
+								state->decompressBuf + SizeOfXLogRecord,
+								rawlen, true) != rawlen)
+				decomp_success = false;
+			break;
+
+		case XLR_COMPRESS_LZ4:
+#ifdef USE_LZ4
+			if (LZ4_decompress_safe(source,
+									state->decompressBuf + SizeOfXLogRecord,
+									srclen, rawlen) != rawlen)
+				decomp_success = false;
+#else
+			report_invalid_record(state, "could not decompress record at %X/%X compressed with %s not supported by build",
+								  LSN_FORMAT_ARGS(lsn), "LZ4");
+			*errormsg = state->errormsg_buf;
+			return NULL;
+#endif
+			break;
+
+		case XLR_COMPRESS_ZSTD:
+#ifdef USE_ZSTD
+			{
+				size_t		decomp_result;
+
+				decomp_result = ZSTD_decompress(state->decompressBuf + SizeOfXLogRecord,
+												rawlen, source, srclen);
+				if (ZSTD_isError(decomp_result) || decomp_result != rawlen)
+					decomp_success = false;
+			}
+#else
+			report_invalid_record(state, "could not decompress record at %X/%X compressed with %s not supported by build",
+								  LSN_FORMAT_ARGS(lsn), "zstd");
+			*errormsg = state->errormsg_buf;
+			return NULL;
+#endif
+			break;
+
+		default:
+			report_invalid_record(state, "could not decompress record at %X/%X compressed with unknown method %u",
+								  LSN_FORMAT_ARGS(lsn), chdr.method);
+			*errormsg = state->errormsg_buf;
+			return NULL;
+	}
+
+	if (!decomp_success)
+	{
+		report_invalid_record(state, "could not decompress record at %X/%X",
+							  LSN_FORMAT_ARGS(lsn));
+		*errormsg = state->errormsg_buf;
+		return NULL;
+	}
+
+	/* Make it look like the record was never compressed */
+	memcpy(result, record, SizeOfXLogRecord);
+	result->xl_tot_len = SizeOfXLogRecord + rawlen;
+	result->xl_info &= ~XLR_COMPRESSED;
+
+	return result;
+}
+
 /*
  * Decode a record.  "decoded" must point to a MAXALIGNed memory area that has
  * space for at least DecodeXLogRecordRequiredSpace(record) bytes.  On
@@ -38,6 +38,7 @@
 #include "postmaster/walsummarizer.h"
 #include "replication/walsender.h"
 #include "replication/walsender_private.h"
+#include "storage/bufmgr.h"
 #include "storage/bufpage.h"
 #include "storage/checksum.h"
 #include "storage/dsm_impl.h"
@@ -59,6 +60,15 @@
  */
 #define SINK_BUFFER_LENGTH			Max(32768, BLCKSZ)
 
+/*
+ * When reading a file, we ask the kernel to read ahead up to
+ * maintenance_io_concurrency chunks of this size beyond the current read
+ * position, so that several reads are in flight while we verify checksums
+ * and pass the data down the sink chain.  Advice is given in whole chunks
+ * to keep the number of system calls down.
+ */
+#define PREFETCH_CHUNK_LENGTH		(128 * 1024)
+
 typedef struct
 {
 	const char *label;
@@ -116,6 +126,8 @@ static void perform_base_backup(basebackup_options *opt, bbsink *sink,
 								IncrementalBackupInfo *ib);
 static void parse_basebackup_options(List *options, basebackup_options *opt);
 static int	compareWalFileNames(const ListCell *a, const ListCell *b);
+static void basebackup_prefetch_file(int fd, off_t offset, off_t filesize,
+									 off_t *prefetched_upto);
 static ssize_t basebackup_read_file(int fd, char *buf, size_t nbytes, off_t offset,
 									const char *filename, bool partial_read_ok);
 
@@ -1583,6 +1595,8 @@ sendFile(bbsink *sink, const char *readfilename, const char *tarfilename,
 	bool		verify_checksum = false;
 	pg_checksum_context checksum_ctx;
 	int			ibindex = 0;
+	bool		truncated = false;
+	off_t		prefetched_upto = 0;
 
 	if (pg_checksum_init(&checksum_ctx, manifest->checksum_type) < 0)
 		elog(ERROR, "could not initialize checksum of file \"%s\"",
@@ -1694,6 +1708,9 @@ sendFile(bbsink *sink, const char *readfilename, const char *tarfilename,
 			if (bytes_done >= statbuf->st_size)
 				break;
 
+			basebackup_prefetch_file(fd, bytes_done, statbuf->st_size,
+									 &prefetched_upto);
+
 			/*
 			 * Read as many bytes as will fit in the buffer, or however many
 			 * are left to read, whichever is less.
@@ -1707,21 +1724,28 @@ sendFile(bbsink *sink, const char *readfilename, const char *tarfilename,
 		else
 		{
 			BlockNumber relative_blkno;
+			unsigned	nblocks = 1;
+			unsigned	maxblocks = Max(sink->bbs_buffer_length / BLCKSZ, 1);
 
 			/*
 			 * If we've read all the blocks, then it's time to stop.
 			 */
-			if (ibindex >= num_incremental_blocks)
+			if (ibindex >= num_incremental_blocks || truncated)
 				break;
 
 			/*
-			 * Read just one block, whichever one is the next that we're
-			 * supposed to include.
+			 * Read the next block that we're supposed to include, together
+			 * with any immediately following blocks that we also need, as
+			 * many as fit in the buffer.
 			 */
-			relative_blkno = incremental_blocks[ibindex++];
+			relative_blkno = incremental_blocks[ibindex];
+			while (nblocks < maxblocks &&
+				   ibindex + nblocks < num_incremental_blocks &&
+				   incremental_blocks[ibindex + nblocks] == relative_blkno + nblocks)
+				nblocks++;
 			cnt = read_file_data_into_buffer(sink, readfilename, fd,
 											 relative_blkno * BLCKSZ,
-											 BLCKSZ,
+											 nblocks * BLCKSZ,
 											 relative_blkno + segno * RELSEG_SIZE,
 											 verify_checksum,
 											 &checksum_failures);
@@ -1733,12 +1757,17 @@ sendFile(bbsink *sink, const char *readfilename, const char *tarfilename,
 			 * relation files, but we might transiently observe an
 			 * intermediate value.
 			 *
-			 * It should be fine to treat this just as if the entire block had
-			 * been truncated away - i.e. fill this and all later blocks with
-			 * zeroes. WAL replay will fix things up.
+			 * It should be fine to treat this just as if the first block we
+			 * didn't read completely had been truncated away - i.e. send the
+			 * complete blocks we have, and fill that and all later blocks
+			 * with zeroes. WAL replay will fix things up.
 			 */
-			if (cnt < BLCKSZ)
-				break;
+			if (cnt < nblocks * BLCKSZ)
+			{
+				cnt -= cnt % BLCKSZ;
+				truncated = true;
+			}
+			ibindex += cnt / BLCKSZ;
 		}
 
 		/*
@@ -2098,6 +2127,42 @@ convert_link_to_directory(const char *pathbuf, struct stat *statbuf)
 		statbuf->st_mode = S_IFDIR | pg_dir_create_mode;
 }
 
+/*
+ * Advise the kernel that we'll soon read the part of a file that follows
+ * 'offset', so that it can read ahead while we process what we have.
+ *
+ * *prefetched_upto tracks how far we've already given advice; it should
+ * start out as zero for each file.
+ */
+static void
+basebackup_prefetch_file(int fd, off_t offset, off_t filesize,
+						 off_t *prefetched_upto)
+{
+#ifdef USE_PREFETCH
+	off_t		target;
+
+	if (maintenance_io_concurrency <= 0)
+		return;
+
+	target = Min(offset + (off_t) maintenance_io_concurrency * PREFETCH_CHUNK_LENGTH,
+				 filesize);
+	if (*prefetched_upto < offset)
+		*prefetched_upto = offset;
+
+	/* Wait until there's a whole chunk to advise, or the end of the file */
+	if (target - *prefetched_upto < PREFETCH_CHUNK_LENGTH &&
+		target < filesize)
+		return;
+	if (target <= *prefetched_upto)
+		return;
+
+	/* This is only a hint, so ignore errors */
+	(void) posix_fadvise(fd, *prefetched_upto, target - *prefetched_upto,
+						 POSIX_FADV_WILLNEED);
+	*prefetched_upto = target;
+#endif
+}
+
 /*
  * Read some data from a file, setting a wait event and reporting any error
  * encountered.
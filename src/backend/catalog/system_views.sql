@@ -1170,8 +1170,14 @@ SELECT
        b.hits,
        b.evictions,
        b.reuses,
+       b.wal_flushes,
        b.fsyncs,
        b.fsync_time,
+       b.read_histogram,
+       b.write_histogram,
+       b.writeback_histogram,
+       b.extend_histogram,
+       b.fsync_histogram,
        b.stats_reset
 FROM pg_stat_get_io() b;
 
@@ -1185,6 +1191,7 @@ CREATE VIEW pg_stat_wal AS
         w.wal_sync,
         w.wal_write_time,
         w.wal_sync_time,
+        w.wal_flush_batches,
         w.stats_reset
     FROM pg_stat_get_wal() w;
 
@@ -73,6 +73,7 @@
 #include "nodes/miscnodes.h"
 #include "pgstat.h"
 #include "port/pg_bswap.h"
+#include "port/simd.h"
 #include "utils/builtins.h"
 #include "utils/rel.h"
 
@@ -153,6 +154,9 @@ static bool CopyReadLine(CopyFromState cstate);
 static bool CopyReadLineText(CopyFromState cstate);
 static int	CopyReadAttributesText(CopyFromState cstate);
 static int	CopyReadAttributesCSV(CopyFromState cstate);
+static inline void CopyTransferPlainChunks(char **cur_ptr, char **output_ptr,
+										   const char *line_end_ptr,
+										   char c1, char c2);
 static Datum CopyReadBinaryAttribute(CopyFromState cstate, FmgrInfo *flinfo,
 									 Oid typioparam, int32 typmod,
 									 bool *isnull);
@@ -1261,6 +1265,42 @@ CopyReadLineText(CopyFromState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Most bytes of a line are ordinary data that need no processing
+		 * here, so skip over runs of them a vector at a time.  Besides line
+		 * endings and backslashes, the CSV quote and escape characters are
+		 * significant; anything else only clears the CSV per-character
+		 * state.  If we skip to the end of the buffer, go back to refill it.
+		 */
+		if (input_buf_ptr + sizeof(Vector8) <= copy_buf_len)
+		{
+			int			skip_start = input_buf_ptr;
+
+			do
+			{
+				Vector8		chunk;
+
+				vector8_load(&chunk,
+							 (const uint8 *) copy_input_buf + input_buf_ptr);
+				if (vector8_has(chunk, '\\') ||
+					vector8_has(chunk, '\r') ||
+					vector8_has(chunk, '\n') ||
+					(cstate->opts.csv_mode &&
+					 (vector8_has(chunk, (uint8) quotec) ||
+					  vector8_has(chunk, (uint8) escapec))))
+					break;
+				input_buf_ptr += sizeof(Vector8);
+			} while (input_buf_ptr + sizeof(Vector8) <= copy_buf_len);
+
+			if (input_buf_ptr != skip_start)
+			{
+				first_char_in_line = false;
+				last_was_esc = false;
+				if (input_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = input_buf_ptr;
 		c = copy_input_buf[input_buf_ptr++];
@@ -1514,6 +1554,38 @@ GetDecimalFromHex(char hex)
 		return tolower((unsigned char) hex) - 'a' + 10;
 }
 
+/*
+ * Copy input to output a vector at a time, for as long as whole chunks
+ * contain neither c1 nor c2, advancing both pointers.  The field scanning
+ * loops call this on entry to get quickly past the leading bytes they would
+ * otherwise copy unchanged one at a time; they still process any remainder,
+ * and the byte that stopped us, themselves.  Calling it once per loop rather
+ * than once per byte keeps short fields from paying for a vector compare on
+ * every byte.
+ */
+static inline void
+CopyTransferPlainChunks(char **cur_ptr, char **output_ptr,
+						const char *line_end_ptr, char c1, char c2)
+{
+	char	   *in = *cur_ptr;
+	char	   *out = *output_ptr;
+
+	while (line_end_ptr - in >= (ptrdiff_t) sizeof(Vector8))
+	{
+		Vector8		chunk;
+
+		vector8_load(&chunk, (const uint8 *) in);
+		if (vector8_has(chunk, (uint8) c1) || vector8_has(chunk, (uint8) c2))
+			break;
+		memcpy(out, in, sizeof(Vector8));
+		in += sizeof(Vector8);
+		out += sizeof(Vector8);
+	}
+
+	*cur_ptr = in;
+	*output_ptr = out;
+}
+
 /*
  * Parse the current line into separate attributes (fields),
  * performing de-escaping as needed.
@@ -1605,6 +1677,8 @@ CopyReadAttributesText(CopyFromState cstate)
 		 * not* throw any syntax errors before we've done the null-marker
 		 * check.
 		 */
+		CopyTransferPlainChunks(&cur_ptr, &output_ptr, line_end_ptr,
+								delimc, '\\');
 		for (;;)
 		{
 			char		c;
@@ -1862,6 +1936,8 @@ CopyReadAttributesCSV(CopyFromState cstate)
 			char		c;
 
 			/* Not in quote */
+			CopyTransferPlainChunks(&cur_ptr, &output_ptr, line_end_ptr,
+									delimc, quotec);
 			for (;;)
 			{
 				end_ptr = cur_ptr;
@@ -1885,6 +1961,8 @@ CopyReadAttributesCSV(CopyFromState cstate)
 			}
 
 			/* In quote */
+			CopyTransferPlainChunks(&cur_ptr, &output_ptr, line_end_ptr,
+									escapec, quotec);
 			for (;;)
 			{
 				end_ptr = cur_ptr;
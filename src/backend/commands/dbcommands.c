@@ -1608,6 +1608,7 @@ createdb_failure_callback(int code, Datum arg)
 	if (fparms->strategy == CREATEDB_WAL_LOG)
 	{
 		DropDatabaseBuffers(fparms->dest_dboid);
+		smgrforgetdatabase(fparms->dest_dboid);
 		ForgetDatabaseSyncRequests(fparms->dest_dboid);
 
 		/* Release lock on the target database. */
@@ -1811,6 +1812,7 @@ dropdb(const char *dbname, bool missing_ok, bool force)
 	 * dirty buffer to the dead database later...
 	 */
 	DropDatabaseBuffers(db_id);
+	smgrforgetdatabase(db_id);
 
 	/*
 	 * Tell checkpointer to forget any pending fsync and unlink requests for
@@ -2093,6 +2095,7 @@ movedb(const char *dbname, const char *tblspcname)
 	 * src_tblspcoid, but bufmgr.c presently provides no API for that.
 	 */
 	DropDatabaseBuffers(db_id);
+	smgrforgetdatabase(db_id);
 
 	/*
 	 * Check for existence of files in the target directory, i.e., objects of
@@ -3372,6 +3375,7 @@ dbase_redo(XLogReaderState *record)
 
 		/* Drop pages for this database that are in the shared buffer cache */
 		DropDatabaseBuffers(xlrec->db_id);
+		smgrforgetdatabase(xlrec->db_id);
 
 		/* Also, clean out any fsync requests that might be pending in md.c */
 		ForgetDatabaseSyncRequests(xlrec->db_id);
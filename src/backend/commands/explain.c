@@ -21,6 +21,7 @@
 #include "foreign/fdwapi.h"
 #include "jit/jit.h"
 #include "libpq/pqformat.h"
+#include "miscadmin.h"
 #include "nodes/extensible.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
@@ -28,6 +29,8 @@
 #include "parser/parsetree.h"
 #include "rewrite/rewriteHandler.h"
 #include "storage/bufmgr.h"
+#include "storage/procarray.h"
+#include "storage/procsignal.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
 #include "utils/guc_tables.h"
@@ -47,6 +50,9 @@ ExplainOneQuery_hook_type ExplainOneQuery_hook = NULL;
 /* Hook for plugins to get control in explain_get_index_name() */
 explain_get_index_name_hook_type explain_get_index_name_hook = NULL;
 
+/* Is a pg_log_query_plan() request waiting for the next ExecProcNode()? */
+static bool LogQueryPlanRequested = false;
+
 
 /* Instrumentation data for SERIALIZE option */
 typedef struct SerializeMetrics
@@ -121,6 +127,7 @@ static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
 static void show_hash_info(HashState *hashstate, ExplainState *es);
 static void show_memoize_info(MemoizeState *mstate, List *ancestors,
 							  ExplainState *es);
+static void show_subplan_cache_info(SubPlanState *sstate, ExplainState *es);
 static void show_hashagg_info(AggState *aggstate, ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
 								ExplainState *es);
@@ -165,6 +172,8 @@ static void ExplainJSONLineEnding(ExplainState *es);
 static void ExplainYAMLLineStarting(ExplainState *es);
 static void escape_yaml(StringInfo buf, const char *str);
 static SerializeMetrics GetSerializationMetrics(DestReceiver *dest);
+static TupleTableSlot *ExecProcNodeLogQueryPlan(PlanState *node);
+static void LogRunningQueryPlan(QueryDesc *queryDesc);
 
 
 
@@ -1187,6 +1196,166 @@ ExplainQueryParameters(ExplainState *es, ParamListInfo params, int maxlen)
 		ExplainPropertyText("Query Parameters", str, es);
 }
 
+/*
+ * pg_log_query_plan
+ *		Signal a backend to log the plan of the query it is running.
+ *
+ * As with pg_log_backend_memory_contexts(), only superusers are allowed to
+ * do this by default, because issuing such requests at an unbounded rate
+ * could produce lots of log messages.  Additional roles can be permitted
+ * with GRANT.
+ */
+Datum
+pg_log_query_plan(PG_FUNCTION_ARGS)
+{
+	int			pid = PG_GETARG_INT32(0);
+	PGPROC	   *proc;
+
+	proc = BackendPidGetProc(pid);
+	if (proc == NULL)
+	{
+		/*
+		 * This is just a warning so a loop-through-resultset will not abort
+		 * if one backend terminated on its own during the run.
+		 */
+		ereport(WARNING,
+				(errmsg("PID %d is not a PostgreSQL backend process", pid)));
+		PG_RETURN_BOOL(false);
+	}
+
+	if (SendProcSignal(pid, PROCSIG_LOG_QUERY_PLAN,
+					   GetNumberFromPGProc(proc)) < 0)
+	{
+		/* Again, just a warning to allow loops */
+		ereport(WARNING,
+				(errmsg("could not send signal to process %d: %m", pid)));
+		PG_RETURN_BOOL(false);
+	}
+
+	PG_RETURN_BOOL(true);
+}
+
+/*
+ * HandleLogQueryPlanInterrupt
+ *		Handle receipt of an interrupt asking to log the plan of the running
+ *		query.
+ *
+ * All the actual work is deferred to ProcessLogQueryPlanInterrupt(),
+ * because we cannot safely emit a log message inside the signal handler.
+ */
+void
+HandleLogQueryPlanInterrupt(void)
+{
+	InterruptPending = true;
+	LogQueryPlanPending = true;
+	/* latch will be set by procsignal_sigusr1_handler */
+}
+
+/*
+ * ProcessLogQueryPlanInterrupt
+ *		Arrange for the plan of the running query to be logged.
+ *
+ * This is called from CHECK_FOR_INTERRUPTS(), which may be in the middle of
+ * a catalog lookup, a buffer access or anything else during which running
+ * EXPLAIN would not be safe.  So all we do here is intercept the
+ * ExecProcNode() calls of the running query's plan nodes; the plan gets
+ * printed by ExecProcNodeLogQueryPlan(), as soon as the executor asks any of
+ * them for its next tuple.
+ */
+void
+ProcessLogQueryPlanInterrupt(void)
+{
+	LogQueryPlanPending = false;
+
+	if (ActiveQueryDesc == NULL || ActiveQueryDesc->planstate == NULL)
+	{
+		ereport(LOG_SERVER_ONLY,
+				(errhidestmt(true),
+				 errhidecontext(true),
+				 errmsg("backend with PID %d is not running a query",
+						MyProcPid)));
+		return;
+	}
+
+	ExecInterceptProcNodes(ActiveQueryDesc->planstate,
+						   ExecProcNodeLogQueryPlan);
+	LogQueryPlanRequested = true;
+}
+
+/*
+ * ExecProcNode interceptor installed by ProcessLogQueryPlanInterrupt().
+ */
+static TupleTableSlot *
+ExecProcNodeLogQueryPlan(PlanState *node)
+{
+	QueryDesc  *queryDesc = ActiveQueryDesc;
+
+	/*
+	 * Interceptors may be left behind in a plan tree that isn't running
+	 * anymore, or that is being run outside ExecutorRun(), such as when
+	 * ExecutorFinish() completes ModifyTable nodes.  Those just remove
+	 * themselves.
+	 */
+	if (LogQueryPlanRequested &&
+		queryDesc != NULL && queryDesc->estate == node->state)
+	{
+		LogQueryPlanRequested = false;
+		ExecRestoreProcNodes(queryDesc->planstate);
+		LogRunningQueryPlan(queryDesc);
+	}
+	else
+		ExecRestoreProcNode(node);
+
+	return node->ExecProcNode(node);
+}
+
+/*
+ * LogRunningQueryPlan
+ *		Write the plan of a query that is being executed to the server log.
+ *
+ * If the query is being instrumented, e.g. because auto_explain asked for
+ * it, the number of rows each node has returned so far is shown as well.
+ */
+static void
+LogRunningQueryPlan(QueryDesc *queryDesc)
+{
+	ExplainState *es;
+	MemoryContext cxt;
+	MemoryContext oldcxt;
+
+	/* Don't leak EXPLAIN's workspace into the running query's contexts. */
+	cxt = AllocSetContextCreate(CurrentMemoryContext,
+								"log query plan temporary context",
+								ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(cxt);
+
+	es = NewExplainState();
+	es->format = EXPLAIN_FORMAT_TEXT;
+	es->running = true;
+
+	ExplainBeginOutput(es);
+	ExplainQueryText(es, queryDesc);
+	ExplainPrintPlan(es, queryDesc);
+	ExplainEndOutput(es);
+
+	/* Remove last line break */
+	if (es->str->len > 0 && es->str->data[es->str->len - 1] == '\n')
+		es->str->data[--es->str->len] = '\0';
+
+	/*
+	 * Use LOG_SERVER_ONLY to prevent this message from being sent to the
+	 * connected client.
+	 */
+	ereport(LOG_SERVER_ONLY,
+			(errhidestmt(true),
+			 errhidecontext(true),
+			 errmsg("query plan running on backend with PID %d is:\n%s",
+					MyProcPid, es->str->data)));
+
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(cxt);
+}
+
 /*
  * report_triggers -
  *		report execution stats for a single relation's triggers
@@ -1369,9 +1538,13 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	const char *operation = NULL;
 	const char *custom_name = NULL;
 	ExplainWorkersState *save_workers_state = es->workers_state;
+	SubPlanState *subplan_state = es->subplan_state;
 	int			save_indent = es->indent;
 	bool		haschildren;
 
+	/* only meant for this node, not its children */
+	es->subplan_state = NULL;
+
 	/*
 	 * Prepare per-worker output buffers, if needed.  We'll append the data in
 	 * these to the main output string further down.
@@ -1826,9 +1999,10 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	 * even though we didn't ask for it here.  Be careful not to print any
 	 * instrumentation results the user didn't ask for.  But we do the
 	 * InstrEndLoop call anyway, if possible, to reduce the number of cases
-	 * auto_explain has to contend with.
+	 * auto_explain has to contend with.  But not if the query is still
+	 * running, since that would disturb the rest of its execution.
 	 */
-	if (planstate->instrument)
+	if (planstate->instrument && !es->running)
 		InstrEndLoop(planstate->instrument);
 
 	if (es->analyze &&
@@ -1878,6 +2052,17 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			ExplainPropertyFloat("Actual Loops", NULL, 0.0, 0, es);
 		}
 	}
+	else if (es->running && planstate->instrument)
+	{
+		/* rows returned by completed loops, plus the current one */
+		double		rows = planstate->instrument->ntuples +
+			planstate->instrument->tuplecount;
+
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+			appendStringInfo(es->str, " (rows so far=%.0f)", rows);
+		else
+			ExplainPropertyFloat("Rows So Far", NULL, rows, 0, es);
+	}
 
 	/* in text format, first line ends here */
 	if (es->format == EXPLAIN_FORMAT_TEXT)
@@ -2250,6 +2435,10 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			break;
 	}
 
+	/* A memoized SubPlan's cache is shown with the top node of its plan */
+	if (subplan_state)
+		show_subplan_cache_info(subplan_state, es);
+
 	/*
 	 * Prepare per-worker JIT instrumentation.  As with the overall JIT
 	 * summary, this is printed only if printing costs is enabled.
@@ -3457,6 +3646,29 @@ show_memoize_info(MemoizeState *mstate, List *ancestors, ExplainState *es)
 	}
 }
 
+/*
+ * Show the result cache hits and misses of a memoized SubPlan.
+ */
+static void
+show_subplan_cache_info(SubPlanState *sstate, ExplainState *es)
+{
+	if (!es->analyze || sstate->cache == NULL)
+		return;
+
+	if (es->format != EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainPropertyInteger("Cache Hits", NULL, sstate->cache_hits, es);
+		ExplainPropertyInteger("Cache Misses", NULL, sstate->cache_misses, es);
+	}
+	else
+	{
+		ExplainIndentText(es);
+		appendStringInfo(es->str,
+						 "Cache Hits: " UINT64_FORMAT "  Cache Misses: " UINT64_FORMAT "\n",
+						 sstate->cache_hits, sstate->cache_misses);
+	}
+}
+
 /*
  * Show information on hash aggregate memory usage and batches.
  */
@@ -3598,9 +3810,11 @@ show_tidbitmap_info(BitmapHeapScanState *planstate, ExplainState *es)
 			ExplainIndentText(es);
 			appendStringInfoString(es->str, "Heap Blocks:");
 			if (planstate->exact_pages > 0)
-				appendStringInfo(es->str, " exact=%ld", planstate->exact_pages);
+				appendStringInfo(es->str, " exact=" UINT64_FORMAT,
+								 planstate->exact_pages);
 			if (planstate->lossy_pages > 0)
-				appendStringInfo(es->str, " lossy=%ld", planstate->lossy_pages);
+				appendStringInfo(es->str, " lossy=" UINT64_FORMAT,
+								 planstate->lossy_pages);
 			appendStringInfoChar(es->str, '\n');
 		}
 	}
@@ -4438,6 +4652,7 @@ ExplainSubPlans(List *plans, List *ancestors,
 		 */
 		ancestors = lcons(sp, ancestors);
 
+		es->subplan_state = sps;
 		ExplainNode(sps->planstate, ancestors,
 					relationship, sp->plan_name, es);
 
@@ -70,6 +70,7 @@ int			vacuum_multixact_freeze_min_age;
 int			vacuum_multixact_freeze_table_age;
 int			vacuum_failsafe_age;
 int			vacuum_multixact_failsafe_age;
+int			vacuum_freeze_page_wal_age;
 
 /*
  * Variables for cost-based vacuum delay. The defaults differ between
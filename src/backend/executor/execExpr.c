@@ -1210,6 +1210,22 @@ ExecInitExprRec(Expr *node, ExprState *state,
 				FunctionCallInfo fcinfo;
 				AclResult	aclresult;
 				Oid			cmpfuncid;
+				bool		use_hash;
+
+				Assert(list_length(opexpr->args) == 2);
+				scalararg = (Expr *) linitial(opexpr->args);
+				arrayarg = (Expr *) lsecond(opexpr->args);
+
+				/*
+				 * The planner may also ask for hashing when the array is not
+				 * a Const but can't change during execution.  We evaluate
+				 * such an array only once, which is safe only within a plan
+				 * tree: a standalone expression state, such as one used for
+				 * a PL/pgSQL simple expression, can be reused with different
+				 * parameter values.  Fall back to a linear search there.
+				 */
+				use_hash = OidIsValid(opexpr->hashfuncid) &&
+					(IsA(arrayarg, Const) || state->parent != NULL);
 
 				/*
 				 * Select the correct comparison function.  When we do hashed
@@ -1217,18 +1233,11 @@ ExecInitExprRec(Expr *node, ExprState *state,
 				 * comparison function and negfuncid will be set to equality.
 				 * We need to use the equality function for hash probes.
 				 */
-				if (OidIsValid(opexpr->negfuncid))
-				{
-					Assert(OidIsValid(opexpr->hashfuncid));
+				if (use_hash && OidIsValid(opexpr->negfuncid))
 					cmpfuncid = opexpr->negfuncid;
-				}
 				else
 					cmpfuncid = opexpr->opfuncid;
 
-				Assert(list_length(opexpr->args) == 2);
-				scalararg = (Expr *) linitial(opexpr->args);
-				arrayarg = (Expr *) lsecond(opexpr->args);
-
 				/* Check permission to call function */
 				aclresult = object_aclcheck(ProcedureRelationId, cmpfuncid,
 											GetUserId(),
@@ -1238,7 +1247,7 @@ ExecInitExprRec(Expr *node, ExprState *state,
 								   get_func_name(cmpfuncid));
 				InvokeFunctionExecuteHook(cmpfuncid);
 
-				if (OidIsValid(opexpr->hashfuncid))
+				if (use_hash)
 				{
 					aclresult = object_aclcheck(ProcedureRelationId, opexpr->hashfuncid,
 												GetUserId(),
@@ -1264,29 +1273,37 @@ ExecInitExprRec(Expr *node, ExprState *state,
 				 * when the number of items in the array is anything but very
 				 * small.
 				 */
-				if (OidIsValid(opexpr->hashfuncid))
+				if (use_hash)
 				{
 					/* Evaluate scalar directly into left function argument */
 					ExecInitExprRec(scalararg, state,
 									&fcinfo->args[0].value, &fcinfo->args[0].isnull);
 
 					/*
-					 * Evaluate array argument into our return value.  There's
+					 * Evaluate a Const array into our return value.  There's
 					 * no danger in that, because the return value is
 					 * guaranteed to be overwritten by
 					 * EEOP_HASHED_SCALARARRAYOP, and will not be passed to
-					 * any other expression.
+					 * any other expression.  Any other array gets its own
+					 * ExprState, which is evaluated only when the hash table
+					 * is built.
 					 */
-					ExecInitExprRec(arrayarg, state, resv, resnull);
+					if (IsA(arrayarg, Const))
+					{
+						ExecInitExprRec(arrayarg, state, resv, resnull);
+						scratch.d.hashedscalararrayop.arraystate = NULL;
+					}
+					else
+						scratch.d.hashedscalararrayop.arraystate =
+							ExecInitExpr(arrayarg, state->parent);
 
 					/* And perform the operation */
 					scratch.opcode = EEOP_HASHED_SCALARARRAYOP;
 					scratch.d.hashedscalararrayop.inclause = opexpr->useOr;
-					scratch.d.hashedscalararrayop.finfo = finfo;
+					scratch.d.hashedscalararrayop.array_isnull = false;
 					scratch.d.hashedscalararrayop.fcinfo_data = fcinfo;
 					scratch.d.hashedscalararrayop.saop = opexpr;
 
-
 					ExprEvalPushStep(state, &scratch);
 				}
 				else
@@ -2701,7 +2718,14 @@ ExecInitFunc(ExprEvalStep *scratch, Expr *node, List *args, Oid funcid,
 	if (pgstat_track_functions <= flinfo->fn_stats)
 	{
 		if (flinfo->fn_strict && nargs > 0)
-			scratch->opcode = EEOP_FUNCEXPR_STRICT;
+		{
+			if (nargs == 1)
+				scratch->opcode = EEOP_FUNCEXPR_STRICT_1;
+			else if (nargs == 2)
+				scratch->opcode = EEOP_FUNCEXPR_STRICT_2;
+			else
+				scratch->opcode = EEOP_FUNCEXPR_STRICT;
+		}
 		else
 			scratch->opcode = EEOP_FUNCEXPR;
 	}
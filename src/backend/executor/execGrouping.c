@@ -16,6 +16,7 @@
 
 #include "access/parallel.h"
 #include "common/hashfn.h"
+#include "executor/execHashKey.h"
 #include "executor/executor.h"
 #include "miscadmin.h"
 #include "utils/lsyscache.h"
@@ -137,7 +138,7 @@ execTuplesHashPrepare(int numCols,
  *	eqfunctions: equality comparison functions to use
  *	hashfunctions: datatype-specific hashing functions to use
  *	nbuckets: initial estimate of hashtable size
- *	additionalsize: size of data stored in ->additional
+ *	additionalsize: size of per-entry data, see TupleHashEntryGetAdditional()
  *	metacxt: memory context for long-lived allocation, but not per-entry data
  *	tablecxt: memory context in which to store table entries
  *	tempcxt: short-lived context for evaluation hash and comparison functions
@@ -186,6 +187,7 @@ BuildTupleHashTableExt(PlanState *parent,
 	hashtable->tablecxt = tablecxt;
 	hashtable->tempcxt = tempcxt;
 	hashtable->entrysize = entrysize;
+	hashtable->additionalsize = MAXALIGN(additionalsize);
 	hashtable->tableslot = NULL;	/* will be made on first lookup */
 	hashtable->inputslot = NULL;
 	hashtable->in_hash_funcs = NULL;
@@ -467,9 +469,9 @@ TupleHashTableHash_internal(struct tuplehash_hash *tb,
 		{
 			uint32		hkey;
 
-			hkey = DatumGetUInt32(FunctionCall1Coll(&hashfunctions[i],
-													hashtable->tab_collations[i],
-													attr));
+			hkey = ExecHashKeyDatum(&hashfunctions[i],
+									hashtable->tab_collations[i],
+									attr);
 			hashkey ^= hkey;
 		}
 	}
@@ -514,11 +516,33 @@ LookupTupleHashEntry_internal(TupleHashTable hashtable, TupleTableSlot *slot,
 		{
 			/* created new entry */
 			*isnew = true;
-			/* zero caller data */
-			entry->additional = NULL;
-			MemoryContextSwitchTo(hashtable->tablecxt);
-			/* Copy the first tuple into the table context */
-			entry->firstTuple = ExecCopySlotMinimalTuple(slot);
+
+			if (hashtable->additionalsize == 0)
+			{
+				MemoryContextSwitchTo(hashtable->tablecxt);
+				/* Copy the first tuple into the table context */
+				entry->firstTuple = ExecCopySlotMinimalTuple(slot);
+			}
+			else
+			{
+				MinimalTuple mtup;
+				bool		shouldFree;
+				char	   *mem;
+
+				/*
+				 * Copy the first tuple into the table context, with zeroed
+				 * space for the caller's data in front of it, so that the
+				 * two share a chunk and, usually, cache lines.
+				 */
+				mtup = ExecFetchSlotMinimalTuple(slot, &shouldFree);
+				MemoryContextSwitchTo(hashtable->tablecxt);
+				mem = palloc(hashtable->additionalsize + mtup->t_len);
+				memset(mem, 0, hashtable->additionalsize);
+				entry->firstTuple = (MinimalTuple) (mem + hashtable->additionalsize);
+				memcpy(entry->firstTuple, mtup, mtup->t_len);
+				if (shouldFree)
+					pfree(mtup);
+			}
 		}
 	}
 	else
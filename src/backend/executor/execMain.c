@@ -70,6 +70,9 @@ ExecutorEnd_hook_type ExecutorEnd_hook = NULL;
 /* Hook for plugin to get control in ExecCheckPermissions() */
 ExecutorCheckPerms_hook_type ExecutorCheckPerms_hook = NULL;
 
+/* The query currently inside ExecutorRun(), innermost if nested */
+QueryDesc  *ActiveQueryDesc = NULL;
+
 /* decls for local routines only used within this module */
 static void InitPlan(QueryDesc *queryDesc, int eflags);
 static void CheckValidRowMarkRel(Relation rel, RowMarkType markType);
@@ -291,6 +294,9 @@ standard_ExecutorStart(QueryDesc *queryDesc, int eflags)
  *		get control when ExecutorRun is called.  Such a plugin would
  *		normally call standard_ExecutorRun().
  *
+ *		While the query runs, it is published in ActiveQueryDesc, so that
+ *		it can be found by pg_log_query_plan().
+ *
  * ----------------------------------------------------------------
  */
 void
@@ -298,10 +304,22 @@ ExecutorRun(QueryDesc *queryDesc,
 			ScanDirection direction, uint64 count,
 			bool execute_once)
 {
-	if (ExecutorRun_hook)
-		(*ExecutorRun_hook) (queryDesc, direction, count, execute_once);
-	else
-		standard_ExecutorRun(queryDesc, direction, count, execute_once);
+	QueryDesc  *save_ActiveQueryDesc = ActiveQueryDesc;
+
+	ActiveQueryDesc = queryDesc;
+
+	PG_TRY();
+	{
+		if (ExecutorRun_hook)
+			(*ExecutorRun_hook) (queryDesc, direction, count, execute_once);
+		else
+			standard_ExecutorRun(queryDesc, direction, count, execute_once);
+	}
+	PG_FINALLY();
+	{
+		ActiveQueryDesc = save_ActiveQueryDesc;
+	}
+	PG_END_TRY();
 }
 
 void
@@ -1000,8 +1000,10 @@ ExecParallelReInitializeDSM(PlanState *planstate,
 				ExecHashJoinReInitializeDSM((HashJoinState *) planstate,
 											pcxt);
 			break;
-		case T_HashState:
 		case T_SortState:
+			ExecSortReInitializeDSM((SortState *) planstate, pcxt);
+			break;
+		case T_HashState:
 		case T_IncrementalSortState:
 		case T_MemoizeState:
 			/* these nodes have DSM state, but no reinitialization is required */
@@ -122,6 +122,7 @@
 static TupleTableSlot *ExecProcNodeFirst(PlanState *node);
 static TupleTableSlot *ExecProcNodeInstr(PlanState *node);
 static bool ExecShutdownNode_walker(PlanState *node, void *context);
+static bool ExecInterceptProcNodes_walker(PlanState *node, void *context);
 
 
 /* ------------------------------------------------------------------------
@@ -485,6 +486,69 @@ ExecProcNodeInstr(PlanState *node)
 }
 
 
+/*
+ * ExecInterceptProcNodes
+ *
+ * Make every node in the given plan state tree call "function" instead of
+ * its own callback, the next time ExecProcNode() is called on it.  This
+ * gives code that can't safely do its work at an arbitrary point, such as
+ * in a CHECK_FOR_INTERRUPTS(), a way to get control at the next tuple
+ * boundary of a running query.
+ *
+ * The interceptor must call ExecRestoreProcNode() on the node it was called
+ * for (or ExecRestoreProcNodes() on the whole tree), and then continue with
+ * node->ExecProcNode(node) to return the node's tuple.
+ */
+void
+ExecInterceptProcNodes(PlanState *planstate, ExecProcNodeMtd function)
+{
+	(void) ExecInterceptProcNodes_walker(planstate, &function);
+}
+
+/*
+ * ExecRestoreProcNodes
+ *
+ * Undo ExecInterceptProcNodes() for all nodes of the tree.
+ */
+void
+ExecRestoreProcNodes(PlanState *planstate)
+{
+	ExecProcNodeMtd function = NULL;
+
+	(void) ExecInterceptProcNodes_walker(planstate, &function);
+}
+
+/*
+ * ExecRestoreProcNode
+ *
+ * Undo ExecInterceptProcNodes() for one node.
+ */
+void
+ExecRestoreProcNode(PlanState *node)
+{
+	/* let the first-call wrapper reinstall the right callback */
+	node->ExecProcNode = ExecProcNodeFirst;
+}
+
+static bool
+ExecInterceptProcNodes_walker(PlanState *node, void *context)
+{
+	ExecProcNodeMtd function = *(ExecProcNodeMtd *) context;
+
+	if (node == NULL)
+		return false;
+
+	check_stack_depth();
+
+	if (function)
+		node->ExecProcNode = function;
+	else
+		ExecRestoreProcNode(node);
+
+	return planstate_tree_walker(node, ExecInterceptProcNodes_walker, context);
+}
+
+
 /* ----------------------------------------------------------------
  *		MultiExecProcNode
  *
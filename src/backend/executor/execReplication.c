@@ -544,6 +544,67 @@ ExecSimpleRelationInsert(ResultRelInfo *resultRelInfo,
 	}
 }
 
+/*
+ * Insert a batch of tuples, using table_multi_insert() for the table data
+ * and then creating index entries and queuing AFTER ROW triggers for each
+ * tuple, much like COPY FROM does.
+ *
+ * The caller must make sure the relation has no BEFORE or INSTEAD OF ROW
+ * INSERT triggers, since those could modify or suppress individual tuples
+ * and must run before the tuple is stored.  The slots must belong to the
+ * relation's table AM.  Caller is responsible for opening the indexes.
+ */
+void
+ExecSimpleRelationMultiInsert(ResultRelInfo *resultRelInfo,
+							  EState *estate,
+							  TupleTableSlot **slots, int nslots)
+{
+	Relation	rel = resultRelInfo->ri_RelationDesc;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+
+	/* For now we support only tables. */
+	Assert(rel->rd_rel->relkind == RELKIND_RELATION);
+	Assert(resultRelInfo->ri_TrigDesc == NULL ||
+		   (!resultRelInfo->ri_TrigDesc->trig_insert_before_row &&
+			!resultRelInfo->ri_TrigDesc->trig_insert_instead_row));
+
+	CheckCmdReplicaIdentity(rel, CMD_INSERT);
+
+	for (int i = 0; i < nslots; i++)
+	{
+		/* Compute stored generated columns */
+		if (tupdesc->constr && tupdesc->constr->has_generated_stored)
+			ExecComputeStoredGenerated(resultRelInfo, estate, slots[i],
+									   CMD_INSERT);
+
+		/* Check the constraints of the tuple */
+		if (tupdesc->constr)
+			ExecConstraints(resultRelInfo, slots[i], estate);
+		if (rel->rd_rel->relispartition)
+			ExecPartitionCheck(resultRelInfo, slots[i], estate, true);
+	}
+
+	/* OK, store the tuples */
+	table_multi_insert(rel, slots, nslots, estate->es_output_cid, 0, NULL);
+
+	/* ... and create index entries and fire triggers for them */
+	for (int i = 0; i < nslots; i++)
+	{
+		List	   *recheckIndexes = NIL;
+
+		if (resultRelInfo->ri_NumIndices > 0)
+			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
+												   slots[i], estate, false,
+												   false, NULL, NIL, false);
+
+		/* AFTER ROW INSERT Triggers */
+		ExecARInsertTriggers(estate, resultRelInfo, slots[i],
+							 recheckIndexes, NULL);
+
+		list_free(recheckIndexes);
+	}
+}
+
 /*
  * Find the searchslot tuple and update it with data in the slot,
  * update the indexes, and execute any constraints and per-row triggers.
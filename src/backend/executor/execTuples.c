@@ -990,6 +990,37 @@ tts_buffer_heap_store_tuple(TupleTableSlot *slot, HeapTuple tuple,
 	}
 }
 
+/*
+ * slot_compute_nfixed
+ *		Compute the number of leading fixed-width attributes of the slot's
+ *		descriptor, and set their attcacheoff.
+ *
+ * The offsets of these attributes within a tuple depend only on the
+ * descriptor, as long as none of them is null, so slot_deform_heap_tuple()
+ * can fetch them without the per-attribute alignment and caching logic.
+ */
+static pg_noinline void
+slot_compute_nfixed(TupleTableSlot *slot)
+{
+	TupleDesc	tupleDesc = slot->tts_tupleDescriptor;
+	uint32		off = 0;
+	int			attnum;
+
+	for (attnum = 0; attnum < tupleDesc->natts; attnum++)
+	{
+		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
+
+		if (thisatt->attlen <= 0)
+			break;
+
+		off = att_align_nominal(off, thisatt->attalign);
+		thisatt->attcacheoff = off;
+		off += thisatt->attlen;
+	}
+
+	slot->tts_nfixed = attnum;
+}
+
 /*
  * slot_deform_heap_tuple
  *		Given a TupleTableSlot, extract data from the slot's physical tuple
@@ -1042,6 +1073,36 @@ slot_deform_heap_tuple(TupleTableSlot *slot, HeapTuple tuple, uint32 *offp,
 
 	tp = (char *) tup + tup->t_hoff;
 
+	/*
+	 * As long as we haven't seen a null yet, attributes in the leading
+	 * fixed-width run of the descriptor are at their cached offsets, and can
+	 * be fetched with a much simpler loop.  Stop at the first null, and let
+	 * the general loop below take over from there.
+	 */
+	if (!slow)
+	{
+		int			fixedatts;
+
+		if (unlikely(slot->tts_nfixed < 0))
+			slot_compute_nfixed(slot);
+		fixedatts = Min(slot->tts_nfixed, natts);
+
+		for (; attnum < fixedatts; attnum++)
+		{
+			Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
+
+			if (hasnulls && att_isnull(attnum, bp))
+				break;
+
+			Assert(thisatt->attlen > 0 && thisatt->attcacheoff >= 0);
+
+			isnull[attnum] = false;
+			off = thisatt->attcacheoff;
+			values[attnum] = fetchatt(thisatt, tp + off);
+			off += thisatt->attlen;
+		}
+	}
+
 	for (; attnum < natts; attnum++)
 	{
 		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
@@ -1226,6 +1287,7 @@ MakeTupleTableSlot(TupleDesc tupleDesc,
 	slot->tts_tupleDescriptor = tupleDesc;
 	slot->tts_mcxt = CurrentMemoryContext;
 	slot->tts_nvalid = 0;
+	slot->tts_nfixed = -1;
 
 	if (tupleDesc != NULL)
 	{
@@ -1397,6 +1459,7 @@ ExecSetSlotDescriptor(TupleTableSlot *slot, /* slot to change */
 	 * Install the new descriptor; if it's refcounted, bump its refcount.
 	 */
 	slot->tts_tupleDescriptor = tupdesc;
+	slot->tts_nfixed = -1;
 	PinTupleDesc(tupdesc);
 
 	/*
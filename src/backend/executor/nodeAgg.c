@@ -1460,9 +1460,12 @@ find_cols_walker(Node *node, FindColsContext *context)
  * We have a separate hashtable and associated perhash data structure for each
  * grouping set for which we're doing hashing.
  *
- * The contents of the hash tables always live in the hashcontext's per-tuple
- * memory context (there is only one of these for all tables together, since
- * they are all reset at the same time).
+ * The hash table entries (representative tuples plus per-group data) live in
+ * hash_tablecxt, and pass-by-reference transition values in the hashcontext's
+ * per-tuple memory context.  There is only one of each for all tables
+ * together, since they are all reset at the same time.  Entries are never
+ * freed individually, so hash_tablecxt is a bump context, which saves the
+ * chunk header and allocation overhead for each group.
  */
 static void
 build_hash_tables(AggState *aggstate)
@@ -1504,7 +1507,7 @@ build_hash_table(AggState *aggstate, int setno, long nbuckets)
 {
 	AggStatePerHash perhash = &aggstate->perhash[setno];
 	MemoryContext metacxt = aggstate->hash_metacxt;
-	MemoryContext hashcxt = aggstate->hashcontext->ecxt_per_tuple_memory;
+	MemoryContext tablecxt = aggstate->hash_tablecxt;
 	MemoryContext tmpcxt = aggstate->tmpcontext->ecxt_per_tuple_memory;
 	Size		additionalsize;
 
@@ -1529,7 +1532,7 @@ build_hash_table(AggState *aggstate, int setno, long nbuckets)
 												nbuckets,
 												additionalsize,
 												metacxt,
-												hashcxt,
+												tablecxt,
 												tmpcxt,
 												DO_AGGSPLIT_SKIPFINAL(aggstate->aggsplit));
 }
@@ -1694,18 +1697,16 @@ Size
 hash_agg_entry_size(int numTrans, Size tupleWidth, Size transitionSpace)
 {
 	Size		tupleChunkSize;
-	Size		pergroupChunkSize;
 	Size		transitionChunkSize;
 	Size		tupleSize = (MAXALIGN(SizeofMinimalTupleHeader) +
 							 tupleWidth);
 	Size		pergroupSize = numTrans * sizeof(AggStatePerGroupData);
 
-	tupleChunkSize = CHUNKHDRSZ + tupleSize;
-
-	if (pergroupSize > 0)
-		pergroupChunkSize = CHUNKHDRSZ + pergroupSize;
-	else
-		pergroupChunkSize = 0;
+	/*
+	 * The per-group states share the tuple's chunk, which is allocated in a
+	 * bump context and so has no chunk header.
+	 */
+	tupleChunkSize = MAXALIGN(pergroupSize) + tupleSize;
 
 	if (transitionSpace > 0)
 		transitionChunkSize = CHUNKHDRSZ + transitionSpace;
@@ -1715,7 +1716,6 @@ hash_agg_entry_size(int numTrans, Size tupleWidth, Size transitionSpace)
 	return
 		sizeof(TupleHashEntryData) +
 		tupleChunkSize +
-		pergroupChunkSize +
 		transitionChunkSize;
 }
 
@@ -1858,8 +1858,10 @@ hash_agg_check_limits(AggState *aggstate)
 	uint64		ngroups = aggstate->hash_ngroups_current;
 	Size		meta_mem = MemoryContextMemAllocated(aggstate->hash_metacxt,
 													 true);
-	Size		hashkey_mem = MemoryContextMemAllocated(aggstate->hashcontext->ecxt_per_tuple_memory,
-														true);
+	Size		hashkey_mem = MemoryContextMemAllocated(aggstate->hash_tablecxt,
+														true) +
+		MemoryContextMemAllocated(aggstate->hashcontext->ecxt_per_tuple_memory,
+								  true);
 
 	/*
 	 * Don't spill unless there's at least one group in the hash table so we
@@ -1929,7 +1931,8 @@ hash_agg_update_metrics(AggState *aggstate, bool from_tape, int npartitions)
 	meta_mem = MemoryContextMemAllocated(aggstate->hash_metacxt, true);
 
 	/* memory for the group keys and transition states */
-	hashkey_mem = MemoryContextMemAllocated(aggstate->hashcontext->ecxt_per_tuple_memory, true);
+	hashkey_mem = MemoryContextMemAllocated(aggstate->hash_tablecxt, true) +
+		MemoryContextMemAllocated(aggstate->hashcontext->ecxt_per_tuple_memory, true);
 
 	/* memory for read/write tape buffers, if spilled */
 	buffer_mem = npartitions * HASHAGG_WRITE_BUFFER_SIZE;
@@ -2055,11 +2058,7 @@ initialize_hash_entry(AggState *aggstate, TupleHashTable hashtable,
 	if (aggstate->numtrans == 0)
 		return;
 
-	pergroup = (AggStatePerGroup)
-		MemoryContextAlloc(hashtable->tablecxt,
-						   sizeof(AggStatePerGroupData) * aggstate->numtrans);
-
-	entry->additional = pergroup;
+	pergroup = (AggStatePerGroup) TupleHashEntryGetAdditional(hashtable, entry);
 
 	/*
 	 * Initialize aggregates for new tuple group, lookup_hash_entries()
@@ -2123,7 +2122,7 @@ lookup_hash_entries(AggState *aggstate)
 		{
 			if (isnew)
 				initialize_hash_entry(aggstate, hashtable, entry);
-			pergroup[setno] = entry->additional;
+			pergroup[setno] = TupleHashEntryGetAdditional(hashtable, entry);
 		}
 		else
 		{
@@ -2622,6 +2621,7 @@ agg_refill_hash_table(AggState *aggstate)
 
 	/* free memory and reset hash tables */
 	ReScanExprContext(aggstate->hashcontext);
+	MemoryContextReset(aggstate->hash_tablecxt);
 	for (int setno = 0; setno < aggstate->num_hashes; setno++)
 		ResetTupleHashTable(aggstate->perhash[setno].hashtable);
 
@@ -2681,7 +2681,8 @@ agg_refill_hash_table(AggState *aggstate)
 		{
 			if (isnew)
 				initialize_hash_entry(aggstate, perhash->hashtable, entry);
-			aggstate->hash_pergroup[batch->setno] = entry->additional;
+			aggstate->hash_pergroup[batch->setno] =
+				TupleHashEntryGetAdditional(perhash->hashtable, entry);
 			advance_aggregates(aggstate);
 		}
 		else
@@ -2861,7 +2862,8 @@ agg_retrieve_hash_table_in_memory(AggState *aggstate)
 		}
 		ExecStoreVirtualTuple(firstSlot);
 
-		pergroup = (AggStatePerGroup) entry->additional;
+		pergroup = (AggStatePerGroup)
+			TupleHashEntryGetAdditional(perhash->hashtable, entry);
 
 		/*
 		 * Use the representative input tuple for any references to
@@ -3587,6 +3589,9 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		aggstate->hash_metacxt = AllocSetContextCreate(aggstate->ss.ps.state->es_query_cxt,
 													   "HashAgg meta context",
 													   ALLOCSET_DEFAULT_SIZES);
+		aggstate->hash_tablecxt = BumpContextCreate(aggstate->ss.ps.state->es_query_cxt,
+													"HashAgg table context",
+													ALLOCSET_DEFAULT_SIZES);
 		aggstate->hash_spill_rslot = ExecInitExtraTupleSlot(estate, scanDesc,
 															&TTSOpsMinimalTuple);
 		aggstate->hash_spill_wslot = ExecInitExtraTupleSlot(estate, scanDesc,
@@ -4338,6 +4343,11 @@ ExecEndAgg(AggState *node)
 		MemoryContextDelete(node->hash_metacxt);
 		node->hash_metacxt = NULL;
 	}
+	if (node->hash_tablecxt != NULL)
+	{
+		MemoryContextDelete(node->hash_tablecxt);
+		node->hash_tablecxt = NULL;
+	}
 
 	for (transno = 0; transno < node->numtrans; transno++)
 	{
@@ -4454,6 +4464,7 @@ ExecReScanAgg(AggState *node)
 		node->hash_ngroups_current = 0;
 
 		ReScanExprContext(node->hashcontext);
+		MemoryContextReset(node->hash_tablecxt);
 		/* Rebuild an empty hash table */
 		build_hash_tables(node);
 		node->table_filled = false;
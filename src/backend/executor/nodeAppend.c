@@ -63,7 +63,10 @@
 #include "executor/nodeAppend.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "storage/bufmgr.h"
 #include "storage/latch.h"
+#include "utils/rel.h"
+#include "utils/spccache.h"
 
 /* Shared state for parallel-aware Append. */
 struct ParallelAppendState
@@ -87,6 +90,7 @@ static TupleTableSlot *ExecAppend(PlanState *pstate);
 static bool choose_next_subplan_locally(AppendState *node);
 static bool choose_next_subplan_for_leader(AppendState *node);
 static bool choose_next_subplan_for_worker(AppendState *node);
+static void ExecAppendPrefetchSubplan(AppendState *node, int whichplan);
 static void mark_invalid_subplans_as_finished(AppendState *node);
 static void ExecAppendAsyncBegin(AppendState *node);
 static bool ExecAppendAsyncGetNext(AppendState *node, TupleTableSlot **result);
@@ -605,9 +609,50 @@ choose_next_subplan_locally(AppendState *node)
 
 	node->as_whichplan = nextplan;
 
+	/*
+	 * Start the I/O for the subplan after this one, so that it overlaps
+	 * with running this one.
+	 */
+	if (ScanDirectionIsForward(node->ps.state->es_direction))
+	{
+		int			followingplan = bms_next_member(node->as_valid_subplans,
+													nextplan);
+
+		if (followingplan >= 0)
+			ExecAppendPrefetchSubplan(node, followingplan);
+	}
+
 	return true;
 }
 
+/* ----------------------------------------------------------------
+ *		ExecAppendPrefetchSubplan
+ *
+ *		Issue prefetch requests for the first blocks a subplan is going
+ *		to read.  This only knows about plain sequential scans, which will
+ *		read their relation from the start.
+ * ----------------------------------------------------------------
+ */
+static void
+ExecAppendPrefetchSubplan(AppendState *node, int whichplan)
+{
+	PlanState  *subnode = node->appendplans[whichplan];
+	Relation	rel;
+	BlockNumber nblocks;
+
+	if (!IsA(subnode, SeqScanState))
+		return;
+
+	rel = ((ScanState *) subnode)->ss_currentRelation;
+	if (rel == NULL ||
+		get_tablespace_io_concurrency(rel->rd_rel->reltablespace) == 0)
+		return;
+
+	nblocks = Min(RelationGetNumberOfBlocks(rel), io_combine_limit);
+	for (BlockNumber blkno = 0; blkno < nblocks; blkno++)
+		(void) PrefetchBuffer(rel, MAIN_FORKNUM, blkno);
+}
+
 /* ----------------------------------------------------------------
  *		choose_next_subplan_for_leader
  *
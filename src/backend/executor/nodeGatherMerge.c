@@ -104,6 +104,13 @@ ExecInitGatherMerge(GatherMerge *node, EState *estate, int eflags)
 	outerNode = outerPlan(node);
 	outerPlanState(gm_state) = ExecInitNode(outerNode, estate, eflags);
 
+	/*
+	 * If we're merging the output of bounded sorts, they can help each other
+	 * by sharing their progress; see nodeSort.c.
+	 */
+	if (IsA(outerPlanState(gm_state), SortState))
+		((SortState *) outerPlanState(gm_state))->share_bound = true;
+
 	/*
 	 * Leader may access ExecProcNode result directly (if
 	 * need_to_scan_locally), or from workers via tuple queue.  So we can't
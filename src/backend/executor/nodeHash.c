@@ -30,11 +30,13 @@
 #include "access/parallel.h"
 #include "catalog/pg_statistic.h"
 #include "commands/tablespace.h"
+#include "executor/execHashKey.h"
 #include "executor/executor.h"
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
 #include "miscadmin.h"
+#include "pg_trace.h"
 #include "port/atomics.h"
 #include "port/pg_bitutils.h"
 #include "utils/dynahash.h"
@@ -186,6 +188,10 @@ MultiExecPrivateHash(HashState *node)
 				/* Not subject to skew optimization, so insert normally */
 				ExecHashTableInsert(hashtable, slot, hashvalue);
 			}
+			if (hashtable->bloomFilter)
+				bloom_add_element(hashtable->bloomFilter,
+								  (unsigned char *) &hashvalue,
+								  sizeof(hashvalue));
 			hashtable->totalTuples += 1;
 		}
 	}
@@ -246,6 +252,7 @@ MultiExecParallelHash(HashState *node)
 	pstate = hashtable->parallel_state;
 	build_barrier = &pstate->build_barrier;
 	Assert(BarrierPhase(build_barrier) >= PHJ_BUILD_ALLOCATE);
+	TRACE_POSTGRESQL_HASH_PARALLEL_BUILD_START(BarrierPhase(build_barrier));
 	switch (BarrierPhase(build_barrier))
 	{
 		case PHJ_BUILD_ALLOCATE:
@@ -340,6 +347,10 @@ MultiExecParallelHash(HashState *node)
 	if (BarrierPhase(build_barrier) < PHJ_BUILD_FREE)
 		ExecParallelHashEnsureBatchAccessors(hashtable);
 
+	TRACE_POSTGRESQL_HASH_PARALLEL_BUILD_DONE(hashtable->nbatch,
+											  hashtable->nbuckets,
+											  (long) hashtable->partialTuples);
+
 	/*
 	 * The next synchronization point is in ExecHashJoin's HJ_BUILD_HASHTABLE
 	 * case, which will bring the build phase to PHJ_BUILD_RUN (if it isn't
@@ -501,6 +512,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 	hashtable->totalTuples = 0;
 	hashtable->partialTuples = 0;
 	hashtable->skewTuples = 0;
+	hashtable->bloomFilter = NULL;
 	hashtable->innerBatchFile = NULL;
 	hashtable->outerBatchFile = NULL;
 	hashtable->spaceUsed = 0;
@@ -873,6 +885,42 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 }
 
 
+/* ----------------------------------------------------------------
+ *		ExecHashTableCreateBloomFilter
+ *
+ *		create a Bloom filter to be filled with the hash values of all
+ *		inner tuples while the hash table is built
+ *
+ * The hash join consults the filter for each outer tuple before probing
+ * the hash table, and discards tuples whose hash value never occurred on
+ * the inner side without further work.  This is only worthwhile when the
+ * join is expected to spill to batch files, since then every outer tuple
+ * that doesn't belong to the first batch would otherwise be written out and
+ * read back in.  Only the caller knows whether unmatched outer tuples can
+ * be discarded, so it decides whether to call this.
+ *
+ * Must be called before the hash table is built; not supported for
+ * Parallel Hash.  ntuples is the estimated number of inner tuples.
+ * ----------------------------------------------------------------
+ */
+void
+ExecHashTableCreateBloomFilter(HashJoinTable hashtable, double ntuples)
+{
+	MemoryContext oldcxt;
+	int64		bloom_work_mem;
+
+	Assert(hashtable->parallel_state == NULL);
+	Assert(hashtable->totalTuples == 0);
+
+	/* Give the filter up to an eighth of the memory allowed for the table */
+	bloom_work_mem = Min(hashtable->spaceAllowed / 8 / 1024, INT_MAX);
+
+	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+	hashtable->bloomFilter = bloom_create((int64) Max(ntuples, 1.0),
+										  (int) bloom_work_mem, 0);
+	MemoryContextSwitchTo(oldcxt);
+}
+
 /* ----------------------------------------------------------------
  *		ExecHashTableDestroy
  *
@@ -1143,6 +1191,9 @@ ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable)
 					new_nbatch = hashtable->nbatch * 2;
 				}
 
+				TRACE_POSTGRESQL_HASH_PARALLEL_GROW_BATCHES(hashtable->nbatch,
+															new_nbatch);
+
 				/* Allocate new larger generation of batches. */
 				Assert(hashtable->nbatch == pstate->nbatch);
 				ExecParallelHashJoinSetUpBatches(hashtable, new_nbatch);
@@ -1888,7 +1939,7 @@ ExecHashGetHashValue(HashJoinTable hashtable,
 			/* Compute the hash function */
 			uint32		hkey;
 
-			hkey = DatumGetUInt32(FunctionCall1Coll(&hashfunctions[i], hashtable->collations[i], keyval));
+			hkey = ExecHashKeyDatum(&hashfunctions[i], hashtable->collations[i], keyval);
 			hashkey ^= hkey;
 		}
 
@@ -188,6 +188,18 @@
 /* Returns true if doing null-fill on inner relation */
 #define HJ_FILL_INNER(hjstate)	((hjstate)->hj_NullOuterTupleSlot != NULL)
 
+/*
+ * While scanning the outer plan, read this many outer tuples ahead and
+ * prefetch the buckets they will probe, if the hash table has at least
+ * debug_hash_join_prefetch_min_buckets buckets.  The default of
+ * DEFAULT_HASH_JOIN_PREFETCH_MIN_BUCKETS is a bucket array of a few MB, plus
+ * at least as many tuples, so the table is unlikely to fit in CPU caches.
+ */
+#define HJ_PREFETCH_DEPTH		16
+
+/* GUC parameter */
+int			debug_hash_join_prefetch_min_buckets = DEFAULT_HASH_JOIN_PREFETCH_MIN_BUCKETS;
+
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
 												 HashJoinState *hjstate,
 												 uint32 *hashvalue);
@@ -198,6 +210,9 @@ static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
 												 BufFile *file,
 												 uint32 *hashvalue,
 												 TupleTableSlot *tupleSlot);
+static TupleTableSlot *ExecHashJoinPrefetchGetTuple(PlanState *outerNode,
+													HashJoinState *hjstate,
+													uint32 *hashvalue);
 static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
 static bool ExecParallelHashJoinNewBatch(HashJoinState *hjstate);
 static void ExecParallelHashJoinPartitionOuter(HashJoinState *hjstate);
@@ -337,6 +352,16 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 												HJ_FILL_INNER(node));
 				node->hj_HashTable = hashtable;
 
+				/*
+				 * If we expect to spill outer tuples to batch files and
+				 * unmatched outer tuples aren't needed, filter them out
+				 * before they are spilled.
+				 */
+				if (!parallel && !HJ_FILL_OUTER(node) &&
+					hashtable->nbatch > 1)
+					ExecHashTableCreateBloomFilter(hashtable,
+												   hashNode->ps.plan->plan_rows);
+
 				/*
 				 * Execute the Hash node, to build the hash table.  If using
 				 * Parallel Hash, then we'll try to help hashing unless we
@@ -465,6 +490,18 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 				econtext->ecxt_outertuple = outerTupleSlot;
 				node->hj_MatchedOuter = false;
 
+				/*
+				 * If the Bloom filter says no inner tuple has this hash
+				 * value, the outer tuple can't have a match, and we know we
+				 * don't need to emit unmatched outer tuples.  Tuples read
+				 * back from batch files have already passed the filter.
+				 */
+				if (hashtable->bloomFilter && hashtable->curbatch == 0 &&
+					bloom_lacks_element(hashtable->bloomFilter,
+										(unsigned char *) &hashvalue,
+										sizeof(hashvalue)))
+					continue;
+
 				/*
 				 * Find the corresponding bucket for this tuple in the main
 				 * hash table or skew hash table.
@@ -830,6 +867,10 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	 */
 	hjstate->hj_HashTable = NULL;
 	hjstate->hj_FirstOuterTupleSlot = NULL;
+	hjstate->hj_PrefetchSlots = NULL;
+	hjstate->hj_PrefetchHashValues = NULL;
+	hjstate->hj_PrefetchCount = 0;
+	hjstate->hj_PrefetchNext = 0;
 
 	hjstate->hj_CurHashValue = 0;
 	hjstate->hj_CurBucketNo = 0;
@@ -896,6 +937,9 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 
 	if (curbatch == 0)			/* if it is the first pass */
 	{
+		if (hashtable->nbuckets >= debug_hash_join_prefetch_min_buckets)
+			return ExecHashJoinPrefetchGetTuple(outerNode, hjstate, hashvalue);
+
 		/*
 		 * Check to see if first outer tuple was already fetched by
 		 * ExecHashJoin() and not used yet.
@@ -973,7 +1017,14 @@ ExecParallelHashJoinOuterGetTuple(PlanState *outerNode,
 	 * single-batch hash joins.  Otherwise we have to go to batch files, even
 	 * for batch 0.
 	 */
-	if (curbatch == 0 && hashtable->nbatch == 1)
+	if (curbatch == 0 && hashtable->nbatch == 1 &&
+		hashtable->nbuckets >= debug_hash_join_prefetch_min_buckets)
+	{
+		slot = ExecHashJoinPrefetchGetTuple(outerNode, hjstate, hashvalue);
+		if (!TupIsNull(slot))
+			return slot;
+	}
+	else if (curbatch == 0 && hashtable->nbatch == 1)
 	{
 		slot = ExecProcNode(outerNode);
 
@@ -1020,6 +1071,136 @@ ExecParallelHashJoinOuterGetTuple(PlanState *outerNode,
 	return NULL;
 }
 
+/*
+ * ExecHashJoinPrefetchGetTuple
+ *
+ *		Variant of the first-pass part of ExecHashJoinOuterGetTuple() and
+ *		ExecParallelHashJoinOuterGetTuple() for large hash tables.
+ *
+ * When the hash table is much larger than the CPU caches, nearly every probe
+ * misses twice before it can compare anything: once loading the bucket, and
+ * once loading the first tuple in its chain.  Probing one outer tuple at a
+ * time serializes those misses.  Instead, we read HJ_PREFETCH_DEPTH outer
+ * tuples ahead and compute their hash values, prefetching each bucket as we
+ * go, and then prefetch the head of each chain, so that the misses of the
+ * whole group overlap.  The tuples are returned in the order they were read,
+ * so the join produces the same output in the same order.
+ */
+static TupleTableSlot *
+ExecHashJoinPrefetchGetTuple(PlanState *outerNode,
+							 HashJoinState *hjstate,
+							 uint32 *hashvalue)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	ExprContext *econtext = hjstate->js.ps.ps_ExprContext;
+	int			next;
+
+	if (hjstate->hj_PrefetchNext >= hjstate->hj_PrefetchCount)
+	{
+		int			ntuples = 0;
+
+		if (hjstate->hj_PrefetchSlots == NULL)
+		{
+			EState	   *estate = hjstate->js.ps.state;
+			TupleDesc	outerDesc = ExecGetResultType(outerNode);
+			const TupleTableSlotOps *ops = ExecGetResultSlotOps(outerNode, NULL);
+
+			hjstate->hj_PrefetchSlots =
+				palloc(HJ_PREFETCH_DEPTH * sizeof(TupleTableSlot *));
+			for (int i = 0; i < HJ_PREFETCH_DEPTH; i++)
+				hjstate->hj_PrefetchSlots[i] =
+					ExecInitExtraTupleSlot(estate, outerDesc, ops);
+			hjstate->hj_PrefetchHashValues =
+				palloc(HJ_PREFETCH_DEPTH * sizeof(uint32));
+		}
+
+		/* Read ahead, hashing each tuple and prefetching its bucket. */
+		while (ntuples < HJ_PREFETCH_DEPTH)
+		{
+			TupleTableSlot *slot;
+			uint32		hv;
+			int			bucketno;
+			int			batchno;
+
+			/*
+			 * Check to see if first outer tuple was already fetched by
+			 * ExecHashJoin() and not used yet.
+			 */
+			slot = hjstate->hj_FirstOuterTupleSlot;
+			if (!TupIsNull(slot))
+				hjstate->hj_FirstOuterTupleSlot = NULL;
+			else
+				slot = ExecProcNode(outerNode);
+
+			if (TupIsNull(slot))
+				break;
+
+			econtext->ecxt_outertuple = slot;
+			if (!ExecHashGetHashValue(hashtable, econtext,
+									  hjstate->hj_OuterHashKeys,
+									  true, /* outer tuple */
+									  HJ_FILL_OUTER(hjstate),
+									  &hv))
+			{
+				/*
+				 * That tuple couldn't match because of a NULL, so discard it
+				 * and continue with the next one.
+				 */
+				continue;
+			}
+
+			/* the outer plan may reuse its slot, so keep a copy */
+			ExecCopySlot(hjstate->hj_PrefetchSlots[ntuples], slot);
+			hjstate->hj_PrefetchHashValues[ntuples] = hv;
+			ntuples++;
+
+			ExecHashGetBucketAndBatch(hashtable, hv, &bucketno, &batchno);
+			if (batchno != hashtable->curbatch)
+				continue;
+			if (hashtable->parallel_state)
+				pg_prefetch_mem(&hashtable->buckets.shared[bucketno]);
+			else
+				pg_prefetch_mem(&hashtable->buckets.unshared[bucketno]);
+		}
+
+		/* Now that the buckets are on their way, prefetch the chain heads. */
+		for (int i = 0; i < ntuples; i++)
+		{
+			int			bucketno;
+			int			batchno;
+
+			ExecHashGetBucketAndBatch(hashtable,
+									  hjstate->hj_PrefetchHashValues[i],
+									  &bucketno, &batchno);
+			if (batchno != hashtable->curbatch)
+				continue;
+			if (hashtable->parallel_state)
+			{
+				dsa_pointer p;
+
+				p = dsa_pointer_atomic_read(&hashtable->buckets.shared[bucketno]);
+				if (DsaPointerIsValid(p))
+					pg_prefetch_mem(dsa_get_address(hashtable->area, p));
+			}
+			else
+				pg_prefetch_mem(hashtable->buckets.unshared[bucketno]);
+		}
+
+		hjstate->hj_PrefetchCount = ntuples;
+		hjstate->hj_PrefetchNext = 0;
+
+		if (ntuples == 0)
+			return NULL;
+
+		/* remember outer relation is not empty for possible rescan */
+		hjstate->hj_OuterNotEmpty = true;
+	}
+
+	next = hjstate->hj_PrefetchNext++;
+	*hashvalue = hjstate->hj_PrefetchHashValues[next];
+	return hjstate->hj_PrefetchSlots[next];
+}
+
 /*
  * ExecHashJoinNewBatch
  *		switch to a new hashjoin batch
@@ -1334,7 +1515,7 @@ ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
 	{
 		MemoryContext oldctx = MemoryContextSwitchTo(hashtable->spillCxt);
 
-		file = BufFileCreateTemp(false);
+		file = BufFileCreateCompressTemp(false);
 		*fileptr = file;
 
 		MemoryContextSwitchTo(oldctx);
@@ -1470,6 +1651,12 @@ ExecReScanHashJoin(HashJoinState *node)
 	node->hj_MatchedOuter = false;
 	node->hj_FirstOuterTupleSlot = NULL;
 
+	/* Forget any outer tuples read ahead */
+	for (int i = 0; i < node->hj_PrefetchCount; i++)
+		ExecClearTuple(node->hj_PrefetchSlots[i]);
+	node->hj_PrefetchCount = 0;
+	node->hj_PrefetchNext = 0;
+
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
 	 * first ExecProcNode.
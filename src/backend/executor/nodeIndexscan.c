@@ -113,6 +113,7 @@ IndexNext(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		index_enable_heap_prefetch(scandesc);
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -1676,6 +1677,7 @@ ExecIndexScanInitializeDSM(IndexScanState *node,
 								 node->iss_NumScanKeys,
 								 node->iss_NumOrderByKeys,
 								 piscan);
+	index_enable_heap_prefetch(node->iss_ScanDesc);
 
 	/*
 	 * If no run-time keys to calculate or they are ready, go ahead and pass
@@ -1719,6 +1721,7 @@ ExecIndexScanInitializeWorker(IndexScanState *node,
 								 node->iss_NumScanKeys,
 								 node->iss_NumOrderByKeys,
 								 piscan);
+	index_enable_heap_prefetch(node->iss_ScanDesc);
 
 	/*
 	 * If no run-time keys to calculate or they are ready, go ahead and pass
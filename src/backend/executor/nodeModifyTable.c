@@ -62,6 +62,15 @@
 #include "utils/snapmgr.h"
 
 
+/*
+ * Limits on the number of tuples, and their approximate total size, that an
+ * INSERT into a local table buffers before handing them to the table AM.
+ * These match the limits COPY FROM uses for the same purpose.
+ */
+#define MT_MAX_BATCH_TUPLES		1000
+#define MT_MAX_BATCH_BYTES		65535
+
+
 typedef struct MTTargetRelLookup
 {
 	Oid			relationOid;	/* hash key, must be first */
@@ -122,6 +131,12 @@ static void ExecBatchInsert(ModifyTableState *mtstate,
 							int numSlots,
 							EState *estate,
 							bool canSetTag);
+static void ExecBatchInsertAddSlot(ModifyTableState *mtstate,
+								   ResultRelInfo *resultRelInfo,
+								   TupleTableSlot *slot,
+								   TupleTableSlot *planSlot,
+								   EState *estate,
+								   bool canSetTag);
 static void ExecPendingInserts(EState *estate);
 static void ExecCrossPartitionUpdateForeignKey(ModifyTableContext *context,
 											   ResultRelInfo *sourcePartInfo,
@@ -763,7 +778,6 @@ ExecInsert(ModifyTableContext *context,
 	ModifyTable *node = (ModifyTable *) mtstate->ps.plan;
 	OnConflictAction onconflict = node->onConflictAction;
 	PartitionTupleRouting *proute = mtstate->mt_partition_tuple_routing;
-	MemoryContext oldContext;
 
 	/*
 	 * If the input result relation is a partitioned table, find the leaf
@@ -840,88 +854,8 @@ ExecInsert(ModifyTableContext *context,
 		 */
 		if (resultRelInfo->ri_BatchSize > 1)
 		{
-			bool		flushed = false;
-
-			/*
-			 * When we've reached the desired batch size, perform the
-			 * insertion.
-			 */
-			if (resultRelInfo->ri_NumSlots == resultRelInfo->ri_BatchSize)
-			{
-				ExecBatchInsert(mtstate, resultRelInfo,
-								resultRelInfo->ri_Slots,
-								resultRelInfo->ri_PlanSlots,
-								resultRelInfo->ri_NumSlots,
-								estate, canSetTag);
-				flushed = true;
-			}
-
-			oldContext = MemoryContextSwitchTo(estate->es_query_cxt);
-
-			if (resultRelInfo->ri_Slots == NULL)
-			{
-				resultRelInfo->ri_Slots = palloc(sizeof(TupleTableSlot *) *
-												 resultRelInfo->ri_BatchSize);
-				resultRelInfo->ri_PlanSlots = palloc(sizeof(TupleTableSlot *) *
-													 resultRelInfo->ri_BatchSize);
-			}
-
-			/*
-			 * Initialize the batch slots. We don't know how many slots will
-			 * be needed, so we initialize them as the batch grows, and we
-			 * keep them across batches. To mitigate an inefficiency in how
-			 * resource owner handles objects with many references (as with
-			 * many slots all referencing the same tuple descriptor) we copy
-			 * the appropriate tuple descriptor for each slot.
-			 */
-			if (resultRelInfo->ri_NumSlots >= resultRelInfo->ri_NumSlotsInitialized)
-			{
-				TupleDesc	tdesc = CreateTupleDescCopy(slot->tts_tupleDescriptor);
-				TupleDesc	plan_tdesc =
-					CreateTupleDescCopy(planSlot->tts_tupleDescriptor);
-
-				resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots] =
-					MakeSingleTupleTableSlot(tdesc, slot->tts_ops);
-
-				resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots] =
-					MakeSingleTupleTableSlot(plan_tdesc, planSlot->tts_ops);
-
-				/* remember how many batch slots we initialized */
-				resultRelInfo->ri_NumSlotsInitialized++;
-			}
-
-			ExecCopySlot(resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots],
-						 slot);
-
-			ExecCopySlot(resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots],
-						 planSlot);
-
-			/*
-			 * If these are the first tuples stored in the buffers, add the
-			 * target rel and the mtstate to the
-			 * es_insert_pending_result_relations and
-			 * es_insert_pending_modifytables lists respectively, except in
-			 * the case where flushing was done above, in which case they
-			 * would already have been added to the lists, so no need to do
-			 * this.
-			 */
-			if (resultRelInfo->ri_NumSlots == 0 && !flushed)
-			{
-				Assert(!list_member_ptr(estate->es_insert_pending_result_relations,
-										resultRelInfo));
-				estate->es_insert_pending_result_relations =
-					lappend(estate->es_insert_pending_result_relations,
-							resultRelInfo);
-				estate->es_insert_pending_modifytables =
-					lappend(estate->es_insert_pending_modifytables, mtstate);
-			}
-			Assert(list_member_ptr(estate->es_insert_pending_result_relations,
-								   resultRelInfo));
-
-			resultRelInfo->ri_NumSlots++;
-
-			MemoryContextSwitchTo(oldContext);
-
+			ExecBatchInsertAddSlot(mtstate, resultRelInfo, slot, planSlot,
+								   estate, canSetTag);
 			return NULL;
 		}
 
@@ -1005,6 +939,19 @@ ExecInsert(ModifyTableContext *context,
 			  resultRelInfo->ri_TrigDesc->trig_insert_before_row)))
 			ExecPartitionCheck(resultRelInfo, slot, estate, true);
 
+		/*
+		 * If the planner found it safe to batch the insertions, accumulate
+		 * the tuple and let ExecBatchInsert() insert it together with the
+		 * others, along with its index entries and AFTER ROW triggers.
+		 */
+		if (resultRelInfo->ri_BatchSize > 1)
+		{
+			Assert(onconflict == ONCONFLICT_NONE);
+			ExecBatchInsertAddSlot(mtstate, resultRelInfo, slot, planSlot,
+								   estate, canSetTag);
+			return NULL;
+		}
+
 		if (onconflict != ONCONFLICT_NONE && resultRelInfo->ri_NumIndices > 0)
 		{
 			/* Perform a speculative insertion. */
@@ -1202,12 +1149,125 @@ ExecInsert(ModifyTableContext *context,
 	return result;
 }
 
+/* ----------------------------------------------------------------
+ *		ExecBatchInsertAddSlot
+ *
+ *		Add a tuple to resultRelInfo's batch of pending insertions,
+ *		inserting the batch first if it is full.
+ * ----------------------------------------------------------------
+ */
+static void
+ExecBatchInsertAddSlot(ModifyTableState *mtstate,
+					   ResultRelInfo *resultRelInfo,
+					   TupleTableSlot *slot,
+					   TupleTableSlot *planSlot,
+					   EState *estate,
+					   bool canSetTag)
+{
+	TupleTableSlot *batchslot;
+	bool		flushed = false;
+	MemoryContext oldContext;
+
+	/*
+	 * When we've reached the desired batch size, perform the insertion.
+	 */
+	if (resultRelInfo->ri_NumSlots == resultRelInfo->ri_BatchSize ||
+		resultRelInfo->ri_BatchBytes >= MT_MAX_BATCH_BYTES)
+	{
+		ExecBatchInsert(mtstate, resultRelInfo,
+						resultRelInfo->ri_Slots,
+						resultRelInfo->ri_PlanSlots,
+						resultRelInfo->ri_NumSlots,
+						estate, canSetTag);
+		flushed = true;
+	}
+
+	oldContext = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	if (resultRelInfo->ri_Slots == NULL)
+	{
+		resultRelInfo->ri_Slots = palloc(sizeof(TupleTableSlot *) *
+										 resultRelInfo->ri_BatchSize);
+		resultRelInfo->ri_PlanSlots = palloc(sizeof(TupleTableSlot *) *
+											 resultRelInfo->ri_BatchSize);
+	}
+
+	/*
+	 * Initialize the batch slots. We don't know how many slots will be
+	 * needed, so we initialize them as the batch grows, and we keep them
+	 * across batches. To mitigate an inefficiency in how resource owner
+	 * handles objects with many references (as with many slots all
+	 * referencing the same tuple descriptor) we copy the appropriate tuple
+	 * descriptor for each slot.
+	 */
+	if (resultRelInfo->ri_NumSlots >= resultRelInfo->ri_NumSlotsInitialized)
+	{
+		TupleDesc	tdesc = CreateTupleDescCopy(slot->tts_tupleDescriptor);
+		TupleDesc	plan_tdesc =
+			CreateTupleDescCopy(planSlot->tts_tupleDescriptor);
+
+		resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots] =
+			MakeSingleTupleTableSlot(tdesc, slot->tts_ops);
+
+		resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots] =
+			MakeSingleTupleTableSlot(plan_tdesc, planSlot->tts_ops);
+
+		/* remember how many batch slots we initialized */
+		resultRelInfo->ri_NumSlotsInitialized++;
+	}
+
+	batchslot = resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots];
+	ExecCopySlot(batchslot, slot);
+
+	/* Only FDWs look at the plan slots */
+	if (resultRelInfo->ri_FdwRoutine)
+		ExecCopySlot(resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots],
+					 planSlot);
+
+	/*
+	 * For a local table, keep track of roughly how much memory the batch
+	 * holds, so that wide rows don't make us buffer an unreasonable amount.
+	 * We can only tell for heap tuples, which ExecCopySlot() will have
+	 * materialized; for other slot types the tuple count limit alone
+	 * applies.  FDWs choose their own batch size, so leave that alone.
+	 */
+	if (resultRelInfo->ri_FdwRoutine == NULL &&
+		(TTS_IS_HEAPTUPLE(batchslot) || TTS_IS_BUFFERTUPLE(batchslot)))
+		resultRelInfo->ri_BatchBytes +=
+			((HeapTupleTableSlot *) batchslot)->tuple->t_len;
+
+	/*
+	 * If these are the first tuples stored in the buffers, add the target
+	 * rel and the mtstate to the es_insert_pending_result_relations and
+	 * es_insert_pending_modifytables lists respectively, except in the case
+	 * where flushing was done above, in which case they would already have
+	 * been added to the lists, so no need to do this.
+	 */
+	if (resultRelInfo->ri_NumSlots == 0 && !flushed)
+	{
+		Assert(!list_member_ptr(estate->es_insert_pending_result_relations,
+								resultRelInfo));
+		estate->es_insert_pending_result_relations =
+			lappend(estate->es_insert_pending_result_relations,
+					resultRelInfo);
+		estate->es_insert_pending_modifytables =
+			lappend(estate->es_insert_pending_modifytables, mtstate);
+	}
+	Assert(list_member_ptr(estate->es_insert_pending_result_relations,
+						   resultRelInfo));
+
+	resultRelInfo->ri_NumSlots++;
+
+	MemoryContextSwitchTo(oldContext);
+}
+
 /* ----------------------------------------------------------------
  *		ExecBatchInsert
  *
  *		Insert multiple tuples in an efficient way.
- *		Currently, this handles inserting into a foreign table without
- *		RETURNING clause.
+ *		Currently, this handles inserting into a foreign table, or into a
+ *		local table when the planner has marked the INSERT as batchable;
+ *		in either case without RETURNING clause.
  * ----------------------------------------------------------------
  */
 static void
@@ -1224,17 +1284,32 @@ ExecBatchInsert(ModifyTableState *mtstate,
 	TupleTableSlot *slot = NULL;
 	TupleTableSlot **rslots;
 
-	/*
-	 * insert into foreign table: let the FDW do it
-	 */
-	rslots = resultRelInfo->ri_FdwRoutine->ExecForeignBatchInsert(estate,
-																  resultRelInfo,
-																  slots,
-																  planSlots,
-																  &numInserted);
+	if (resultRelInfo->ri_FdwRoutine)
+	{
+		/*
+		 * insert into foreign table: let the FDW do it
+		 */
+		rslots = resultRelInfo->ri_FdwRoutine->ExecForeignBatchInsert(estate,
+																	  resultRelInfo,
+																	  slots,
+																	  planSlots,
+																	  &numInserted);
+	}
+	else
+	{
+		/*
+		 * insert into local table: hand all the tuples to the table AM at
+		 * once, then add their index entries below
+		 */
+		table_multi_insert(resultRelInfo->ri_RelationDesc, slots, numSlots,
+						   estate->es_output_cid, 0, NULL);
+		rslots = slots;
+	}
 
 	for (i = 0; i < numInserted; i++)
 	{
+		List	   *recheckIndexes = NIL;
+
 		slot = rslots[i];
 
 		/*
@@ -1243,10 +1318,20 @@ ExecBatchInsert(ModifyTableState *mtstate,
 		 */
 		slot->tts_tableOid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
 
+		/* insert index entries for tuple */
+		if (resultRelInfo->ri_FdwRoutine == NULL &&
+			resultRelInfo->ri_NumIndices > 0)
+			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
+												   slot, estate, false,
+												   false, NULL, NIL,
+												   false);
+
 		/* AFTER ROW INSERT Triggers */
-		ExecARInsertTriggers(estate, resultRelInfo, slot, NIL,
+		ExecARInsertTriggers(estate, resultRelInfo, slot, recheckIndexes,
 							 mtstate->mt_transition_capture);
 
+		list_free(recheckIndexes);
+
 		/*
 		 * Check any WITH CHECK OPTION constraints from parent views.  See the
 		 * comment in ExecInsert.
@@ -1265,10 +1350,11 @@ ExecBatchInsert(ModifyTableState *mtstate,
 		ExecClearTuple(planSlots[i]);
 	}
 	resultRelInfo->ri_NumSlots = 0;
+	resultRelInfo->ri_BatchBytes = 0;
 }
 
 /*
- * ExecPendingInserts -- flushes all pending inserts to the foreign tables
+ * ExecPendingInserts -- flushes all pending batched inserts
  */
 static void
 ExecPendingInserts(EState *estate)
@@ -4631,6 +4717,12 @@ ExecInitModifyTable(ModifyTable *node, EState *estate, int eflags)
 	 * (a FDW may support batching, but it may be disabled for the
 	 * server/table).
 	 *
+	 * For a plain table, batch the insertions if the planner found that
+	 * nothing in the statement can observe the target table between rows,
+	 * and there are no row triggers that would have to see each row inserted
+	 * before the next one is processed.  AFTER ROW triggers are fine, since
+	 * ExecBatchInsert() queues them as each tuple's index entries are made.
+	 *
 	 * We only do this for INSERT, so that for UPDATE/DELETE the batch size
 	 * remains set to 0.
 	 */
@@ -4648,6 +4740,12 @@ ExecInitModifyTable(ModifyTable *node, EState *estate, int eflags)
 				resultRelInfo->ri_FdwRoutine->GetForeignModifyBatchSize(resultRelInfo);
 			Assert(resultRelInfo->ri_BatchSize >= 1);
 		}
+		else if (node->canBatchInsert &&
+				 resultRelInfo->ri_RelationDesc->rd_rel->relkind == RELKIND_RELATION &&
+				 (resultRelInfo->ri_TrigDesc == NULL ||
+				  (!resultRelInfo->ri_TrigDesc->trig_insert_before_row &&
+				   !resultRelInfo->ri_TrigDesc->trig_insert_instead_row)))
+			resultRelInfo->ri_BatchSize = MT_MAX_BATCH_TUPLES;
 		else
 			resultRelInfo->ri_BatchSize = 1;
 	}
@@ -4696,9 +4794,8 @@ ExecEndModifyTable(ModifyTableState *node)
 														   resultRelInfo);
 
 		/*
-		 * Cleanup the initialized batch slots. This only matters for FDWs
-		 * with batching, but the other cases will have ri_NumSlotsInitialized
-		 * == 0.
+		 * Cleanup the initialized batch slots. This only matters for batched
+		 * inserts, but the other cases will have ri_NumSlotsInitialized == 0.
 		 */
 		for (j = 0; j < resultRelInfo->ri_NumSlotsInitialized; j++)
 		{
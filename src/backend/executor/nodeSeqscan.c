@@ -27,13 +27,19 @@
  */
 #include "postgres.h"
 
+#include "access/heapam.h"
 #include "access/relscan.h"
 #include "access/tableam.h"
+#include "access/transam.h"
+#include "catalog/pg_type.h"
+#include "executor/execScan.h"
 #include "executor/executor.h"
 #include "executor/nodeSeqscan.h"
+#include "utils/lsyscache.h"
 #include "utils/rel.h"
 
 static TupleTableSlot *SeqNext(SeqScanState *node);
+static List *SeqScanPushDownQuals(SeqScanState *node, List *qual);
 
 /* ----------------------------------------------------------------
  *						Scan Support
@@ -53,6 +59,7 @@ SeqNext(SeqScanState *node)
 	EState	   *estate;
 	ScanDirection direction;
 	TupleTableSlot *slot;
+	bool		found;
 
 	/*
 	 * get information from the estate and scan state
@@ -70,16 +77,156 @@ SeqNext(SeqScanState *node)
 		 */
 		scandesc = table_beginscan(node->ss.ss_currentRelation,
 								   estate->es_snapshot,
-								   0, NULL);
+								   node->ss_NumScanKeys, node->ss_ScanKeys);
 		node->ss.ss_currentScanDesc = scandesc;
 	}
 
 	/*
 	 * get the next tuple from the table
 	 */
-	if (table_scan_getnextslot(scandesc, direction, slot))
-		return slot;
-	return NULL;
+	found = table_scan_getnextslot(scandesc, direction, slot);
+
+	/* credit tuples rejected by the scan keys to the filter */
+	if (unlikely(node->ss_NumScanKeys > 0) && node->ss.ps.instrument)
+	{
+		InstrCountFiltered1(node, scandesc->rs_nfiltered);
+		scandesc->rs_nfiltered = 0;
+	}
+
+	return found ? slot : NULL;
+}
+
+/*
+ * SeqScanPushDownQuals -- turn leading simple quals into heap scan keys
+ *
+ * A qual of the form "column op constant" (or "constant op column") on a
+ * fixed-width column can be tested by the heap AM itself while it prepares
+ * each page, straight from the on-page tuple and without storing the tuple
+ * in our slot first.  For selective filters that saves deforming, and even
+ * looking at, most rows.
+ *
+ * The heap AM tests a whole page's worth of tuples at once, including ones
+ * that a LIMIT above us would never have fetched, so the operator must not
+ * be able to fail.  We therefore only accept built-in btree operators whose
+ * function is strict and leakproof.  The key's FmgrInfo has no fn_expr, so
+ * operators declared on polymorphic types, which would need it to resolve
+ * their actual argument types, are rejected too.
+ *
+ * Only a leading run of such quals is converted, so they are still
+ * evaluated before the remaining ones, in the order the planner chose; that
+ * matters for quals coming from security barrier views.  The remaining quals
+ * are returned for ordinary evaluation.
+ */
+static List *
+SeqScanPushDownQuals(SeqScanState *node, List *qual)
+{
+	Relation	rel = node->ss.ss_currentRelation;
+	Index		scanrelid = ((Scan *) node->ss.ps.plan)->scanrelid;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	ScanKey		keys;
+	int			nkeys = 0;
+	ListCell   *lc;
+
+	/*
+	 * Only heap is known to apply scan keys in plain scans, and parallel
+	 * scans and EvalPlanQual rechecks don't pass them down at all.
+	 */
+	if (qual == NIL ||
+		rel->rd_tableam != GetHeapamTableAmRoutine() ||
+		node->ss.ps.plan->parallel_aware ||
+		node->ss.ps.state->es_epq_active != NULL)
+		return qual;
+
+	keys = (ScanKey) palloc(list_length(qual) * sizeof(ScanKeyData));
+
+	foreach(lc, qual)
+	{
+		OpExpr	   *op = (OpExpr *) lfirst(lc);
+		Node	   *leftop;
+		Node	   *rightop;
+		Var		   *var;
+		Const	   *con;
+		Oid			opno;
+		Oid			opfuncid;
+		Oid		   *argtypes;
+		int			nargs;
+		bool		polymorphic = false;
+		List	   *interpretations;
+		Form_pg_attribute attr;
+
+		if (!IsA(op, OpExpr) || list_length(op->args) != 2 ||
+			op->opresulttype != BOOLOID || op->opretset)
+			break;
+
+		leftop = linitial(op->args);
+		rightop = lsecond(op->args);
+		opno = op->opno;
+
+		if (IsA(leftop, Var) && IsA(rightop, Const))
+		{
+			var = (Var *) leftop;
+			con = (Const *) rightop;
+		}
+		else if (IsA(leftop, Const) && IsA(rightop, Var))
+		{
+			/* the scan key must have the column on the left */
+			var = (Var *) rightop;
+			con = (Const *) leftop;
+			opno = get_commutator(opno);
+			if (!OidIsValid(opno))
+				break;
+		}
+		else
+			break;
+
+		if (var->varno != scanrelid || var->varlevelsup != 0 ||
+			var->varattno <= 0 || var->varattno > tupdesc->natts ||
+			con->constisnull)
+			break;
+
+		attr = TupleDescAttr(tupdesc, var->varattno - 1);
+		if (attr->attisdropped || attr->attlen <= 0 ||
+			attr->atttypid != var->vartype)
+			break;
+
+		opfuncid = get_opcode(opno);
+		if (opno >= FirstNormalObjectId ||
+			!func_strict(opfuncid) ||
+			!get_func_leakproof(opfuncid))
+			break;
+
+		get_func_signature(opfuncid, &argtypes, &nargs);
+		for (int i = 0; i < nargs; i++)
+			polymorphic |= IsPolymorphicType(argtypes[i]);
+		pfree(argtypes);
+		if (polymorphic)
+			break;
+
+		interpretations = get_op_btree_interpretation(opno);
+		if (interpretations == NIL)
+			break;
+		list_free_deep(interpretations);
+
+		ScanKeyEntryInitialize(&keys[nkeys++],
+							   0,
+							   var->varattno,
+							   InvalidStrategy,
+							   InvalidOid,
+							   op->inputcollid,
+							   opfuncid,
+							   con->constvalue);
+	}
+
+	if (nkeys == 0)
+	{
+		pfree(keys);
+		return qual;
+	}
+
+	node->ss_NumScanKeys = nkeys;
+	node->ss_ScanKeys = keys;
+
+	return list_copy_tail(qual, nkeys);
 }
 
 /*
@@ -100,8 +247,13 @@ SeqRecheck(SeqScanState *node, TupleTableSlot *slot)
  *
  *		Scans the relation sequentially and returns the next qualifying
  *		tuple.
- *		We call the ExecScan() routine and pass it the appropriate
- *		access method functions.
+ *		We call the ExecScanExtended() routine and pass it the
+ *		appropriate access method functions.
+ *
+ *		This is the most common case, with no qual, no projection and
+ *		no EvalPlanQual; the variants below handle the others, so that
+ *		none of them has to test for these per tuple.  The choice is
+ *		made in ExecInitSeqScan().
  * ----------------------------------------------------------------
  */
 static TupleTableSlot *
@@ -109,6 +261,89 @@ ExecSeqScan(PlanState *pstate)
 {
 	SeqScanState *node = castNode(SeqScanState, pstate);
 
+	Assert(pstate->state->es_epq_active == NULL);
+	Assert(pstate->qual == NULL);
+	Assert(pstate->ps_ProjInfo == NULL);
+
+	return ExecScanExtended(&node->ss,
+							(ExecScanAccessMtd) SeqNext,
+							(ExecScanRecheckMtd) SeqRecheck,
+							NULL,
+							NULL,
+							NULL);
+}
+
+/*
+ * Variant of ExecSeqScan() but when qual evaluation is required.
+ */
+static TupleTableSlot *
+ExecSeqScanWithQual(PlanState *pstate)
+{
+	SeqScanState *node = castNode(SeqScanState, pstate);
+
+	Assert(pstate->state->es_epq_active == NULL);
+	Assert(pstate->qual != NULL);
+	Assert(pstate->ps_ProjInfo == NULL);
+
+	return ExecScanExtended(&node->ss,
+							(ExecScanAccessMtd) SeqNext,
+							(ExecScanRecheckMtd) SeqRecheck,
+							NULL,
+							pstate->qual,
+							NULL);
+}
+
+/*
+ * Variant of ExecSeqScan() but when projection is required.
+ */
+static TupleTableSlot *
+ExecSeqScanWithProject(PlanState *pstate)
+{
+	SeqScanState *node = castNode(SeqScanState, pstate);
+
+	Assert(pstate->state->es_epq_active == NULL);
+	Assert(pstate->qual == NULL);
+	Assert(pstate->ps_ProjInfo != NULL);
+
+	return ExecScanExtended(&node->ss,
+							(ExecScanAccessMtd) SeqNext,
+							(ExecScanRecheckMtd) SeqRecheck,
+							NULL,
+							NULL,
+							pstate->ps_ProjInfo);
+}
+
+/*
+ * Variant of ExecSeqScan() but when qual evaluation and projection are
+ * required.
+ */
+static TupleTableSlot *
+ExecSeqScanWithQualProject(PlanState *pstate)
+{
+	SeqScanState *node = castNode(SeqScanState, pstate);
+
+	Assert(pstate->state->es_epq_active == NULL);
+	Assert(pstate->qual != NULL);
+	Assert(pstate->ps_ProjInfo != NULL);
+
+	return ExecScanExtended(&node->ss,
+							(ExecScanAccessMtd) SeqNext,
+							(ExecScanRecheckMtd) SeqRecheck,
+							NULL,
+							pstate->qual,
+							pstate->ps_ProjInfo);
+}
+
+/*
+ * Variant of ExecSeqScan for when EPQ evaluation is required.  We don't
+ * bother adding variants of this for with/without qual and projection as
+ * EPQ doesn't seem as exciting a case to optimize for.
+ */
+static TupleTableSlot *
+ExecSeqScanEPQ(PlanState *pstate)
+{
+	SeqScanState *node = castNode(SeqScanState, pstate);
+
 	return ExecScan(&node->ss,
 					(ExecScanAccessMtd) SeqNext,
 					(ExecScanRecheckMtd) SeqRecheck);
@@ -137,7 +372,6 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	scanstate = makeNode(SeqScanState);
 	scanstate->ss.ps.plan = (Plan *) node;
 	scanstate->ss.ps.state = estate;
-	scanstate->ss.ps.ExecProcNode = ExecSeqScan;
 
 	/*
 	 * Miscellaneous initialization
@@ -169,7 +403,30 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	 * initialize child expressions
 	 */
 	scanstate->ss.ps.qual =
-		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
+		ExecInitQual(SeqScanPushDownQuals(scanstate, node->scan.plan.qual),
+					 (PlanState *) scanstate);
+
+	/*
+	 * When EvalPlanQual() is not in use, assign ExecProcNode for this node
+	 * based on the presence of qual and projection.  Each ExecSeqScan*()
+	 * variant is optimized for the specific combination of these conditions.
+	 */
+	if (scanstate->ss.ps.state->es_epq_active != NULL)
+		scanstate->ss.ps.ExecProcNode = ExecSeqScanEPQ;
+	else if (scanstate->ss.ps.qual == NULL)
+	{
+		if (scanstate->ss.ps.ps_ProjInfo == NULL)
+			scanstate->ss.ps.ExecProcNode = ExecSeqScan;
+		else
+			scanstate->ss.ps.ExecProcNode = ExecSeqScanWithProject;
+	}
+	else
+	{
+		if (scanstate->ss.ps.ps_ProjInfo == NULL)
+			scanstate->ss.ps.ExecProcNode = ExecSeqScanWithQual;
+		else
+			scanstate->ss.ps.ExecProcNode = ExecSeqScanWithQualProject;
+	}
 
 	return scanstate;
 }
@@ -19,8 +19,48 @@
 #include "executor/execdebug.h"
 #include "executor/nodeSort.h"
 #include "miscadmin.h"
+#include "port/atomics.h"
 #include "utils/tuplesort.h"
 
+/*
+ * When a bounded Sort runs directly below a Gather Merge, the Gather Merge
+ * only needs the first "bound" tuples of the merged output, but each
+ * participant's sort would by itself keep its own first "bound" tuples.
+ * Once any participant has that many, none of the tuples it would reject
+ * can be needed from the other participants either.  So every
+ * participant periodically publishes the leading key of the last tuple in
+ * its bounded heap, and passes the other participants' values to its own
+ * tuplesort as thresholds.  Each participant then discards input as soon
+ * as the best participant could, rather than only once its own heap is
+ * as good.
+ *
+ * Values are exchanged as raw Datums, so this is only done when the leading
+ * sort column is pass-by-value.  Each participant only ever writes its own
+ * slot, and its threshold only ever gets tighter, so a reader seeing an
+ * older value merely filters less.
+ */
+#define SORT_SHARE_BOUND_INTERVAL	1024
+
+/* The shm_toc key, since plan_node_id is taken by SharedSortInfo */
+#define SORT_SHARED_BOUND_KEY(node) \
+	(UINT64CONST(0xD000000000000000) | (uint64) (node)->ss.ps.plan->plan_node_id)
+
+typedef struct SortBoundSlot
+{
+	pg_atomic_uint32 valid;		/* has value been set? */
+	pg_atomic_uint64 value;		/* leading key Datum */
+} SortBoundSlot;
+
+typedef struct SharedSortBound
+{
+	int			nslots;			/* leader, then one per planned worker */
+	SortBoundSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} SharedSortBound;
+
+static bool ExecSortCanShareBound(SortState *node, ParallelContext *pcxt);
+static void ExecSortShareBound(SortState *node,
+							   Tuplesortstate *tuplesortstate);
+
 
 /* ----------------------------------------------------------------
  *		ExecSort
@@ -78,6 +118,8 @@ ExecSort(PlanState *pstate)
 		PlanState  *outerNode;
 		TupleDesc	tupDesc;
 		int			tuplesortopts = TUPLESORT_NONE;
+		bool		share_bound;
+		uint64		ntuples = 0;
 
 		SO1_printf("ExecSort: %s\n",
 				   "sorting subplan");
@@ -123,6 +165,7 @@ ExecSort(PlanState *pstate)
 		if (node->bounded)
 			tuplesort_set_bound(tuplesortstate, node->bound);
 		node->tuplesortstate = (void *) tuplesortstate;
+		share_bound = node->bounded && node->shared_bound != NULL;
 
 		/*
 		 * Scan the subplan and feed all the tuples to tuplesort using the
@@ -140,6 +183,8 @@ ExecSort(PlanState *pstate)
 				tuplesort_putdatum(tuplesortstate,
 								   slot->tts_values[0],
 								   slot->tts_isnull[0]);
+				if (share_bound && ++ntuples % SORT_SHARE_BOUND_INTERVAL == 0)
+					ExecSortShareBound(node, tuplesortstate);
 			}
 		}
 		else
@@ -151,6 +196,8 @@ ExecSort(PlanState *pstate)
 				if (TupIsNull(slot))
 					break;
 				tuplesort_puttupleslot(tuplesortstate, slot);
+				if (share_bound && ++ntuples % SORT_SHARE_BOUND_INTERVAL == 0)
+					ExecSortShareBound(node, tuplesortstate);
 			}
 		}
 
@@ -246,6 +293,8 @@ ExecInitSort(Sort *node, EState *estate, int eflags)
 	sortstate->bounded = false;
 	sortstate->sort_Done = false;
 	sortstate->tuplesortstate = NULL;
+	sortstate->share_bound = false;
+	sortstate->shared_bound = NULL;
 
 	/*
 	 * Miscellaneous initialization
@@ -406,10 +455,62 @@ ExecReScanSort(SortState *node)
  * ----------------------------------------------------------------
  */
 
+/*
+ * Should we set up shared memory for participants to exchange bounds?
+ *
+ * This is called in the leader, whose copy of the node has already been told
+ * its bound if there is one.
+ */
+static bool
+ExecSortCanShareBound(SortState *node, ParallelContext *pcxt)
+{
+	Sort	   *plannode = (Sort *) node->ss.ps.plan;
+	TupleDesc	tupDesc = ExecGetResultType(outerPlanState(node));
+	AttrNumber	attno;
+
+	if (!node->share_bound || !node->bounded || pcxt->nworkers == 0)
+		return false;
+
+	attno = node->datumSort ? 1 : plannode->sortColIdx[0];
+	return TupleDescAttr(tupDesc, attno - 1)->attbyval;
+}
+
+/*
+ * Publish our bounded heap's threshold, and use the other participants'.
+ */
+static void
+ExecSortShareBound(SortState *node, Tuplesortstate *tuplesortstate)
+{
+	SharedSortBound *sb = node->shared_bound;
+	int			myslot = IsParallelWorker() ? ParallelWorkerNumber + 1 : 0;
+	Datum		datum;
+	bool		isnull;
+
+	Assert(myslot < sb->nslots);
+
+	if (tuplesort_get_bound_threshold(tuplesortstate, &datum, &isnull) &&
+		!isnull)
+	{
+		pg_atomic_write_u64(&sb->slots[myslot].value, (uint64) datum);
+		pg_write_barrier();
+		pg_atomic_write_u32(&sb->slots[myslot].valid, 1);
+	}
+
+	for (int i = 0; i < sb->nslots; i++)
+	{
+		if (i == myslot || pg_atomic_read_u32(&sb->slots[i].valid) == 0)
+			continue;
+		pg_read_barrier();
+		datum = (Datum) pg_atomic_read_u64(&sb->slots[i].value);
+		tuplesort_set_bound_threshold(tuplesortstate, datum, false);
+	}
+}
+
 /* ----------------------------------------------------------------
  *		ExecSortEstimate
  *
- *		Estimate space required to propagate sort statistics.
+ *		Estimate space required to propagate sort statistics and to
+ *		share bounds.
  * ----------------------------------------------------------------
  */
 void
@@ -417,7 +518,15 @@ ExecSortEstimate(SortState *node, ParallelContext *pcxt)
 {
 	Size		size;
 
-	/* don't need this if not instrumenting or no workers */
+	if (ExecSortCanShareBound(node, pcxt))
+	{
+		size = mul_size(pcxt->nworkers + 1, sizeof(SortBoundSlot));
+		size = add_size(size, offsetof(SharedSortBound, slots));
+		shm_toc_estimate_chunk(&pcxt->estimator, size);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+
+	/* don't need the rest if not instrumenting or no workers */
 	if (!node->ss.ps.instrument || pcxt->nworkers == 0)
 		return;
 
@@ -430,7 +539,7 @@ ExecSortEstimate(SortState *node, ParallelContext *pcxt)
 /* ----------------------------------------------------------------
  *		ExecSortInitializeDSM
  *
- *		Initialize DSM space for sort statistics.
+ *		Initialize DSM space for sort statistics and shared bounds.
  * ----------------------------------------------------------------
  */
 void
@@ -438,7 +547,24 @@ ExecSortInitializeDSM(SortState *node, ParallelContext *pcxt)
 {
 	Size		size;
 
-	/* don't need this if not instrumenting or no workers */
+	if (ExecSortCanShareBound(node, pcxt))
+	{
+		SharedSortBound *sb;
+
+		size = offsetof(SharedSortBound, slots)
+			+ (pcxt->nworkers + 1) * sizeof(SortBoundSlot);
+		sb = shm_toc_allocate(pcxt->toc, size);
+		sb->nslots = pcxt->nworkers + 1;
+		for (int i = 0; i < sb->nslots; i++)
+		{
+			pg_atomic_init_u32(&sb->slots[i].valid, 0);
+			pg_atomic_init_u64(&sb->slots[i].value, 0);
+		}
+		shm_toc_insert(pcxt->toc, SORT_SHARED_BOUND_KEY(node), sb);
+		node->shared_bound = sb;
+	}
+
+	/* don't need the rest if not instrumenting or no workers */
 	if (!node->ss.ps.instrument || pcxt->nworkers == 0)
 		return;
 
@@ -452,10 +578,28 @@ ExecSortInitializeDSM(SortState *node, ParallelContext *pcxt)
 				   node->shared_info);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSortReInitializeDSM
+ *
+ *		Forget the bounds of the previous scan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSortReInitializeDSM(SortState *node, ParallelContext *pcxt)
+{
+	SharedSortBound *sb = node->shared_bound;
+
+	if (sb == NULL)
+		return;
+
+	for (int i = 0; i < sb->nslots; i++)
+		pg_atomic_write_u32(&sb->slots[i].valid, 0);
+}
+
 /* ----------------------------------------------------------------
  *		ExecSortInitializeWorker
  *
- *		Attach worker to DSM space for sort statistics.
+ *		Attach worker to DSM space for sort statistics and shared bounds.
  * ----------------------------------------------------------------
  */
 void
@@ -463,6 +607,8 @@ ExecSortInitializeWorker(SortState *node, ParallelWorkerContext *pwcxt)
 {
 	node->shared_info =
 		shm_toc_lookup(pwcxt->toc, node->ss.ps.plan->plan_node_id, true);
+	node->shared_bound =
+		shm_toc_lookup(pwcxt->toc, SORT_SHARED_BOUND_KEY(node), true);
 	node->am_worker = true;
 }
 
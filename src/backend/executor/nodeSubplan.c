@@ -29,6 +29,7 @@
 #include <math.h>
 
 #include "access/htup_details.h"
+#include "common/hashfn.h"
 #include "executor/executor.h"
 #include "executor/nodeSubplan.h"
 #include "miscadmin.h"
@@ -36,9 +37,49 @@
 #include "nodes/nodeFuncs.h"
 #include "optimizer/optimizer.h"
 #include "utils/array.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 
+/*
+ * Cache of results of a memoized SubPlan, keyed by the values of its
+ * parameters.  Values are compared by their binary image, so that we never
+ * return a result computed for a value that is merely equal, but might
+ * behave differently inside the subplan (think 1.0 and 1.00).
+ */
+typedef struct SubPlanCacheKey
+{
+	Datum	   *values;
+	bool	   *isnull;
+} SubPlanCacheKey;
+
+typedef struct SubPlanCacheEntry
+{
+	SubPlanCacheKey key;		/* parameter values */
+	Datum		result;			/* result for those parameters */
+	bool		resultnull;
+	uint32		hash;			/* hash value of key */
+	char		status;			/* hash status */
+} SubPlanCacheEntry;
+
+static uint32 subplan_cache_hash_key(struct subplan_cache_hash *tb,
+									 SubPlanCacheKey key);
+static bool subplan_cache_key_equal(struct subplan_cache_hash *tb,
+									SubPlanCacheKey a, SubPlanCacheKey b);
+
+#define SH_PREFIX subplan_cache
+#define SH_ELEMENT_TYPE SubPlanCacheEntry
+#define SH_KEY_TYPE SubPlanCacheKey
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) subplan_cache_hash_key(tb, key)
+#define SH_EQUAL(tb, a, b) subplan_cache_key_equal(tb, a, b)
+#define SH_SCOPE static inline
+#define SH_STORE_HASH
+#define SH_GET_HASH(tb, a) a->hash
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
 static Datum ExecHashSubPlan(SubPlanState *node,
 							 ExprContext *econtext,
 							 bool *isNull);
@@ -50,6 +91,10 @@ static bool findPartialMatch(TupleHashTable hashtable, TupleTableSlot *slot,
 							 FmgrInfo *eqfunctions);
 static bool slotAllNulls(TupleTableSlot *slot);
 static bool slotNoNulls(TupleTableSlot *slot);
+static SubPlanCacheEntry *ExecSubPlanCacheLookup(SubPlanState *node,
+												 ExprContext *econtext);
+static void ExecSubPlanCacheStore(SubPlanState *node, Datum result,
+								  bool isnull);
 
 
 /* ----------------------------------------------------------------
@@ -265,6 +310,23 @@ ExecScanSubPlan(SubPlanState *node,
 		planstate->chgParam = bms_add_member(planstate->chgParam, paramid);
 	}
 
+	/*
+	 * If we've been called with the same parameter values before, we already
+	 * know the answer.
+	 */
+	if (node->cache != NULL)
+	{
+		SubPlanCacheEntry *entry = ExecSubPlanCacheLookup(node, econtext);
+
+		if (entry != NULL)
+		{
+			node->cache_hits++;
+			MemoryContextSwitchTo(oldcontext);
+			*isNull = entry->resultnull;
+			return entry->result;
+		}
+	}
+
 	/*
 	 * Now that we've set up its parameters, we can reset the subplan.
 	 */
@@ -494,9 +556,130 @@ ExecScanSubPlan(SubPlanState *node,
 		}
 	}
 
+	if (node->cache != NULL)
+	{
+		node->cache_misses++;
+		ExecSubPlanCacheStore(node, result, *isNull);
+	}
+
 	return result;
 }
 
+/*
+ * Hash and equality functions for the keys of the memoized results.
+ */
+static uint32
+subplan_cache_hash_key(struct subplan_cache_hash *tb, SubPlanCacheKey key)
+{
+	SubPlanState *node = (SubPlanState *) tb->private_data;
+	uint32		hashkey = 0;
+
+	for (int i = 0; i < node->numParams; i++)
+	{
+		uint32		hkey = 0;
+
+		if (!key.isnull[i])
+			hkey = datum_image_hash(key.values[i], node->param_typbyval[i],
+									node->param_typlen[i]);
+		hashkey = hash_combine(hashkey, hkey);
+	}
+
+	return murmurhash32(hashkey);
+}
+
+static bool
+subplan_cache_key_equal(struct subplan_cache_hash *tb, SubPlanCacheKey a,
+						SubPlanCacheKey b)
+{
+	SubPlanState *node = (SubPlanState *) tb->private_data;
+
+	for (int i = 0; i < node->numParams; i++)
+	{
+		if (a.isnull[i] != b.isnull[i])
+			return false;
+		if (!a.isnull[i] &&
+			!datum_image_eq(a.values[i], b.values[i],
+							node->param_typbyval[i], node->param_typlen[i]))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Look up the memoized result for the current values of the subplan's
+ * parameters, which the caller has just set.  Returns NULL if there is none.
+ */
+static SubPlanCacheEntry *
+ExecSubPlanCacheLookup(SubPlanState *node, ExprContext *econtext)
+{
+	SubPlanCacheKey key;
+	int			i = 0;
+	ListCell   *l;
+
+	foreach(l, node->subplan->parParam)
+	{
+		ParamExecData *prm = &(econtext->ecxt_param_exec_vals[lfirst_int(l)]);
+
+		node->param_values[i] = prm->value;
+		node->param_isnull[i] = prm->isnull;
+		i++;
+	}
+
+	key.values = node->param_values;
+	key.isnull = node->param_isnull;
+	return subplan_cache_lookup(node->cache, key);
+}
+
+/*
+ * Remember the result for the parameter values that the preceding
+ * ExecSubPlanCacheLookup() call didn't find.
+ *
+ * We don't bother with any eviction policy: if the cache has used up
+ * hash_mem, we just empty it and start over.
+ */
+static void
+ExecSubPlanCacheStore(SubPlanState *node, Datum result, bool isnull)
+{
+	MemoryContext oldcontext;
+	SubPlanCacheEntry *entry;
+	SubPlanCacheKey key;
+	bool		found;
+
+	if (MemoryContextMemAllocated(node->cachecxt, false) >
+		get_hash_memory_limit())
+	{
+		MemoryContextReset(node->cachecxt);
+		node->cache = subplan_cache_create(node->cachecxt, 64, node);
+	}
+
+	oldcontext = MemoryContextSwitchTo(node->cachecxt);
+
+	key.values = palloc(node->numParams * sizeof(Datum));
+	key.isnull = palloc(node->numParams * sizeof(bool));
+	for (int i = 0; i < node->numParams; i++)
+	{
+		key.isnull[i] = node->param_isnull[i];
+		if (key.isnull[i])
+			key.values[i] = (Datum) 0;
+		else
+			key.values[i] = datumCopy(node->param_values[i],
+									  node->param_typbyval[i],
+									  node->param_typlen[i]);
+	}
+
+	entry = subplan_cache_insert(node->cache, key, &found);
+	Assert(!found);
+	entry->resultnull = isnull;
+	if (isnull)
+		entry->result = (Datum) 0;
+	else
+		entry->result = datumCopy(result, node->result_typbyval,
+								  node->result_typlen);
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
 /*
  * buildSubPlanHash: load hash table by scanning subplan output.
  */
@@ -865,6 +1048,62 @@ ExecInitSubPlan(SubPlan *subplan, PlanState *parent)
 	sstate->tab_collations = NULL;
 	sstate->lhs_hash_funcs = NULL;
 	sstate->cur_eq_funcs = NULL;
+	sstate->cache = NULL;
+	sstate->cachecxt = NULL;
+	sstate->cache_hits = 0;
+	sstate->cache_misses = 0;
+
+	/*
+	 * If the planner asked us to memoize the results of a correlated
+	 * subplan, set up the cache.  That's only safe if the subplan's output
+	 * depends on nothing but the parameters we pass down to it.
+	 */
+	if (subplan->memoize && !subplan->useHashTable &&
+		subplan->setParam == NIL && subplan->parParam != NIL)
+	{
+		Bitmapset  *parParams = NULL;
+		ListCell   *l;
+		int			i;
+
+		foreach(l, subplan->parParam)
+			parParams = bms_add_member(parParams, lfirst_int(l));
+
+		if (bms_is_subset(sstate->planstate->plan->extParam, parParams))
+		{
+			sstate->numParams = list_length(subplan->parParam);
+			sstate->param_typlen = (int16 *)
+				palloc(sstate->numParams * sizeof(int16));
+			sstate->param_typbyval = (bool *)
+				palloc(sstate->numParams * sizeof(bool));
+			sstate->param_values = (Datum *)
+				palloc(sstate->numParams * sizeof(Datum));
+			sstate->param_isnull = (bool *)
+				palloc(sstate->numParams * sizeof(bool));
+
+			i = 0;
+			foreach(l, subplan->args)
+			{
+				get_typlenbyval(exprType(lfirst(l)),
+								&sstate->param_typlen[i],
+								&sstate->param_typbyval[i]);
+				i++;
+			}
+
+			if (subplan->subLinkType == EXISTS_SUBLINK)
+				get_typlenbyval(BOOLOID, &sstate->result_typlen,
+								&sstate->result_typbyval);
+			else
+				get_typlenbyval(subplan->firstColType, &sstate->result_typlen,
+								&sstate->result_typbyval);
+
+			sstate->cachecxt =
+				AllocSetContextCreate(CurrentMemoryContext,
+									  "Subplan Memoize Context",
+									  ALLOCSET_DEFAULT_SIZES);
+			sstate->cache = subplan_cache_create(sstate->cachecxt, 64, sstate);
+		}
+		bms_free(parParams);
+	}
 
 	/*
 	 * If this is an initplan, it has output parameters that the parent plan
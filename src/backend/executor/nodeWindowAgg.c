@@ -118,6 +118,7 @@ typedef struct WindowStatePerAggData
 	FmgrInfo	transfn;
 	FmgrInfo	invtransfn;
 	FmgrInfo	finalfn;
+	FmgrInfo	combinefn;		/* only valid if use_segtree */
 
 	int			numFinalArgs;	/* number of arguments to pass to finalfn */
 
@@ -157,6 +158,15 @@ typedef struct WindowStatePerAggData
 
 	/* Data local to eval_windowaggregates() */
 	bool		restart;		/* need to restart this agg in this cycle? */
+
+	/*
+	 * Segment tree of transition values over the rows of the partition, see
+	 * eval_windowaggregates_segtree().  Node i combines nodes 2i and 2i+1;
+	 * the leaves are at segtree_rows .. 2 * segtree_rows - 1.
+	 */
+	bool		use_segtree;	/* can this agg use a segment tree? */
+	Datum	   *segtree_values;
+	bool	   *segtree_isnull;
 } WindowStatePerAggData;
 
 static void initialize_windowaggregate(WindowAggState *winstate,
@@ -174,6 +184,12 @@ static void finalize_windowaggregate(WindowAggState *winstate,
 									 Datum *result, bool *isnull);
 
 static void eval_windowaggregates(WindowAggState *winstate);
+static bool eval_windowaggregates_segtree(WindowAggState *winstate);
+static void build_segtrees(WindowAggState *winstate);
+static void combine_segtree_values(WindowAggState *winstate,
+								   WindowStatePerAgg peraggstate,
+								   Datum *value, bool *isnull,
+								   Datum value2, bool isnull2);
 static void eval_windowfunction(WindowAggState *winstate,
 								WindowStatePerFunc perfuncstate,
 								Datum *result, bool *isnull);
@@ -678,6 +694,9 @@ eval_windowaggregates(WindowAggState *winstate)
 	if (numaggs == 0)
 		return;					/* nothing to do */
 
+	if (winstate->use_segtree && eval_windowaggregates_segtree(winstate))
+		return;
+
 	/* final output execution is in ps_ExprContext */
 	econtext = winstate->ss.ps.ps_ExprContext;
 	agg_winobj = winstate->agg_winobj;
@@ -1020,6 +1039,247 @@ next_tuple:
 	}
 }
 
+/*
+ * eval_windowaggregates_segtree
+ * evaluate plain aggregates using segment trees
+ *
+ * When the frame head can move and the aggregates have no inverse transition
+ * function, eval_windowaggregates() has to aggregate the whole frame again
+ * whenever the head moves, costing O(frame size) per row.  If the aggregates
+ * have combine functions instead, we can build a segment tree of transition
+ * values over the partition once, and then obtain the transition value for
+ * any frame by combining at most 2 * log2(N) tree nodes.
+ *
+ * This requires the whole partition to be spooled, and the trees to fit in
+ * work_mem; if they don't, we return false and the caller falls back to the
+ * regular method for the rest of the partition.  To find that out, we
+ * spool at most one row more than the trees could hold, so that a large
+ * partition is not read into the tuplestore far ahead of the current frame.
+ */
+static bool
+eval_windowaggregates_segtree(WindowAggState *winstate)
+{
+	ExprContext *econtext = winstate->ss.ps.ps_ExprContext;
+	int64		nrows;
+	int64		lo,
+				hi;
+	int			i;
+
+	if (winstate->segtree_rows < 0)
+	{
+		int64		maxrows;
+
+		/* each row takes two tree nodes per aggregate */
+		maxrows = (int64) work_mem * 1024 /
+			(winstate->numaggs * 2 * (sizeof(Datum) + sizeof(bool)));
+
+		/* spooling "up to and including maxrows" tells us if there's more */
+		spool_tuples(winstate, maxrows);
+		nrows = winstate->spooled_rows;
+		if (!winstate->partition_spooled || nrows > maxrows)
+		{
+			winstate->segtree_rows = 0;
+			return false;
+		}
+		winstate->segtree_rows = nrows;
+		build_segtrees(winstate);
+	}
+	else if (winstate->segtree_rows == 0)
+		return false;
+
+	nrows = winstate->segtree_rows;
+
+	update_frameheadpos(winstate);
+	update_frametailpos(winstate);
+
+	/* Let the tuplestore discard rows before the frame head */
+	if (winstate->agg_winobj->markptr >= 0)
+		WinSetMarkPosition(winstate->agg_winobj, winstate->frameheadpos);
+
+	lo = Max(winstate->frameheadpos, 0) + nrows;
+	hi = Min(winstate->frametailpos, nrows) + nrows;
+
+	for (i = 0; i < winstate->numaggs; i++)
+	{
+		WindowStatePerAgg peraggstate = &winstate->peragg[i];
+		int			wfuncno = peraggstate->wfuncno;
+		Datum		leftValue = peraggstate->initValue;
+		bool		leftIsNull = peraggstate->initValueIsNull;
+		Datum		rightValue = peraggstate->initValue;
+		bool		rightIsNull = peraggstate->initValueIsNull;
+		int64		l = lo,
+					r = hi;
+
+		/*
+		 * Walk up from the leaves, combining the nodes that cover [l, r).
+		 * Keep the left and right parts separate, so that the rows are
+		 * combined in their original order.
+		 */
+		while (l < r)
+		{
+			if (l & 1)
+			{
+				combine_segtree_values(winstate, peraggstate,
+									   &leftValue, &leftIsNull,
+									   peraggstate->segtree_values[l],
+									   peraggstate->segtree_isnull[l]);
+				l++;
+			}
+			if (r & 1)
+			{
+				Datum		value;
+				bool		isnull;
+
+				r--;
+				value = peraggstate->segtree_values[r];
+				isnull = peraggstate->segtree_isnull[r];
+				combine_segtree_values(winstate, peraggstate,
+									   &value, &isnull,
+									   rightValue, rightIsNull);
+				rightValue = value;
+				rightIsNull = isnull;
+			}
+			l >>= 1;
+			r >>= 1;
+		}
+		combine_segtree_values(winstate, peraggstate,
+							   &leftValue, &leftIsNull,
+							   rightValue, rightIsNull);
+
+		peraggstate->transValue = leftValue;
+		peraggstate->transValueIsNull = leftIsNull;
+		finalize_windowaggregate(winstate, &winstate->perfunc[wfuncno],
+								 peraggstate,
+								 &econtext->ecxt_aggvalues[wfuncno],
+								 &econtext->ecxt_aggnulls[wfuncno]);
+	}
+
+	ResetExprContext(winstate->tmpcontext);
+
+	return true;
+}
+
+/*
+ * build_segtrees
+ * build the segment trees of all aggregates for the current partition
+ *
+ * Each leaf holds the transition value of a single row, and each inner node
+ * the combination of its two children.
+ */
+static void
+build_segtrees(WindowAggState *winstate)
+{
+	WindowObject agg_winobj = winstate->agg_winobj;
+	TupleTableSlot *agg_row_slot = winstate->agg_row_slot;
+	int64		nrows = winstate->segtree_rows;
+	int64		pos;
+	int			i;
+
+	for (i = 0; i < winstate->numaggs; i++)
+	{
+		WindowStatePerAgg peraggstate = &winstate->peragg[i];
+
+		peraggstate->segtree_values = (Datum *)
+			MemoryContextAllocHuge(winstate->partcontext,
+								   2 * nrows * sizeof(Datum));
+		peraggstate->segtree_isnull = (bool *)
+			MemoryContextAllocHuge(winstate->partcontext,
+								   2 * nrows * sizeof(bool));
+	}
+
+	for (pos = 0; pos < nrows; pos++)
+	{
+		if (!window_gettupleslot(agg_winobj, pos, agg_row_slot))
+			elog(ERROR, "could not re-fetch previously fetched partition row");
+
+		/* Set tuple context for evaluation of aggregate arguments */
+		winstate->tmpcontext->ecxt_outertuple = agg_row_slot;
+
+		for (i = 0; i < winstate->numaggs; i++)
+		{
+			WindowStatePerAgg peraggstate = &winstate->peragg[i];
+
+			initialize_windowaggregate(winstate,
+									   &winstate->perfunc[peraggstate->wfuncno],
+									   peraggstate);
+			advance_windowaggregate(winstate,
+									&winstate->perfunc[peraggstate->wfuncno],
+									peraggstate);
+			peraggstate->segtree_values[nrows + pos] = peraggstate->transValue;
+			peraggstate->segtree_isnull[nrows + pos] = peraggstate->transValueIsNull;
+		}
+
+		ResetExprContext(winstate->tmpcontext);
+		ExecClearTuple(agg_row_slot);
+	}
+
+	for (pos = nrows - 1; pos > 0; pos--)
+	{
+		for (i = 0; i < winstate->numaggs; i++)
+		{
+			WindowStatePerAgg peraggstate = &winstate->peragg[i];
+			Datum		value = peraggstate->segtree_values[2 * pos];
+			bool		isnull = peraggstate->segtree_isnull[2 * pos];
+
+			combine_segtree_values(winstate, peraggstate, &value, &isnull,
+								   peraggstate->segtree_values[2 * pos + 1],
+								   peraggstate->segtree_isnull[2 * pos + 1]);
+			peraggstate->segtree_values[pos] = value;
+			peraggstate->segtree_isnull[pos] = isnull;
+		}
+		ResetExprContext(winstate->tmpcontext);
+	}
+}
+
+/*
+ * combine_segtree_values
+ * combine value2 into *value using the aggregate's combine function
+ *
+ * Since we only use segment trees for pass-by-value transition types, there's
+ * no memory to manage.
+ */
+static void
+combine_segtree_values(WindowAggState *winstate,
+					   WindowStatePerAgg peraggstate,
+					   Datum *value, bool *isnull,
+					   Datum value2, bool isnull2)
+{
+	LOCAL_FCINFO(fcinfo, 2);
+	MemoryContext oldContext;
+	Datum		newVal;
+
+	if (peraggstate->combinefn.fn_strict)
+	{
+		/* same rules as for a strict combine function in nodeAgg.c */
+		if (isnull2)
+			return;
+		if (*isnull)
+		{
+			*value = value2;
+			*isnull = false;
+			return;
+		}
+	}
+
+	oldContext = MemoryContextSwitchTo(winstate->tmpcontext->ecxt_per_tuple_memory);
+
+	InitFunctionCallInfoData(*fcinfo, &(peraggstate->combinefn), 2,
+							 winstate->perfunc[peraggstate->wfuncno].winCollation,
+							 (void *) winstate, NULL);
+	fcinfo->args[0].value = *value;
+	fcinfo->args[0].isnull = *isnull;
+	fcinfo->args[1].value = value2;
+	fcinfo->args[1].isnull = isnull2;
+	winstate->curaggcontext = peraggstate->aggcontext;
+	newVal = FunctionCallInvoke(fcinfo);
+	winstate->curaggcontext = NULL;
+
+	MemoryContextSwitchTo(oldContext);
+
+	*value = newVal;
+	*isnull = fcinfo->isnull;
+}
+
 /*
  * eval_windowfunction
  *
@@ -1099,6 +1359,7 @@ begin_partition(WindowAggState *winstate)
 	winstate->frametailgroup = 0;
 	winstate->groupheadpos = 0;
 	winstate->grouptailpos = -1;	/* see update_grouptailpos */
+	winstate->segtree_rows = -1;
 	ExecClearTuple(winstate->agg_row_slot);
 	if (winstate->framehead_slot)
 		ExecClearTuple(winstate->framehead_slot);
@@ -2635,6 +2896,18 @@ ExecInitWindowAgg(WindowAgg *node, EState *estate, int eflags)
 	winstate->numfuncs = wfuncno + 1;
 	winstate->numaggs = aggno + 1;
 
+	/*
+	 * The aggregates are advanced together, so we can only use segment trees
+	 * if all of them can.
+	 */
+	winstate->use_segtree = (winstate->numaggs > 0);
+	for (aggno = 0; aggno < winstate->numaggs; aggno++)
+	{
+		if (!winstate->peragg[aggno].use_segtree)
+			winstate->use_segtree = false;
+	}
+	winstate->segtree_rows = -1;
+
 	/* Set up WindowObject for aggregates, if needed */
 	if (winstate->numaggs > 0)
 	{
@@ -2756,6 +3029,7 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 	Oid			aggtranstype;
 	AttrNumber	initvalAttNo;
 	AclResult	aclresult;
+	Oid			aggOwner;
 	bool		use_ma_code;
 	Oid			transfn_oid,
 				invtransfn_oid,
@@ -2843,7 +3117,6 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 	/* Check that aggregate owner has permission to call component fns */
 	{
 		HeapTuple	procTuple;
-		Oid			aggOwner;
 
 		procTuple = SearchSysCache1(PROCOID,
 									ObjectIdGetDatum(wfunc->winfnoid));
@@ -2947,6 +3220,49 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 					&peraggstate->transtypeLen,
 					&peraggstate->transtypeByVal);
 
+	/*
+	 * If the frame head can move but we're not using moving-aggregate code,
+	 * see if the aggregate can use a segment tree instead, which needs a
+	 * combine function.  We only do that for pass-by-value transition types
+	 * (other than "internal"), so that tree nodes need no memory management,
+	 * and not with an EXCLUSION clause, which can make the frame
+	 * non-contiguous.  The same volatility concerns as above apply.
+	 */
+	peraggstate->use_segtree = false;
+	if (!use_ma_code &&
+		OidIsValid(aggform->aggcombinefn) &&
+		!(winstate->frameOptions & (FRAMEOPTION_START_UNBOUNDED_PRECEDING |
+									FRAMEOPTION_EXCLUSION)) &&
+		peraggstate->transtypeByVal && aggtranstype != INTERNALOID &&
+		!contain_volatile_functions((Node *) wfunc) &&
+		!contain_subplans((Node *) wfunc))
+	{
+		Oid			combinefn_oid = aggform->aggcombinefn;
+		Expr	   *combinefnexpr;
+
+		aclresult = object_aclcheck(ProcedureRelationId, combinefn_oid,
+									aggOwner, ACL_EXECUTE);
+		if (aclresult != ACLCHECK_OK)
+			aclcheck_error(aclresult, OBJECT_FUNCTION,
+						   get_func_name(combinefn_oid));
+		InvokeFunctionExecuteHook(combinefn_oid);
+
+		/* the combine function takes two arguments of aggtranstype */
+		build_aggregate_transfn_expr(&aggtranstype,
+									 1,
+									 0,
+									 false,
+									 aggtranstype,
+									 wfunc->inputcollid,
+									 combinefn_oid,
+									 InvalidOid,
+									 &combinefnexpr,
+									 NULL);
+		fmgr_info(combinefn_oid, &peraggstate->combinefn);
+		fmgr_info_set_expr((Node *) combinefnexpr, &peraggstate->combinefn);
+		peraggstate->use_segtree = true;
+	}
+
 	/*
 	 * initval is potentially null, so don't try to access it as a struct
 	 * field. Must do it the hard way with SysCacheGetAttr.
@@ -8,6 +8,15 @@
  *
  * A TupleQueueReader reads tuples from a shm_mq and returns the tuples.
  *
+ * To cut down on per-message overhead, which dominates for narrow tuples,
+ * the sender packs small tuples into batches of up to TQUEUE_BATCH_SIZE
+ * bytes, each tuple starting at a MAXALIGN'd offset, and sends each batch
+ * as a single message.  A message holding just one tuple is simply the
+ * degenerate case, so the reader need not know how a message was built.
+ * A batch is also sent once it holds TQUEUE_BATCH_TUPLES tuples, or once
+ * its first tuple has waited TQUEUE_BATCH_DELAY_US, so that a slow producer
+ * doesn't keep the leader waiting for tuples that are already available.
+ *
  * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
  *
@@ -21,6 +30,26 @@
 
 #include "access/htup_details.h"
 #include "executor/tqueue.h"
+#include "portability/instr_time.h"
+
+/*
+ * Maximum size of a batch of tuples sent as one message.  This is kept well
+ * below a quarter of PARALLEL_TUPLE_QUEUE_SIZE, the point at which shm_mq
+ * makes written data visible to the receiver, so that batching doesn't
+ * delay tuples any more than shm_mq already does.
+ */
+#define TQUEUE_BATCH_SIZE	4096
+
+/*
+ * Maximum number of tuples in a batch, and maximum time in microseconds a
+ * batched tuple may wait for the batch to be sent.  A batch sent because of
+ * the time limit is also made visible to the receiver right away, instead
+ * of waiting for shm_mq to accumulate a quarter of the ring, since tuples
+ * are evidently arriving slowly and the leader may be waiting for them (for
+ * example, to satisfy a LIMIT).
+ */
+#define TQUEUE_BATCH_TUPLES		64
+#define TQUEUE_BATCH_DELAY_US	1000
 
 /*
  * DestReceiver object's private contents
@@ -31,23 +60,56 @@ typedef struct TQueueDestReceiver
 {
 	DestReceiver pub;			/* public fields */
 	shm_mq_handle *queue;		/* shm_mq to send to */
+	Size		batch_used;		/* bytes used in batch */
+	int			batch_ntuples;	/* number of tuples in batch */
+	instr_time	batch_start;	/* when the first tuple was batched */
+	char	   *batch;			/* tuples not yet sent */
 } TQueueDestReceiver;
 
 /*
  * TupleQueueReader object's private contents
  *
- * queue is a pointer to data supplied by reader's caller.
+ * queue is a pointer to data supplied by reader's caller.  When a message
+ * holding several tuples has been received, next_tuple and remaining
+ * describe the part of it not yet returned.
  *
  * "typedef struct TupleQueueReader TupleQueueReader" is in tqueue.h
  */
 struct TupleQueueReader
 {
 	shm_mq_handle *queue;		/* shm_mq to receive from */
+	char	   *next_tuple;		/* next tuple in current message */
+	Size		remaining;		/* bytes left in current message */
 };
 
+/*
+ * Send the current batch of tuples, if any, as a single message.  If
+ * force_flush is true, make it visible to the receiver immediately.
+ */
+static shm_mq_result
+tqueueFlushBatch(TQueueDestReceiver *tqueue, bool force_flush)
+{
+	shm_mq_result result;
+
+	if (tqueue->batch_used == 0)
+		return SHM_MQ_SUCCESS;
+
+	result = shm_mq_send(tqueue->queue, tqueue->batch_used, tqueue->batch,
+						 false, force_flush);
+	tqueue->batch_used = 0;
+	tqueue->batch_ntuples = 0;
+
+	return result;
+}
+
 /*
  * Receive a tuple from a query, and send it to the designated shm_mq.
  *
+ * Small tuples are collected into the current batch, which is sent once the
+ * next tuple wouldn't fit, or once it has reached the tuple count or time
+ * limit.  A tuple too large to share a batch is sent on its own, after
+ * whatever precedes it.
+ *
  * Returns true if successful, false if shm_mq has been detached.
  */
 static bool
@@ -55,12 +117,51 @@ tqueueReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
 {
 	TQueueDestReceiver *tqueue = (TQueueDestReceiver *) self;
 	MinimalTuple tuple;
-	shm_mq_result result;
+	shm_mq_result result = SHM_MQ_SUCCESS;
 	bool		should_free;
+	Size		len;
 
-	/* Send the tuple itself. */
 	tuple = ExecFetchSlotMinimalTuple(slot, &should_free);
-	result = shm_mq_send(tqueue->queue, tuple->t_len, tuple, false, false);
+	len = MAXALIGN(tuple->t_len);
+
+	/*
+	 * Send the pending batch first, if this tuple doesn't fit into it or is
+	 * to be sent on its own.  Either way, tuples must go out in order.
+	 */
+	if (tqueue->batch_used + len > TQUEUE_BATCH_SIZE ||
+		len > TQUEUE_BATCH_SIZE / 4)
+		result = tqueueFlushBatch(tqueue, false);
+
+	if (result == SHM_MQ_SUCCESS)
+	{
+		if (len <= TQUEUE_BATCH_SIZE / 4)
+		{
+			/* Add the tuple to the batch. */
+			memcpy(tqueue->batch + tqueue->batch_used, tuple, tuple->t_len);
+			tqueue->batch_used += len;
+
+			/* Send the batch if it is full or has been waiting too long. */
+			if (++tqueue->batch_ntuples == 1)
+				INSTR_TIME_SET_CURRENT(tqueue->batch_start);
+			else if (tqueue->batch_ntuples >= TQUEUE_BATCH_TUPLES)
+				result = tqueueFlushBatch(tqueue, false);
+			else
+			{
+				instr_time	elapsed;
+
+				INSTR_TIME_SET_CURRENT(elapsed);
+				INSTR_TIME_SUBTRACT(elapsed, tqueue->batch_start);
+				if (INSTR_TIME_GET_MICROSEC(elapsed) >= TQUEUE_BATCH_DELAY_US)
+					result = tqueueFlushBatch(tqueue, true);
+			}
+		}
+		else
+		{
+			/* Send the tuple itself. */
+			result = shm_mq_send(tqueue->queue, tuple->t_len, tuple,
+								 false, false);
+		}
+	}
 
 	if (should_free)
 		pfree(tuple);
@@ -94,7 +195,14 @@ tqueueShutdownReceiver(DestReceiver *self)
 	TQueueDestReceiver *tqueue = (TQueueDestReceiver *) self;
 
 	if (tqueue->queue != NULL)
+	{
+		/*
+		 * Send any batched tuples.  If the receiver has gone away, it no
+		 * longer wants them, so the result doesn't matter.
+		 */
+		(void) tqueueFlushBatch(tqueue, false);
 		shm_mq_detach(tqueue->queue);
+	}
 	tqueue->queue = NULL;
 }
 
@@ -109,6 +217,7 @@ tqueueDestroyReceiver(DestReceiver *self)
 	/* We probably already detached from queue, but let's be sure */
 	if (tqueue->queue != NULL)
 		shm_mq_detach(tqueue->queue);
+	pfree(tqueue->batch);
 	pfree(self);
 }
 
@@ -128,6 +237,7 @@ CreateTupleQueueDestReceiver(shm_mq_handle *handle)
 	self->pub.rDestroy = tqueueDestroyReceiver;
 	self->pub.mydest = DestTupleQueue;
 	self->queue = handle;
+	self->batch = palloc(TQUEUE_BATCH_SIZE);
 
 	return (DestReceiver *) self;
 }
@@ -166,7 +276,9 @@ DestroyTupleQueueReader(TupleQueueReader *reader)
  *
  * The returned tuple, if any, is either in shared memory or a private buffer
  * and should not be freed.  The pointer is invalid after the next call to
- * TupleQueueReaderNext().
+ * TupleQueueReaderNext().  Tuples from a message holding a batch are returned
+ * one per call, still pointing into the message, which stays valid until
+ * we ask shm_mq for the next one.
  *
  * Even when shm_mq_receive() returns SHM_MQ_WOULD_BLOCK, this can still
  * accumulate bytes from a partially-read message, so it's useful to call
@@ -183,6 +295,17 @@ TupleQueueReaderNext(TupleQueueReader *reader, bool nowait, bool *done)
 	if (done != NULL)
 		*done = false;
 
+	/* Return the next tuple of the current message, if there is one. */
+	if (reader->remaining > 0)
+	{
+		tuple = (MinimalTuple) reader->next_tuple;
+		Assert(tuple->t_len <= reader->remaining);
+		nbytes = Min(MAXALIGN(tuple->t_len), reader->remaining);
+		reader->next_tuple += nbytes;
+		reader->remaining -= nbytes;
+		return tuple;
+	}
+
 	/* Attempt to read a message. */
 	result = shm_mq_receive(reader->queue, &nbytes, &data, nowait);
 
@@ -201,10 +324,16 @@ TupleQueueReaderNext(TupleQueueReader *reader, bool nowait, bool *done)
 
 	/*
 	 * Return a pointer to the queue memory directly (which had better be
-	 * sufficiently aligned).
+	 * sufficiently aligned).  If the message holds more tuples, remember
+	 * where the next one starts.
 	 */
 	tuple = (MinimalTuple) data;
-	Assert(tuple->t_len == nbytes);
+	Assert(tuple->t_len <= nbytes);
+	if (MAXALIGN(tuple->t_len) < nbytes)
+	{
+		reader->next_tuple = (char *) data + MAXALIGN(tuple->t_len);
+		reader->remaining = nbytes - MAXALIGN(tuple->t_len);
+	}
 
 	return tuple;
 }
@@ -258,8 +258,30 @@ be_tls_init(bool isServerStart)
 		}
 	}
 
-	/* disallow SSL session tickets */
-	SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+	if (ssl_session_tickets)
+	{
+		/*
+		 * Allow clients to resume a previous session with a stateless session
+		 * ticket, which saves the key exchange and certificate checks of a
+		 * full handshake.  The ticket keys are generated along with the
+		 * context, and the context is built in the postmaster, so a ticket
+		 * issued by one backend can be used with any other.  Reloading the
+		 * configuration builds a new context and so invalidates outstanding
+		 * tickets.  (In EXEC_BACKEND builds each backend builds its own
+		 * context, so resumption never succeeds there.)
+		 *
+		 * A session ID context is required for resumption to work when
+		 * client certificates are verified.
+		 */
+		SSL_CTX_set_session_id_context(context,
+									   (const unsigned char *) "PostgreSQL",
+									   strlen("PostgreSQL"));
+	}
+	else
+	{
+		/* disallow SSL session tickets */
+		SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+	}
 
 	/* disallow SSL session caching, too */
 	SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_OFF);
@@ -113,15 +113,23 @@ static List *sock_paths = NIL;
  *
  * The receive buffer is fixed size. Send buffer is usually 8k, but can be
  * enlarged by pq_putmessage_noblock() if the message doesn't fit otherwise.
+ * It is also enlarged, up to PQ_SEND_BUFFER_MAX_SIZE, when a long stream of
+ * output keeps filling it up between explicit flushes, as happens when
+ * sending a large result set; that lets us hand the kernel (and SSL) fewer,
+ * larger writes.
  */
 
 #define PQ_SEND_BUFFER_SIZE 8192
+#define PQ_SEND_BUFFER_MAX_SIZE (128 * 1024)
+#define PQ_SEND_BUFFER_GROW_AFTER 4
 #define PQ_RECV_BUFFER_SIZE 8192
 
 static char *PqSendBuffer;
 static int	PqSendBufferSize;	/* Size send buffer */
 static size_t PqSendPointer;	/* Next index to store a byte in PqSendBuffer */
 static size_t PqSendStart;		/* Next index to send a byte in PqSendBuffer */
+static int	PqSendFullFlushes;	/* Flushes of a full buffer since the last
+								 * explicit flush */
 
 static char PqRecvBuffer[PQ_RECV_BUFFER_SIZE];
 static int	PqRecvPointer;		/* Next index to read a byte from PqRecvBuffer */
@@ -1283,6 +1291,25 @@ internal_putbytes(const char *s, size_t len)
 			socket_set_nonblocking(false);
 			if (internal_flush())
 				return EOF;
+
+			/*
+			 * If this keeps happening without the caller ever flushing, we
+			 * are streaming bulk output; use a bigger buffer.  The blocking
+			 * flush above emptied the buffer, so nothing needs copying.
+			 */
+			if (++PqSendFullFlushes >= PQ_SEND_BUFFER_GROW_AFTER &&
+				PqSendBufferSize < PQ_SEND_BUFFER_MAX_SIZE &&
+				PqSendStart == PqSendPointer)
+			{
+				int			newsize;
+
+				newsize = Min(PqSendBufferSize * 2, PQ_SEND_BUFFER_MAX_SIZE);
+				pfree(PqSendBuffer);
+				PqSendBuffer = MemoryContextAlloc(TopMemoryContext, newsize);
+				PqSendBufferSize = newsize;
+				PqSendStart = PqSendPointer = 0;
+				PqSendFullFlushes = 0;
+			}
 		}
 
 		/*
@@ -1332,6 +1359,7 @@ socket_flush(void)
 	socket_set_nonblocking(false);
 	res = internal_flush();
 	PqCommBusy = false;
+	PqSendFullFlushes = 0;
 	return res;
 }
 
@@ -449,6 +449,69 @@ tbm_add_page(TIDBitmap *tbm, BlockNumber pageno)
 		tbm_lossify(tbm);
 }
 
+/*
+ * tbm_add_page_range - add a range of whole pages to a TIDBitmap
+ *
+ * Equivalent to calling tbm_add_page() for each of the npages pages starting
+ * at startpage, but much cheaper when the bitmap holds no exact pages, as is
+ * the case when it is filled by a BRIN scan: each chunk is then looked up
+ * only once, rather than once per page plus once more to check for an exact
+ * entry to replace.
+ */
+void
+tbm_add_page_range(TIDBitmap *tbm, BlockNumber startpage, BlockNumber npages)
+{
+	BlockNumber pageno = startpage;
+	BlockNumber endpage = startpage + npages;
+
+	Assert(!tbm->iterating);
+
+	if (tbm->npages > 0)
+	{
+		/* Exact entries may need to be replaced, do it the slow way */
+		for (; pageno < endpage; pageno++)
+			tbm_add_page(tbm, pageno);
+		return;
+	}
+
+	/* We force the bitmap into hashtable mode whenever it's lossy */
+	if (tbm->status != TBM_HASH)
+		tbm_create_pagetable(tbm);
+
+	while (pageno < endpage)
+	{
+		int			bitno = pageno % PAGES_PER_CHUNK;
+		BlockNumber chunk_pageno = pageno - bitno;
+		BlockNumber nchunkpages = Min(PAGES_PER_CHUNK - bitno,
+									  endpage - pageno);
+		PagetableEntry *page;
+		bool		found;
+
+		page = pagetable_insert(tbm->pagetable, chunk_pageno, &found);
+		if (!found)
+		{
+			char		oldstatus = page->status;
+
+			MemSet(page, 0, sizeof(PagetableEntry));
+			page->status = oldstatus;
+			page->blockno = chunk_pageno;
+			page->ischunk = true;
+			tbm->nentries++;
+			tbm->nchunks++;
+		}
+		/* with no exact pages in the bitmap, this must be a chunk */
+		Assert(page->ischunk);
+
+		for (BlockNumber i = 0; i < nchunkpages; i++, bitno++)
+			page->words[WORDNUM(bitno)] |= ((bitmapword) 1 << BITNUM(bitno));
+
+		pageno += nchunkpages;
+	}
+
+	if (tbm->nentries > tbm->maxentries)
+		tbm_lossify(tbm);
+}
+
 /*
  * tbm_union - set union
  *
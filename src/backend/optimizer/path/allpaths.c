@@ -35,6 +35,7 @@
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/geqo.h"
+#include "optimizer/joininfo.h"
 #include "optimizer/optimizer.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
@@ -78,6 +79,7 @@ typedef enum pushdown_safe_type
 /* These parameters are set by GUC */
 bool		enable_geqo = false;	/* just in case GUC doesn't set it */
 int			geqo_threshold;
+bool		geqo_greedy = false;
 int			min_parallel_table_scan_size;
 int			min_parallel_index_scan_size;
 
@@ -142,6 +144,9 @@ static void set_result_pathlist(PlannerInfo *root, RelOptInfo *rel,
 static void set_worktable_pathlist(PlannerInfo *root, RelOptInfo *rel,
 								   RangeTblEntry *rte);
 static RelOptInfo *make_rel_from_joinlist(PlannerInfo *root, List *joinlist);
+static RelOptInfo *greedy_join_search(PlannerInfo *root, int levels_needed,
+									  List *initial_rels);
+static void greedy_join_finish_rel(PlannerInfo *root, RelOptInfo *rel);
 static bool subquery_is_pushdown_safe(Query *subquery, Query *topquery,
 									  pushdown_safety_info *safetyInfo);
 static bool recurse_pushdown_safe(Node *setOp, Query *topquery,
@@ -3372,7 +3377,15 @@ make_rel_from_joinlist(PlannerInfo *root, List *joinlist)
 		if (join_search_hook)
 			return (*join_search_hook) (root, levels_needed, initial_rels);
 		else if (enable_geqo && levels_needed >= geqo_threshold)
-			return geqo(root, levels_needed, initial_rels);
+		{
+			RelOptInfo *rel = NULL;
+
+			if (geqo_greedy)
+				rel = greedy_join_search(root, levels_needed, initial_rels);
+			if (rel == NULL)
+				rel = geqo(root, levels_needed, initial_rels);
+			return rel;
+		}
 		else
 			return standard_join_search(root, levels_needed, initial_rels);
 	}
@@ -3494,6 +3507,154 @@ standard_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
 	return rel;
 }
 
+/*
+ * Finish off a join relation built by greedy_join_search(), the same way
+ * standard_join_search() does once all paths have been added to it.
+ */
+static void
+greedy_join_finish_rel(PlannerInfo *root, RelOptInfo *rel)
+{
+	generate_partitionwise_join_paths(root, rel);
+	if (!bms_equal(rel->relids, root->all_query_rels))
+		generate_useful_gather_paths(root, rel, false);
+	set_cheapest(rel);
+}
+
+/*
+ * greedy_join_search
+ *	  Find a join order by repeatedly performing the join with the smallest
+ *	  estimated output, used instead of GEQO when geqo_greedy is set.
+ *
+ * We keep a set of components, initially the initial_rels.  At each step we
+ * consider joining every pair of components that has a join clause or a
+ * join order restriction linking them, and merge the pair whose join
+ * relation has the fewest estimated rows (ties broken by cheapest total
+ * cost).  Only if no such pair can be joined do we consider clauseless joins.
+ * This is "greedy operator ordering": it takes O(N^2) join relations
+ * overall, since a candidate join between two components stays valid until
+ * one of them is merged with something else, and it is deterministic, unlike
+ * GEQO.  It can produce bushy plans.
+ *
+ * Like the heuristics in GEQO's gimme_tree(), this can paint itself into a
+ * corner where no remaining pair of components can legally be joined.  In
+ * that case we throw away the join relations we made and return NULL, and
+ * the caller falls back to GEQO.
+ */
+static RelOptInfo *
+greedy_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
+{
+	int			nrels = list_length(initial_rels);
+	int			savelength = list_length(root->join_rel_list);
+	RelOptInfo **comps;
+	RelOptInfo **joinrels;
+	bool	   *tried;
+	int			ncomps = nrels;
+	int			i;
+	ListCell   *lc;
+
+	Assert(levels_needed == nrels);
+	Assert(root->join_rel_level == NULL);
+
+	comps = (RelOptInfo **) palloc(nrels * sizeof(RelOptInfo *));
+	joinrels = (RelOptInfo **) palloc0(nrels * nrels * sizeof(RelOptInfo *));
+	tried = (bool *) palloc0(nrels * nrels * sizeof(bool));
+
+	i = 0;
+	foreach(lc, initial_rels)
+		comps[i++] = (RelOptInfo *) lfirst(lc);
+
+	while (ncomps > 1)
+	{
+		int			best_i = -1;
+		int			best_j = -1;
+		RelOptInfo *best = NULL;
+
+		for (int pass = 0; pass < 2 && best == NULL; pass++)
+		{
+			bool		desperate = (pass == 1);
+
+			for (i = 0; i < nrels; i++)
+			{
+				if (comps[i] == NULL)
+					continue;
+
+				for (int j = i + 1; j < nrels; j++)
+				{
+					int			cell = i * nrels + j;
+					RelOptInfo *joinrel;
+
+					if (comps[j] == NULL)
+						continue;
+
+					if (!tried[cell])
+					{
+						if (!desperate &&
+							!have_relevant_joinclause(root, comps[i], comps[j]) &&
+							!have_join_order_restriction(root, comps[i], comps[j]))
+							continue;
+
+						CHECK_FOR_INTERRUPTS();
+
+						joinrel = make_join_rel(root, comps[i], comps[j]);
+						if (joinrel)
+							greedy_join_finish_rel(root, joinrel);
+						joinrels[cell] = joinrel;
+						tried[cell] = true;
+					}
+
+					joinrel = joinrels[cell];
+					if (joinrel == NULL)
+						continue;
+
+					if (best == NULL ||
+						joinrel->rows < best->rows ||
+						(joinrel->rows == best->rows &&
+						 joinrel->cheapest_total_path->total_cost <
+						 best->cheapest_total_path->total_cost))
+					{
+						best = joinrel;
+						best_i = i;
+						best_j = j;
+					}
+				}
+			}
+		}
+
+		if (best == NULL)
+		{
+			/* Stuck; forget what we built and let GEQO have a go */
+			root->join_rel_list = list_truncate(root->join_rel_list,
+												savelength);
+			root->join_rel_hash = NULL;
+			return NULL;
+		}
+
+		/*
+		 * Replace the pair by their join.  Candidate joins involving either
+		 * of them are no longer of interest.
+		 */
+		comps[best_i] = best;
+		comps[best_j] = NULL;
+		for (i = 0; i < nrels; i++)
+		{
+			int			lo = Min(i, best_i);
+			int			hi = Max(i, best_i);
+
+			tried[lo * nrels + hi] = false;
+			joinrels[lo * nrels + hi] = NULL;
+		}
+		ncomps--;
+	}
+
+	for (i = 0; i < nrels; i++)
+	{
+		if (comps[i] != NULL)
+			return comps[i];
+	}
+
+	return NULL;				/* keep compiler quiet */
+}
+
 /*****************************************************************************
  *			PUSHING QUALS DOWN INTO SUBQUERIES
  *****************************************************************************/
@@ -69,6 +69,12 @@ static bool reconsider_outer_join_clause(PlannerInfo *root,
 static bool reconsider_full_join_clause(PlannerInfo *root,
 										OuterJoinClauseInfo *ojcinfo);
 static JoinDomain *find_join_domain(PlannerInfo *root, Relids relids);
+static bool sort_expr_matches_eclass(EquivalenceClass *ec, Expr *expr,
+									 List *opfamilies, Oid opcintype,
+									 Oid collation, Index sortref,
+									 Relids rel, JoinDomain *jdomain);
+static bool get_sort_expr_eclass_indexes(PlannerInfo *root, Expr *expr,
+										 Bitmapset **ec_indexes);
 static Bitmapset *get_eclass_indexes_for_relids(PlannerInfo *root,
 												Relids relids);
 static Bitmapset *get_common_eclass_indexes(PlannerInfo *root, Relids relids1,
@@ -597,7 +603,7 @@ get_eclass_for_sort_expr(PlannerInfo *root,
 	Relids		expr_relids;
 	EquivalenceClass *newec;
 	EquivalenceMember *newem;
-	ListCell   *lc1;
+	Bitmapset  *ec_indexes;
 	MemoryContext oldcontext;
 
 	/*
@@ -612,58 +618,35 @@ get_eclass_for_sort_expr(PlannerInfo *root,
 	jdomain = linitial_node(JoinDomain, root->join_domains);
 
 	/*
-	 * Scan through the existing EquivalenceClasses for a match
+	 * Scan through the existing EquivalenceClasses for a match.  Once EC
+	 * merging is done, we can usually limit the search to the ECs mentioning
+	 * one of the expression's relations; with hundreds of relations, walking
+	 * the whole list for every sort expression adds up.
 	 */
-	foreach(lc1, root->eq_classes)
+	if (get_sort_expr_eclass_indexes(root, expr, &ec_indexes))
 	{
-		EquivalenceClass *cur_ec = (EquivalenceClass *) lfirst(lc1);
-		ListCell   *lc2;
-
-		/*
-		 * Never match to a volatile EC, except when we are looking at another
-		 * reference to the same volatile SortGroupClause.
-		 */
-		if (cur_ec->ec_has_volatile &&
-			(sortref == 0 || sortref != cur_ec->ec_sortref))
-			continue;
-
-		if (collation != cur_ec->ec_collation)
-			continue;
-		if (!equal(opfamilies, cur_ec->ec_opfamilies))
-			continue;
+		int			i = -1;
 
-		foreach(lc2, cur_ec->ec_members)
+		while ((i = bms_next_member(ec_indexes, i)) >= 0)
 		{
-			EquivalenceMember *cur_em = (EquivalenceMember *) lfirst(lc2);
+			EquivalenceClass *cur_ec = list_nth(root->eq_classes, i);
 
-			/*
-			 * Ignore child members unless they match the request.
-			 */
-			if (cur_em->em_is_child &&
-				!bms_equal(cur_em->em_relids, rel))
-				continue;
+			if (sort_expr_matches_eclass(cur_ec, expr, opfamilies, opcintype,
+										 collation, sortref, rel, jdomain))
+				return cur_ec;
+		}
+	}
+	else
+	{
+		ListCell   *lc1;
 
-			/*
-			 * Match constants only within the same JoinDomain (see
-			 * optimizer/README).
-			 */
-			if (cur_em->em_is_const && cur_em->em_jdomain != jdomain)
-				continue;
+		foreach(lc1, root->eq_classes)
+		{
+			EquivalenceClass *cur_ec = (EquivalenceClass *) lfirst(lc1);
 
-			if (opcintype == cur_em->em_datatype &&
-				equal(expr, cur_em->em_expr))
-			{
-				/*
-				 * Match!
-				 *
-				 * Copy the sortref if it wasn't set yet.  That may happen if
-				 * the ec was constructed from a WHERE clause, i.e. it doesn't
-				 * have a target reference at all.
-				 */
-				if (cur_ec->ec_sortref == 0 && sortref > 0)
-					cur_ec->ec_sortref = sortref;
+			if (sort_expr_matches_eclass(cur_ec, expr, opfamilies, opcintype,
+										 collation, sortref, rel, jdomain))
 				return cur_ec;
-			}
 		}
 	}
 
@@ -755,6 +738,114 @@ get_eclass_for_sort_expr(PlannerInfo *root,
 	return newec;
 }
 
+/*
+ * sort_expr_matches_eclass
+ *		Subroutine for get_eclass_for_sort_expr: does the EC contain a member
+ *		matching the sort expression?
+ *
+ * On a match, the EC's sortref is filled in if it wasn't set yet.
+ */
+static bool
+sort_expr_matches_eclass(EquivalenceClass *ec, Expr *expr,
+						 List *opfamilies, Oid opcintype, Oid collation,
+						 Index sortref, Relids rel, JoinDomain *jdomain)
+{
+	ListCell   *lc;
+
+	/*
+	 * Never match to a volatile EC, except when we are looking at another
+	 * reference to the same volatile SortGroupClause.
+	 */
+	if (ec->ec_has_volatile &&
+		(sortref == 0 || sortref != ec->ec_sortref))
+		return false;
+
+	if (collation != ec->ec_collation)
+		return false;
+	if (!equal(opfamilies, ec->ec_opfamilies))
+		return false;
+
+	foreach(lc, ec->ec_members)
+	{
+		EquivalenceMember *cur_em = (EquivalenceMember *) lfirst(lc);
+
+		/*
+		 * Ignore child members unless they match the request.
+		 */
+		if (cur_em->em_is_child &&
+			!bms_equal(cur_em->em_relids, rel))
+			continue;
+
+		/*
+		 * Match constants only within the same JoinDomain (see
+		 * optimizer/README).
+		 */
+		if (cur_em->em_is_const && cur_em->em_jdomain != jdomain)
+			continue;
+
+		if (opcintype == cur_em->em_datatype &&
+			equal(expr, cur_em->em_expr))
+		{
+			/*
+			 * Match!
+			 *
+			 * Copy the sortref if it wasn't set yet.  That may happen if the
+			 * ec was constructed from a WHERE clause, i.e. it doesn't have a
+			 * target reference at all.
+			 */
+			if (ec->ec_sortref == 0 && sortref > 0)
+				ec->ec_sortref = sortref;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * get_sort_expr_eclass_indexes
+ *		Subroutine for get_eclass_for_sort_expr: find the ECs that could
+ *		contain a member matching the sort expression.  Returns false if
+ *		the whole eq_classes list must be searched instead.
+ *
+ * A matching non-child member has exactly the expression's relids, and
+ * those are all included in its EC's ec_relids, so any one base relation
+ * of the expression tells us where to look.  We can only rely on that once
+ * EC merging is done, and only for base relations: a child member's relids
+ * belong to "other" rels, which we therefore don't try to handle here.
+ */
+static bool
+get_sort_expr_eclass_indexes(PlannerInfo *root, Expr *expr,
+							 Bitmapset **ec_indexes)
+{
+	Relids		expr_relids;
+	RelOptInfo *baserel = NULL;
+	int			i = -1;
+
+	if (!root->ec_merging_done)
+		return false;
+
+	expr_relids = pull_varnos(root, (Node *) expr);
+	while ((i = bms_next_member(expr_relids, i)) > 0)
+	{
+		RelOptInfo *rel = root->simple_rel_array[i];
+
+		if (rel == NULL)		/* must be an outer join */
+			continue;
+		if (rel->reloptkind != RELOPT_BASEREL)
+			return false;
+		if (baserel == NULL)
+			baserel = rel;
+	}
+
+	/* Constant expression, or only outer join relids; search everything */
+	if (baserel == NULL)
+		return false;
+
+	*ec_indexes = baserel->eclass_indexes;
+	return true;
+}
+
 /*
  * find_ec_member_matching_expr
  *		Locate an EquivalenceClass member matching the given expr, if any;
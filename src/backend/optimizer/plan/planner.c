@@ -1169,11 +1169,13 @@ preprocess_expression(PlannerInfo *root, Node *expr, int kind)
 		expr = eval_const_expressions(root, expr);
 
 	/*
-	 * If it's a qual or havingQual, canonicalize it.
+	 * If it's a qual or havingQual, canonicalize it, then merge long lists
+	 * of OR'ed constant comparisons into = ANY.
 	 */
 	if (kind == EXPRKIND_QUAL)
 	{
 		expr = (Node *) canonicalize_qual((Expr *) expr, false);
+		expr = (Node *) convert_ors_to_saops((Expr *) expr);
 
 #ifdef OPTIMIZER_DEBUG
 		printf("After canonicalize_qual()\n");
@@ -1182,9 +1184,9 @@ preprocess_expression(PlannerInfo *root, Node *expr, int kind)
 	}
 
 	/*
-	 * Check for ANY ScalarArrayOpExpr with Const arrays and set the
-	 * hashfuncid of any that might execute more quickly by using hash lookups
-	 * instead of a linear search.
+	 * Check for ANY ScalarArrayOpExpr with Const or execution-constant arrays
+	 * and set the hashfuncid of any that might execute more quickly by using
+	 * hash lookups instead of a linear search.
 	 */
 	if (kind == EXPRKIND_QUAL || kind == EXPRKIND_TARGET)
 	{
@@ -371,6 +371,17 @@ build_subplan(PlannerInfo *root, Plan *plan, Path *path,
 		splan->args = lappend(splan->args, arg);
 	}
 
+	/*
+	 * A correlated EXPR or EXISTS subplan without volatile functions returns
+	 * the same result whenever it's called with the same parameter values,
+	 * so the executor may remember its results.  There are other conditions,
+	 * which are checked by ExecInitSubPlan().
+	 */
+	splan->memoize = enable_memoize &&
+		(subLinkType == EXPR_SUBLINK || subLinkType == EXISTS_SUBLINK) &&
+		splan->parParam != NIL &&
+		!contain_volatile_functions((Node *) subroot->parse);
+
 	/*
 	 * Un-correlated or undirect correlated plans of EXISTS, EXPR, ARRAY,
 	 * ROWCOMPARE, or MULTIEXPR types can be used as initPlans.  For EXISTS,
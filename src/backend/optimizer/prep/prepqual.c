@@ -34,13 +34,20 @@
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/optimizer.h"
+#include "utils/array.h"
 #include "utils/lsyscache.h"
 
+/* GUC parameter */
+int			or_to_any_threshold = 5;
+
 
 static List *pull_ands(List *andlist);
 static List *pull_ors(List *orlist);
 static Expr *find_duplicate_ors(Expr *qual, bool is_check);
 static Expr *process_duplicate_ors(List *orlist);
+static Expr *make_or_with_saops(List *orlist);
+static bool or_arm_is_saop_candidate(Expr *arm);
+static Expr *make_saop_from_or_arms(List *arms);
 
 
 /*
@@ -674,3 +681,226 @@ process_duplicate_ors(List *orlist)
 	else
 		return make_andclause(pull_ands(winners));
 }
+
+/*
+ * convert_ors_to_saops
+ *	  Replace groups of OR'ed "expr op const" comparisons within the top-level
+ *	  AND/OR structure of a qual by "expr op ANY (array)".
+ *
+ * This is meant for WHERE and JOIN/ON quals only, and it is applied after
+ * canonicalize_qual, so the input is AND/OR flat.  It is deliberately not
+ * part of canonicalize_qual itself: that is also used on CHECK constraints
+ * and partial index predicates, and those are better left as plain OR lists
+ * for the benefit of predtest.c, which gives up on arrays longer than
+ * MAX_SAOP_ARRAY_SIZE.
+ *
+ * Returns the modified qualification.  AND/OR flatness is preserved.
+ */
+Expr *
+convert_ors_to_saops(Expr *qual)
+{
+	List	   *args = NIL;
+	ListCell   *temp;
+
+	if (qual == NULL || or_to_any_threshold <= 0)
+		return qual;
+
+	if (!is_orclause(qual) && !is_andclause(qual))
+		return qual;
+
+	/* Recurse */
+	foreach(temp, ((BoolExpr *) qual)->args)
+		args = lappend(args, convert_ors_to_saops((Expr *) lfirst(temp)));
+
+	if (is_andclause(qual))
+		return make_andclause(args);
+	return make_or_with_saops(args);
+}
+
+/*
+ * make_or_with_saops
+ *	  Build an OR clause from the given list of arms, first replacing groups of
+ *	  "expr op const" arms that share the same expr and operator by a single
+ *	  "expr op ANY (array)" when the group has at least or_to_any_threshold
+ *	  members.
+ *
+ * The two forms are equivalent, including their behavior for nulls: both
+ * yield true if any comparison is true, else null if any comparison is null,
+ * else false.  The ScalarArrayOpExpr, however, can be used for a single
+ * index scan with array keys instead of a BitmapOr with one scan per arm,
+ * and long constant lists get hashed at execution time.
+ *
+ * Only arms with a constant on the right-hand side are considered, and the
+ * expression on the left must not be volatile, since it is evaluated once
+ * instead of once per arm.  Each array is kept to at most MAX_SAOP_ARRAY_SIZE
+ * elements, so that predtest.c can still expand it when proving partial index
+ * predicates or refuting CHECK constraints from the qual; longer groups turn
+ * into several ScalarArrayOpExprs.  The resulting expression might be a
+ * single ScalarArrayOpExpr if all arms were merged.
+ */
+static Expr *
+make_or_with_saops(List *orlist)
+{
+	List	   *neworlist = NIL;
+	bool	   *done;
+	int			nargs = list_length(orlist);
+	int			i;
+
+	if (or_to_any_threshold <= 0 || nargs < or_to_any_threshold)
+		return make_orclause(orlist);
+
+	done = (bool *) palloc0(nargs * sizeof(bool));
+
+	for (i = 0; i < nargs; i++)
+	{
+		OpExpr	   *arm = (OpExpr *) list_nth(orlist, i);
+		List	   *group;
+
+		if (done[i])
+			continue;
+
+		if (!or_arm_is_saop_candidate((Expr *) arm))
+		{
+			neworlist = lappend(neworlist, arm);
+			continue;
+		}
+
+		/* Collect all later arms that compare the same expression */
+		group = list_make1(arm);
+		for (int j = i + 1; j < nargs; j++)
+		{
+			OpExpr	   *other = (OpExpr *) list_nth(orlist, j);
+
+			if (done[j] || !or_arm_is_saop_candidate((Expr *) other))
+				continue;
+			if (other->opno != arm->opno ||
+				other->inputcollid != arm->inputcollid ||
+				((Const *) lsecond(other->args))->consttype !=
+				((Const *) lsecond(arm->args))->consttype ||
+				!equal(linitial(other->args), linitial(arm->args)))
+				continue;
+
+			group = lappend(group, other);
+			done[j] = true;
+		}
+
+		if (list_length(group) >= or_to_any_threshold)
+		{
+			List	   *saops = NIL;
+
+			for (int start = 0; start < list_length(group);
+				 start += MAX_SAOP_ARRAY_SIZE)
+			{
+				List	   *chunk;
+				Expr	   *saop;
+
+				chunk = list_copy_head(list_copy_tail(group, start),
+									   MAX_SAOP_ARRAY_SIZE);
+				saop = make_saop_from_or_arms(chunk);
+				if (saop == NULL)
+				{
+					saops = NIL;
+					break;
+				}
+				saops = lappend(saops, saop);
+			}
+
+			if (saops != NIL)
+			{
+				neworlist = list_concat(neworlist, saops);
+				continue;
+			}
+		}
+
+		/* Not worth it, or not possible; keep the arms as they were */
+		neworlist = list_concat(neworlist, group);
+	}
+
+	pfree(done);
+
+	if (list_length(neworlist) == 1)
+		return (Expr *) linitial(neworlist);
+	return make_orclause(neworlist);
+}
+
+/*
+ * Is an OR arm of the form "non-volatile expr op Const"?
+ */
+static bool
+or_arm_is_saop_candidate(Expr *arm)
+{
+	OpExpr	   *opexpr;
+
+	if (!IsA(arm, OpExpr))
+		return false;
+	opexpr = (OpExpr *) arm;
+	if (list_length(opexpr->args) != 2 ||
+		!IsA(lsecond(opexpr->args), Const) ||
+		IsA(linitial(opexpr->args), Const) ||
+		opexpr->opretset)
+		return false;
+	return !contain_volatile_functions(linitial(opexpr->args));
+}
+
+/*
+ * Build "expr op ANY (array)" from a group of arms accepted by
+ * or_arm_is_saop_candidate() that all share the same expr and operator.
+ * Returns NULL if the constants' type has no array type.
+ */
+static Expr *
+make_saop_from_or_arms(List *arms)
+{
+	OpExpr	   *first = (OpExpr *) linitial(arms);
+	Const	   *firstconst = (Const *) lsecond(first->args);
+	Oid			elemtype = firstconst->consttype;
+	Oid			arraytype = get_array_type(elemtype);
+	int			nelems = list_length(arms);
+	Datum	   *elems;
+	bool	   *nulls;
+	int			dims[1];
+	int			lbs[1];
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	ArrayType  *array;
+	Const	   *arrayconst;
+	ScalarArrayOpExpr *saop;
+	int			i;
+
+	if (!OidIsValid(arraytype))
+		return NULL;
+
+	get_typlenbyvalalign(elemtype, &typlen, &typbyval, &typalign);
+
+	elems = (Datum *) palloc(nelems * sizeof(Datum));
+	nulls = (bool *) palloc(nelems * sizeof(bool));
+	i = 0;
+	foreach_node(OpExpr, arm, arms)
+	{
+		Const	   *c = (Const *) lsecond(arm->args);
+
+		elems[i] = c->constvalue;
+		nulls[i] = c->constisnull;
+		i++;
+	}
+
+	dims[0] = nelems;
+	lbs[0] = 1;
+	array = construct_md_array(elems, nulls, 1, dims, lbs,
+							   elemtype, typlen, typbyval, typalign);
+
+	arrayconst = makeConst(arraytype, -1, firstconst->constcollid, -1,
+						   PointerGetDatum(array), false, false);
+
+	saop = makeNode(ScalarArrayOpExpr);
+	saop->opno = first->opno;
+	saop->opfuncid = first->opfuncid;
+	saop->hashfuncid = InvalidOid;
+	saop->negfuncid = InvalidOid;
+	saop->useOr = true;
+	saop->inputcollid = first->inputcollid;
+	saop->args = list_make2(linitial(first->args), arrayconst);
+	saop->location = first->location;
+
+	return (Expr *) saop;
+}
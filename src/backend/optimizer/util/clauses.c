@@ -109,6 +109,8 @@ static Relids find_nonnullable_rels_walker(Node *node, bool top_level);
 static List *find_nonnullable_vars_walker(Node *node, bool top_level);
 static bool is_strict_saop(ScalarArrayOpExpr *expr, bool falseOK);
 static bool convert_saop_to_hashed_saop_walker(Node *node, void *context);
+static int	hashed_saop_array_length(Expr *arrayarg);
+static bool contain_non_execution_constant_walker(Node *node, void *context);
 static Node *eval_const_expressions_mutator(Node *node,
 											eval_const_expressions_context *context);
 static bool contain_non_const_walker(Node *node, void *context);
@@ -2275,7 +2277,9 @@ eval_const_expressions(PlannerInfo *root, Node *node)
  * evaluate using a hash table rather than a linear search.
  *
  * We'll use a hash table if all of the following conditions are met:
- * 1. The 2nd argument of the array contain only Consts.
+ * 1. The 2nd argument of the array is a Const, or an expression whose value
+ *	  can't change during execution, such as ARRAY[$1, $2, ...]; the
+ *	  executor evaluates the latter just once, when it can.
  * 2. useOr is true or there is a valid negator operator for the
  *	  ScalarArrayOpExpr's opno.
  * 3. There's valid hash function for both left and righthand operands and
@@ -2302,25 +2306,20 @@ convert_saop_to_hashed_saop_walker(Node *node, void *context)
 		Oid			lefthashfunc;
 		Oid			righthashfunc;
 
-		if (arrayarg && IsA(arrayarg, Const) &&
-			!((Const *) arrayarg)->constisnull)
+		int			nitems = hashed_saop_array_length(arrayarg);
+
+		if (nitems >= 0)
 		{
 			if (saop->useOr)
 			{
 				if (get_op_hash_functions(saop->opno, &lefthashfunc, &righthashfunc) &&
 					lefthashfunc == righthashfunc)
 				{
-					Datum		arrdatum = ((Const *) arrayarg)->constvalue;
-					ArrayType  *arr = (ArrayType *) DatumGetPointer(arrdatum);
-					int			nitems;
-
 					/*
 					 * Only fill in the hash functions if the array looks
 					 * large enough for it to be worth hashing instead of
 					 * doing a linear search.
 					 */
-					nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
-
 					if (nitems >= MIN_ARRAY_SIZE_FOR_HASHED_SAOP)
 					{
 						/* Looks good. Fill in the hash functions */
@@ -2342,17 +2341,11 @@ convert_saop_to_hashed_saop_walker(Node *node, void *context)
 					get_op_hash_functions(negator, &lefthashfunc, &righthashfunc) &&
 					lefthashfunc == righthashfunc)
 				{
-					Datum		arrdatum = ((Const *) arrayarg)->constvalue;
-					ArrayType  *arr = (ArrayType *) DatumGetPointer(arrdatum);
-					int			nitems;
-
 					/*
 					 * Only fill in the hash functions if the array looks
 					 * large enough for it to be worth hashing instead of
 					 * doing a linear search.
 					 */
-					nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
-
 					if (nitems >= MIN_ARRAY_SIZE_FOR_HASHED_SAOP)
 					{
 						/* Looks good. Fill in the hash functions */
@@ -2373,6 +2366,72 @@ convert_saop_to_hashed_saop_walker(Node *node, void *context)
 	return expression_tree_walker(node, convert_saop_to_hashed_saop_walker, NULL);
 }
 
+/*
+ * Subroutine for convert_saop_to_hashed_saop: return the number of elements
+ * of a ScalarArrayOpExpr's array argument, or -1 if it can't be hashed.
+ *
+ * Besides non-null Consts, we accept expressions built only from Consts,
+ * PARAM_EXTERN Params and immutable functions, since their value stays the
+ * same for the whole execution and the executor builds the hash table on
+ * first use.  (Stable functions are not safe here: an expression state can
+ * outlive a single scan.)  If the length of such an array can't be
+ * determined, as for a plain Param, assume it is worth hashing: the table is
+ * built only once per execution, so that costs little even if the array
+ * turns out to be short.
+ */
+static int
+hashed_saop_array_length(Expr *arrayarg)
+{
+	if (arrayarg == NULL)
+		return -1;
+
+	if (IsA(arrayarg, Const))
+	{
+		ArrayType  *arr;
+
+		if (((Const *) arrayarg)->constisnull)
+			return -1;
+		arr = (ArrayType *) DatumGetPointer(((Const *) arrayarg)->constvalue);
+		return ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+	}
+
+	if (contain_non_execution_constant_walker((Node *) arrayarg, NULL) ||
+		contain_mutable_functions((Node *) arrayarg) ||
+		expression_returns_set((Node *) arrayarg))
+		return -1;
+
+	if (IsA(arrayarg, ArrayExpr) && !((ArrayExpr *) arrayarg)->multidims)
+		return list_length(((ArrayExpr *) arrayarg)->elements);
+
+	return MIN_ARRAY_SIZE_FOR_HASHED_SAOP;
+}
+
+/*
+ * Does the expression contain anything whose value might change during
+ * execution, other than mutable functions?  That's Vars, and Params other
+ * than PARAM_EXTERN ones, plus anything that could hide those.
+ */
+static bool
+contain_non_execution_constant_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Var) ||
+		IsA(node, PlaceHolderVar) ||
+		IsA(node, Aggref) ||
+		IsA(node, WindowFunc) ||
+		IsA(node, GroupingFunc) ||
+		IsA(node, SubLink) ||
+		IsA(node, SubPlan) ||
+		IsA(node, AlternativeSubPlan) ||
+		IsA(node, CurrentOfExpr))
+		return true;
+	if (IsA(node, Param) && ((Param *) node)->paramkind != PARAM_EXTERN)
+		return true;
+	return expression_tree_walker(node, contain_non_execution_constant_walker,
+								  context);
+}
+
 
 /*--------------------
  * estimate_expression_value
@@ -26,6 +26,10 @@
 #include <sys/mman.h>
 #include <sys/shm.h>
 #include <sys/stat.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
 
 #include "miscadmin.h"
 #include "port/pg_bitutils.h"
@@ -66,6 +70,17 @@
  * to sysv (though this is not the default).
  */
 
+/*
+ * NUMA placement of the main segment uses the raw mbind(2) and
+ * get_mempolicy(2) system calls, so that we don't need to depend on libnuma.
+ * NUMA_MAX_NODES bounds the size of the node masks we pass to the kernel.
+ */
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_get_mempolicy) && \
+	defined(MPOL_F_MEMS_ALLOWED)
+#define USE_SHMEM_NUMA
+#define NUMA_MAX_NODES 1024
+#endif
+
 
 typedef key_t IpcMemoryKey;		/* shared memory key passed to shmget(2) */
 typedef int IpcMemoryId;		/* shared memory ID returned by shmget(2) */
@@ -100,6 +115,7 @@ static void *AnonymousShmem = NULL;
 static void *InternalIpcMemoryCreate(IpcMemoryKey memKey, Size size);
 static void IpcMemoryDetach(int status, Datum shmaddr);
 static void IpcMemoryDelete(int status, Datum shmId);
+static void ApplySharedMemoryNumaPolicy(void *addr, Size size);
 static IpcMemoryState PGSharedMemoryAttach(IpcMemoryId shmId,
 										   void *attachAt,
 										   PGShmemHeader **addr);
@@ -258,6 +274,13 @@ InternalIpcMemoryCreate(IpcMemoryKey memKey, Size size)
 		elog(FATAL, "shmat(id=%d, addr=%p, flags=0x%x) failed: %m",
 			 shmid, requestedAddress, PG_SHMAT_FLAGS);
 
+	/*
+	 * For a small interlock-only segment this is pointless, but when
+	 * shared_memory_type = sysv, this is the main segment.
+	 */
+	if (shared_memory_type == SHMEM_TYPE_SYSV)
+		ApplySharedMemoryNumaPolicy(memAddress, size);
+
 	/* Register on-exit routine to detach new segment before deleting */
 	on_shmem_exit(IpcMemoryDetach, PointerGetDatum(memAddress));
 
@@ -588,6 +611,74 @@ check_huge_page_size(int *newval, void **extra, GucSource source)
 	return true;
 }
 
+/*
+ * GUC check_hook for shared_memory_numa
+ */
+bool
+check_shared_memory_numa(int *newval, void **extra, GucSource source)
+{
+#ifndef USE_SHMEM_NUMA
+	if (*newval != SHMEM_NUMA_OFF)
+	{
+		GUC_check_errdetail("shared_memory_numa must be set to \"off\" on this platform.");
+		return false;
+	}
+#endif
+	return true;
+}
+
+/*
+ * Apply the memory policy selected by shared_memory_numa to a newly created
+ * segment.  This must happen before any of its pages are touched, since the
+ * kernel places each page on first access and never moves it afterwards.
+ *
+ * With "interleave", pages are spread round-robin across all the nodes we are
+ * allowed to allocate from, so that the buffer pool and the buffer
+ * descriptors don't all end up on whichever node the postmaster happened to
+ * run on.  Failure is not fatal: the segment is still usable, just with the
+ * default placement.
+ */
+static void
+ApplySharedMemoryNumaPolicy(void *addr, Size size)
+{
+#ifdef USE_SHMEM_NUMA
+	unsigned long nodemask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	int			nnodes;
+	char		buf[32];
+
+	if (shared_memory_numa == SHMEM_NUMA_OFF)
+		return;
+
+	memset(nodemask, 0, sizeof(nodemask));
+	if (syscall(SYS_get_mempolicy, NULL, nodemask,
+				(unsigned long) NUMA_MAX_NODES, NULL,
+				MPOL_F_MEMS_ALLOWED) != 0)
+	{
+		ereport(WARNING,
+				(errmsg("could not determine available NUMA nodes: %m")));
+		return;
+	}
+
+	/* Nothing to gain on a single-node machine */
+	nnodes = pg_popcount((const char *) nodemask, sizeof(nodemask));
+	if (nnodes <= 1)
+		return;
+
+	/* mbind() wants one more than the number of bits in the mask */
+	if (syscall(SYS_mbind, addr, (unsigned long) size, MPOL_INTERLEAVE,
+				nodemask, (unsigned long) NUMA_MAX_NODES + 1, 0) != 0)
+	{
+		ereport(WARNING,
+				(errmsg("could not interleave shared memory across NUMA nodes: %m")));
+		return;
+	}
+
+	snprintf(buf, sizeof(buf), "%d", nnodes);
+	SetConfigOption("shared_memory_numa_nodes", buf,
+					PGC_INTERNAL, PGC_S_DYNAMIC_DEFAULT);
+#endif
+}
+
 /*
  * Creates an anonymous mmap()ed shared memory segment.
  *
@@ -663,6 +754,8 @@ CreateAnonymousSegment(Size *size)
 						 allocsize) : 0));
 	}
 
+	ApplySharedMemoryNumaPolicy(ptr, allocsize);
+
 	*size = allocsize;
 	return ptr;
 }
@@ -648,3 +648,17 @@ check_huge_page_size(int *newval, void **extra, GucSource source)
 	}
 	return true;
 }
+
+/*
+ * GUC check_hook for shared_memory_numa
+ */
+bool
+check_shared_memory_numa(int *newval, void **extra, GucSource source)
+{
+	if (*newval != SHMEM_NUMA_OFF)
+	{
+		GUC_check_errdetail("shared_memory_numa must be set to \"off\" on this platform.");
+		return false;
+	}
+	return true;
+}
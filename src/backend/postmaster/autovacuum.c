@@ -192,6 +192,14 @@ typedef struct av_relation
 								 * reloptions, or NULL if none */
 } av_relation;
 
+/* struct to keep track of tables to vacuum and/or analyze, in priority order */
+typedef struct av_candidate
+{
+	Oid			ac_relid;
+	bool		ac_wraparound;	/* vacuum forced to prevent wraparound? */
+	double		ac_priority;	/* see relation_needs_vacanalyze */
+} av_candidate;
+
 /* struct to keep track of tables to vacuum and/or analyze, after rechecking */
 typedef struct autovac_table
 {
@@ -336,7 +344,9 @@ static void relation_needs_vacanalyze(Oid relid, AutoVacOpts *relopts,
 									  Form_pg_class classForm,
 									  PgStat_StatTabEntry *tabentry,
 									  int effective_multixact_freeze_max_age,
-									  bool *dovacuum, bool *doanalyze, bool *wraparound);
+									  bool *dovacuum, bool *doanalyze, bool *wraparound,
+									  double *priority);
+static int	av_candidate_cmp(const ListCell *a, const ListCell *b);
 
 static void autovacuum_do_vac_analyze(autovac_table *tab,
 									  BufferAccessStrategy bstrategy);
@@ -1877,6 +1887,7 @@ do_autovacuum(void)
 	TableScanDesc relScan;
 	Form_pg_database dbForm;
 	List	   *table_oids = NIL;
+	List	   *candidates = NIL;
 	List	   *orphan_oids = NIL;
 	HASHCTL		ctl;
 	HTAB	   *table_toast_map;
@@ -1982,6 +1993,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		double		priority;
 
 		if (classForm->relkind != RELKIND_RELATION &&
 			classForm->relkind != RELKIND_MATVIEW)
@@ -2022,11 +2034,19 @@ do_autovacuum(void)
 		/* Check if it needs vacuum or analyze */
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound,
+								  &priority);
 
-		/* Relations that need work are added to table_oids */
+		/* Relations that need work are added to the candidates */
 		if (dovacuum || doanalyze)
-			table_oids = lappend_oid(table_oids, relid);
+		{
+			av_candidate *cand = palloc(sizeof(av_candidate));
+
+			cand->ac_relid = relid;
+			cand->ac_wraparound = wraparound;
+			cand->ac_priority = priority;
+			candidates = lappend(candidates, cand);
+		}
 
 		/*
 		 * Remember TOAST associations for the second pass.  Note: we must do
@@ -2075,6 +2095,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		double		priority;
 
 		/*
 		 * We cannot safely process other backends' temp tables, so skip 'em.
@@ -2105,16 +2126,36 @@ do_autovacuum(void)
 
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound,
+								  &priority);
 
 		/* ignore analyze for toast tables */
 		if (dovacuum)
-			table_oids = lappend_oid(table_oids, relid);
+		{
+			av_candidate *cand = palloc(sizeof(av_candidate));
+
+			cand->ac_relid = relid;
+			cand->ac_wraparound = wraparound;
+			cand->ac_priority = priority;
+			candidates = lappend(candidates, cand);
+		}
 	}
 
 	table_endscan(relScan);
 	table_close(classRel, AccessShareLock);
 
+	/*
+	 * Process the most urgent tables first: those that must be vacuumed to
+	 * prevent wraparound, and then the ones that are furthest past their
+	 * thresholds.  Otherwise, a small, heavily updated table placed after a
+	 * huge one in pg_class could have to wait for the huge one to finish.
+	 */
+	list_sort(candidates, av_candidate_cmp);
+	foreach(cell, candidates)
+		table_oids = lappend_oid(table_oids,
+								 ((av_candidate *) lfirst(cell))->ac_relid);
+	list_free_deep(candidates);
+
 	/*
 	 * Recheck orphan temporary tables, and if they still seem orphaned, drop
 	 * them.  We'll eat a transaction per dropped table, which might seem
@@ -2608,6 +2649,10 @@ perform_work_item(AutoVacuumWorkItem *workitem)
 									ObjectIdGetDatum(workitem->avw_relation),
 									Int64GetDatum((int64) workitem->avw_blockNumber));
 				break;
+			case AVW_GINCleanPendingList:
+				DirectFunctionCall1(gin_clean_pending_list,
+									ObjectIdGetDatum(workitem->avw_relation));
+				break;
 			default:
 				elog(WARNING, "unrecognized work item found: type %d",
 					 workitem->avw_type);
@@ -2850,6 +2895,7 @@ recheck_relation_needs_vacanalyze(Oid relid,
 								  bool *wraparound)
 {
 	PgStat_StatTabEntry *tabentry;
+	double		priority;
 
 	/* fetch the pgstat table entry */
 	tabentry = pgstat_fetch_stat_tabentry_ext(classForm->relisshared,
@@ -2857,7 +2903,7 @@ recheck_relation_needs_vacanalyze(Oid relid,
 
 	relation_needs_vacanalyze(relid, avopts, classForm, tabentry,
 							  effective_multixact_freeze_max_age,
-							  dovacuum, doanalyze, wraparound);
+							  dovacuum, doanalyze, wraparound, &priority);
 
 	/* ignore ANALYZE for toast tables */
 	if (classForm->relkind == RELKIND_TOASTVALUE)
@@ -2871,6 +2917,11 @@ recheck_relation_needs_vacanalyze(Oid relid,
  * "dovacuum" and "doanalyze", respectively.  Also return whether the vacuum is
  * being forced because of Xid or multixact wraparound.
  *
+ * "priority" is set to a measure of how urgently the relation needs work, used
+ * to decide the order in which to process tables: for a forced vacuum, how far
+ * its relfrozenxid or relminmxid age is into freeze_max_age, otherwise the
+ * largest ratio of a tuple count to its threshold.
+ *
  * relopts is a pointer to the AutoVacOpts options (either for itself in the
  * case of a plain table, or for either itself or its parent table in the case
  * of a TOAST table), NULL if none; tabentry is the pgstats entry, which can be
@@ -2910,7 +2961,8 @@ relation_needs_vacanalyze(Oid relid,
  /* output params below */
 						  bool *dovacuum,
 						  bool *doanalyze,
-						  bool *wraparound)
+						  bool *wraparound,
+						  double *priority)
 {
 	bool		force_vacuum;
 	bool		av_enabled;
@@ -3005,6 +3057,18 @@ relation_needs_vacanalyze(Oid relid,
 	}
 	*wraparound = force_vacuum;
 
+	*priority = 0;
+	if (force_vacuum)
+	{
+		if (TransactionIdIsNormal(relfrozenxid))
+			*priority = (double) (recentXid - relfrozenxid) /
+				Max(freeze_max_age, 1);
+		if (MultiXactIdIsValid(classForm->relminmxid))
+			*priority = Max(*priority,
+							(double) (recentMulti - classForm->relminmxid) /
+							Max(multixact_freeze_max_age, 1));
+	}
+
 	/* User disabled it in pg_class.reloptions?  (But ignore if at risk) */
 	if (!av_enabled && !force_vacuum)
 	{
@@ -3053,6 +3117,14 @@ relation_needs_vacanalyze(Oid relid,
 		*dovacuum = force_vacuum || (vactuples > vacthresh) ||
 			(vac_ins_base_thresh >= 0 && instuples > vacinsthresh);
 		*doanalyze = (anltuples > anlthresh);
+
+		if (!force_vacuum)
+		{
+			*priority = Max(vactuples / Max(vacthresh, 1),
+							anltuples / Max(anlthresh, 1));
+			if (vac_ins_base_thresh >= 0)
+				*priority = Max(*priority, instuples / Max(vacinsthresh, 1));
+		}
 	}
 	else
 	{
@@ -3070,6 +3142,25 @@ relation_needs_vacanalyze(Oid relid,
 		*doanalyze = false;
 }
 
+/*
+ * list_sort comparator for av_candidate: wraparound vacuums first, then by
+ * descending priority.
+ */
+static int
+av_candidate_cmp(const ListCell *a, const ListCell *b)
+{
+	av_candidate *ca = (av_candidate *) lfirst(a);
+	av_candidate *cb = (av_candidate *) lfirst(b);
+
+	if (ca->ac_wraparound != cb->ac_wraparound)
+		return ca->ac_wraparound ? -1 : 1;
+	if (ca->ac_priority > cb->ac_priority)
+		return -1;
+	if (ca->ac_priority < cb->ac_priority)
+		return 1;
+	return 0;
+}
+
 /*
  * autovacuum_do_vac_analyze
  *		Vacuum and/or analyze the specified table
@@ -3162,6 +3253,10 @@ autovac_report_workitem(AutoVacuumWorkItem *workitem,
 			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
 					 "autovacuum: BRIN summarize");
 			break;
+		case AVW_GINCleanPendingList:
+			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
+					 "autovacuum: GIN pending list cleanup");
+			break;
 	}
 
 	/*
@@ -3209,6 +3304,26 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 
 	LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
 
+	/*
+	 * If the same work is already queued and not yet started, there's no
+	 * need to queue it again.  Callers such as GIN insertion may ask
+	 * repeatedly until the work gets done.
+	 */
+	for (i = 0; i < NUM_WORKITEMS; i++)
+	{
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[i];
+
+		if (workitem->avw_used && !workitem->avw_active &&
+			workitem->avw_type == type &&
+			workitem->avw_database == MyDatabaseId &&
+			workitem->avw_relation == relationId &&
+			workitem->avw_blockNumber == blkno)
+		{
+			LWLockRelease(AutovacuumLock);
+			return true;
+		}
+	}
+
 	/*
 	 * Locate an unused work item and fill it with the given data.
 	 */
@@ -496,6 +496,9 @@ PostmasterMain(int argc, char *argv[])
 
 	InitProcessGlobals();
 
+	/* Choose the time source for instrumentation; children inherit it. */
+	pg_initialize_timing();
+
 	PostmasterPid = MyProcPid;
 
 	IsPostmasterEnvironment = true;
@@ -925,9 +928,10 @@ PostmasterMain(int argc, char *argv[])
 
 	/*
 	 * Now that loadable modules have had their chance to alter any GUCs,
-	 * calculate MaxBackends.
+	 * calculate MaxBackends and the number of fast-path lock groups.
 	 */
 	InitializeMaxBackends();
+	InitializeFastPathLocks();
 
 	/*
 	 * Give preloaded libraries a chance to request additional shared memory.
@@ -252,6 +252,9 @@ WalWriterMain(char *startup_data, size_t startup_data_len)
 		else if (left_till_hibernate > 0)
 			left_till_hibernate--;
 
+		/* Create WAL segments ahead of need, so that backends don't have to */
+		XLogPreallocateSegments();
+
 		/* report pending statistics to the cumulative stats system */
 		pgstat_report_wal(false);
 
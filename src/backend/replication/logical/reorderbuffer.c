@@ -88,6 +88,9 @@
 
 #include <unistd.h>
 #include <sys/stat.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
 
 #include "access/detoast.h"
 #include "access/heapam.h"
@@ -97,13 +100,16 @@
 #include "access/xlog_internal.h"
 #include "catalog/catalog.h"
 #include "common/int.h"
+#include "common/pg_lzcompress.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
+#include "pg_trace.h"
 #include "pgstat.h"
 #include "replication/logical.h"
 #include "replication/reorderbuffer.h"
 #include "replication/slot.h"
 #include "replication/snapbuild.h"	/* just for SnapBuildSnapDecRefcount */
+#include "storage/buffile.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
 #include "storage/sinval.h"
@@ -181,6 +187,25 @@ typedef struct ReorderBufferDiskChange
 	/* data follows */
 } ReorderBufferDiskChange;
 
+/*
+ * If a change's data was compressed, that is flagged in the high bit of
+ * ReorderBufferDiskChange.size, and the data starts with this header.  That
+ * way changes stored raw, including all changes when compression is off,
+ * take no more space than before.
+ */
+#define REORDER_DISK_CHANGE_COMPRESSED \
+	((Size) 1 << (sizeof(Size) * BITS_PER_BYTE - 1))
+
+typedef struct ReorderBufferDiskCompressed
+{
+	uint32		rawsize;		/* uncompressed size of the data */
+	int32		compression;	/* TEMP_FILE_COMPRESSION_* method */
+	/* compressed data follows */
+} ReorderBufferDiskCompressed;
+
+/* don't bother trying to compress the data of smaller changes */
+#define SPILL_COMPRESS_MIN_SIZE		128
+
 #define IsSpecInsert(action) \
 ( \
 	((action) == REORDER_BUFFER_CHANGE_INTERNAL_SPEC_INSERT) \
@@ -212,8 +237,9 @@ typedef struct ReorderBufferDiskChange
 int			logical_decoding_work_mem;
 static const Size max_changes_in_memory = 4096; /* XXX for restore only */
 
-/* GUC variable */
+/* GUC variables */
 int			debug_logical_replication_streaming = DEBUG_LOGICAL_REP_STREAMING_BUFFERED;
+int			logical_decoding_spill_compression = TEMP_FILE_COMPRESSION_NONE;
 
 /* ---------------------------------------
  * primary reorderbuffer support routines
@@ -359,6 +385,8 @@ ReorderBufferAllocate(void)
 
 	buffer->outbuf = NULL;
 	buffer->outbufsize = 0;
+	buffer->compressbuf = NULL;
+	buffer->compressbufsize = 0;
 	buffer->size = 0;
 
 	/* txn_heap is ordered by transaction size */
@@ -2115,6 +2143,14 @@ ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
 		int			changes_count = 0;	/* used to accumulate the number of
 										 * changes */
 
+		/*
+		 * Relation used by the previous data change, kept open because runs
+		 * of changes to the same relation are the norm.  It is forgotten
+		 * whenever the catalog view may have changed.
+		 */
+		Relation	lastrel = NULL;
+		RelFileLocator lastrlocator = {0};
+
 		if (using_subtxn)
 			BeginInternalSubTransaction(streaming ? "stream" : "replay");
 		else
@@ -2195,6 +2231,22 @@ ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
 				case REORDER_BUFFER_CHANGE_DELETE:
 					Assert(snapshot_now);
 
+					/* Same relation as last time, and still valid? */
+					if (lastrel != NULL &&
+						RelFileLocatorEquals(lastrlocator,
+											 change->data.tp.rlocator) &&
+						lastrel->rd_isvalid)
+					{
+						relation = lastrel;
+						goto have_relation;
+					}
+
+					if (lastrel != NULL)
+					{
+						RelationClose(lastrel);
+						lastrel = NULL;
+					}
+
 					reloid = RelidByRelfilenumber(change->data.tp.rlocator.spcOid,
 												  change->data.tp.rlocator.relNumber);
 
@@ -2227,6 +2279,10 @@ ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
 							 relpathperm(change->data.tp.rlocator,
 										 MAIN_FORKNUM));
 
+					lastrel = relation;
+					lastrlocator = change->data.tp.rlocator;
+
+			have_relation:
 					if (!RelationIsLogicallyLogged(relation))
 						goto change_done;
 
@@ -2291,11 +2347,8 @@ ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
 						specinsert = NULL;
 					}
 
-					if (RelationIsValid(relation))
-					{
-						RelationClose(relation);
-						relation = NULL;
-					}
+					/* the relation itself stays open as lastrel */
+					relation = NULL;
 					break;
 
 				case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_INSERT:
@@ -2391,12 +2444,24 @@ ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
 					break;
 
 				case REORDER_BUFFER_CHANGE_INVALIDATION:
+					if (lastrel != NULL)
+					{
+						RelationClose(lastrel);
+						lastrel = NULL;
+					}
+
 					/* Execute the invalidation messages locally */
 					ReorderBufferExecuteInvalidations(change->data.inval.ninvalidations,
 													  change->data.inval.invalidations);
 					break;
 
 				case REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT:
+					if (lastrel != NULL)
+					{
+						RelationClose(lastrel);
+						lastrel = NULL;
+					}
+
 					/* get rid of the old */
 					TeardownHistoricSnapshot(false);
 
@@ -2433,6 +2498,12 @@ ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 					if (command_id < change->data.command_id)
 					{
+						if (lastrel != NULL)
+						{
+							RelationClose(lastrel);
+							lastrel = NULL;
+						}
+
 						command_id = change->data.command_id;
 
 						if (!snapshot_now->copied)
@@ -2474,6 +2545,9 @@ ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
 			}
 		}
 
+		if (lastrel != NULL)
+			RelationClose(lastrel);
+
 		/* speculative insertion record must be freed by now */
 		Assert(!specinsert);
 
@@ -3502,6 +3576,124 @@ ReorderBufferSerializeReserve(ReorderBuffer *rb, Size sz)
 	}
 }
 
+/*
+ * Like ReorderBufferSerializeReserve, for the (de)compression scratch buffer.
+ */
+static void
+ReorderBufferCompressReserve(ReorderBuffer *rb, Size sz)
+{
+	if (rb->compressbufsize < sz)
+	{
+		if (rb->compressbuf)
+			pfree(rb->compressbuf);
+		rb->compressbuf = MemoryContextAlloc(rb->context, sz);
+		rb->compressbufsize = sz;
+	}
+}
+
+/*
+ * Try to compress the data part of the serialized change in rb->outbuf,
+ * which is sz bytes long in total, using logical_decoding_spill_compression.
+ * If that makes it smaller, the data is replaced in place by a
+ * ReorderBufferDiskCompressed header and the compressed data, and the
+ * change's size is flagged accordingly.  Returns the number of bytes to
+ * write.
+ */
+static Size
+ReorderBufferCompressChange(ReorderBuffer *rb, Size sz)
+{
+	ReorderBufferDiskChange *ondisk = (ReorderBufferDiskChange *) rb->outbuf;
+	char	   *data = rb->outbuf + sizeof(ReorderBufferDiskChange);
+	int32		rawlen = sz - sizeof(ReorderBufferDiskChange);
+	int32		clen = -1;
+	ReorderBufferDiskCompressed hdr;
+
+	ReorderBufferCompressReserve(rb, PGLZ_MAX_OUTPUT(rawlen));
+
+	switch (logical_decoding_spill_compression)
+	{
+		case TEMP_FILE_COMPRESSION_PGLZ:
+			clen = pglz_compress(data, rawlen, rb->compressbuf,
+								 PGLZ_strategy_default);
+			break;
+		case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			clen = LZ4_compress_default(data, rb->compressbuf,
+										rawlen, rawlen - 1);
+#endif
+			break;
+	}
+
+	/* Keep the data uncompressed if compression didn't make it smaller */
+	if (clen <= 0 || clen + sizeof(ReorderBufferDiskCompressed) >= rawlen)
+		return sz;
+
+	hdr.rawsize = rawlen;
+	hdr.compression = logical_decoding_spill_compression;
+	memcpy(data, &hdr, sizeof(ReorderBufferDiskCompressed));
+	memcpy(data + sizeof(ReorderBufferDiskCompressed), rb->compressbuf, clen);
+
+	sz = sizeof(ReorderBufferDiskChange) +
+		sizeof(ReorderBufferDiskCompressed) + clen;
+	ondisk->size = sz | REORDER_DISK_CHANGE_COMPRESSED;
+
+	return sz;
+}
+
+/*
+ * Reverse ReorderBufferCompressChange() for a change read back into
+ * rb->outbuf, whose size has already had REORDER_DISK_CHANGE_COMPRESSED
+ * cleared.
+ */
+static void
+ReorderBufferDecompressChange(ReorderBuffer *rb)
+{
+	ReorderBufferDiskChange *ondisk = (ReorderBufferDiskChange *) rb->outbuf;
+	char	   *cdata;
+	int32		clen;
+	int32		rawlen;
+	int32		len = -1;
+	ReorderBufferDiskCompressed hdr;
+
+	if (ondisk->size < sizeof(ReorderBufferDiskChange) +
+		sizeof(ReorderBufferDiskCompressed))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("invalid compressed change in reorderbuffer spill file")));
+
+	memcpy(&hdr, rb->outbuf + sizeof(ReorderBufferDiskChange),
+		   sizeof(ReorderBufferDiskCompressed));
+	cdata = rb->outbuf + sizeof(ReorderBufferDiskChange) +
+		sizeof(ReorderBufferDiskCompressed);
+	clen = ondisk->size - sizeof(ReorderBufferDiskChange) -
+		sizeof(ReorderBufferDiskCompressed);
+	rawlen = hdr.rawsize;
+
+	ReorderBufferCompressReserve(rb, rawlen);
+
+	switch (hdr.compression)
+	{
+		case TEMP_FILE_COMPRESSION_PGLZ:
+			len = pglz_decompress(cdata, clen, rb->compressbuf, rawlen, true);
+			break;
+		case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			len = LZ4_decompress_safe(cdata, rb->compressbuf, clen, rawlen);
+#endif
+			break;
+	}
+	if (len != rawlen)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("could not decompress change in reorderbuffer spill file")));
+
+	ReorderBufferSerializeReserve(rb, sizeof(ReorderBufferDiskChange) + rawlen);
+	ondisk = (ReorderBufferDiskChange *) rb->outbuf;
+	memcpy(rb->outbuf + sizeof(ReorderBufferDiskChange), rb->compressbuf,
+		   rawlen);
+	ondisk->size = sizeof(ReorderBufferDiskChange) + rawlen;
+}
+
 
 /* Compare two transactions by size */
 static int
@@ -3690,6 +3882,8 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 	elog(DEBUG2, "spill %u changes in XID %u to disk",
 		 (uint32) txn->nentries_mem, txn->xid);
 
+	TRACE_POSTGRESQL_REORDERBUFFER_SPILL_START(txn->xid, size);
+
 	/* do the same to all child TXs */
 	dlist_foreach(subtxn_i, &txn->subtxns)
 	{
@@ -3760,6 +3954,8 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 		UpdateDecodingStats((LogicalDecodingContext *) rb->private_data);
 	}
 
+	TRACE_POSTGRESQL_REORDERBUFFER_SPILL_DONE(txn->xid, spilled, size);
+
 	Assert(spilled == txn->nentries_mem);
 	Assert(dlist_is_empty(&txn->changes));
 	txn->nentries_mem = 0;
@@ -3955,9 +4151,13 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 	ondisk->size = sz;
 
+	if (logical_decoding_spill_compression != TEMP_FILE_COMPRESSION_NONE &&
+		sz - sizeof(ReorderBufferDiskChange) >= SPILL_COMPRESS_MIN_SIZE)
+		sz = ReorderBufferCompressChange(rb, sz);
+
 	errno = 0;
 	pgstat_report_wait_start(WAIT_EVENT_REORDER_BUFFER_WRITE);
-	if (write(fd, rb->outbuf, ondisk->size) != ondisk->size)
+	if (write(fd, rb->outbuf, sz) != sz)
 	{
 		int			save_errno = errno;
 
@@ -4254,6 +4454,7 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 	{
 		int			readBytes;
 		ReorderBufferDiskChange *ondisk;
+		bool		compressed;
 
 		CHECK_FOR_INTERRUPTS();
 
@@ -4324,6 +4525,8 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 		file->curOffset += readBytes;
 
 		ondisk = (ReorderBufferDiskChange *) rb->outbuf;
+		compressed = (ondisk->size & REORDER_DISK_CHANGE_COMPRESSED) != 0;
+		ondisk->size &= ~REORDER_DISK_CHANGE_COMPRESSED;
 
 		ReorderBufferSerializeReserve(rb,
 									  sizeof(ReorderBufferDiskChange) + ondisk->size);
@@ -4348,6 +4551,9 @@ ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 		file->curOffset += readBytes;
 
+		if (compressed)
+			ReorderBufferDecompressChange(rb);
+
 		/*
 		 * ok, read a full change from disk, now restore it into proper
 		 * in-memory format
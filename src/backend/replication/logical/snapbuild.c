@@ -548,6 +548,8 @@ SnapBuildBuildSnapshot(SnapBuild *builder)
 	snapshot->subxip = NULL;
 
 	snapshot->suboverflowed = false;
+	snapshot->xidssorted = false;
+	snapshot->xidsearches = 0;
 	snapshot->takenDuringRecovery = false;
 	snapshot->copied = false;
 	snapshot->curcid = FirstCommandId;
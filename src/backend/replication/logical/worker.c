@@ -215,6 +215,27 @@ typedef struct ApplyExecutionData
 	PartitionTupleRouting *proute;	/* partition routing info */
 } ApplyExecutionData;
 
+/*
+ * Consecutive INSERTs into the same plain table are collected and applied
+ * together with table_multi_insert(), as COPY does, so that we don't pay for
+ * executor setup and a separate heap insertion for every replicated row.  The
+ * batch is applied once it is full, when an INSERT for another relation
+ * arrives, or before any other kind of message is processed.
+ */
+#define APPLY_INSERT_BATCH_TUPLES	1000
+#define APPLY_INSERT_BATCH_BYTES	65535
+
+typedef struct ApplyInsertBatch
+{
+	ApplyExecutionData *edata;	/* NULL if no batch is in progress */
+	TupleTableSlot *remoteslot; /* scratch slot for decoding remote rows */
+	int			nslots;			/* number of buffered tuples */
+	Size		nbytes;			/* approx. size of buffered tuple data */
+	TupleTableSlot *slots[APPLY_INSERT_BATCH_TUPLES];
+} ApplyInsertBatch;
+
+static ApplyInsertBatch insert_batch;
+
 /* Struct for saving and restoring apply errcontext information */
 typedef struct ApplyErrorCallbackArg
 {
@@ -382,6 +403,9 @@ static void apply_handle_commit_internal(LogicalRepCommitData *commit_data);
 static void apply_handle_insert_internal(ApplyExecutionData *edata,
 										 ResultRelInfo *relinfo,
 										 TupleTableSlot *remoteslot);
+static void apply_insert_batch_add(LogicalRepTupleData *newtup);
+static void apply_insert_batch_flush(void);
+static void apply_flush_pending_inserts(void);
 static void apply_handle_update_internal(ApplyExecutionData *edata,
 										 ResultRelInfo *relinfo,
 										 TupleTableSlot *remoteslot,
@@ -2118,6 +2142,9 @@ apply_spooled_messages(FileSet *stream_fileset, TransactionId xid,
 	if (stream_fd)
 		stream_close_file();
 
+	/* Apply any inserts still batched up from the replayed changes */
+	apply_flush_pending_inserts();
+
 	elog(DEBUG1, "replayed %d (all) changes from file \"%s\"",
 		 nchanges, path);
 
@@ -2391,6 +2418,22 @@ apply_handle_insert(StringInfo s)
 	begin_replication_step();
 
 	relid = logicalrep_read_insert(s, &newtup);
+
+	/*
+	 * If we're collecting inserts for this relation, just add the row to the
+	 * batch.  An insert into some other relation ends the batch.
+	 */
+	if (insert_batch.edata != NULL)
+	{
+		if (insert_batch.edata->targetRel->remoterel.remoteid == relid)
+		{
+			apply_insert_batch_add(&newtup);
+			end_replication_step();
+			return;
+		}
+		apply_insert_batch_flush();
+	}
+
 	rel = logicalrep_rel_open(relid, RowExclusiveLock);
 	if (!should_apply_changes_for_rel(rel))
 	{
@@ -2403,6 +2446,31 @@ apply_handle_insert(StringInfo s)
 		return;
 	}
 
+	/*
+	 * Start a batch if the relation is a plain table without BEFORE or
+	 * INSTEAD OF row triggers, which must see each row before it's stored.
+	 */
+	if (rel->localrel->rd_rel->relkind == RELKIND_RELATION &&
+		(rel->localrel->trigdesc == NULL ||
+		 (!rel->localrel->trigdesc->trig_insert_before_row &&
+		  !rel->localrel->trigdesc->trig_insert_instead_row)))
+	{
+		oldctx = MemoryContextSwitchTo(ApplyContext);
+		insert_batch.edata = edata = create_edata_for_relation(rel);
+		MemoryContextSwitchTo(edata->estate->es_query_cxt);
+		insert_batch.remoteslot =
+			ExecInitExtraTupleSlot(edata->estate,
+								   RelationGetDescr(rel->localrel),
+								   &TTSOpsVirtual);
+		MemoryContextSwitchTo(oldctx);
+		insert_batch.nslots = 0;
+		insert_batch.nbytes = 0;
+
+		apply_insert_batch_add(&newtup);
+		end_replication_step();
+		return;
+	}
+
 	/*
 	 * Make sure that any user-supplied code runs as the table owner, unless
 	 * the user has opted out of that behavior.
@@ -2448,6 +2516,139 @@ apply_handle_insert(StringInfo s)
 	end_replication_step();
 }
 
+/*
+ * Add a remote row to the current insert batch, applying it if the batch
+ * is then full.
+ */
+static void
+apply_insert_batch_add(LogicalRepTupleData *newtup)
+{
+	ApplyExecutionData *edata = insert_batch.edata;
+	LogicalRepRelMapEntry *rel = edata->targetRel;
+	EState	   *estate = edata->estate;
+	TupleTableSlot *slot;
+	UserContext ucxt;
+	MemoryContext oldctx;
+	bool		run_as_owner;
+
+	/* Default expressions are user-supplied code, so run them as owner */
+	run_as_owner = MySubscription->runasowner;
+	if (!run_as_owner)
+		SwitchToUntrustedUser(rel->localrel->rd_rel->relowner, &ucxt);
+
+	/* Set relation for error callback */
+	apply_error_callback_arg.rel = rel;
+
+	/* Process the remote tuple, then copy it into a batch slot */
+	oldctx = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+	slot_store_data(insert_batch.remoteslot, rel, newtup);
+	slot_fill_defaults(rel, estate, insert_batch.remoteslot);
+
+	MemoryContextSwitchTo(estate->es_query_cxt);
+	slot = insert_batch.slots[insert_batch.nslots];
+	if (slot == NULL)
+		slot = insert_batch.slots[insert_batch.nslots] =
+			table_slot_create(rel->localrel, &estate->es_tupleTable);
+	ExecCopySlot(slot, insert_batch.remoteslot);
+	MemoryContextSwitchTo(oldctx);
+
+	ExecClearTuple(insert_batch.remoteslot);
+	ResetPerTupleExprContext(estate);
+
+	insert_batch.nslots++;
+	for (int i = 0; i < newtup->ncols; i++)
+		insert_batch.nbytes += newtup->colvalues[i].len;
+
+	/* Reset relation for error callback */
+	apply_error_callback_arg.rel = NULL;
+
+	if (!run_as_owner)
+		RestoreUserContext(&ucxt);
+
+	if (insert_batch.nslots >= APPLY_INSERT_BATCH_TUPLES ||
+		insert_batch.nbytes >= APPLY_INSERT_BATCH_BYTES)
+		apply_insert_batch_flush();
+}
+
+/*
+ * Apply the rows collected in the current insert batch, and end the batch.
+ *
+ * Must be called within a replication step.
+ */
+static void
+apply_insert_batch_flush(void)
+{
+	ApplyExecutionData *edata = insert_batch.edata;
+	LogicalRepRelMapEntry *rel;
+	ResultRelInfo *relinfo;
+	LogicalRepMsgType saved_command;
+	UserContext ucxt;
+	bool		run_as_owner;
+
+	if (edata == NULL)
+		return;
+
+	rel = edata->targetRel;
+	relinfo = edata->targetRelInfo;
+
+	run_as_owner = MySubscription->runasowner;
+	if (!run_as_owner)
+		SwitchToUntrustedUser(rel->localrel->rd_rel->relowner, &ucxt);
+
+	/* Errors from here on are reported against the batched INSERTs */
+	saved_command = apply_error_callback_arg.command;
+	apply_error_callback_arg.command = LOGICAL_REP_MSG_INSERT;
+	apply_error_callback_arg.rel = rel;
+
+	if (insert_batch.nslots > 0)
+	{
+		/* Commands may have been counted since the batch was started */
+		edata->estate->es_output_cid = GetCurrentCommandId(true);
+
+		ExecOpenIndices(relinfo, false);
+		TargetPrivilegesCheck(relinfo->ri_RelationDesc, ACL_INSERT);
+		ExecSimpleRelationMultiInsert(relinfo, edata->estate,
+									  insert_batch.slots,
+									  insert_batch.nslots);
+		ExecCloseIndices(relinfo);
+	}
+
+	/* This also drops the batch's slots */
+	finish_edata(edata);
+
+	insert_batch.edata = NULL;
+	insert_batch.remoteslot = NULL;
+	memset(insert_batch.slots, 0, sizeof(insert_batch.slots));
+	insert_batch.nslots = 0;
+	insert_batch.nbytes = 0;
+
+	apply_error_callback_arg.rel = NULL;
+	apply_error_callback_arg.command = saved_command;
+
+	if (!run_as_owner)
+		RestoreUserContext(&ucxt);
+
+	logicalrep_rel_close(rel, NoLock);
+}
+
+/*
+ * Apply any pending insert batch in a replication step of its own.
+ */
+static void
+apply_flush_pending_inserts(void)
+{
+	MemoryContext oldctx = CurrentMemoryContext;
+
+	if (insert_batch.edata == NULL)
+		return;
+
+	begin_replication_step();
+	apply_insert_batch_flush();
+	end_replication_step();
+
+	MemoryContextSwitchTo(oldctx);
+}
+
 /*
  * Workhorse for apply_handle_insert()
  * relinfo is for the relation we're actually inserting into
@@ -3280,6 +3481,14 @@ apply_dispatch(StringInfo s)
 	 * command.
 	 */
 	saved_command = apply_error_callback_arg.command;
+
+	/*
+	 * Anything other than another INSERT must see the effects of any inserts
+	 * we've been batching up, so apply them first.
+	 */
+	if (action != LOGICAL_REP_MSG_INSERT)
+		apply_flush_pending_inserts();
+
 	apply_error_callback_arg.command = action;
 
 	switch (action)
@@ -77,6 +77,7 @@
 #include "access/xact.h"
 #include "common/int.h"
 #include "miscadmin.h"
+#include "pg_trace.h"
 #include "pgstat.h"
 #include "replication/syncrep.h"
 #include "replication/walsender.h"
@@ -182,6 +183,22 @@ SyncRepWaitForLSN(XLogRecPtr lsn, bool commit)
 	Assert(dlist_node_is_detached(&MyProc->syncRepLinks));
 	Assert(WalSndCtl != NULL);
 
+#ifdef PG_HAVE_8BYTE_SINGLE_COPY_ATOMICITY
+
+	/*
+	 * Under heavy commit load the standby has frequently already confirmed
+	 * our LSN by the time we get here, because one reply covers many
+	 * commits.  WalSndCtl->lsn[] only ever advances, and a value we see
+	 * there has been confirmed by the required standbys, so it is safe to
+	 * return without taking SyncRepLock, which the WAL senders need
+	 * exclusively to release waiters.  This requires that the 8-byte read
+	 * cannot be torn.
+	 */
+	pg_read_barrier();
+	if (lsn <= ((volatile WalSndCtlData *) WalSndCtl)->lsn[mode])
+		return;
+#endif
+
 	LWLockAcquire(SyncRepLock, LW_EXCLUSIVE);
 	Assert(MyProc->syncRepState == SYNC_REP_NOT_WAITING);
 
@@ -219,6 +236,8 @@ SyncRepWaitForLSN(XLogRecPtr lsn, bool commit)
 		set_ps_display_suffix(buffer);
 	}
 
+	TRACE_POSTGRESQL_SYNCREP_WAIT_START(lsn, mode);
+
 	/*
 	 * Wait for specified LSN to be confirmed.
 	 *
@@ -314,6 +333,8 @@ SyncRepWaitForLSN(XLogRecPtr lsn, bool commit)
 	MyProc->syncRepState = SYNC_REP_NOT_WAITING;
 	MyProc->waitLSN = 0;
 
+	TRACE_POSTGRESQL_SYNCREP_WAIT_DONE(lsn, mode);
+
 	/* reset ps display to remove the suffix */
 	if (update_process_title)
 		set_ps_display_remove_suffix();
@@ -51,6 +51,14 @@
 
 #include <unistd.h>
 
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "access/htup_details.h"
 #include "access/timeline.h"
 #include "access/transam.h"
@@ -74,6 +82,7 @@
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
+#include "utils/memutils.h"
 #include "utils/pg_lsn.h"
 #include "utils/ps_status.h"
 #include "utils/timestamp.h"
@@ -87,6 +96,7 @@
 int			wal_receiver_status_interval;
 int			wal_receiver_timeout;
 bool		hot_standby_feedback;
+int			wal_receiver_compression = PG_COMPRESSION_NONE;
 
 /* libpqwalreceiver connection */
 static WalReceiverConn *wrconn = NULL;
@@ -101,6 +111,14 @@ static int	recvFile = -1;
 static TimeLineID recvFileTLI = 0;
 static XLogSegNo recvSegNo = 0;
 
+/*
+ * Compression requested for the current stream, and the buffer that
+ * CompressedXLogData messages are decompressed into.
+ */
+static pg_compress_algorithm streamCompression = PG_COMPRESSION_NONE;
+static char *decompressBuf = NULL;
+static Size decompressBufSize = 0;
+
 /*
  * LogstreamResult indicates the byte positions that we have already
  * written/fsynced.
@@ -136,6 +154,7 @@ static void WalRcvWaitForStartPosition(XLogRecPtr *startpoint, TimeLineID *start
 static void WalRcvDie(int code, Datum arg);
 static void XLogWalRcvProcessMsg(unsigned char type, char *buf, Size len,
 								 TimeLineID tli);
+static char *XLogWalRcvDecompress(char *buf, Size len, Size rawlen);
 static void XLogWalRcvWrite(char *buf, Size nbytes, XLogRecPtr recptr,
 							TimeLineID tli);
 static void XLogWalRcvFlush(bool dying, TimeLineID tli);
@@ -412,6 +431,8 @@ WalReceiverMain(char *startup_data, size_t startup_data_len)
 		options.startpoint = startpoint;
 		options.slotname = slotname[0] != '\0' ? slotname : NULL;
 		options.proto.physical.startpointTLI = startpointTLI;
+		options.proto.physical.compression = wal_receiver_compression;
+		streamCompression = wal_receiver_compression;
 		if (walrcv_startstreaming(wrconn, &options))
 		{
 			if (first_stream)
@@ -870,6 +891,34 @@ XLogWalRcvProcessMsg(unsigned char type, char *buf, Size len, TimeLineID tli)
 				XLogWalRcvWrite(buf, len, dataStart, tli);
 				break;
 			}
+		case 'z':				/* compressed WAL records */
+			{
+				StringInfoData incoming_message;
+				Size		rawlen;
+
+				hdrlen = sizeof(int64) + sizeof(int64) + sizeof(int64) +
+					sizeof(int32);
+				if (len < hdrlen || streamCompression == PG_COMPRESSION_NONE)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("invalid compressed WAL message received from primary")));
+
+				/* initialize a StringInfo with the given buffer */
+				initReadOnlyStringInfo(&incoming_message, buf, hdrlen);
+
+				/* read the fields */
+				dataStart = pq_getmsgint64(&incoming_message);
+				walEnd = pq_getmsgint64(&incoming_message);
+				sendTime = pq_getmsgint64(&incoming_message);
+				rawlen = (uint32) pq_getmsgint(&incoming_message, 4);
+				ProcessWalSndrMessage(walEnd, sendTime);
+
+				buf += hdrlen;
+				len -= hdrlen;
+				buf = XLogWalRcvDecompress(buf, len, rawlen);
+				XLogWalRcvWrite(buf, rawlen, dataStart, tli);
+				break;
+			}
 		case 'k':				/* Keepalive */
 			{
 				StringInfoData incoming_message;
@@ -903,6 +952,54 @@ XLogWalRcvProcessMsg(unsigned char type, char *buf, Size len, TimeLineID tli)
 	}
 }
 
+/*
+ * Decompress the payload of a CompressedXLogData message, which must expand
+ * to exactly rawlen bytes.  Returns a pointer to the decompressed data, valid
+ * until the next call.
+ */
+static char *
+XLogWalRcvDecompress(char *buf, Size len, Size rawlen)
+{
+	bool		ok = false;
+
+	if (rawlen == 0 || rawlen > MaxAllocSize)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg_internal("invalid compressed WAL message received from primary")));
+
+	if (rawlen > decompressBufSize)
+	{
+		if (decompressBuf)
+			pfree(decompressBuf);
+		decompressBuf = MemoryContextAlloc(TopMemoryContext, rawlen);
+		decompressBufSize = rawlen;
+	}
+
+	switch (streamCompression)
+	{
+		case PG_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			ok = LZ4_decompress_safe(buf, decompressBuf,
+									 len, rawlen) == (int) rawlen;
+#endif
+			break;
+		case PG_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			ok = ZSTD_decompress(decompressBuf, rawlen, buf, len) == rawlen;
+#endif
+			break;
+		default:
+			break;
+	}
+
+	if (!ok)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg_internal("could not decompress WAL message received from primary")));
+
+	return decompressBuf;
+}
+
 /*
  * Write XLOG data to disk.
  */
@@ -961,6 +1058,20 @@ XLogWalRcvWrite(char *buf, Size nbytes, XLogRecPtr recptr, TimeLineID tli)
 							xlogfname, startoff, (unsigned long) segbytes)));
 		}
 
+#ifdef HAVE_SYNC_FILE_RANGE
+
+		/*
+		 * Start writeback of what we just wrote, so that the kernel works on
+		 * it while we go back to receiving more WAL.  That leaves less for
+		 * the fsync in XLogWalRcvFlush() to do, and the flush position we
+		 * report to the primary advances sooner.  Not needed if every write
+		 * is synchronous anyway.
+		 */
+		if (wal_sync_method != WAL_SYNC_METHOD_OPEN &&
+			wal_sync_method != WAL_SYNC_METHOD_OPEN_DSYNC)
+			pg_flush_data(recvFile, (off_t) startoff, (off_t) byteswritten);
+#endif
+
 		/* Update state for write */
 		recptr += byteswritten;
 
@@ -49,6 +49,14 @@
 #include <signal.h>
 #include <unistd.h>
 
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "access/timeline.h"
 #include "access/transam.h"
 #include "access/xact.h"
@@ -62,6 +70,7 @@
 #include "catalog/pg_type.h"
 #include "commands/dbcommands.h"
 #include "commands/defrem.h"
+#include "common/compression.h"
 #include "funcapi.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
@@ -169,6 +178,26 @@ static StringInfoData output_message;
 static StringInfoData reply_message;
 static StringInfoData tmpbuf;
 
+/*
+ * Logical decoding output is only pushed to the socket once this much has
+ * been queued, rather than with a send() per change; see WalSndWriteData().
+ */
+#define WALSND_LOGICAL_FLUSH_BYTES	(64 * 1024)
+
+static Size logical_unflushed_bytes = 0;
+
+/*
+ * Compression requested by the client for physical WAL data, and the
+ * scratch space used to apply it.
+ */
+static pg_compress_algorithm wal_send_compression = PG_COMPRESSION_NONE;
+static char *wal_send_compress_buf = NULL;
+static int	wal_send_compress_buf_size = 0;
+
+#ifdef USE_ZSTD
+static ZSTD_CCtx *wal_send_zstd_cctx = NULL;
+#endif
+
 /* Timestamp of last ProcessRepliesIfAny(). */
 static TimestampTz last_processing = 0;
 
@@ -239,6 +268,8 @@ static void InitWalSenderSlot(void);
 static void WalSndKill(int code, Datum arg);
 static void WalSndShutdown(void) pg_attribute_noreturn();
 static void XLogSendPhysical(void);
+static void ParseStartReplicationOptions(StartReplicationCmd *cmd);
+static void WalSndCompressWALMessage(void);
 static void XLogSendLogical(void);
 static void WalSndDone(WalSndSendDataCallback send_data);
 static void IdentifySystem(void);
@@ -835,6 +866,8 @@ StartReplication(StartReplicationCmd *cmd)
 				 errmsg("out of memory"),
 				 errdetail("Failed while allocating a WAL reading processor.")));
 
+	ParseStartReplicationOptions(cmd);
+
 	/*
 	 * We assume here that we're logging enough information in the WAL for
 	 * log-shipping, since this is checked in PostmasterMain().
@@ -1093,14 +1126,15 @@ logical_read_xlog_page(XLogReaderState *state, XLogRecPtr targetPagePtr, int req
 		count = flushptr - targetPagePtr;	/* part of the page available */
 
 	/* now actually read the data, we know it's there */
-	if (!WALRead(state,
-				 cur_page,
-				 targetPagePtr,
-				 count,
-				 currTLI,		/* Pass the current TLI because only
-								 * WalSndSegmentOpen controls whether new TLI
-								 * is needed. */
-				 &errinfo))
+	if (!WALReadBuffered(state,
+						 cur_page,
+						 targetPagePtr,
+						 count,
+						 flushptr,
+						 currTLI,	/* Pass the current TLI because only
+									 * WalSndSegmentOpen controls whether
+									 * new TLI is needed. */
+						 &errinfo))
 		WALReadRaiseError(&errinfo);
 
 	/*
@@ -1407,6 +1441,81 @@ DropReplicationSlot(DropReplicationSlotCmd *cmd)
 	ReplicationSlotDrop(cmd->slotname, !cmd->wait);
 }
 
+/*
+ * Process extra options given to physical START_REPLICATION.
+ */
+static void
+ParseStartReplicationOptions(StartReplicationCmd *cmd)
+{
+	bool		compression_given = false;
+	pg_compress_algorithm algorithm = PG_COMPRESSION_NONE;
+	int			bound = 0;
+
+	foreach_ptr(DefElem, defel, cmd->options)
+	{
+		if (strcmp(defel->defname, "compression") == 0)
+		{
+			char	   *value = defGetString(defel);
+
+			if (compression_given)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			compression_given = true;
+			if (!parse_compress_algorithm(value, &algorithm))
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("unrecognized compression algorithm: \"%s\"",
+								value)));
+		}
+		else
+			elog(ERROR, "unrecognized option: %s", defel->defname);
+	}
+
+	switch (algorithm)
+	{
+		case PG_COMPRESSION_NONE:
+			break;
+		case PG_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			bound = LZ4_compressBound(MAX_SEND_SIZE);
+#endif
+			break;
+		case PG_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			bound = ZSTD_compressBound(MAX_SEND_SIZE);
+			if (wal_send_zstd_cctx == NULL)
+			{
+				wal_send_zstd_cctx = ZSTD_createCCtx();
+				if (wal_send_zstd_cctx == NULL)
+					ereport(ERROR,
+							(errcode(ERRCODE_OUT_OF_MEMORY),
+							 errmsg("out of memory")));
+			}
+#endif
+			break;
+		case PG_COMPRESSION_GZIP:
+			/* not offered for streaming; treated as unsupported below */
+			break;
+	}
+
+	if (algorithm != PG_COMPRESSION_NONE && bound == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("compression algorithm \"%s\" is not supported for WAL streaming",
+						get_compress_algorithm_name(algorithm))));
+
+	if (bound > wal_send_compress_buf_size)
+	{
+		if (wal_send_compress_buf)
+			pfree(wal_send_compress_buf);
+		wal_send_compress_buf = MemoryContextAlloc(TopMemoryContext, bound);
+		wal_send_compress_buf_size = bound;
+	}
+
+	wal_send_compression = algorithm;
+}
+
 /*
  * Process extra options given to ALTER_REPLICATION_SLOT.
  */
@@ -1590,6 +1699,22 @@ WalSndWriteData(LogicalDecodingContext *ctx, XLogRecPtr lsn, TransactionId xid,
 
 	CHECK_FOR_INTERRUPTS();
 
+	/*
+	 * Let small messages accumulate in the output buffer, so that a stream of
+	 * narrow changes goes out in a few large writes instead of one system
+	 * call per change.  Whatever is left is flushed by WalSndLoop once the
+	 * current WAL record has been decoded, or before we wait for more WAL.
+	 * Don't hold back output when we're getting close to the timeout,
+	 * though, because then we must also look for replies.
+	 */
+	logical_unflushed_bytes += ctx->out->len;
+	if (logical_unflushed_bytes < WALSND_LOGICAL_FLUSH_BYTES &&
+		(wal_sender_timeout <= 0 ||
+		 now < TimestampTzPlusMilliseconds(last_reply_timestamp,
+										   wal_sender_timeout / 2)))
+		return;
+	logical_unflushed_bytes = 0;
+
 	/* Try to flush pending output to the client */
 	if (pq_flush_if_writable() != 0)
 		WalSndShutdown();
@@ -3337,6 +3462,9 @@ retry:
 	output_message.len += nbytes;
 	output_message.data[output_message.len] = '\0';
 
+	if (wal_send_compression != PG_COMPRESSION_NONE)
+		WalSndCompressWALMessage();
+
 	/*
 	 * Fill the send timestamp last, so that it is taken as late as possible.
 	 */
@@ -3369,6 +3497,66 @@ retry:
 	}
 }
 
+/*
+ * Replace the XLogData message in output_message with a CompressedXLogData
+ * message carrying the same WAL, if compressing actually makes it smaller.
+ *
+ * Both messages start with the same three Int64 fields, so the send
+ * timestamp can still be filled in at the same offset afterwards.
+ */
+static void
+WalSndCompressWALMessage(void)
+{
+	int			hdrlen = 1 + sizeof(int64) * 3;
+	int			srclen = output_message.len - hdrlen;
+	int			clen = -1;
+
+	Assert(output_message.data[0] == 'w');
+	Assert(srclen <= MAX_SEND_SIZE);
+
+	if (srclen <= 0)
+		return;
+
+	switch (wal_send_compression)
+	{
+		case PG_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			clen = LZ4_compress_default(&output_message.data[hdrlen],
+										wal_send_compress_buf,
+										srclen, wal_send_compress_buf_size);
+			if (clen <= 0)
+				clen = -1;
+#endif
+			break;
+		case PG_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			{
+				size_t		len;
+
+				len = ZSTD_compressCCtx(wal_send_zstd_cctx,
+										wal_send_compress_buf,
+										wal_send_compress_buf_size,
+										&output_message.data[hdrlen], srclen,
+										ZSTD_CLEVEL_DEFAULT);
+				if (!ZSTD_isError(len))
+					clen = (int) len;
+			}
+#endif
+			break;
+		default:
+			break;
+	}
+
+	/* Send it uncompressed if it didn't shrink, e.g. for FPIs. */
+	if (clen < 0 || clen + (int) sizeof(int32) >= srclen)
+		return;
+
+	output_message.data[0] = 'z';
+	output_message.len = hdrlen;
+	pq_sendint32(&output_message, srclen);
+	appendBinaryStringInfo(&output_message, wal_send_compress_buf, clen);
+}
+
 /*
  * Stream out logically decoded data.
  */
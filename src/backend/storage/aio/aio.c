@@ -0,0 +1,167 @@
+/*-------------------------------------------------------------------------
+ *
+ * aio.c
+ *	  Core of the I/O method infrastructure
+ *
+ * Code that wants to perform file I/O without necessarily waiting for it
+ * describes each I/O in a PgAioHandle with pgaio_io_prep_readv() or
+ * pgaio_io_prep_writev(), hands one or more handles to pgaio_submit(), and
+ * later calls pgaio_io_wait() to collect the result of each.  Between
+ * submission and waiting, the caller can do other work, including preparing
+ * and submitting further I/Os.
+ *
+ * The I/O method selected by io_method decides what submission means.  The
+ * only built-in method so far is "sync", which performs the I/O during
+ * pgaio_submit().  Asynchronous methods plug in through IoMethodOps, and
+ * keeping all callers on this interface means they can be added without
+ * touching code that issues I/O.
+ *
+ * Handles are owned by the caller and carry no shared state, so there is
+ * nothing to clean up at error time beyond what the caller itself holds.
+ *
+ * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/aio/aio.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "storage/aio_internal.h"
+
+/* GUCs */
+int			io_method = DEFAULT_IO_METHOD;
+
+static const IoMethodOps *const pgaio_method_ops_table[] = {
+	[IOMETHOD_SYNC] = &pgaio_sync_ops,
+};
+
+#define pgaio_method_ops (pgaio_method_ops_table[io_method])
+
+static inline void
+pgaio_io_prep(PgAioHandle *ioh, PgAioOp op, File file,
+			  const struct iovec *iov, int iovcnt,
+			  off_t offset, uint32 wait_event_info)
+{
+	Assert(iovcnt > 0 && iovcnt <= PG_IOV_MAX);
+
+	ioh->state = PGAIO_HS_DEFINED;
+	ioh->op = op;
+	ioh->file = file;
+	ioh->offset = offset;
+	ioh->iov = iov;
+	ioh->iovcnt = iovcnt;
+	ioh->wait_event_info = wait_event_info;
+	ioh->result = 0;
+	ioh->result_errno = 0;
+}
+
+/*
+ * Describe a vectored read of the given file into iov, starting at offset.
+ */
+void
+pgaio_io_prep_readv(PgAioHandle *ioh, File file,
+					const struct iovec *iov, int iovcnt,
+					off_t offset, uint32 wait_event_info)
+{
+	pgaio_io_prep(ioh, PGAIO_OP_READV, file, iov, iovcnt, offset,
+				  wait_event_info);
+}
+
+/*
+ * Describe a vectored write of iov to the given file, starting at offset.
+ */
+void
+pgaio_io_prep_writev(PgAioHandle *ioh, File file,
+					 const struct iovec *iov, int iovcnt,
+					 off_t offset, uint32 wait_event_info)
+{
+	pgaio_io_prep(ioh, PGAIO_OP_WRITEV, file, iov, iovcnt, offset,
+				  wait_event_info);
+}
+
+/*
+ * Submit a batch of prepared handles.  Submitting several at once gives the
+ * I/O method a chance to issue them with a single system call.
+ */
+void
+pgaio_submit(PgAioHandle **iohs, int nios)
+{
+	if (nios == 0)
+		return;
+
+	for (int i = 0; i < nios; i++)
+	{
+		Assert(iohs[i]->state == PGAIO_HS_DEFINED);
+		iohs[i]->state = PGAIO_HS_SUBMITTED;
+	}
+
+	pgaio_method_ops->submit(iohs, nios);
+}
+
+/*
+ * Convenience wrapper around pgaio_submit() for a single handle.
+ */
+void
+pgaio_io_submit(PgAioHandle *ioh)
+{
+	pgaio_submit(&ioh, 1);
+}
+
+/*
+ * Wait for a submitted handle to complete, and return its result with the
+ * same conventions as FileReadV()/FileWriteV(): the number of bytes
+ * transferred, or -1 with errno set.  The handle can be prepared again
+ * afterwards.
+ */
+ssize_t
+pgaio_io_wait(PgAioHandle *ioh)
+{
+	Assert(ioh->state == PGAIO_HS_SUBMITTED ||
+		   ioh->state == PGAIO_HS_COMPLETED);
+
+	if (ioh->state != PGAIO_HS_COMPLETED)
+		pgaio_method_ops->wait_one(ioh);
+
+	Assert(ioh->state == PGAIO_HS_COMPLETED);
+	ioh->state = PGAIO_HS_IDLE;
+
+	if (ioh->result < 0)
+		errno = ioh->result_errno;
+	return ioh->result;
+}
+
+/*
+ * Execute the I/O described by a handle in the calling process, and mark it
+ * completed.  For use by I/O methods, either as their main implementation or
+ * as a fallback for I/Os they cannot issue asynchronously.
+ */
+void
+pgaio_io_perform_synchronously(PgAioHandle *ioh)
+{
+	ssize_t		result;
+
+	Assert(ioh->state == PGAIO_HS_SUBMITTED);
+
+	switch (ioh->op)
+	{
+		case PGAIO_OP_READV:
+			result = FileReadV(ioh->file, ioh->iov, ioh->iovcnt,
+							   ioh->offset, ioh->wait_event_info);
+			break;
+		case PGAIO_OP_WRITEV:
+			result = FileWriteV(ioh->file, ioh->iov, ioh->iovcnt,
+								ioh->offset, ioh->wait_event_info);
+			break;
+		default:
+			elog(ERROR, "unrecognized AIO operation: %d", (int) ioh->op);
+			result = -1;		/* keep compiler quiet */
+			break;
+	}
+
+	ioh->result = result;
+	ioh->result_errno = result < 0 ? errno : 0;
+	ioh->state = PGAIO_HS_COMPLETED;
+}
@@ -0,0 +1,42 @@
+/*-------------------------------------------------------------------------
+ *
+ * method_sync.c
+ *	  "AIO" implementation that just executes I/O synchronously
+ *
+ * This is the fallback used when no asynchronous I/O method is configured.
+ * Submitting a batch of handles performs each of the I/Os in turn, so by the
+ * time pgaio_submit() returns, every handle has completed.
+ *
+ * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/aio/method_sync.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "storage/aio_internal.h"
+
+static void pgaio_sync_submit(PgAioHandle **iohs, int nios);
+static void pgaio_sync_wait_one(PgAioHandle *ioh);
+
+const IoMethodOps pgaio_sync_ops = {
+	.submit = pgaio_sync_submit,
+	.wait_one = pgaio_sync_wait_one,
+};
+
+static void
+pgaio_sync_submit(PgAioHandle **iohs, int nios)
+{
+	for (int i = 0; i < nios; i++)
+		pgaio_io_perform_synchronously(iohs[i]);
+}
+
+static void
+pgaio_sync_wait_one(PgAioHandle *ioh)
+{
+	/* All I/O is completed during submission. */
+	elog(ERROR, "unexpected wait for incomplete I/O with io_method=sync");
+}
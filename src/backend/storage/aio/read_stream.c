@@ -90,6 +90,7 @@
 
 #include "catalog/pg_tablespace.h"
 #include "miscadmin.h"
+#include "pg_trace.h"
 #include "storage/fd.h"
 #include "storage/smgr.h"
 #include "storage/read_stream.h"
@@ -284,6 +285,13 @@ read_stream_start_pending_read(ReadStream *stream, bool suppress_advice)
 	}
 	else
 	{
+		TRACE_POSTGRESQL_READ_STREAM_IO_START(stream->ios[io_index].op.forknum,
+											  stream->ios[io_index].op.blocknum,
+											  stream->ios[io_index].op.smgr->smgr_rlocator.locator.spcOid,
+											  stream->ios[io_index].op.smgr->smgr_rlocator.locator.dbOid,
+											  stream->ios[io_index].op.smgr->smgr_rlocator.locator.relNumber,
+											  stream->ios[io_index].op.nblocks);
+
 		/*
 		 * Remember to call WaitReadBuffers() before returning head buffer.
 		 * Look-ahead distance will be adjusted after waiting.
@@ -623,6 +631,13 @@ read_stream_next_buffer(ReadStream *stream, void **per_buffer_data)
 				return buffer;
 			}
 
+			TRACE_POSTGRESQL_READ_STREAM_IO_START(stream->ios[0].op.forknum,
+												  next_blocknum,
+												  stream->ios[0].op.smgr->smgr_rlocator.locator.spcOid,
+												  stream->ios[0].op.smgr->smgr_rlocator.locator.dbOid,
+												  stream->ios[0].op.smgr->smgr_rlocator.locator.relNumber,
+												  1);
+
 			/* Next call must wait for I/O for the newly pinned buffer. */
 			stream->oldest_io_index = 0;
 			stream->next_io_index = stream->max_ios > 1 ? 1 : 0;
@@ -683,13 +698,25 @@ read_stream_next_buffer(ReadStream *stream, void **per_buffer_data)
 		stream->ios[stream->oldest_io_index].buffer_index == oldest_buffer_index)
 	{
 		int16		io_index = stream->oldest_io_index;
+		ReadBuffersOperation *op = &stream->ios[io_index].op;
 		int16		distance;
 
 		/* Sanity check that we still agree on the buffers. */
-		Assert(stream->ios[io_index].op.buffers ==
-			   &stream->buffers[oldest_buffer_index]);
-
-		WaitReadBuffers(&stream->ios[io_index].op);
+		Assert(op->buffers == &stream->buffers[oldest_buffer_index]);
+
+		TRACE_POSTGRESQL_READ_STREAM_WAIT_START(op->forknum,
+												op->blocknum,
+												op->smgr->smgr_rlocator.locator.spcOid,
+												op->smgr->smgr_rlocator.locator.dbOid,
+												op->smgr->smgr_rlocator.locator.relNumber,
+												op->nblocks);
+		WaitReadBuffers(op);
+		TRACE_POSTGRESQL_READ_STREAM_WAIT_DONE(op->forknum,
+											   op->blocknum,
+											   op->smgr->smgr_rlocator.locator.spcOid,
+											   op->smgr->smgr_rlocator.locator.dbOid,
+											   op->smgr->smgr_rlocator.locator.relNumber,
+											   op->nblocks);
 
 		Assert(stream->ios_in_progress > 0);
 		stream->ios_in_progress--;
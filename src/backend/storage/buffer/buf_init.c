@@ -21,6 +21,7 @@
 BufferDescPadded *BufferDescriptors;
 char	   *BufferBlocks;
 ConditionVariableMinimallyPadded *BufferIOCVArray;
+RelFileNumber *BufferRelNumbers;
 WritebackContext BackendWritebackContext;
 CkptSortItem *CkptBufferIds;
 
@@ -70,6 +71,7 @@ InitBufferPool(void)
 	bool		foundBufs,
 				foundDescs,
 				foundIOCV,
+				foundRelNumbers,
 				foundBufCkpt;
 
 	/* Align descriptors to a cacheline boundary. */
@@ -91,6 +93,11 @@ InitBufferPool(void)
 						NBuffers * sizeof(ConditionVariableMinimallyPadded),
 						&foundIOCV);
 
+	BufferRelNumbers = (RelFileNumber *)
+		ShmemInitStruct("Buffer Relation Numbers",
+						NBuffers * sizeof(RelFileNumber),
+						&foundRelNumbers);
+
 	/*
 	 * The array used to sort to-be-checkpointed buffer ids is located in
 	 * shared memory, to avoid having to allocate significant amounts of
@@ -102,10 +109,11 @@ InitBufferPool(void)
 		ShmemInitStruct("Checkpoint BufferIds",
 						NBuffers * sizeof(CkptSortItem), &foundBufCkpt);
 
-	if (foundDescs || foundBufs || foundIOCV || foundBufCkpt)
+	if (foundDescs || foundBufs || foundIOCV || foundRelNumbers || foundBufCkpt)
 	{
 		/* should find all of these, or none of them */
-		Assert(foundDescs && foundBufs && foundIOCV && foundBufCkpt);
+		Assert(foundDescs && foundBufs && foundIOCV && foundRelNumbers &&
+			   foundBufCkpt);
 		/* note: this path is only taken in EXEC_BACKEND case */
 	}
 	else
@@ -120,6 +128,7 @@ InitBufferPool(void)
 			BufferDesc *buf = GetBufferDescriptor(i);
 
 			ClearBufferTag(&buf->tag);
+			BufferRelNumbers[i] = InvalidRelFileNumber;
 
 			pg_atomic_init_u32(&buf->state, 0);
 			buf->wait_backend_pgprocno = INVALID_PROC_NUMBER;
@@ -179,6 +188,9 @@ BufferShmemSize(void)
 	/* to allow aligning the above */
 	size = add_size(size, PG_CACHE_LINE_SIZE);
 
+	/* size of relation number array */
+	size = add_size(size, mul_size(NBuffers, sizeof(RelFileNumber)));
+
 	/* size of checkpoint sort array in bufmgr.c */
 	size = add_size(size, mul_size(NBuffers, sizeof(CkptSortItem)));
 
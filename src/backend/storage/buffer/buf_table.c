@@ -104,6 +104,36 @@ BufTableLookup(BufferTag *tagPtr, uint32 hashcode)
 	return result->id;
 }
 
+/*
+ * BufTableLookupOptimistic
+ *		Lookup the given BufferTag without the BufMappingLock; return a buffer
+ *		ID that probably holds it, or -1 if none was found
+ *
+ * No lock is required, but the result is only a hint, because the mapping
+ * can change concurrently: the caller has to check the returned buffer's tag
+ * under its header lock, and fall back to BufTableLookup() if a result of -1
+ * or a mismatch leaves it empty-handed.
+ */
+int
+BufTableLookupOptimistic(BufferTag *tagPtr, uint32 hashcode)
+{
+	BufferLookupEnt *result;
+	int			id;
+
+	result = (BufferLookupEnt *)
+		hash_search_optimistic(SharedBufHash, tagPtr, hashcode);
+
+	if (!result)
+		return -1;
+
+	/* the entry might be in the middle of being set up */
+	id = ((volatile BufferLookupEnt *) result)->id;
+	if (id < 0 || id >= NBuffers)
+		return -1;
+
+	return id;
+}
+
 /*
  * BufTableInsert
  *		Insert a hashtable entry for given tag and buffer ID,
@@ -56,7 +56,9 @@
 #include "storage/proc.h"
 #include "storage/smgr.h"
 #include "storage/standby.h"
+#include "utils/builtins.h"
 #include "utils/memdebug.h"
+#include "utils/memutils.h"
 #include "utils/ps_status.h"
 #include "utils/rel.h"
 #include "utils/resowner.h"
@@ -120,6 +122,13 @@ typedef struct CkptTsStatus
 
 	/* current offset in CkptBufferIds for this tablespace */
 	int			index;
+
+	/*
+	 * Relation fork we last wrote buffers of in this tablespace.  Once we
+	 * move on to another fork, its pending fsyncs are done early.
+	 */
+	bool		sync_pending;
+	BufferTag	sync_tag;
 } CkptTsStatus;
 
 /*
@@ -504,12 +513,17 @@ static BlockNumber ExtendBufferedRelShared(BufferManagerRelation bmr,
 										   uint32 *extended_by);
 static bool PinBuffer(BufferDesc *buf, BufferAccessStrategy strategy);
 static void PinBuffer_Locked(BufferDesc *buf);
+static bool PinBufferIfTagMatches(BufferDesc *buf, const BufferTag *tag,
+								  BufferAccessStrategy strategy);
 static void UnpinBuffer(BufferDesc *buf);
 static void UnpinBufferNoOwner(BufferDesc *buf);
 static void BufferSync(int flags);
 static uint32 WaitBufHdrUnlocked(BufferDesc *buf);
 static int	SyncOneBuffer(int buf_id, bool skip_recently_used,
 						  WritebackContext *wb_context);
+static int	SyncCheckpointBufferRun(CkptTsStatus *ts_stat, int *nwritten,
+									WritebackContext *wb_context);
+static void CheckpointSyncFork(CkptTsStatus *ts_stat);
 static void WaitIO(BufferDesc *buf);
 static bool StartBufferIO(BufferDesc *buf, bool forInput, bool nowait);
 static void TerminateBufferIO(BufferDesc *buf, bool clear_dirty,
@@ -1569,6 +1583,28 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	newHash = BufTableHashCode(&newTag);
 	newPartitionLock = BufMappingPartitionLock(newHash);
 
+	/*
+	 * Most lookups find a valid buffer.  Try to find and pin it without
+	 * taking the mapping lock first, which would otherwise be a point of
+	 * contention between all backends accessing blocks in the same partition.
+	 * The lookup can give a wrong answer if the mapping changes concurrently,
+	 * but once we have verified the tag of the buffer with its header locked,
+	 * and pinned it, it can't be replaced anymore.  Anything else, including
+	 * buffers that don't have valid contents yet, goes through the regular
+	 * locked path below.
+	 */
+	existing_buf_id = BufTableLookupOptimistic(&newTag, newHash);
+	if (existing_buf_id >= 0)
+	{
+		BufferDesc *buf = GetBufferDescriptor(existing_buf_id);
+
+		if (PinBufferIfTagMatches(buf, &newTag, strategy))
+		{
+			*foundPtr = true;
+			return buf;
+		}
+	}
+
 	/* see if the block is in the buffer pool already */
 	LWLockAcquire(newPartitionLock, LW_SHARED);
 	existing_buf_id = BufTableLookup(&newTag, newHash);
@@ -1682,6 +1718,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	Assert(!(victim_buf_state & (BM_TAG_VALID | BM_VALID | BM_DIRTY | BM_IO_IN_PROGRESS)));
 
 	victim_buf_hdr->tag = newTag;
+	BufferRelNumbers[victim_buf_hdr->buf_id] = BufTagGetRelNumber(&newTag);
 
 	/*
 	 * Make sure BM_PERMANENT is set for buffers that must be written at every
@@ -1689,7 +1726,8 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	 * checkpoints, except for their "init" forks, which need to be treated
 	 * just like permanent relations.
 	 */
-	victim_buf_state |= BM_TAG_VALID | BUF_USAGECOUNT_ONE;
+	victim_buf_state |= BM_TAG_VALID |
+		StrategyInitialUsageCount(newHash) * BUF_USAGECOUNT_ONE;
 	if (relpersistence == RELPERSISTENCE_PERMANENT || forkNum == INIT_FORKNUM)
 		victim_buf_state |= BM_PERMANENT;
 
@@ -1791,6 +1829,7 @@ retry:
 	 */
 	oldFlags = buf_state & BUF_FLAG_MASK;
 	ClearBufferTag(&buf->tag);
+	BufferRelNumbers[buf->buf_id] = InvalidRelFileNumber;
 	buf_state &= ~(BUF_FLAG_MASK | BUF_USAGECOUNT_MASK);
 	UnlockBufHdr(buf, buf_state);
 
@@ -1871,6 +1910,7 @@ InvalidateVictimBuffer(BufferDesc *buf_hdr)
 	 * tag (see e.g. FlushDatabaseBuffers()).
 	 */
 	ClearBufferTag(&buf_hdr->tag);
+	BufferRelNumbers[buf_hdr->buf_id] = InvalidRelFileNumber;
 	buf_state &= ~(BUF_FLAG_MASK | BUF_USAGECOUNT_MASK);
 	UnlockBufHdr(buf_hdr, buf_state);
 
@@ -1881,6 +1921,9 @@ InvalidateVictimBuffer(BufferDesc *buf_hdr)
 
 	LWLockRelease(partition_lock);
 
+	/* let the replacement policy know that the page was evicted */
+	StrategyRememberEvicted(hash);
+
 	Assert(!(buf_state & (BM_DIRTY | BM_VALID | BM_TAG_VALID)));
 	Assert(BUF_STATE_GET_REFCOUNT(buf_state) > 0);
 	Assert(BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf_hdr->state)) > 0);
@@ -1978,12 +2021,18 @@ again:
 			lsn = BufferGetLSN(buf_hdr);
 			UnlockBufHdr(buf_hdr, buf_state);
 
-			if (XLogNeedsFlush(lsn)
-				&& StrategyRejectBuffer(strategy, buf_hdr, from_ring))
+			if (XLogNeedsFlush(lsn))
 			{
-				LWLockRelease(content_lock);
-				UnpinBuffer(buf_hdr);
-				goto again;
+				if (StrategyRejectBuffer(strategy, buf_hdr, from_ring))
+				{
+					LWLockRelease(content_lock);
+					UnpinBuffer(buf_hdr);
+					goto again;
+				}
+
+				/* FlushBuffer() will have to flush WAL first */
+				pgstat_count_io_op(IOOBJECT_RELATION, io_context,
+								   IOOP_WAL_FLUSH);
 			}
 		}
 
@@ -2016,6 +2065,12 @@ again:
 		 */
 		pgstat_count_io_op(IOOBJECT_RELATION, io_context,
 						   from_ring ? IOOP_REUSE : IOOP_EVICT);
+		TRACE_POSTGRESQL_BUFFER_EVICT(BufTagGetForkNum(&buf_hdr->tag),
+									  buf_hdr->tag.blockNum,
+									  buf_hdr->tag.spcOid,
+									  buf_hdr->tag.dbOid,
+									  BufTagGetRelNumber(&buf_hdr->tag),
+									  from_ring);
 	}
 
 	/*
@@ -2332,6 +2387,7 @@ ExtendBufferedRelShared(BufferManagerRelation bmr,
 			Assert(BUF_STATE_GET_REFCOUNT(buf_state) == 1);
 
 			victim_buf_hdr->tag = tag;
+			BufferRelNumbers[victim_buf_hdr->buf_id] = BufTagGetRelNumber(&tag);
 
 			buf_state |= BM_TAG_VALID | BUF_USAGECOUNT_ONE;
 			if (bmr.relpersistence == RELPERSISTENCE_PERMANENT || fork == INIT_FORKNUM)
@@ -2739,6 +2795,75 @@ PinBuffer_Locked(BufferDesc *buf)
 	ResourceOwnerRememberBuffer(CurrentResourceOwner, b);
 }
 
+/*
+ * PinBufferIfTagMatches -- pin a buffer if it holds a valid page with the
+ * given tag
+ *
+ * This is for callers that found the buffer without holding the buffer
+ * mapping lock, and therefore can't be sure it still holds the page they
+ * want.  Returns true if the page is valid and was pinned, adjusting its
+ * usage count like PinBuffer() does, false if the caller has to look for the
+ * page the hard way.
+ *
+ * As with PinBuffer_Locked(), the caller has to previously call
+ * ReservePrivateRefCountEntry() and ResourceOwnerEnlarge(CurrentResourceOwner).
+ */
+static bool
+PinBufferIfTagMatches(BufferDesc *buf, const BufferTag *tag,
+					  BufferAccessStrategy strategy)
+{
+	Buffer		b = BufferDescriptorGetBuffer(buf);
+	PrivateRefCountEntry *ref;
+	uint32		buf_state;
+
+	/*
+	 * If we already have the buffer pinned, its tag can't change, so it is
+	 * safe to check it without locking.  Otherwise we have to check under
+	 * the header lock, and can't pin first and ask questions later, as that
+	 * might confuse code paths like InvalidateBuffer() if we pinned a random
+	 * non-matching buffer.
+	 */
+	if (GetPrivateRefCountEntry(b, false) != NULL)
+	{
+		if (!BufferTagsEqual(&buf->tag, tag) ||
+			!(pg_atomic_read_u32(&buf->state) & BM_VALID))
+			return false;
+
+		return PinBuffer(buf, strategy);
+	}
+
+	buf_state = LockBufHdr(buf);
+	if (!(buf_state & BM_VALID) || !BufferTagsEqual(&buf->tag, tag))
+	{
+		UnlockBufHdr(buf, buf_state);
+		return false;
+	}
+
+	/* increase refcount and usagecount, see PinBuffer() */
+	buf_state += BUF_REFCOUNT_ONE;
+	if (strategy == NULL)
+	{
+		if (BUF_STATE_GET_USAGECOUNT(buf_state) < BM_MAX_USAGE_COUNT)
+			buf_state += BUF_USAGECOUNT_ONE;
+	}
+	else
+	{
+		if (BUF_STATE_GET_USAGECOUNT(buf_state) == 0)
+			buf_state += BUF_USAGECOUNT_ONE;
+	}
+	UnlockBufHdr(buf, buf_state);
+
+	VALGRIND_MAKE_MEM_DEFINED(BufHdrGetBlock(buf), BLCKSZ);
+
+	/* we know there was no preexisting pin, as in PinBuffer_Locked() */
+	ref = NewPrivateRefCountEntry(b);
+	ref->refcount++;
+
+	ResourceOwnerRememberBuffer(CurrentResourceOwner, b);
+
+	return true;
+}
+
 /*
  * UnpinBuffer -- make buffer available for replacement.
  *
@@ -3040,10 +3165,25 @@ BufferSync(int flags)
 		BufferDesc *bufHdr = NULL;
 		CkptTsStatus *ts_stat = (CkptTsStatus *)
 			DatumGetPointer(binaryheap_first(ts_heap));
+		int			nprocessed;
 
 		buf_id = CkptBufferIds[ts_stat->index].buf_id;
 		Assert(buf_id != -1);
 
+		/*
+		 * If we just finished the last fork written in this tablespace, fsync
+		 * it now rather than leaving the fsync for the end of the checkpoint.
+		 * The sort order means no more buffers of it are coming, except in
+		 * the unlikely case that the next entry is for the same relation
+		 * number in another database.  We'd then merely skip the early fsync.
+		 */
+		if (ts_stat->sync_pending &&
+			(CkptBufferIds[ts_stat->index].relNumber !=
+			 BufTagGetRelNumber(&ts_stat->sync_tag) ||
+			 CkptBufferIds[ts_stat->index].forkNum !=
+			 BufTagGetForkNum(&ts_stat->sync_tag)))
+			CheckpointSyncFork(ts_stat);
+
 		bufHdr = GetBufferDescriptor(buf_id);
 
 		num_processed++;
@@ -3062,25 +3202,36 @@ BufferSync(int flags)
 		 */
 		if (pg_atomic_read_u32(&bufHdr->state) & BM_CHECKPOINT_NEEDED)
 		{
-			if (SyncOneBuffer(buf_id, false, &wb_context) & BUF_WRITTEN)
-			{
-				TRACE_POSTGRESQL_BUFFER_SYNC_WRITTEN(buf_id);
-				PendingCheckpointerStats.buffers_written++;
-				num_written++;
-			}
+			int			nwritten;
+
+			/*
+			 * Write this buffer, together with any immediately following
+			 * blocks of the same relation fork that are ready to go, in a
+			 * single vectored write.  The run covers at least this buffer.
+			 */
+			nprocessed = SyncCheckpointBufferRun(ts_stat, &nwritten,
+												 &wb_context);
+			PendingCheckpointerStats.buffers_written += nwritten;
+			num_written += nwritten;
 		}
+		else
+			nprocessed = 1;
+
+		num_processed += nprocessed - 1;
 
 		/*
 		 * Measure progress independent of actually having to flush the buffer
 		 * - otherwise writing become unbalanced.
 		 */
-		ts_stat->progress += ts_stat->progress_slice;
-		ts_stat->num_scanned++;
-		ts_stat->index++;
+		ts_stat->progress += ts_stat->progress_slice * nprocessed;
+		ts_stat->num_scanned += nprocessed;
+		ts_stat->index += nprocessed;
 
 		/* Have all the buffers from the tablespace been processed? */
 		if (ts_stat->num_scanned == ts_stat->num_to_scan)
 		{
+			if (ts_stat->sync_pending)
+				CheckpointSyncFork(ts_stat);
 			binaryheap_remove_first(ts_heap);
 		}
 		else
@@ -3491,6 +3642,245 @@ SyncOneBuffer(int buf_id, bool skip_recently_used, WritebackContext *wb_context)
 	return result | BUF_WRITTEN;
 }
 
+/*
+ * PrepareCheckpointBufferWrite -- pin, share-lock and start I/O on a buffer
+ *		that is about to be written as part of a checkpoint write run.
+ *
+ * If expected_tag is not NULL, the buffer must still hold that block, and we
+ * refuse to wait for the content lock or for I/O already in progress: the
+ * caller already holds the same locks on the preceding blocks of the run, so
+ * waiting here could deadlock, and the buffer will be visited again later
+ * anyway.
+ *
+ * Returns false, leaving the buffer unpinned, if it doesn't need writing or
+ * can't be added to the run.  On success the buffer's LSN is returned in
+ * *lsn, or InvalidXLogRecPtr if it is not permanent.
+ */
+static bool
+PrepareCheckpointBufferWrite(BufferDesc *bufHdr, const BufferTag *expected_tag,
+							 XLogRecPtr *lsn)
+{
+	LWLock	   *content_lock = BufferDescriptorGetContentLock(bufHdr);
+	bool		nowait = (expected_tag != NULL);
+	uint32		buf_state;
+
+	/* Make sure we can handle the pin */
+	ReservePrivateRefCountEntry();
+	ResourceOwnerEnlarge(CurrentResourceOwner);
+
+	/* See SyncOneBuffer() for why the header lock is enough to test this */
+	buf_state = LockBufHdr(bufHdr);
+	if (!(buf_state & BM_VALID) || !(buf_state & BM_DIRTY) ||
+		(expected_tag && !BufferTagsEqual(&bufHdr->tag, expected_tag)))
+	{
+		UnlockBufHdr(bufHdr, buf_state);
+		return false;
+	}
+	PinBuffer_Locked(bufHdr);
+
+	if (!nowait)
+		LWLockAcquire(content_lock, LW_SHARED);
+	else if (!LWLockConditionalAcquire(content_lock, LW_SHARED))
+	{
+		UnpinBuffer(bufHdr);
+		return false;
+	}
+
+	/* Someone else may have flushed it in the meantime */
+	if (!StartBufferIO(bufHdr, false, nowait))
+	{
+		LWLockRelease(content_lock);
+		UnpinBuffer(bufHdr);
+		return false;
+	}
+
+	/* As in FlushBuffer(), read the LSN while holding the header lock */
+	buf_state = LockBufHdr(bufHdr);
+	*lsn = (buf_state & BM_PERMANENT) ? BufferGetLSN(bufHdr) : InvalidXLogRecPtr;
+	buf_state &= ~BM_JUST_DIRTIED;
+	UnlockBufHdr(bufHdr, buf_state);
+
+	return true;
+}
+
+/*
+ * SyncCheckpointBufferRun -- write out a run of checkpoint buffers
+ *
+ * Starting at ts_stat's current position in CkptBufferIds, collect up to
+ * io_combine_limit buffers holding consecutive blocks of one relation fork,
+ * and write them with a single smgrwritev() call.  Since CkptBufferIds is
+ * sorted by relation, fork and block, such runs appear as adjacent entries
+ * whenever a relation has contiguous dirty ranges, which is typical of bulk
+ * loads and of tables with hot tail pages.
+ *
+ * Returns the number of CkptBufferIds entries consumed, which is always at
+ * least one, and sets *nwritten to the number of buffers actually written.
+ * Entries that are not consumed are left for the caller's next iteration.
+ */
+static int
+SyncCheckpointBufferRun(CkptTsStatus *ts_stat, int *nwritten,
+						WritebackContext *wb_context)
+{
+	static char *page_copies = NULL;
+	BufferDesc *run[MAX_IO_COMBINE_LIMIT];
+	const void *pages[MAX_IO_COMBINE_LIMIT];
+	CkptSortItem *first = &CkptBufferIds[ts_stat->index];
+	ErrorContextCallback errcallback;
+	XLogRecPtr	max_lsn = InvalidXLogRecPtr;
+	instr_time	io_start;
+	SMgrRelation reln;
+	BufferTag	next_tag;
+	ForkNumber	forknum;
+	BlockNumber first_block;
+	int			max_run;
+	int			nrun;
+
+	*nwritten = 0;
+
+	run[0] = GetBufferDescriptor(first->buf_id);
+	if (!PrepareCheckpointBufferWrite(run[0], NULL, &max_lsn))
+		return 1;
+	nrun = 1;
+
+	/* Don't run past the last entry for this tablespace */
+	max_run = Min(io_combine_limit, ts_stat->num_to_scan - ts_stat->num_scanned);
+
+	next_tag = run[0]->tag;
+	forknum = BufTagGetForkNum(&next_tag);
+	first_block = next_tag.blockNum;
+
+	while (nrun < max_run)
+	{
+		CkptSortItem *item = &CkptBufferIds[ts_stat->index + nrun];
+		BufferDesc *bufHdr = GetBufferDescriptor(item->buf_id);
+		XLogRecPtr	lsn;
+
+		/* The sort order tells us cheaply whether the next entry can follow */
+		if (item->relNumber != first->relNumber ||
+			item->forkNum != first->forkNum ||
+			item->blockNum != first_block + nrun)
+			break;
+		if (!(pg_atomic_read_u32(&bufHdr->state) & BM_CHECKPOINT_NEEDED))
+			break;
+
+		/* Also checks the database, which CkptSortItem doesn't record */
+		next_tag.blockNum = first_block + nrun;
+		if (!PrepareCheckpointBufferWrite(bufHdr, &next_tag, &lsn))
+			break;
+
+		max_lsn = Max(max_lsn, lsn);
+		run[nrun++] = bufHdr;
+	}
+
+	/* Setup error traceback support for ereport() */
+	errcallback.callback = shared_buffer_write_error_callback;
+	errcallback.arg = (void *) run[0];
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	reln = smgropen(BufTagGetRelFileLocator(&run[0]->tag), INVALID_PROC_NUMBER);
+
+	/* Enforce the WAL-before-data rule once, for the whole run */
+	if (!XLogRecPtrIsInvalid(max_lsn))
+		XLogFlush(max_lsn);
+
+	/*
+	 * We only hold share locks, so as in FlushBuffer() each page must be
+	 * copied to private memory if we need to compute its checksum.
+	 * PageSetChecksumCopy() has only one page of space, so keep our own.
+	 */
+	if (DataChecksumsEnabled() && page_copies == NULL)
+		page_copies = MemoryContextAllocAligned(TopMemoryContext,
+												MAX_IO_COMBINE_LIMIT * BLCKSZ,
+												PG_IO_ALIGN_SIZE,
+												0);
+
+	for (int i = 0; i < nrun; i++)
+	{
+		Page		page = (Page) BufHdrGetBlock(run[i]);
+
+		TRACE_POSTGRESQL_BUFFER_FLUSH_START(forknum,
+											first_block + i,
+											reln->smgr_rlocator.locator.spcOid,
+											reln->smgr_rlocator.locator.dbOid,
+											reln->smgr_rlocator.locator.relNumber);
+
+		if (DataChecksumsEnabled() && !PageIsNew(page))
+		{
+			char	   *copy = page_copies + i * BLCKSZ;
+
+			memcpy(copy, page, BLCKSZ);
+			PageSetChecksumInplace((Page) copy, first_block + i);
+			pages[i] = copy;
+		}
+		else
+			pages[i] = page;
+	}
+
+	io_start = pgstat_prepare_io_time(track_io_timing);
+
+	smgrwritev(reln, forknum, first_block, pages, nrun, false);
+
+	/* Only checkpointer calls this, so IOContext is always IOCONTEXT_NORMAL */
+	pgstat_count_io_op_time(IOOBJECT_RELATION, IOCONTEXT_NORMAL,
+							IOOP_WRITE, io_start, nrun);
+
+	pgBufferUsage.shared_blks_written += nrun;
+
+	for (int i = 0; i < nrun; i++)
+	{
+		BufferDesc *bufHdr = run[i];
+		BufferTag	tag;
+
+		/*
+		 * Mark the buffer as clean (unless BM_JUST_DIRTIED has become set)
+		 * and end the BM_IO_IN_PROGRESS state.
+		 */
+		TerminateBufferIO(bufHdr, true, 0, true);
+
+		TRACE_POSTGRESQL_BUFFER_FLUSH_DONE(forknum,
+										   first_block + i,
+										   reln->smgr_rlocator.locator.spcOid,
+										   reln->smgr_rlocator.locator.dbOid,
+										   reln->smgr_rlocator.locator.relNumber);
+
+		LWLockRelease(BufferDescriptorGetContentLock(bufHdr));
+		tag = bufHdr->tag;
+		UnpinBuffer(bufHdr);
+
+		ScheduleBufferTagForWriteback(wb_context, IOCONTEXT_NORMAL, &tag);
+
+		TRACE_POSTGRESQL_BUFFER_SYNC_WRITTEN(bufHdr->buf_id);
+	}
+
+	/* Pop the error context stack */
+	error_context_stack = errcallback.previous;
+
+	/* Remember to fsync the fork once we're done with it */
+	ts_stat->sync_pending = true;
+	ts_stat->sync_tag = next_tag;
+
+	*nwritten = nrun;
+	return nrun;
+}
+
+/*
+ * CheckpointSyncFork -- perform the pending fsyncs of the relation fork last
+ * written by SyncCheckpointBufferRun() in a tablespace
+ */
+static void
+CheckpointSyncFork(CkptTsStatus *ts_stat)
+{
+	SMgrRelation reln;
+
+	Assert(ts_stat->sync_pending);
+	ts_stat->sync_pending = false;
+
+	reln = smgropen(BufTagGetRelFileLocator(&ts_stat->sync_tag),
+					INVALID_PROC_NUMBER);
+	smgrsyncpending(reln, BufTagGetForkNum(&ts_stat->sync_tag));
+}
+
 /*
  *		AtEOXact_Buffers - clean up at end of transaction.
  *
@@ -4046,13 +4436,14 @@ DropRelationBuffers(SMgrRelation smgr_reln, ForkNumber *forkNum,
 
 	for (i = 0; i < NBuffers; i++)
 	{
-		BufferDesc *bufHdr = GetBufferDescriptor(i);
+		BufferDesc *bufHdr;
 		uint32		buf_state;
 
 		/*
-		 * We can make this a tad faster by prechecking the buffer tag before
-		 * we attempt to lock the buffer; this saves a lot of lock
-		 * acquisitions in typical cases.  It should be safe because the
+		 * We can make this a lot faster by prechecking the buffer's relation
+		 * number before we attempt to lock the buffer; this saves a lot of
+		 * lock acquisitions in typical cases, and BufferRelNumbers is much
+		 * smaller than the buffer descriptors.  It should be safe because the
 		 * caller must have AccessExclusiveLock on the relation, or some other
 		 * reason to be certain that no one is loading new pages of the rel
 		 * into the buffer pool.  (Otherwise we might well miss such pages
@@ -4065,9 +4456,10 @@ DropRelationBuffers(SMgrRelation smgr_reln, ForkNumber *forkNum,
 		 * We could check forkNum and blockNum as well as the rlocator, but
 		 * the incremental win from doing so seems small.
 		 */
-		if (!BufTagMatchesRelFileLocator(&bufHdr->tag, &rlocator.locator))
+		if (BufferRelNumbers[i] != rlocator.locator.relNumber)
 			continue;
 
+		bufHdr = GetBufferDescriptor(i);
 		buf_state = LockBufHdr(bufHdr);
 
 		for (j = 0; j < nforks; j++)
@@ -4102,6 +4494,7 @@ DropRelationsAllBuffers(SMgrRelation *smgr_reln, int nlocators)
 	BlockNumber (*block)[MAX_FORKNUM + 1];
 	uint64		nBlocksToInvalidate = 0;
 	RelFileLocator *locators;
+	RelFileNumber *relNumbers = NULL;
 	bool		cached = true;
 	bool		use_bsearch;
 
@@ -4202,20 +4595,38 @@ DropRelationsAllBuffers(SMgrRelation *smgr_reln, int nlocators)
 	 */
 	use_bsearch = n > RELS_BSEARCH_THRESHOLD;
 
-	/* sort the list of rlocators if necessary */
+	/*
+	 * Sort the list of rlocators if necessary.  Since rlocator_comparator
+	 * sorts by relNumber first, the relNumbers come out sorted too, so that
+	 * we can binary search them to precheck each buffer.
+	 */
 	if (use_bsearch)
+	{
 		qsort(locators, n, sizeof(RelFileLocator), rlocator_comparator);
+		relNumbers = palloc(sizeof(RelFileNumber) * n);
+		for (i = 0; i < n; i++)
+			relNumbers[i] = locators[i].relNumber;
+	}
 
 	for (i = 0; i < NBuffers; i++)
 	{
 		RelFileLocator *rlocator = NULL;
-		BufferDesc *bufHdr = GetBufferDescriptor(i);
+		RelFileNumber relNumber = BufferRelNumbers[i];
+		BufferDesc *bufHdr;
 		uint32		buf_state;
 
 		/*
 		 * As in DropRelationBuffers, an unlocked precheck should be safe and
 		 * saves some cycles.
 		 */
+		if (relNumber == InvalidRelFileNumber)
+			continue;
+		if (use_bsearch &&
+			bsearch(&relNumber, relNumbers, n, sizeof(RelFileNumber),
+					oid_cmp) == NULL)
+			continue;
+
+		bufHdr = GetBufferDescriptor(i);
 
 		if (!use_bsearch)
 		{
@@ -4223,7 +4634,8 @@ DropRelationsAllBuffers(SMgrRelation *smgr_reln, int nlocators)
 
 			for (j = 0; j < n; j++)
 			{
-				if (BufTagMatchesRelFileLocator(&bufHdr->tag, &locators[j]))
+				if (relNumber == locators[j].relNumber &&
+					BufTagMatchesRelFileLocator(&bufHdr->tag, &locators[j]))
 				{
 					rlocator = &locators[j];
 					break;
@@ -4251,6 +4663,8 @@ DropRelationsAllBuffers(SMgrRelation *smgr_reln, int nlocators)
 			UnlockBufHdr(bufHdr, buf_state);
 	}
 
+	if (relNumbers)
+		pfree(relNumbers);
 	pfree(locators);
 	pfree(rels);
 }
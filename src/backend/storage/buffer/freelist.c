@@ -64,6 +64,35 @@ typedef struct
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
 
+/*
+ * Ghost entries for the scan-resistant replacement policy: a direct-mapped
+ * table, with as many slots as there are buffers, of the hash codes of the
+ * buffer tags of pages recently evicted from shared buffers.  A page that is
+ * read back in while it still has a ghost entry was evicted too early, and
+ * gets a higher initial usage count than a page seen for the first time.
+ *
+ * The table is only a heuristic, so it is accessed without locking, and
+ * hash collisions are tolerated: a false hit merely lets a page stay in
+ * shared buffers a little longer.  Zero marks an empty slot.
+ */
+static pg_atomic_uint32 *GhostBufferTags = NULL;
+
+/* GUC variable */
+int			buffer_replacement_policy = BUFFER_REPLACEMENT_CLOCK_SWEEP;
+
+/*
+ * Initial usage counts under the scan-resistant policy, for pages without
+ * and with a ghost entry.
+ */
+#define FIRST_ACCESS_USAGE_COUNT	0
+#define GHOST_HIT_USAGE_COUNT		2
+
+/*
+ * Rings created by GetAccessStrategy() may grow up to this many times their
+ * initial size, but never beyond 1/8th of shared_buffers.
+ */
+#define STRATEGY_RING_MAX_GROWTH	16
+
 /*
  * Private (non-shared) state for managing a ring of shared buffers to re-use.
  * This is currently the only kind of BufferAccessStrategy object, but someday
@@ -73,9 +102,21 @@ typedef struct BufferAccessStrategyData
 {
 	/* Overall strategy type */
 	BufferAccessStrategyType btype;
-	/* Number of elements in buffers[] array */
+	/* Number of elements of buffers[] array currently in use as the ring */
 	int			nbuffers;
 
+	/*
+	 * Bounds for nbuffers.  If they differ, the ring is resized at each wrap
+	 * around depending on whether reusing its buffers forced WAL flushes; see
+	 * StrategyAdjustRingSize.  buffers[] is allocated with max_nbuffers
+	 * elements.
+	 */
+	int			min_nbuffers;
+	int			max_nbuffers;
+
+	/* Number of ring buffers written with a WAL flush since the last wrap */
+	int			wal_flushes;
+
 	/*
 	 * Index of the "current" slot in the ring, ie, the one most recently
 	 * returned by GetBufferFromRing.
@@ -97,6 +138,10 @@ static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
 									 uint32 *buf_state);
 static void AddBufferToRing(BufferAccessStrategy strategy,
 							BufferDesc *buf);
+static BufferAccessStrategy CreateAccessStrategy(BufferAccessStrategyType btype,
+												 int ring_size_kb,
+												 int max_growth);
+static void StrategyAdjustRingSize(BufferAccessStrategy strategy);
 
 /*
  * ClockSweepTick - Helper routine for StrategyGetBuffer()
@@ -379,6 +424,66 @@ StrategyFreeBuffer(BufferDesc *buf)
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 }
 
+/*
+ * GhostSlot -- map a buffer tag's hash code to its ghost table slot
+ *
+ * The slot is chosen by the higher-order bits of the hash code, as the
+ * lower-order ones select the buffer mapping partition.
+ */
+static inline pg_atomic_uint32 *
+GhostSlot(uint32 hashcode)
+{
+	return &GhostBufferTags[(hashcode >> 7) % NBuffers];
+}
+
+/*
+ * StrategyRememberEvicted -- record that a page is leaving shared buffers
+ *
+ * Called with the hash code of the buffer tag of a valid page whose buffer
+ * is being reused for another page.
+ */
+void
+StrategyRememberEvicted(uint32 hashcode)
+{
+	if (buffer_replacement_policy != BUFFER_REPLACEMENT_SCAN_RESISTANT)
+		return;
+
+	pg_atomic_write_u32(GhostSlot(hashcode), hashcode != 0 ? hashcode : 1);
+}
+
+/*
+ * StrategyInitialUsageCount -- usage count for a page newly read into a
+ * shared buffer
+ *
+ * With the plain clock sweep, every page starts with a usage count of one,
+ * so a page touched only once, e.g. by a large index or bitmap scan, needs
+ * as many sweeps to be evicted as a page that will be needed again soon.
+ * The scan-resistant policy instead starts pages at zero, making them the
+ * first to go unless they are accessed again while they are in the pool,
+ * and gives a head start to pages that had been evicted recently, as seen
+ * from their ghost entry.
+ */
+uint32
+StrategyInitialUsageCount(uint32 hashcode)
+{
+	pg_atomic_uint32 *slot;
+	uint32		ghost;
+
+	if (buffer_replacement_policy != BUFFER_REPLACEMENT_SCAN_RESISTANT)
+		return 1;
+
+	slot = GhostSlot(hashcode);
+	ghost = pg_atomic_read_u32(slot);
+	if (ghost != 0 && ghost == (hashcode != 0 ? hashcode : 1))
+	{
+		/* the page is resident again, so the ghost entry has served */
+		pg_atomic_write_u32(slot, 0);
+		return GHOST_HIT_USAGE_COUNT;
+	}
+
+	return FIRST_ACCESS_USAGE_COUNT;
+}
+
 /*
  * StrategySyncStart -- tell BufferSync where to start syncing
  *
@@ -460,6 +565,10 @@ StrategyShmemSize(void)
 	/* size of the shared replacement strategy control block */
 	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
+	/* size of the ghost table, if needed */
+	if (buffer_replacement_policy == BUFFER_REPLACEMENT_SCAN_RESISTANT)
+		size = add_size(size, mul_size(NBuffers, sizeof(pg_atomic_uint32)));
+
 	return size;
 }
 
@@ -523,6 +632,20 @@ StrategyInitialize(bool init)
 	}
 	else
 		Assert(!init);
+
+	if (buffer_replacement_policy == BUFFER_REPLACEMENT_SCAN_RESISTANT)
+	{
+		GhostBufferTags = (pg_atomic_uint32 *)
+			ShmemInitStruct("Buffer Ghost Entries",
+							mul_size(NBuffers, sizeof(pg_atomic_uint32)),
+							&found);
+
+		if (!found)
+		{
+			for (int i = 0; i < NBuffers; i++)
+				pg_atomic_init_u32(&GhostBufferTags[i], 0);
+		}
+	}
 }
 
 
@@ -570,7 +693,7 @@ GetAccessStrategy(BufferAccessStrategyType btype)
 			return NULL;		/* keep compiler quiet */
 	}
 
-	return GetAccessStrategyWithSize(btype, ring_size_kb);
+	return CreateAccessStrategy(btype, ring_size_kb, STRATEGY_RING_MAX_GROWTH);
 }
 
 /*
@@ -579,11 +702,28 @@ GetAccessStrategy(BufferAccessStrategyType btype)
  *
  * If the given ring size is 0, no BufferAccessStrategy will be created and
  * the function will return NULL.  ring_size_kb must not be negative.
+ *
+ * Since the caller asked for a specific size, the ring is never resized.
  */
 BufferAccessStrategy
 GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
+{
+	return CreateAccessStrategy(btype, ring_size_kb, 1);
+}
+
+/*
+ * CreateAccessStrategy -- workhorse for GetAccessStrategy and
+ *		GetAccessStrategyWithSize
+ *
+ * The ring starts with ring_size_kb worth of buffers, and may grow up to
+ * max_growth times that.
+ */
+static BufferAccessStrategy
+CreateAccessStrategy(BufferAccessStrategyType btype, int ring_size_kb,
+					 int max_growth)
 {
 	int			ring_buffers;
+	int			max_ring_buffers;
 	BufferAccessStrategy strategy;
 
 	Assert(ring_size_kb >= 0);
@@ -595,8 +735,9 @@ GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
 	if (ring_buffers == 0)
 		return NULL;
 
-	/* Cap to 1/8th of shared_buffers */
+	/* Cap to 1/8th of shared_buffers, also when growing */
 	ring_buffers = Min(NBuffers / 8, ring_buffers);
+	max_ring_buffers = Min(NBuffers / 8, ring_buffers * max_growth);
 
 	/* NBuffers should never be less than 16, so this shouldn't happen */
 	Assert(ring_buffers > 0);
@@ -604,15 +745,52 @@ GetAccessStrategyWithSize(BufferAccessStrategyType btype, int ring_size_kb)
 	/* Allocate the object and initialize all elements to zeroes */
 	strategy = (BufferAccessStrategy)
 		palloc0(offsetof(BufferAccessStrategyData, buffers) +
-				ring_buffers * sizeof(Buffer));
+				max_ring_buffers * sizeof(Buffer));
 
 	/* Set fields that don't start out zero */
 	strategy->btype = btype;
 	strategy->nbuffers = ring_buffers;
+	strategy->min_nbuffers = ring_buffers;
+	strategy->max_nbuffers = max_ring_buffers;
 
 	return strategy;
 }
 
+/*
+ * StrategyAdjustRingSize -- resize the ring after a full pass over it
+ *
+ * Reusing a dirty ring buffer whose LSN hasn't been flushed yet forces a WAL
+ * flush, so with a ring that is small compared to the rate at which WAL is
+ * generated, a bulk write ends up flushing WAL once per trip around the ring.
+ * If that happened during the pass just completed, double the ring so that
+ * each flush covers more of the work.  If the pass didn't need any WAL
+ * flush, halve it again so that we don't keep more of shared buffers than
+ * we need.
+ *
+ * Slots added by growing the ring start out empty and are filled by the
+ * normal allocation strategy; slots dropped by shrinking it are forgotten,
+ * leaving their buffers to the clock sweep.
+ */
+static void
+StrategyAdjustRingSize(BufferAccessStrategy strategy)
+{
+	int			nbuffers = strategy->nbuffers;
+
+	Assert(strategy->current == 0);
+
+	if (strategy->wal_flushes > 0)
+		nbuffers = Min(nbuffers * 2, strategy->max_nbuffers);
+	else
+		nbuffers = Max(nbuffers / 2, strategy->min_nbuffers);
+
+	if (nbuffers < strategy->nbuffers)
+		memset(&strategy->buffers[nbuffers], 0,
+			   (strategy->nbuffers - nbuffers) * sizeof(Buffer));
+
+	strategy->nbuffers = nbuffers;
+	strategy->wal_flushes = 0;
+}
+
 /*
  * GetAccessStrategyBufferCount -- an accessor for the number of buffers in
  *		the ring
@@ -701,8 +879,13 @@ GetBufferFromRing(BufferAccessStrategy strategy, uint32 *buf_state)
 
 	/* Advance to next ring slot */
 	if (++strategy->current >= strategy->nbuffers)
+	{
 		strategy->current = 0;
 
+		if (strategy->min_nbuffers != strategy->max_nbuffers)
+			StrategyAdjustRingSize(strategy);
+	}
+
 	/*
 	 * If the slot hasn't been filled yet, tell the caller to allocate a new
 	 * buffer with the normal allocation strategy.  He will then fill this
@@ -797,15 +980,22 @@ IOContextForStrategy(BufferAccessStrategy strategy)
 bool
 StrategyRejectBuffer(BufferAccessStrategy strategy, BufferDesc *buf, bool from_ring)
 {
-	/* We only do this in bulkread mode */
-	if (strategy->btype != BAS_BULKREAD)
-		return false;
-
 	/* Don't muck with behavior of normal buffer-replacement strategy */
 	if (!from_ring ||
 		strategy->buffers[strategy->current] != BufferDescriptorGetBuffer(buf))
 		return false;
 
+	/*
+	 * We only reject buffers in bulkread mode.  Otherwise, the buffer will be
+	 * written with a WAL flush, which may make us grow the ring.
+	 */
+	if (strategy->btype != BAS_BULKREAD)
+	{
+		if (strategy->min_nbuffers != strategy->max_nbuffers)
+			strategy->wal_flushes++;
+		return false;
+	}
+
 	/*
 	 * Remove the dirty buffer from the ring; necessary to prevent infinite
 	 * loop if all ring members are dirty.
@@ -40,12 +40,24 @@
  * when the corresponding files need to be survived across the transaction and
  * need to be opened and closed multiple times.  Such files need to be created
  * as a member of a FileSet.
+ *
+ * BufFiles created with BufFileCreateCompressTemp() are compressed one
+ * buffer at a time, using the method selected by temp_file_compression.
+ * Each buffer is stored as a BufFileChunkHeader followed by its data,
+ * compressed if that made it smaller.  Since logical positions no longer
+ * map to physical ones, such files must be written sequentially, and the
+ * only seek supported is rewinding to the start to read them back.
  *-------------------------------------------------------------------------
  */
 
 #include "postgres.h"
 
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
 #include "commands/tablespace.h"
+#include "common/pg_lzcompress.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -62,6 +74,23 @@
 #define MAX_PHYSICAL_FILESIZE	0x40000000
 #define BUFFILE_SEG_SIZE		(MAX_PHYSICAL_FILESIZE / BLCKSZ)
 
+/*
+ * While a BufFile is read sequentially, we ask the kernel to read ahead this
+ * much, renewing the advice whenever we are less than half of it away from
+ * the end of what was last advised.
+ */
+#define BUFFILE_READ_AHEAD		(256 * 1024)
+
+/* Header of each buffer in a compressed BufFile */
+typedef struct BufFileChunkHeader
+{
+	int32		clen;			/* stored length, == rawlen if uncompressed */
+	int32		rawlen;			/* length of the uncompressed data */
+} BufFileChunkHeader;
+
+/* GUC variable */
+int			temp_file_compression = TEMP_FILE_COMPRESSION_NONE;
+
 /*
  * This data structure represents a buffered file that consists of one or
  * more physical files (each accessed through a virtual file descriptor
@@ -96,18 +125,38 @@ struct BufFile
 	int			pos;			/* next read/write position in buffer */
 	int			nbytes;			/* total # of valid bytes in buffer */
 
+	/*
+	 * Read-ahead state: where the next read would start if the file is read
+	 * sequentially, and how far read-ahead has been advised.
+	 */
+	int			nextReadFile;
+	off_t		nextReadOffset;
+	int			readAheadFile;
+	off_t		readAheadOffset;
+
 	/*
 	 * XXX Should ideally us PGIOAlignedBlock, but might need a way to avoid
 	 * wasting per-file alignment padding when some users create many files.
 	 */
 	PGAlignedBlock buffer;
+
+	/*
+	 * For compressed files, the method in use, the physical length of the
+	 * chunk currently in the buffer, and space for compressed data.
+	 */
+	int			compress;
+	int			chunkLen;
+	char	   *cbuffer;
 };
 
 static BufFile *makeBufFileCommon(int nfiles);
 static BufFile *makeBufFile(File firstfile);
 static void extendBufFile(BufFile *file);
+static void BufFileReadAhead(BufFile *file);
 static void BufFileLoadBuffer(BufFile *file);
+static void BufFileLoadCompressedBuffer(BufFile *file);
 static void BufFileDumpBuffer(BufFile *file);
+static void BufFileDumpCompressedBuffer(BufFile *file);
 static void BufFileFlush(BufFile *file);
 static File MakeNewFileSetSegment(BufFile *buffile, int segment);
 
@@ -127,6 +176,13 @@ makeBufFileCommon(int nfiles)
 	file->curOffset = 0;
 	file->pos = 0;
 	file->nbytes = 0;
+	file->nextReadFile = -1;
+	file->nextReadOffset = 0;
+	file->readAheadFile = -1;
+	file->readAheadOffset = 0;
+	file->compress = TEMP_FILE_COMPRESSION_NONE;
+	file->chunkLen = 0;
+	file->cbuffer = NULL;
 
 	return file;
 }
@@ -215,6 +271,26 @@ BufFileCreateTemp(bool interXact)
 	return file;
 }
 
+/*
+ * Like BufFileCreateTemp(), but the file is compressed according to
+ * temp_file_compression.  The caller must only write to it sequentially, and
+ * can then read it back after rewinding it with BufFileSeek(file, 0, 0,
+ * SEEK_SET).
+ */
+BufFile *
+BufFileCreateCompressTemp(bool interXact)
+{
+	BufFile    *file = BufFileCreateTemp(interXact);
+
+	if (temp_file_compression != TEMP_FILE_COMPRESSION_NONE)
+	{
+		file->compress = temp_file_compression;
+		file->cbuffer = palloc(PGLZ_MAX_OUTPUT(BLCKSZ));
+	}
+
+	return file;
+}
+
 /*
  * Build the name for a given segment of a given BufFile.
  */
@@ -420,9 +496,73 @@ BufFileClose(BufFile *file)
 		FileClose(file->files[i]);
 	/* release the buffer space */
 	pfree(file->files);
+	if (file->cbuffer)
+		pfree(file->cbuffer);
 	pfree(file);
 }
 
+/*
+ * BufFileReadAhead
+ *
+ * If the read about to be done at the current position continues where the
+ * previous one ended, advise the kernel that we'll soon need the data
+ * following it, so that sequential reads of temp files such as hash join
+ * batches don't wait for the disk on every buffer load.
+ */
+static void
+BufFileReadAhead(BufFile *file)
+{
+	off_t		start;
+	off_t		end;
+
+	if (file->curFile != file->nextReadFile ||
+		file->curOffset != file->nextReadOffset)
+		return;
+
+	if (file->readAheadFile == file->curFile &&
+		file->readAheadOffset > file->curOffset)
+	{
+		/* still far enough ahead? */
+		if (file->readAheadOffset - file->curOffset > BUFFILE_READ_AHEAD / 2)
+			return;
+		start = file->readAheadOffset;
+	}
+	else
+		start = file->curOffset + sizeof(file->buffer);
+
+	/* never beyond the end of this segment */
+	end = Min(file->curOffset + BUFFILE_READ_AHEAD, MAX_PHYSICAL_FILESIZE);
+	if (end <= start)
+		return;
+
+	(void) FilePrefetch(file->files[file->curFile], start, end - start,
+						WAIT_EVENT_BUFFILE_READ);
+	file->readAheadFile = file->curFile;
+	file->readAheadOffset = end;
+}
+
+/*
+ * BufFilePrefetchBlock
+ *
+ * Advise that the nblocks BLCKSZ-sized blocks starting at blknum will be
+ * read soon.  This is for callers that know they'll seek there, such as
+ * logtape.c; sequential reads are handled automatically.
+ */
+void
+BufFilePrefetchBlock(BufFile *file, int64 blknum, int nblocks)
+{
+	int			fileno = (int) (blknum / BUFFILE_SEG_SIZE);
+	off_t		offset = (off_t) (blknum % BUFFILE_SEG_SIZE) * BLCKSZ;
+	off_t		amount;
+
+	if (fileno >= file->numFiles || nblocks <= 0)
+		return;
+
+	amount = Min((off_t) nblocks * BLCKSZ, MAX_PHYSICAL_FILESIZE - offset);
+	(void) FilePrefetch(file->files[fileno], offset, amount,
+						WAIT_EVENT_BUFFILE_READ);
+}
+
 /*
  * BufFileLoadBuffer
  *
@@ -437,6 +577,12 @@ BufFileLoadBuffer(BufFile *file)
 	instr_time	io_start;
 	instr_time	io_time;
 
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		BufFileLoadCompressedBuffer(file);
+		return;
+	}
+
 	/*
 	 * Advance to next component file if necessary and possible.
 	 */
@@ -449,6 +595,8 @@ BufFileLoadBuffer(BufFile *file)
 
 	thisfile = file->files[file->curFile];
 
+	BufFileReadAhead(file);
+
 	if (track_io_timing)
 		INSTR_TIME_SET_CURRENT(io_start);
 	else
@@ -479,10 +627,220 @@ BufFileLoadBuffer(BufFile *file)
 
 	/* we choose not to advance curOffset here */
 
+	file->nextReadFile = file->curFile;
+	file->nextReadOffset = file->curOffset + file->nbytes;
+
 	if (file->nbytes > 0)
 		pgBufferUsage.temp_blks_read++;
 }
 
+/*
+ * BufFileLoadCompressedBuffer
+ *
+ * BufFileLoadBuffer() for compressed files: read the chunk at curOffset and
+ * decompress it into the buffer.  Sets chunkLen to the chunk's physical
+ * length, so that the reader knows how far to advance curOffset.
+ */
+static void
+BufFileLoadCompressedBuffer(BufFile *file)
+{
+	BufFileChunkHeader hdr;
+	File		thisfile;
+	int			nread;
+	char	   *dest;
+	instr_time	io_start;
+	instr_time	io_time;
+
+	file->nbytes = 0;
+	file->chunkLen = 0;
+
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(io_start);
+	else
+		INSTR_TIME_SET_ZERO(io_start);
+
+	/*
+	 * Chunks never cross a segment boundary, so when we reach the end of a
+	 * segment, continue with the next one, if any.
+	 */
+	for (;;)
+	{
+		thisfile = file->files[file->curFile];
+		BufFileReadAhead(file);
+		nread = FileRead(thisfile, &hdr, sizeof(hdr), file->curOffset,
+						 WAIT_EVENT_BUFFILE_READ);
+		if (nread < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m",
+							FilePathName(thisfile))));
+		if (nread > 0 || file->curFile + 1 >= file->numFiles)
+			break;
+		file->curFile++;
+		file->curOffset = 0;
+	}
+
+	if (nread == 0)
+		return;					/* EOF */
+
+	if (nread != sizeof(hdr) ||
+		hdr.rawlen <= 0 || hdr.rawlen > BLCKSZ ||
+		hdr.clen <= 0 || hdr.clen > hdr.rawlen)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("invalid chunk header in compressed temporary file \"%s\"",
+								 FilePathName(thisfile))));
+
+	/* Uncompressed chunks can be read straight into the buffer */
+	dest = (hdr.clen == hdr.rawlen) ? file->buffer.data : file->cbuffer;
+	nread = FileRead(thisfile, dest, hdr.clen,
+					 file->curOffset + sizeof(hdr),
+					 WAIT_EVENT_BUFFILE_READ);
+	if (nread != hdr.clen)
+	{
+		if (nread < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m",
+							FilePathName(thisfile))));
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("could not read file \"%s\": read only %d of %d bytes",
+								 FilePathName(thisfile), nread, hdr.clen)));
+	}
+
+	if (track_io_timing)
+	{
+		INSTR_TIME_SET_CURRENT(io_time);
+		INSTR_TIME_ACCUM_DIFF(pgBufferUsage.temp_blk_read_time, io_time, io_start);
+	}
+
+	if (hdr.clen != hdr.rawlen)
+	{
+		int			rawlen = -1;
+
+		switch (file->compress)
+		{
+			case TEMP_FILE_COMPRESSION_PGLZ:
+				rawlen = pglz_decompress(file->cbuffer, hdr.clen,
+										 file->buffer.data, hdr.rawlen, true);
+				break;
+			case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+				rawlen = LZ4_decompress_safe(file->cbuffer, file->buffer.data,
+											 hdr.clen, hdr.rawlen);
+#endif
+				break;
+		}
+		if (rawlen != hdr.rawlen)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("could not decompress chunk of temporary file \"%s\"",
+									 FilePathName(thisfile))));
+	}
+
+	file->nbytes = hdr.rawlen;
+	file->chunkLen = sizeof(hdr) + hdr.clen;
+	file->nextReadFile = file->curFile;
+	file->nextReadOffset = file->curOffset + file->chunkLen;
+	pgBufferUsage.temp_blks_read++;
+}
+
+/*
+ * BufFileDumpCompressedBuffer
+ *
+ * BufFileDumpBuffer() for compressed files: compress the buffer and append
+ * it as one chunk at curOffset, which is always the end of the file.
+ */
+static void
+BufFileDumpCompressedBuffer(BufFile *file)
+{
+	BufFileChunkHeader hdr;
+	const char *data;
+	File		thisfile;
+	int			clen = -1;
+	int			nwritten;
+	instr_time	io_start;
+	instr_time	io_time;
+
+	/* We don't allow seeking, so the buffer was filled sequentially */
+	Assert(file->pos == file->nbytes);
+
+	switch (file->compress)
+	{
+		case TEMP_FILE_COMPRESSION_PGLZ:
+			clen = pglz_compress(file->buffer.data, file->nbytes,
+								 file->cbuffer, PGLZ_strategy_default);
+			break;
+		case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			clen = LZ4_compress_default(file->buffer.data, file->cbuffer,
+										file->nbytes, file->nbytes - 1);
+#endif
+			break;
+	}
+
+	/* Store the data uncompressed if compression didn't make it smaller */
+	hdr.rawlen = file->nbytes;
+	if (clen > 0 && clen < file->nbytes)
+	{
+		hdr.clen = clen;
+		data = file->cbuffer;
+	}
+	else
+	{
+		hdr.clen = file->nbytes;
+		data = file->buffer.data;
+	}
+
+	/* Start a new segment if the chunk doesn't fit into this one */
+	if (file->curOffset + sizeof(hdr) + hdr.clen > MAX_PHYSICAL_FILESIZE)
+	{
+		while (file->curFile + 1 >= file->numFiles)
+			extendBufFile(file);
+		file->curFile++;
+		file->curOffset = 0;
+	}
+	thisfile = file->files[file->curFile];
+
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(io_start);
+	else
+		INSTR_TIME_SET_ZERO(io_start);
+
+	nwritten = FileWrite(thisfile, &hdr, sizeof(hdr), file->curOffset,
+						 WAIT_EVENT_BUFFILE_WRITE);
+	if (nwritten == sizeof(hdr))
+		nwritten = FileWrite(thisfile, data, hdr.clen,
+							 file->curOffset + sizeof(hdr),
+							 WAIT_EVENT_BUFFILE_WRITE);
+	else
+		nwritten = -1;
+	if (nwritten != hdr.clen)
+	{
+		/* if write didn't set errno, assume problem is no disk space */
+		if (nwritten >= 0)
+			errno = ENOSPC;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to file \"%s\": %m",
+						FilePathName(thisfile))));
+	}
+
+	if (track_io_timing)
+	{
+		INSTR_TIME_SET_CURRENT(io_time);
+		INSTR_TIME_ACCUM_DIFF(pgBufferUsage.temp_blk_write_time, io_time, io_start);
+	}
+
+	pgBufferUsage.temp_blks_written++;
+
+	file->curOffset += sizeof(hdr) + hdr.clen;
+	file->dirty = false;
+	file->pos = 0;
+	file->nbytes = 0;
+}
+
 /*
  * BufFileDumpBuffer
  *
@@ -497,6 +855,12 @@ BufFileDumpBuffer(BufFile *file)
 	int			bytestowrite;
 	File		thisfile;
 
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		BufFileDumpCompressedBuffer(file);
+		return;
+	}
+
 	/*
 	 * Unlike BufFileLoadBuffer, we must dump the whole buffer even if it
 	 * crosses a component-file boundary; so we need a loop.
@@ -603,7 +967,10 @@ BufFileReadCommon(BufFile *file, void *ptr, size_t size, bool exact, bool eofOK)
 		if (file->pos >= file->nbytes)
 		{
 			/* Try to load more data into buffer. */
-			file->curOffset += file->pos;
+			if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+				file->curOffset += file->chunkLen;
+			else
+				file->curOffset += file->pos;
 			file->pos = 0;
 			file->nbytes = 0;
 			BufFileLoadBuffer(file);
@@ -689,6 +1056,8 @@ BufFileWrite(BufFile *file, const void *ptr, size_t size)
 			else
 			{
 				/* Hmm, went directly from reading to writing? */
+				if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+					elog(ERROR, "cannot write to compressed temporary file after reading it");
 				file->curOffset += file->pos;
 				file->pos = 0;
 				file->nbytes = 0;
@@ -742,6 +1111,20 @@ BufFileSeek(BufFile *file, int fileno, off_t offset, int whence)
 	int			newFile;
 	off_t		newOffset;
 
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		if (whence != SEEK_SET || fileno != 0 || offset != 0)
+			elog(ERROR, "compressed temporary files can only be rewound");
+
+		BufFileFlush(file);
+		file->curFile = 0;
+		file->curOffset = 0;
+		file->pos = 0;
+		file->nbytes = 0;
+		file->chunkLen = 0;
+		return 0;
+	}
+
 	switch (whence)
 	{
 		case SEEK_SET:
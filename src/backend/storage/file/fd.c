@@ -3939,7 +3939,7 @@ data_sync_elevel(int elevel)
 }
 
 bool
-check_debug_io_direct(char **newval, void **extra, GucSource source)
+check_io_direct(char **newval, void **extra, GucSource source)
 {
 	bool		result = true;
 	int			flags;
@@ -3947,7 +3947,7 @@ check_debug_io_direct(char **newval, void **extra, GucSource source)
 #if PG_O_DIRECT == 0
 	if (strcmp(*newval, "") != 0)
 	{
-		GUC_check_errdetail("debug_io_direct is not supported on this platform.");
+		GUC_check_errdetail("io_direct is not supported on this platform.");
 		result = false;
 	}
 	flags = 0;
@@ -3962,7 +3962,7 @@ check_debug_io_direct(char **newval, void **extra, GucSource source)
 	if (!SplitGUCList(rawstring, ',', &elemlist))
 	{
 		GUC_check_errdetail("Invalid list syntax in parameter %s",
-							"debug_io_direct");
+							"io_direct");
 		pfree(rawstring);
 		list_free(elemlist);
 		return false;
@@ -3994,14 +3994,14 @@ check_debug_io_direct(char **newval, void **extra, GucSource source)
 #if XLOG_BLCKSZ < PG_IO_ALIGN_SIZE
 	if (result && (flags & (IO_DIRECT_WAL | IO_DIRECT_WAL_INIT)))
 	{
-		GUC_check_errdetail("debug_io_direct is not supported for WAL because XLOG_BLCKSZ is too small");
+		GUC_check_errdetail("io_direct is not supported for WAL because XLOG_BLCKSZ is too small");
 		result = false;
 	}
 #endif
 #if BLCKSZ < PG_IO_ALIGN_SIZE
 	if (result && (flags & IO_DIRECT_DATA))
 	{
-		GUC_check_errdetail("debug_io_direct is not supported for data because BLCKSZ is too small");
+		GUC_check_errdetail("io_direct is not supported for data because BLCKSZ is too small");
 		result = false;
 	}
 #endif
@@ -4013,7 +4013,7 @@ check_debug_io_direct(char **newval, void **extra, GucSource source)
 	if (!result)
 		return result;
 
-	/* Save the flags in *extra, for use by assign_debug_io_direct */
+	/* Save the flags in *extra, for use by assign_io_direct */
 	*extra = guc_malloc(ERROR, sizeof(int));
 	*((int *) *extra) = flags;
 
@@ -4021,7 +4021,7 @@ check_debug_io_direct(char **newval, void **extra, GucSource source)
 }
 
 extern void
-assign_debug_io_direct(const char *newval, void *extra)
+assign_io_direct(const char *newval, void *extra)
 {
 	int		   *flags = (int *) extra;
 
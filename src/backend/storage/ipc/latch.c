@@ -49,6 +49,10 @@
 #ifdef HAVE_POLL_H
 #include <poll.h>
 #endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 #include "libpq/pqsignal.h"
 #include "miscadmin.h"
@@ -98,6 +102,29 @@
 #endif
 #endif
 
+/*
+ * On Linux, WaitLatch() calls that wait for nothing but our own latch, a
+ * timeout and postmaster death sleep directly on the latch's is_set flag
+ * with futex(2), and SetLatch() wakes them with FUTEX_WAKE.  That avoids
+ * delivering a signal and draining the signalfd for the most common kind of
+ * wait.  Postmaster death doesn't have a file descriptor to wait on in that
+ * case; instead the death signal's handler sets our latch (see pmsignal.c),
+ * which interrupts the futex wait.
+ */
+#if defined(__linux__) && defined(WAIT_USE_SIGNALFD) && \
+	defined(USE_POSTMASTER_DEATH_SIGNAL)
+#define WAIT_USE_FUTEX
+#endif
+
+/*
+ * Values of Latch.maybe_sleeping.  The owner sets it before checking is_set
+ * for the last time, so that SetLatch() knows whether it has to wake the
+ * owner up, and how.
+ */
+#define LATCH_NOT_SLEEPING		0
+#define LATCH_SLEEPING			1	/* in WaitEventSetWaitBlock() */
+#define LATCH_SLEEPING_FUTEX	2	/* in WaitLatchFutex() */
+
 /* typedef in latch.h */
 struct WaitEventSet
 {
@@ -197,6 +224,11 @@ static void WaitEventAdjustWin32(WaitEventSet *set, WaitEvent *event);
 static inline int WaitEventSetWaitBlock(WaitEventSet *set, int cur_timeout,
 										WaitEvent *occurred_events, int nevents);
 
+#ifdef WAIT_USE_FUTEX
+static int	WaitLatchFutex(Latch *latch, int wakeEvents, long timeout,
+						   uint32 wait_event_info);
+#endif
+
 /* ResourceOwner support to hold WaitEventSets */
 static void ResOwnerReleaseWaitEventSet(Datum res);
 
@@ -531,6 +563,14 @@ WaitLatch(Latch *latch, int wakeEvents, long timeout,
 	 */
 	if (!(wakeEvents & WL_LATCH_SET))
 		latch = NULL;
+
+#ifdef WAIT_USE_FUTEX
+	/* Use the cheaper futex wait if there's nothing but the latch to watch */
+	if (latch == MyLatch && latch != NULL &&
+		(wakeEvents & ~(WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH)) == 0)
+		return WaitLatchFutex(latch, wakeEvents, timeout, wait_event_info);
+#endif
+
 	ModifyWaitEvent(LatchWaitSet, LatchWaitSetLatchPos, WL_LATCH_SET, latch);
 	LatchWaitSet->exit_on_postmaster_death =
 		((wakeEvents & WL_EXIT_ON_PM_DEATH) != 0);
@@ -544,6 +584,108 @@ WaitLatch(Latch *latch, int wakeEvents, long timeout,
 		return event.events;
 }
 
+#ifdef WAIT_USE_FUTEX
+/*
+ * Implementation of WaitLatch() for waits on our own latch, optionally with
+ * a timeout and WL_EXIT_ON_PM_DEATH, by sleeping on latch->is_set with
+ * futex(2).
+ *
+ * The kernel only puts us to sleep if is_set is still 0 at that point, so a
+ * SetLatch() that happens after our last check can't be missed: either it
+ * changes is_set first and FUTEX_WAIT returns EAGAIN, or it finds
+ * maybe_sleeping set and wakes us with FUTEX_WAKE.  Signal handlers that set
+ * our latch interrupt the wait, and postmaster death is caught the same way,
+ * because the death signal's handler sets our latch too.
+ */
+static int
+WaitLatchFutex(Latch *latch, int wakeEvents, long timeout,
+			   uint32 wait_event_info)
+{
+	instr_time	start_time;
+	instr_time	cur_time;
+	long		cur_timeout = -1;
+	int			result = 0;
+
+	StaticAssertStmt(sizeof(latch->is_set) == sizeof(uint32),
+					 "futex requires a 32-bit latch flag");
+	Assert(latch->owner_pid == MyProcPid);
+
+	if (wakeEvents & WL_TIMEOUT)
+	{
+		INSTR_TIME_SET_CURRENT(start_time);
+		Assert(timeout >= 0 && timeout <= INT_MAX);
+		cur_timeout = timeout;
+	}
+	else
+		INSTR_TIME_SET_ZERO(start_time);
+
+	pgstat_report_wait_start(wait_event_info);
+
+	for (;;)
+	{
+		struct timespec ts;
+		int			rc;
+
+		/* about to sleep on the latch, so recheck it after saying so */
+		if (!latch->is_set)
+		{
+			latch->maybe_sleeping = LATCH_SLEEPING_FUTEX;
+			pg_memory_barrier();
+		}
+
+		if (latch->is_set)
+		{
+			latch->maybe_sleeping = LATCH_NOT_SLEEPING;
+			result = WL_LATCH_SET;
+			break;
+		}
+
+		/*
+		 * This is cheap unless the death signal has arrived.  If it arrives
+		 * after this check, the latch will have been set by then.
+		 */
+		if ((wakeEvents & WL_EXIT_ON_PM_DEATH) && !PostmasterIsAlive())
+		{
+			latch->maybe_sleeping = LATCH_NOT_SLEEPING;
+			proc_exit(1);
+		}
+
+		if (cur_timeout >= 0)
+		{
+			ts.tv_sec = cur_timeout / 1000;
+			ts.tv_nsec = (cur_timeout % 1000) * 1000000;
+		}
+
+		rc = syscall(SYS_futex, &latch->is_set, FUTEX_WAIT, 0,
+					 cur_timeout >= 0 ? &ts : NULL, NULL, 0);
+
+		latch->maybe_sleeping = LATCH_NOT_SLEEPING;
+
+		if (rc < 0 && errno == ETIMEDOUT)
+			break;				/* timeout occurred */
+		else if (rc < 0 && errno != EAGAIN && errno != EINTR)
+		{
+			pgstat_report_wait_end();
+			elog(ERROR, "futex() failed: %m");
+		}
+
+		/* If we're not done, update cur_timeout for next iteration */
+		if (timeout >= 0 && cur_timeout >= 0 && !latch->is_set)
+		{
+			INSTR_TIME_SET_CURRENT(cur_time);
+			INSTR_TIME_SUBTRACT(cur_time, start_time);
+			cur_timeout = timeout - (long) INSTR_TIME_GET_MILLISEC(cur_time);
+			if (cur_timeout <= 0)
+				break;
+		}
+	}
+
+	pgstat_report_wait_end();
+
+	return result ? result : WL_TIMEOUT;
+}
+#endif							/* WAIT_USE_FUTEX */
+
 /*
  * Like WaitLatch, but with an extra socket argument for WL_SOCKET_*
  * conditions.
@@ -654,6 +796,22 @@ SetLatch(Latch *latch)
 	if (!latch->maybe_sleeping)
 		return;
 
+#ifdef WAIT_USE_FUTEX
+
+	/*
+	 * If the owner sleeps in WaitLatchFutex(), FUTEX_WAKE is all it takes.
+	 * If the owner is ourselves, we're in a signal handler that has already
+	 * interrupted the wait, or the futex call will see is_set changed.
+	 */
+	if (latch->maybe_sleeping == LATCH_SLEEPING_FUTEX)
+	{
+		owner_pid = latch->owner_pid;
+		if (owner_pid != 0 && owner_pid != MyProcPid)
+			syscall(SYS_futex, &latch->is_set, FUTEX_WAKE, 1, NULL, NULL, 0);
+		return;
+	}
+#endif
+
 #ifndef WIN32
 
 	/*
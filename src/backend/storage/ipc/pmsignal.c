@@ -24,6 +24,7 @@
 #include "miscadmin.h"
 #include "postmaster/postmaster.h"
 #include "replication/walsender.h"
+#include "storage/latch.h"
 #include "storage/pmsignal.h"
 #include "storage/shmem.h"
 #include "utils/memutils.h"
@@ -101,6 +102,13 @@ static void
 postmaster_death_handler(SIGNAL_ARGS)
 {
 	postmaster_possibly_dead = true;
+
+	/*
+	 * Also set our latch.  Waits that don't watch the postmaster pipe, such
+	 * as the futex-based latch wait in latch.c, rely on that to notice.
+	 */
+	if (MyLatch != NULL)
+		SetLatch(MyLatch);
 }
 
 /*
@@ -26,6 +26,7 @@
 #include "storage/shmem.h"
 #include "storage/sinvaladt.h"
 #include "storage/spin.h"
+#include "utils/guc_hooks.h"
 
 /*
  * Conceptually, the shared cache invalidation messages are stored in an
@@ -43,9 +44,10 @@
  * SICleanupQueue is called, and we try not to do that often.)
  *
  * In reality, the messages are stored in a circular buffer of MAXNUMMESSAGES
- * entries.  We translate MsgNum values into circular-buffer indexes by
- * computing MsgNum % MAXNUMMESSAGES (this should be fast as long as
- * MAXNUMMESSAGES is a constant and a power of 2).  As long as maxMsgNum
+ * entries, where MAXNUMMESSAGES is set by invalidation_queue_size.  We
+ * translate MsgNum values into circular-buffer indexes by masking off the
+ * high bits of MsgNum (MAXNUMMESSAGES is required to be a power of 2 so that
+ * this works and is fast).  As long as maxMsgNum
  * doesn't exceed minMsgNum by more than MAXNUMMESSAGES, we have enough space
  * in the buffer.  If the buffer does overflow, we recover by setting the
  * "reset" flag for each backend that has fallen too far behind.  A backend
@@ -53,6 +55,16 @@
  * it does finally attempt to receive inval messages, it must discard all
  * its invalidatable state, since it won't know what it missed.
  *
+ * Most messages only concern one database, and a backend connected to some
+ * other database simply ignores them.  To keep such backends from being
+ * woken up, signaled, or reset on account of messages they don't care
+ * about, each ProcState records its backend's database, and writers only
+ * set hasMessages for backends that might be interested in what was added.
+ * A backend whose hasMessages flag is clear therefore has nothing relevant
+ * among its unread messages, and SICleanupQueue just advances its
+ * nextMsgNum to the end of the queue instead of letting it hold back
+ * minMsgNum.
+ *
  * To reduce the probability of needing resets, we send a "catchup" interrupt
  * to any backend that seems to be falling unreasonably far behind.  The
  * normal behavior is that at most one such interrupt is in flight at a time;
@@ -107,10 +119,11 @@
  * Configurable parameters.
  *
  * MAXNUMMESSAGES: max number of shared-inval messages we can buffer.
- * Must be a power of 2 for speed.
+ * Must be a power of 2 for speed; check_invalidation_queue_size enforces it.
  *
  * MSGNUMWRAPAROUND: how often to reduce MsgNum variables to avoid overflow.
- * Must be a multiple of MAXNUMMESSAGES.  Should be large.
+ * Must be a multiple of MAXNUMMESSAGES.  Should be large.  Since
+ * MAXNUMMESSAGES is at most 2^20, 2^30 satisfies both requirements.
  *
  * CLEANUP_MIN: the minimum number of messages that must be in the buffer
  * before we bother to call SICleanupQueue.
@@ -127,8 +140,9 @@
  * per iteration.
  */
 
-#define MAXNUMMESSAGES 4096
-#define MSGNUMWRAPAROUND (MAXNUMMESSAGES * 262144)
+#define MAXNUMMESSAGES invalidation_queue_size
+#define MSGNUMWRAPAROUND (1 << 30)
+#define MSGNUMINDEX(n) ((n) & (MAXNUMMESSAGES - 1))
 #define CLEANUP_MIN (MAXNUMMESSAGES / 2)
 #define CLEANUP_QUANTUM (MAXNUMMESSAGES / 16)
 #define SIG_THRESHOLD (MAXNUMMESSAGES / 2)
@@ -143,7 +157,9 @@ typedef struct ProcState
 	int			nextMsgNum;		/* next message number to read */
 	bool		resetState;		/* backend needs to reset its state */
 	bool		signaled;		/* backend has been sent catchup signal */
-	bool		hasMessages;	/* backend has unread messages */
+	bool		hasMessages;	/* backend has unread relevant messages */
+	Oid			databaseId;		/* backend's database, or InvalidOid if
+								 * none (yet); see SharedInvalSetDatabase */
 
 	/*
 	 * Backend only sends invalidations, never receives them. This only makes
@@ -175,9 +191,10 @@ typedef struct SISeg
 	slock_t		msgnumLock;		/* spinlock protecting maxMsgNum */
 
 	/*
-	 * Circular buffer holding shared-inval messages
+	 * Circular buffer holding shared-inval messages; MAXNUMMESSAGES entries
+	 * allocated after the procState and pgprocnos arrays.
 	 */
-	SharedInvalidationMessage buffer[MAXNUMMESSAGES];
+	SharedInvalidationMessage *buffer;
 
 	/*
 	 * Per-backend invalidation state info.
@@ -205,6 +222,9 @@ typedef struct SISeg
 
 static SISeg *shmInvalBuffer;	/* pointer to the shared inval buffer */
 
+/* GUC variable */
+int			invalidation_queue_size = 4096;
+
 
 static LocalTransactionId nextLocalTransactionId;
 
@@ -222,6 +242,9 @@ SInvalShmemSize(void)
 	size = offsetof(SISeg, procState);
 	size = add_size(size, mul_size(sizeof(ProcState), NumProcStateSlots));	/* procState */
 	size = add_size(size, mul_size(sizeof(int), NumProcStateSlots));	/* pgprocnos */
+	size = MAXALIGN(size);
+	size = add_size(size, mul_size(sizeof(SharedInvalidationMessage),
+								   MAXNUMMESSAGES));	/* buffer */
 
 	return size;
 }
@@ -258,10 +281,13 @@ CreateSharedInvalidationState(void)
 		shmInvalBuffer->procState[i].resetState = false;
 		shmInvalBuffer->procState[i].signaled = false;
 		shmInvalBuffer->procState[i].hasMessages = false;
+		shmInvalBuffer->procState[i].databaseId = InvalidOid;
 		shmInvalBuffer->procState[i].nextLXID = InvalidLocalTransactionId;
 	}
 	shmInvalBuffer->numProcs = 0;
 	shmInvalBuffer->pgprocnos = (int *) &shmInvalBuffer->procState[i];
+	shmInvalBuffer->buffer = (SharedInvalidationMessage *)
+		MAXALIGN(&shmInvalBuffer->pgprocnos[NumProcStateSlots]);
 }
 
 /*
@@ -308,6 +334,7 @@ SharedInvalBackendInit(bool sendOnly)
 	stateP->resetState = false;
 	stateP->signaled = false;
 	stateP->hasMessages = false;
+	stateP->databaseId = InvalidOid;
 	stateP->sendOnly = sendOnly;
 
 	LWLockRelease(SInvalWriteLock);
@@ -316,6 +343,69 @@ SharedInvalBackendInit(bool sendOnly)
 	on_shmem_exit(CleanupInvalidationState, PointerGetDatum(segP));
 }
 
+/*
+ * SharedInvalSetDatabase
+ *		Record the database the current backend is connected to
+ *
+ * Until this is called, the backend is considered interested in every
+ * message.  Afterwards, messages that only concern other databases no longer
+ * set its hasMessages flag.  This must only be called once MyDatabaseId is
+ * set, since from then on inval.c ignores such messages anyway.
+ */
+void
+SharedInvalSetDatabase(Oid dbid)
+{
+	ProcState  *stateP = &shmInvalBuffer->procState[MyProcNumber];
+
+	/* writers read databaseId while holding the write lock */
+	LWLockAcquire(SInvalWriteLock, LW_EXCLUSIVE);
+	stateP->databaseId = dbid;
+	LWLockRelease(SInvalWriteLock);
+}
+
+/*
+ * SIMessageDatabase
+ *		Return the database a message concerns, or InvalidOid if it might
+ *		concern backends in any database.
+ *
+ * smgr messages are treated as concerning everyone, since any backend can
+ * have smgr handles open for relations of other databases.
+ */
+static inline Oid
+SIMessageDatabase(const SharedInvalidationMessage *msg)
+{
+	if (msg->id >= 0)
+		return msg->cc.dbId;
+
+	switch (msg->id)
+	{
+		case SHAREDINVALCATALOG_ID:
+			return msg->cat.dbId;
+		case SHAREDINVALRELCACHE_ID:
+			return msg->rc.dbId;
+		case SHAREDINVALRELMAP_ID:
+			return msg->rm.dbId;
+		case SHAREDINVALSNAPSHOT_ID:
+			return msg->sn.dbId;
+		default:
+			return InvalidOid;
+	}
+}
+
+/*
+ * check_hook for invalidation_queue_size
+ */
+bool
+check_invalidation_queue_size(int *newval, void **extra, GucSource source)
+{
+	if ((*newval & (*newval - 1)) != 0)
+	{
+		GUC_check_errdetail("\"invalidation_queue_size\" must be a power of two.");
+		return false;
+	}
+	return true;
+}
+
 /*
  * CleanupInvalidationState
  *		Mark the current backend as no longer active.
@@ -386,9 +476,29 @@ SIInsertDataEntries(const SharedInvalidationMessage *data, int n)
 		int			numMsgs;
 		int			max;
 		int			i;
+		Oid			batchdb;
+		bool		allrelevant = false;
 
 		n -= nthistime;
 
+		/*
+		 * Work out which backends need to look at this batch.  Typically all
+		 * the messages were generated by one transaction in one database; if
+		 * so only backends connected to that database need to be told.  If
+		 * there's any mix, or anything not tied to a database, tell everyone.
+		 */
+		batchdb = SIMessageDatabase(&data[0]);
+		for (i = 0; i < nthistime; i++)
+		{
+			Oid			msgdb = SIMessageDatabase(&data[i]);
+
+			if (!OidIsValid(msgdb) || msgdb != batchdb)
+			{
+				allrelevant = true;
+				break;
+			}
+		}
+
 		LWLockAcquire(SInvalWriteLock, LW_EXCLUSIVE);
 
 		/*
@@ -414,7 +524,7 @@ SIInsertDataEntries(const SharedInvalidationMessage *data, int n)
 		max = segP->maxMsgNum;
 		while (nthistime-- > 0)
 		{
-			segP->buffer[max % MAXNUMMESSAGES] = *data++;
+			segP->buffer[MSGNUMINDEX(max)] = *data++;
 			max++;
 		}
 
@@ -425,16 +535,18 @@ SIInsertDataEntries(const SharedInvalidationMessage *data, int n)
 
 		/*
 		 * Now that the maxMsgNum change is globally visible, we give everyone
-		 * a swift kick to make sure they read the newly added messages.
-		 * Releasing SInvalWriteLock will enforce a full memory barrier, so
-		 * these (unlocked) changes will be committed to memory before we exit
-		 * the function.
+		 * who might care a swift kick to make sure they read the newly added
+		 * messages.  Releasing SInvalWriteLock will enforce a full memory
+		 * barrier, so these (unlocked) changes will be committed to memory
+		 * before we exit the function.
 		 */
 		for (i = 0; i < segP->numProcs; i++)
 		{
 			ProcState  *stateP = &segP->procState[segP->pgprocnos[i]];
 
-			stateP->hasMessages = true;
+			if (allrelevant || !OidIsValid(stateP->databaseId) ||
+				stateP->databaseId == batchdb)
+				stateP->hasMessages = true;
 		}
 
 		LWLockRelease(SInvalWriteLock);
@@ -537,7 +649,7 @@ SIGetDataEntries(SharedInvalidationMessage *data, int datasize)
 	n = 0;
 	while (n < datasize && stateP->nextMsgNum < max)
 	{
-		data[n++] = segP->buffer[stateP->nextMsgNum % MAXNUMMESSAGES];
+		data[n++] = segP->buffer[MSGNUMINDEX(stateP->nextMsgNum)];
 		stateP->nextMsgNum++;
 	}
 
@@ -610,6 +722,17 @@ SICleanupQueue(bool callerHasWriteLock, int minFree)
 		if (stateP->resetState || stateP->sendOnly)
 			continue;
 
+		/*
+		 * If none of the backend's unread messages concern it, it can be
+		 * considered caught up.  Clear "signaled" too, since it won't go
+		 * through SIGetDataEntries to do that itself.
+		 */
+		if (!stateP->hasMessages && n < segP->maxMsgNum)
+		{
+			n = stateP->nextMsgNum = segP->maxMsgNum;
+			stateP->signaled = false;
+		}
+
 		/*
 		 * If we must free some space and this backend is preventing it, force
 		 * him into reset state and then ignore until he catches up.
@@ -169,6 +169,7 @@ static const char *const BuiltinTrancheNames[] = {
 	[LWTRANCHE_SUBTRANS_SLRU] = "SubtransSLRU",
 	[LWTRANCHE_XACT_SLRU] = "XactSLRU",
 	[LWTRANCHE_PARALLEL_VACUUM_DSA] = "ParallelVacuumDSA",
+	[LWTRANCHE_RELATION_SIZE] = "RelationSize",
 };
 
 StaticAssertDecl(lengthof(BuiltinTrancheNames) ==
@@ -191,12 +192,10 @@ static int	LWLockTrancheNamesAllocated = 0;
 LWLockPadded *MainLWLockArray = NULL;
 
 /*
- * We use this structure to keep track of locked LWLocks for release
- * during error recovery.  Normally, only a few will be held at once, but
- * occasionally the number can be much higher; for example, the pg_buffercache
- * extension locks all buffer partitions simultaneously.
+ * Number of times a waiter in LWLockAcquire polls for its wakeup before
+ * sleeping on its semaphore.  See LWLockSpinBeforeSleep().
  */
-#define MAX_SIMUL_LWLOCKS	200
+#define LWLOCK_SPINS_BEFORE_SLEEP	64
 
 /* struct representing the LWLocks we're holding */
 typedef struct LWLockHandle
@@ -205,6 +204,12 @@ typedef struct LWLockHandle
 	LWLockMode	mode;
 } LWLockHandle;
 
+/*
+ * We use this structure to keep track of locked LWLocks for release
+ * during error recovery.  Normally, only a few will be held at once, but
+ * occasionally the number can be much higher; for example, the pg_buffercache
+ * extension locks all buffer partitions simultaneously.
+ */
 static int	num_held_lwlocks = 0;
 static LWLockHandle held_lwlocks[MAX_SIMUL_LWLOCKS];
 
@@ -1158,6 +1163,37 @@ LWLockDequeueSelf(LWLock *lock)
 #endif
 }
 
+/*
+ * Spin briefly, waiting for LWLockWakeup to clear our lwWaiting flag.
+ *
+ * Contended LWLocks are often held only for a short while, so a waiter is
+ * likely to be woken soon after it has queued itself.  Going to sleep on the
+ * semaphore right away then means a trip through the kernel's scheduler on
+ * both sides, which costs far more than the wait itself.  Polling for a
+ * little while first lets us notice the wakeup while still on the CPU;
+ * the semaphore has then already been, or is about to be, unlocked, so the
+ * caller's PGSemaphoreLock() returns without sleeping.
+ *
+ * Nothing depends on whether we saw the wakeup here: the caller still
+ * consumes the semaphore and rechecks lwWaiting as before.
+ */
+static inline void
+LWLockSpinBeforeSleep(PGPROC *proc)
+{
+	volatile PGPROC *vproc = proc;
+
+	for (int i = 0; i < LWLOCK_SPINS_BEFORE_SLEEP; i++)
+	{
+		if (vproc->lwWaiting == LW_WS_NOT_WAITING)
+		{
+			/* pairs with the write barrier in LWLockWakeup */
+			pg_read_barrier();
+			break;
+		}
+		pg_spin_delay();
+	}
+}
+
 /*
  * LWLockAcquire - acquire a lightweight lock in the specified mode
  *
@@ -1284,6 +1320,8 @@ LWLockAcquire(LWLock *lock, LWLockMode mode)
 		if (TRACE_POSTGRESQL_LWLOCK_WAIT_START_ENABLED())
 			TRACE_POSTGRESQL_LWLOCK_WAIT_START(T_NAME(lock), mode);
 
+		LWLockSpinBeforeSleep(proc);
+
 		for (;;)
 		{
 			PGSemaphoreLock(proc->sem);
@@ -4155,6 +4155,7 @@ CheckTargetForConflictsIn(PREDICATELOCKTARGETTAG *targettag)
 	PREDICATELOCKTARGET *target;
 	PREDICATELOCK *mypredlock = NULL;
 	PREDICATELOCKTAG mypredlocktag;
+	bool		havexactlock = false;
 	dlist_mutable_iter iter;
 
 	Assert(MySerializableXact != InvalidSerializableXact);
@@ -4179,15 +4180,25 @@ CheckTargetForConflictsIn(PREDICATELOCKTARGETTAG *targettag)
 	/*
 	 * Each lock for an overlapping transaction represents a conflict: a
 	 * rw-dependency in to this transaction.
+	 *
+	 * The lock list itself is protected by the partition lock; we only need
+	 * SerializableXactHashLock to examine other transactions' state.  So
+	 * take it only once we meet a lock that isn't ours.  In the common case
+	 * of a transaction updating rows it has just read, we then never touch
+	 * that globally contended lock.
 	 */
-	LWLockAcquire(SerializableXactHashLock, LW_SHARED);
-
 	dlist_foreach_modify(iter, &target->predicateLocks)
 	{
 		PREDICATELOCK *predlock =
 			dlist_container(PREDICATELOCK, targetLink, iter.cur);
 		SERIALIZABLEXACT *sxact = predlock->tag.myXact;
 
+		if (sxact != MySerializableXact && !havexactlock)
+		{
+			LWLockAcquire(SerializableXactHashLock, LW_SHARED);
+			havexactlock = true;
+		}
+
 		if (sxact == MySerializableXact)
 		{
 			/*
@@ -4233,7 +4244,8 @@ CheckTargetForConflictsIn(PREDICATELOCKTARGETTAG *targettag)
 			LWLockAcquire(SerializableXactHashLock, LW_SHARED);
 		}
 	}
-	LWLockRelease(SerializableXactHashLock);
+	if (havexactlock)
+		LWLockRelease(SerializableXactHashLock);
 	LWLockRelease(partitionLock);
 
 	/*
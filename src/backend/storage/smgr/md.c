@@ -31,6 +31,7 @@
 #include "miscadmin.h"
 #include "pg_trace.h"
 #include "pgstat.h"
+#include "storage/aio.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
 #include "storage/md.h"
@@ -816,6 +817,7 @@ mdreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		int			iovcnt;
 		off_t		seekpos;
 		int			nbytes;
+		PgAioHandle ioh;
 		MdfdVec    *v;
 		BlockNumber nblocks_this_segment;
 		size_t		transferred_this_segment;
@@ -849,8 +851,10 @@ mdreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 												reln->smgr_rlocator.locator.dbOid,
 												reln->smgr_rlocator.locator.relNumber,
 												reln->smgr_rlocator.backend);
-			nbytes = FileReadV(v->mdfd_vfd, iov, iovcnt, seekpos,
-							   WAIT_EVENT_DATA_FILE_READ);
+			pgaio_io_prep_readv(&ioh, v->mdfd_vfd, iov, iovcnt, seekpos,
+								WAIT_EVENT_DATA_FILE_READ);
+			pgaio_io_submit(&ioh);
+			nbytes = pgaio_io_wait(&ioh);
 			TRACE_POSTGRESQL_SMGR_MD_READ_DONE(forknum, blocknum,
 											   reln->smgr_rlocator.locator.spcOid,
 											   reln->smgr_rlocator.locator.dbOid,
@@ -939,6 +943,7 @@ mdwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		int			iovcnt;
 		off_t		seekpos;
 		int			nbytes;
+		PgAioHandle ioh;
 		MdfdVec    *v;
 		BlockNumber nblocks_this_segment;
 		size_t		transferred_this_segment;
@@ -972,8 +977,10 @@ mdwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 												 reln->smgr_rlocator.locator.dbOid,
 												 reln->smgr_rlocator.locator.relNumber,
 												 reln->smgr_rlocator.backend);
-			nbytes = FileWriteV(v->mdfd_vfd, iov, iovcnt, seekpos,
-								WAIT_EVENT_DATA_FILE_WRITE);
+			pgaio_io_prep_writev(&ioh, v->mdfd_vfd, iov, iovcnt, seekpos,
+								 WAIT_EVENT_DATA_FILE_WRITE);
+			pgaio_io_submit(&ioh);
+			nbytes = pgaio_io_wait(&ioh);
 			TRACE_POSTGRESQL_SMGR_MD_WRITE_DONE(forknum, blocknum,
 												reln->smgr_rlocator.locator.spcOid,
 												reln->smgr_rlocator.locator.dbOid,
@@ -1276,6 +1283,24 @@ mdregistersync(SMgrRelation reln, ForkNumber forknum)
 	}
 }
 
+/*
+ * mdsyncpending() -- Perform now the pending fsyncs of a relation fork.
+ *
+ * Only the segments we have open are considered.  Callers use this after
+ * writing to the fork, which opens all segments up to the one written.
+ */
+void
+mdsyncpending(SMgrRelation reln, ForkNumber forknum)
+{
+	for (int segno = 0; segno < reln->md_num_open_segs[forknum]; segno++)
+	{
+		FileTag		tag;
+
+		INIT_MD_FILETAG(tag, reln->smgr_rlocator.locator, forknum, segno);
+		SyncFileEarly(&tag);
+	}
+}
+
 /*
  * mdimmedsync() -- Immediately sync a relation to stable storage.
  *
@@ -40,6 +40,12 @@
  * themselves, as there could pointers to them in active use.  See
  * smgrrelease() and smgrreleaseall().
  *
+ * Outside recovery, the size of a relation fork can change under us at any
+ * time, so smgr_cached_nblocks can't be trusted there.  Instead there is a
+ * shared hash table of relation fork sizes, which every backend keeps up to
+ * date as it extends, truncates and unlinks relations.  See
+ * smgrnblocks_shared().
+ *
  * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
  *
@@ -51,11 +57,14 @@
  */
 #include "postgres.h"
 
+#include "access/xlog.h"
 #include "access/xlogutils.h"
 #include "lib/ilist.h"
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
+#include "storage/lwlock.h"
 #include "storage/md.h"
+#include "storage/shmem.h"
 #include "storage/smgr.h"
 #include "utils/hsearch.h"
 #include "utils/inval.h"
@@ -102,6 +111,7 @@ typedef struct f_smgr
 								  BlockNumber nblocks);
 	void		(*smgr_immedsync) (SMgrRelation reln, ForkNumber forknum);
 	void		(*smgr_registersync) (SMgrRelation reln, ForkNumber forknum);
+	void		(*smgr_syncpending) (SMgrRelation reln, ForkNumber forknum);
 } f_smgr;
 
 static const f_smgr smgrsw[] = {
@@ -124,6 +134,7 @@ static const f_smgr smgrsw[] = {
 		.smgr_truncate = mdtruncate,
 		.smgr_immedsync = mdimmedsync,
 		.smgr_registersync = mdregistersync,
+		.smgr_syncpending = mdsyncpending,
 	}
 };
 
@@ -137,9 +148,54 @@ static HTAB *SMgrRelationHash = NULL;
 
 static dlist_head unpinned_relns;
 
+/*
+ * Shared relation size cache.
+ *
+ * Entries are created by smgrnblocks() when it has to ask the storage
+ * manager for the size of a fork, and removed when the fork is created,
+ * truncated or unlinked.  Temporary relations are never entered, since only
+ * their own backend can access them.  Nothing is entered during recovery
+ * either; the startup process has the local smgr_cached_nblocks for that,
+ * and the table starts out empty after promotion.
+ *
+ * The table has a fixed size, set by relation_size_cache_entries.  When it
+ * is full, sizes of forks without an entry are just not cached until
+ * entries are removed again.  Evicting entries instead would need a way to
+ * pick victims across partitions, which isn't worth it: the default size
+ * covers the forks of far more relations than are typically in active use,
+ * and the server can be configured with a bigger table if that's not so.
+ */
+typedef struct SMgrSizeTag
+{
+	RelFileLocator locator;
+	ForkNumber	forknum;
+} SMgrSizeTag;
+
+typedef struct SMgrSizeEnt
+{
+	SMgrSizeTag tag;			/* hash key, must be first */
+	BlockNumber nblocks;		/* current size of the fork */
+} SMgrSizeEnt;
+
+#define NUM_SMGR_SIZE_PARTITIONS  16
+
+#define SMgrSizePartitionLock(hashcode) \
+	(&SMgrSizeLocks[(hashcode) % NUM_SMGR_SIZE_PARTITIONS].lock)
+
+static HTAB *SMgrSizeHash = NULL;
+static LWLockPadded *SMgrSizeLocks = NULL;
+
+/* GUC variable; 0 means size the table based on shared_buffers */
+int			relation_size_cache_entries = 0;
+
 /* local function prototypes */
 static void smgrshutdown(int code, Datum arg);
 static void smgrdestroy(SMgrRelation reln);
+static BlockNumber smgrnblocks_shared(SMgrRelation reln, ForkNumber forknum);
+static void smgr_size_extended(SMgrRelation reln, ForkNumber forknum,
+							   BlockNumber nblocks);
+static void smgr_size_forget(RelFileLocatorBackend rlocator,
+							 ForkNumber forknum);
 
 
 /*
@@ -165,6 +221,65 @@ smgrinit(void)
 	on_proc_exit(smgrshutdown, 0);
 }
 
+/*
+ * Number of entries in the shared relation size cache.  By default, a
+ * quarter of the number of buffers, which leaves room for the forks of many
+ * more relations than can have a useful number of pages cached at the same
+ * time.
+ */
+static int
+SMgrSizeCacheEntries(void)
+{
+	if (relation_size_cache_entries > 0)
+		return relation_size_cache_entries;
+	return Max(NBuffers / 4, 1024);
+}
+
+/*
+ * SMgrShmemSize -- report amount of shared memory needed by smgr.c
+ */
+Size
+SMgrShmemSize(void)
+{
+	Size		size;
+
+	size = mul_size(NUM_SMGR_SIZE_PARTITIONS, sizeof(LWLockPadded));
+	size = add_size(size, hash_estimate_size(SMgrSizeCacheEntries(),
+											 sizeof(SMgrSizeEnt)));
+	return size;
+}
+
+/*
+ * SMgrShmemInit -- initialize the shared relation size cache
+ */
+void
+SMgrShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+	int			nentries = SMgrSizeCacheEntries();
+
+	SMgrSizeLocks = (LWLockPadded *)
+		ShmemInitStruct("Relation Size Cache Locks",
+						mul_size(NUM_SMGR_SIZE_PARTITIONS, sizeof(LWLockPadded)),
+						&found);
+	if (!found)
+	{
+		for (int i = 0; i < NUM_SMGR_SIZE_PARTITIONS; i++)
+			LWLockInitialize(&SMgrSizeLocks[i].lock, LWTRANCHE_RELATION_SIZE);
+	}
+
+	info.keysize = sizeof(SMgrSizeTag);
+	info.entrysize = sizeof(SMgrSizeEnt);
+	info.num_partitions = NUM_SMGR_SIZE_PARTITIONS;
+
+	SMgrSizeHash = ShmemInitHash("Relation Size Cache",
+								 nentries, nentries,
+								 &info,
+								 HASH_ELEM | HASH_BLOBS | HASH_PARTITION |
+								 HASH_FIXED_SIZE);
+}
+
 /*
  * on_proc_exit hook for smgr cleanup during backend shutdown
  */
@@ -411,6 +526,9 @@ void
 smgrcreate(SMgrRelation reln, ForkNumber forknum, bool isRedo)
 {
 	smgrsw[reln->smgr_which].smgr_create(reln, forknum, isRedo);
+
+	/* Don't let a left-over entry describe the new fork */
+	smgr_size_forget(reln->smgr_rlocator, forknum);
 }
 
 /*
@@ -515,7 +633,10 @@ smgrdounlinkall(SMgrRelation *rels, int nrels, bool isRedo)
 		int			which = rels[i]->smgr_which;
 
 		for (forknum = 0; forknum <= MAX_FORKNUM; forknum++)
+		{
 			smgrsw[which].smgr_unlink(rlocators[i], forknum, isRedo);
+			smgr_size_forget(rlocators[i], forknum);
+		}
 	}
 
 	pfree(rlocators);
@@ -547,6 +668,8 @@ smgrextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		reln->smgr_cached_nblocks[forknum] = blocknum + 1;
 	else
 		reln->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+
+	smgr_size_extended(reln, forknum, blocknum + 1);
 }
 
 /*
@@ -572,6 +695,8 @@ smgrzeroextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		reln->smgr_cached_nblocks[forknum] = blocknum + nblocks;
 	else
 		reln->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+
+	smgr_size_extended(reln, forknum, blocknum + nblocks);
 }
 
 /*
@@ -661,13 +786,161 @@ smgrnblocks(SMgrRelation reln, ForkNumber forknum)
 	if (result != InvalidBlockNumber)
 		return result;
 
-	result = smgrsw[reln->smgr_which].smgr_nblocks(reln, forknum);
+	if (!RelFileLocatorBackendIsTemp(reln->smgr_rlocator) &&
+		!RecoveryInProgress())
+		result = smgrnblocks_shared(reln, forknum);
+	else
+		result = smgrsw[reln->smgr_which].smgr_nblocks(reln, forknum);
 
 	reln->smgr_cached_nblocks[forknum] = result;
 
 	return result;
 }
 
+/*
+ * smgrnblocks_shared() -- Get the number of blocks in the supplied relation
+ *						   via the shared relation size cache.
+ *
+ * On a miss, we ask the storage manager while holding the partition lock
+ * exclusively.  A backend that extends the relation concurrently updates the
+ * entry under the same lock after its extension is done, so whichever order
+ * the two happen in, the entry can't end up smaller than the file.
+ * Truncation needs no such care, since the caller of smgrtruncate() holds
+ * AccessExclusiveLock and nobody can be looking up the size meanwhile.
+ */
+static BlockNumber
+smgrnblocks_shared(SMgrRelation reln, ForkNumber forknum)
+{
+	SMgrSizeTag tag;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+	SMgrSizeEnt *entry;
+	BlockNumber result;
+
+	tag.locator = reln->smgr_rlocator.locator;
+	tag.forknum = forknum;
+	hashcode = get_hash_value(SMgrSizeHash, &tag);
+	partitionLock = SMgrSizePartitionLock(hashcode);
+
+	LWLockAcquire(partitionLock, LW_SHARED);
+	entry = (SMgrSizeEnt *)
+		hash_search_with_hash_value(SMgrSizeHash, &tag, hashcode,
+									HASH_FIND, NULL);
+	if (entry)
+	{
+		result = entry->nblocks;
+		LWLockRelease(partitionLock);
+		return result;
+	}
+	LWLockRelease(partitionLock);
+
+	LWLockAcquire(partitionLock, LW_EXCLUSIVE);
+	entry = (SMgrSizeEnt *)
+		hash_search_with_hash_value(SMgrSizeHash, &tag, hashcode,
+									HASH_FIND, NULL);
+	if (entry)
+		result = entry->nblocks;
+	else
+	{
+		result = smgrsw[reln->smgr_which].smgr_nblocks(reln, forknum);
+
+		entry = (SMgrSizeEnt *)
+			hash_search_with_hash_value(SMgrSizeHash, &tag, hashcode,
+										HASH_ENTER_NULL, NULL);
+		if (entry)
+			entry->nblocks = result;
+	}
+	LWLockRelease(partitionLock);
+
+	return result;
+}
+
+/*
+ * smgr_size_extended() -- Tell the shared relation size cache that a fork
+ *						   now has (at least) nblocks blocks.
+ *
+ * Only an existing entry is updated.
+ */
+static void
+smgr_size_extended(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks)
+{
+	SMgrSizeTag tag;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+	SMgrSizeEnt *entry;
+
+	/* Nothing is cached for temp relations or during recovery */
+	if (RelFileLocatorBackendIsTemp(reln->smgr_rlocator) ||
+		RecoveryInProgress())
+		return;
+
+	tag.locator = reln->smgr_rlocator.locator;
+	tag.forknum = forknum;
+	hashcode = get_hash_value(SMgrSizeHash, &tag);
+	partitionLock = SMgrSizePartitionLock(hashcode);
+
+	LWLockAcquire(partitionLock, LW_EXCLUSIVE);
+	entry = (SMgrSizeEnt *)
+		hash_search_with_hash_value(SMgrSizeHash, &tag, hashcode,
+									HASH_FIND, NULL);
+	if (entry && entry->nblocks < nblocks)
+		entry->nblocks = nblocks;
+	LWLockRelease(partitionLock);
+}
+
+/*
+ * smgr_size_forget() -- Remove a fork from the shared relation size cache.
+ */
+static void
+smgr_size_forget(RelFileLocatorBackend rlocator, ForkNumber forknum)
+{
+	SMgrSizeTag tag;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+
+	if (RelFileLocatorBackendIsTemp(rlocator))
+		return;
+
+	tag.locator = rlocator.locator;
+	tag.forknum = forknum;
+	hashcode = get_hash_value(SMgrSizeHash, &tag);
+	partitionLock = SMgrSizePartitionLock(hashcode);
+
+	LWLockAcquire(partitionLock, LW_EXCLUSIVE);
+	(void) hash_search_with_hash_value(SMgrSizeHash, &tag, hashcode,
+									   HASH_REMOVE, NULL);
+	LWLockRelease(partitionLock);
+}
+
+/*
+ * smgrforgetdatabase() -- Remove all relations of a database from the shared
+ *						   relation size cache.
+ *
+ * This must be called whenever the files of a database are removed other
+ * than through smgrdounlinkall(), such as by DROP DATABASE, so that the
+ * entries can't be mistaken for relations of a later database that reuses
+ * the OID.
+ */
+void
+smgrforgetdatabase(Oid dbid)
+{
+	HASH_SEQ_STATUS status;
+	SMgrSizeEnt *entry;
+
+	for (int i = 0; i < NUM_SMGR_SIZE_PARTITIONS; i++)
+		LWLockAcquire(&SMgrSizeLocks[i].lock, LW_EXCLUSIVE);
+
+	hash_seq_init(&status, SMgrSizeHash);
+	while ((entry = (SMgrSizeEnt *) hash_seq_search(&status)) != NULL)
+	{
+		if (entry->tag.locator.dbOid == dbid)
+			(void) hash_search(SMgrSizeHash, &entry->tag, HASH_REMOVE, NULL);
+	}
+
+	for (int i = NUM_SMGR_SIZE_PARTITIONS; --i >= 0;)
+		LWLockRelease(&SMgrSizeLocks[i].lock);
+}
+
 /*
  * smgrnblocks_cached() -- Get the cached number of blocks in the supplied
  *						   relation.
@@ -682,6 +955,7 @@ smgrnblocks_cached(SMgrRelation reln, ForkNumber forknum)
 	 * For now, this function uses cached values only in recovery due to lack
 	 * of a shared invalidation mechanism for changes in file size.  Code
 	 * elsewhere reads smgr_cached_nblocks and copes with stale data.
+	 * Outside recovery, smgrnblocks() uses the shared relation size cache.
 	 */
 	if (InRecovery && reln->smgr_cached_nblocks[forknum] != InvalidBlockNumber)
 		return reln->smgr_cached_nblocks[forknum];
@@ -738,6 +1012,8 @@ smgrtruncate(SMgrRelation reln, ForkNumber *forknum, int nforks, BlockNumber *nb
 		 * But these ensure they aren't outright wrong until then.
 		 */
 		reln->smgr_cached_nblocks[forknum[i]] = nblocks[i];
+
+		smgr_size_forget(reln->smgr_rlocator, forknum[i]);
 	}
 }
 
@@ -759,6 +1035,21 @@ smgrregistersync(SMgrRelation reln, ForkNumber forknum)
 	smgrsw[reln->smgr_which].smgr_registersync(reln, forknum);
 }
 
+/*
+ * smgrsyncpending() -- Perform now the fsyncs already requested for a
+ *						relation fork
+ *
+ * This is for the checkpointer, which uses it during BufferSync() once it
+ * has written all of a fork's buffers, to spread the checkpoint's fsyncs
+ * out instead of leaving them all for ProcessSyncRequests().  In other
+ * processes, it does nothing.
+ */
+void
+smgrsyncpending(SMgrRelation reln, ForkNumber forknum)
+{
+	smgrsw[reln->smgr_which].smgr_syncpending(reln, forknum);
+}
+
 /*
  * smgrimmedsync() -- Force the specified relation to stable storage.
  *
@@ -193,6 +193,63 @@ SyncPreCheckpoint(void)
 	checkpoint_cycle_ctr++;
 }
 
+/*
+ * SyncFileEarly() -- fsync one file ahead of ProcessSyncRequests()
+ *
+ * BufferSync() calls this, through smgr, for each file it is done writing to
+ * for the current checkpoint.  If the file has a pending fsync request, we
+ * perform it right away and forget the request, so that the checkpoint's
+ * fsyncs are spread over its write phase instead of all hitting the disk
+ * at the end.  Anything written to the file after this point enters a new
+ * request, which ProcessSyncRequests() handles as usual; and anything
+ * written before a request arrives still in the queue is covered by our
+ * fsync, so handling that request again later is merely redundant.
+ *
+ * If the file seems to have been deleted, we leave the request alone, for
+ * ProcessSyncRequests() to check for a cancel.
+ */
+void
+SyncFileEarly(const FileTag *ftag)
+{
+	PendingFsyncEntry *entry;
+	char		path[MAXPGPATH];
+	instr_time	sync_start,
+				sync_end;
+	uint64		elapsed;
+
+	if (!pendingOps || !enableFsync)
+		return;
+
+	entry = (PendingFsyncEntry *) hash_search(pendingOps, ftag, HASH_FIND, NULL);
+	if (entry == NULL || entry->canceled)
+		return;
+
+	INSTR_TIME_SET_CURRENT(sync_start);
+	if (syncsw[ftag->handler].sync_syncfiletag(ftag, path) != 0)
+	{
+		if (!FILE_POSSIBLY_DELETED(errno))
+			ereport(data_sync_elevel(ERROR),
+					(errcode_for_file_access(),
+					 errmsg("could not fsync file \"%s\": %m", path)));
+		return;
+	}
+	INSTR_TIME_SET_CURRENT(sync_end);
+	INSTR_TIME_SUBTRACT(sync_end, sync_start);
+	elapsed = INSTR_TIME_GET_MICROSEC(sync_end);
+
+	CheckpointStats.ckpt_sync_rels++;
+	CheckpointStats.ckpt_longest_sync = Max(CheckpointStats.ckpt_longest_sync,
+											elapsed);
+	CheckpointStats.ckpt_agg_sync_time += elapsed;
+
+	if (log_checkpoints)
+		elog(DEBUG1, "checkpoint early sync: file=%s time=%.3f ms",
+			 path, (double) elapsed / 1000);
+
+	if (hash_search(pendingOps, ftag, HASH_REMOVE, NULL) == NULL)
+		elog(ERROR, "pendingOps corrupted");
+}
+
 /*
  * SyncPostCheckpoint() -- Do post-checkpoint work
  *
@@ -465,10 +522,14 @@ ProcessSyncRequests(void)
 			elog(ERROR, "pendingOps corrupted");
 	}							/* end loop over hashtable entries */
 
-	/* Return sync performance metrics for report at checkpoint end */
-	CheckpointStats.ckpt_sync_rels = processed;
-	CheckpointStats.ckpt_longest_sync = longest;
-	CheckpointStats.ckpt_agg_sync_time = total_elapsed;
+	/*
+	 * Return sync performance metrics for report at checkpoint end.  These
+	 * add to the numbers for any files SyncFileEarly() already synced.
+	 */
+	CheckpointStats.ckpt_sync_rels += processed;
+	CheckpointStats.ckpt_longest_sync = Max(CheckpointStats.ckpt_longest_sync,
+											longest);
+	CheckpointStats.ckpt_agg_sync_time += total_elapsed;
 
 	/* Flag successful completion of ProcessSyncRequests */
 	sync_in_progress = false;
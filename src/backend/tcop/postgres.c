@@ -37,6 +37,7 @@
 #include "catalog/pg_type.h"
 #include "commands/async.h"
 #include "commands/event_trigger.h"
+#include "commands/explain.h"
 #include "commands/prepare.h"
 #include "common/pg_prng.h"
 #include "jit/jit.h"
@@ -157,6 +158,15 @@ static bool ignore_till_sync = false;
  */
 static CachedPlanSource *unnamed_stmt_psrc = NULL;
 
+/*
+ * The parameter types the client sent when it created the unnamed statement
+ * (parse analysis may have filled in unspecified ones since), so that a
+ * repeated Parse of the same statement can be recognized.  The array lives
+ * in the CachedPlanSource's context.
+ */
+static Oid *unnamed_stmt_paramtypes = NULL;
+static int	unnamed_stmt_nparams = 0;
+
 /* assorted command-line switches */
 static const char *userDoption = NULL;	/* -D switch */
 static bool EchoQuery = false;	/* -E switch */
@@ -190,6 +200,8 @@ static bool IsTransactionExitStmt(Node *parsetree);
 static bool IsTransactionExitStmtList(List *pstmts);
 static bool IsTransactionStmtList(List *pstmts);
 static void drop_unnamed_stmt(void);
+static bool unnamed_stmt_matches(const char *query_string, Oid *paramTypes,
+								 int numParams);
 static void log_disconnections(int code, Datum arg);
 static void enable_statement_timeout(void);
 static void disable_statement_timeout(void);
@@ -1400,6 +1412,8 @@ exec_parse_message(const char *query_string,	/* string to execute */
 	List	   *querytree_list;
 	CachedPlanSource *psrc;
 	bool		is_named;
+	Oid		   *clientParamTypes = NULL;
+	int			clientNumParams = numParams;
 	bool		save_log_statement_stats = log_statement_stats;
 	char		msec_str[32];
 
@@ -1442,6 +1456,26 @@ exec_parse_message(const char *query_string,	/* string to execute */
 	 * query_context here, and do all the parsing work therein.
 	 */
 	is_named = (stmt_name[0] != '\0');
+
+	/*
+	 * Clients that don't use named statements typically send the same few
+	 * statements as unnamed ones over and over.  If the unnamed statement
+	 * we already have was made from the same query text and parameter types
+	 * under the same search_path and role and is still valid, just keep it,
+	 * saving parse analysis and rewriting (and planning, if it has a generic
+	 * plan).  Its custom-plan history is reset, so that plan choice works as
+	 * for a brand new statement.  Bind will revalidate it as usual.  In an
+	 * aborted transaction we take the normal path, which gives the usual
+	 * error for anything but COMMIT/ROLLBACK.
+	 */
+	if (!is_named &&
+		!IsAbortedTransactionBlockState() &&
+		unnamed_stmt_matches(query_string, paramTypes, numParams))
+	{
+		CachedPlanResetPlanChoice(unnamed_stmt_psrc);
+		goto parse_complete;
+	}
+
 	if (is_named)
 	{
 		/* Named prepared statement --- parse in MessageContext */
@@ -1449,6 +1483,17 @@ exec_parse_message(const char *query_string,	/* string to execute */
 	}
 	else
 	{
+		/*
+		 * Remember the parameter types as sent, since parse analysis may
+		 * scribble on the array.
+		 */
+		if (numParams > 0)
+		{
+			clientParamTypes = (Oid *)
+				MemoryContextAlloc(MessageContext, numParams * sizeof(Oid));
+			memcpy(clientParamTypes, paramTypes, numParams * sizeof(Oid));
+		}
+
 		/* Unnamed prepared statement --- release any prior unnamed stmt */
 		drop_unnamed_stmt();
 		/* Create context for parsing */
@@ -1574,10 +1619,22 @@ exec_parse_message(const char *query_string,	/* string to execute */
 		 */
 		SaveCachedPlan(psrc);
 		unnamed_stmt_psrc = psrc;
+
+		if (clientNumParams > 0)
+		{
+			unnamed_stmt_paramtypes = (Oid *)
+				MemoryContextAlloc(psrc->context,
+								   clientNumParams * sizeof(Oid));
+			memcpy(unnamed_stmt_paramtypes, clientParamTypes,
+				   clientNumParams * sizeof(Oid));
+		}
+		unnamed_stmt_nparams = clientNumParams;
 	}
 
 	MemoryContextSwitchTo(oldcontext);
 
+parse_complete:
+
 	/*
 	 * We do NOT close the open transaction command here; that only happens
 	 * when the client sends Sync.  Instead, do CommandCounterIncrement just
@@ -2855,10 +2912,35 @@ drop_unnamed_stmt(void)
 		CachedPlanSource *psrc = unnamed_stmt_psrc;
 
 		unnamed_stmt_psrc = NULL;
+		unnamed_stmt_paramtypes = NULL;
+		unnamed_stmt_nparams = 0;
 		DropCachedPlan(psrc);
 	}
 }
 
+/*
+ * Does the current unnamed statement, if any, match a Parse message with the
+ * given query text and parameter types, and is it still valid?  It must also
+ * have been analyzed under the current search_path and role, since the same
+ * text could now refer to different objects.
+ */
+static bool
+unnamed_stmt_matches(const char *query_string, Oid *paramTypes, int numParams)
+{
+	CachedPlanSource *psrc = unnamed_stmt_psrc;
+
+	if (psrc == NULL || !CachedPlanIsValid(psrc) ||
+		!CachedPlanMatchesEnvironment(psrc))
+		return false;
+	if (numParams != unnamed_stmt_nparams)
+		return false;
+	if (numParams > 0 &&
+		memcmp(paramTypes, unnamed_stmt_paramtypes,
+			   numParams * sizeof(Oid)) != 0)
+		return false;
+	return strcmp(query_string, psrc->query_string) == 0;
+}
+
 
 /* --------------------------------
  *		signal handler routines used in PostgresMain()
@@ -3468,6 +3550,9 @@ ProcessInterrupts(void)
 	if (LogMemoryContextPending)
 		ProcessLogMemoryContextInterrupt();
 
+	if (LogQueryPlanPending)
+		ProcessLogQueryPlanInterrupt();
+
 	if (ParallelApplyMessagePending)
 		HandleParallelApplyMessages();
 }
@@ -4094,8 +4179,9 @@ PostgresSingleUserMain(int argc, char *argv[],
 	 */
 	process_shared_preload_libraries();
 
-	/* Initialize MaxBackends */
+	/* Initialize MaxBackends and the number of fast-path lock groups */
 	InitializeMaxBackends();
+	InitializeFastPathLocks();
 
 	/*
 	 * Give preloaded libraries a chance to request additional shared memory.
@@ -4563,7 +4649,9 @@ PostgresMain(const char *dbname, const char *username)
 				 * timeout below. enable_timeout_after() needs to determine
 				 * the current timestamp, which can have a negative
 				 * performance impact. That's OK because pgstat_report_stat()
-				 * won't have us wake up sooner than a prior call.
+				 * won't have us wake up sooner than a prior call, except for
+				 * a pgstat_report_stat_hook asking for a shorter timeout,
+				 * which then just gets to flush a bit late.
 				 */
 				stats_timeout = pgstat_report_stat(false);
 				if (stats_timeout > 0)
@@ -167,6 +167,8 @@ static void pgstat_read_statsfile(void);
 
 static void pgstat_reset_after_failure(void);
 
+static long pgstat_flush_pending_stats(bool force);
+
 static bool pgstat_flush_pending_entries(bool nowait);
 
 static void pgstat_prep_snapshot(void);
@@ -193,6 +195,14 @@ int			pgstat_fetch_consistency = PGSTAT_FETCH_CONSISTENCY_CACHE;
 PgStat_LocalState pgStatLocal;
 
 
+/* ----------
+ * Hook for plugins to flush their own pending statistics
+ * ----------
+ */
+
+pgstat_report_stat_hook_type pgstat_report_stat_hook = NULL;
+
+
 /* ----------
  * Local data
  *
@@ -572,17 +582,18 @@ pgstat_initialize(void)
  * a timeout after which to call pgstat_report_stat(true), but are not
  * required to do so.
  *
+ * pgstat_report_stat_hook, if set, is called with the same 'force' argument
+ * so that loadable modules can flush statistics they accumulate themselves.
+ * It returns the time after which it wants to be called again, or 0 if it
+ * has nothing pending; the shorter of that and our own timeout is returned.
+ *
  * Note that this is called only when not within a transaction, so it is fair
  * to use transaction stop time as an approximation of current time.
  */
 long
 pgstat_report_stat(bool force)
 {
-	static TimestampTz pending_since = 0;
-	static TimestampTz last_flush = 0;
-	bool		partial_flush;
-	TimestampTz now;
-	bool		nowait;
+	long		timeout;
 
 	pgstat_assert_is_up();
 	Assert(!IsTransactionOrTransactionBlock());
@@ -594,6 +605,31 @@ pgstat_report_stat(bool force)
 		pgStatForceNextFlush = false;
 	}
 
+	timeout = pgstat_flush_pending_stats(force);
+
+	if (pgstat_report_stat_hook)
+	{
+		long		hook_timeout = pgstat_report_stat_hook(force);
+
+		if (hook_timeout > 0 && (timeout == 0 || hook_timeout < timeout))
+			timeout = hook_timeout;
+	}
+
+	return timeout;
+}
+
+/*
+ * Workhorse for pgstat_report_stat(), flushing the built-in statistics.
+ */
+static long
+pgstat_flush_pending_stats(bool force)
+{
+	static TimestampTz pending_since = 0;
+	static TimestampTz last_flush = 0;
+	bool		partial_flush;
+	TimestampTz now;
+	bool		nowait;
+
 	/* Don't expend a clock check if nothing to do */
 	if (dlist_is_empty(&pgStatPending) &&
 		!have_iostats &&
@@ -17,6 +17,7 @@
 #include "postgres.h"
 
 #include "executor/instrument.h"
+#include "port/pg_bitutils.h"
 #include "storage/bufmgr.h"
 #include "utils/pgstat_internal.h"
 
@@ -25,6 +26,7 @@ typedef struct PgStat_PendingIO
 {
 	PgStat_Counter counts[IOOBJECT_NUM_TYPES][IOCONTEXT_NUM_TYPES][IOOP_NUM_TYPES];
 	instr_time	pending_times[IOOBJECT_NUM_TYPES][IOCONTEXT_NUM_TYPES][IOOP_NUM_TYPES];
+	PgStat_Counter hist[IOOBJECT_NUM_TYPES][IOCONTEXT_NUM_TYPES][IOOP_NUM_TYPES][PGSTAT_IO_HIST_BUCKETS];
 } PgStat_PendingIO;
 
 
@@ -116,7 +118,8 @@ pgstat_prepare_io_time(bool track_io_guc)
 }
 
 /*
- * Like pgstat_count_io_op_n() except it also accumulates time.
+ * Like pgstat_count_io_op_n() except it also accumulates time, and counts
+ * the operation in the latency histogram.
  */
 void
 pgstat_count_io_op_time(IOObject io_object, IOContext io_context, IOOp io_op,
@@ -125,10 +128,18 @@ pgstat_count_io_op_time(IOObject io_object, IOContext io_context, IOOp io_op,
 	if (track_io_timing)
 	{
 		instr_time	io_time;
+		uint64		io_us;
+		int			bucket = 0;
 
 		INSTR_TIME_SET_CURRENT(io_time);
 		INSTR_TIME_SUBTRACT(io_time, start_time);
 
+		io_us = INSTR_TIME_GET_MICROSEC(io_time);
+		if (io_us >= 16)
+			bucket = Min(pg_leftmost_one_pos64(io_us) - 3,
+						 PGSTAT_IO_HIST_BUCKETS - 1);
+		PendingIOStats.hist[io_object][io_context][io_op][bucket]++;
+
 		if (io_op == IOOP_WRITE || io_op == IOOP_EXTEND)
 		{
 			pgstat_count_buffer_write_time(INSTR_TIME_GET_MICROSEC(io_time));
@@ -202,6 +213,10 @@ pgstat_flush_io(bool nowait)
 
 				bktype_shstats->times[io_object][io_context][io_op] +=
 					INSTR_TIME_GET_MICROSEC(time);
+
+				for (int bucket = 0; bucket < PGSTAT_IO_HIST_BUCKETS; bucket++)
+					bktype_shstats->hist[io_object][io_context][io_op][bucket] +=
+						PendingIOStats.hist[io_object][io_context][io_op][bucket];
 			}
 		}
 	}
@@ -465,6 +480,13 @@ pgstat_tracks_io_op(BackendType bktype, IOObject io_object,
 	if (!strategy_io_context && io_op == IOOP_REUSE)
 		return false;
 
+	/*
+	 * IOOP_WAL_FLUSH is only counted for buffers evicted by a
+	 * BufferAccessStrategy, see GetVictimBuffer().
+	 */
+	if (!strategy_io_context && io_op == IOOP_WAL_FLUSH)
+		return false;
+
 	/*
 	 * IOOP_FSYNC IOOps done by a backend using a BufferAccessStrategy are
 	 * counted in the IOCONTEXT_NORMAL IOContext. See comment in
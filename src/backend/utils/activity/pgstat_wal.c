@@ -18,6 +18,7 @@
 #include "postgres.h"
 
 #include "executor/instrument.h"
+#include "port/pg_bitutils.h"
 #include "utils/pgstat_internal.h"
 
 
@@ -119,6 +120,8 @@ pgstat_flush_wal(bool nowait)
 	WALSTAT_ACC(wal_sync, PendingWalStats);
 	WALSTAT_ACC_INSTR_TIME(wal_write_time);
 	WALSTAT_ACC_INSTR_TIME(wal_sync_time);
+	for (int i = 0; i < PGSTAT_WAL_FLUSH_BATCH_BUCKETS; i++)
+		WALSTAT_ACC(wal_flush_batches[i], PendingWalStats);
 #undef WALSTAT_ACC_INSTR_TIME
 #undef WALSTAT_ACC
 
@@ -137,6 +140,21 @@ pgstat_flush_wal(bool nowait)
 	return false;
 }
 
+/*
+ * Count a WAL flush performed by XLogFlush() on behalf of 'batch' flush
+ * requests, in the batch size histogram.
+ */
+void
+pgstat_count_wal_flush_batch(uint32 batch)
+{
+	int			bucket = 0;
+
+	if (batch > 1)
+		bucket = Min(pg_ceil_log2_32(batch), PGSTAT_WAL_FLUSH_BATCH_BUCKETS - 1);
+
+	PendingWalStats.wal_flush_batches[bucket]++;
+}
+
 void
 pgstat_init_wal(void)
 {
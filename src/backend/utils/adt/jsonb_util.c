@@ -413,6 +413,11 @@ getKeyJsonValueFromContainer(JsonbContainer *container,
 	/*
 	 * Binary search the container. Since we know this is an object, account
 	 * for *Pairs* of Jentrys
+	 *
+	 * Keys are sorted by length first, as in lengthCompareJsonbString(), and
+	 * a key's length can usually be read straight off its JEntry while its
+	 * offset may take a walk back over preceding entries.  So compare the
+	 * lengths first and only locate the key's bytes when they match.
 	 */
 	baseAddr = (char *) (children + count * 2);
 	stopLow = 0;
@@ -426,11 +431,14 @@ getKeyJsonValueFromContainer(JsonbContainer *container,
 
 		stopMiddle = stopLow + (stopHigh - stopLow) / 2;
 
-		candidateVal = baseAddr + getJsonbOffset(container, stopMiddle);
 		candidateLen = getJsonbLength(container, stopMiddle);
-
-		difference = lengthCompareJsonbString(candidateVal, candidateLen,
-											  keyVal, keyLen);
+		if (candidateLen != keyLen)
+			difference = candidateLen > keyLen ? 1 : -1;
+		else
+		{
+			candidateVal = baseAddr + getJsonbOffset(container, stopMiddle);
+			difference = memcmp(candidateVal, keyVal, keyLen);
+		}
 
 		if (difference == 0)
 		{
@@ -124,6 +124,7 @@ SB_lower_char(unsigned char c, pg_locale_t locale, bool locale_is_c)
 #define CHAREQ(p1, p2) (*(p1) == *(p2))
 #define NextChar(p, plen) NextByte((p), (plen))
 #define CopyAdvChar(dst, src, srclen) (*(dst)++ = *(src)++, (srclen)--)
+#define MATCH_MEMCHR
 
 #define MatchText	SB_MatchText
 #define do_like_escape	SB_do_like_escape
@@ -141,6 +142,7 @@ SB_lower_char(unsigned char c, pg_locale_t locale, bool locale_is_c)
 
 #define NextChar(p, plen) \
 	do { (p)++; (plen)--; } while ((plen) > 0 && (*(p) & 0xC0) == 0x80 )
+#define MATCH_MEMCHR
 #define MatchText	UTF8_MatchText
 
 #include "like_match.c"
@@ -171,6 +171,33 @@ MatchText(const char *t, int tlen, const char *p, int plen,
 			else
 				firstpat = GETCHAR(*p);
 
+#ifdef MATCH_MEMCHR
+
+			/*
+			 * Without case folding, a candidate position must hold exactly
+			 * the byte firstpat, so let memchr() find the candidates rather
+			 * than examining the text one character at a time.  This is
+			 * only safe where any byte equal to firstpat starts a character:
+			 * always in single-byte encodings, and in UTF8 because firstpat
+			 * is a lead byte, which can never appear inside a character.
+			 */
+			while (tlen > 0)
+			{
+				const char *next = memchr(t, (unsigned char) firstpat, tlen);
+				int			matched;
+
+				if (next == NULL)
+					break;
+				tlen -= next - t;
+				t = next;
+
+				matched = MatchText(t, tlen, p, plen, locale, locale_is_c);
+				if (matched != LIKE_FALSE)
+					return matched; /* TRUE or ABORT */
+
+				NextChar(t, tlen);
+			}
+#else
 			while (tlen > 0)
 			{
 				if (GETCHAR(*t) == firstpat)
@@ -184,6 +211,7 @@ MatchText(const char *t, int tlen, const char *p, int plen,
 
 				NextChar(t, tlen);
 			}
+#endif							/* MATCH_MEMCHR */
 
 			/*
 			 * End of text with no match, so no point in trying later places
@@ -347,6 +375,7 @@ do_like_escape(text *pat, text *esc)
 #undef NextChar
 #undef CopyAdvChar
 #undef MatchText
+#undef MATCH_MEMCHR
 
 #ifdef do_like_escape
 #undef do_like_escape
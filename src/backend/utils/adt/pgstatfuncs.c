@@ -29,6 +29,7 @@
 #include "storage/proc.h"
 #include "storage/procarray.h"
 #include "utils/acl.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/timestamp.h"
 
@@ -1283,8 +1284,14 @@ typedef enum io_stat_col
 	IO_COL_HITS,
 	IO_COL_EVICTIONS,
 	IO_COL_REUSES,
+	IO_COL_WAL_FLUSHES,
 	IO_COL_FSYNCS,
 	IO_COL_FSYNC_TIME,
+	IO_COL_READ_HIST,
+	IO_COL_WRITE_HIST,
+	IO_COL_WRITEBACK_HIST,
+	IO_COL_EXTEND_HIST,
+	IO_COL_FSYNC_HIST,
 	IO_COL_RESET_TIME,
 	IO_NUM_COLUMNS,
 } io_stat_col;
@@ -1310,6 +1317,8 @@ pgstat_get_io_op_index(IOOp io_op)
 			return IO_COL_READS;
 		case IOOP_REUSE:
 			return IO_COL_REUSES;
+		case IOOP_WAL_FLUSH:
+			return IO_COL_WAL_FLUSHES;
 		case IOOP_WRITE:
 			return IO_COL_WRITES;
 		case IOOP_WRITEBACK:
@@ -1340,6 +1349,37 @@ pgstat_get_io_time_index(IOOp io_op)
 		case IOOP_EVICT:
 		case IOOP_HIT:
 		case IOOP_REUSE:
+		case IOOP_WAL_FLUSH:
+			return IO_COL_INVALID;
+	}
+
+	elog(ERROR, "unrecognized IOOp value: %d", io_op);
+	pg_unreachable();
+}
+
+/*
+ * Get the number of the column containing the IO latency histogram for the
+ * specified IOOp, or IO_COL_INVALID if the op is not timed.
+ */
+static io_stat_col
+pgstat_get_io_hist_index(IOOp io_op)
+{
+	switch (io_op)
+	{
+		case IOOP_READ:
+			return IO_COL_READ_HIST;
+		case IOOP_WRITE:
+			return IO_COL_WRITE_HIST;
+		case IOOP_WRITEBACK:
+			return IO_COL_WRITEBACK_HIST;
+		case IOOP_EXTEND:
+			return IO_COL_EXTEND_HIST;
+		case IOOP_FSYNC:
+			return IO_COL_FSYNC_HIST;
+		case IOOP_EVICT:
+		case IOOP_HIT:
+		case IOOP_REUSE:
+		case IOOP_WAL_FLUSH:
 			return IO_COL_INVALID;
 	}
 
@@ -1422,6 +1462,7 @@ pg_stat_get_io(PG_FUNCTION_ARGS)
 				{
 					int			op_idx = pgstat_get_io_op_index(io_op);
 					int			time_idx = pgstat_get_io_time_index(io_op);
+					int			hist_idx = pgstat_get_io_hist_index(io_op);
 
 					/*
 					 * Some combinations of BackendType and IOOp, of IOContext
@@ -1451,6 +1492,23 @@ pg_stat_get_io(PG_FUNCTION_ARGS)
 					}
 					else
 						nulls[time_idx] = true;
+
+					/* timed operations also have a histogram */
+					Assert(hist_idx != IO_COL_INVALID);
+
+					if (!nulls[op_idx])
+					{
+						Datum		hist[PGSTAT_IO_HIST_BUCKETS];
+
+						for (int i = 0; i < PGSTAT_IO_HIST_BUCKETS; i++)
+							hist[i] = Int64GetDatum(bktype_stats->hist[io_obj][io_context][io_op][i]);
+						values[hist_idx] =
+							PointerGetDatum(construct_array_builtin(hist,
+																	PGSTAT_IO_HIST_BUCKETS,
+																	INT8OID));
+					}
+					else
+						nulls[hist_idx] = true;
 				}
 
 				tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc,
@@ -1468,11 +1526,12 @@ pg_stat_get_io(PG_FUNCTION_ARGS)
 Datum
 pg_stat_get_wal(PG_FUNCTION_ARGS)
 {
-#define PG_STAT_GET_WAL_COLS	9
+#define PG_STAT_GET_WAL_COLS	10
 	TupleDesc	tupdesc;
 	Datum		values[PG_STAT_GET_WAL_COLS] = {0};
 	bool		nulls[PG_STAT_GET_WAL_COLS] = {0};
 	char		buf[256];
+	Datum		batches[PGSTAT_WAL_FLUSH_BATCH_BUCKETS];
 	PgStat_WalStats *wal_stats;
 
 	/* Initialise attributes information in the tuple descriptor */
@@ -1493,7 +1552,9 @@ pg_stat_get_wal(PG_FUNCTION_ARGS)
 					   FLOAT8OID, -1, 0);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "wal_sync_time",
 					   FLOAT8OID, -1, 0);
-	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "stats_reset",
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "wal_flush_batches",
+					   INT8ARRAYOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 10, "stats_reset",
 					   TIMESTAMPTZOID, -1, 0);
 
 	BlessTupleDesc(tupdesc);
@@ -1520,7 +1581,13 @@ pg_stat_get_wal(PG_FUNCTION_ARGS)
 	values[6] = Float8GetDatum(((double) wal_stats->wal_write_time) / 1000.0);
 	values[7] = Float8GetDatum(((double) wal_stats->wal_sync_time) / 1000.0);
 
-	values[8] = TimestampTzGetDatum(wal_stats->stat_reset_timestamp);
+	for (int i = 0; i < PGSTAT_WAL_FLUSH_BATCH_BUCKETS; i++)
+		batches[i] = Int64GetDatum(wal_stats->wal_flush_batches[i]);
+	values[8] = PointerGetDatum(construct_array_builtin(batches,
+														PGSTAT_WAL_FLUSH_BATCH_BUCKETS,
+														INT8OID));
+
+	values[9] = TimestampTzGetDatum(wal_stats->stat_reset_timestamp);
 
 	/* Returns the record as Datum */
 	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
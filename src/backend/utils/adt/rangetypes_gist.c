@@ -21,6 +21,7 @@
 #include "utils/fmgrprotos.h"
 #include "utils/multirangetypes.h"
 #include "utils/rangetypes.h"
+#include "utils/sortsupport.h"
 
 /*
  * Range class properties used to segregate different classes of ranges in
@@ -182,6 +183,7 @@ static int	single_bound_cmp(const void *a, const void *b, void *arg);
 static int	interval_cmp_lower(const void *a, const void *b, void *arg);
 static int	interval_cmp_upper(const void *a, const void *b, void *arg);
 static int	common_entry_cmp(const void *i1, const void *i2);
+static int	range_gist_sort_cmp(Datum a, Datum b, SortSupport ssup);
 static float8 call_subtype_diff(TypeCacheEntry *typcache,
 								Datum val1, Datum val2);
 
@@ -801,6 +803,27 @@ range_gist_same(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*
+ * Sort support routine for fast GiST index build by sorting.
+ *
+ * Ranges are sorted by lower bound and then by upper bound, with empty ranges
+ * first, which is the same order that range_cmp() uses.  That's a natural
+ * one-dimensional order for packing leaf pages: ranges that start close to
+ * each other end up together, so the bounding ranges of the pages overlap
+ * little unless the input ranges vary a lot in length.  This is also used by
+ * multirange_ops, whose keys are compressed to ranges.
+ */
+Datum
+range_gist_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+	ssup->comparator = range_gist_sort_cmp;
+	ssup->ssup_extra = NULL;
+
+	PG_RETURN_VOID();
+}
+
 /*
  *----------------------------------------------------------
  * STATIC FUNCTIONS
@@ -1737,6 +1760,59 @@ single_bound_cmp(const void *a, const void *b, void *arg)
 	return range_cmp_bounds(typcache, &i1->bound, &i2->bound);
 }
 
+/*
+ * SortSupport comparator for range_gist_sortsupport()
+ *
+ * The type cache entry is looked up on the first call and kept in
+ * ssup_extra.  Detoasted copies of the input are freed right away, since
+ * this is called many times during the sort.
+ */
+static int
+range_gist_sort_cmp(Datum a, Datum b, SortSupport ssup)
+{
+	RangeType  *r1 = DatumGetRangeTypeP(a);
+	RangeType  *r2 = DatumGetRangeTypeP(b);
+	TypeCacheEntry *typcache = (TypeCacheEntry *) ssup->ssup_extra;
+	RangeBound	lower1,
+				lower2;
+	RangeBound	upper1,
+				upper2;
+	bool		empty1,
+				empty2;
+	int			cmp;
+
+	if (typcache == NULL)
+	{
+		typcache = lookup_type_cache(RangeTypeGetOid(r1), TYPECACHE_RANGE_INFO);
+		if (typcache->rngelemtype == NULL)
+			elog(ERROR, "type %u is not a range type", RangeTypeGetOid(r1));
+		ssup->ssup_extra = typcache;
+	}
+
+	range_deserialize(typcache, r1, &lower1, &upper1, &empty1);
+	range_deserialize(typcache, r2, &lower2, &upper2, &empty2);
+
+	if (empty1 && empty2)
+		cmp = 0;
+	else if (empty1)
+		cmp = -1;
+	else if (empty2)
+		cmp = 1;
+	else
+	{
+		cmp = range_cmp_bounds(typcache, &lower1, &lower2);
+		if (cmp == 0)
+			cmp = range_cmp_bounds(typcache, &upper1, &upper2);
+	}
+
+	if ((Pointer) r1 != DatumGetPointer(a))
+		pfree(r1);
+	if ((Pointer) r2 != DatumGetPointer(b))
+		pfree(r2);
+
+	return cmp;
+}
+
 /*
  * Compare NonEmptyRanges by lower bound.
  */
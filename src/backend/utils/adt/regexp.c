@@ -30,6 +30,7 @@
 #include "postgres.h"
 
 #include "catalog/pg_type.h"
+#include "common/hashfn.h"
 #include "funcapi.h"
 #include "regex/regex.h"
 #include "utils/array.h"
@@ -88,11 +89,16 @@ typedef struct regexp_matches_ctx
  * patterns are seen will "fail to keep up" and will drop off the end of the
  * cache.  With move-to-front, a reusable pattern is guaranteed to stay in
  * the cache as long as it's used at least once in every MAX_CACHED_RES uses.
+ *
+ * Each entry also remembers a hash of its pattern text, so that the scan
+ * can reject non-matching entries without touching the pattern strings.
+ * That keeps a miss cheap enough to allow a fairly large cache, which
+ * matters for workloads that cycle through many distinct patterns.
  */
 
 /* this is the maximum number of cached regular expressions */
 #ifndef MAX_CACHED_RES
-#define MAX_CACHED_RES	32
+#define MAX_CACHED_RES	128
 #endif
 
 /* A parent memory context for regular expressions. */
@@ -104,6 +110,7 @@ typedef struct cached_re_str
 	MemoryContext cre_context;	/* memory context for this regexp */
 	char	   *cre_pat;		/* original RE (not null terminated!) */
 	int			cre_pat_len;	/* length of original RE, in bytes */
+	uint32		cre_pat_hash;	/* hash_bytes() of original RE */
 	int			cre_flags;		/* compile flags: extended,icase etc */
 	Oid			cre_collation;	/* collation to use */
 	regex_t		cre_re;			/* the compiled regular expression */
@@ -142,6 +149,7 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 {
 	int			text_re_len = VARSIZE_ANY_EXHDR(text_re);
 	char	   *text_re_val = VARDATA_ANY(text_re);
+	uint32		text_re_hash;
 	pg_wchar   *pattern;
 	int			pattern_len;
 	int			i;
@@ -155,9 +163,12 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 	 * structure is self-organizing with most-used entries at the front, our
 	 * search strategy can just be to scan from the front.
 	 */
+	text_re_hash = hash_bytes((const unsigned char *) text_re_val, text_re_len);
+
 	for (i = 0; i < num_res; i++)
 	{
-		if (re_array[i].cre_pat_len == text_re_len &&
+		if (re_array[i].cre_pat_hash == text_re_hash &&
+			re_array[i].cre_pat_len == text_re_len &&
 			re_array[i].cre_flags == cflags &&
 			re_array[i].cre_collation == collation &&
 			memcmp(re_array[i].cre_pat, text_re_val, text_re_len) == 0)
@@ -235,6 +246,7 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 	MemoryContextSetIdentifier(re_temp.cre_context, re_temp.cre_pat);
 
 	re_temp.cre_pat_len = text_re_len;
+	re_temp.cre_pat_hash = text_re_hash;
 	re_temp.cre_flags = cflags;
 	re_temp.cre_collation = collation;
 
@@ -60,6 +60,18 @@
 #define CACHE_elog(...)
 #endif
 
+/* GUC variable: -1 disables pruning of unused entries */
+int			catalog_cache_prune_min_age = -1;
+
+/* GUC variable: 0 means no limit on memory used by entries */
+int			catalog_cache_memory_limit = 0;
+
+/* Timestamp used to age entries, advanced at each statement start */
+TimestampTz catcacheclock = 0;
+
+/* Child of CacheMemoryContext holding the cache entries themselves */
+static MemoryContext CatCacheMemoryContext = NULL;
+
 /* Cache management header --- pointer is NULL until created */
 static CatCacheHeader *CacheHdr = NULL;
 
@@ -89,6 +101,8 @@ static void CatCachePrintStats(int code, Datum arg);
 static void CatCacheRemoveCTup(CatCache *cache, CatCTup *ct);
 static void CatCacheRemoveCList(CatCache *cache, CatCList *cl);
 static void RehashCatCache(CatCache *cp);
+static bool CatCachePruneEntries(CatCache *cp, CatCTup *keep);
+static void CatCacheEnforceMemoryLimit(CatCTup *keep);
 static void RehashCatCacheLists(CatCache *cp);
 static void CatalogCacheInitializeCache(CatCache *cache);
 static CatCTup *CatalogCacheCreateEntry(CatCache *cache,
@@ -523,8 +537,10 @@ CatCacheRemoveCTup(CatCache *cache, CatCTup *ct)
 		return;					/* nothing left to do */
 	}
 
-	/* delink from linked list */
+	/* delink from linked lists */
 	dlist_delete(&ct->cache_elem);
+	dlist_delete(&ct->lru_elem);
+	CacheHdr->ch_nbytes -= GetMemoryChunkSpace(ct);
 
 	/*
 	 * Free keys when we're dealing with a negative entry, normal entries just
@@ -865,6 +881,16 @@ InitCatCache(int id,
 		CacheHdr = (CatCacheHeader *) palloc(sizeof(CatCacheHeader));
 		slist_init(&CacheHdr->ch_caches);
 		CacheHdr->ch_ntup = 0;
+		CacheHdr->ch_nbytes = 0;
+		dlist_init(&CacheHdr->ch_lru);
+
+		/*
+		 * Keep the entries in their own context, so that their memory usage
+		 * can be told apart from the rest of CacheMemoryContext.
+		 */
+		CatCacheMemoryContext = AllocSetContextCreate(CacheMemoryContext,
+													  "CatCacheMemoryContext",
+													  ALLOCSET_DEFAULT_SIZES);
 #ifdef CATCACHE_STATS
 		/* set up to dump stats at backend exit */
 		on_proc_exit(CatCachePrintStats, 0);
@@ -927,6 +953,87 @@ InitCatCache(int id,
 	return cp;
 }
 
+/*
+ *		CatCachePruneEntries
+ *
+ * Remove entries that have not been looked up for at least
+ * catalog_cache_prune_min_age seconds, as measured by catcacheclock.
+ * Entries that are referenced, dead, or members of a CatCList are left
+ * alone, as is "keep" (the entry our caller just created).  Returns false
+ * without doing anything if pruning is disabled.
+ */
+static bool
+CatCachePruneEntries(CatCache *cp, CatCTup *keep)
+{
+	TimestampTz prune_before;
+
+	if (catalog_cache_prune_min_age < 0 || catcacheclock == 0)
+		return false;
+
+	prune_before = catcacheclock -
+		(TimestampTz) catalog_cache_prune_min_age * USECS_PER_SEC;
+
+	for (int i = 0; i < cp->cc_nbuckets; i++)
+	{
+		dlist_mutable_iter iter;
+
+		dlist_foreach_modify(iter, &cp->cc_bucket[i])
+		{
+			CatCTup    *ct = dlist_container(CatCTup, cache_elem, iter.cur);
+
+			if (ct == keep || ct->refcount > 0 || ct->dead ||
+				ct->c_list != NULL || ct->lastaccess >= prune_before)
+				continue;
+
+			CatCacheRemoveCTup(cp, ct);
+		}
+	}
+
+	CACHE_elog(DEBUG1, "catcache %s: %d entries remain after pruning",
+			   cp->cc_relname, cp->cc_ntup);
+
+	return true;
+}
+
+/*
+ *		CatCacheEnforceMemoryLimit
+ *
+ * Remove least-recently-used entries, from any cache, until the memory used
+ * by catcache entries is back under catalog_cache_memory_limit.  Entries
+ * that are currently referenced, and "keep" (the entry our caller just
+ * created), are skipped.  An entry belonging to an unreferenced CatCList
+ * takes the list with it; since that may delete other entries too, we
+ * restart from the front of the LRU list afterwards.
+ */
+static void
+CatCacheEnforceMemoryLimit(CatCTup *keep)
+{
+	Size		limit = (Size) catalog_cache_memory_limit * 1024;
+	dlist_mutable_iter iter;
+
+restart:
+	dlist_foreach_modify(iter, &CacheHdr->ch_lru)
+	{
+		CatCTup    *ct = dlist_container(CatCTup, lru_elem, iter.cur);
+
+		if (CacheHdr->ch_nbytes <= limit)
+			return;
+
+		if (ct == keep || ct->refcount > 0 || ct->dead)
+			continue;
+
+		if (ct->c_list != NULL)
+		{
+			if (ct->c_list->refcount > 0)
+				continue;
+			CatCacheRemoveCTup(ct->my_cache, ct);
+			goto restart;
+		}
+
+		CatCacheRemoveCTup(ct->my_cache, ct);
+	}
+}
+
 /*
  * Enlarge a catcache, doubling the number of buckets.
  */
@@ -1377,6 +1484,16 @@ SearchCatCacheInternal(CatCache *cache,
 		 * near the front of the hashbucket's list.)
 		 */
 		dlist_move_head(bucket, &ct->cache_elem);
+		ct->lastaccess = catcacheclock;
+
+		/*
+		 * Keep the LRU list in order only if there's a memory limit to
+		 * enforce, since this touches another entry's cache line.  If a limit
+		 * is set later on, the list starts out in roughly creation order,
+		 * which is good enough.
+		 */
+		if (catalog_cache_memory_limit > 0)
+			dlist_move_tail(&CacheHdr->ch_lru, &ct->lru_elem);
 
 		/*
 		 * If it's a positive entry, bump its refcount and return it. If it's
@@ -1897,7 +2014,7 @@ SearchCatCacheList(CatCache *cache,
 		ResourceOwnerEnlarge(CurrentResourceOwner);
 
 		/* Now we can build the CatCList entry. */
-		oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+		oldcxt = MemoryContextSwitchTo(CatCacheMemoryContext);
 		nmembers = list_length(ctlist);
 		cl = (CatCList *)
 			palloc(offsetof(CatCList, members) + nmembers * sizeof(CatCTup *));
@@ -2074,7 +2191,7 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, SysScanDesc scandesc,
 			dtp = ntp;
 
 		/* Allocate memory for CatCTup and the cached tuple in one go */
-		oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+		oldcxt = MemoryContextSwitchTo(CatCacheMemoryContext);
 
 		ct = (CatCTup *) palloc(sizeof(CatCTup) +
 								MAXIMUM_ALIGNOF + dtp->t_len);
@@ -2109,7 +2226,7 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, SysScanDesc scandesc,
 	else
 	{
 		/* Set up keys for a negative cache entry */
-		oldcxt = MemoryContextSwitchTo(CacheMemoryContext);
+		oldcxt = MemoryContextSwitchTo(CatCacheMemoryContext);
 		ct = (CatCTup *) palloc(sizeof(CatCTup));
 
 		/*
@@ -2132,18 +2249,34 @@ CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp, SysScanDesc scandesc,
 	ct->dead = false;
 	ct->negative = (ntp == NULL);
 	ct->hash_value = hashValue;
+	ct->lastaccess = catcacheclock;
 
 	dlist_push_head(&cache->cc_bucket[hashIndex], &ct->cache_elem);
+	dlist_push_tail(&CacheHdr->ch_lru, &ct->lru_elem);
 
 	cache->cc_ntup++;
 	CacheHdr->ch_ntup++;
+	CacheHdr->ch_nbytes += GetMemoryChunkSpace(ct);
+
+	/* Evict from all caches if this took us over the memory budget */
+	if (catalog_cache_memory_limit > 0 &&
+		CacheHdr->ch_nbytes > (Size) catalog_cache_memory_limit * 1024)
+		CatCacheEnforceMemoryLimit(ct);
 
 	/*
 	 * If the hash table has become too full, enlarge the buckets array. Quite
-	 * arbitrarily, we enlarge when fill factor > 2.
+	 * arbitrarily, we enlarge when fill factor > 2.  If pruning is enabled,
+	 * first try to make room by discarding entries that haven't been used
+	 * for a while; we only enlarge if that didn't bring the fill factor back
+	 * down to 1.  Doing this only at the point where we would otherwise
+	 * rehash keeps the cost of the scan amortized over many insertions.
 	 */
 	if (cache->cc_ntup > cache->cc_nbuckets * 2)
-		RehashCatCache(cache);
+	{
+		if (!CatCachePruneEntries(cache, ct) ||
+			cache->cc_ntup > cache->cc_nbuckets)
+			RehashCatCache(cache);
+	}
 
 	return ct;
 }
@@ -86,6 +86,13 @@
 	((plansource)->raw_parse_tree != NULL && \
 	 stmt_requires_parse_analysis((plansource)->raw_parse_tree))
 
+/*
+ * If the most expensive custom plan seen so far costs more than this many
+ * times the cheapest one, choose_custom_plan() considers the statement too
+ * parameter-sensitive for a generic plan.
+ */
+#define CUSTOM_PLAN_COST_SPREAD 100.0
+
 /*
  * This is the head of the backend's list of "saved" CachedPlanSources (i.e.,
  * those that are in long-lived storage and are examined for sinval events).
@@ -246,6 +253,8 @@ CreateCachedPlan(RawStmt *raw_parse_tree,
 	plansource->generation = 0;
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
+	plansource->min_custom_cost = -1;
+	plansource->max_custom_cost = -1;
 	plansource->num_generic_plans = 0;
 	plansource->num_custom_plans = 0;
 
@@ -314,6 +323,8 @@ CreateOneShotCachedPlan(RawStmt *raw_parse_tree,
 	plansource->generation = 0;
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
+	plansource->min_custom_cost = -1;
+	plansource->max_custom_cost = -1;
 	plansource->num_generic_plans = 0;
 	plansource->num_custom_plans = 0;
 
@@ -1074,6 +1085,17 @@ choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams)
 	if (plansource->num_custom_plans < 5)
 		return true;
 
+	/*
+	 * If the custom plans' costs differ by orders of magnitude, the best plan
+	 * evidently depends heavily on the parameter values, as happens with
+	 * skewed data distributions.  A single generic plan is then likely to be
+	 * terrible for some of the values, whatever its average cost looks like,
+	 * so keep planning for each set of parameters.
+	 */
+	if (plansource->max_custom_cost >
+		CUSTOM_PLAN_COST_SPREAD * plansource->min_custom_cost)
+		return true;
+
 	avg_custom_cost = plansource->total_custom_cost / plansource->num_custom_plans;
 
 	/*
@@ -1240,10 +1262,19 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 
 	if (customplan)
 	{
+		double		cost;
+
 		/* Build a custom plan */
 		plan = BuildCachedPlan(plansource, qlist, boundParams, queryEnv);
-		/* Accumulate total costs of custom plans */
-		plansource->total_custom_cost += cached_plan_cost(plan, true);
+		cost = cached_plan_cost(plan, true);
+
+		/* Accumulate total costs of custom plans, and track their spread */
+		plansource->total_custom_cost += cost;
+		if (plansource->min_custom_cost < 0 ||
+			cost < plansource->min_custom_cost)
+			plansource->min_custom_cost = cost;
+		if (cost > plansource->max_custom_cost)
+			plansource->max_custom_cost = cost;
 
 		plansource->num_custom_plans++;
 	}
@@ -1607,6 +1638,8 @@ CopyCachedPlan(CachedPlanSource *plansource)
 	/* We may as well copy any acquired cost knowledge */
 	newsource->generic_cost = plansource->generic_cost;
 	newsource->total_custom_cost = plansource->total_custom_cost;
+	newsource->min_custom_cost = plansource->min_custom_cost;
+	newsource->max_custom_cost = plansource->max_custom_cost;
 	newsource->num_generic_plans = plansource->num_generic_plans;
 	newsource->num_custom_plans = plansource->num_custom_plans;
 
@@ -1630,6 +1663,54 @@ CachedPlanIsValid(CachedPlanSource *plansource)
 	return plansource->is_valid;
 }
 
+/*
+ * CachedPlanResetPlanChoice: forget the custom-plan cost history that
+ * choose_custom_plan() bases its decision on, so that the CachedPlanSource
+ * starts out again generating custom plans as a freshly created one would.
+ * Any existing generic plan is kept.
+ */
+void
+CachedPlanResetPlanChoice(CachedPlanSource *plansource)
+{
+	Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
+	plansource->total_custom_cost = 0;
+	plansource->min_custom_cost = -1;
+	plansource->max_custom_cost = -1;
+	plansource->num_custom_plans = 0;
+}
+
+/*
+ * CachedPlanMatchesEnvironment: was the CachedPlanSource analyzed under the
+ * current search_path and, if its query depends on row security, the current
+ * role and row_security setting?
+ *
+ * If not, RevalidateCachedQuery() would redo parse analysis, which is a
+ * problem for a caller wanting to reuse a plansource in place of parsing the
+ * same query text again: with fixed_result set, analysis that now finds a
+ * different relation fails with "cached plan must not change result type"
+ * instead of just producing the new result.
+ */
+bool
+CachedPlanMatchesEnvironment(CachedPlanSource *plansource)
+{
+	Assert(plansource->magic == CACHEDPLANSOURCE_MAGIC);
+
+	/* Plans that RevalidateCachedQuery() never checks always match */
+	if (plansource->is_oneshot || !StmtPlanRequiresRevalidation(plansource))
+		return true;
+
+	if (plansource->search_path == NULL ||
+		!SearchPathMatchesCurrentEnvironment(plansource->search_path))
+		return false;
+
+	if (plansource->dependsOnRLS &&
+		(plansource->rewriteRoleId != GetUserId() ||
+		 plansource->rewriteRowSecurity != row_security))
+		return false;
+
+	return true;
+}
+
 /*
  * CachedPlanGetTargetList: return tlist, if any, describing plan's output
  *
@@ -127,6 +127,9 @@
 /* Number of freelists to be used for a partitioned hash table. */
 #define NUM_FREELISTS			32
 
+/* Max number of elements hash_search_optimistic() looks at before giving up */
+#define MAX_OPTIMISTIC_SEARCH_STEPS	64
+
 /* A hash bucket is a linked list of HASHELEMENTs */
 typedef HASHELEMENT *HASHBUCKET;
 
@@ -1122,6 +1125,59 @@ hash_search_with_hash_value(HTAB *hashp,
 	return NULL;				/* keep compiler quiet */
 }
 
+/*
+ * hash_search_optimistic -- look up a key without holding the partition lock
+ *
+ * This is like hash_search_with_hash_value() with HASH_FIND, but may be
+ * called without the lock that normally protects the key's partition against
+ * concurrent insertions and deletions.  That is only possible for partitioned
+ * tables, as their bucket array never changes, and their elements are
+ * recycled through the freelists but never freed, so that following a
+ * collision chain always leads through valid elements, if not necessarily
+ * the right ones.
+ *
+ * The result is therefore only a hint: NULL may be returned although the key
+ * is present, and the element returned may be in the process of being
+ * removed, or even hold a different key by the time the caller looks at it.
+ * Callers must verify the result by other means, and take the partition lock
+ * and search again if it doesn't hold up.
+ */
+void *
+hash_search_optimistic(HTAB *hashp,
+					   const void *keyPtr,
+					   uint32 hashvalue)
+{
+	HASHBUCKET	currBucket;
+	HASHBUCKET *prevBucketPtr;
+	HashCompareFunc match = hashp->match;
+	Size		keysize = hashp->keysize;
+	int			nsteps = 0;
+
+	Assert(IS_PARTITIONED(hashp->hctl));
+
+	(void) hash_initial_lookup(hashp, hashvalue, &prevBucketPtr);
+	currBucket = *((volatile HASHBUCKET *) prevBucketPtr);
+
+	while (currBucket != NULL)
+	{
+		if (currBucket->hashvalue == hashvalue &&
+			match(ELEMENTKEY(currBucket), keyPtr, keysize) == 0)
+			return (void *) ELEMENTKEY(currBucket);
+
+		/*
+		 * Elements concurrently moving between chains could keep us going
+		 * around in circles, so give up after a while.  Collision chains are
+		 * normally very short.
+		 */
+		if (++nsteps > MAX_OPTIMISTIC_SEARCH_STEPS)
+			return NULL;
+
+		currBucket = *((volatile HASHBUCKET *) &currBucket->link);
+	}
+
+	return NULL;
+}
+
 /*
  * hash_update_hash_key -- change the hash key of an existing table entry
  *
@@ -193,6 +193,8 @@ InitStandaloneProcess(const char *argv0)
 
 	InitProcessGlobals();
 
+	pg_initialize_timing();
+
 	/* Initialize process-local latch support */
 	InitializeLatchSupport();
 	InitProcessLocalLatch();
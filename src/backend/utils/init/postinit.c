@@ -585,6 +585,41 @@ InitializeMaxBackends(void)
 		elog(ERROR, "too many backends configured");
 }
 
+/*
+ * Initialize the number of fast-path lock groups, based on the configured
+ * number of locks per transaction.
+ *
+ * We allow anything between 1 and 1024 groups, with the usual power-of-2
+ * logic.  The 1 is the "old" size with only 16 slots, 1024 is an arbitrary
+ * limit (matching max_locks_per_transaction = 16k).  Values over 1024 are
+ * unlikely to be beneficial, as there are bottlenecks we'll hit way before
+ * that.
+ *
+ * Like InitializeMaxBackends, this must be called before shared memory size
+ * is determined; in EXEC_BACKEND environment, the value is passed down from
+ * postmaster to subprocesses via BackendParameters.
+ */
+void
+InitializeFastPathLocks(void)
+{
+	/* Should be initialized only once. */
+	Assert(FastPathLockGroupsPerBackend == 0);
+
+	/* we need at least one group */
+	FastPathLockGroupsPerBackend = 1;
+
+	while (FastPathLockGroupsPerBackend < FP_LOCK_GROUPS_PER_BACKEND_MAX)
+	{
+		/* stop once we exceed max_locks_per_xact */
+		if (FastPathLockSlotsPerBackend() >= max_locks_per_xact)
+			break;
+
+		FastPathLockGroupsPerBackend *= 2;
+	}
+
+	Assert(FastPathLockGroupsPerBackend <= FP_LOCK_GROUPS_PER_BACKEND_MAX);
+}
+
 /*
  * GUC check_hook for max_connections
  */
@@ -1146,6 +1181,9 @@ InitPostgres(const char *in_dbname, Oid dboid,
 	 */
 	MyProc->databaseId = MyDatabaseId;
 
+	/* Likewise, let sinval writers know which messages concern us */
+	SharedInvalSetDatabase(MyDatabaseId);
+
 	/*
 	 * We established a catalog snapshot while reading pg_authid and/or
 	 * pg_database; but until we have set up MyDatabaseId, we won't react to
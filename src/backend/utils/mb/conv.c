@@ -12,6 +12,7 @@
  */
 #include "postgres.h"
 #include "mb/pg_wchar.h"
+#include "utils/ascii.h"
 
 
 /*
@@ -541,8 +542,20 @@ UtfToLocal(const unsigned char *utf, int len,
 
 		if (l == 1)
 		{
-			/* ASCII case is easy, assume it's one-to-one conversion */
-			*iso++ = *utf++;
+			/*
+			 * ASCII case is easy, assume it's one-to-one conversion.  Text
+			 * is often mostly ASCII, so copy a whole chunk at once if
+			 * possible.
+			 */
+			if (len >= sizeof(Vector8) && is_valid_ascii(utf, sizeof(Vector8)))
+			{
+				memcpy(iso, utf, sizeof(Vector8));
+				iso += sizeof(Vector8);
+				utf += sizeof(Vector8);
+				l = sizeof(Vector8);
+			}
+			else
+				*iso++ = *utf++;
 			continue;
 		}
 
@@ -746,8 +759,19 @@ LocalToUtf(const unsigned char *iso, int len,
 		if (!IS_HIGHBIT_SET(*iso))
 		{
 			/* ASCII case is easy, assume it's one-to-one conversion */
-			*utf++ = *iso++;
-			l = 1;
+			if (len >= sizeof(Vector8) && is_valid_ascii(iso, sizeof(Vector8)))
+			{
+				/* copy a whole chunk of ASCII at once, as in UtfToLocal */
+				memcpy(utf, iso, sizeof(Vector8));
+				utf += sizeof(Vector8);
+				iso += sizeof(Vector8);
+				l = sizeof(Vector8);
+			}
+			else
+			{
+				*utf++ = *iso++;
+				l = 1;
+			}
 			continue;
 		}
 
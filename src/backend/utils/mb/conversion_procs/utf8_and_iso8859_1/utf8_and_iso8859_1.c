@@ -14,6 +14,7 @@
 #include "postgres.h"
 #include "fmgr.h"
 #include "mb/pg_wchar.h"
+#include "utils/ascii.h"
 
 PG_MODULE_MAGIC;
 
@@ -56,7 +57,18 @@ iso8859_1_to_utf8(PG_FUNCTION_ARGS)
 			report_invalid_encoding(PG_LATIN1, (const char *) src, len);
 		}
 		if (!IS_HIGHBIT_SET(c))
+		{
+			/* fast path for chunks of ASCII-subset characters */
+			if (len >= sizeof(Vector8) && is_valid_ascii(src, sizeof(Vector8)))
+			{
+				memcpy(dest, src, sizeof(Vector8));
+				dest += sizeof(Vector8);
+				src += sizeof(Vector8);
+				len -= sizeof(Vector8);
+				continue;
+			}
 			*dest++ = c;
+		}
 		else
 		{
 			*dest++ = (c >> 6) | 0xc0;
@@ -95,9 +107,19 @@ utf8_to_iso8859_1(PG_FUNCTION_ARGS)
 		/* fast path for ASCII-subset characters */
 		if (!IS_HIGHBIT_SET(c))
 		{
-			*dest++ = c;
-			src++;
-			len--;
+			if (len >= sizeof(Vector8) && is_valid_ascii(src, sizeof(Vector8)))
+			{
+				memcpy(dest, src, sizeof(Vector8));
+				dest += sizeof(Vector8);
+				src += sizeof(Vector8);
+				len -= sizeof(Vector8);
+			}
+			else
+			{
+				*dest++ = c;
+				src++;
+				len--;
+			}
 		}
 		else
 		{
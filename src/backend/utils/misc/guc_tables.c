@@ -44,6 +44,7 @@
 #include "commands/user.h"
 #include "commands/vacuum.h"
 #include "common/file_utils.h"
+#include "executor/nodeHashjoin.h"
 #include "common/scram-common.h"
 #include "jit/jit.h"
 #include "libpq/auth.h"
@@ -70,15 +71,21 @@
 #include "replication/slot.h"
 #include "replication/slotsync.h"
 #include "replication/syncrep.h"
+#include "replication/walreceiver.h"
+#include "storage/aio.h"
 #include "storage/bufmgr.h"
+#include "storage/buffile.h"
 #include "storage/large_object.h"
 #include "storage/pg_shmem.h"
 #include "storage/predicate.h"
+#include "storage/sinvaladt.h"
+#include "storage/smgr.h"
 #include "storage/standby.h"
 #include "tcop/tcopprot.h"
 #include "tsearch/ts_cache.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
+#include "utils/catcache.h"
 #include "utils/float.h"
 #include "utils/guc_hooks.h"
 #include "utils/guc_tables.h"
@@ -443,6 +450,17 @@ static const struct config_enum_entry recovery_init_sync_method_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry buffer_replacement_policy_options[] = {
+	{"clock_sweep", BUFFER_REPLACEMENT_CLOCK_SWEEP, false},
+	{"scan_resistant", BUFFER_REPLACEMENT_SCAN_RESISTANT, false},
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry io_method_options[] = {
+	{"sync", IOMETHOD_SYNC, false},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry shared_memory_options[] = {
 #ifndef WIN32
 	{"sysv", SHMEM_TYPE_SYSV, false},
@@ -456,10 +474,28 @@ static const struct config_enum_entry shared_memory_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry shared_memory_numa_options[] = {
+	{"off", SHMEM_NUMA_OFF, false},
+	{"interleave", SHMEM_NUMA_INTERLEAVE, false},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry default_toast_compression_options[] = {
 	{"pglz", TOAST_PGLZ_COMPRESSION, false},
 #ifdef  USE_LZ4
 	{"lz4", TOAST_LZ4_COMPRESSION, false},
+#endif
+#ifdef  USE_ZSTD
+	{"zstd", TOAST_ZSTD_COMPRESSION, false},
+#endif
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry temp_file_compression_options[] = {
+	{"none", TEMP_FILE_COMPRESSION_NONE, false},
+	{"pglz", TEMP_FILE_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", TEMP_FILE_COMPRESSION_LZ4, false},
 #endif
 	{NULL, 0, false}
 };
@@ -483,6 +519,17 @@ static const struct config_enum_entry wal_compression_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry wal_receiver_compression_options[] = {
+	{"none", PG_COMPRESSION_NONE, false},
+#ifdef USE_LZ4
+	{"lz4", PG_COMPRESSION_LZ4, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", PG_COMPRESSION_ZSTD, false},
+#endif
+	{NULL, 0, false}
+};
+
 /*
  * Options for enum values stored in other modules
  */
@@ -564,6 +611,7 @@ int			ssl_renegotiation_limit;
 int			huge_pages = HUGE_PAGES_TRY;
 int			huge_page_size;
 int			huge_pages_status = HUGE_PAGES_UNKNOWN;
+int			shared_memory_numa = SHMEM_NUMA_OFF;
 
 /*
  * These variables are all dummies that don't do anything, except in some
@@ -577,7 +625,7 @@ static char *datestyle_string;
 static char *server_encoding_string;
 static char *server_version_string;
 static int	server_version_num;
-static char *debug_io_direct_string;
+static char *io_direct_string;
 
 #ifdef HAVE_SYSLOG
 #define	DEFAULT_SYSLOG_FACILITY LOG_LOCAL0
@@ -598,6 +646,7 @@ static int	block_size;
 static int	segment_size;
 static int	shared_memory_size_mb;
 static int	shared_memory_size_in_huge_pages;
+static int	shared_memory_numa_nodes;
 static int	wal_block_size;
 static bool data_checksums;
 static bool integer_datetimes;
@@ -1017,6 +1066,16 @@ struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"geqo_greedy", PGC_USERSET, QUERY_TUNING_GEQO,
+			gettext_noop("Uses greedy join ordering instead of genetic search for queries over geqo_threshold."),
+			gettext_noop("The join with the smallest estimated result is made first, repeatedly."),
+			GUC_EXPLAIN
+		},
+		&geqo_greedy,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		/*
 		 * Not for general use --- used by SET SESSION AUTHORIZATION and SET
@@ -1092,6 +1151,15 @@ struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"ssl_session_tickets", PGC_SIGHUP, CONN_AUTH_SSL,
+			gettext_noop("Allows clients to resume SSL sessions using session tickets."),
+			NULL
+		},
+		&ssl_session_tickets,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"fsync", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Forces synchronization of updates to disk."),
@@ -2055,6 +2123,18 @@ struct config_int ConfigureNamesInt[] =
 		0, 0, INT_MAX / 2,
 		NULL, NULL, NULL
 	},
+	{
+		{"debug_hash_join_prefetch_min_buckets", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the minimum number of hash table buckets for "
+						 "prefetching in hash joins."),
+			gettext_noop("Hash joins probing a table with fewer buckets do not "
+						 "read outer tuples ahead to prefetch their buckets."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&debug_hash_join_prefetch_min_buckets,
+		DEFAULT_HASH_JOIN_PREFETCH_MIN_BUCKETS, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
 	{
 		{"post_auth_delay", PGC_BACKEND, DEVELOPER_OPTIONS,
 			gettext_noop("Sets the amount of time to wait after "
@@ -2089,6 +2169,17 @@ struct config_int ConfigureNamesInt[] =
 		8, 1, INT_MAX,
 		NULL, NULL, NULL
 	},
+	{
+		{"or_to_any_threshold", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of OR'ed comparisons of the same "
+						 "expression beyond which they are merged into = ANY."),
+			gettext_noop("Zero disables the transformation."),
+			GUC_EXPLAIN
+		},
+		&or_to_any_threshold,
+		5, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
 	{
 		{"join_collapse_limit", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Sets the FROM-list size beyond which JOIN "
@@ -2301,6 +2392,17 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"shared_memory_numa_nodes", PGC_INTERNAL, PRESET_OPTIONS,
+			gettext_noop("Shows the number of NUMA nodes the main shared memory area is interleaved across."),
+			gettext_noop("0 indicates that the default memory placement is in use."),
+			GUC_NOT_IN_SAMPLE | GUC_DISALLOW_IN_FILE
+		},
+		&shared_memory_numa_nodes,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"commit_timestamp_buffers", PGC_POSTMASTER, RESOURCES_MEM,
 			gettext_noop("Sets the size of the dedicated buffer pool used for the commit timestamp cache."),
@@ -2479,6 +2581,67 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"catalog_cache_prune_min_age", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the minimum unused duration of catalog cache entries before removal."),
+			gettext_noop("Catalog cache entries that have not been used for "
+						 "this long may be removed when the cache would "
+						 "otherwise be enlarged. -1 disables removal."),
+			GUC_UNIT_S
+		},
+		&catalog_cache_prune_min_age,
+		-1, -1, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"catalog_cache_memory_limit", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the maximum memory to be used for catalog cache entries."),
+			gettext_noop("Least recently used entries are removed once this "
+						 "much memory is in use. 0 disables the limit."),
+			GUC_UNIT_KB
+		},
+		&catalog_cache_memory_limit,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"backend_memory_limit", PGC_SUSET, RESOURCES_MEM,
+			gettext_noop("Sets the maximum memory a backend's memory contexts may hold."),
+			gettext_noop("Allocations that would exceed it fail with an out-of-memory "
+						 "error. 0 disables the limit."),
+			GUC_UNIT_KB
+		},
+		&backend_memory_limit,
+		0, 0, MAX_KILOBYTES,
+		check_backend_memory_limit, NULL, NULL
+	},
+
+	{
+		{"invalidation_queue_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the number of shared cache invalidation messages that can be queued."),
+			gettext_noop("Backends that fall further behind than this must "
+						 "discard all their cached catalog information. "
+						 "Must be a power of two.")
+		},
+		&invalidation_queue_size,
+		4096, 1024, 1024 * 1024,
+		check_invalidation_queue_size, NULL, NULL
+	},
+
+	{
+		{"relation_size_cache_entries", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the number of relation fork sizes cached in shared memory."),
+			gettext_noop("Sizes of further forks are looked up in the file "
+						 "system each time. 0 means a quarter of shared_buffers, "
+						 "but at least 1024.")
+		},
+		&relation_size_cache_entries,
+		0, 0, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
+
 	/*
 	 * We use the hopefully-safely-small value of 100kB as the compiled-in
 	 * default for max_stack_depth.  InitializeGUCOptions will increase it if
@@ -2715,6 +2878,16 @@ struct config_int ConfigureNamesInt[] =
 		1600000000, 0, 2100000000,
 		NULL, NULL, NULL
 	},
+	{
+		{"vacuum_freeze_page_wal_age", PGC_USERSET, CLIENT_CONN_STATEMENT,
+			gettext_noop("Amount of WAL written since a page was last modified after which VACUUM freezes it eagerly."),
+			gettext_noop("-1 disables eager freezing of unmodified pages."),
+			GUC_UNIT_MB
+		},
+		&vacuum_freeze_page_wal_age,
+		-1, -1, INT_MAX,
+		NULL, NULL, NULL
+	},
 
 	/*
 	 * See also CheckRequiredParameterValues() if this parameter changes
@@ -2893,6 +3066,16 @@ struct config_int ConfigureNamesInt[] =
 		check_wal_buffers, NULL, NULL
 	},
 
+	{
+		{"wal_insert_locks", PGC_POSTMASTER, WAL_SETTINGS,
+			gettext_noop("Sets the number of locks used for concurrent WAL insertion."),
+			gettext_noop("Specify -1 to have this value determined from max_connections.")
+		},
+		&wal_insert_locks,
+		-1, -1, MAX_WAL_INSERT_LOCKS,
+		check_wal_insert_locks, NULL, NULL
+	},
+
 	{
 		{"wal_writer_delay", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Time between WAL flushes performed in the WAL writer."),
@@ -2915,6 +3098,16 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_preallocate_segments", PGC_SIGHUP, WAL_SETTINGS,
+			gettext_noop("Sets the number of future WAL segments the WAL writer keeps created."),
+			NULL
+		},
+		&wal_preallocate_segments,
+		1, 0, 256,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_skip_threshold", PGC_USERSET, WAL_SETTINGS,
 			gettext_noop("Minimum size of new file to fsync instead of writing WAL."),
@@ -2975,11 +3168,12 @@ struct config_int ConfigureNamesInt[] =
 		{"commit_delay", PGC_SUSET, WAL_SETTINGS,
 			gettext_noop("Sets the delay in microseconds between transaction commit and "
 						 "flushing WAL to disk."),
-			NULL
+			gettext_noop("-1 chooses the delay automatically from the recent WAL flush "
+						 "latency and commit rate.")
 			/* we have no microseconds designation, so can't supply units here */
 		},
 		&CommitDelay,
-		0, 0, 100000,
+		0, -1, 100000,
 		NULL, NULL, NULL
 	},
 
@@ -3044,6 +3238,18 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_record_compression_threshold", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Sets the minimum size of WAL records that are compressed as a whole."),
+			gettext_noop("-1 disables compression of whole records. The method "
+						 "is the one chosen with wal_compression."),
+			GUC_UNIT_BYTE
+		},
+		&wal_record_compression_threshold,
+		-1, -1, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"log_parameter_max_length", PGC_SUSET, LOGGING_WHAT,
 			gettext_noop("Sets the maximum length in bytes of data logged for bind "
@@ -4691,14 +4897,14 @@ struct config_string ConfigureNamesString[] =
 	},
 
 	{
-		{"debug_io_direct", PGC_POSTMASTER, DEVELOPER_OPTIONS,
+		{"io_direct", PGC_POSTMASTER, RESOURCES_DISK,
 			gettext_noop("Use direct I/O for file access."),
 			NULL,
-			GUC_LIST_INPUT | GUC_NOT_IN_SAMPLE
+			GUC_LIST_INPUT
 		},
-		&debug_io_direct_string,
+		&io_direct_string,
 		"",
-		check_debug_io_direct, assign_debug_io_direct, NULL
+		check_io_direct, assign_io_direct, NULL
 	},
 
 	{
@@ -4944,6 +5150,26 @@ struct config_enum ConfigureNamesEnum[] =
 		NULL, assign_stats_fetch_consistency, NULL
 	},
 
+	{
+		{"temp_file_compression", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Compresses temporary files written by hash joins with the specified method."),
+			NULL
+		},
+		&temp_file_compression,
+		TEMP_FILE_COMPRESSION_NONE, temp_file_compression_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"logical_decoding_spill_compression", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Compresses changes that logical decoding spills to disk with the specified method."),
+			NULL
+		},
+		&logical_decoding_spill_compression,
+		TEMP_FILE_COMPRESSION_NONE, temp_file_compression_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_compression", PGC_SUSET, WAL_SETTINGS,
 			gettext_noop("Compresses full-page writes written in WAL file with specified method."),
@@ -4954,6 +5180,16 @@ struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_receiver_compression", PGC_SIGHUP, REPLICATION_STANDBY,
+			gettext_noop("Compresses WAL streamed from the primary server with the specified method."),
+			gettext_noop("Takes effect the next time streaming is started.")
+		},
+		&wal_receiver_compression,
+		PG_COMPRESSION_NONE, wal_receiver_compression_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_level", PGC_POSTMASTER, WAL_SETTINGS,
 			gettext_noop("Sets the level of information written to the WAL."),
@@ -5025,6 +5261,26 @@ struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"shared_memory_numa", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the NUMA memory policy for the main shared memory area."),
+			NULL
+		},
+		&shared_memory_numa,
+		SHMEM_NUMA_OFF, shared_memory_numa_options,
+		check_shared_memory_numa, NULL, NULL
+	},
+
+	{
+		{"buffer_replacement_policy", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Selects the replacement policy for shared buffers."),
+			NULL
+		},
+		&buffer_replacement_policy,
+		BUFFER_REPLACEMENT_CLOCK_SWEEP, buffer_replacement_policy_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"huge_pages_status", PGC_INTERNAL, PRESET_OPTIONS,
 			gettext_noop("Indicates the status of huge pages."),
@@ -5115,6 +5371,16 @@ struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"io_method", PGC_POSTMASTER, RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Selects the method for executing file I/O."),
+			NULL
+		},
+		&io_method,
+		DEFAULT_IO_METHOD, io_method_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"debug_logical_replication_streaming", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Forces immediate streaming or serialization of changes in large transactions."),
@@ -422,8 +422,8 @@ AllocSetContextCreateInternal(MemoryContext parent,
 								parent,
 								name);
 
-			((MemoryContext) set)->mem_allocated =
-				KeeperBlock(set)->endptr - ((char *) set);
+			MemoryContextAccountAlloc((MemoryContext) set,
+									  KeeperBlock(set)->endptr - ((char *) set));
 
 			return (MemoryContext) set;
 		}
@@ -516,7 +516,7 @@ AllocSetContextCreateInternal(MemoryContext parent,
 						parent,
 						name);
 
-	((MemoryContext) set)->mem_allocated = firstBlockSize;
+	MemoryContextAccountAlloc((MemoryContext) set, firstBlockSize);
 
 	return (MemoryContext) set;
 }
@@ -580,7 +580,7 @@ AllocSetReset(MemoryContext context)
 		else
 		{
 			/* Normal case, release the block */
-			context->mem_allocated -= block->endptr - ((char *) block);
+			MemoryContextAccountFree(context, block->endptr - ((char *) block));
 
 #ifdef CLOBBER_FREED_MEMORY
 			wipe_mem(block, block->freeptr - ((char *) block));
@@ -668,7 +668,7 @@ AllocSetDelete(MemoryContext context)
 		AllocBlock	next = block->next;
 
 		if (!IsKeeperBlock(set, block))
-			context->mem_allocated -= block->endptr - ((char *) block);
+			MemoryContextAccountFree(context, block->endptr - ((char *) block));
 
 #ifdef CLOBBER_FREED_MEMORY
 		wipe_mem(block, block->freeptr - ((char *) block));
@@ -712,11 +712,13 @@ AllocSetAllocLarge(MemoryContext context, Size size, int flags)
 #endif
 
 	blksize = chunk_size + ALLOC_BLOCKHDRSZ + ALLOC_CHUNKHDRSZ;
+	if (MemoryContextWouldExceedLimit(context, blksize))
+		return MemoryContextLimitFailure(context, size, flags);
 	block = (AllocBlock) malloc(blksize);
 	if (block == NULL)
 		return MemoryContextAllocationFailure(context, size, flags);
 
-	context->mem_allocated += blksize;
+	MemoryContextAccountAlloc(context, blksize);
 
 	block->aset = set;
 	block->freeptr = block->endptr = ((char *) block) + blksize;
@@ -904,6 +906,9 @@ AllocSetAllocFromNewBlock(MemoryContext context, Size size, int flags,
 	while (blksize < required_size)
 		blksize <<= 1;
 
+	if (MemoryContextWouldExceedLimit(context, blksize))
+		return MemoryContextLimitFailure(context, size, flags);
+
 	/* Try to allocate it */
 	block = (AllocBlock) malloc(blksize);
 
@@ -922,7 +927,7 @@ AllocSetAllocFromNewBlock(MemoryContext context, Size size, int flags,
 	if (block == NULL)
 		return MemoryContextAllocationFailure(context, size, flags);
 
-	context->mem_allocated += blksize;
+	MemoryContextAccountAlloc(context, blksize);
 
 	block->aset = set;
 	block->freeptr = ((char *) block) + ALLOC_BLOCKHDRSZ;
@@ -1099,7 +1104,7 @@ AllocSetFree(void *pointer)
 		if (block->next)
 			block->next->prev = block->prev;
 
-		set->header.mem_allocated -= block->endptr - ((char *) block);
+		MemoryContextAccountFree(&set->header, block->endptr - ((char *) block));
 
 #ifdef CLOBBER_FREED_MEMORY
 		wipe_mem(block, block->freeptr - ((char *) block));
@@ -1223,6 +1228,14 @@ AllocSetRealloc(void *pointer, Size size, int flags)
 		blksize = chksize + ALLOC_BLOCKHDRSZ + ALLOC_CHUNKHDRSZ;
 		oldblksize = block->endptr - ((char *) block);
 
+		if (blksize > oldblksize &&
+			MemoryContextWouldExceedLimit(&set->header, blksize - oldblksize))
+		{
+			/* Disallow access to the chunk header. */
+			VALGRIND_MAKE_MEM_NOACCESS(chunk, ALLOC_CHUNKHDRSZ);
+			return MemoryContextLimitFailure(&set->header, size, flags);
+		}
+
 		block = (AllocBlock) realloc(block, blksize);
 		if (block == NULL)
 		{
@@ -1232,8 +1245,8 @@ AllocSetRealloc(void *pointer, Size size, int flags)
 		}
 
 		/* updated separately, not to underflow when (oldblksize > blksize) */
-		set->header.mem_allocated -= oldblksize;
-		set->header.mem_allocated += blksize;
+		MemoryContextAccountFree(&set->header, oldblksize);
+		MemoryContextAccountAlloc(&set->header, blksize);
 
 		block->freeptr = block->endptr = ((char *) block) + blksize;
 
@@ -227,7 +227,7 @@ BumpContextCreate(MemoryContext parent, const char *name, Size minContextSize,
 	MemoryContextCreate((MemoryContext) set, T_BumpContext, MCTX_BUMP_ID,
 						parent, name);
 
-	((MemoryContext) set)->mem_allocated = allocSize;
+	MemoryContextAccountAlloc((MemoryContext) set, allocSize);
 
 	return (MemoryContext) set;
 }
@@ -314,11 +314,13 @@ BumpAllocLarge(MemoryContext context, Size size, int flags)
 	required_size = chunk_size + Bump_CHUNKHDRSZ;
 	blksize = required_size + Bump_BLOCKHDRSZ;
 
+	if (MemoryContextWouldExceedLimit(context, blksize))
+		return MemoryContextLimitFailure(context, size, flags);
 	block = (BumpBlock *) malloc(blksize);
 	if (block == NULL)
 		return NULL;
 
-	context->mem_allocated += blksize;
+	MemoryContextAccountAlloc(context, blksize);
 
 	/* the block is completely full */
 	block->freeptr = block->endptr = ((char *) block) + blksize;
@@ -450,12 +452,14 @@ BumpAllocFromNewBlock(MemoryContext context, Size size, int flags,
 	if (blksize < required_size)
 		blksize = pg_nextpower2_size_t(required_size);
 
+	if (MemoryContextWouldExceedLimit(context, blksize))
+		return MemoryContextLimitFailure(context, size, flags);
 	block = (BumpBlock *) malloc(blksize);
 
 	if (block == NULL)
 		return MemoryContextAllocationFailure(context, size, flags);
 
-	context->mem_allocated += blksize;
+	MemoryContextAccountAlloc(context, blksize);
 
 	/* initialize the new block */
 	BumpBlockInit(set, block, blksize);
@@ -600,7 +604,8 @@ BumpBlockFree(BumpContext *set, BumpBlock *block)
 	/* release the block from the list of blocks */
 	dlist_delete(&block->node);
 
-	((MemoryContext) set)->mem_allocated -= ((char *) block->endptr - (char *) block);
+	MemoryContextAccountFree((MemoryContext) set,
+							 (char *) block->endptr - (char *) block);
 
 #ifdef CLOBBER_FREED_MEMORY
 	wipe_mem(block, ((char *) block->endptr - (char *) block));
@@ -265,7 +265,7 @@ GenerationContextCreate(MemoryContext parent,
 						parent,
 						name);
 
-	((MemoryContext) set)->mem_allocated = firstBlockSize;
+	MemoryContextAccountAlloc((MemoryContext) set, firstBlockSize);
 
 	return (MemoryContext) set;
 }
@@ -361,11 +361,13 @@ GenerationAllocLarge(MemoryContext context, Size size, int flags)
 	required_size = chunk_size + Generation_CHUNKHDRSZ;
 	blksize = required_size + Generation_BLOCKHDRSZ;
 
+	if (MemoryContextWouldExceedLimit(context, blksize))
+		return MemoryContextLimitFailure(context, size, flags);
 	block = (GenerationBlock *) malloc(blksize);
 	if (block == NULL)
 		return MemoryContextAllocationFailure(context, size, flags);
 
-	context->mem_allocated += blksize;
+	MemoryContextAccountAlloc(context, blksize);
 
 	/* block with a single (used) chunk */
 	block->context = set;
@@ -482,12 +484,14 @@ GenerationAllocFromNewBlock(MemoryContext context, Size size, int flags,
 	if (blksize < required_size)
 		blksize = pg_nextpower2_size_t(required_size);
 
+	if (MemoryContextWouldExceedLimit(context, blksize))
+		return MemoryContextLimitFailure(context, size, flags);
 	block = (GenerationBlock *) malloc(blksize);
 
 	if (block == NULL)
 		return MemoryContextAllocationFailure(context, size, flags);
 
-	context->mem_allocated += blksize;
+	MemoryContextAccountAlloc(context, blksize);
 
 	/* initialize the new block */
 	GenerationBlockInit(set, block, blksize);
@@ -671,7 +675,7 @@ GenerationBlockFree(GenerationContext *set, GenerationBlock *block)
 	/* release the block from the list of blocks */
 	dlist_delete(&block->node);
 
-	((MemoryContext) set)->mem_allocated -= block->blksize;
+	MemoryContextAccountFree((MemoryContext) set, block->blksize);
 
 #ifdef CLOBBER_FREED_MEMORY
 	wipe_mem(block, block->blksize);
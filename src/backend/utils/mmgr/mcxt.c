@@ -23,6 +23,7 @@
 
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
+#include "utils/guc_hooks.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
 #include "utils/memutils_internal.h"
@@ -157,6 +158,12 @@ MemoryContext CurTransactionContext = NULL;
 /* This is a transient link to the active portal's memory context: */
 MemoryContext PortalContext = NULL;
 
+/* GUC variable; 0 means no limit */
+int			backend_memory_limit = 0;
+
+/* see memutils_internal.h */
+Size		MemoryContextTotalAllocated = 0;
+
 static void MemoryContextDeleteOnly(MemoryContext context);
 static void MemoryContextCallResetCallbacks(MemoryContext context);
 static void MemoryContextStatsInternal(MemoryContext context, int level,
@@ -525,7 +532,18 @@ MemoryContextDeleteOnly(MemoryContext context)
 	 */
 	context->ident = NULL;
 
-	context->methods->delete_context(context);
+	/*
+	 * The context implementation accounts for the blocks it frees along the
+	 * way, but not for what it releases together with the context header, so
+	 * just drop everything this context had from the backend total.
+	 */
+	{
+		Size		remaining = MemoryContextTotalAllocated -
+			context->mem_allocated;
+
+		context->methods->delete_context(context);
+		MemoryContextTotalAllocated = remaining;
+	}
 
 	VALGRIND_DESTROY_MEMPOOL(context);
 }
@@ -1158,6 +1176,61 @@ MemoryContextAllocationFailure(MemoryContext context, Size size, int flags)
 	return NULL;
 }
 
+/*
+ * MemoryContextLimitExceeded
+ *		Out-of-line part of MemoryContextWouldExceedLimit().
+ *
+ * The limit only applies to regular backends and background workers (which
+ * includes parallel workers); failing an allocation in a postmaster child
+ * with more specialized tasks would just turn into a crash-and-restart
+ * cycle.  Error reporting and critical sections are exempt too.
+ */
+bool
+MemoryContextLimitExceeded(MemoryContext context, Size size)
+{
+	if (MemoryContextTotalAllocated + size <= (Size) backend_memory_limit * 1024)
+		return false;
+	if (MyBackendType != B_BACKEND && MyBackendType != B_BG_WORKER)
+		return false;
+	if (context == ErrorContext || CritSectionCount > 0)
+		return false;
+	return true;
+}
+
+/*
+ * GUC check_hook for backend_memory_limit
+ */
+bool
+check_backend_memory_limit(int *newval, void **extra, GucSource source)
+{
+	if (*newval != 0 && *newval < MIN_BACKEND_MEMORY_LIMIT)
+	{
+		GUC_check_errdetail("\"%s\" must be 0 or at least %d kB.",
+							"backend_memory_limit", MIN_BACKEND_MEMORY_LIMIT);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * MemoryContextLimitFailure
+ *		For use by MemoryContextMethods implementations when allocating a new
+ *		block would exceed backend_memory_limit.  Like
+ *		MemoryContextAllocationFailure(), this respects MCXT_ALLOC_NO_OOM.
+ */
+void *
+MemoryContextLimitFailure(MemoryContext context, Size size, int flags)
+{
+	if ((flags & MCXT_ALLOC_NO_OOM) == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed on request of size %zu in memory context \"%s\" because the backend would exceed \"%s\" (%d kB).",
+						   size, context->name,
+						   "backend_memory_limit", backend_memory_limit)));
+	return NULL;
+}
+
 /*
  * MemoryContextSizeFailure
  *		For use by MemoryContextMethods implementations to handle invalid
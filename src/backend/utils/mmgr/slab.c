@@ -452,7 +452,7 @@ SlabReset(MemoryContext context)
 		wipe_mem(block, slab->blockSize);
 #endif
 		free(block);
-		context->mem_allocated -= slab->blockSize;
+		MemoryContextAccountFree(context, slab->blockSize);
 	}
 
 	/* walk over blocklist and free the blocks */
@@ -468,7 +468,7 @@ SlabReset(MemoryContext context)
 			wipe_mem(block, slab->blockSize);
 #endif
 			free(block);
-			context->mem_allocated -= slab->blockSize;
+			MemoryContextAccountFree(context, slab->blockSize);
 		}
 	}
 
@@ -562,13 +562,15 @@ SlabAllocFromNewBlock(MemoryContext context, Size size, int flags)
 	}
 	else
 	{
+		if (MemoryContextWouldExceedLimit(context, slab->blockSize))
+			return MemoryContextLimitFailure(context, size, flags);
 		block = (SlabBlock *) malloc(slab->blockSize);
 
 		if (unlikely(block == NULL))
 			return MemoryContextAllocationFailure(context, size, flags);
 
 		block->slab = slab;
-		context->mem_allocated += slab->blockSize;
+		MemoryContextAccountAlloc(context, slab->blockSize);
 
 		/* use the first chunk in the new block */
 		chunk = SlabBlockGetChunk(slab, block, 0);
@@ -796,7 +798,7 @@ SlabFree(void *pointer)
 			wipe_mem(block, slab->blockSize);
 #endif
 			free(block);
-			slab->header.mem_allocated -= slab->blockSize;
+			MemoryContextAccountFree(&slab->header, slab->blockSize);
 		}
 
 		/*
@@ -330,6 +330,16 @@ ltsReadFillBuffer(LogicalTape *lt)
 		/* Advance to next block, if we have buffer space left */
 	} while (lt->buffer_size - lt->nbytes > BLCKSZ);
 
+	/*
+	 * Blocks are preallocated to tapes in runs, so the next bufferload most
+	 * likely follows on from the next block.  Get the kernel started on it
+	 * while the caller works through this one.
+	 */
+	if (lt->nextBlockNumber != -1L)
+		BufFilePrefetchBlock(lt->tapeSet->pfile,
+							 lt->nextBlockNumber + lt->offsetBlockNumber,
+							 lt->buffer_size / BLCKSZ);
+
 	return (lt->nbytes > 0);
 }
 
@@ -191,6 +191,9 @@ struct Tuplesortstate
 								 * tuples to return? */
 	bool		boundUsed;		/* true if we made use of a bounded heap */
 	int			bound;			/* if bounded, the maximum number of tuples */
+	bool		haveThreshold;	/* is threshold valid? */
+	bool		thresholdNull;	/* threshold for leading key, see */
+	Datum		threshold;		/* tuplesort_set_bound_threshold() */
 	int64		tupleMem;		/* memory consumed by individual tuples.
 								 * storing this separately from what we track
 								 * in availMem allows us to subtract the
@@ -456,6 +459,9 @@ struct Sharedsort
 
 static void tuplesort_begin_batch(Tuplesortstate *state);
 static bool consider_abort_common(Tuplesortstate *state);
+static inline int compare_leading_key(Tuplesortstate *state,
+									  Datum datum1, bool isnull1,
+									  Datum datum2, bool isnull2);
 static void inittapes(Tuplesortstate *state, bool mergeruns);
 static void inittapestate(Tuplesortstate *state, int maxTapes);
 static void selectnewtape(Tuplesortstate *state);
@@ -622,6 +628,224 @@ qsort_tuple_int32_compare(SortTuple *a, SortTuple *b, Tuplesortstate *state)
 #define ST_DEFINE
 #include "lib/sort_template.h"
 
+/*
+ * Radix sort for SortTuples whose leading datum1 uses one of the comparators
+ * specialized above.
+ *
+ * For those comparators, the order of datum1 values is the order of their
+ * bits, after flipping the sign bit for signed types, and all bits for
+ * descending sorts.  That lets us sort on datum1 with an in-place MSD radix
+ * sort ("American flag sort"), one byte per pass, which needs no
+ * comparisons and no unpredictable branches.  Once a bucket is small, or all
+ * bytes of the key have been used and the bucket still needs tiebreaking
+ * (further sort keys, or abbreviated keys), the matching qsort_tuple_xxx()
+ * finishes that bucket.  For large inputs this is considerably faster than
+ * a comparison sort.
+ */
+#define RADIX_SORT_MIN_TUPLES	4096	/* use radix sort for at least this
+										 * many tuples */
+#define RADIX_SORT_MIN_BUCKET	64	/* qsort buckets smaller than this */
+
+typedef enum RadixSortKind
+{
+	RADIX_SORT_UNSIGNED,
+	RADIX_SORT_SIGNED,
+	RADIX_SORT_INT32,
+} RadixSortKind;
+
+typedef struct RadixSortInfo
+{
+	RadixSortKind kind;
+	uint64		keymask;		/* bits of datum1 that make up the key */
+	uint64		xormask;		/* bits to flip to get the key */
+	int			keybytes;		/* number of significant bytes in the key */
+	bool		needtiebreak;	/* may tuples with equal keys differ? */
+	Tuplesortstate *state;
+} RadixSortInfo;
+
+static inline uint64
+radix_sort_key(SortTuple *tuple, RadixSortInfo *info)
+{
+	return ((uint64) tuple->datum1 & info->keymask) ^ info->xormask;
+}
+
+/* Sort a bucket with the comparison sort matching the key kind. */
+static void
+radix_sort_fallback(SortTuple *begin, size_t n, RadixSortInfo *info)
+{
+	switch (info->kind)
+	{
+		case RADIX_SORT_UNSIGNED:
+			qsort_tuple_unsigned(begin, n, info->state);
+			break;
+#if SIZEOF_DATUM >= 8
+		case RADIX_SORT_SIGNED:
+			qsort_tuple_signed(begin, n, info->state);
+			break;
+#endif
+		case RADIX_SORT_INT32:
+			qsort_tuple_int32(begin, n, info->state);
+			break;
+		default:
+			elog(ERROR, "unexpected radix sort kind: %d", (int) info->kind);
+	}
+}
+
+/* Sort non-NULL tuples on byte "level" (0 is most significant) and up. */
+static void
+radix_sort_tuple_recurse(SortTuple *begin, size_t n, int level,
+						 RadixSortInfo *info)
+{
+	size_t		counts[256];
+	size_t		offsets[256];
+	size_t		ends[256];
+	int			shift;
+	size_t		pos;
+
+	CHECK_FOR_INTERRUPTS();
+
+	/*
+	 * Count the tuples in each bucket.  Skip bytes on which all tuples agree,
+	 * as happens for the leading bytes of smallish integers.
+	 */
+	for (;;)
+	{
+		shift = (info->keybytes - 1 - level) * BITS_PER_BYTE;
+		memset(counts, 0, sizeof(counts));
+		for (size_t i = 0; i < n; i++)
+			counts[(radix_sort_key(&begin[i], info) >> shift) & 0xFF]++;
+
+		if (counts[(radix_sort_key(&begin[0], info) >> shift) & 0xFF] < n)
+			break;
+		if (++level == info->keybytes)
+		{
+			/* all keys are equal */
+			if (info->needtiebreak)
+				radix_sort_fallback(begin, n, info);
+			return;
+		}
+	}
+
+	pos = 0;
+	for (int b = 0; b < 256; b++)
+	{
+		offsets[b] = pos;
+		pos += counts[b];
+		ends[b] = pos;
+	}
+
+	/* Move every tuple to its bucket, following cycles of displacements */
+	for (int b = 0; b < 256; b++)
+	{
+		while (offsets[b] < ends[b])
+		{
+			SortTuple	tmp = begin[offsets[b]];
+			int			d = (radix_sort_key(&tmp, info) >> shift) & 0xFF;
+
+			while (d != b)
+			{
+				SortTuple	swap = begin[offsets[d]];
+
+				begin[offsets[d]++] = tmp;
+				tmp = swap;
+				d = (radix_sort_key(&tmp, info) >> shift) & 0xFF;
+			}
+			begin[offsets[b]++] = tmp;
+		}
+	}
+
+	/* Now sort each bucket on the remaining bytes */
+	pos = 0;
+	for (int b = 0; b < 256; b++)
+	{
+		size_t		count = counts[b];
+
+		if (count > 1)
+		{
+			if (level + 1 == info->keybytes)
+			{
+				if (info->needtiebreak)
+					radix_sort_fallback(begin + pos, count, info);
+			}
+			else if (count < RADIX_SORT_MIN_BUCKET)
+				radix_sort_fallback(begin + pos, count, info);
+			else
+				radix_sort_tuple_recurse(begin + pos, count, level + 1, info);
+		}
+		pos += count;
+	}
+}
+
+static void
+radix_sort_tuple(SortTuple *begin, size_t n, RadixSortKind kind,
+				 Tuplesortstate *state)
+{
+	SortSupport ssup = &state->base.sortKeys[0];
+	RadixSortInfo info;
+	size_t		nnulls = 0;
+	SortTuple  *notnull;
+
+	info.kind = kind;
+	info.state = state;
+	info.needtiebreak = (state->base.onlyKey == NULL);
+	if (kind == RADIX_SORT_INT32)
+	{
+		info.keymask = PG_UINT32_MAX;
+		info.xormask = UINT64CONST(1) << 31;
+		info.keybytes = sizeof(int32);
+	}
+	else
+	{
+		info.keymask = PG_UINT64_MAX;
+		info.xormask = (kind == RADIX_SORT_SIGNED) ?
+			UINT64CONST(1) << (SIZEOF_DATUM * BITS_PER_BYTE - 1) : 0;
+		info.keybytes = SIZEOF_DATUM;
+	}
+	if (ssup->ssup_reverse)
+		info.xormask ^= info.keymask;
+
+	/*
+	 * Partition off the NULLs, which go before or after everything else
+	 * regardless of ssup_reverse.  They only need sorting among themselves if
+	 * there are further keys.
+	 */
+	if (ssup->ssup_nulls_first)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			if (begin[i].isnull1)
+			{
+				SortTuple	tmp = begin[i];
+
+				begin[i] = begin[nnulls];
+				begin[nnulls++] = tmp;
+			}
+		}
+		if (nnulls > 1 && info.needtiebreak)
+			radix_sort_fallback(begin, nnulls, &info);
+		notnull = begin + nnulls;
+	}
+	else
+	{
+		for (size_t i = n; i > 0; i--)
+		{
+			if (begin[i - 1].isnull1)
+			{
+				SortTuple	tmp = begin[i - 1];
+
+				begin[i - 1] = begin[n - 1 - nnulls];
+				begin[n - 1 - nnulls++] = tmp;
+			}
+		}
+		if (nnulls > 1 && info.needtiebreak)
+			radix_sort_fallback(begin + n - nnulls, nnulls, &info);
+		notnull = begin;
+	}
+
+	if (n - nnulls > 1)
+		radix_sort_tuple_recurse(notnull, n - nnulls, 0, &info);
+}
+
 /*
  *		tuplesort_begin_xxx
  *
@@ -786,6 +1010,7 @@ tuplesort_begin_batch(Tuplesortstate *state)
 	state->status = TSS_INITIAL;
 	state->bounded = false;
 	state->boundUsed = false;
+	state->haveThreshold = false;
 
 	state->availMem = state->allowedMem;
 
@@ -882,6 +1107,77 @@ tuplesort_set_bound(Tuplesortstate *state, int64 bound)
 	state->base.sortKeys->abbrev_full_comparator = NULL;
 }
 
+/*
+ * Compare two leading key values in the requested sort order, allowing for
+ * the bounded heap running with the sort direction reversed.
+ */
+static inline int
+compare_leading_key(Tuplesortstate *state, Datum datum1, bool isnull1,
+					Datum datum2, bool isnull2)
+{
+	int			compare;
+
+	compare = ApplySortComparator(datum1, isnull1, datum2, isnull2,
+								  state->base.sortKeys);
+	if (state->status == TSS_BOUNDED)
+		INVERT_COMPARE_RESULT(compare);
+	return compare;
+}
+
+/*
+ * tuplesort_get_bound_threshold
+ *
+ * Once a bounded sort has collected as many tuples as its bound, return the
+ * leading key of the last tuple it would currently return.  No tuple whose
+ * leading key sorts after that value can be part of the sort's output.
+ * Returns false if no such value is known yet.
+ *
+ * This is the raw datum1 value, which tuplesort_set_bound() has made sure is
+ * not an abbreviated key.  If it is pass-by-reference, it points into memory
+ * owned by the sort, and is only valid until the next tuple is added.
+ */
+bool
+tuplesort_get_bound_threshold(Tuplesortstate *state, Datum *datum,
+							  bool *isnull)
+{
+	if (state->status != TSS_BOUNDED || state->memtupcount < 1)
+		return false;
+
+	/* the heap's direction is reversed, so its top is the last tuple */
+	*datum = state->memtuples[0].datum1;
+	*isnull = state->memtuples[0].isnull1;
+	return true;
+}
+
+/*
+ * tuplesort_set_bound_threshold
+ *
+ * Tell a bounded sort that tuples whose leading key sorts after the given
+ * value are not needed, typically because another sort working on part of
+ * the same input in a parallel query already has enough tuples that sort no
+ * later than it.  Such tuples are discarded as they are added.  A threshold
+ * looser than an earlier one is ignored.
+ *
+ * The caller must keep a pass-by-reference value valid for the life of the
+ * sort.
+ */
+void
+tuplesort_set_bound_threshold(Tuplesortstate *state, Datum datum,
+							  bool isnull)
+{
+	if (!state->bounded)
+		return;
+
+	if (state->haveThreshold &&
+		compare_leading_key(state, datum, isnull,
+							state->threshold, state->thresholdNull) >= 0)
+		return;
+
+	state->haveThreshold = true;
+	state->threshold = datum;
+	state->thresholdNull = isnull;
+}
+
 /*
  * tuplesort_used_bound
  *
@@ -1228,6 +1524,20 @@ tuplesort_puttuple_common(Tuplesortstate *state, SortTuple *tuple,
 		REMOVEABBREV(state, state->memtuples, state->memtupcount);
 	}
 
+	/*
+	 * Discard the tuple right away if its leading key sorts after the
+	 * threshold we were given.
+	 */
+	if (state->haveThreshold &&
+		(state->status == TSS_INITIAL || state->status == TSS_BOUNDED) &&
+		compare_leading_key(state, tuple->datum1, tuple->isnull1,
+							state->threshold, state->thresholdNull) > 0)
+	{
+		free_sort_tuple(state, tuple);
+		MemoryContextSwitchTo(oldcontext);
+		return;
+	}
+
 	switch (state->status)
 	{
 		case TSS_INITIAL:
@@ -2723,27 +3033,41 @@ tuplesort_sort_memtuples(Tuplesortstate *state)
 		 */
 		if (state->base.haveDatum1 && state->base.sortKeys)
 		{
+			bool		radix = state->memtupcount >= RADIX_SORT_MIN_TUPLES;
+
 			if (state->base.sortKeys[0].comparator == ssup_datum_unsigned_cmp)
 			{
-				qsort_tuple_unsigned(state->memtuples,
-									 state->memtupcount,
-									 state);
+				if (radix)
+					radix_sort_tuple(state->memtuples, state->memtupcount,
+									 RADIX_SORT_UNSIGNED, state);
+				else
+					qsort_tuple_unsigned(state->memtuples,
+										 state->memtupcount,
+										 state);
 				return;
 			}
 #if SIZEOF_DATUM >= 8
 			else if (state->base.sortKeys[0].comparator == ssup_datum_signed_cmp)
 			{
-				qsort_tuple_signed(state->memtuples,
-								   state->memtupcount,
-								   state);
+				if (radix)
+					radix_sort_tuple(state->memtuples, state->memtupcount,
+									 RADIX_SORT_SIGNED, state);
+				else
+					qsort_tuple_signed(state->memtuples,
+									   state->memtupcount,
+									   state);
 				return;
 			}
 #endif
 			else if (state->base.sortKeys[0].comparator == ssup_datum_int32_cmp)
 			{
-				qsort_tuple_int32(state->memtuples,
-								  state->memtupcount,
-								  state);
+				if (radix)
+					radix_sort_tuple(state->memtuples, state->memtupcount,
+									 RADIX_SORT_INT32, state);
+				else
+					qsort_tuple_int32(state->memtuples,
+									  state->memtupcount,
+									  state);
 				return;
 			}
 		}
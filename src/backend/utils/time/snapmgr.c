@@ -144,6 +144,15 @@ static Snapshot FirstXactSnapshot = NULL;
 /* Define pathname of exported-snapshot files */
 #define SNAPSHOT_EXPORT_DIR "pg_snapshots"
 
+/*
+ * XidInMVCCSnapshot() sorts a snapshot's xid arrays once they hold at least
+ * XIDSEARCH_SORT_MIN_XIDS xids in total and have been searched linearly
+ * XIDSEARCH_SORT_AFTER times, so that sorting only pays for itself on
+ * snapshots that are used for many visibility checks.
+ */
+#define XIDSEARCH_SORT_MIN_XIDS		256
+#define XIDSEARCH_SORT_AFTER		256
+
 /* Structure holding info about exported snapshot. */
 typedef struct ExportedSnapshot
 {
@@ -511,6 +520,8 @@ SetTransactionSnapshot(Snapshot sourcesnap, VirtualTransactionId *sourcevxid,
 		memcpy(CurrentSnapshot->subxip, sourcesnap->subxip,
 			   sourcesnap->subxcnt * sizeof(TransactionId));
 	CurrentSnapshot->suboverflowed = sourcesnap->suboverflowed;
+	CurrentSnapshot->xidssorted = false;
+	CurrentSnapshot->xidsearches = 0;
 	CurrentSnapshot->takenDuringRecovery = sourcesnap->takenDuringRecovery;
 	/* NB: curcid should NOT be copied, it's a local matter */
 
@@ -1799,6 +1810,8 @@ RestoreSnapshot(char *start_address)
 	snapshot->subxip = NULL;
 	snapshot->subxcnt = serialized_snapshot.subxcnt;
 	snapshot->suboverflowed = serialized_snapshot.suboverflowed;
+	snapshot->xidssorted = false;
+	snapshot->xidsearches = 0;
 	snapshot->takenDuringRecovery = serialized_snapshot.takenDuringRecovery;
 	snapshot->curcid = serialized_snapshot.curcid;
 	snapshot->whenTaken = serialized_snapshot.whenTaken;
@@ -1842,6 +1855,19 @@ RestoreTransactionSnapshot(Snapshot snapshot, void *source_pgproc)
 	SetTransactionSnapshot(snapshot, NULL, InvalidPid, source_pgproc);
 }
 
+/*
+ * Is xid in the given array of a snapshot's xids?
+ */
+static inline bool
+XidInSnapshotArray(TransactionId xid, TransactionId *xids, uint32 nxids,
+				   bool sorted)
+{
+	if (sorted)
+		return bsearch(&xid, xids, nxids, sizeof(TransactionId),
+					   xidComparator) != NULL;
+	return pg_lfind32(xid, xids, nxids);
+}
+
 /*
  * XidInMVCCSnapshot
  *		Is the given XID still-in-progress according to the snapshot?
@@ -1870,6 +1896,22 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 	if (TransactionIdFollowsOrEquals(xid, snapshot->xmax))
 		return true;
 
+	/*
+	 * If this snapshot has many xids and keeps getting searched, sort its
+	 * arrays so that we can binary-search them.  The order of the xids
+	 * doesn't matter to anyone else, so it's OK to do this in place.
+	 */
+	if (!snapshot->xidssorted &&
+		snapshot->xcnt + snapshot->subxcnt >= XIDSEARCH_SORT_MIN_XIDS &&
+		++snapshot->xidsearches >= XIDSEARCH_SORT_AFTER)
+	{
+		qsort(snapshot->xip, snapshot->xcnt, sizeof(TransactionId),
+			  xidComparator);
+		qsort(snapshot->subxip, snapshot->subxcnt, sizeof(TransactionId),
+			  xidComparator);
+		snapshot->xidssorted = true;
+	}
+
 	/*
 	 * Snapshot information is stored slightly differently in snapshots taken
 	 * during recovery.
@@ -1886,7 +1928,8 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 		if (!snapshot->suboverflowed)
 		{
 			/* we have full data, so search subxip */
-			if (pg_lfind32(xid, snapshot->subxip, snapshot->subxcnt))
+			if (XidInSnapshotArray(xid, snapshot->subxip, snapshot->subxcnt,
+								   snapshot->xidssorted))
 				return true;
 
 			/* not there, fall through to search xip[] */
@@ -1908,7 +1951,8 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 				return false;
 		}
 
-		if (pg_lfind32(xid, snapshot->xip, snapshot->xcnt))
+		if (XidInSnapshotArray(xid, snapshot->xip, snapshot->xcnt,
+							   snapshot->xidssorted))
 			return true;
 	}
 	else
@@ -1942,7 +1986,8 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 		 * indeterminate xid. We don't know whether it's top level or subxact
 		 * but it doesn't matter. If it's present, the xid is visible.
 		 */
-		if (pg_lfind32(xid, snapshot->subxip, snapshot->subxcnt))
+		if (XidInSnapshotArray(xid, snapshot->subxip, snapshot->subxcnt,
+							   snapshot->xidssorted))
 			return true;
 	}
 
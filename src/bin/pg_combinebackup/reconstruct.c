@@ -46,6 +46,12 @@ typedef struct rfile
 	off_t		highest_offset_read;
 } rfile;
 
+/*
+ * Maximum number of blocks that write_reconstructed_file() reads and writes,
+ * or copies, with a single system call.
+ */
+#define COPY_RUN_BLOCKS		128
+
 static void debug_reconstruction(int n_source,
 								 rfile **sources,
 								 bool dry_run);
@@ -62,10 +68,10 @@ static void write_reconstructed_file(char *input_filename,
 									 bool debug,
 									 bool dry_run);
 static void read_bytes(rfile *rf, void *buffer, unsigned length);
-static void write_block(int wfd, char *output_filename,
-						uint8 *buffer,
-						pg_checksum_context *checksum_ctx);
-static void read_block(rfile *s, off_t off, uint8 *buffer);
+static void write_blocks(int wfd, char *output_filename,
+						 uint8 *buffer, unsigned length,
+						 pg_checksum_context *checksum_ctx);
+static void read_blocks(rfile *s, off_t off, uint8 *buffer, unsigned length);
 
 /*
  * Reconstruct a full file from an incremental file and a chain of prior
@@ -548,7 +554,9 @@ write_reconstructed_file(char *input_filename,
 {
 	int			wfd = -1;
 	unsigned	i;
+	unsigned	nblocks;
 	unsigned	zero_blocks = 0;
+	uint8	   *buffer = NULL;
 
 	/* Debugging output. */
 	if (debug)
@@ -625,51 +633,66 @@ write_reconstructed_file(char *input_filename,
 					pg_file_create_mode)) < 0)
 		pg_fatal("could not open file \"%s\": %m", output_filename);
 
-	/* Read and write the blocks as required. */
-	for (i = 0; i < block_length; ++i)
+	/*
+	 * Read and write the blocks as required.  Consecutive blocks that come
+	 * from consecutive offsets in the same source file, or that are all to
+	 * be zero-filled, are handled together, up to COPY_RUN_BLOCKS at a time.
+	 */
+	if (!dry_run)
+		buffer = palloc(COPY_RUN_BLOCKS * BLCKSZ);
+	for (i = 0; i < block_length; i += nblocks)
 	{
-		uint8		buffer[BLCKSZ];
 		rfile	   *s = sourcemap[i];
+		unsigned	length;
+
+		/* Find the end of this run. */
+		nblocks = 1;
+		while (nblocks < COPY_RUN_BLOCKS && i + nblocks < block_length &&
+			   sourcemap[i + nblocks] == s &&
+			   (s == NULL ||
+				offsetmap[i + nblocks] == offsetmap[i] + (off_t) nblocks * BLCKSZ))
+			++nblocks;
+		length = nblocks * BLCKSZ;
 
 		/* Update accounting information. */
 		if (s == NULL)
-			++zero_blocks;
+			zero_blocks += nblocks;
 		else
 		{
-			s->num_blocks_read++;
+			s->num_blocks_read += nblocks;
 			s->highest_offset_read = Max(s->highest_offset_read,
-										 offsetmap[i] + BLCKSZ);
+										 offsetmap[i] + length);
 		}
 
 		/* Skip the rest of this in dry-run mode. */
 		if (dry_run)
 			continue;
 
-		/* Read or zero-fill the block as appropriate. */
+		/* Read or zero-fill the blocks as appropriate. */
 		if (s == NULL)
 		{
 			/*
-			 * New block not mentioned in the WAL summary. Should have been an
-			 * uninitialized block, so just zero-fill it.
+			 * New blocks not mentioned in the WAL summary. Should have been
+			 * uninitialized blocks, so just zero-fill them.
 			 */
-			memset(buffer, 0, BLCKSZ);
+			memset(buffer, 0, length);
 
-			/* Write out the block, update the checksum if needed. */
-			write_block(wfd, output_filename, buffer, checksum_ctx);
+			/* Write out the blocks, update the checksum if needed. */
+			write_blocks(wfd, output_filename, buffer, length, checksum_ctx);
 
 			/* Nothing else to do for zero-filled blocks. */
 			continue;
 		}
 
-		/* Copy the block using the appropriate copy method. */
+		/* Copy the blocks using the appropriate copy method. */
 		if (copy_method != COPY_METHOD_COPY_FILE_RANGE)
 		{
 			/*
-			 * Read the block from the correct source file, and then write it
-			 * out, possibly with a checksum update.
+			 * Read the blocks from the correct source file, and then write
+			 * them out, possibly with a checksum update.
 			 */
-			read_block(s, offsetmap[i], buffer);
-			write_block(wfd, output_filename, buffer, checksum_ctx);
+			read_blocks(s, offsetmap[i], buffer, length);
+			write_blocks(wfd, output_filename, buffer, length, checksum_ctx);
 		}
 		else					/* use copy_file_range */
 		{
@@ -684,9 +707,9 @@ write_reconstructed_file(char *input_filename,
 			 */
 			do
 			{
-				int			wb;
+				ssize_t		wb;
 
-				wb = copy_file_range(s->fd, &off, wfd, NULL, BLCKSZ - nwritten, 0);
+				wb = copy_file_range(s->fd, &off, wfd, NULL, length - nwritten, 0);
 
 				if (wb < 0)
 					pg_fatal("error while copying file range from \"%s\" to \"%s\": %m",
@@ -694,18 +717,18 @@ write_reconstructed_file(char *input_filename,
 
 				nwritten += wb;
 
-			} while (BLCKSZ > nwritten);
+			} while (length > nwritten);
 
 			/*
 			 * When checksum calculation not needed, we're done, otherwise
-			 * read the block and pass it to the checksum calculation.
+			 * read the blocks and pass them to the checksum calculation.
 			 */
 			if (checksum_ctx->type == CHECKSUM_TYPE_NONE)
 				continue;
 
-			read_block(s, offsetmap[i], buffer);
+			read_blocks(s, offsetmap[i], buffer, length);
 
-			if (pg_checksum_update(checksum_ctx, buffer, BLCKSZ) < 0)
+			if (pg_checksum_update(checksum_ctx, buffer, length) < 0)
 				pg_fatal("could not update checksum of file \"%s\"",
 						 output_filename);
 #else
@@ -713,6 +736,8 @@ write_reconstructed_file(char *input_filename,
 #endif
 		}
 	}
+	if (buffer != NULL)
+		pfree(buffer);
 
 	/* Debugging output. */
 	if (zero_blocks > 0)
@@ -729,50 +754,51 @@ write_reconstructed_file(char *input_filename,
 }
 
 /*
- * Write the block into the file (using the file descriptor), and
+ * Write one or more blocks into the file (using the file descriptor), and
  * if needed update the checksum calculation.
  *
- * The buffer is expected to contain BLCKSZ bytes. The filename is
- * provided only for the error message.
+ * The buffer is expected to contain 'length' bytes, a multiple of BLCKSZ.
+ * The filename is provided only for the error message.
  */
 static void
-write_block(int fd, char *output_filename,
-			uint8 *buffer, pg_checksum_context *checksum_ctx)
+write_blocks(int fd, char *output_filename,
+			 uint8 *buffer, unsigned length,
+			 pg_checksum_context *checksum_ctx)
 {
 	int			wb;
 
-	if ((wb = write(fd, buffer, BLCKSZ)) != BLCKSZ)
+	if ((wb = write(fd, buffer, length)) != length)
 	{
 		if (wb < 0)
 			pg_fatal("could not write file \"%s\": %m", output_filename);
 		else
-			pg_fatal("could not write file \"%s\": wrote only %d of %d bytes",
-					 output_filename, wb, BLCKSZ);
+			pg_fatal("could not write file \"%s\": wrote only %d of %u bytes",
+					 output_filename, wb, length);
 	}
 
 	/* Update the checksum computation. */
-	if (pg_checksum_update(checksum_ctx, buffer, BLCKSZ) < 0)
+	if (pg_checksum_update(checksum_ctx, buffer, length) < 0)
 		pg_fatal("could not update checksum of file \"%s\"",
 				 output_filename);
 }
 
 /*
- * Read a block of data (BLCKSZ bytes) into the buffer.
+ * Read 'length' bytes of data, a multiple of BLCKSZ, into the buffer.
  */
 static void
-read_block(rfile *s, off_t off, uint8 *buffer)
+read_blocks(rfile *s, off_t off, uint8 *buffer, unsigned length)
 {
 	int			rb;
 
-	/* Read the block from the correct source, except if dry-run. */
-	rb = pg_pread(s->fd, buffer, BLCKSZ, off);
-	if (rb != BLCKSZ)
+	/* Read the blocks from the correct source, except if dry-run. */
+	rb = pg_pread(s->fd, buffer, length, off);
+	if (rb != length)
 	{
 		if (rb < 0)
 			pg_fatal("could not read file \"%s\": %m", s->filename);
 		else
-			pg_fatal("could not read file \"%s\": read only %d of %d bytes at offset %llu",
-					 s->filename, rb, BLCKSZ,
+			pg_fatal("could not read file \"%s\": read only %d of %u bytes at offset %llu",
+					 s->filename, rb, length,
 					 (unsigned long long) off);
 	}
 }
@@ -21,7 +21,10 @@
  *
  * The leader process dispatches an individual work item to one of the worker
  * processes in DispatchJobForTocEntry().  We send a command string such as
- * "DUMP 1234" or "RESTORE 1234", where 1234 is the TocEntry ID.
+ * "DUMP 1234" or "RESTORE 1234 65536 2", where 1234 is the TocEntry ID.
+ * For restore, the command also carries the maintenance_work_mem and
+ * max_parallel_maintenance_workers the leader assigned to the item, which
+ * matter only for index builds.
  * The worker process receives and decodes the command and passes it to the
  * routine pointed to by AH->WorkerJobDumpPtr or AH->WorkerJobRestorePtr,
  * which are routines of the current archive format.  That routine performs
@@ -33,12 +36,13 @@
  *
  * In principle additional archive-format-specific information might be needed
  * in commands or worker status responses, but so far that hasn't proved
- * necessary, since workers have full copies of the ArchiveHandle/TocEntry
- * data structures.  Remember that we have forked off the workers only after
- * we have read in the catalog.  That's why our worker processes can also
- * access the catalog information.  (In the Windows case, the workers are
- * threads in the same process.  To avoid problems, they work with cloned
- * copies of the Archive data structure; see RunWorker().)
+ * necessary, apart from the index build budget, since workers have full
+ * copies of the ArchiveHandle/TocEntry data structures.  Remember that we
+ * have forked off the workers only after we have read in the catalog.  That's
+ * why our worker processes can also access the catalog information.  (In the
+ * Windows case, the workers are threads in the same process.  To avoid
+ * problems, they work with cloned copies of the Archive data structure; see
+ * RunWorker().)
  *
  * In the leader process, the workerStatus field for each worker has one of
  * the following values:
@@ -1111,7 +1115,8 @@ buildWorkerCommand(ArchiveHandle *AH, TocEntry *te, T_Action act,
 	if (act == ACT_DUMP)
 		snprintf(buf, buflen, "DUMP %d", te->dumpId);
 	else if (act == ACT_RESTORE)
-		snprintf(buf, buflen, "RESTORE %d", te->dumpId);
+		snprintf(buf, buflen, "RESTORE %d %d %d", te->dumpId,
+				 te->index_mem_kb, te->index_workers);
 	else
 		Assert(false);
 }
@@ -1124,6 +1129,8 @@ parseWorkerCommand(ArchiveHandle *AH, TocEntry **te, T_Action *act,
 				   const char *msg)
 {
 	DumpId		dumpId;
+	int			index_mem_kb;
+	int			index_workers;
 	int			nBytes;
 
 	if (messageStartsWith(msg, "DUMP "))
@@ -1137,10 +1144,13 @@ parseWorkerCommand(ArchiveHandle *AH, TocEntry **te, T_Action *act,
 	else if (messageStartsWith(msg, "RESTORE "))
 	{
 		*act = ACT_RESTORE;
-		sscanf(msg, "RESTORE %d%n", &dumpId, &nBytes);
+		sscanf(msg, "RESTORE %d %d %d%n", &dumpId,
+			   &index_mem_kb, &index_workers, &nBytes);
 		Assert(nBytes == strlen(msg));
 		*te = getTocEntryByDumpId(AH, dumpId);
 		Assert(*te != NULL);
+		(*te)->index_mem_kb = index_mem_kb;
+		(*te)->index_workers = index_workers;
 	}
 	else
 		pg_fatal("unrecognized command received from leader: \"%s\"",
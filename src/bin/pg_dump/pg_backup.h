@@ -152,6 +152,9 @@ typedef struct _restoreOptions
 
 	bool		single_txn;		/* restore all TOCs in one transaction */
 	int			txn_size;		/* restore this many TOCs per txn, if > 0 */
+	int			index_build_memory; /* MB shared by index builds, if > 0 */
+	int			index_build_workers;	/* parallel maintenance workers shared
+										 * by index builds, if >= 0 */
 
 	bool	   *idWanted;		/* array showing which dump IDs to emit */
 	int			enable_row_security;
@@ -203,6 +206,8 @@ typedef struct _dumpOptions
 
 	int			sequence_data;	/* dump sequence data even in schema-only mode */
 	int			do_nothing;
+	int			table_chunk_size;	/* split table data into chunks of this
+									 * many MB, 0 = don't */
 } DumpOptions;
 
 /*
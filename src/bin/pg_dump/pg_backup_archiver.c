@@ -104,6 +104,11 @@ static void move_to_ready_heap(TocEntry *pending_list,
 							   RestorePass pass);
 static TocEntry *pop_next_work_item(binaryheap *ready_heap,
 									ParallelState *pstate);
+static bool is_index_build(TocEntry *te);
+static void assign_index_build_resources(ArchiveHandle *AH,
+										 ParallelState *pstate,
+										 binaryheap *ready_heap,
+										 TocEntry *te);
 static void mark_dump_job_done(ArchiveHandle *AH,
 							   TocEntry *te,
 							   int status,
@@ -867,7 +872,37 @@ restore_toc_entry(ArchiveHandle *AH, TocEntry *te, bool is_parallel)
 			pg_log_info("creating %s \"%s\"",
 						te->desc, te->tag);
 
-		_printTocEntry(AH, te, false);
+		/*
+		 * Give index builds their share of the index build budget.  When
+		 * restoring serially, one index is built at a time, so it gets all
+		 * of it; parallel workers get what the leader assigned them.
+		 */
+		if (is_index_build(te) &&
+			(ropt->index_build_memory > 0 || ropt->index_build_workers >= 0))
+		{
+			if (!is_parallel)
+			{
+				te->index_mem_kb = ropt->index_build_memory * 1024;
+				te->index_workers = ropt->index_build_workers;
+			}
+			if (ropt->index_build_memory > 0)
+				ahprintf(AH, "SET maintenance_work_mem = '%dkB';\n",
+						 te->index_mem_kb);
+			if (ropt->index_build_workers >= 0)
+				ahprintf(AH, "SET max_parallel_maintenance_workers = %d;\n",
+						 te->index_workers);
+			ahprintf(AH, "\n");
+
+			_printTocEntry(AH, te, false);
+
+			if (ropt->index_build_memory > 0)
+				ahprintf(AH, "RESET maintenance_work_mem;\n");
+			if (ropt->index_build_workers >= 0)
+				ahprintf(AH, "RESET max_parallel_maintenance_workers;\n");
+			ahprintf(AH, "\n");
+		}
+		else
+			_printTocEntry(AH, te, false);
 		defnDumped = true;
 
 		if (strcmp(te->desc, "TABLE") == 0)
@@ -980,10 +1015,13 @@ restore_toc_entry(ArchiveHandle *AH, TocEntry *te, bool is_parallel)
 					 * because some data might get moved across partition
 					 * boundaries, risking deadlock and/or loss of previously
 					 * loaded data.  (We assume that all partitions of a
-					 * partitioned table will be treated the same way.)
+					 * partitioned table will be treated the same way.)  Nor
+					 * when the table's data was dumped in chunks, since the
+					 * TRUNCATE would remove the chunks loaded before.
 					 */
 					use_truncate = is_parallel && te->created &&
-						!is_load_via_partition_root(te);
+						!is_load_via_partition_root(te) &&
+						!te->dataChunk;
 
 					if (use_truncate)
 					{
@@ -1080,6 +1118,7 @@ NewRestoreOptions(void)
 	opts->dumpSections = DUMP_UNSECTIONED;
 	opts->compression_spec.algorithm = PG_COMPRESSION_NONE;
 	opts->compression_spec.level = 0;
+	opts->index_build_workers = -1;
 
 	return opts;
 }
@@ -1226,6 +1265,7 @@ ArchiveEntry(Archive *AHX, CatalogId catalogId, DumpId dumpId,
 	newToc->tablespace = opts->tablespace ? pg_strdup(opts->tablespace) : NULL;
 	newToc->tableam = opts->tableam ? pg_strdup(opts->tableam) : NULL;
 	newToc->relkind = opts->relkind;
+	newToc->dataChunk = opts->dataChunk;
 	newToc->owner = opts->owner ? pg_strdup(opts->owner) : NULL;
 	newToc->desc = pg_strdup(opts->description);
 	newToc->defn = opts->createStmt ? pg_strdup(opts->createStmt) : NULL;
@@ -1961,8 +2001,9 @@ buildTocEntryArrays(ArchiveHandle *AH)
 		/*
 		 * tableDataId provides the TABLE DATA item's dump ID for each TABLE
 		 * TOC entry that has a DATA item.  We compute this by reversing the
-		 * TABLE DATA item's dependency, knowing that a TABLE DATA item has
-		 * just one dependency and it is the TABLE item.
+		 * TABLE DATA item's dependency, knowing that a TABLE DATA item's
+		 * first dependency is the TABLE item.  If the data was split into
+		 * several chunks, use the chunk that depends on all the others.
 		 */
 		if (strcmp(te->desc, "TABLE DATA") == 0 && te->nDeps > 0)
 		{
@@ -1976,7 +2017,9 @@ buildTocEntryArrays(ArchiveHandle *AH)
 			if (tableId <= 0 || tableId > maxDumpId)
 				pg_fatal("bad table dumpId for TABLE DATA item");
 
-			AH->tableDataId[tableId] = te->dumpId;
+			if (AH->tableDataId[tableId] == 0 ||
+				(te->dataChunk && te->nDeps > 1))
+				AH->tableDataId[tableId] = te->dumpId;
 		}
 	}
 }
@@ -2607,6 +2650,7 @@ WriteToc(ArchiveHandle *AH)
 		WriteStr(AH, te->tablespace);
 		WriteStr(AH, te->tableam);
 		WriteInt(AH, te->relkind);
+		WriteInt(AH, te->dataChunk ? 1 : 0);
 		WriteStr(AH, te->owner);
 		WriteStr(AH, "false");
 
@@ -2715,6 +2759,9 @@ ReadToc(ArchiveHandle *AH)
 		if (AH->version >= K_VERS_1_16)
 			te->relkind = ReadInt(AH);
 
+		if (AH->version >= K_VERS_1_17)
+			te->dataChunk = (ReadInt(AH) != 0);
+
 		te->owner = ReadStr(AH);
 		is_supported = true;
 		if (AH->version < K_VERS_1_9)
@@ -4306,6 +4353,9 @@ restore_toc_entries_parallel(ArchiveHandle *AH, ParallelState *pstate,
 				continue;
 			}
 
+			assign_index_build_resources(AH, pstate, ready_heap,
+										 next_work_item);
+
 			pg_log_info("launching item %d %s %s",
 						next_work_item->dumpId,
 						next_work_item->desc, next_work_item->tag);
@@ -4579,6 +4629,109 @@ pop_next_work_item(binaryheap *ready_heap,
 	return NULL;
 }
 
+/*
+ * Does restoring this item's schema build an index?
+ *
+ * "CONSTRAINT" items are primary key, unique and exclusion constraints, each
+ * of which builds an index; foreign keys are "FK CONSTRAINT" items.
+ */
+static bool
+is_index_build(TocEntry *te)
+{
+	return (strcmp(te->desc, "INDEX") == 0 ||
+			strcmp(te->desc, "CONSTRAINT") == 0);
+}
+
+/*
+ * Decide on the maintenance_work_mem and max_parallel_maintenance_workers
+ * that an index build about to be dispatched may use.
+ *
+ * The --index-build-memory and --index-build-workers budgets are shared by
+ * all index builds running at the same time.  The item gets a part of what
+ * the running builds have left over, in proportion to its size compared to
+ * the index builds that are ready to go and could take the other idle
+ * workers.  Thus a large index that's built while only small ones remain
+ * gets most of the budget and can use parallel workers, while a batch of
+ * similar indexes splits it evenly.
+ *
+ * An index build is always given at least 1MB, the lowest value allowed for
+ * maintenance_work_mem, so a small budget can be overrun.  The server only
+ * uses as many parallel workers as leave 32MB for each participant, so we
+ * cap the number of workers the same way to avoid reserving workers that
+ * would not be used.
+ */
+static void
+assign_index_build_resources(ArchiveHandle *AH, ParallelState *pstate,
+							 binaryheap *ready_heap, TocEntry *te)
+{
+	RestoreOptions *ropt = AH->public.ropt;
+	int64		mem_avail = (int64) ropt->index_build_memory * 1024;
+	int			workers_avail = ropt->index_build_workers;
+	int			idle = 0;
+	int			nitems = 1;
+	double		total_size;
+	double		share;
+	int64		mem_kb;
+	int			workers;
+
+	if (!is_index_build(te) || (te->reqs & REQ_SCHEMA) == 0 ||
+		(ropt->index_build_memory <= 0 && ropt->index_build_workers < 0))
+		return;
+
+	/* Subtract what the index builds already running are using */
+	for (int k = 0; k < pstate->numWorkers; k++)
+	{
+		TocEntry   *running_te = pstate->te[k];
+
+		if (running_te == NULL)
+		{
+			idle++;
+			continue;
+		}
+		if (is_index_build(running_te) && (running_te->reqs & REQ_SCHEMA))
+		{
+			mem_avail -= running_te->index_mem_kb;
+			workers_avail -= running_te->index_workers;
+		}
+	}
+	mem_avail = Max(mem_avail, 0);
+	workers_avail = Max(workers_avail, 0);
+
+	/*
+	 * Add up the sizes of the index builds that could be dispatched to the
+	 * other idle workers next.  The heap isn't fully sorted, but its first
+	 * few nodes are the largest items.
+	 */
+	total_size = te->dataLength;
+	for (int i = 0; i < binaryheap_size(ready_heap) && nitems < idle; i++)
+	{
+		TocEntry   *other_te = (TocEntry *) binaryheap_get_node(ready_heap, i);
+
+		if (is_index_build(other_te) && (other_te->reqs & REQ_SCHEMA))
+		{
+			total_size += other_te->dataLength;
+			nitems++;
+		}
+	}
+
+	if (total_size > 0)
+		share = te->dataLength / total_size;
+	else
+		share = 1.0 / nitems;
+
+	mem_kb = Max((int64) (mem_avail * share), 1024);
+	workers = (int) (workers_avail * share);
+	if (ropt->index_build_memory > 0)
+		workers = Min(workers, Max(mem_kb / (32 * 1024) - 1, 0));
+
+	te->index_mem_kb = (int) Min(mem_kb, INT_MAX);
+	te->index_workers = workers;
+
+	pg_log_debug("assigning %d kB and %d parallel workers to item %d %s %s",
+				 te->index_mem_kb, te->index_workers,
+				 te->dumpId, te->desc, te->tag);
+}
+
 
 /*
  * Restore a single TOC item in parallel with others
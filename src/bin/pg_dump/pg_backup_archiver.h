@@ -71,10 +71,12 @@
 #define K_VERS_1_16 MAKE_ARCHIVE_VERSION(1, 16, 0)	/* BLOB METADATA entries
 													 * and multiple BLOBS,
 													 * relkind */
+#define K_VERS_1_17 MAKE_ARCHIVE_VERSION(1, 17, 0)	/* add TABLE DATA chunk
+													 * indicator */
 
 /* Current archive version number (the format we can output) */
 #define K_VERS_MAJOR 1
-#define K_VERS_MINOR 16
+#define K_VERS_MINOR 17
 #define K_VERS_REV 0
 #define K_VERS_SELF MAKE_ARCHIVE_VERSION(K_VERS_MAJOR, K_VERS_MINOR, K_VERS_REV)
 
@@ -355,6 +357,8 @@ struct _tocEntry
 								 * means use database default */
 	char	   *tableam;		/* table access method, only for TABLE tags */
 	char		relkind;		/* relation kind, only for TABLE tags */
+	bool		dataChunk;		/* TABLE DATA item holds only part of the
+								 * table's data */
 	char	   *owner;
 	char	   *desc;
 	char	   *defn;
@@ -372,6 +376,8 @@ struct _tocEntry
 	int			reqs;			/* do we need schema and/or data of object
 								 * (REQ_* bit mask) */
 	bool		created;		/* set for DATA member if TABLE was created */
+	int			index_mem_kb;	/* maintenance_work_mem for an index build */
+	int			index_workers;	/* max_parallel_maintenance_workers for it */
 
 	/* working state (needed only for parallel restore) */
 	struct _tocEntry *pending_prev; /* list links for pending-items list; */
@@ -396,6 +402,7 @@ typedef struct _archiveOpts
 	const char *tablespace;
 	const char *tableam;
 	char		relkind;
+	bool		dataChunk;
 	const char *owner;
 	const char *description;
 	teSection	section;
@@ -145,6 +145,9 @@ static const CatalogId nilCatalogId = {0, 0};
 static bool have_extra_float_digits = false;
 static int	extra_float_digits;
 
+/* --table-chunk-size converted to pages of the server, 0 if not chunking */
+static BlockNumber table_chunk_pages = 0;
+
 /* sorted table of role names */
 static RoleNameItem *rolenames = NULL;
 static int	nrolenames = 0;
@@ -448,6 +451,7 @@ main(int argc, char **argv)
 		{"sync-method", required_argument, NULL, 15},
 		{"filter", required_argument, NULL, 16},
 		{"exclude-extension", required_argument, NULL, 17},
+		{"table-chunk-size", required_argument, NULL, 18},
 
 		{NULL, 0, NULL, 0}
 	};
@@ -688,6 +692,12 @@ main(int argc, char **argv)
 										  optarg);
 				break;
 
+			case 18:			/* table chunk size */
+				if (!option_parse_int(optarg, "--table-chunk-size", 1, INT_MAX,
+									  &dopt.table_chunk_size))
+					exit_nicely(1);
+				break;
+
 			default:
 				/* getopt_long already emitted a complaint */
 				pg_log_error_hint("Try \"%s --help\" for more information.", progname);
@@ -843,6 +853,29 @@ main(int argc, char **argv)
 	if (fout->isStandby)
 		dopt.no_unlogged_table_data = true;
 
+	/*
+	 * Chunks are read with TID range scans, which need 14 or later.  The
+	 * chunk size has to be converted using the server's block size.
+	 */
+	if (dopt.table_chunk_size > 0)
+	{
+		if (fout->remoteVersion < 140000)
+			pg_log_warning("--table-chunk-size is ignored for servers older than version 14");
+		else
+		{
+			PGresult   *res;
+			uint64		block_size;
+
+			res = ExecuteSqlQueryForSingleRow(fout,
+											  "SELECT current_setting('block_size')");
+			block_size = strtoul(PQgetvalue(res, 0, 0), NULL, 10);
+			PQclear(res);
+
+			table_chunk_pages = Max((uint64) dopt.table_chunk_size * 1024 * 1024 /
+									block_size, 1);
+		}
+	}
+
 	/*
 	 * Find the last built-in OID, if needed (prior to 8.1)
 	 *
@@ -1166,6 +1199,8 @@ help(const char *progname)
 			 "                               match at least one entity each\n"));
 	printf(_("  --table-and-children=PATTERN dump only the specified table(s), including\n"
 			 "                               child and partition tables\n"));
+	printf(_("  --table-chunk-size=SIZE      dump data of tables larger than SIZE megabytes\n"
+			 "                               in several parts\n"));
 	printf(_("  --use-set-session-authorization\n"
 			 "                               use SET SESSION AUTHORIZATION commands instead of\n"
 			 "                               ALTER OWNER commands to set ownership\n"));
@@ -2157,7 +2192,8 @@ dumpTableData_copy(Archive *fout, const void *dcontext)
 	/*
 	 * Use COPY (SELECT ...) TO when dumping a foreign table's data, and when
 	 * a filter condition was specified.  For other cases a simple COPY
-	 * suffices.
+	 * suffices.  Like the simple COPY, the SELECT must not include rows of
+	 * child tables.
 	 */
 	if (tdinfo->filtercond || tbinfo->relkind == RELKIND_FOREIGN_TABLE)
 	{
@@ -2171,7 +2207,7 @@ dumpTableData_copy(Archive *fout, const void *dcontext)
 		else
 			appendPQExpBufferStr(q, "* ");
 
-		appendPQExpBuffer(q, "FROM %s %s) TO stdout;",
+		appendPQExpBuffer(q, "FROM ONLY %s %s) TO stdout;",
 						  fmtQualifiedDumpable(tbinfo),
 						  tdinfo->filtercond ? tdinfo->filtercond : "");
 	}
@@ -2659,6 +2695,68 @@ dumpTableData(Archive *fout, const TableDataInfo *tdinfo)
 	if (tdinfo->dobj.dump & DUMP_COMPONENT_DATA)
 	{
 		TocEntry   *te;
+		BlockNumber relpages = (BlockNumber) tbinfo->relpages;
+		const TableDataInfo *lastinfo = tdinfo;
+		DumpId	   *deps = &(tbinfo->dobj.dumpId);
+		int			nDeps = 1;
+		bool		chunked = false;
+
+		/*
+		 * With --table-chunk-size, split the data of a large table into
+		 * several TABLE DATA items, each covering a range of blocks, so that
+		 * parallel dump and restore can work on them concurrently.  The item
+		 * with this TableDataInfo's dump ID covers the last range and depends
+		 * on all the others, so that objects depending on the table's data
+		 * wait for all of it to be restored.  The ranges are based on
+		 * relpages, so the last one is open-ended to cover blocks added since
+		 * the table was last vacuumed or analyzed.
+		 */
+		if (table_chunk_pages > 0 && relpages > table_chunk_pages &&
+			tbinfo->relkind == RELKIND_RELATION &&
+			tdinfo->filtercond == NULL &&
+			tbinfo->amname != NULL && strcmp(tbinfo->amname, "heap") == 0)
+		{
+			int			nchunks = (relpages + table_chunk_pages - 1) / table_chunk_pages;
+			TableDataInfo *chunkinfo;
+
+			chunked = true;
+			deps = pg_malloc_array(DumpId, nchunks);
+			deps[0] = tbinfo->dobj.dumpId;
+
+			for (int i = 0; i < nchunks - 1; i++)
+			{
+				DumpId		chunkId = createDumpId();
+
+				chunkinfo = pg_malloc_object(TableDataInfo);
+				*chunkinfo = *tdinfo;
+				chunkinfo->filtercond =
+					psprintf("WHERE ctid >= '(%u,0)' AND ctid < '(%u,0)'",
+							 i * table_chunk_pages,
+							 (i + 1) * table_chunk_pages);
+
+				te = ArchiveEntry(fout, tdinfo->dobj.catId, chunkId,
+								  ARCHIVE_OPTS(.tag = tbinfo->dobj.name,
+											   .namespace = tbinfo->dobj.namespace->dobj.name,
+											   .owner = tbinfo->rolname,
+											   .description = "TABLE DATA",
+											   .section = SECTION_DATA,
+											   .dataChunk = true,
+											   .createStmt = tdDefn,
+											   .copyStmt = copyStmt,
+											   .deps = &(tbinfo->dobj.dumpId),
+											   .nDeps = 1,
+											   .dumpFn = dumpFn,
+											   .dumpArg = chunkinfo));
+				te->dataLength = table_chunk_pages;
+				deps[nDeps++] = chunkId;
+			}
+
+			chunkinfo = pg_malloc_object(TableDataInfo);
+			*chunkinfo = *tdinfo;
+			chunkinfo->filtercond = psprintf("WHERE ctid >= '(%u,0)'",
+											 (nchunks - 1) * table_chunk_pages);
+			lastinfo = chunkinfo;
+		}
 
 		te = ArchiveEntry(fout, tdinfo->dobj.catId, tdinfo->dobj.dumpId,
 						  ARCHIVE_OPTS(.tag = tbinfo->dobj.name,
@@ -2666,12 +2764,13 @@ dumpTableData(Archive *fout, const TableDataInfo *tdinfo)
 									   .owner = tbinfo->rolname,
 									   .description = "TABLE DATA",
 									   .section = SECTION_DATA,
+									   .dataChunk = chunked,
 									   .createStmt = tdDefn,
 									   .copyStmt = copyStmt,
-									   .deps = &(tbinfo->dobj.dumpId),
-									   .nDeps = 1,
+									   .deps = deps,
+									   .nDeps = nDeps,
 									   .dumpFn = dumpFn,
-									   .dumpArg = tdinfo));
+									   .dumpArg = lastinfo));
 
 		/*
 		 * Set the TocEntry's dataLength in case we are doing a parallel dump
@@ -16670,6 +16769,9 @@ dumpTableSchema(Archive *fout, const TableInfo *tbinfo)
 					case 'l':
 						cmname = "lz4";
 						break;
+					case 'z':
+						cmname = "zstd";
+						break;
 					default:
 						cmname = NULL;
 						break;
@@ -114,6 +114,8 @@ main(int argc, char **argv)
 		{"disable-triggers", no_argument, &disable_triggers, 1},
 		{"enable-row-security", no_argument, &enable_row_security, 1},
 		{"if-exists", no_argument, &if_exists, 1},
+		{"index-build-memory", required_argument, NULL, 6},
+		{"index-build-workers", required_argument, NULL, 7},
 		{"no-data-for-failed-tables", no_argument, &no_data_for_failed_tables, 1},
 		{"no-table-access-method", no_argument, &outputNoTableAm, 1},
 		{"no-tablespaces", no_argument, &outputNoTablespaces, 1},
@@ -302,6 +304,20 @@ main(int argc, char **argv)
 				opts->exit_on_error = true;
 				break;
 
+			case 6:				/* index-build-memory */
+				if (!option_parse_int(optarg, "--index-build-memory",
+									  1, INT_MAX / 1024,
+									  &opts->index_build_memory))
+					exit(1);
+				break;
+
+			case 7:				/* index-build-workers */
+				if (!option_parse_int(optarg, "--index-build-workers",
+									  0, 1024,
+									  &opts->index_build_workers))
+					exit(1);
+				break;
+
 			default:
 				/* getopt_long already emitted a complaint */
 				pg_log_error_hint("Try \"%s --help\" for more information.", progname);
@@ -485,6 +501,10 @@ usage(const char *progname)
 	printf(_("  --filter=FILENAME            restore or skip objects based on expressions\n"
 			 "                               in FILENAME\n"));
 	printf(_("  --if-exists                  use IF EXISTS when dropping objects\n"));
+	printf(_("  --index-build-memory=MB      share this much maintenance_work_mem among\n"
+			 "                               concurrent index builds\n"));
+	printf(_("  --index-build-workers=NUM    share this many parallel maintenance workers\n"
+			 "                               among concurrent index builds\n"));
 	printf(_("  --no-comments                do not restore comments\n"));
 	printf(_("  --no-data-for-failed-tables  do not restore data of tables that could not be\n"
 			 "                               created\n"));
@@ -115,6 +115,21 @@ command_fails_like(
 	qr/\Qpg_restore: error: -j\/--jobs must be in range\E/,
 	'pg_restore: -j/--jobs must be in range');
 
+command_fails_like(
+	[ 'pg_restore', '--index-build-memory=0', '-f -' ],
+	qr/\Qpg_restore: error: --index-build-memory must be in range\E/,
+	'pg_restore: --index-build-memory must be in range');
+
+command_fails_like(
+	[ 'pg_restore', '--index-build-workers=-1', '-f -' ],
+	qr/\Qpg_restore: error: --index-build-workers must be in range\E/,
+	'pg_restore: --index-build-workers must be in range');
+
+command_fails_like(
+	[ 'pg_restore', '--index-build-workers=1025', '-f -' ],
+	qr/\Qpg_restore: error: --index-build-workers must be in range\E/,
+	'pg_restore: --index-build-workers must be at most 1024');
+
 command_fails_like(
 	[ 'pg_restore', '--single-transaction', '-j3', '-f -' ],
 	qr/\Qpg_restore: error: cannot specify both --single-transaction and multiple jobs\E/,
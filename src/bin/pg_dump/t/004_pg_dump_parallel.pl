@@ -11,6 +11,8 @@ use Test::More;
 my $dbname1 = 'regression_src';
 my $dbname2 = 'regression_dest1';
 my $dbname3 = 'regression_dest2';
+my $dbname4 = 'regression_dest3';
+my $dbname5 = 'regression_dest4';
 
 my $node = PostgreSQL::Test::Cluster->new('main');
 $node->init;
@@ -21,6 +23,8 @@ my $backupdir = $node->backup_dir;
 $node->run_log([ 'createdb', $dbname1 ]);
 $node->run_log([ 'createdb', $dbname2 ]);
 $node->run_log([ 'createdb', $dbname3 ]);
+$node->run_log([ 'createdb', $dbname4 ]);
+$node->run_log([ 'createdb', $dbname5 ]);
 
 $node->safe_psql(
 	$dbname1,
@@ -44,6 +48,11 @@ create table tht_p1 partition of tht for values with (modulus 3, remainder 0);
 create table tht_p2 partition of tht for values with (modulus 3, remainder 1);
 create table tht_p3 partition of tht for values with (modulus 3, remainder 2);
 insert into tht select (x%10)::text::digit, x from generate_series(1,1000) x;
+
+-- table large enough to be dumped in chunks
+create table tbig (id int primary key, filler text);
+insert into tbig select x, repeat('x', 100) from generate_series(1,30000) x;
+vacuum analyze tbig;
 	});
 
 $node->command_ok(
@@ -78,4 +87,67 @@ $node->command_ok(
 	],
 	'parallel restore as inserts');
 
+$node->command_ok(
+	[
+		'pg_dump', '-Fd',
+		'--no-sync', '-j2',
+		'-f', "$backupdir/dump3",
+		'--table-chunk-size=1', $node->connstr($dbname1)
+	],
+	'parallel dump in table chunks');
+
+my ($toc) = run_command([ 'pg_restore', '-l', "$backupdir/dump3" ]);
+my $nchunks = () = $toc =~ /TABLE DATA public tbig /g;
+cmp_ok($nchunks, '>', 1, 'table data dumped in several chunks');
+
+$node->command_ok(
+	[
+		'pg_restore', '-v',
+		'-d', $node->connstr($dbname4),
+		'-j3', "$backupdir/dump3"
+	],
+	'parallel restore of table chunks');
+
+is( $node->safe_psql($dbname4, 'select count(*), sum(id) from tbig'),
+	$node->safe_psql($dbname1, 'select count(*), sum(id) from tbig'),
+	'all chunks of table restored');
+
+# A serial restore gives each index build the whole budget
+$node->command_like(
+	[
+		'pg_restore', '-f', '-',
+		'--index-build-memory=64', '--index-build-workers=2',
+		"$backupdir/dump3"
+	],
+	qr/SET\ maintenance_work_mem\ =\ '65536kB';\n
+	   SET\ max_parallel_maintenance_workers\ =\ 2;\n
+	   (?:(?!RESET).)*
+	   ADD\ CONSTRAINT\ tbig_pkey\ PRIMARY\ KEY\ \(id\);\n
+	   \s*
+	   RESET\ maintenance_work_mem;\n
+	   RESET\ max_parallel_maintenance_workers;/xs,
+	'serial restore with index build budget');
+
+# In a parallel restore, the leader hands out shares of the budget
+$node->command_checks_all(
+	[
+		'pg_restore', '-v', '-v',
+		'--index-build-memory=64', '--index-build-workers=2',
+		'-d', $node->connstr($dbname5),
+		'-j3', "$backupdir/dump3"
+	],
+	0,
+	[qr/^$/],
+	[
+		qr/assigning \d+ kB and \d+ parallel workers to item \d+ CONSTRAINT tbig tbig_pkey/
+	],
+	'parallel restore with index build budget');
+
+is( $node->safe_psql(
+		$dbname5,
+		"select count(*) from pg_index where indrelid = 'tbig'::regclass and indisvalid"
+	),
+	'1',
+	'index built in parallel restore with index build budget');
+
 done_testing();
@@ -32,6 +32,9 @@ main(int argc, char *argv[])
 
 	handle_args(argc, argv);
 
+	/* measure the same time source the server would use */
+	pg_initialize_timing();
+
 	loop_count = test_timing(test_duration);
 
 	output(loop_count);
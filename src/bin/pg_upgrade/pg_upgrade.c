@@ -534,6 +534,8 @@ static void
 create_new_objects(void)
 {
 	int			dbnum;
+	int			ndbs = 0;
+	int			restore_jobs = 1;
 
 	prep_status_progress("Restoring database schemas in the new cluster");
 
@@ -569,18 +571,34 @@ create_new_objects(void)
 				  true,
 				  true,
 				  "\"%s/pg_restore\" %s %s --exit-on-error --verbose "
-				  "--transaction-size=%d "
+				  "--transaction-size=%d --jobs=%d "
 				  "--dbname postgres \"%s/%s\"",
 				  new_cluster.bindir,
 				  cluster_conn_opts(&new_cluster),
 				  create_opts,
 				  RESTORE_TRANSACTION_SIZE,
+				  user_opts.jobs,
 				  log_opts.dumpdir,
 				  sql_file_name);
 
 		break;					/* done once we've processed template1 */
 	}
 
+	/*
+	 * If there are fewer remaining databases than jobs, some of the jobs
+	 * would sit idle, so let each pg_restore use several connections
+	 * instead.  That matters most for a single database with many objects.
+	 * pg_restore still creates the pre-data objects, such as tables, over
+	 * one connection, but it builds the indexes and constraints in parallel.
+	 */
+	for (dbnum = 0; dbnum < old_cluster.dbarr.ndbs; dbnum++)
+	{
+		if (strcmp(old_cluster.dbarr.dbs[dbnum].db_name, "template1") != 0)
+			ndbs++;
+	}
+	if (ndbs > 0 && user_opts.jobs > ndbs)
+		restore_jobs = user_opts.jobs / ndbs;
+
 	for (dbnum = 0; dbnum < old_cluster.dbarr.ndbs; dbnum++)
 	{
 		char		sql_file_name[MAXPGPATH],
@@ -623,12 +641,13 @@ create_new_objects(void)
 		parallel_exec_prog(log_file_name,
 						   NULL,
 						   "\"%s/pg_restore\" %s %s --exit-on-error --verbose "
-						   "--transaction-size=%d "
+						   "--transaction-size=%d --jobs=%d "
 						   "--dbname template1 \"%s/%s\"",
 						   new_cluster.bindir,
 						   cluster_conn_opts(&new_cluster),
 						   create_opts,
 						   txn_size,
+						   restore_jobs,
 						   log_opts.dumpdir,
 						   sql_file_name);
 	}
@@ -391,6 +391,7 @@ WALDumpReadPage(XLogReaderState *state, XLogRecPtr targetPagePtr, int reqLen,
 {
 	XLogDumpPrivate *private = state->private_data;
 	int			count = XLOG_BLCKSZ;
+	XLogRecPtr	upto;
 	WALReadError errinfo;
 
 	if (private->endptr != InvalidXLogRecPtr)
@@ -406,8 +407,17 @@ WALDumpReadPage(XLogReaderState *state, XLogRecPtr targetPagePtr, int reqLen,
 		}
 	}
 
-	if (!WALRead(state, readBuff, targetPagePtr, count, private->timeline,
-				 &errinfo))
+	/*
+	 * Without an end point, we might be following WAL that is still being
+	 * written, so don't read ahead past the requested page.
+	 */
+	if (private->endptr != InvalidXLogRecPtr)
+		upto = private->endptr;
+	else
+		upto = targetPagePtr + count;
+
+	if (!WALReadBuffered(state, readBuff, targetPagePtr, count, upto,
+						 private->timeline, &errinfo))
 	{
 		WALOpenSegment *seg = &errinfo.wre_seg;
 		char		fname[MAXPGPATH];
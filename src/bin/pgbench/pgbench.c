@@ -202,6 +202,23 @@ double		sample_rate = 0.0;
  */
 double		throttle_delay = 0;
 
+/*
+ * With --phase, the run is divided into consecutive phases that each have
+ * their own target rate.  'end' is the end of the phase in usec from the
+ * start of the benchmark, and 'delay' the per-thread throttle delay to use
+ * during it, like throttle_delay.
+ */
+typedef struct RatePhase
+{
+	int64		end;
+	double		delay;
+} RatePhase;
+
+#define MAX_RATE_PHASES		64
+
+static RatePhase rate_phases[MAX_RATE_PHASES];
+static int	num_rate_phases = 0;
+
 /*
  * Transactions which take longer than this limit (in usec) are counted as
  * late, and reported as such, although they are completed anyway. When
@@ -259,6 +276,8 @@ bool		use_quiet;			/* quiet logging onto stderr */
 int			agg_interval;		/* log aggregates instead of individual
 								 * transactions */
 bool		per_script_stats = false;	/* whether to collect stats per script */
+bool		latency_percentiles = false;	/* whether to report latency
+											 * percentiles */
 int			progress = 0;		/* thread progress report every this seconds */
 bool		progress_timestamp = false; /* progress report with Unix time */
 int			nclients = 1;		/* number of clients */
@@ -369,6 +388,22 @@ typedef struct SimpleStats
  */
 typedef int64 pg_time_usec_t;
 
+/*
+ * Histogram of transaction latencies, used to report percentiles.
+ *
+ * Latencies (in usec) below 2^LATENCY_HIST_SUB_BITS get a bucket each.
+ * Above that, every power of two is split into 2^(LATENCY_HIST_SUB_BITS - 1)
+ * equally wide buckets, so a bucket is never wider than about 6% of the
+ * values it holds, whatever their magnitude.  This is the same layout as an
+ * HDR histogram with roughly one and a half significant digits.  Latencies
+ * above 2^LATENCY_HIST_MAX_BITS usec (about 12 days) go in the last bucket.
+ */
+#define LATENCY_HIST_SUB_BITS	5
+#define LATENCY_HIST_MAX_BITS	40
+#define LATENCY_HIST_BUCKETS \
+	((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS) * \
+	 (1 << (LATENCY_HIST_SUB_BITS - 1)) + (1 << LATENCY_HIST_SUB_BITS))
+
 /*
  * Data structure to hold various statistics: per-thread and per-script stats
  * are maintained and merged together.
@@ -440,6 +475,8 @@ typedef struct StatsData
 									 * error */
 	SimpleStats latency;
 	SimpleStats lag;
+	int64		latency_hist[LATENCY_HIST_BUCKETS]; /* only with
+													 * --latency-percentiles */
 } StatsData;
 
 /*
@@ -884,6 +921,7 @@ usage(void)
 		   "                           p: create primary key indexes on the standard tables\n"
 		   "                           f: create foreign keys between the standard tables\n"
 		   "  -F, --fillfactor=NUM     set fill factor\n"
+		   "  -j, --jobs=NUM           number of connections for server-side data generation\n"
 		   "  -n, --no-vacuum          do not run VACUUM during initialization\n"
 		   "  -q, --quiet              quiet logging (one message each 5 seconds)\n"
 		   "  -s, --scale=NUM          scaling factor\n"
@@ -924,9 +962,12 @@ usage(void)
 		   "  --aggregate-interval=NUM aggregate data over NUM seconds\n"
 		   "  --exit-on-abort          exit when any client is aborted\n"
 		   "  --failures-detailed      report the failures grouped by basic types\n"
+		   "  --latency-percentiles    report latency percentiles\n"
 		   "  --log-prefix=PREFIX      prefix for transaction time log file\n"
 		   "                           (default: \"pgbench_log\")\n"
 		   "  --max-tries=NUM          max number of tries to run transaction (default: 1)\n"
+		   "  --phase=SECONDS:RATE     run for SECONDS at RATE transactions per second;\n"
+		   "                           repeat to run several phases one after another\n"
 		   "  --progress-timestamp     use Unix epoch timestamps for progress\n"
 		   "  --random-seed=SEED       set random seed (\"time\", \"rand\", integer)\n"
 		   "  --sampling-rate=NUM      fraction of transactions to log (e.g., 0.01 for 1%%)\n"
@@ -1190,6 +1231,26 @@ getPoissonRand(pg_prng_state *state, double center)
 	return (int64) (-log(uniform) * center + 0.5);
 }
 
+/*
+ * Return the throttle delay to use for the next transaction slot of the
+ * given thread: that of the phase the previous slot fell in under --phase,
+ * or simply throttle_delay.
+ */
+static double
+getThrottleDelay(TState *thread)
+{
+	int64		elapsed = thread->throttle_trigger - thread->bench_start;
+
+	for (int i = 0; i < num_rate_phases; i++)
+	{
+		if (elapsed < rate_phases[i].end)
+			return rate_phases[i].delay;
+	}
+
+	return num_rate_phases > 0 ?
+		rate_phases[num_rate_phases - 1].delay : throttle_delay;
+}
+
 /*
  * Computing zipfian using rejection method, based on
  * "Non-Uniform Random Variate Generation",
@@ -1426,6 +1487,67 @@ mergeSimpleStats(SimpleStats *acc, SimpleStats *ss)
 	acc->sum2 += ss->sum2;
 }
 
+/*
+ * Return the latency histogram bucket for the given latency in usec.
+ */
+static int
+getLatencyHistBucket(double latency)
+{
+	uint64		val;
+	int			msb;
+	int			shift;
+
+	if (latency <= 0)
+		return 0;
+	if (latency >= (double) (UINT64CONST(1) << LATENCY_HIST_MAX_BITS))
+		return LATENCY_HIST_BUCKETS - 1;
+
+	val = (uint64) latency;
+	if (val < (1 << LATENCY_HIST_SUB_BITS))
+		return (int) val;
+
+	msb = pg_leftmost_one_pos64(val);
+	shift = msb - LATENCY_HIST_SUB_BITS + 1;
+	return shift * (1 << (LATENCY_HIST_SUB_BITS - 1)) + (int) (val >> shift);
+}
+
+/*
+ * Return the midpoint of the values that fall in the given bucket, in usec.
+ */
+static double
+getLatencyHistValue(int bucket)
+{
+	int			half = 1 << (LATENCY_HIST_SUB_BITS - 1);
+	int			shift;
+	uint64		low;
+
+	if (bucket < (1 << LATENCY_HIST_SUB_BITS))
+		return bucket + 0.5;
+
+	shift = bucket / half - 1;
+	low = (uint64) (bucket - shift * half) << shift;
+	return low + (double) (UINT64CONST(1) << shift) / 2;
+}
+
+/*
+ * Return the latency at or below which the given fraction of the
+ * transactions counted in the histogram completed.
+ */
+static double
+getLatencyPercentile(const int64 *hist, int64 count, double fraction)
+{
+	int64		target = (int64) ceil(fraction * count);
+	int64		seen = 0;
+
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+	{
+		seen += hist[i];
+		if (seen >= target && seen > 0)
+			return getLatencyHistValue(i);
+	}
+	return 0.0;
+}
+
 /*
  * Initialize a StatsData struct to mostly zeroes, with its start time set to
  * the given value.
@@ -1442,6 +1564,7 @@ initStats(StatsData *sd, pg_time_usec_t start)
 	sd->deadlock_failures = 0;
 	initSimpleStats(&sd->latency);
 	initSimpleStats(&sd->lag);
+	memset(sd->latency_hist, 0, sizeof(sd->latency_hist));
 }
 
 /*
@@ -1476,6 +1599,8 @@ accumStats(StatsData *stats, bool skipped, double lat, double lag,
 			stats->cnt++;
 
 			addToSimpleStats(&stats->latency, lat);
+			if (latency_percentiles)
+				stats->latency_hist[getLatencyHistBucket(lat)]++;
 
 			/* and possibly the same for schedule lag */
 			if (throttle_delay)
@@ -3703,7 +3828,8 @@ advanceConnectionState(TState *thread, CState *st, StatsData *agg)
 				Assert(throttle_delay > 0);
 
 				thread->throttle_trigger +=
-					getPoissonRand(&thread->ts_throttle_rs, throttle_delay);
+					getPoissonRand(&thread->ts_throttle_rs,
+								   getThrottleDelay(thread));
 				st->txn_scheduled = thread->throttle_trigger;
 
 				/*
@@ -4669,7 +4795,7 @@ processXactStats(TState *thread, CState *st, pg_time_usec_t *now,
 	double		latency = 0.0,
 				lag = 0.0;
 	bool		detailed = progress || throttle_delay || latency_limit ||
-		use_log || per_script_stats;
+		use_log || per_script_stats || latency_percentiles;
 
 	if (detailed && !skipped && st->estatus == ESTATUS_NO_ERROR)
 	{
@@ -5070,6 +5196,71 @@ initGenerateDataClientSide(PGconn *con)
 	executeStatement(con, "commit");
 }
 
+/*
+ * Fill pgbench_accounts on the server using -j connections at once, each
+ * inserting its own range of aids.
+ *
+ * With range partitioning, the ranges are made to cover whole partitions, so
+ * that each partition is loaded by a single connection.
+ */
+static void
+initGenerateAccountsParallel(PQExpBufferData *sql)
+{
+	int64		total = (int64) naccounts * scale;
+	int64		chunk = (total + nthreads - 1) / nthreads;
+	PGconn	  **conns = pg_malloc_array(PGconn *, nthreads);
+	int			nconns = 0;
+
+	if (partition_method == PART_RANGE)
+	{
+		int64		part_size = (total + partitions - 1) / partitions;
+
+		chunk = (chunk + part_size - 1) / part_size * part_size;
+	}
+
+	for (int64 low = 1; low <= total; low += chunk)
+	{
+		PGconn	   *con;
+
+		if ((con = doConnect()) == NULL)
+			pg_fatal("could not create connection for initialization");
+
+		printfPQExpBuffer(sql,
+						  "insert into pgbench_accounts(aid,bid,abalance,filler) "
+						  "select aid, (aid - 1) / %d + 1, 0, '' "
+						  "from generate_series(" INT64_FORMAT ", " INT64_FORMAT ") as aid",
+						  naccounts, low, Min(low + chunk - 1, total));
+		if (!PQsendQuery(con, sql->data))
+		{
+			pg_log_error("query failed: %s", PQerrorMessage(con));
+			pg_log_error_detail("Query was: %s", sql->data);
+			exit(1);
+		}
+		conns[nconns++] = con;
+	}
+
+	fprintf(stderr, "loading pgbench_accounts using %d connections...\n", nconns);
+
+	/* the inserts now run concurrently, wait for all of them to finish */
+	for (int i = 0; i < nconns; i++)
+	{
+		PGresult   *res;
+
+		while ((res = PQgetResult(conns[i])) != NULL)
+		{
+			if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			{
+				pg_log_error("query failed: %s", PQerrorMessage(conns[i]));
+				exit(1);
+			}
+			PQclear(res);
+		}
+		PQfinish(conns[i]);
+	}
+
+	pg_free(conns);
+}
+
 /*
  * Fill the standard tables with some data generated on the server
  *
@@ -5107,16 +5298,27 @@ initGenerateDataServerSide(PGconn *con)
 					  "from generate_series(1, %d) as tid", ntellers, ntellers * scale);
 	executeStatement(con, sql.data);
 
-	printfPQExpBuffer(&sql,
-					  "insert into pgbench_accounts(aid,bid,abalance,filler) "
-					  "select aid, (aid - 1) / %d + 1, 0, '' "
-					  "from generate_series(1, " INT64_FORMAT ") as aid",
-					  naccounts, (int64) naccounts * scale);
-	executeStatement(con, sql.data);
+	if (nthreads > 1)
+	{
+		/*
+		 * The other connections would block on our TRUNCATE until we
+		 * commit, so pgbench_accounts is filled outside of this transaction.
+		 */
+		executeStatement(con, "commit");
+		initGenerateAccountsParallel(&sql);
+	}
+	else
+	{
+		printfPQExpBuffer(&sql,
+						  "insert into pgbench_accounts(aid,bid,abalance,filler) "
+						  "select aid, (aid - 1) / %d + 1, 0, '' "
+						  "from generate_series(1, " INT64_FORMAT ") as aid",
+						  naccounts, (int64) naccounts * scale);
+		executeStatement(con, sql.data);
+		executeStatement(con, "commit");
+	}
 
 	termPQExpBuffer(&sql);
-
-	executeStatement(con, "commit");
 }
 
 /*
@@ -6317,6 +6519,24 @@ printSimpleStats(const char *prefix, SimpleStats *ss)
 	}
 }
 
+/*
+ * Print latency percentiles computed from a latency histogram.
+ */
+static void
+printLatencyPercentiles(const char *prefix, const int64 *hist, int64 count)
+{
+	static const double fractions[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+
+	if (count <= 0)
+		return;
+
+	printf("%s percentiles:", prefix);
+	for (int i = 0; i < lengthof(fractions); i++)
+		printf("%s p%g = %.3f ms", i > 0 ? "," : "", 100 * fractions[i],
+			   0.001 * getLatencyPercentile(hist, count, fractions[i]));
+	printf("\n");
+}
+
 /* print version banner */
 static void
 printVersion(PGconn *con)
@@ -6377,6 +6597,19 @@ printResults(StatsData *total,
 	if (max_tries)
 		printf("maximum number of tries: %u\n", max_tries);
 
+	if (num_rate_phases > 0)
+	{
+		int64		phase_start = 0;
+
+		for (int i = 0; i < num_rate_phases; i++)
+		{
+			printf("phase %d: %d s at %.1f tps\n", i + 1,
+				   (int) ((rate_phases[i].end - phase_start) / 1000000),
+				   1000000.0 * nthreads / rate_phases[i].delay);
+			phase_start = rate_phases[i].end;
+		}
+	}
+
 	if (duration <= 0)
 	{
 		printf("number of transactions per client: %d\n", nxacts);
@@ -6424,7 +6657,7 @@ printResults(StatsData *total,
 			   latency_limit / 1000.0, latency_late, total->cnt,
 			   (total->cnt > 0) ? 100.0 * latency_late / total->cnt : 0.0);
 
-	if (throttle_delay || progress || latency_limit)
+	if (throttle_delay || progress || latency_limit || latency_percentiles)
 		printSimpleStats("latency", &total->latency);
 	else
 	{
@@ -6446,6 +6679,9 @@ printResults(StatsData *total,
 			   0.001 * total->lag.sum / total->cnt, 0.001 * total->lag.max);
 	}
 
+	if (latency_percentiles)
+		printLatencyPercentiles("latency", total->latency_hist, total->cnt);
+
 	/*
 	 * Under -C/--connect, each transaction incurs a significant connection
 	 * cost, it would not make much sense to ignore it in tps, and it would
@@ -6522,6 +6758,9 @@ printResults(StatsData *total,
 						   100.0 * sstats->skipped / script_total_cnt);
 
 				printSimpleStats(" - latency", &sstats->latency);
+				if (latency_percentiles)
+					printLatencyPercentiles(" - latency", sstats->latency_hist,
+											sstats->cnt);
 			}
 
 			/*
@@ -6663,6 +6902,8 @@ main(int argc, char **argv)
 		{"verbose-errors", no_argument, NULL, 15},
 		{"exit-on-abort", no_argument, NULL, 16},
 		{"debug", no_argument, NULL, 17},
+		{"latency-percentiles", no_argument, NULL, 18},
+		{"phase", required_argument, NULL, 19},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -6815,7 +7056,6 @@ main(int argc, char **argv)
 				initialization_option_set = true;
 				break;
 			case 'j':			/* jobs */
-				benchmarking_option_set = true;
 				if (!option_parse_int(optarg, "-j/--jobs", 1, INT_MAX,
 									  &nthreads))
 				{
@@ -7003,6 +7243,41 @@ main(int argc, char **argv)
 			case 17:			/* debug */
 				pg_logging_increase_verbosity();
 				break;
+			case 18:			/* latency-percentiles */
+				benchmarking_option_set = true;
+				latency_percentiles = true;
+				break;
+			case 19:			/* phase */
+				{
+					char	   *sep = strchr(optarg, ':');
+					int			phase_duration;
+					double		phase_rate;
+					int64		phase_start;
+
+					benchmarking_option_set = true;
+
+					if (num_rate_phases >= MAX_RATE_PHASES)
+						pg_fatal("at most %d phases can be specified",
+								 MAX_RATE_PHASES);
+					if (sep == NULL)
+						pg_fatal("invalid phase \"%s\", expecting SECONDS:RATE",
+								 optarg);
+					*sep = '\0';
+					if (!option_parse_int(optarg, "--phase", 1, INT_MAX,
+										  &phase_duration))
+						exit(1);
+					phase_rate = atof(sep + 1);
+					if (phase_rate <= 0.0)
+						pg_fatal("invalid rate limit: \"%s\"", sep + 1);
+
+					phase_start = num_rate_phases > 0 ?
+						rate_phases[num_rate_phases - 1].end : 0;
+					rate_phases[num_rate_phases].end =
+						phase_start + (int64) 1000000 * phase_duration;
+					rate_phases[num_rate_phases].delay = 1000000.0 / phase_rate;
+					num_rate_phases++;
+				}
+				break;
 			default:
 				/* getopt_long already emitted a complaint */
 				pg_log_error_hint("Try \"%s --help\" for more information.", progname);
@@ -7041,9 +7316,10 @@ main(int argc, char **argv)
 	/*
 	 * Don't need more threads than there are clients.  (This is not merely an
 	 * optimization; throttle_delay is calculated incorrectly below if some
-	 * threads have no clients assigned to them.)
+	 * threads have no clients assigned to them.)  In initialization mode, -j
+	 * is the number of connections used to generate data instead.
 	 */
-	if (nthreads > nclients)
+	if (!is_init_mode && nthreads > nclients)
 		nthreads = nclients;
 
 	/*
@@ -7052,6 +7328,8 @@ main(int argc, char **argv)
 	 * the center of a Poisson distribution of delays.
 	 */
 	throttle_delay *= nthreads;
+	for (i = 0; i < num_rate_phases; i++)
+		rate_phases[i].delay *= nthreads;
 
 	if (dbName == NULL)
 	{
@@ -7124,6 +7402,23 @@ main(int argc, char **argv)
 	if (nxacts > 0 && duration > 0)
 		pg_fatal("specify either a number of transactions (-t) or a duration (-T), not both");
 
+	/*
+	 * Phases determine both the rate and the duration of the run.  Start
+	 * throttling at the rate of the first phase.
+	 */
+	if (num_rate_phases > 0)
+	{
+		if (throttle_delay > 0)
+			pg_fatal("--phase cannot be used together with -R/--rate");
+		if (nxacts > 0 || duration > 0)
+			pg_fatal("--phase cannot be used together with -t/--transactions or -T/--time");
+		if (rate_phases[num_rate_phases - 1].end / 1000000 > INT_MAX)
+			pg_fatal("total duration of the phases is too large");
+
+		duration = (int) (rate_phases[num_rate_phases - 1].end / 1000000);
+		throttle_delay = rate_phases[0].delay;
+	}
+
 	/* Use DEFAULT_NXACTS if neither nxacts nor duration is specified. */
 	if (nxacts <= 0 && duration <= 0)
 		nxacts = DEFAULT_NXACTS;
@@ -7352,6 +7647,11 @@ main(int argc, char **argv)
 		/* aggregate thread level stats */
 		mergeSimpleStats(&stats.latency, &thread->stats.latency);
 		mergeSimpleStats(&stats.lag, &thread->stats.lag);
+		if (latency_percentiles)
+		{
+			for (int j = 0; j < LATENCY_HIST_BUCKETS; j++)
+				stats.latency_hist[j] += thread->stats.latency_hist[j];
+		}
 		stats.cnt += thread->stats.cnt;
 		stats.skipped += thread->stats.skipped;
 		stats.retries += thread->stats.retries;
@@ -136,6 +136,20 @@ $node->pgbench(
 # Check data state, after server-side data generation.
 check_data_state($node, 'server-side');
 
+# Server-side data generation with several connections
+$node->pgbench(
+	'--initialize --init-steps=dtGvp --jobs=2 --partitions=3',
+	0,
+	[qr{^$}],
+	[
+		qr{generating data \(server-side\)},
+		qr{loading pgbench_accounts using 2 connections},
+		qr{done in \d+\.\d\d s }
+	],
+	'pgbench parallel server-side initialization');
+
+check_data_state($node, 'parallel server-side');
+
 # Run all builtin scripts, for a few transactions each
 $node->pgbench(
 	'--transactions=5 -Dfoo=bla --client=2 --protocol=simple --builtin=t'
@@ -1244,6 +1258,19 @@ $node->pgbench(
 	'pgbench late throttling',
 	{ '001_pgbench_sleep' => q{\sleep 2ms} });
 
+# rate phases and latency percentiles
+$node->pgbench(
+	'-S -b select-only@2 -b simple-update@1 --phase=1:100 --phase=1:200 -c 2 -n --latency-percentiles',
+	0,
+	[
+		qr{phase 1: 1 s at 100.0 tps},
+		qr{phase 2: 1 s at 200.0 tps},
+		qr{latency percentiles: p50 = \d+\.\d+ ms, p90 = },
+		qr{ - latency percentiles: p50 = }
+	],
+	[qr{^$}],
+	'pgbench rate phases');
+
 # return a list of files from directory $dir matching regexpr $re
 # this works around glob portability and escaping issues
 sub list_files
@@ -128,6 +128,12 @@ my @options = (
 		[qr{-P/--progress must be in range}]
 	],
 	[ 'invalid rate', '--rate=0.0', [qr{invalid rate limit}] ],
+	[ 'invalid phase', '--phase=10', [qr{invalid phase}] ],
+	[ 'invalid phase rate', '--phase=10:0', [qr{invalid rate limit}] ],
+	[
+		'phase with duration', '--phase=10:100 -T 10',
+		[qr{--phase cannot be used together}]
+	],
 	[ 'invalid latency', '--latency-limit=0.0', [qr{invalid latency limit}] ],
 	[
 		'invalid sampling rate', '--sampling-rate=0',
@@ -0,0 +1,110 @@
+/*-------------------------------------------------------------------------
+ *
+ * instr_time.c
+ *	  Set up the time source used by portability/instr_time.h
+ *
+ * On x86-64 Linux, reading the CPU's time-stamp counter with RDTSC is much
+ * cheaper than clock_gettime(), which matters when timing is taken around
+ * every tuple as in EXPLAIN ANALYZE.  We only use the TSC if the CPU says it
+ * runs at a constant rate independent of power states, and the kernel has
+ * itself chosen it as the system clocksource, which means it found the TSC
+ * to be synchronized across CPUs.  Its frequency is calibrated once against
+ * clock_gettime().
+ *
+ * Processes that don't call pg_initialize_timing() keep using
+ * clock_gettime().  So do children started via EXEC_BACKEND, which is fine
+ * since instr_time values are never exchanged between processes that
+ * disagree about the time source.
+ *
+ * Copyright (c) 2024, PostgreSQL Global Development Group
+ *
+ * src/common/instr_time.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "c.h"
+
+#include "portability/instr_time.h"
+
+#ifdef PG_INSTR_TSC
+#include <cpuid.h>
+#endif
+
+#ifdef PG_INSTR_TSC
+
+/* Use RDTSC for INSTR_TIME_SET_CURRENT? */
+bool		pg_instr_use_tsc = false;
+
+/* Nanoseconds per TSC tick, valid if pg_instr_use_tsc */
+double		pg_instr_ns_per_tick = 1.0;
+
+/* How long to spin when calibrating the TSC against clock_gettime() */
+#define TSC_CALIBRATION_NS	(2 * NS_PER_MS)
+
+/*
+ * Does the CPU advertise an invariant TSC, and is the kernel using the TSC
+ * as its clocksource?
+ */
+static bool
+tsc_is_reliable(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	char		buf[32];
+	FILE	   *fp;
+	bool		result;
+
+	if (__get_cpuid_max(0x80000000, NULL) < 0x80000007)
+		return false;
+	__get_cpuid(0x80000007, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[3] & (1 << 8)) == 0)	/* invariant TSC */
+		return false;
+
+	fp = fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource", "r");
+	if (fp == NULL)
+		return false;
+	result = (fgets(buf, sizeof(buf), fp) != NULL &&
+			  strcmp(buf, "tsc\n") == 0);
+	fclose(fp);
+
+	return result;
+}
+
+#endif							/* PG_INSTR_TSC */
+
+/*
+ * Choose the time source for INSTR_TIME_SET_CURRENT in this process.
+ *
+ * This must be called before any instr_time value is taken, since values
+ * from different time sources can't be mixed.
+ */
+void
+pg_initialize_timing(void)
+{
+#ifdef PG_INSTR_TSC
+	instr_time	start_time;
+	instr_time	end_time;
+	uint64		start_tsc;
+	uint64		end_tsc;
+
+	pg_instr_use_tsc = false;
+
+	if (!tsc_is_reliable())
+		return;
+
+	start_time = pg_clock_gettime_ns();
+	start_tsc = __builtin_ia32_rdtsc();
+	do
+	{
+		end_time = pg_clock_gettime_ns();
+		end_tsc = __builtin_ia32_rdtsc();
+	} while (end_time.ticks - start_time.ticks < TSC_CALIBRATION_NS);
+
+	if (end_tsc <= start_tsc)
+		return;
+
+	pg_instr_ns_per_tick = (double) (end_time.ticks - start_time.ticks) /
+		(end_tsc - start_tsc);
+	pg_instr_use_tsc = true;
+#endif
+}
@@ -19,7 +19,7 @@
 
 #include "common/jsonapi.h"
 #include "mb/pg_wchar.h"
-#include "port/pg_lfind.h"
+#include "port/simd.h"
 
 #ifndef FRONTEND
 #include "miscadmin.h"
@@ -1861,13 +1861,20 @@ json_lex_string(JsonLexContext *lex)
 
 			/*
 			 * Skip to the first byte that requires special handling, so we
-			 * can batch calls to appendBinaryStringInfo.
+			 * can batch calls to appendBinaryStringInfo.  Load each chunk
+			 * once and test it for all three conditions.
 			 */
-			while (p < end - sizeof(Vector8) &&
-				   !pg_lfind8('\\', (uint8 *) p, sizeof(Vector8)) &&
-				   !pg_lfind8('"', (uint8 *) p, sizeof(Vector8)) &&
-				   !pg_lfind8_le(31, (uint8 *) p, sizeof(Vector8)))
+			while (p < end - sizeof(Vector8))
+			{
+				Vector8		chunk;
+
+				vector8_load(&chunk, (const uint8 *) p);
+				if (vector8_has(chunk, '\\') ||
+					vector8_has(chunk, '"') ||
+					vector8_has_le(chunk, 31))
+					break;
 				p += sizeof(Vector8);
+			}
 
 			for (; p < end; p++)
 			{
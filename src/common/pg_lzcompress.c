@@ -186,6 +186,7 @@
 #include <limits.h>
 
 #include "common/pg_lzcompress.h"
+#include "port/pg_bitutils.h"
 
 
 /* ----------
@@ -387,6 +388,48 @@ do { \
 } while (0)
 
 
+/* ----------
+ * pglz_match_length -
+ *
+ *		Returns the number of leading bytes that ip and hp have in common,
+ *		up to maxlen.  We compare a word at a time and locate the first
+ *		differing byte from the XOR of the two words, falling back to
+ *		byte-at-a-time comparison only for the tail.  hp is always behind
+ *		ip in the input, so reading maxlen bytes from either is safe.
+ * ----------
+ */
+static inline int32
+pglz_match_length(const char *ip, const char *hp, int32 maxlen)
+{
+	int32		len = 0;
+
+	while (len + (int32) sizeof(uint64) <= maxlen)
+	{
+		uint64		a;
+		uint64		b;
+		uint64		diff;
+
+		memcpy(&a, ip + len, sizeof(uint64));
+		memcpy(&b, hp + len, sizeof(uint64));
+		diff = a ^ b;
+		if (diff != 0)
+		{
+#ifdef WORDS_BIGENDIAN
+			return len + (63 - pg_leftmost_one_pos64(diff)) / BITS_PER_BYTE;
+#else
+			return len + pg_rightmost_one_pos64(diff) / BITS_PER_BYTE;
+#endif
+		}
+		len += sizeof(uint64);
+	}
+
+	while (len < maxlen && ip[len] == hp[len])
+		len++;
+
+	return len;
+}
+
+
 /* ----------
  * pglz_find_match -
  *
@@ -403,6 +446,7 @@ pglz_find_match(int16 *hstart, const char *input, const char *end,
 	int16		hentno;
 	int32		len = 0;
 	int32		off = 0;
+	int32		maxlen = Min(end - input, PGLZ_MAX_MATCH);
 
 	/*
 	 * Traverse the linked history list until a good enough match is found.
@@ -411,7 +455,6 @@ pglz_find_match(int16 *hstart, const char *input, const char *end,
 	hent = &hist_entries[hentno];
 	while (hent != INVALID_ENTRY_PTR)
 	{
-		const char *ip = input;
 		const char *hp = hent->pos;
 		int32		thisoff;
 		int32		thislen;
@@ -419,43 +462,15 @@ pglz_find_match(int16 *hstart, const char *input, const char *end,
 		/*
 		 * Stop if the offset does not fit into our tag anymore.
 		 */
-		thisoff = ip - hp;
+		thisoff = input - hp;
 		if (thisoff >= 0x0fff)
 			break;
 
 		/*
-		 * Determine length of match. A better match must be larger than the
-		 * best so far. And if we already have a match of 16 or more bytes,
-		 * it's worth the call overhead to use memcmp() to check if this match
-		 * is equal for the same size. After that we must fallback to
-		 * character by character comparison to know the exact position where
-		 * the diff occurred.
+		 * Determine length of match.  A better match must be larger than the
+		 * best so far.
 		 */
-		thislen = 0;
-		if (len >= 16)
-		{
-			if (memcmp(ip, hp, len) == 0)
-			{
-				thislen = len;
-				ip += len;
-				hp += len;
-				while (ip < end && *ip == *hp && thislen < PGLZ_MAX_MATCH)
-				{
-					thislen++;
-					ip++;
-					hp++;
-				}
-			}
-		}
-		else
-		{
-			while (ip < end && *ip == *hp && thislen < PGLZ_MAX_MATCH)
-			{
-				thislen++;
-				ip++;
-				hp++;
-			}
-		}
+		thislen = pglz_match_length(input, hp, maxlen);
 
 		/*
 		 * Remember this match as the best (if it is)
@@ -711,6 +726,19 @@ pglz_decompress(const char *source, int32 slen, char *dest,
 		unsigned char ctrl = *sp++;
 		int			ctrlc;
 
+		/*
+		 * A zero control byte means the next 8 items are all literal bytes,
+		 * which is common in poorly compressible data.  If both buffers have
+		 * room, copy them in one go rather than one at a time.
+		 */
+		if (ctrl == 0 && srcend - sp >= 8 && destend - dp >= 8)
+		{
+			memcpy(dp, sp, 8);
+			sp += 8;
+			dp += 8;
+			continue;
+		}
+
 		for (ctrlc = 0; ctrlc < 8 && sp < srcend && dp < destend; ctrlc++)
 		{
 			if (ctrl & 1)
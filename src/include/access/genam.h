@@ -174,6 +174,8 @@ extern void index_parallelrescan(IndexScanDesc scan);
 extern IndexScanDesc index_beginscan_parallel(Relation heaprel,
 											  Relation indexrel, int nkeys, int norderbys,
 											  ParallelIndexScanDesc pscan);
+extern void index_enable_heap_prefetch(IndexScanDesc scan);
+extern ItemPointer index_heap_prefetch_batch(IndexScanDesc scan, int ntids);
 extern ItemPointer index_getnext_tid(IndexScanDesc scan,
 									 ScanDirection direction);
 struct TupleTableSlot;
@@ -101,6 +101,16 @@ typedef struct HeapScanDescData
 	Buffer		rs_vmbuffer;
 	int			rs_empty_tuples_pending;
 
+	/*
+	 * Bitmap pages consumed by the read stream callback of a bitmap scan but
+	 * not yet reported to the executor by heapam_scan_bitmap_next_block().
+	 */
+	uint64		rs_lossy_pages;
+	uint64		rs_exact_pages;
+
+	/* short-lived context for testing scan keys in page-at-a-time mode */
+	MemoryContext rs_keycxt;
+
 	/* these fields only used in page-at-a-time mode and for bitmap scans */
 	int			rs_cindex;		/* current tuple's index in vistuples */
 	int			rs_ntuples;		/* number of visible tuples on page */
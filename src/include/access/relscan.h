@@ -35,6 +35,8 @@ typedef struct TableScanDescData
 	struct SnapshotData *rs_snapshot;	/* snapshot to see */
 	int			rs_nkeys;		/* number of scan keys */
 	struct ScanKeyData *rs_key; /* array of scan key descriptors */
+	uint64		rs_nfiltered;	/* # of tuples the scan keys rejected, if
+								 * reported by the AM */
 
 	/* Range of ItemPointers for table_scan_getnextslot_tidrange() to scan. */
 	ItemPointerData rs_mintid;
@@ -48,6 +50,14 @@ typedef struct TableScanDescData
 
 	struct ParallelTableScanDescData *rs_parallel;	/* parallel scan
 													 * information */
+
+	/*
+	 * Iterator over the TIDBitmap driving a bitmap table scan, set up by the
+	 * executor after table_beginscan_bm().  Only one of them is set,
+	 * depending on whether the scan is parallel.
+	 */
+	struct TBMIterator *rs_tbmiterator;
+	struct TBMSharedIterator *rs_shared_tbmiterator;
 } TableScanDescData;
 typedef struct TableScanDescData *TableScanDesc;
 
@@ -106,6 +116,26 @@ typedef struct IndexFetchTableData
 	Relation	rel;
 } IndexFetchTableData;
 
+/*
+ * State for prefetching the heap blocks of TIDs that an amgettuple-based
+ * index scan is going to return.  An AM that reads index entries a page at a
+ * time can hand each page's TIDs, in the order the scan will return them, to
+ * index_heap_prefetch_batch().  index_getnext_tid() then keeps prefetching up
+ * to 'distance' TIDs ahead of the one just returned.  This is a hint only:
+ * if the AM's position gets out of step with the batch (e.g. after restoring
+ * a mark), we just prefetch less usefully until the next batch.
+ */
+typedef struct IndexHeapPrefetchData
+{
+	int			distance;		/* # of TIDs to look ahead */
+	int			ntids;			/* # of TIDs in current batch */
+	int			maxtids;		/* allocated length of tids[] */
+	int			nreturned;		/* # of batch TIDs returned so far */
+	int			nprefetched;	/* # of batch TIDs considered for prefetch */
+	BlockNumber last_block;		/* heap block most recently prefetched */
+	ItemPointerData *tids;		/* TIDs, in scan order */
+} IndexHeapPrefetchData;
+
 /*
  * We use the same IndexScanDescData structure for both amgettuple-based
  * and amgetbitmap-based index scans.  Some fields are only relevant in
@@ -151,6 +181,9 @@ typedef struct IndexScanDescData
 
 	bool		xs_recheck;		/* T means scan keys must be rechecked */
 
+	/* heap prefetching state, or NULL if not enabled */
+	IndexHeapPrefetchData *xs_prefetch;
+
 	/*
 	 * When fetching with an ordering operator, the values of the ORDER BY
 	 * expressions of the last returned tuple, according to the index.  If
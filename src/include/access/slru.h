@@ -165,6 +165,15 @@ typedef struct SlruCtlData
 	 */
 	char		Dir[64];
 
+	/*
+	 * Backend-local state for detecting sequential reads, see
+	 * SlruPhysicalReadPage().  last_read_pageno is the page this backend last
+	 * read from disk, and prefetched_upto the end of the range it has
+	 * already asked the kernel to read ahead.
+	 */
+	int64		last_read_pageno;
+	int64		prefetched_upto;
+
 } SlruCtlData;
 
 typedef SlruCtlData *SlruCtl;
@@ -40,6 +40,15 @@ extern PGDLLIMPORT int max_wal_size_mb;
 extern PGDLLIMPORT int wal_keep_size_mb;
 extern PGDLLIMPORT int max_slot_wal_keep_size_mb;
 extern PGDLLIMPORT int XLOGbuffers;
+extern PGDLLIMPORT int wal_preallocate_segments;
+extern PGDLLIMPORT int wal_insert_locks;
+
+/*
+ * Upper limit for wal_insert_locks.  WALInsertLockAcquireExclusive() holds
+ * all of them at once, so this has to stay well below MAX_SIMUL_LWLOCKS.
+ */
+#define MAX_WAL_INSERT_LOCKS	128
+
 extern PGDLLIMPORT int XLogArchiveTimeout;
 extern PGDLLIMPORT int wal_retrieve_retry_interval;
 extern PGDLLIMPORT char *XLogArchiveCommand;
@@ -47,6 +56,7 @@ extern PGDLLIMPORT bool EnableHotStandby;
 extern PGDLLIMPORT bool fullPageWrites;
 extern PGDLLIMPORT bool wal_log_hints;
 extern PGDLLIMPORT int wal_compression;
+extern PGDLLIMPORT int wal_record_compression_threshold;
 extern PGDLLIMPORT bool wal_init_zero;
 extern PGDLLIMPORT bool wal_recycle;
 extern PGDLLIMPORT bool *wal_consistency_checking;
@@ -203,6 +213,7 @@ extern XLogRecPtr XLogInsertRecord(struct XLogRecData *rdata,
 								   bool topxid_included);
 extern void XLogFlush(XLogRecPtr record);
 extern bool XLogBackgroundFlush(void);
+extern void XLogPreallocateSegments(void);
 extern bool XLogNeedsFlush(XLogRecPtr record);
 extern int	XLogFileInit(XLogSegNo logsegno, TimeLineID logtli);
 extern int	XLogFileOpen(XLogSegNo segno, TimeLineID tli);
@@ -116,6 +116,9 @@ typedef struct XLogReaderRoutine
 
 #define XL_ROUTINE(...) &(XLogReaderRoutine){__VA_ARGS__}
 
+/* Amount of WAL that WALReadBuffered() reads at a time */
+#define XLOGREADER_READ_AHEAD_SIZE	(32 * XLOG_BLCKSZ)
+
 typedef struct
 {
 	/* Is this block ref in use? */
@@ -307,6 +310,22 @@ struct XLogReaderState
 	char	   *readRecordBuf;
 	uint32		readRecordBufSize;
 
+	/*
+	 * Buffer holding the decompressed form of the current record, if it was
+	 * stored with XLR_COMPRESSED (expandable).
+	 */
+	char	   *decompressBuf;
+	uint32		decompressBufSize;
+
+	/*
+	 * Read-ahead buffer used by WALReadBuffered(), holding readAheadLen
+	 * bytes of WAL starting at readAheadPtr on timeline readAheadTLI.
+	 */
+	char	   *readAheadBuf;
+	XLogRecPtr	readAheadPtr;
+	Size		readAheadLen;
+	TimeLineID	readAheadTLI;
+
 	/* Buffer to hold error message */
 	char	   *errormsg_buf;
 	bool		errormsg_deferred;
@@ -391,6 +410,10 @@ typedef struct WALReadError
 extern bool WALRead(XLogReaderState *state,
 					char *buf, XLogRecPtr startptr, Size count,
 					TimeLineID tli, WALReadError *errinfo);
+extern bool WALReadBuffered(XLogReaderState *state,
+							char *buf, XLogRecPtr startptr, Size count,
+							XLogRecPtr upto, TimeLineID tli,
+							WALReadError *errinfo);
 
 /* Functions for decoding an XLogRecord */
 
@@ -400,6 +423,10 @@ extern bool DecodeXLogRecord(XLogReaderState *state,
 							 XLogRecord *record,
 							 XLogRecPtr lsn,
 							 char **errormsg);
+extern XLogRecord *DecompressXLogRecord(XLogReaderState *state,
+										XLogRecord *record,
+										XLogRecPtr lsn,
+										char **errormsg);
 
 /*
  * Macros that provide access to parts of the record most recently returned by
@@ -90,6 +90,35 @@ typedef struct XLogRecord
  */
 #define XLR_CHECK_CONSISTENCY	0x02
 
+/*
+ * The rest of the record after the XLogRecord struct is compressed.  This is
+ * set by XLogInsert when wal_record_compression_threshold is enabled, and
+ * is cleared again by the XLogReader when it decompresses the record, so
+ * redo routines never see it.
+ */
+#define XLR_COMPRESSED			0x04
+
+/*
+ * Header that follows the XLogRecord struct in a compressed record.  The
+ * compressed data follows it, and decompresses to everything that would
+ * otherwise come after the XLogRecord struct: the block headers, the data
+ * headers, block data and main data.  The record's CRC covers the data as
+ * stored, i.e. compressed.
+ */
+typedef struct XLogRecordCompressHeader
+{
+	uint32		length;			/* uncompressed length, excluding XLogRecord */
+	uint8		method;			/* XLR_COMPRESS_* */
+} XLogRecordCompressHeader;
+
+#define SizeOfXLogRecordCompressHeader	\
+	(offsetof(XLogRecordCompressHeader, method) + sizeof(uint8))
+
+/* compression methods supported for whole records */
+#define XLR_COMPRESS_PGLZ		1
+#define XLR_COMPRESS_LZ4		2
+#define XLR_COMPRESS_ZSTD		3
+
 /*
  * Header info for block data appended to an XLOG record.
  *
@@ -283,6 +283,18 @@
 
 #endif							/* defined(__MINGW64__) && __GNUC__ == 8 &&
 								 * __GNUC_MINOR__ == 1 */
+
+/*
+ * pg_attribute_target allows specifying different target options that the
+ * function should be compiled with (e.g., for using special CPU instructions).
+ * Callers must make sure the compiler knows the options they pass.
+ */
+#if __has_attribute (target)
+#define pg_attribute_target(...) __attribute__((target(__VA_ARGS__)))
+#else
+#define pg_attribute_target(...)
+#endif
+
 /*
  * Mark a point as unreachable in a portable fashion.  This should preferably
  * be something that the compiler understands, to aid code generation.
@@ -311,6 +323,18 @@
 #define unlikely(x) ((x) != 0)
 #endif
 
+/*
+ * Hint to the CPU to start loading the cache line containing the given
+ * address, for read access.  This is only a hint: it never faults, even on an
+ * invalid address, and expands to nothing if the compiler has no way to
+ * express it.
+ */
+#if defined(__GNUC__)
+#define pg_prefetch_mem(a)	__builtin_prefetch(a)
+#else
+#define pg_prefetch_mem(a)	((void) 0)
+#endif
+
 /*
  * CppAsString
  *		Convert the argument to a string, using the C preprocessor.
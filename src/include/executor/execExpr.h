@@ -106,10 +106,14 @@ typedef enum ExprEvalOp
 	/*
 	 * Evaluate function call (including OpExprs etc).  For speed, we
 	 * distinguish in the opcode whether the function is strict and/or
-	 * requires usage stats tracking.
+	 * requires usage stats tracking.  Strict functions of one or two
+	 * arguments, which covers nearly all operators, get dedicated opcodes
+	 * that test the arguments for NULL without looping.
 	 */
 	EEOP_FUNCEXPR,
 	EEOP_FUNCEXPR_STRICT,
+	EEOP_FUNCEXPR_STRICT_1,
+	EEOP_FUNCEXPR_STRICT_2,
 	EEOP_FUNCEXPR_FUSAGE,
 	EEOP_FUNCEXPR_STRICT_FUSAGE,
 
@@ -587,9 +591,11 @@ typedef struct ExprEvalStep
 		{
 			bool		has_nulls;
 			bool		inclause;	/* true for IN and false for NOT IN */
+			bool		array_isnull;	/* array evaluated to NULL */
 			struct ScalarArrayOpExprHashTable *elements_tab;
-			FmgrInfo   *finfo;	/* function's lookup data */
-			FunctionCallInfo fcinfo_data;	/* arguments etc */
+			/* separately evaluated array argument, or NULL if inline */
+			ExprState  *arraystate;
+			FunctionCallInfo fcinfo_data;	/* arguments and lookup data */
 			ScalarArrayOpExpr *saop;
 		}			hashedscalararrayop;
 
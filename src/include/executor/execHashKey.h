@@ -0,0 +1,51 @@
+/*-------------------------------------------------------------------------
+ * execHashKey.h
+ *		Hashing of join and grouping keys
+ *
+ * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *		src/include/executor/execHashKey.h
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef EXECHASHKEY_H
+#define EXECHASHKEY_H
+
+#include "common/hashfn.h"
+#include "fmgr.h"
+#include "utils/fmgrprotos.h"
+
+/*
+ * Compute the hash of a non-null key value with the given hash function,
+ * as used when building hash tables for joins and grouping.
+ *
+ * The hash functions of the common fixed-width integer types are evaluated
+ * inline, which saves the function-call overhead of FunctionCall1Coll() on
+ * every key column of every tuple.  The results must of course be identical
+ * to what the called functions would return.
+ */
+static inline uint32
+ExecHashKeyDatum(FmgrInfo *flinfo, Oid collation, Datum value)
+{
+	if (flinfo->fn_addr == hashint4 || flinfo->fn_addr == hashoid)
+		return hash_bytes_uint32(DatumGetUInt32(value));
+	else if (flinfo->fn_addr == hashint8)
+	{
+		/* see hashint8() */
+		int64		val = DatumGetInt64(value);
+		uint32		lohalf = (uint32) val;
+		uint32		hihalf = (uint32) (val >> 32);
+
+		lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+
+		return hash_bytes_uint32(lohalf);
+	}
+	else if (flinfo->fn_addr == hashint2)
+		return hash_bytes_uint32((int32) DatumGetInt16(value));
+
+	return DatumGetUInt32(FunctionCall1Coll(flinfo, collation, value));
+}
+
+#endif							/* EXECHASHKEY_H */
@@ -96,6 +96,8 @@ typedef bool (*ExecutorCheckPerms_hook_type) (List *rangeTable,
 											  bool ereport_on_violation);
 extern PGDLLIMPORT ExecutorCheckPerms_hook_type ExecutorCheckPerms_hook;
 
+extern PGDLLIMPORT QueryDesc *ActiveQueryDesc;
+
 
 /*
  * prototypes from functions in execAmi.c
@@ -163,6 +165,19 @@ extern TupleHashEntry FindTupleHashEntry(TupleHashTable hashtable,
 										 FmgrInfo *hashfunctions);
 extern void ResetTupleHashTable(TupleHashTable hashtable);
 
+/*
+ * Return the caller's per-entry data of a hash table entry, zeroed when the
+ * entry was created, or NULL if the table was built with additionalsize 0.
+ */
+static inline void *
+TupleHashEntryGetAdditional(TupleHashTable hashtable, TupleHashEntry entry)
+{
+	if (hashtable->additionalsize > 0)
+		return (char *) entry->firstTuple - hashtable->additionalsize;
+	else
+		return NULL;
+}
+
 /*
  * prototypes from functions in execJunk.c
  */
@@ -252,6 +267,9 @@ extern void EvalPlanQualEnd(EPQState *epqstate);
  */
 extern PlanState *ExecInitNode(Plan *node, EState *estate, int eflags);
 extern void ExecSetExecProcNode(PlanState *node, ExecProcNodeMtd function);
+extern void ExecInterceptProcNodes(PlanState *planstate, ExecProcNodeMtd function);
+extern void ExecRestoreProcNodes(PlanState *planstate);
+extern void ExecRestoreProcNode(PlanState *node);
 extern Node *MultiExecProcNode(PlanState *node);
 extern void ExecEndNode(PlanState *node);
 extern void ExecShutdownNode(PlanState *node);
@@ -656,6 +674,9 @@ extern bool RelationFindReplTupleSeq(Relation rel, LockTupleMode lockmode,
 
 extern void ExecSimpleRelationInsert(ResultRelInfo *resultRelInfo,
 									 EState *estate, TupleTableSlot *slot);
+extern void ExecSimpleRelationMultiInsert(ResultRelInfo *resultRelInfo,
+										  EState *estate,
+										  TupleTableSlot **slots, int nslots);
 extern void ExecSimpleRelationUpdate(ResultRelInfo *resultRelInfo,
 									 EState *estate, EPQState *epqstate,
 									 TupleTableSlot *searchslot, TupleTableSlot *slot);
@@ -28,6 +28,8 @@ extern HashJoinTable ExecHashTableCreate(HashState *state, List *hashOperators,
 										 bool keepNulls);
 extern void ExecParallelHashTableAlloc(HashJoinTable hashtable,
 									   int batchno);
+extern void ExecHashTableCreateBloomFilter(HashJoinTable hashtable,
+										   double ntuples);
 extern void ExecHashTableDestroy(HashJoinTable hashtable);
 extern void ExecHashTableDetach(HashJoinTable hashtable);
 extern void ExecHashTableDetachBatch(HashJoinTable hashtable);
@@ -18,6 +18,11 @@
 #include "nodes/execnodes.h"
 #include "storage/buffile.h"
 
+/* default for debug_hash_join_prefetch_min_buckets */
+#define DEFAULT_HASH_JOIN_PREFETCH_MIN_BUCKETS	(1 << 19)
+
+extern PGDLLIMPORT int debug_hash_join_prefetch_min_buckets;
+
 extern HashJoinState *ExecInitHashJoin(HashJoin *node, EState *estate, int eflags);
 extern void ExecEndHashJoin(HashJoinState *node);
 extern void ExecReScanHashJoin(HashJoinState *node);
@@ -120,6 +120,7 @@ extern ssize_t secure_open_gssapi(Port *port);
 extern PGDLLIMPORT char *SSLCipherSuites;
 extern PGDLLIMPORT char *SSLECDHCurve;
 extern PGDLLIMPORT bool SSLPreferServerCiphers;
+extern PGDLLIMPORT bool ssl_session_tickets;
 extern PGDLLIMPORT int ssl_min_protocol_version;
 extern PGDLLIMPORT int ssl_max_protocol_version;
 
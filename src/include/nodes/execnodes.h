@@ -512,6 +512,7 @@ typedef struct ResultRelInfo
 	int			ri_NumSlots;	/* number of slots in the array */
 	int			ri_NumSlotsInitialized; /* number of initialized slots */
 	int			ri_BatchSize;	/* max slots inserted in a single batch */
+	Size		ri_BatchBytes;	/* approx. size of tuples in ri_Slots */
 	TupleTableSlot **ri_Slots;	/* input tuples for batch insert */
 	TupleTableSlot **ri_PlanSlots;
 
@@ -796,10 +797,15 @@ typedef struct ExecAuxRowMark
 typedef struct TupleHashEntryData *TupleHashEntry;
 typedef struct TupleHashTableData *TupleHashTable;
 
+/*
+ * The caller's per-entry data, if any, is allocated in the same chunk as the
+ * copy of the first tuple, immediately before it; use
+ * TupleHashEntryGetAdditional() to find it.  Keeping it out of the entry
+ * itself makes the bucket array denser.
+ */
 typedef struct TupleHashEntryData
 {
 	MinimalTuple firstTuple;	/* copy of first tuple in this group */
-	void	   *additional;		/* user data */
 	uint32		status;			/* hash status */
 	uint32		hash;			/* hash value (cached) */
 } TupleHashEntryData;
@@ -823,6 +829,7 @@ typedef struct TupleHashTableData
 	MemoryContext tablecxt;		/* memory context containing table */
 	MemoryContext tempcxt;		/* context for function evaluations */
 	Size		entrysize;		/* actual size to make each hash entry */
+	Size		additionalsize; /* MAXALIGN'd size of per-entry user data */
 	TupleTableSlot *tableslot;	/* slot for referencing table entries */
 	/* The following fields are set transiently for each table search: */
 	TupleTableSlot *inputslot;	/* current input tuple's slot */
@@ -986,6 +993,18 @@ typedef struct SubPlanState
 	FmgrInfo   *lhs_hash_funcs; /* hash functions for lefthand datatype(s) */
 	FmgrInfo   *cur_eq_funcs;	/* equality functions for LHS vs. table */
 	ExprState  *cur_eq_comp;	/* equality comparator for LHS vs. table */
+	/* these are used when caching results by parameter values: */
+	struct subplan_cache_hash *cache;	/* results for known parameters */
+	MemoryContext cachecxt;		/* memory context containing the cache */
+	int			numParams;		/* number of parameters */
+	int16	   *param_typlen;	/* typlen of each parameter */
+	bool	   *param_typbyval; /* typbyval of each parameter */
+	Datum	   *param_values;	/* current parameter values */
+	bool	   *param_isnull;	/* current parameter nullness */
+	int16		result_typlen;	/* typlen of the result */
+	bool		result_typbyval;	/* typbyval of the result */
+	uint64		cache_hits;		/* # of calls answered from the cache */
+	uint64		cache_misses;	/* # of calls that ran the subplan */
 } SubPlanState;
 
 /*
@@ -1569,12 +1588,17 @@ typedef struct ScanState
 
 /* ----------------
  *	 SeqScanState information
+ *
+ *		NumScanKeys		   number of leading quals pushed down as scan keys
+ *		ScanKeys		   scan key descriptors for those quals
  * ----------------
  */
 typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
+	int			ss_NumScanKeys;
+	struct ScanKeyData *ss_ScanKeys;
 } SeqScanState;
 
 /* ----------------
@@ -1770,11 +1794,7 @@ typedef enum
 /* ----------------
  *	 ParallelBitmapHeapState information
  *		tbmiterator				iterator for scanning current pages
- *		prefetch_iterator		iterator for prefetching ahead of current page
- *		mutex					mutual exclusion for the prefetching variable
- *								and state
- *		prefetch_pages			# pages prefetch iterator is ahead of current
- *		prefetch_target			current target prefetch distance
+ *		mutex					mutual exclusion for the state
  *		state					current state of the TIDBitmap
  *		cv						conditional wait variable
  * ----------------
@@ -1782,10 +1802,7 @@ typedef enum
 typedef struct ParallelBitmapHeapState
 {
 	dsa_pointer tbmiterator;
-	dsa_pointer prefetch_iterator;
 	slock_t		mutex;
-	int			prefetch_pages;
-	int			prefetch_target;
 	SharedBitmapState state;
 	ConditionVariable cv;
 } ParallelBitmapHeapState;
@@ -1796,18 +1813,12 @@ typedef struct ParallelBitmapHeapState
  *		bitmapqualorig	   execution state for bitmapqualorig expressions
  *		tbm				   bitmap obtained from child index scan(s)
  *		tbmiterator		   iterator for scanning current pages
- *		tbmres			   current-page data
- *		pvmbuffer		   buffer for visibility-map lookups of prefetched pages
  *		exact_pages		   total number of exact pages retrieved
  *		lossy_pages		   total number of lossy pages retrieved
- *		prefetch_iterator  iterator for prefetching ahead of current page
- *		prefetch_pages	   # pages prefetch iterator is ahead of current
- *		prefetch_target    current target prefetch distance
- *		prefetch_maximum   maximum value for prefetch_target
  *		initialized		   is node is ready to iterate
  *		shared_tbmiterator	   shared iterator
- *		shared_prefetch_iterator shared iterator for prefetching
  *		pstate			   shared state for parallel bitmap scan
+ *		recheck			   do current page's tuples need recheck
  * ----------------
  */
 typedef struct BitmapHeapScanState
@@ -1816,18 +1827,12 @@ typedef struct BitmapHeapScanState
 	ExprState  *bitmapqualorig;
 	TIDBitmap  *tbm;
 	TBMIterator *tbmiterator;
-	TBMIterateResult *tbmres;
-	Buffer		pvmbuffer;
-	long		exact_pages;
-	long		lossy_pages;
-	TBMIterator *prefetch_iterator;
-	int			prefetch_pages;
-	int			prefetch_target;
-	int			prefetch_maximum;
+	uint64		exact_pages;
+	uint64		lossy_pages;
 	bool		initialized;
 	TBMSharedIterator *shared_tbmiterator;
-	TBMSharedIterator *shared_prefetch_iterator;
 	ParallelBitmapHeapState *pstate;
+	bool		recheck;
 } BitmapHeapScanState;
 
 /* ----------------
@@ -2177,6 +2182,11 @@ typedef struct MergeJoinState
  *		hj_JoinState			current state of ExecHashJoin state machine
  *		hj_MatchedOuter			true if found a join match for current outer
  *		hj_OuterNotEmpty		true if outer relation known not empty
+ *		hj_PrefetchSlots		outer tuples read ahead to prefetch their
+ *								buckets, or NULL if never needed
+ *		hj_PrefetchHashValues	hash values of those tuples
+ *		hj_PrefetchCount		number of tuples read ahead
+ *		hj_PrefetchNext			index of the next one to return
  * ----------------
  */
 
@@ -2204,6 +2214,10 @@ typedef struct HashJoinState
 	int			hj_JoinState;
 	bool		hj_MatchedOuter;
 	bool		hj_OuterNotEmpty;
+	TupleTableSlot **hj_PrefetchSlots;
+	uint32	   *hj_PrefetchHashValues;
+	int			hj_PrefetchCount;
+	int			hj_PrefetchNext;
 } HashJoinState;
 
 
@@ -2340,6 +2354,8 @@ typedef struct SortState
 	bool		am_worker;		/* are we a worker? */
 	bool		datumSort;		/* Datum sort instead of tuple sort? */
 	SharedSortInfo *shared_info;	/* one entry per worker */
+	bool		share_bound;	/* directly below a Gather Merge? */
+	struct SharedSortBound *shared_bound;	/* bounds of all participants */
 } SortState;
 
 /* ----------------
@@ -2503,6 +2519,7 @@ typedef struct AggState
 	bool		table_filled;	/* hash table filled yet? */
 	int			num_hashes;
 	MemoryContext hash_metacxt; /* memory for hash table itself */
+	MemoryContext hash_tablecxt;	/* memory for hash table entries */
 	struct LogicalTapeSet *hash_tapeset;	/* tape set for hash spill tapes */
 	struct HashAggSpill *hash_spills;	/* HashAggSpill for each grouping set,
 										 * exists only during first pass */
@@ -2580,6 +2597,10 @@ typedef struct WindowAggState
 	struct WindowObjectData *agg_winobj;	/* winobj for aggregate fetches */
 	int64		aggregatedbase; /* start row for current aggregates */
 	int64		aggregatedupto; /* rows before this one are aggregated */
+	bool		use_segtree;	/* evaluate aggregates using segment trees? */
+	int64		segtree_rows;	/* # of partition rows in the segment trees,
+								 * 0 if not used for this partition, -1 if
+								 * not yet decided */
 	WindowAggStatus status;		/* run status of WindowAggState */
 
 	int			frameOptions;	/* frame_clause options, see WindowDef */
@@ -1083,6 +1083,8 @@ typedef struct SubPlan
 								 * simpler handling of null values */
 	bool		parallel_safe;	/* is the subplan parallel-safe? */
 	/* Note: parallel_safe does not consider contents of testexpr or args */
+	bool		memoize;		/* true if results may be cached by the
+								 * values of the parParams */
 	/* Information for passing params into and out of the subselect: */
 	/* setParam and parParam are lists of integers (param IDs) */
 	List	   *setParam;		/* initplan and MULTIEXPR subqueries have to
@@ -235,7 +235,7 @@ typedef struct PgStat_TableXactStatus
  * ------------------------------------------------------------
  */
 
-#define PGSTAT_FILE_FORMAT_ID	0x01A5BCAC
+#define PGSTAT_FILE_FORMAT_ID	0x01A5BCAF
 
 typedef struct PgStat_ArchiverStats
 {
@@ -301,16 +301,26 @@ typedef enum IOOp
 	IOOP_HIT,
 	IOOP_READ,
 	IOOP_REUSE,
+	IOOP_WAL_FLUSH,
 	IOOP_WRITE,
 	IOOP_WRITEBACK,
 } IOOp;
 
 #define IOOP_NUM_TYPES (IOOP_WRITEBACK + 1)
 
+/*
+ * Number of buckets in the IO latency histograms.  Bucket 0 counts
+ * operations that took less than 16 microseconds, and bucket i > 0 those
+ * that took 2^(i+3) to 2^(i+4) microseconds, with the last bucket being
+ * open-ended.  Latencies are only measured when track_io_timing is on.
+ */
+#define PGSTAT_IO_HIST_BUCKETS	16
+
 typedef struct PgStat_BktypeIO
 {
 	PgStat_Counter counts[IOOBJECT_NUM_TYPES][IOCONTEXT_NUM_TYPES][IOOP_NUM_TYPES];
 	PgStat_Counter times[IOOBJECT_NUM_TYPES][IOCONTEXT_NUM_TYPES][IOOP_NUM_TYPES];
+	PgStat_Counter hist[IOOBJECT_NUM_TYPES][IOCONTEXT_NUM_TYPES][IOOP_NUM_TYPES][PGSTAT_IO_HIST_BUCKETS];
 } PgStat_BktypeIO;
 
 typedef struct PgStat_IO
@@ -428,6 +438,15 @@ typedef struct PgStat_StatTabEntry
 	PgStat_Counter autoanalyze_count;
 } PgStat_StatTabEntry;
 
+/*
+ * Number of buckets in the histogram of WAL flush batch sizes.  Bucket 0
+ * counts flushes satisfying a single request, and bucket i > 0 those that
+ * satisfied 2^(i-1) + 1 to 2^i requests, with the last bucket being
+ * open-ended.  So the buckets are 1, 2, 3-4, 5-8, 9-16, 17-32, 33-64 and
+ * 65 or more.
+ */
+#define PGSTAT_WAL_FLUSH_BATCH_BUCKETS	8
+
 typedef struct PgStat_WalStats
 {
 	PgStat_Counter wal_records;
@@ -438,6 +457,7 @@ typedef struct PgStat_WalStats
 	PgStat_Counter wal_sync;
 	PgStat_Counter wal_write_time;
 	PgStat_Counter wal_sync_time;
+	PgStat_Counter wal_flush_batches[PGSTAT_WAL_FLUSH_BATCH_BUCKETS];
 	TimestampTz stat_reset_timestamp;
 } PgStat_WalStats;
 
@@ -454,6 +474,7 @@ typedef struct PgStat_PendingWalStats
 	PgStat_Counter wal_sync;
 	instr_time	wal_write_time;
 	instr_time	wal_sync_time;
+	PgStat_Counter wal_flush_batches[PGSTAT_WAL_FLUSH_BATCH_BUCKETS];
 } PgStat_PendingWalStats;
 
 
@@ -474,6 +495,9 @@ extern void pgstat_before_server_shutdown(int code, Datum arg);
 extern void pgstat_initialize(void);
 
 /* Functions called from backends */
+typedef long (*pgstat_report_stat_hook_type) (bool force);
+extern PGDLLIMPORT pgstat_report_stat_hook_type pgstat_report_stat_hook;
+
 extern long pgstat_report_stat(bool force);
 extern void pgstat_force_next_flush(void);
 
@@ -719,6 +743,7 @@ extern void pgstat_execute_transactional_drops(int ndrops, struct xl_xact_stats_
 
 extern void pgstat_report_wal(bool force);
 extern PgStat_WalStats *pgstat_fetch_stat_wal(void);
+extern void pgstat_count_wal_flush_batch(uint32 batch);
 
 
 /*
@@ -7,7 +7,9 @@
  * jump through some hoops to get the best implementation for each
  * platform. Some CPU architectures have special instructions for speeding
  * up CRC calculations (e.g. Intel SSE 4.2), on other platforms we use the
- * Slicing-by-8 algorithm which uses lookup tables.
+ * Slicing-by-8 algorithm which uses lookup tables.  On x86-64 with AVX-512,
+ * large inputs are additionally folded 64 bytes at a time with carry-less
+ * multiplication (VPCLMULQDQ).
  *
  * The public interface consists of four macros:
  *
@@ -41,7 +43,33 @@ typedef uint32 pg_crc32c;
 #define INIT_CRC32C(crc) ((crc) = 0xFFFFFFFF)
 #define EQ_CRC32C(c1, c2) ((c1) == (c2))
 
-#if defined(USE_SSE42_CRC32C)
+/*
+ * The AVX-512 implementation is part of pg_crc32c_sse42.c.  It can be used
+ * directly if the compiler is already targeting a CPU that has the required
+ * instructions.  Otherwise, if the compiler understands the corresponding
+ * function target attributes, it is built alongside the SSE 4.2 code and
+ * chosen at runtime.
+ */
+#if defined(USE_SSE42_CRC32C) && \
+	defined(__AVX512F__) && defined(__AVX512VL__) && defined(__VPCLMULQDQ__)
+#define USE_AVX512_CRC32C 1
+#elif defined(USE_SSE42_CRC32C_WITH_RUNTIME_CHECK) && defined(__x86_64__) && \
+	defined(HAVE__GET_CPUID) && defined(HAVE__GET_CPUID_COUNT) && \
+	((defined(__clang__) && __clang_major__ >= 7) || \
+	 (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8))
+#define USE_AVX512_CRC32C_WITH_RUNTIME_CHECK 1
+#endif
+
+#if defined(USE_AVX512_CRC32C)
+/* Use AVX-512 and Intel SSE4.2 instructions. */
+#define COMP_CRC32C(crc, data, len) \
+	((crc) = pg_comp_crc32c_avx512((crc), (data), (len)))
+#define FIN_CRC32C(crc) ((crc) ^= 0xFFFFFFFF)
+
+extern pg_crc32c pg_comp_crc32c_sse42(pg_crc32c crc, const void *data, size_t len);
+extern pg_crc32c pg_comp_crc32c_avx512(pg_crc32c crc, const void *data, size_t len);
+
+#elif defined(USE_SSE42_CRC32C)
 /* Use Intel SSE4.2 instructions. */
 #define COMP_CRC32C(crc, data, len) \
 	((crc) = pg_comp_crc32c_sse42((crc), (data), (len)))
@@ -83,6 +111,9 @@ extern pg_crc32c (*pg_comp_crc32c) (pg_crc32c crc, const void *data, size_t len)
 #ifdef USE_SSE42_CRC32C_WITH_RUNTIME_CHECK
 extern pg_crc32c pg_comp_crc32c_sse42(pg_crc32c crc, const void *data, size_t len);
 #endif
+#ifdef USE_AVX512_CRC32C_WITH_RUNTIME_CHECK
+extern pg_crc32c pg_comp_crc32c_avx512(pg_crc32c crc, const void *data, size_t len);
+#endif
 #ifdef USE_ARMV8_CRC32C_WITH_RUNTIME_CHECK
 extern pg_crc32c pg_comp_crc32c_armv8(pg_crc32c crc, const void *data, size_t len);
 #endif
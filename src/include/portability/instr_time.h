@@ -5,7 +5,9 @@
  *
  * This file provides an abstraction layer to hide portability issues in
  * interval timing.  On Unix we use clock_gettime(), and on Windows we use
- * QueryPerformanceCounter().  These macros also give some breathing room to
+ * QueryPerformanceCounter().  On x86-64 Linux, processes that have called
+ * pg_initialize_timing() read the CPU's time-stamp counter instead, when it
+ * is found to be reliable.  These macros also give some breathing room to
  * use other high-precision-timing APIs.
  *
  * The basic data type is instr_time, which all callers should treat as an
@@ -119,12 +121,52 @@ pg_clock_gettime_ns(void)
 	return now;
 }
 
+/*
+ * On x86-64 Linux, we can read the time-stamp counter instead.  Whether
+ * that's safe, and the length of a tick, are determined by
+ * pg_initialize_timing(); see src/common/instr_time.c.
+ */
+#if defined(__x86_64__) && defined(__linux__) && defined(HAVE__GET_CPUID)
+#define PG_INSTR_TSC 1
+#endif
+
+#ifdef PG_INSTR_TSC
+
+extern PGDLLIMPORT bool pg_instr_use_tsc;
+extern PGDLLIMPORT double pg_instr_ns_per_tick;
+
+/* helper for INSTR_TIME_SET_CURRENT */
+static inline instr_time
+pg_get_ticks(void)
+{
+	if (pg_instr_use_tsc)
+	{
+		instr_time	now;
+
+		now.ticks = __builtin_ia32_rdtsc();
+		return now;
+	}
+
+	return pg_clock_gettime_ns();
+}
+
+#define INSTR_TIME_SET_CURRENT(t) \
+	((t) = pg_get_ticks())
+
+#define INSTR_TIME_GET_NANOSEC(t) \
+	(pg_instr_use_tsc ? \
+	 (int64) ((t).ticks * pg_instr_ns_per_tick) : (int64) (t).ticks)
+
+#else							/* !PG_INSTR_TSC */
+
 #define INSTR_TIME_SET_CURRENT(t) \
 	((t) = pg_clock_gettime_ns())
 
 #define INSTR_TIME_GET_NANOSEC(t) \
 	((int64) (t).ticks)
 
+#endif							/* PG_INSTR_TSC */
+
 
 #else							/* WIN32 */
 
@@ -162,6 +204,8 @@ GetTimerFrequency(void)
 #endif							/* WIN32 */
 
 
+extern void pg_initialize_timing(void);
+
 /*
  * Common macros
  */
@@ -23,6 +23,7 @@
 typedef enum
 {
 	AVW_BRINSummarizeRange,
+	AVW_GINCleanPendingList,
 } AutoVacuumWorkItemType;
 
 
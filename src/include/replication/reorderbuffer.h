@@ -21,6 +21,7 @@
 /* GUC variables */
 extern PGDLLIMPORT int logical_decoding_work_mem;
 extern PGDLLIMPORT int debug_logical_replication_streaming;
+extern PGDLLIMPORT int logical_decoding_spill_compression;
 
 /* possible values for debug_logical_replication_streaming */
 typedef enum
@@ -634,6 +635,10 @@ struct ReorderBuffer
 	char	   *outbuf;
 	Size		outbufsize;
 
+	/* scratch buffer for compressing and decompressing spilled changes */
+	char	   *compressbuf;
+	Size		compressbufsize;
+
 	/* memory accounting */
 	Size		size;
 
@@ -16,6 +16,7 @@
 
 #include "access/xlog.h"
 #include "access/xlogdefs.h"
+#include "common/compression.h"
 #include "pgtime.h"
 #include "port/atomics.h"
 #include "replication/logicalproto.h"
@@ -29,6 +30,7 @@
 extern PGDLLIMPORT int wal_receiver_status_interval;
 extern PGDLLIMPORT int wal_receiver_timeout;
 extern PGDLLIMPORT bool hot_standby_feedback;
+extern PGDLLIMPORT int wal_receiver_compression;
 
 /*
  * MAXCONNINFO: maximum size of a connection string.
@@ -175,6 +177,8 @@ typedef struct
 		struct
 		{
 			TimeLineID	startpointTLI;	/* Starting timeline */
+			pg_compress_algorithm compression;	/* Requested compression of
+												 * WAL data */
 		}			physical;
 		struct
 		{
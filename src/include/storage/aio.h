@@ -0,0 +1,93 @@
+/*-------------------------------------------------------------------------
+ *
+ * aio.h
+ *	  Interface for issuing file I/O through a selectable I/O method
+ *
+ * Callers describe vectored reads and writes with a PgAioHandle, submit one
+ * or more handles together, and later wait for each of them to complete.
+ * Whether the I/O is actually performed at submission time or concurrently
+ * with the caller depends on the I/O method selected with io_method.
+ *
+ *
+ * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/aio.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef AIO_H
+#define AIO_H
+
+#include "storage/fd.h"
+
+/* Possible values for io_method */
+typedef enum IoMethod
+{
+	IOMETHOD_SYNC = 0,
+} IoMethod;
+
+#define DEFAULT_IO_METHOD IOMETHOD_SYNC
+
+/* Operations that can be described by a PgAioHandle */
+typedef enum PgAioOp
+{
+	PGAIO_OP_INVALID = 0,
+	PGAIO_OP_READV,
+	PGAIO_OP_WRITEV,
+} PgAioOp;
+
+typedef enum PgAioHandleState
+{
+	PGAIO_HS_IDLE = 0,			/* not in use */
+	PGAIO_HS_DEFINED,			/* prepared, but not yet submitted */
+	PGAIO_HS_SUBMITTED,			/* handed to the I/O method */
+	PGAIO_HS_COMPLETED,			/* result is available */
+} PgAioHandleState;
+
+/*
+ * Description of one I/O.  The handle is owned by the caller, typically as
+ * part of a larger operation struct, and the iovec array it points to must
+ * remain valid until pgaio_io_wait() has returned.
+ */
+typedef struct PgAioHandle
+{
+	PgAioHandleState state;
+	PgAioOp		op;
+	File		file;
+	off_t		offset;
+	const struct iovec *iov;
+	int			iovcnt;
+	uint32		wait_event_info;
+
+	/* set on completion */
+	ssize_t		result;
+	int			result_errno;
+} PgAioHandle;
+
+/*
+ * Callbacks implementing an I/O method.  submit() is handed a batch of
+ * handles in PGAIO_HS_SUBMITTED state, and must eventually move each of them
+ * to PGAIO_HS_COMPLETED.  wait_one() is called for a handle that has not yet
+ * completed, and must not return until it has.
+ */
+typedef struct IoMethodOps
+{
+	void		(*submit) (PgAioHandle **iohs, int nios);
+	void		(*wait_one) (PgAioHandle *ioh);
+} IoMethodOps;
+
+/* GUCs */
+extern PGDLLIMPORT int io_method;
+
+extern void pgaio_io_prep_readv(PgAioHandle *ioh, File file,
+								const struct iovec *iov, int iovcnt,
+								off_t offset, uint32 wait_event_info);
+extern void pgaio_io_prep_writev(PgAioHandle *ioh, File file,
+								 const struct iovec *iov, int iovcnt,
+								 off_t offset, uint32 wait_event_info);
+extern void pgaio_submit(PgAioHandle **iohs, int nios);
+extern void pgaio_io_submit(PgAioHandle *ioh);
+extern ssize_t pgaio_io_wait(PgAioHandle *ioh);
+
+#endif							/* AIO_H */
@@ -0,0 +1,25 @@
+/*-------------------------------------------------------------------------
+ *
+ * aio_internal.h
+ *	  Declarations shared between the AIO core and the I/O methods
+ *
+ *
+ * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/aio_internal.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef AIO_INTERNAL_H
+#define AIO_INTERNAL_H
+
+#include "storage/aio.h"
+
+/* aio.c */
+extern void pgaio_io_perform_synchronously(PgAioHandle *ioh);
+
+/* I/O methods */
+extern PGDLLIMPORT const IoMethodOps pgaio_sync_ops;
+
+#endif							/* AIO_INTERNAL_H */
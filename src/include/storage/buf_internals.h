@@ -311,6 +311,15 @@ extern PGDLLIMPORT BufferDescPadded *BufferDescriptors;
 extern PGDLLIMPORT ConditionVariableMinimallyPadded *BufferIOCVArray;
 extern PGDLLIMPORT WritebackContext BackendWritebackContext;
 
+/*
+ * Dense copy of each shared buffer's tag's relNumber, or InvalidRelFileNumber
+ * if the tag is clear.  It's set together with the tag, while holding the
+ * buffer header lock.  Scans of the whole buffer pool for the buffers of a
+ * relation read this instead of the descriptors, touching 4 bytes per buffer
+ * rather than a cache line, and recheck the tag of the buffers that match.
+ */
+extern PGDLLIMPORT RelFileNumber *BufferRelNumbers;
+
 /* in localbuf.c */
 extern PGDLLIMPORT BufferDesc *LocalBufferDescriptors;
 
@@ -426,6 +435,8 @@ extern BufferDesc *StrategyGetBuffer(BufferAccessStrategy strategy,
 extern void StrategyFreeBuffer(BufferDesc *buf);
 extern bool StrategyRejectBuffer(BufferAccessStrategy strategy,
 								 BufferDesc *buf, bool from_ring);
+extern void StrategyRememberEvicted(uint32 hashcode);
+extern uint32 StrategyInitialUsageCount(uint32 hashcode);
 
 extern int	StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc);
 extern void StrategyNotifyBgWriter(int bgwprocno);
@@ -439,6 +450,7 @@ extern Size BufTableShmemSize(int size);
 extern void InitBufTable(int size);
 extern uint32 BufTableHashCode(BufferTag *tagPtr);
 extern int	BufTableLookup(BufferTag *tagPtr, uint32 hashcode);
+extern int	BufTableLookupOptimistic(BufferTag *tagPtr, uint32 hashcode);
 extern int	BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id);
 extern void BufTableDelete(BufferTag *tagPtr, uint32 hashcode);
 
@@ -32,11 +32,23 @@
 
 typedef struct BufFile BufFile;
 
+/* Possible values for temp_file_compression */
+typedef enum TempFileCompression
+{
+	TEMP_FILE_COMPRESSION_NONE,
+	TEMP_FILE_COMPRESSION_PGLZ,
+	TEMP_FILE_COMPRESSION_LZ4,
+} TempFileCompression;
+
+/* GUC */
+extern PGDLLIMPORT int temp_file_compression;
+
 /*
  * prototypes for functions in buffile.c
  */
 
 extern BufFile *BufFileCreateTemp(bool interXact);
+extern BufFile *BufFileCreateCompressTemp(bool interXact);
 extern void BufFileClose(BufFile *file);
 extern pg_nodiscard size_t BufFileRead(BufFile *file, void *ptr, size_t size);
 extern void BufFileReadExact(BufFile *file, void *ptr, size_t size);
@@ -45,6 +57,7 @@ extern void BufFileWrite(BufFile *file, const void *ptr, size_t size);
 extern int	BufFileSeek(BufFile *file, int fileno, off_t offset, int whence);
 extern void BufFileTell(BufFile *file, int *fileno, off_t *offset);
 extern int	BufFileSeekBlock(BufFile *file, int64 blknum);
+extern void BufFilePrefetchBlock(BufFile *file, int64 blknum, int nblocks);
 extern int64 BufFileSize(BufFile *file);
 extern int64 BufFileAppend(BufFile *target, BufFile *source);
 
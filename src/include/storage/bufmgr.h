@@ -39,6 +39,13 @@ typedef enum BufferAccessStrategyType
 	BAS_VACUUM,					/* VACUUM */
 } BufferAccessStrategyType;
 
+/* Possible values for buffer_replacement_policy */
+typedef enum BufferReplacementPolicy
+{
+	BUFFER_REPLACEMENT_CLOCK_SWEEP,
+	BUFFER_REPLACEMENT_SCAN_RESISTANT,
+} BufferReplacementPolicy;
+
 /* Possible modes for ReadBufferExtended() */
 typedef enum
 {
@@ -315,6 +322,7 @@ extern Size BufferShmemSize(void);
 extern void AtProcExit_LocalBuffers(void);
 
 /* in freelist.c */
+extern PGDLLIMPORT int buffer_replacement_policy;
 
 extern BufferAccessStrategy GetAccessStrategy(BufferAccessStrategyType btype);
 extern BufferAccessStrategy GetAccessStrategyWithSize(BufferAccessStrategyType btype,
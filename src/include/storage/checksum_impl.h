@@ -102,6 +102,17 @@
 
 #include "storage/bufpage.h"
 
+/*
+ * On x86-64, also build a copy of the block checksum loop that the compiler
+ * may vectorize with AVX2, and choose between it and the baseline version
+ * at runtime.  Both run exactly the same algorithm, so the result does not
+ * depend on which one is used.
+ */
+#if defined(__x86_64__) && defined(HAVE__GET_CPUID) && __has_attribute (target)
+#define USE_AVX2_CHECKSUM_WITH_RUNTIME_CHECK
+#include <cpuid.h>
+#endif
+
 /* number of checksums to calculate in parallel */
 #define N_SUMS 32
 /* prime multiplier of FNV-1a hash */
@@ -142,8 +153,8 @@ do { \
  * Block checksum algorithm.  The page must be adequately aligned
  * (at least on 4-byte boundary).
  */
-static uint32
-pg_checksum_block(const PGChecksummablePage *page)
+static pg_attribute_always_inline uint32
+pg_checksum_block_internal(const PGChecksummablePage *page)
 {
 	uint32		sums[N_SUMS];
 	uint32		result = 0;
@@ -173,6 +184,74 @@ pg_checksum_block(const PGChecksummablePage *page)
 	return result;
 }
 
+#ifdef USE_AVX2_CHECKSUM_WITH_RUNTIME_CHECK
+
+static uint32
+pg_checksum_block_default(const PGChecksummablePage *page)
+{
+	return pg_checksum_block_internal(page);
+}
+
+pg_attribute_target("avx2")
+static uint32
+pg_checksum_block_avx2(const PGChecksummablePage *page)
+{
+	return pg_checksum_block_internal(page);
+}
+
+/*
+ * Does the CPU support AVX2, and does the OS save the YMM registers?
+ */
+static bool
+pg_checksum_avx2_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	uint32		eax;
+	uint32		edx;
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[2] & (1 << 27)) == 0)	/* OSXSAVE */
+		return false;
+
+	/* see zmm_regs_available() in src/port/pg_crc32c_sse42_choose.c */
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	if ((eax & 0x06) != 0x06)	/* XMM and YMM state */
+		return false;
+
+	__get_cpuid_count(7, 0, &exx[0], &exx[1], &exx[2], &exx[3]);
+	return (exx[1] & (1 << 5)) != 0;	/* AVX2 */
+}
+
+static uint32 pg_checksum_block_choose(const PGChecksummablePage *page);
+
+static uint32 (*pg_checksum_block) (const PGChecksummablePage *page) =
+	pg_checksum_block_choose;
+
+/*
+ * This gets called on the first call. It replaces the function pointer
+ * so that subsequent calls are routed directly to the chosen implementation.
+ */
+static uint32
+pg_checksum_block_choose(const PGChecksummablePage *page)
+{
+	if (pg_checksum_avx2_available())
+		pg_checksum_block = pg_checksum_block_avx2;
+	else
+		pg_checksum_block = pg_checksum_block_default;
+
+	return pg_checksum_block(page);
+}
+
+#else							/* !USE_AVX2_CHECKSUM_WITH_RUNTIME_CHECK */
+
+static uint32
+pg_checksum_block(const PGChecksummablePage *page)
+{
+	return pg_checksum_block_internal(page);
+}
+
+#endif							/* USE_AVX2_CHECKSUM_WITH_RUNTIME_CHECK */
+
 /*
  * Compute the checksum for a Postgres page.
  *
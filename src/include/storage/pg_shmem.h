@@ -45,6 +45,7 @@ typedef struct PGShmemHeader	/* standard header for all Postgres shmem */
 extern PGDLLIMPORT int shared_memory_type;
 extern PGDLLIMPORT int huge_pages;
 extern PGDLLIMPORT int huge_page_size;
+extern PGDLLIMPORT int shared_memory_numa;
 
 /* Possible values for huge_pages and huge_pages_status */
 typedef enum
@@ -55,6 +56,13 @@ typedef enum
 	HUGE_PAGES_UNKNOWN,			/* only for huge_pages_status */
 }			HugePagesType;
 
+/* Possible values for shared_memory_numa */
+typedef enum
+{
+	SHMEM_NUMA_OFF,
+	SHMEM_NUMA_INTERLEAVE,
+}			ShmemNumaPolicy;
+
 /* Possible values for shared_memory_type */
 typedef enum
 {
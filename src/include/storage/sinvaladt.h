@@ -31,6 +31,7 @@
 extern Size SInvalShmemSize(void);
 extern void CreateSharedInvalidationState(void);
 extern void SharedInvalBackendInit(bool sendOnly);
+extern void SharedInvalSetDatabase(Oid dbid);
 
 extern void SIInsertDataEntries(const SharedInvalidationMessage *data, int n);
 extern int	SIGetDataEntries(SharedInvalidationMessage *data, int datasize);
@@ -38,4 +39,7 @@ extern void SICleanupQueue(bool callerHasWriteLock, int minFree);
 
 extern LocalTransactionId GetNextLocalTransactionId(void);
 
+/* GUC variable */
+extern PGDLLIMPORT int invalidation_queue_size;
+
 #endif							/* SINVALADT_H */
@@ -22,6 +22,7 @@
 
 #include "access/htup.h"
 #include "access/skey.h"
+#include "datatype/timestamp.h"
 #include "lib/ilist.h"
 #include "utils/relcache.h"
 
@@ -105,6 +106,13 @@ typedef struct catctup
 	 */
 	dlist_node	cache_elem;		/* list member of per-bucket list */
 
+	/*
+	 * Every tuple is also a member of a single list spanning all caches, kept
+	 * in least-recently-used-first order, which is used to enforce
+	 * catalog_cache_memory_limit.
+	 */
+	dlist_node	lru_elem;		/* list member of CacheHdr->ch_lru */
+
 	/*
 	 * A tuple marked "dead" must not be returned by subsequent searches.
 	 * However, it won't be physically deleted from the cache until its
@@ -132,6 +140,7 @@ typedef struct catctup
 	struct catclist *c_list;	/* containing CatCList, or NULL if none */
 
 	CatCache   *my_cache;		/* link to owning catcache */
+	TimestampTz lastaccess;		/* catcacheclock at last lookup hit */
 	/* properly aligned tuple data follows, unless a negative entry */
 } CatCTup;
 
@@ -185,9 +194,31 @@ typedef struct catcacheheader
 {
 	slist_head	ch_caches;		/* head of list of CatCache structs */
 	int			ch_ntup;		/* # of tuples in all caches */
+	Size		ch_nbytes;		/* approx. memory used by those tuples */
+	dlist_head	ch_lru;			/* all tuples, least recently used first */
 } CatCacheHeader;
 
 
+/* GUC parameter: minimum idle age (seconds) before pruning, or -1 */
+extern PGDLLIMPORT int catalog_cache_prune_min_age;
+
+/* GUC parameter: memory budget for catcache entries in kilobytes, or 0 */
+extern PGDLLIMPORT int catalog_cache_memory_limit;
+
+/* coarse clock used to age catcache entries; see SetCatCacheClock() */
+extern PGDLLIMPORT TimestampTz catcacheclock;
+
+/*
+ * Advance the catcache clock.  This is called at statement start, so entries
+ * are aged in units of statements rather than by reading the system clock on
+ * every cache hit.
+ */
+static inline void
+SetCatCacheClock(TimestampTz ts)
+{
+	catcacheclock = ts;
+}
+
 /* this extern duplicates utils/memutils.h... */
 extern PGDLLIMPORT MemoryContext CacheMemoryContext;
 
@@ -66,6 +66,15 @@ extern PGDLLIMPORT MemoryContext CurTransactionContext;
 /* This is a transient link to the active portal's memory context: */
 extern PGDLLIMPORT MemoryContext PortalContext;
 
+/* GUC: cap on memory held by this backend's memory contexts, in kB */
+extern PGDLLIMPORT int backend_memory_limit;
+
+/*
+ * Smallest nonzero backend_memory_limit, in kB.  An idle backend's caches
+ * alone take a few MB, so anything less would fail every query.
+ */
+#define MIN_BACKEND_MEMORY_LIMIT	(8 * 1024)
+
 
 /*
  * Memory-context-type-independent functions in mcxt.c
@@ -163,6 +163,46 @@ extern void *MemoryContextAllocationFailure(MemoryContext context, Size size,
 extern void MemoryContextSizeFailure(MemoryContext context, Size size,
 									 int flags) pg_attribute_noreturn();
 
+extern void *MemoryContextLimitFailure(MemoryContext context, Size size,
+									   int flags);
+extern bool MemoryContextLimitExceeded(MemoryContext context, Size size);
+
+/*
+ * Sum of mem_allocated over all live memory contexts of this backend.  The
+ * context implementations must keep it up to date by adjusting mem_allocated
+ * only through MemoryContextAccountAlloc() and MemoryContextAccountFree().
+ * MemoryContextDelete() takes care of whatever a deleted context still had.
+ */
+extern PGDLLIMPORT Size MemoryContextTotalAllocated;
+
+static inline void
+MemoryContextAccountAlloc(MemoryContext context, Size size)
+{
+	context->mem_allocated += size;
+	MemoryContextTotalAllocated += size;
+}
+
+static inline void
+MemoryContextAccountFree(MemoryContext context, Size size)
+{
+	context->mem_allocated -= size;
+	MemoryContextTotalAllocated -= size;
+}
+
+/*
+ * Would malloc'ing another 'size' bytes for 'context' take this backend over
+ * backend_memory_limit?  Context implementations check this before
+ * allocating a new block, and fail the allocation via
+ * MemoryContextLimitFailure() if so.
+ */
+static inline bool
+MemoryContextWouldExceedLimit(MemoryContext context, Size size)
+{
+	if (likely(backend_memory_limit == 0))
+		return false;
+	return MemoryContextLimitExceeded(context, size);
+}
+
 static inline void
 MemoryContextCheckSize(MemoryContext context, Size size, int flags)
 {
@@ -130,6 +130,8 @@ typedef struct CachedPlanSource
 	/* State kept to help decide whether to use custom or generic plans: */
 	double		generic_cost;	/* cost of generic plan, or -1 if not known */
 	double		total_custom_cost;	/* total cost of custom plans so far */
+	double		min_custom_cost;	/* cheapest custom plan, or -1 if none */
+	double		max_custom_cost;	/* costliest custom plan, or -1 if none */
 	int64		num_custom_plans;	/* # of custom plans included in total */
 	int64		num_generic_plans;	/* # of generic plans */
 } CachedPlanSource;
@@ -215,6 +217,8 @@ extern void CachedPlanSetParentContext(CachedPlanSource *plansource,
 extern CachedPlanSource *CopyCachedPlan(CachedPlanSource *plansource);
 
 extern bool CachedPlanIsValid(CachedPlanSource *plansource);
+extern void CachedPlanResetPlanChoice(CachedPlanSource *plansource);
+extern bool CachedPlanMatchesEnvironment(CachedPlanSource *plansource);
 
 extern List *CachedPlanGetTargetList(CachedPlanSource *plansource,
 									 QueryEnvironment *queryEnv);
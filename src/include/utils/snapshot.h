@@ -181,6 +181,14 @@ typedef struct SnapshotData
 	int32		subxcnt;		/* # of xact ids in subxip[] */
 	bool		suboverflowed;	/* has the subxip array overflowed? */
 
+	/*
+	 * For non-historic MVCC snapshots, XidInMVCCSnapshot() sorts large xip[]
+	 * and subxip[] arrays in place once it has searched them often enough,
+	 * and binary-searches them from then on.
+	 */
+	bool		xidssorted;		/* are xip[] and subxip[] sorted? */
+	uint32		xidsearches;	/* # of linear array searches so far */
+
 	bool		takenDuringRecovery;	/* recovery-shaped snapshot? */
 	bool		copied;			/* false if it's a static snapshot */
 
@@ -376,6 +376,10 @@ extern Tuplesortstate *tuplesort_begin_common(int workMem,
 											  int sortopt);
 extern void tuplesort_set_bound(Tuplesortstate *state, int64 bound);
 extern bool tuplesort_used_bound(Tuplesortstate *state);
+extern bool tuplesort_get_bound_threshold(Tuplesortstate *state,
+										  Datum *datum, bool *isnull);
+extern void tuplesort_set_bound_threshold(Tuplesortstate *state,
+										  Datum datum, bool isnull);
 extern void tuplesort_puttuple_common(Tuplesortstate *state,
 									  SortTuple *tuple, bool useAbbrev,
 									  Size tuplen);
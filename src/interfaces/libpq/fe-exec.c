@@ -1209,6 +1209,8 @@ pqRowProcessor(PGconn *conn, const char **errmsgp)
 	int			nfields = res->numAttributes;
 	const PGdataValue *columns = conn->rowBuf;
 	PGresAttValue *tup;
+	char	   *space;
+	size_t		rowsize;
 	int			i;
 
 	/*
@@ -1236,17 +1238,34 @@ pqRowProcessor(PGconn *conn, const char **errmsgp)
 
 	/*
 	 * Basically we just allocate space in the PGresult for each field and
-	 * copy the data over.
+	 * copy the data over.  To keep the per-row cost down, the attribute
+	 * array and all the values are carved out of a single allocation, laid
+	 * out just as separate pqResultAlloc() calls would have done: binary
+	 * values are aligned, text values are not.  The rows of a result are
+	 * therefore also contiguous in memory for the common case of small rows.
 	 *
 	 * Note: on malloc failure, we return 0 leaving *errmsgp still NULL, which
 	 * caller will take to mean "out of memory".  This is preferable to trying
 	 * to set up such a message here, because evidently there's not enough
 	 * memory for gettext() to do anything.
 	 */
-	tup = (PGresAttValue *)
-		pqResultAlloc(res, nfields * sizeof(PGresAttValue), true);
-	if (tup == NULL)
+	rowsize = nfields * sizeof(PGresAttValue);
+	for (i = 0; i < nfields; i++)
+	{
+		int			clen = columns[i].len;
+
+		if (clen < 0)
+			continue;
+		if (res->attDescs[i].format != 0)
+			rowsize = TYPEALIGN(PGRESULT_ALIGN_BOUNDARY, rowsize);
+		rowsize += clen + 1;
+	}
+
+	space = (char *) pqResultAlloc(res, rowsize, true);
+	if (space == NULL)
 		return 0;
+	tup = (PGresAttValue *) space;
+	rowsize = nfields * sizeof(PGresAttValue);
 
 	for (i = 0; i < nfields; i++)
 	{
@@ -1260,12 +1279,12 @@ pqRowProcessor(PGconn *conn, const char **errmsgp)
 		}
 		else
 		{
-			bool		isbinary = (res->attDescs[i].format != 0);
 			char	   *val;
 
-			val = (char *) pqResultAlloc(res, clen + 1, isbinary);
-			if (val == NULL)
-				return 0;
+			if (res->attDescs[i].format != 0)
+				rowsize = TYPEALIGN(PGRESULT_ALIGN_BOUNDARY, rowsize);
+			val = space + rowsize;
+			rowsize += clen + 1;
 
 			/* copy and zero-terminate the data (even if it's binary) */
 			memcpy(val, columns[i].value, clen);
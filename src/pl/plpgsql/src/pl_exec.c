@@ -318,6 +318,9 @@ static int	exec_stmt_raise(PLpgSQL_execstate *estate,
 							PLpgSQL_stmt_raise *stmt);
 static int	exec_stmt_assert(PLpgSQL_execstate *estate,
 							 PLpgSQL_stmt_assert *stmt);
+static bool exec_stmt_execsql_simple(PLpgSQL_execstate *estate,
+									 PLpgSQL_stmt_execsql *stmt);
+static void exec_stmt_execsql_error_callback(void *arg);
 static int	exec_stmt_execsql(PLpgSQL_execstate *estate,
 							  PLpgSQL_stmt_execsql *stmt);
 static int	exec_stmt_dynexecute(PLpgSQL_execstate *estate,
@@ -380,6 +383,13 @@ static int	exec_run_select(PLpgSQL_execstate *estate,
 							PLpgSQL_expr *expr, long maxtuples, Portal *portalP);
 static int	exec_for_query(PLpgSQL_execstate *estate, PLpgSQL_stmt_forq *stmt,
 						   Portal portal, bool prefetch_ok);
+static int	exec_for_query_materialized(PLpgSQL_execstate *estate,
+										PLpgSQL_stmt_forq *stmt,
+										PLpgSQL_expr *expr);
+static void exec_for_query_assign(PLpgSQL_execstate *estate,
+								  PLpgSQL_variable *var,
+								  HeapTuple tup, TupleDesc tupdesc,
+								  uint64 *previous_id, bool *tupdescs_match);
 static ParamListInfo setup_param_list(PLpgSQL_execstate *estate,
 									  PLpgSQL_expr *expr);
 static ParamExternData *plpgsql_param_fetch(ParamListInfo params,
@@ -2827,6 +2837,17 @@ exec_stmt_fors(PLpgSQL_execstate *estate, PLpgSQL_stmt_fors *stmt)
 	Portal		portal;
 	int			rc;
 
+	/*
+	 * If allowed, run the whole query up front so that it can use a
+	 * parallel plan.  We can't do that in a non-atomic context, since the
+	 * stored rows might contain toast pointers that a COMMIT in the loop
+	 * body would leave dangling.
+	 */
+	if (plpgsql_parallel_for_loops && estate->atomic)
+		return exec_for_query_materialized(estate,
+										   (PLpgSQL_stmt_forq *) stmt,
+										   stmt->query);
+
 	/*
 	 * Open the implicit cursor for the statement using exec_run_select
 	 */
@@ -4259,6 +4280,14 @@ exec_stmt_execsql(PLpgSQL_execstate *estate,
 		stmt->mod_stmt_set = true;
 	}
 
+	/*
+	 * A SELECT INTO of a simple expression can skip SPI and the executor
+	 * entirely.
+	 */
+	if (stmt->into && !stmt->mod_stmt &&
+		exec_stmt_execsql_simple(estate, stmt))
+		return PLPGSQL_RC_OK;
+
 	/*
 	 * Set up ParamListInfo to pass to executor
 	 */
@@ -4435,6 +4464,76 @@ exec_stmt_execsql(PLpgSQL_execstate *estate,
 	return PLPGSQL_RC_OK;
 }
 
+/* ----------
+ * exec_stmt_execsql_simple		Try to execute a SELECT INTO as a simple
+ *								expression.
+ *
+ * "SELECT a + b INTO x" is a simple expression that always returns exactly
+ * one row, so we can evaluate it the way exec_assign_expr would evaluate
+ * "x := a + b", rather than starting up the executor through SPI.  This is
+ * only done for a single scalar target; row and record targets would need a
+ * tuple built for exec_move_row, which is most of what we're trying to save.
+ *
+ * Returns false if the statement must be run the hard way.
+ * ----------
+ */
+static bool
+exec_stmt_execsql_simple(PLpgSQL_execstate *estate,
+						 PLpgSQL_stmt_execsql *stmt)
+{
+	PLpgSQL_expr *expr = stmt->sqlstmt;
+	PLpgSQL_datum *target;
+	ErrorContextCallback errcallback;
+	Datum		value;
+	bool		isnull;
+	Oid			valtype;
+	int32		valtypmod;
+
+	if (expr->expr_simple_expr == NULL)
+		return false;
+
+	target = estate->datums[stmt->target->dno];
+	if (target->dtype != PLPGSQL_DTYPE_ROW ||
+		((PLpgSQL_row *) target)->nfields != 1)
+		return false;
+	target = estate->datums[((PLpgSQL_row *) target)->varnos[0]];
+
+	/* Report errors the same way SPI would */
+	errcallback.callback = exec_stmt_execsql_error_callback;
+	errcallback.arg = (void *) expr;
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	if (!exec_eval_simple_expr(estate, expr,
+							   &value, &isnull, &valtype, &valtypmod))
+	{
+		error_context_stack = errcallback.previous;
+		return false;
+	}
+
+	error_context_stack = errcallback.previous;
+
+	exec_assign_value(estate, target, value, isnull, valtype, valtypmod);
+	exec_eval_cleanup(estate);
+
+	/* Same results as SPI would have given for the one-row SELECT */
+	exec_set_found(estate, true);
+	estate->eval_processed = 1;
+
+	return true;
+}
+
+/*
+ * error context callback for exec_stmt_execsql_simple
+ */
+static void
+exec_stmt_execsql_error_callback(void *arg)
+{
+	PLpgSQL_expr *expr = (PLpgSQL_expr *) arg;
+
+	errcontext("SQL statement \"%s\"", expr->query);
+}
+
 
 /* ----------
  * exec_stmt_dynexecute			Execute a dynamic SQL query
@@ -5910,57 +6009,10 @@ exec_for_query(PLpgSQL_execstate *estate, PLpgSQL_stmt_forq *stmt,
 
 		for (i = 0; i < n; i++)
 		{
-			/*
-			 * Assign the tuple to the target.  Here, because we know that all
-			 * loop iterations should be assigning the same tupdesc, we can
-			 * optimize away repeated creations of expanded records with
-			 * identical tupdescs.  Testing for changes of er_tupdesc_id is
-			 * reliable even if the loop body contains assignments that
-			 * replace the target's value entirely, because it's assigned from
-			 * a process-global counter.  The case where the tupdescs don't
-			 * match could possibly be handled more efficiently than this
-			 * coding does, but it's not clear extra effort is worthwhile.
-			 */
-			if (var->dtype == PLPGSQL_DTYPE_REC)
-			{
-				PLpgSQL_rec *rec = (PLpgSQL_rec *) var;
-
-				if (rec->erh &&
-					rec->erh->er_tupdesc_id == previous_id &&
-					tupdescs_match)
-				{
-					/* Only need to assign a new tuple value */
-					expanded_record_set_tuple(rec->erh, tuptab->vals[i],
-											  true, !estate->atomic);
-				}
-				else
-				{
-					/*
-					 * First time through, or var's tupdesc changed in loop,
-					 * or we have to do it the hard way because type coercion
-					 * is needed.
-					 */
-					exec_move_row(estate, var,
-								  tuptab->vals[i], tuptab->tupdesc);
-
-					/*
-					 * Check to see if physical assignment is OK next time.
-					 * Once the tupdesc comparison has failed once, we don't
-					 * bother rechecking in subsequent loop iterations.
-					 */
-					if (tupdescs_match)
-					{
-						tupdescs_match =
-							(rec->rectypeid == RECORDOID ||
-							 rec->rectypeid == tuptab->tupdesc->tdtypeid ||
-							 compatible_tupdescs(tuptab->tupdesc,
-												 expanded_record_get_tupdesc(rec->erh)));
-					}
-					previous_id = rec->erh->er_tupdesc_id;
-				}
-			}
-			else
-				exec_move_row(estate, var, tuptab->vals[i], tuptab->tupdesc);
+			/* Assign the tuple to the target */
+			exec_for_query_assign(estate, var,
+								  tuptab->vals[i], tuptab->tupdesc,
+								  &previous_id, &tupdescs_match);
 
 			exec_eval_cleanup(estate);
 
@@ -6002,6 +6054,196 @@ loop_exit:
 	return rc;
 }
 
+/*
+ * exec_for_query_materialized --- FOR loop over a query run to completion
+ *
+ * When plpgsql.parallel_for_loops is on, a FOR loop over a static query
+ * first runs the query to completion, storing its result in a tuplestore,
+ * and then executes the loop body for each stored row.  Unlike reading the
+ * rows through a cursor, that lets the query use a parallel plan, since
+ * nothing the loop body does can happen while the query is running.  The
+ * price is that the whole result is computed even if the loop exits early.
+ */
+static int
+exec_for_query_materialized(PLpgSQL_execstate *estate,
+							PLpgSQL_stmt_forq *stmt,
+							PLpgSQL_expr *expr)
+{
+	PLpgSQL_variable *var;
+	MemoryContext store_cxt;
+	MemoryContext oldcontext;
+	Tuplestorestate *tupstore;
+	DestReceiver *treceiver;
+	ParamListInfo paramLI;
+	SPIExecuteOptions options;
+	CachedPlanSource *plansource;
+	TupleDesc	tupdesc;
+	TupleTableSlot *slot;
+	bool		found = false;
+	int			rc;
+	uint64		previous_id = INVALID_TUPLEDESC_IDENTIFIER;
+	bool		tupdescs_match = true;
+
+	/* Fetch loop variable's datum entry */
+	var = (PLpgSQL_variable *) estate->datums[stmt->var->dno];
+
+	/*
+	 * On the first call for this expression generate the plan.  As in
+	 * exec_run_select, we don't expect any cursor operations to be done.
+	 */
+	if (expr->plan == NULL)
+		exec_prepare_plan(estate, expr,
+						  CURSOR_OPT_NO_SCROLL | CURSOR_OPT_PARALLEL_OK);
+
+	/*
+	 * The stored rows have to survive the execution of the loop body, so
+	 * keep them in a context of their own.
+	 */
+	store_cxt = AllocSetContextCreate(CurrentMemoryContext,
+									  "PL/pgSQL FOR loop results",
+									  ALLOCSET_DEFAULT_SIZES);
+	oldcontext = MemoryContextSwitchTo(store_cxt);
+	tupstore = tuplestore_begin_heap(false, false, work_mem);
+	treceiver = CreateDestReceiver(DestTuplestore);
+	SetTuplestoreDestReceiverParams(treceiver, tupstore, store_cxt,
+									false, NULL, NULL);
+	MemoryContextSwitchTo(oldcontext);
+
+	/*
+	 * Execute the query.  Since the whole result is fetched at once, the
+	 * executor is free to choose a parallel plan.
+	 */
+	paramLI = setup_param_list(estate, expr);
+
+	memset(&options, 0, sizeof(options));
+	options.params = paramLI;
+	options.read_only = estate->readonly_func;
+	options.must_return_tuples = true;
+	options.dest = treceiver;
+
+	rc = SPI_execute_plan_extended(expr->plan, &options);
+	if (rc < 0)
+		elog(ERROR, "SPI_execute_plan_extended failed executing query \"%s\": %s",
+			 expr->query, SPI_result_code_string(rc));
+	treceiver->rDestroy(treceiver);
+	exec_eval_cleanup(estate);
+
+	/*
+	 * Get the result's tuple descriptor.  Copy it, since the loop body could
+	 * cause the plan to be revalidated.
+	 */
+	plansource = (CachedPlanSource *)
+		linitial(SPI_plan_get_plan_sources(expr->plan));
+	oldcontext = MemoryContextSwitchTo(store_cxt);
+	tupdesc = CreateTupleDescCopy(plansource->resultDesc);
+	slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsMinimalTuple);
+	MemoryContextSwitchTo(oldcontext);
+
+	rc = PLPGSQL_RC_OK;
+
+	while (tuplestore_gettupleslot(tupstore, true, false, slot))
+	{
+		HeapTuple	tup;
+		bool		shouldFree;
+
+		found = true;
+
+		tup = ExecFetchSlotHeapTuple(slot, false, &shouldFree);
+		exec_for_query_assign(estate, var, tup, tupdesc,
+							  &previous_id, &tupdescs_match);
+		if (shouldFree)
+			heap_freetuple(tup);
+
+		exec_eval_cleanup(estate);
+
+		/*
+		 * Execute the statements
+		 */
+		rc = exec_stmts(estate, stmt->body);
+
+		LOOP_RC_PROCESSING(stmt->label, break);
+	}
+
+	/*
+	 * If the query didn't return any rows, set the target to NULL.
+	 */
+	if (!found)
+	{
+		exec_move_row(estate, var, NULL, tupdesc);
+		exec_eval_cleanup(estate);
+	}
+
+	ExecDropSingleTupleTableSlot(slot);
+	tuplestore_end(tupstore);
+	MemoryContextDelete(store_cxt);
+
+	/*
+	 * Set the FOUND variable to indicate the result of executing the loop
+	 * (namely, whether we looped one or more times).
+	 */
+	exec_set_found(estate, found);
+
+	return rc;
+}
+
+/*
+ * exec_for_query_assign --- assign one row of a FOR loop's query to its target
+ *
+ * Here, because we know that all loop iterations should be assigning the
+ * same tupdesc, we can optimize away repeated creations of expanded records
+ * with identical tupdescs.  Testing for changes of er_tupdesc_id is reliable
+ * even if the loop body contains assignments that replace the target's value
+ * entirely, because it's assigned from a process-global counter.  The case
+ * where the tupdescs don't match could possibly be handled more efficiently
+ * than this coding does, but it's not clear extra effort is worthwhile.
+ *
+ * *previous_id and *tupdescs_match carry that state between calls; the
+ * caller initializes them to INVALID_TUPLEDESC_IDENTIFIER and true.
+ */
+static void
+exec_for_query_assign(PLpgSQL_execstate *estate, PLpgSQL_variable *var,
+					  HeapTuple tup, TupleDesc tupdesc,
+					  uint64 *previous_id, bool *tupdescs_match)
+{
+	if (var->dtype == PLPGSQL_DTYPE_REC)
+	{
+		PLpgSQL_rec *rec = (PLpgSQL_rec *) var;
+
+		if (rec->erh &&
+			rec->erh->er_tupdesc_id == *previous_id &&
+			*tupdescs_match)
+		{
+			/* Only need to assign a new tuple value */
+			expanded_record_set_tuple(rec->erh, tup, true, !estate->atomic);
+		}
+		else
+		{
+			/*
+			 * First time through, or var's tupdesc changed in loop, or we
+			 * have to do it the hard way because type coercion is needed.
+			 */
+			exec_move_row(estate, var, tup, tupdesc);
+
+			/*
+			 * Check to see if physical assignment is OK next time.  Once the
+			 * tupdesc comparison has failed once, we don't bother rechecking
+			 * in subsequent loop iterations.
+			 */
+			if (*tupdescs_match)
+			{
+				*tupdescs_match =
+					(rec->rectypeid == RECORDOID ||
+					 rec->rectypeid == tupdesc->tdtypeid ||
+					 compatible_tupdescs(tupdesc,
+										 expanded_record_get_tupdesc(rec->erh)));
+			}
+			*previous_id = rec->erh->er_tupdesc_id;
+		}
+	}
+	else
+		exec_move_row(estate, var, tup, tupdesc);
+}
+
 
 /* ----------
  * exec_eval_simple_expr -		Evaluate a simple expression returning
@@ -47,6 +47,8 @@ bool		plpgsql_print_strict_params = false;
 
 bool		plpgsql_check_asserts = true;
 
+bool		plpgsql_parallel_for_loops = false;
+
 char	   *plpgsql_extra_warnings_string = NULL;
 char	   *plpgsql_extra_errors_string = NULL;
 int			plpgsql_extra_warnings;
@@ -177,6 +179,14 @@ _PG_init(void)
 							 PGC_USERSET, 0,
 							 NULL, NULL, NULL);
 
+	DefineCustomBoolVariable("plpgsql.parallel_for_loops",
+							 gettext_noop("Runs the query of a FOR loop to completion before the loop body, allowing a parallel plan."),
+							 NULL,
+							 &plpgsql_parallel_for_loops,
+							 false,
+							 PGC_USERSET, 0,
+							 NULL, NULL, NULL);
+
 	DefineCustomStringVariable("plpgsql.extra_warnings",
 							   gettext_noop("List of programming constructs that should produce a warning."),
 							   NULL,
@@ -1199,6 +1199,8 @@ extern bool plpgsql_print_strict_params;
 
 extern bool plpgsql_check_asserts;
 
+extern bool plpgsql_parallel_for_loops;
+
 /* extra compile-time and run-time checks */
 #define PLPGSQL_XCHECK_NONE						0
 #define PLPGSQL_XCHECK_SHADOWVAR				(1 << 1)
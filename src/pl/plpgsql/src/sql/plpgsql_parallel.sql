@@ -0,0 +1,137 @@
+--
+-- Tests for plpgsql.parallel_for_loops, which runs the query of a FOR loop
+-- to completion before the loop body so that it can use a parallel plan.
+-- The loop body itself must run normally: it may modify data and raise
+-- errors.
+--
+
+create table parfor_src (a int, b text);
+insert into parfor_src select g, 'row ' || g from generate_series(1, 10000) g;
+analyze parfor_src;
+create table parfor_dst (a int);
+
+create function parfor_copy() returns bigint language plpgsql as $$
+declare
+  r record;
+  n bigint := 0;
+begin
+  for r in select a from parfor_src where a % 10 = 0 loop
+    insert into parfor_dst values (r.a);
+    n := n + 1;
+  end loop;
+  return n;
+end;
+$$;
+
+create function parfor_update() returns bigint language plpgsql as $$
+declare
+  r record;
+  n bigint := 0;
+begin
+  for r in select a from parfor_src where a <= 100 loop
+    update parfor_src set b = 'updated' where a = r.a;
+    n := n + 1;
+  end loop;
+  return n;
+end;
+$$;
+
+create function parfor_trap() returns text language plpgsql as $$
+declare
+  r record;
+  caught int := 0;
+begin
+  for r in select a from parfor_src where a <= 20 loop
+    begin
+      insert into parfor_dst values (r.a);
+      if r.a % 5 = 0 then
+        raise exception 'boom %', r.a;
+      end if;
+    exception when others then
+      caught := caught + 1;
+    end;
+  end loop;
+  return caught || ' caught';
+end;
+$$;
+
+create function parfor_fail() returns void language plpgsql as $$
+declare
+  r record;
+begin
+  for r in select a from parfor_src where a <= 100 order by a loop
+    insert into parfor_dst values (r.a);
+    if r.a = 50 then
+      raise exception 'stopping at %', r.a;
+    end if;
+  end loop;
+end;
+$$;
+
+create function parfor_exit() returns int language plpgsql as $$
+declare
+  r record;
+  n int := 0;
+begin
+  for r in select a from parfor_src order by a loop
+    exit when r.a > 3;
+    n := n + 1;
+  end loop;
+  return n;
+end;
+$$;
+
+-- encourage parallel plans
+set parallel_setup_cost = 0;
+set parallel_tuple_cost = 0;
+set min_parallel_table_scan_size = 0;
+set max_parallel_workers_per_gather = 2;
+set plpgsql.parallel_for_loops = on;
+
+explain (costs off)
+select a from parfor_src where a % 10 = 0;
+
+-- loop bodies that modify data
+select parfor_copy();
+select count(*), sum(a) from parfor_dst;
+select parfor_update();
+select count(*) from parfor_src where b = 'updated';
+
+-- errors trapped in the loop body roll back only their own subtransaction
+truncate parfor_dst;
+select parfor_trap();
+select count(*), sum(a) from parfor_dst;
+
+-- an error escaping the loop body rolls back everything
+truncate parfor_dst;
+select parfor_fail();
+select count(*) from parfor_dst;
+
+select parfor_exit();
+
+-- non-atomic contexts still read the rows through a cursor
+do $$
+declare
+  r record;
+begin
+  for r in select a from parfor_src where a <= 3 order by a loop
+    insert into parfor_dst values (r.a);
+    commit;
+  end loop;
+end;
+$$;
+select count(*), sum(a) from parfor_dst;
+
+reset plpgsql.parallel_for_loops;
+reset max_parallel_workers_per_gather;
+reset min_parallel_table_scan_size;
+reset parallel_tuple_cost;
+reset parallel_setup_cost;
+
+drop function parfor_copy();
+drop function parfor_update();
+drop function parfor_trap();
+drop function parfor_fail();
+drop function parfor_exit();
+drop table parfor_src;
+drop table parfor_dst;
@@ -80,3 +80,22 @@ create or replace function simplesql() returns int language sql
 as $$select 2 + 2$$;
 
 select simplecaller();
+
+
+-- SELECT INTO of a simple expression bypasses SPI, but should still
+-- set FOUND and the row count, and report errors the same way
+
+create function simpleselectinto(a int) returns text language plpgsql
+as $$
+declare x int; n bigint;
+begin
+  select 0 into x where false;
+  get diagnostics n = row_count;
+  raise notice '% % %', x, found, n;
+  select 10 / a into x;
+  get diagnostics n = row_count;
+  return format('%s %s %s', x, found, n);
+end$$;
+
+select simpleselectinto(5);
+select simpleselectinto(0);
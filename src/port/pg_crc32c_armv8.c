@@ -1,7 +1,8 @@
 /*-------------------------------------------------------------------------
  *
  * pg_crc32c_armv8.c
- *	  Compute CRC-32C checksum using ARMv8 CRC Extension instructions
+ *	  Compute CRC-32C checksum using ARMv8 CRC Extension instructions, and
+ *	  the PMULL instruction for large inputs where available.
  *
  * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -16,8 +17,96 @@
 
 #include <arm_acle.h>
 
+/*
+ * If the compiler targets a CPU with the Cryptographic Extension, we also
+ * have the PMULL carry-less multiplication instruction, and can fold large
+ * inputs 64 bytes at a time instead of feeding them all through the crc32c
+ * instruction.  We don't try to detect it at runtime.
+ */
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+#define USE_PMULL_CRC32C_FOLDING
+#include <arm_neon.h>
+#endif
+
 #include "port/pg_crc32c.h"
 
+#ifdef USE_PMULL_CRC32C_FOLDING
+
+/*
+ * Multiply the low and the high 64-bit halves of a by those of k, carry-less,
+ * and return the sum (XOR) of both products.
+ */
+static inline uint64x2_t
+clmul_fold(uint64x2_t a, uint64x2_t k)
+{
+	poly64x2_t	pa = vreinterpretq_p64_u64(a);
+	poly64x2_t	pk = vreinterpretq_p64_u64(k);
+	poly128_t	lo = vmull_p64(vgetq_lane_p64(pa, 0), vgetq_lane_p64(pk, 0));
+	poly128_t	hi = vmull_high_p64(pa, pk);
+
+	return veorq_u64(vreinterpretq_u64_p128(lo), vreinterpretq_u64_p128(hi));
+}
+
+static inline uint64x2_t
+make_u64x2(uint64 lo, uint64 hi)
+{
+	return vcombine_u64(vcreate_u64(lo), vcreate_u64(hi));
+}
+
+/*
+ * Fold the input into four 128-bit accumulators, 64 bytes at a time, and
+ * return the CRC of everything consumed.  *pp is advanced past the consumed
+ * input, leaving less than 64 bytes.  The constants are x^n mod P
+ * (bit-reflected) for the folding distances involved, chosen so that the
+ * final 128 bits can be reduced with the crc32c instruction; see the
+ * VPCLMULQDQ implementation in pg_crc32c_sse42.c, which uses the same ones.
+ */
+static pg_crc32c
+pg_comp_crc32c_pmull(pg_crc32c crc, const unsigned char **pp,
+					 const unsigned char *pend)
+{
+	const unsigned char *p = *pp;
+	uint64x2_t	x0,
+				x1,
+				x2,
+				x3;
+	uint64x2_t	k;
+
+	Assert(pend - p >= 64);
+
+	x0 = vld1q_u64((const uint64_t *) p);
+	x1 = vld1q_u64((const uint64_t *) (p + 16));
+	x2 = vld1q_u64((const uint64_t *) (p + 32));
+	x3 = vld1q_u64((const uint64_t *) (p + 48));
+	x0 = veorq_u64(x0, make_u64x2(crc, 0));
+	p += 64;
+
+	k = make_u64x2(0x740eef02, 0x9e4addf8);
+	while (pend - p >= 64)
+	{
+		x0 = veorq_u64(clmul_fold(x0, k), vld1q_u64((const uint64_t *) p));
+		x1 = veorq_u64(clmul_fold(x1, k), vld1q_u64((const uint64_t *) (p + 16)));
+		x2 = veorq_u64(clmul_fold(x2, k), vld1q_u64((const uint64_t *) (p + 32)));
+		x3 = veorq_u64(clmul_fold(x3, k), vld1q_u64((const uint64_t *) (p + 48)));
+		p += 64;
+	}
+
+	/* Fold x0-x2 onto x3, 384, 256 and 128 bits away */
+	x0 = clmul_fold(x0, make_u64x2(0x1c291d04, 0xddc0152b));
+	x1 = clmul_fold(x1, make_u64x2(0x3da6d0cb, 0xba4fc28e));
+	x2 = clmul_fold(x2, make_u64x2(0xf20c0dfe, 0x493c7d27));
+	x0 = veorq_u64(veorq_u64(x0, x1), veorq_u64(x2, x3));
+
+	/* Reduce the remaining 128 bits to 32 */
+	crc = __crc32cd(0, vgetq_lane_u64(x0, 0));
+	crc = __crc32cd(crc, vgetq_lane_u64(x0, 1));
+
+	*pp = p;
+	return crc;
+}
+
+#endif							/* USE_PMULL_CRC32C_FOLDING */
+
 pg_crc32c
 pg_comp_crc32c_armv8(pg_crc32c crc, const void *data, size_t len)
 {
@@ -48,6 +137,11 @@ pg_comp_crc32c_armv8(pg_crc32c crc, const void *data, size_t len)
 		p += 4;
 	}
 
+#ifdef USE_PMULL_CRC32C_FOLDING
+	if (pend - p >= 64)
+		crc = pg_comp_crc32c_pmull(crc, &p, pend);
+#endif
+
 	/* Process eight bytes at a time, as far as we can. */
 	while (p + 8 <= pend)
 	{
@@ -5,8 +5,9 @@
  *
  * On first call, checks if the CPU we're running on supports Intel SSE
  * 4.2. If it does, use the special SSE instructions for CRC-32C
- * computation. Otherwise, fall back to the pure software implementation
- * (slicing-by-8).
+ * computation, and if it also supports AVX-512 with VPCLMULQDQ, the
+ * implementation that uses those for large inputs. Otherwise, fall back to
+ * the pure software implementation (slicing-by-8).
  *
  * Portions Copyright (c) 1996-2024, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -46,6 +47,49 @@ pg_crc32c_sse42_available(void)
 	return (exx[2] & (1 << 20)) != 0;	/* SSE 4.2 */
 }
 
+#ifdef USE_AVX512_CRC32C_WITH_RUNTIME_CHECK
+
+/*
+ * Does XGETBV say the ZMM registers are enabled?
+ *
+ * NB: Caller is responsible for verifying that CPUID reports OSXSAVE before
+ * calling this.  We use inline assembly rather than the _xgetbv() intrinsic,
+ * which would require compiling this file with -mxsave.
+ */
+static bool
+zmm_regs_available(void)
+{
+	uint32		eax;
+	uint32		edx;
+
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (eax & 0xe6) == 0xe6;
+}
+
+/*
+ * Does the CPU support the instructions used by pg_comp_crc32c_avx512(), and
+ * does the OS save the registers it uses?
+ */
+static bool
+pg_crc32c_avx512_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[2] & (1 << 27)) == 0)	/* OSXSAVE */
+		return false;
+
+	if (!zmm_regs_available())
+		return false;
+
+	__get_cpuid_count(7, 0, &exx[0], &exx[1], &exx[2], &exx[3]);
+	return (exx[1] & (1 << 16)) != 0 && /* AVX-512F */
+		(exx[1] & (1U << 31)) != 0 &&	/* AVX-512VL */
+		(exx[2] & (1 << 10)) != 0;	/* VPCLMULQDQ */
+}
+
+#endif							/* USE_AVX512_CRC32C_WITH_RUNTIME_CHECK */
+
 /*
  * This gets called on the first call. It replaces the function pointer
  * so that subsequent calls are routed directly to the chosen implementation.
@@ -54,7 +98,13 @@ static pg_crc32c
 pg_comp_crc32c_choose(pg_crc32c crc, const void *data, size_t len)
 {
 	if (pg_crc32c_sse42_available())
+	{
 		pg_comp_crc32c = pg_comp_crc32c_sse42;
+#ifdef USE_AVX512_CRC32C_WITH_RUNTIME_CHECK
+		if (pg_crc32c_avx512_available())
+			pg_comp_crc32c = pg_comp_crc32c_avx512;
+#endif
+	}
 	else
 		pg_comp_crc32c = pg_comp_crc32c_sb8;
 
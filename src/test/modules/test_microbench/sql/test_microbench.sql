@@ -0,0 +1,11 @@
+CREATE EXTENSION test_microbench;
+
+--
+-- The timings vary from run to run, so just check that all the benchmarks
+-- run, and yield plausible results.
+--
+SELECT name, ops, ns_per_op >= 0 AS timed FROM test_microbench();
+
+SELECT name, ops FROM test_microbench('radixtree', 2);
+
+SELECT * FROM test_microbench('nosuchbenchmark');
@@ -0,0 +1,12 @@
+/* src/test/modules/test_microbench/test_microbench--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_microbench" to load this file. \quit
+
+CREATE FUNCTION test_microbench(benchmark text DEFAULT NULL,
+                                scale int DEFAULT 1,
+                                OUT name text,
+                                OUT ops bigint,
+                                OUT ns_per_op float8)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME' LANGUAGE C;
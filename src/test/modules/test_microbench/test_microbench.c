@@ -0,0 +1,448 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_microbench.c
+ *		Micro-benchmarks of core data structures and executor hot paths.
+ *
+ * Each benchmark runs a fixed number of operations, derived from the scale
+ * argument, on pseudo-random but reproducible input, and reports the time
+ * taken per operation.  The regression test only checks that everything
+ * runs; to track performance, run the benchmarks at a larger scale on an
+ * otherwise idle machine and compare the timings between builds.
+ *
+ * Copyright (c) 2024, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_microbench/test_microbench.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/tupdesc.h"
+#include "catalog/pg_operator.h"
+#include "catalog/pg_type.h"
+#include "common/hashfn.h"
+#include "common/pg_prng.h"
+#include "executor/executor.h"
+#include "funcapi.h"
+#include "lib/dshash.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "portability/instr_time.h"
+#include "storage/lwlock.h"
+#include "utils/builtins.h"
+#include "utils/dsa.h"
+#include "utils/fmgroids.h"
+#include "utils/memutils.h"
+#include "utils/tuplesort.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_microbench);
+
+/* Number of operations per benchmark at scale 1 */
+#define MICROBENCH_OPS_PER_SCALE	100000
+
+/* Seed of the pseudo-random input, so that every run sees the same keys */
+#define MICROBENCH_SEED		0x5eed
+
+/* define the simplehash instance to measure */
+typedef struct mb_hash_entry
+{
+	uint64		key;
+	char		status;
+} mb_hash_entry;
+
+#define SH_PREFIX mbhash
+#define SH_ELEMENT_TYPE mb_hash_entry
+#define SH_KEY_TYPE uint64
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) murmurhash64(key)
+#define SH_EQUAL(tb, a, b) ((a) == (b))
+#define SH_SCOPE static inline
+#define SH_DECLARE
+#define SH_DEFINE
+#include "lib/simplehash.h"
+
+/* define the radix tree instance to measure */
+#define RT_PREFIX mbrt
+#define RT_SCOPE static inline
+#define RT_DECLARE
+#define RT_DEFINE
+#define RT_VALUE_TYPE uint64
+#include "lib/radixtree.h"
+
+/* entry of the dshash table to measure */
+typedef struct mb_dshash_entry
+{
+	uint64		key;
+	uint64		value;
+} mb_dshash_entry;
+
+typedef void (*microbench_function) (ReturnSetInfo *rsinfo, int64 nops);
+
+static void bench_simplehash(ReturnSetInfo *rsinfo, int64 nops);
+static void bench_dshash(ReturnSetInfo *rsinfo, int64 nops);
+static void bench_radixtree(ReturnSetInfo *rsinfo, int64 nops);
+static void bench_tuplesort(ReturnSetInfo *rsinfo, int64 nops);
+static void bench_expr(ReturnSetInfo *rsinfo, int64 nops);
+static void bench_deform(ReturnSetInfo *rsinfo, int64 nops);
+
+static const struct
+{
+	const char *name;
+	microbench_function function;
+}			microbenchmarks[] =
+{
+	{"simplehash", bench_simplehash},
+	{"dshash", bench_dshash},
+	{"radixtree", bench_radixtree},
+	{"tuplesort", bench_tuplesort},
+	{"expr", bench_expr},
+	{"deform", bench_deform},
+};
+
+/*
+ * Add one result row.
+ */
+static void
+report(ReturnSetInfo *rsinfo, const char *name, int64 nops,
+	   instr_time elapsed)
+{
+	Datum		values[3];
+	bool		nulls[3] = {0};
+
+	values[0] = CStringGetTextDatum(name);
+	values[1] = Int64GetDatum(nops);
+	values[2] = Float8GetDatum((double) INSTR_TIME_GET_NANOSEC(elapsed) / nops);
+
+	tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+}
+
+/*
+ * SQL-callable entry point: run one or all of the benchmarks.
+ */
+Datum
+test_microbench(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	char	   *name = PG_ARGISNULL(0) ? NULL : text_to_cstring(PG_GETARG_TEXT_PP(0));
+	int32		scale = PG_ARGISNULL(1) ? 1 : PG_GETARG_INT32(1);
+	bool		found = false;
+
+	if (scale < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("scale must be at least 1")));
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	for (int i = 0; i < lengthof(microbenchmarks); i++)
+	{
+		MemoryContext bench_cxt;
+		MemoryContext oldcxt;
+
+		if (name != NULL && strcmp(name, microbenchmarks[i].name) != 0)
+			continue;
+		found = true;
+
+		bench_cxt = AllocSetContextCreate(CurrentMemoryContext,
+										  "microbenchmark",
+										  ALLOCSET_DEFAULT_SIZES);
+		oldcxt = MemoryContextSwitchTo(bench_cxt);
+
+		microbenchmarks[i].function(rsinfo,
+									(int64) scale * MICROBENCH_OPS_PER_SCALE);
+
+		MemoryContextSwitchTo(oldcxt);
+		MemoryContextDelete(bench_cxt);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("unrecognized benchmark \"%s\"", name)));
+
+	return (Datum) 0;
+}
+
+/*
+ * Generate the keys used by the hash table and radix tree benchmarks.
+ */
+static uint64 *
+make_keys(int64 nops)
+{
+	uint64	   *keys = palloc(sizeof(uint64) * nops);
+	pg_prng_state state;
+
+	pg_prng_seed(&state, MICROBENCH_SEED);
+	for (int64 i = 0; i < nops; i++)
+		keys[i] = pg_prng_uint64(&state);
+
+	return keys;
+}
+
+static void
+bench_simplehash(ReturnSetInfo *rsinfo, int64 nops)
+{
+	uint64	   *keys = make_keys(nops);
+	mbhash_hash *hash;
+	instr_time	start;
+	instr_time	elapsed;
+	bool		found;
+
+	hash = mbhash_create(CurrentMemoryContext, 1024, NULL);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+		(void) mbhash_insert(hash, keys[i], &found);
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "simplehash insert", nops, elapsed);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+	{
+		if (mbhash_lookup(hash, keys[i]) == NULL)
+			elog(ERROR, "key " UINT64_FORMAT " not found", keys[i]);
+	}
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "simplehash lookup", nops, elapsed);
+
+	mbhash_destroy(hash);
+}
+
+static void
+bench_dshash(ReturnSetInfo *rsinfo, int64 nops)
+{
+	uint64	   *keys = make_keys(nops);
+	int			tranche_id = LWLockNewTrancheId();
+	dshash_parameters params;
+	dsa_area   *area;
+	dshash_table *hash;
+	instr_time	start;
+	instr_time	elapsed;
+
+	LWLockRegisterTranche(tranche_id, "test_microbench");
+	area = dsa_create(tranche_id);
+
+	params.key_size = sizeof(uint64);
+	params.entry_size = sizeof(mb_dshash_entry);
+	params.compare_function = dshash_memcmp;
+	params.hash_function = dshash_memhash;
+	params.copy_function = dshash_memcpy;
+	params.tranche_id = tranche_id;
+	hash = dshash_create(area, &params, NULL);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+	{
+		mb_dshash_entry *entry;
+		bool		found;
+
+		entry = dshash_find_or_insert(hash, &keys[i], &found);
+		entry->value = i;
+		dshash_release_lock(hash, entry);
+	}
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "dshash insert", nops, elapsed);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+	{
+		mb_dshash_entry *entry;
+
+		entry = dshash_find(hash, &keys[i], false);
+		if (entry == NULL)
+			elog(ERROR, "key " UINT64_FORMAT " not found", keys[i]);
+		dshash_release_lock(hash, entry);
+	}
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "dshash lookup", nops, elapsed);
+
+	dshash_destroy(hash);
+	dsa_detach(area);
+}
+
+static void
+bench_radixtree(ReturnSetInfo *rsinfo, int64 nops)
+{
+	uint64	   *keys = make_keys(nops);
+	mbrt_radix_tree *tree;
+	instr_time	start;
+	instr_time	elapsed;
+
+	tree = mbrt_create(CurrentMemoryContext);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+	{
+		uint64		value = i;
+
+		(void) mbrt_set(tree, keys[i], &value);
+	}
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "radixtree insert", nops, elapsed);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+	{
+		if (mbrt_find(tree, keys[i]) == NULL)
+			elog(ERROR, "key " UINT64_FORMAT " not found", keys[i]);
+	}
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "radixtree lookup", nops, elapsed);
+
+	mbrt_free(tree);
+}
+
+static void
+bench_tuplesort(ReturnSetInfo *rsinfo, int64 nops)
+{
+	Tuplesortstate *sortstate;
+	pg_prng_state state;
+	instr_time	start;
+	instr_time	elapsed;
+	Datum		val;
+	bool		isnull;
+
+	pg_prng_seed(&state, MICROBENCH_SEED);
+
+	INSTR_TIME_SET_CURRENT(start);
+	sortstate = tuplesort_begin_datum(INT8OID, Int8LessOperator, InvalidOid,
+									  false, work_mem, NULL, TUPLESORT_NONE);
+	for (int64 i = 0; i < nops; i++)
+		tuplesort_putdatum(sortstate,
+						   Int64GetDatum((int64) pg_prng_uint64(&state)),
+						   false);
+	tuplesort_performsort(sortstate);
+	while (tuplesort_getdatum(sortstate, true, false, &val, &isnull, NULL))
+		;
+	tuplesort_end(sortstate);
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "tuplesort int8", nops, elapsed);
+}
+
+/*
+ * Evaluate "(a + 1) * 2 > 100" on an int4 column, through ExecInterpExpr
+ * or JIT-compiled code, whichever ExecInitExpr() chooses.
+ */
+static void
+bench_expr(ReturnSetInfo *rsinfo, int64 nops)
+{
+	TupleDesc	tupdesc;
+	TupleTableSlot *slot;
+	ExprContext *econtext;
+	ExprState  *exprstate;
+	Expr	   *expr;
+	instr_time	start;
+	instr_time	elapsed;
+	int64		ntrue = 0;
+
+	tupdesc = CreateTemplateTupleDesc(1);
+	TupleDescInitEntry(tupdesc, 1, "a", INT4OID, -1, 0);
+	slot = MakeSingleTupleTableSlot(tupdesc, &TTSOpsVirtual);
+
+	expr = (Expr *) makeVar(1, 1, INT4OID, -1, InvalidOid, 0);
+	expr = (Expr *) makeFuncExpr(F_INT4PL, INT4OID,
+								 list_make2(expr,
+											makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+													  Int32GetDatum(1), false, true)),
+								 InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+	expr = (Expr *) makeFuncExpr(F_INT4MUL, INT4OID,
+								 list_make2(expr,
+											makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+													  Int32GetDatum(2), false, true)),
+								 InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+	expr = (Expr *) makeFuncExpr(F_INT4GT, BOOLOID,
+								 list_make2(expr,
+											makeConst(INT4OID, -1, InvalidOid, sizeof(int32),
+													  Int32GetDatum(100), false, true)),
+								 InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+
+	exprstate = ExecInitExpr(expr, NULL);
+	econtext = CreateStandaloneExprContext();
+	econtext->ecxt_scantuple = slot;
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+	{
+		bool		isnull;
+
+		ExecClearTuple(slot);
+		slot->tts_values[0] = Int32GetDatum((int32) (i % 1000));
+		slot->tts_isnull[0] = false;
+		ExecStoreVirtualTuple(slot);
+
+		if (DatumGetBool(ExecEvalExpr(exprstate, econtext, &isnull)))
+			ntrue++;
+	}
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+
+	/* (a + 1) * 2 > 100 holds for a >= 50 */
+	if (ntrue != nops - (nops / 1000) * 50 - Min(nops % 1000, 50))
+		elog(ERROR, "unexpected expression result");
+
+	report(rsinfo, "expr eval", nops, elapsed);
+
+	FreeExprContext(econtext, true);
+	ExecDropSingleTupleTableSlot(slot);
+}
+
+/*
+ * Deform a heap tuple with a mix of fixed-width and variable-width columns,
+ * as every scan of a heap page does for each tuple.
+ */
+static void
+bench_deform(ReturnSetInfo *rsinfo, int64 nops)
+{
+#define MICROBENCH_DEFORM_NATTS	16
+	TupleDesc	tupdesc;
+	HeapTuple	tuple;
+	Datum		values[MICROBENCH_DEFORM_NATTS];
+	bool		isnull[MICROBENCH_DEFORM_NATTS] = {0};
+	instr_time	start;
+	instr_time	elapsed;
+
+	tupdesc = CreateTemplateTupleDesc(MICROBENCH_DEFORM_NATTS);
+	for (int i = 0; i < MICROBENCH_DEFORM_NATTS; i++)
+	{
+		switch (i % 4)
+		{
+			case 0:
+				TupleDescInitEntry(tupdesc, i + 1, NULL, INT4OID, -1, 0);
+				values[i] = Int32GetDatum(i);
+				break;
+			case 1:
+				TupleDescInitEntry(tupdesc, i + 1, NULL, INT8OID, -1, 0);
+				values[i] = Int64GetDatum(i);
+				break;
+			case 2:
+				TupleDescInitEntry(tupdesc, i + 1, NULL, TEXTOID, -1, 0);
+				values[i] = CStringGetTextDatum("some text");
+				break;
+			case 3:
+				TupleDescInitEntry(tupdesc, i + 1, NULL, BOOLOID, -1, 0);
+				values[i] = BoolGetDatum(true);
+				break;
+		}
+	}
+	tuple = heap_form_tuple(tupdesc, values, isnull);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int64 i = 0; i < nops; i++)
+		heap_deform_tuple(tuple, tupdesc, values, isnull);
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	report(rsinfo, "heap deform", nops, elapsed);
+}
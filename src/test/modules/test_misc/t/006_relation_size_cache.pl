@@ -0,0 +1,94 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check that relation sizes stay correct when the shared relation size cache
+# is too small for all the relations in use, so that some sizes are cached
+# and others are looked up in the file system.
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf('postgresql.conf', 'relation_size_cache_entries = 16');
+$node->start;
+
+is($node->safe_psql('postgres', 'SHOW relation_size_cache_entries'),
+	'16', 'relation_size_cache_entries set');
+
+# Many more tables than the cache has entries for, plus a function that
+# scans them all
+$node->safe_psql(
+	'postgres', q{
+	CREATE FUNCTION make_tables(lo int, hi int) RETURNS void
+	LANGUAGE plpgsql AS $$
+	BEGIN
+		FOR i IN lo..hi LOOP
+			EXECUTE format('CREATE TABLE t%s AS SELECT g AS a FROM generate_series(1, 10) g', i);
+		END LOOP;
+	END $$;
+	CREATE FUNCTION total(lo int, hi int) RETURNS bigint
+	LANGUAGE plpgsql AS $$
+	DECLARE
+		n bigint := 0;
+		c bigint;
+	BEGIN
+		FOR i IN lo..hi LOOP
+			EXECUTE format('SELECT count(*) FROM t%s', i) INTO c;
+			n := n + c;
+		END LOOP;
+		RETURN n;
+	END $$;
+	SELECT make_tables(1, 40);
+});
+
+# Fill the cache from one session, extend all the tables from another
+is($node->safe_psql('postgres', 'SELECT total(1, 40)'),
+	'400', 'sizes of new tables');
+$node->safe_psql(
+	'postgres', q{
+	DO $$
+	BEGIN
+		FOR i IN 1..40 LOOP
+			EXECUTE format('INSERT INTO t%s SELECT g FROM generate_series(11, 10000) g', i);
+		END LOOP;
+	END $$;
+});
+is($node->safe_psql('postgres', 'SELECT total(1, 40)'),
+	'400000', 'sizes after extending cached and uncached tables');
+
+# Truncation by VACUUM, then extension again
+$node->safe_psql(
+	'postgres', q{
+	DELETE FROM t1 WHERE a > 10;
+	DELETE FROM t40 WHERE a > 10;
+	VACUUM t1, t40;
+});
+is($node->safe_psql('postgres', 'SELECT total(1, 40)'),
+	'380020', 'sizes after truncation');
+$node->safe_psql(
+	'postgres', q{
+	INSERT INTO t1 SELECT g FROM generate_series(11, 10000) g;
+	INSERT INTO t40 SELECT g FROM generate_series(11, 10000) g;
+});
+is($node->safe_psql('postgres', 'SELECT total(1, 40)'),
+	'400000', 'sizes after extending truncated tables');
+
+# Dropping tables frees entries for new ones
+$node->safe_psql(
+	'postgres', q{
+	DO $$
+	BEGIN
+		FOR i IN 1..20 LOOP
+			EXECUTE format('DROP TABLE t%s', i);
+		END LOOP;
+	END $$;
+	SELECT make_tables(1, 20);
+});
+is($node->safe_psql('postgres', 'SELECT total(1, 40)'),
+	'200200', 'sizes after dropping and recreating tables');
+
+$node->stop;
+
+done_testing();
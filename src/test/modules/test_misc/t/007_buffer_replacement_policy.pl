@@ -0,0 +1,67 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check the usage counts that buffer_replacement_policy gives to pages read
+# into shared buffers: zero for a first read under scan_resistant, two for a
+# page read back in soon after it was evicted, and one under clock_sweep.
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq{
+buffer_replacement_policy = scan_resistant
+autovacuum = off
+});
+$node->start;
+
+is($node->safe_psql('postgres', 'SHOW buffer_replacement_policy'),
+	'scan_resistant', 'buffer_replacement_policy set');
+
+$node->safe_psql(
+	'postgres', q{
+	CREATE EXTENSION pg_buffercache;
+	CREATE TABLE t (a int);
+	INSERT INTO t SELECT g FROM generate_series(1, 10) g;
+});
+
+my $buffer_query = q{
+	FROM pg_buffercache
+	WHERE relfilenode = pg_relation_filenode('t')
+	  AND reldatabase = (SELECT oid FROM pg_database
+						 WHERE datname = current_database())
+	  AND relforknumber = 0 AND relblocknumber = 0};
+
+# Read the table's only page after a restart, so that this is the first time
+# it is read into shared buffers
+$node->restart;
+is($node->safe_psql('postgres', 'SELECT count(*) FROM t'),
+	'10', 'table read after restart');
+is($node->safe_psql('postgres', "SELECT usagecount $buffer_query"),
+	'0', 'first read of a page starts with usage count zero');
+
+# Evict the page and read it back in; its ghost entry marks it as recently
+# evicted
+is( $node->safe_psql(
+		'postgres', "SELECT pg_buffercache_evict(bufferid) $buffer_query"),
+	't',
+	'page evicted');
+is($node->safe_psql('postgres', 'SELECT count(*) FROM t'),
+	'10', 'table read after eviction');
+is($node->safe_psql('postgres', "SELECT usagecount $buffer_query"),
+	'2', 'page read back in after eviction starts with usage count two');
+
+# The default policy gives every newly read page a usage count of one
+$node->append_conf('postgresql.conf', 'buffer_replacement_policy = clock_sweep');
+$node->restart;
+is($node->safe_psql('postgres', 'SELECT count(*) FROM t'),
+	'10', 'table read under clock_sweep');
+is($node->safe_psql('postgres', "SELECT usagecount $buffer_query"),
+	'1', 'first read of a page starts with usage count one under clock_sweep');
+
+$node->stop;
+
+done_testing();
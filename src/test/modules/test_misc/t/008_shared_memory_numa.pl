@@ -0,0 +1,53 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check that the server runs with shared_memory_numa = interleave where it is
+# supported, and refuses to start with it elsewhere.
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf('postgresql.conf', 'shared_memory_numa = interleave');
+
+if ($^O ne 'linux')
+{
+	is($node->start(fail_ok => 1), 0, 'server refuses to start');
+	like(
+		slurp_file($node->logfile),
+		qr/shared_memory_numa must be set to "off" on this platform/,
+		'shared_memory_numa = interleave rejected on this platform');
+	done_testing();
+	exit;
+}
+
+# Both ways of creating the main segment apply the policy
+foreach my $type ('mmap', 'sysv')
+{
+	$node->append_conf('postgresql.conf', "shared_memory_type = $type");
+	$node->start;
+
+	is($node->safe_psql('postgres', 'SHOW shared_memory_numa'),
+		'interleave', "shared_memory_numa set with $type");
+
+	# Zero on a single-node machine, otherwise the number of nodes the
+	# segment is spread across
+	my $nodes = $node->safe_psql('postgres', 'SHOW shared_memory_numa_nodes');
+	ok($nodes == 0 || $nodes >= 2,
+		"shared_memory_numa_nodes is $nodes with $type");
+
+	# Touch a good number of buffers
+	is( $node->safe_psql(
+			'postgres', q{
+		CREATE TABLE t AS SELECT g AS a FROM generate_series(1, 100000) g;
+		SELECT sum(a) FROM t;
+		DROP TABLE t;}),
+		'5000050000',
+		"queries work with $type");
+
+	$node->stop;
+}
+
+done_testing();
@@ -0,0 +1,45 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check that the server works with the largest allowed number of WAL
+# insertion locks.  Checkpoints and WAL switches take all of them at once,
+# which must not exceed the number of LWLocks a backend can hold.
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('primary');
+$node->init;
+$node->append_conf('postgresql.conf', 'wal_insert_locks = 128');
+$node->start;
+
+is($node->safe_psql('postgres', 'SHOW wal_insert_locks'),
+	'128', 'wal_insert_locks set to its maximum');
+
+$node->safe_psql(
+	'postgres', q{
+	CREATE TABLE t AS SELECT g AS a FROM generate_series(1, 1000) g;
+	CHECKPOINT;
+	SELECT pg_switch_wal();
+	INSERT INTO t SELECT g FROM generate_series(1, 1000) g;
+});
+
+# Crash recovery replays the WAL written with all the locks
+$node->stop('immediate');
+$node->start;
+
+is($node->safe_psql('postgres', 'SELECT count(*) FROM t'),
+	'2000', 'data intact after crash recovery');
+
+# Values above the maximum are rejected
+my ($ret, $stdout, $stderr) = $node->psql('postgres',
+	'ALTER SYSTEM SET wal_insert_locks = 129');
+like(
+	$stderr,
+	qr/129 is outside the valid range for parameter "wal_insert_locks" \(-1 \.\. 128\)/,
+	'wal_insert_locks above the maximum is rejected');
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,85 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Test compression of whole WAL records with wal_record_compression_threshold,
+# checking that compressed records are smaller and that both a streaming
+# standby and crash recovery replay them correctly.
+
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node_primary = PostgreSQL::Test::Cluster->new('primary');
+$node_primary->init(allows_streaming => 1);
+$node_primary->append_conf(
+	'postgresql.conf', qq[
+wal_compression = pglz
+full_page_writes = off
+autovacuum = off
+]);
+$node_primary->start;
+
+my $backup_name = 'my_backup';
+$node_primary->backup($backup_name);
+my $node_standby = PostgreSQL::Test::Cluster->new('standby');
+$node_standby->init_from_backup($node_primary, $backup_name,
+	has_streaming => 1);
+$node_standby->start;
+
+$node_primary->safe_psql('postgres', 'CREATE TABLE t (a int, b text)');
+
+# Return the amount of WAL generated by the given SQL
+sub wal_bytes
+{
+	my ($sql) = @_;
+
+	return $node_primary->safe_psql(
+		'postgres', qq[
+SELECT pg_current_wal_insert_lsn() AS start \\gset
+$sql;
+SELECT pg_current_wal_insert_lsn() - :'start';
+]);
+}
+
+# Heap insert records carrying lots of compressible tuple data
+my $insert_sql =
+  "INSERT INTO t SELECT g, repeat('x', 200) FROM generate_series(1, 2000) g";
+
+my $plain = wal_bytes("SET wal_record_compression_threshold = -1; $insert_sql");
+my $compressed =
+  wal_bytes("SET wal_record_compression_threshold = 128; $insert_sql");
+cmp_ok($compressed, '<', $plain,
+	'records above the threshold are written compressed');
+
+# Logical messages are compressed too
+$node_primary->safe_psql(
+	'postgres', qq[
+SET wal_record_compression_threshold = 128;
+SELECT pg_logical_emit_message(false, 'test', repeat('message', 1000));
+]);
+
+$node_primary->wait_for_replay_catchup($node_standby);
+is( $node_standby->safe_psql(
+		'postgres', "SELECT count(*), sum(length(b)) FROM t"),
+	'4000|800000',
+	'standby replayed compressed records');
+
+# Crash recovery must decompress the records too
+$node_primary->safe_psql(
+	'postgres', qq[
+CHECKPOINT;
+SET wal_record_compression_threshold = 128;
+$insert_sql;
+]);
+$node_primary->stop('immediate');
+$node_primary->start;
+is( $node_primary->safe_psql(
+		'postgres', "SELECT count(*), sum(length(b)) FROM t"),
+	'6000|1200000',
+	'crash recovery replayed compressed records');
+
+$node_standby->stop;
+$node_primary->stop;
+
+done_testing();
@@ -0,0 +1,78 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Test physical streaming replication with wal_receiver_compression, which
+# makes the walsender compress the WAL it sends.
+
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my @methods = (
+	{ name => 'lz4', enabled => check_pg_config("#define USE_LZ4 1") },
+	{ name => 'zstd', enabled => check_pg_config("#define USE_ZSTD 1") });
+
+if (!grep { $_->{enabled} } @methods)
+{
+	plan skip_all => 'neither lz4 nor zstd is supported by this build';
+}
+
+my $node_primary = PostgreSQL::Test::Cluster->new('primary');
+$node_primary->init(allows_streaming => 1);
+$node_primary->append_conf('postgresql.conf', 'log_replication_commands = on');
+$node_primary->start;
+$node_primary->backup('my_backup');
+
+$node_primary->safe_psql('postgres', 'CREATE TABLE t (a int, b text)');
+
+foreach my $method (@methods)
+{
+	my $name = $method->{name};
+
+	next unless $method->{enabled};
+
+	my $node_standby = PostgreSQL::Test::Cluster->new("standby_$name");
+	$node_standby->init_from_backup($node_primary, 'my_backup',
+		has_streaming => 1);
+	$node_standby->append_conf('postgresql.conf',
+		"wal_receiver_compression = $name");
+
+	my $log_offset = -s $node_primary->logfile;
+	$node_standby->start;
+
+	# Mix compressible tuple data with full-page images
+	$node_primary->safe_psql(
+		'postgres', qq[
+INSERT INTO t SELECT g, repeat('$name', 100) FROM generate_series(1, 5000) g;
+CHECKPOINT;
+UPDATE t SET a = a + 1;
+]);
+	$node_primary->wait_for_replay_catchup($node_standby);
+
+	ok( $node_primary->log_contains(
+			qr/START_REPLICATION .* \(compression '$name'\)/, $log_offset),
+		"standby requested $name compression");
+
+	is( $node_standby->safe_psql(
+			'postgres', 'SELECT count(*), sum(a), sum(length(b)) FROM t'),
+		$node_primary->safe_psql(
+			'postgres', 'SELECT count(*), sum(a), sum(length(b)) FROM t'),
+		"standby with $name compression is up to date");
+
+	$node_standby->stop;
+}
+
+# A walsender rejects algorithms it doesn't know
+my ($ret, $stdout, $stderr) = $node_primary->psql(
+	'postgres',
+	"START_REPLICATION 0/0 (COMPRESSION 'bogus')",
+	replication => 'true');
+like(
+	$stderr,
+	qr/unrecognized compression algorithm: "bogus"/,
+	'unknown compression algorithm is rejected');
+
+$node_primary->stop;
+
+done_testing();
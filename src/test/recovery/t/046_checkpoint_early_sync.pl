@@ -0,0 +1,74 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check that a checkpoint fsyncs each relation fork as soon as it has
+# written the fork's last dirty buffer, and that crash recovery starting
+# from such a checkpoint finds the data intact.
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('primary');
+$node->init;
+# The early syncs are skipped with fsync off, the default for tests
+$node->append_conf(
+	'postgresql.conf', q{
+fsync = on
+log_checkpoints = on
+log_min_messages = debug1
+});
+$node->start;
+
+# A table with an index and, after the vacuum, free space and visibility
+# map forks, so that the checkpoint has several forks to write
+$node->safe_psql(
+	'postgres', q{
+	CREATE TABLE t (a int PRIMARY KEY, b text);
+	INSERT INTO t SELECT g, repeat('x', 100) FROM generate_series(1, 10000) g;
+	DELETE FROM t WHERE a % 10 = 0;
+	VACUUM t;
+});
+my $path = $node->safe_psql('postgres', q{SELECT pg_relation_filepath('t')});
+
+my $log_offset = -s $node->logfile;
+$node->safe_psql('postgres', 'CHECKPOINT');
+ok( $node->log_contains(
+		qr/checkpoint early sync: file=\Q$path\E /, $log_offset),
+	'checkpoint synced the table before its end');
+ok($node->log_contains(qr/checkpoint complete: .*sync files=[1-9]/, $log_offset),
+	'early syncs are counted in the checkpoint statistics');
+
+# Changes after the checkpoint are only in the WAL
+$node->safe_psql(
+	'postgres', q{
+	UPDATE t SET b = 'y' WHERE a <= 1000;
+	INSERT INTO t SELECT g, 'z' FROM generate_series(10001, 11000) g;
+});
+
+$node->stop('immediate');
+$node->start;
+
+is( $node->safe_psql(
+		'postgres', q{
+	SELECT count(*), count(*) FILTER (WHERE b = 'y'),
+		count(*) FILTER (WHERE b = 'z') FROM t}),
+	'10000|900|1000',
+	'data intact after crash recovery');
+is( $node->safe_psql(
+		'postgres', q{
+	SET enable_seqscan = off;
+	SET enable_bitmapscan = off;
+	SELECT count(*) FROM t WHERE a BETWEEN 995 AND 1005}),
+	'10',
+	'index intact after crash recovery');
+
+# The recovered cluster checkpoints normally
+$log_offset = -s $node->logfile;
+$node->safe_psql('postgres', 'CHECKPOINT');
+ok($node->log_contains(qr/checkpoint complete: /, $log_offset),
+	'checkpoint after crash recovery');
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,50 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check that the walwriter keeps wal_preallocate_segments segments created
+# ahead of the current WAL insert position.
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('primary');
+$node->init;
+$node->append_conf('postgresql.conf', 'wal_preallocate_segments = 3');
+$node->start;
+
+is($node->safe_psql('postgres', 'SHOW wal_preallocate_segments'),
+	'3', 'wal_preallocate_segments set');
+
+# Wait until pg_wal holds at least the given number of segments past the one
+# being inserted into
+sub wait_for_segments_ahead
+{
+	my ($count) = @_;
+
+	return $node->poll_query_until(
+		'postgres', qq{
+		SELECT count(*) >= $count FROM pg_ls_waldir()
+		WHERE name ~ '^[0-9A-F]{24}\$'
+		  AND name > pg_walfile_name(pg_current_wal_insert_lsn())});
+}
+
+ok(wait_for_segments_ahead(3), 'segments preallocated after startup');
+
+# Move to a new segment; the walwriter then creates the ones after it
+$node->safe_psql(
+	'postgres', q{
+	CREATE TABLE t AS SELECT g AS a FROM generate_series(1, 1000) g;
+	SELECT pg_switch_wal();
+});
+ok(wait_for_segments_ahead(3),
+	'segments preallocated after a segment switch');
+
+# The setting can be raised with a reload
+$node->append_conf('postgresql.conf', 'wal_preallocate_segments = 5');
+$node->reload;
+ok(wait_for_segments_ahead(5), 'more segments preallocated after a reload');
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,59 @@
+--
+-- Catalog cache entry removal
+--
+
+-- Prune entries as soon as they are unused, and make sure that lookups keep
+-- working while the caches are being pruned.  Entries are aged by statement,
+-- so the work is spread over several statements.
+SET catalog_cache_prune_min_age = 0;
+
+DO $$
+BEGIN
+  FOR i IN 1..500 LOOP
+    EXECUTE format('CREATE FUNCTION catcache_f%s(int) RETURNS int '
+                   'LANGUAGE sql IMMUTABLE AS %L', i, 'SELECT $1 + ' || i);
+  END LOOP;
+END;
+$$;
+
+CREATE FUNCTION catcache_call(n int) RETURNS bigint LANGUAGE plpgsql AS $$
+DECLARE
+  s bigint := 0;
+  r int;
+BEGIN
+  FOR i IN 1..n LOOP
+    EXECUTE format('SELECT catcache_f%s(0)', i) INTO r;
+    s := s + r;
+  END LOOP;
+  RETURN s;
+END;
+$$;
+
+SELECT catcache_call(500);
+SELECT count(*) FROM pg_proc
+  WHERE proname LIKE 'catcache\_f%' AND oid::regprocedure::text = proname || '(integer)';
+SELECT catcache_call(500);
+SELECT count(*) FROM pg_proc
+  WHERE proname LIKE 'catcache\_f%' AND to_regprocedure(proname || '(int)') = oid;
+
+RESET catalog_cache_prune_min_age;
+
+-- Likewise with a memory limit small enough to force evictions from all
+-- caches.  Converting every type OID to text is sure to add new entries.
+SET catalog_cache_memory_limit = '64kB';
+SELECT catcache_call(500);
+SELECT count(*) FILTER (WHERE oid::regtype::text IS NULL) FROM pg_type;
+SELECT catcache_call(500);
+SELECT parent, used_bytes < 256 * 1024 AS bounded
+  FROM pg_backend_memory_contexts WHERE name = 'CatCacheMemoryContext';
+RESET catalog_cache_memory_limit;
+SELECT catcache_call(500);
+
+DO $$
+BEGIN
+  FOR i IN 1..500 LOOP
+    EXECUTE format('DROP FUNCTION catcache_f%s(int)', i);
+  END LOOP;
+END;
+$$;
+DROP FUNCTION catcache_call(int);
@@ -0,0 +1,41 @@
+/*
+ * This test is for TOAST compression with zstd.
+ */
+
+/* skip test if the server was built without zstd support */
+SELECT NOT ('zstd' = ANY (enumvals)) AS skip_test FROM pg_settings
+  WHERE name = 'default_toast_compression' \gset
+\if :skip_test
+\quit
+\endif
+
+\set HIDE_TOAST_COMPRESSION false
+
+-- an inline compressed value, and one stored externally
+CREATE TABLE cmdata_zstd(f1 text COMPRESSION zstd);
+INSERT INTO cmdata_zstd VALUES (repeat('1234567890', 1004));
+INSERT INTO cmdata_zstd
+  SELECT string_agg(md5(g::text), '' ORDER BY g) FROM generate_series(1, 2000) g;
+\d+ cmdata_zstd
+SELECT pg_column_compression(f1), length(f1) FROM cmdata_zstd;
+
+-- decompress data slices, and whole values
+SELECT substr(f1, 200, 5) FROM cmdata_zstd;
+SELECT substr(f1, 2000, 50) FROM cmdata_zstd;
+SELECT md5(f1) FROM cmdata_zstd;
+
+-- changing the compression method affects only new values
+CREATE TABLE cmdata_zstd2(f1 text COMPRESSION pglz);
+INSERT INTO cmdata_zstd2 VALUES (repeat('1234567890', 1000));
+ALTER TABLE cmdata_zstd2 ALTER COLUMN f1 SET COMPRESSION zstd;
+INSERT INTO cmdata_zstd2 VALUES (repeat('1234567890', 1004));
+SELECT pg_column_compression(f1), length(f1) FROM cmdata_zstd2;
+
+-- default_toast_compression
+SET default_toast_compression = 'zstd';
+CREATE TABLE cmdata_zstd3(f1 text);
+INSERT INTO cmdata_zstd3 VALUES (repeat('1234567890', 1004));
+SELECT pg_column_compression(f1) FROM cmdata_zstd3;
+RESET default_toast_compression;
+
+DROP TABLE cmdata_zstd, cmdata_zstd2, cmdata_zstd3;
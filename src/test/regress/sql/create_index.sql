@@ -738,6 +738,80 @@ SELECT count(*) FROM tenk1
 SELECT count(*) FROM tenk1
   WHERE hundred = 42 AND (thousand = 42 OR thousand = 99);
 
+--
+-- Check merging of OR'ed constant comparisons into = ANY
+--
+
+CREATE TEMP TABLE or_any_tbl (a int, b text);
+INSERT INTO or_any_tbl SELECT i, i::text FROM generate_series(1, 1000) i;
+ANALYZE or_any_tbl;
+
+EXPLAIN (COSTS OFF)
+SELECT * FROM or_any_tbl WHERE a = 1 OR a = 2 OR a = 3 OR a = 4 OR a = 5;
+EXPLAIN (COSTS OFF)
+SELECT * FROM or_any_tbl WHERE a = 1 OR a = 2 OR a = 3 OR a = 4;
+EXPLAIN (COSTS OFF)
+SELECT * FROM or_any_tbl
+  WHERE a = 1 OR b = 'x' OR a = 2 OR a = 3 OR a < 0 OR a = 4 OR a = 5;
+SELECT count(*) FROM or_any_tbl
+  WHERE a = 1 OR b = 'x' OR a = 2 OR a = 3 OR a < 0 OR a = 4 OR a = 5;
+EXPLAIN (COSTS OFF)
+SELECT * FROM or_any_tbl t1 JOIN or_any_tbl t2
+  ON t1.a = t2.a AND
+     (t2.b = '1' OR t2.b = '2' OR t2.b = '3' OR t2.b = '4' OR t2.b = '5');
+SET or_to_any_threshold = 0;
+EXPLAIN (COSTS OFF)
+SELECT * FROM or_any_tbl WHERE a = 1 OR a = 2 OR a = 3 OR a = 4 OR a = 5;
+RESET or_to_any_threshold;
+
+-- Long lists are split so that predtest.c can still use them
+CREATE FUNCTION or_any_plan(cond text) RETURNS SETOF text
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+BEGIN
+    FOR ln IN
+        EXECUTE 'EXPLAIN (COSTS OFF) SELECT * FROM or_any_tbl WHERE ' || cond
+    LOOP
+        ln := regexp_replace(ln, '''\{[^}]*\}''', '''{...}''', 'g');
+        RETURN NEXT ln;
+    END LOOP;
+END;
+$$;
+CREATE INDEX or_any_tbl_part_idx ON or_any_tbl (a) WHERE a < 500;
+SET enable_seqscan = off;
+SELECT or_any_plan(string_agg('a = ' || i, ' OR '))
+  FROM generate_series(1, 150) i;
+RESET enable_seqscan;
+DROP INDEX or_any_tbl_part_idx;
+
+-- CHECK constraints and partial index predicates are left alone
+DO $$
+DECLARE
+    cond text;
+BEGIN
+    SELECT string_agg('a = ' || i, ' OR ') INTO cond
+      FROM generate_series(1, 120) i;
+    EXECUTE 'ALTER TABLE or_any_tbl ADD CONSTRAINT or_any_tbl_chk CHECK (' ||
+        cond || ' OR a > 120)';
+    EXECUTE 'CREATE INDEX or_any_tbl_part_idx ON or_any_tbl (a) WHERE ' ||
+        cond;
+END;
+$$;
+SET constraint_exclusion = on;
+EXPLAIN (COSTS OFF)
+SELECT * FROM or_any_tbl WHERE a = -1;
+RESET constraint_exclusion;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+EXPLAIN (COSTS OFF)
+SELECT * FROM or_any_tbl WHERE a = 7;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP FUNCTION or_any_plan(text);
+DROP TABLE or_any_tbl;
+
 --
 -- Check behavior with duplicate index column contents
 --
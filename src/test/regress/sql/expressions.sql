@@ -134,6 +134,54 @@ select return_text_input('a') not in ('a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i
 
 rollback;
 
+-- Arrays that are not Consts but can't change during execution are hashed
+-- too: Params in a generic plan, and ARRAY[] or IN lists containing them
+begin;
+create table saop_tbl (a int);
+insert into saop_tbl select g from generate_series(1, 20) g;
+insert into saop_tbl values (null);
+set local plan_cache_mode = force_generic_plan;
+
+prepare saop_param(int[]) as
+  select count(*) from saop_tbl where a = any($1);
+execute saop_param('{1,2,3,4,5,6,7,8,9,10}');
+execute saop_param('{1,2,3,4,5,6,7,8,9,null}');
+execute saop_param('{15,16,17,18,19,20,21,22,23,24}');
+execute saop_param(null);
+prepare saop_param_not(int[]) as
+  select count(*) from saop_tbl where a <> all($1);
+execute saop_param_not('{1,2,3,4,5,6,7,8,9,10}');
+execute saop_param_not('{1,2,3,4,5,6,7,8,9,null}');
+
+prepare saop_list(int, int) as
+  select count(*) from saop_tbl where a in ($1, $2, 3, 4, 5, 6, 7, 8, 9, 10);
+execute saop_list(1, 2);
+execute saop_list(null, 20);
+prepare saop_list_not(int, int) as
+  select count(*) from saop_tbl where a not in ($1, $2, 3, 4, 5, 6, 7, 8, 9, 10);
+execute saop_list_not(1, 2);
+execute saop_list_not(null, 2);
+
+-- the array is evaluated once per execution, and kept across rescans
+prepare saop_rescan(int, int) as
+  select x, (select count(*) from saop_tbl
+            where a in ($1, $2, 3, 4, 5, 6, 7, 8, 9, 10) and a >= x)
+  from (values (1), (5), (30)) v(x);
+execute saop_rescan(1, 2);
+execute saop_rescan(11, 12);
+
+-- but an array that depends on the outer query changes on rescan
+select x, (select count(*) from saop_tbl
+          where a in (x, x + 1, 3, 4, 5, 6, 7, 8, 9, 10))
+  from (values (1), (3), (30), (null)) v(x);
+
+deallocate saop_param;
+deallocate saop_param_not;
+deallocate saop_list;
+deallocate saop_list_not;
+deallocate saop_rescan;
+rollback;
+
 -- Test with non-strict equality function.
 -- We need to create our own type for this.
 
@@ -180,6 +180,62 @@ reset enable_indexonlyscan;
 
 drop table gist_tbl;
 
+-- Test sorted builds, which the box, polygon and circle opclasses use by
+-- default, against builds with buffering
+create table gist_sorted_tbl (id int4, b box, pg polygon, c circle);
+insert into gist_sorted_tbl
+select i, box(point(i % 100, i / 100), point(i % 100 + 0.5, i / 100 + 0.5)),
+       polygon(box(point(i % 100, i / 100), point(i % 100 + 0.5, i / 100 + 0.5))),
+       circle(point(i % 100, i / 100), 0.25)
+from generate_series(0, 9999) as i;
+vacuum analyze gist_sorted_tbl;
+
+set enable_seqscan=off;
+set enable_bitmapscan=off;
+
+create index gist_sorted_tbl_b_index on gist_sorted_tbl using gist (b);
+create index gist_sorted_tbl_pg_index on gist_sorted_tbl using gist (pg);
+create index gist_sorted_tbl_c_index on gist_sorted_tbl using gist (c);
+
+select count(*) from gist_sorted_tbl
+  where b && box(point(10.2, 20.2), point(15.2, 25.2));
+select count(*) from gist_sorted_tbl
+  where b <@ box(point(0, 0), point(2.5, 99.5));
+select id from gist_sorted_tbl order by b <-> point(50.7, 50.6) limit 3;
+select count(*) from gist_sorted_tbl
+  where pg && polygon(box(point(10.2, 20.2), point(15.2, 25.2)));
+select count(*) from gist_sorted_tbl
+  where c && circle(point(50, 50), 1.2);
+select count(*) from gist_sorted_tbl
+  where c <@ circle(point(50, 50), 1.3);
+
+drop index gist_sorted_tbl_b_index, gist_sorted_tbl_pg_index,
+  gist_sorted_tbl_c_index;
+
+create index gist_sorted_tbl_b_index on gist_sorted_tbl using gist (b)
+  with (buffering = on);
+create index gist_sorted_tbl_pg_index on gist_sorted_tbl using gist (pg)
+  with (buffering = on);
+create index gist_sorted_tbl_c_index on gist_sorted_tbl using gist (c)
+  with (buffering = on);
+
+select count(*) from gist_sorted_tbl
+  where b && box(point(10.2, 20.2), point(15.2, 25.2));
+select count(*) from gist_sorted_tbl
+  where b <@ box(point(0, 0), point(2.5, 99.5));
+select id from gist_sorted_tbl order by b <-> point(50.7, 50.6) limit 3;
+select count(*) from gist_sorted_tbl
+  where pg && polygon(box(point(10.2, 20.2), point(15.2, 25.2)));
+select count(*) from gist_sorted_tbl
+  where c && circle(point(50, 50), 1.2);
+select count(*) from gist_sorted_tbl
+  where c <@ circle(point(50, 50), 1.3);
+
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+drop table gist_sorted_tbl;
+
 -- test an unlogged table, mostly to get coverage of gistbuildempty
 create unlogged table gist_tbl (b box);
 create index gist_tbl_box_index on gist_tbl using gist (b);
@@ -674,3 +674,43 @@ alter table returningwrtest2 drop c;
 alter table returningwrtest attach partition returningwrtest2 for values in (2);
 insert into returningwrtest values (2, 'foo') returning returningwrtest;
 drop table returningwrtest;
+
+--
+-- Batched insertion of multiple rows into a plain table
+--
+create table batchins (a int primary key, b text);
+create table batchins_log (seq serial, a int, nrows bigint);
+create function batchins_log_row() returns trigger language plpgsql as
+$$ begin
+  insert into batchins_log (a, nrows) values (new.a, (select count(*) from batchins));
+  return null;
+end $$;
+create trigger batchins_after after insert on batchins
+  for each row execute function batchins_log_row();
+-- AFTER ROW triggers fire once per row, in order, across several batches
+insert into batchins select g, 'x' from generate_series(1, 2500) g;
+select count(*), min(a), max(a), min(nrows), max(nrows),
+       bool_and(a = seq) as in_order
+  from batchins_log;
+-- wide rows, so that batches are flushed by size rather than tuple count
+insert into batchins
+  select g, (select string_agg(md5(g::text || i::text), '')
+             from generate_series(1, 30) i)
+  from generate_series(2501, 2600) g;
+select count(*), sum(length(b)) from batchins where a > 2500;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select count(*) from batchins where a between 990 and 1010;
+reset enable_seqscan;
+reset enable_bitmapscan;
+-- unique violations in the middle of a batch report the offending key,
+-- whether it duplicates an existing row or one from the same batch
+insert into batchins values (3001, 'a'), (3002, 'b'), (5, 'c'), (3003, 'd');
+insert into batchins values (3001, 'a'), (3002, 'b'), (3001, 'c');
+-- other constraints are still checked row by row
+insert into batchins values (3001, 'a'), (null, 'b'), (3002, 'c');
+select count(*) from batchins where a > 3000;
+-- RETURNING returns the rows in insertion order
+insert into batchins values (3003, 'c'), (3001, 'a'), (3002, 'b') returning a, b;
+drop table batchins, batchins_log;
+drop function batchins_log_row();
@@ -386,6 +386,33 @@ select count(*) from tenk1 x where
   x.unique1 in (select aa.f1 from int4_tbl aa,float8_tbl bb where aa.f1=bb.f1);
 rollback;
 
+-- and with the greedy join search in place of GEQO, including a join large
+-- enough to have join order restrictions and several clauseless choices
+begin;
+set geqo = on;
+set geqo_threshold = 2;
+set geqo_greedy = on;
+select count(*) from tenk1 x where
+  x.unique1 in (select a.f1 from int4_tbl a,float8_tbl b where a.f1=b.f1) and
+  x.unique1 = 0 and
+  x.unique1 in (select aa.f1 from int4_tbl aa,float8_tbl bb where aa.f1=bb.f1);
+select count(*), count(i.f1), count(f.f1)
+from onek t1
+  join onek t2 on t2.unique1 = t1.unique2
+  join onek t3 on t3.unique2 = t2.unique1
+  join onek t4 on t4.unique1 = t3.unique2
+  join onek t5 on t5.unique2 = t4.unique1
+  join onek t6 on t6.unique1 = t5.unique2
+  join onek t7 on t7.unique2 = t6.unique1
+  join onek t8 on t8.unique1 = t7.unique2
+  left join int4_tbl i on i.f1 = t1.unique1
+  left join float8_tbl f on f.f1 = t8.unique1 + 1000000
+  cross join (select 1 from int8_tbl limit 1) ss
+where t1.unique1 < 10 and
+  exists (select 1 from onek s where s.unique1 = t5.unique1) and
+  not exists (select 1 from onek s where s.unique1 = t6.unique1 + 1000);
+rollback;
+
 --
 -- regression test: be sure we cope with proven-dummy append rels
 --
@@ -157,6 +157,72 @@ $$
 $$);
 rollback to settings;
 
+-- non-parallel, with most outer tuples having no inner match: the batches
+-- are planned up front, so outer tuples are checked against a Bloom filter
+-- of the inner hash values, but only if unmatched ones needn't be emitted
+savepoint settings;
+set local max_parallel_workers_per_gather = 0;
+set local work_mem = '128kB';
+set local hash_mem_multiplier = 1.0;
+create table sparse as
+  select generate_series(1, 60000, 3) as id;
+analyze sparse;
+select original > 1 as initially_multibatch
+  from hash_join_batches(
+$$
+  select count(*) from sparse o join simple s using (id);
+$$);
+select count(*) from sparse o join simple s using (id);
+select count(*) from sparse o where exists
+  (select from simple s where s.id = o.id);
+select count(*), count(o.id) from sparse o right join simple s using (id);
+select count(*), count(s.id) from sparse o left join simple s using (id);
+select count(*) from sparse o where not exists
+  (select from simple s where s.id = o.id);
+rollback to settings;
+
+-- batch files compressed with temp_file_compression, including the
+-- under-estimated case, where batches are split while they are read back
+savepoint settings;
+set local max_parallel_workers_per_gather = 0;
+set local work_mem = '128kB';
+set local hash_mem_multiplier = 1.0;
+create table compressible as
+  select g as id, repeat(md5(g::text), 4) as t
+  from generate_series(1, 20000) g;
+analyze compressible;
+set local temp_file_compression = none;
+select original > 1 as initially_multibatch
+  from hash_join_batches(
+$$
+  select count(*) from compressible r join compressible s using (id);
+$$);
+select count(*), sum(length(r.t)), count(*) filter (where r.t = s.t)
+  from compressible r join compressible s using (id);
+set local temp_file_compression = pglz;
+select original > 1 as initially_multibatch
+  from hash_join_batches(
+$$
+  select count(*) from compressible r join compressible s using (id);
+$$);
+select count(*), sum(length(r.t)), count(*) filter (where r.t = s.t)
+  from compressible r join compressible s using (id);
+select final > original as increased_batches
+  from hash_join_batches(
+$$
+  select count(*) from compressible r join bigger_than_it_looks s using (id);
+$$);
+select count(*) from compressible r join bigger_than_it_looks s using (id);
+-- lz4 if the server was built with it, pglz again otherwise
+select set_config('temp_file_compression',
+                  case when 'lz4' = any(enumvals) then 'lz4' else 'pglz' end,
+                  true) <> 'none' as compressed
+  from pg_settings where name = 'temp_file_compression';
+select count(*), sum(length(r.t)), count(*) filter (where r.t = s.t)
+  from compressible r join compressible s using (id);
+select count(*) from compressible r join bigger_than_it_looks s using (id);
+rollback to settings;
+
 -- parallel with parallel-oblivious hash join
 savepoint settings;
 set local max_parallel_workers_per_gather = 2;
@@ -507,6 +573,46 @@ $$);
 rollback to settings;
 
 
+-- Outer tuples are normally read ahead to prefetch their hash buckets only
+-- for much bigger hash tables; force that for the same queries as above
+savepoint settings;
+set local debug_hash_join_prefetch_min_buckets = 0;
+set local max_parallel_workers_per_gather = 0;
+set local enable_mergejoin = off;
+set local enable_nestloop = off;
+-- single-batch, including outer tuples rejected for NULL keys and ones
+-- that must be null-filled
+select count(*) from simple r join simple s using (id);
+select count(*) from (select nullif(id % 3, 0) * 0 + id as id from simple) r
+  join simple s using (id);
+select count(*), count(s.id) from
+  (select nullif(id % 3, 0) * 0 + id as id from simple) r
+  left join simple s using (id);
+select count(*) from simple r full outer join simple s on (r.id = 0 - s.id);
+-- rescans of the join in a correlated subquery
+select x, (select count(*) from simple r join simple s using (id)
+           where r.id <= x)
+  from (values (10), (0), (20000), (5)) v(x);
+-- multi-batch, also with the number of batches increased during the join
+set local work_mem = '128kB';
+set local hash_mem_multiplier = 1.0;
+select count(*) from simple r join simple s using (id);
+select final > 1 as multibatch
+  from hash_join_batches(
+$$
+  select count(*) from simple r join simple s using (id);
+$$);
+select count(*) FROM simple r JOIN bigger_than_it_looks s USING (id);
+select x, (select count(*) from simple r join simple s using (id)
+           where r.id <= x)
+  from (values (10), (0), (20000), (5)) v(x);
+-- parallel-aware, single-batch
+set local max_parallel_workers_per_gather = 2;
+set local enable_parallel_hash = on;
+set local work_mem = '4MB';
+select count(*) from simple r join simple s using (id);
+rollback to settings;
+
 -- Hash join reuses the HOT status bit to indicate match status. This can only
 -- be guaranteed to produce correct results if all the hash join tuple match
 -- bits are reset before reuse. This is done upon loading them into the
@@ -102,6 +102,18 @@ REVOKE EXECUTE ON FUNCTION pg_log_backend_memory_contexts(integer)
 
 DROP ROLE regress_log_memory;
 
+--
+-- pg_log_query_plan()
+--
+-- As above, the plan goes to the log, so just check that the function works
+-- and that it is not available to everyone.
+--
+
+SELECT pg_log_query_plan(pg_backend_pid());
+
+SELECT has_function_privilege('public',
+  'pg_log_query_plan(integer)', 'EXECUTE'); -- no
+
 --
 -- Test some built-in SRFs
 --
@@ -223,3 +223,54 @@ select name, generic_plans, custom_plans from pg_prepared_statements
   where  name = 'test_mode_pp';
 
 drop table test_mode;
+
+-- If the custom plans' costs differ by orders of magnitude, as with skewed
+-- data, custom plans keep being made after the first five
+create table test_spread (a int);
+alter table test_spread set (parallel_workers = 0);
+insert into test_spread select 1 from generate_series(1,200000) union all select 2;
+create index on test_spread (a);
+vacuum analyze test_spread;
+set plan_cache_mode to auto;
+
+prepare test_spread_pp (int) as select count(*) from test_spread where a = $1;
+execute test_spread_pp(1); -- 1x
+execute test_spread_pp(2); -- 2x
+execute test_spread_pp(1); -- 3x
+execute test_spread_pp(2); -- 4x
+execute test_spread_pp(1); -- 5x
+execute test_spread_pp(2); -- 6x, still custom
+select name, generic_plans, custom_plans from pg_prepared_statements
+  where  name = 'test_spread_pp';
+
+-- but with similar costs a generic plan is chosen as usual
+prepare test_spread_pp2 (int) as select count(*) from test_spread where a = $1;
+execute test_spread_pp2(1); -- 1x
+execute test_spread_pp2(1); -- 2x
+execute test_spread_pp2(1); -- 3x
+execute test_spread_pp2(1); -- 4x
+execute test_spread_pp2(1); -- 5x
+execute test_spread_pp2(1); -- 6x, generic
+select name, generic_plans, custom_plans from pg_prepared_statements
+  where  name = 'test_spread_pp2';
+
+deallocate test_spread_pp;
+deallocate test_spread_pp2;
+drop table test_spread;
+reset plan_cache_mode;
+
+-- A repeated unnamed statement is reused only in the environment it was
+-- analyzed in; here the query itself switches search_path, so the second
+-- execution must see the other schema's table
+create schema plancache_s1;
+create schema plancache_s2;
+create table plancache_s1.pc_t (a int);
+create table plancache_s2.pc_t (a text, b text);
+insert into plancache_s1.pc_t values (1);
+insert into plancache_s2.pc_t values ('x', 'y');
+set search_path = plancache_s1;
+select *, set_config('search_path', 'plancache_s2', false) from pc_t \bind \g
+select *, set_config('search_path', 'plancache_s2', false) from pc_t \bind \g
+select *, set_config('search_path', 'plancache_s2', false) from pc_t \bind \g
+reset search_path;
+drop schema plancache_s1, plancache_s2 cascade;
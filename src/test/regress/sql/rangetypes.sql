@@ -285,7 +285,8 @@ select count(*) from test_range_gist where ir &< int4multirange(int4range(100,20
 select count(*) from test_range_gist where ir &> int4multirange(int4range(100,200), int4range(400,500));
 select count(*) from test_range_gist where ir -|- int4multirange(int4range(100,200), int4range(400,500));
 
--- now check same queries using a bulk-loaded index
+-- now check same queries using a bulk-loaded index, which is built by
+-- sorting the ranges
 drop index test_range_gist_idx;
 create index test_range_gist_idx on test_range_gist using gist (ir);
 
@@ -310,6 +311,32 @@ select count(*) from test_range_gist where ir &< int4multirange(int4range(100,20
 select count(*) from test_range_gist where ir &> int4multirange(int4range(100,200), int4range(400,500));
 select count(*) from test_range_gist where ir -|- int4multirange(int4range(100,200), int4range(400,500));
 
+-- and using one built with buffering instead
+drop index test_range_gist_idx;
+create index test_range_gist_idx on test_range_gist using gist (ir)
+  with (buffering = on);
+
+select count(*) from test_range_gist where ir @> 'empty'::int4range;
+select count(*) from test_range_gist where ir = int4range(10,20);
+select count(*) from test_range_gist where ir @> 10;
+select count(*) from test_range_gist where ir @> int4range(10,20);
+select count(*) from test_range_gist where ir && int4range(10,20);
+select count(*) from test_range_gist where ir <@ int4range(10,50);
+select count(*) from test_range_gist where ir << int4range(100,500);
+select count(*) from test_range_gist where ir >> int4range(100,500);
+select count(*) from test_range_gist where ir &< int4range(100,500);
+select count(*) from test_range_gist where ir &> int4range(100,500);
+select count(*) from test_range_gist where ir -|- int4range(100,500);
+select count(*) from test_range_gist where ir @> '{}'::int4multirange;
+select count(*) from test_range_gist where ir @> int4multirange(int4range(10,20), int4range(30,40));
+select count(*) from test_range_gist where ir && '{(10,20),(30,40),(50,60)}'::int4multirange;
+select count(*) from test_range_gist where ir <@ '{(10,30),(40,60),(70,90)}'::int4multirange;
+select count(*) from test_range_gist where ir << int4multirange(int4range(100,200), int4range(400,500));
+select count(*) from test_range_gist where ir >> int4multirange(int4range(100,200), int4range(400,500));
+select count(*) from test_range_gist where ir &< int4multirange(int4range(100,200), int4range(400,500));
+select count(*) from test_range_gist where ir &> int4multirange(int4range(100,200), int4range(400,500));
+select count(*) from test_range_gist where ir -|- int4multirange(int4range(100,200), int4range(400,500));
+
 -- test SP-GiST index that's been built incrementally
 create table test_range_spgist(ir int4range);
 create index test_range_spgist_idx on test_range_spgist using spgist (ir);
@@ -262,3 +262,36 @@ create table list_parted_tbl1 partition of list_parted_tbl
   for values in (1) partition by list(b);
 explain (costs off) select * from list_parted_tbl;
 drop table list_parted_tbl;
+
+--
+-- Simple quals pushed down to heap scan keys
+--
+create temp table scankey_tbl (a int, b int);
+insert into scankey_tbl select g, g % 10 from generate_series(1, 1000) g;
+explain (analyze, costs off, timing off, summary off)
+select * from scankey_tbl where b = 3 and a < 50;
+select * from scankey_tbl where b = 3 and a < 50;
+select * from scankey_tbl where 3 = b and 50 > a;
+
+-- Operators that might fail are not pushed down, since the keys would be
+-- tested on rows that the LIMIT never fetches
+create function scankey_check(int, int) returns bool
+  language plpgsql immutable strict as
+$$ begin
+  if $1 = 0 then raise exception 'scankey_check called on zero'; end if;
+  return $1 = $2;
+end $$;
+create operator === (function = scankey_check, leftarg = int, rightarg = int);
+create temp table scankey_lim (a int);
+insert into scankey_lim values (1), (0);
+select * from scankey_lim where a === 1 limit 1;
+drop operator === (int, int);
+drop function scankey_check(int, int);
+
+-- Operators on polymorphic types are not pushed down either
+create type scankey_enum as enum ('x', 'y', 'z');
+create temp table scankey_enum_tbl (e scankey_enum);
+insert into scankey_enum_tbl values ('z'), ('x'), ('y');
+select * from scankey_enum_tbl where e < 'z';
+drop table scankey_tbl, scankey_lim, scankey_enum_tbl;
+drop type scankey_enum;
@@ -1020,3 +1020,30 @@ WHERE a.thousand < 750;
 explain (costs off)
 SELECT * FROM tenk1 A LEFT JOIN tenk2 B
 ON B.hundred in (SELECT min(c.hundred) FROM tenk2 C WHERE c.odd = b.odd);
+
+--
+-- Memoized correlated subplans
+--
+create temp table memo_outer as select g % 4 as k from generate_series(1, 12) g;
+create temp table memo_inner as
+  select g as v, g % 4 as k from generate_series(1, 40) g;
+create temp sequence memo_seq;
+explain (analyze, costs off, timing off, summary off)
+select k, (select count(*) from memo_inner i where i.k = o.k) from memo_outer o;
+select k, (select count(*) from memo_inner i where i.k = o.k) from memo_outer o;
+-- parameters are compared by binary image, not equality
+select x, (select o.x::text) from (values (1.0), (1.00), (1.0)) o(x);
+-- subplans with volatile functions are not memoized
+select count(distinct n) from
+  (select (select nextval('memo_seq') from memo_inner i where i.k = o.k limit 1)
+   as n from memo_outer o) ss;
+-- nor are subplans that also depend on the parameters of an outer level
+select k, count(*), min(s), max(s)
+from (select o.k,
+             (select sum((select count(*) from memo_inner i
+                          where i.k = o.k and i.v > x.v))
+              from memo_inner x where x.v <= 2) as s
+      from memo_outer o) ss
+group by k order by k;
+drop table memo_outer, memo_inner;
+drop sequence memo_seq;
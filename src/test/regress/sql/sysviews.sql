@@ -32,6 +32,17 @@ select name, parent, total_bytes > 0, total_nblocks, free_bytes > 0, free_chunks
 from pg_backend_memory_contexts where name = 'Caller tuples';
 rollback;
 
+-- backend_memory_limit turns running out of memory into an ordinary error,
+-- after which the session carries on
+\set VERBOSITY terse
+set backend_memory_limit = '1MB';
+set backend_memory_limit = '16MB';
+select length(repeat('x', 32 * 1024 * 1024));
+select length(repeat('x', 1024 * 1024));
+reset backend_memory_limit;
+\set VERBOSITY default
+select length(repeat('x', 32 * 1024 * 1024));
+
 -- At introduction, pg_config had 23 entries; it may grow
 select count(*) > 20 as ok from pg_config;
 
@@ -305,3 +305,56 @@ EXPLAIN (COSTS OFF) :qry;
 :qry;
 
 COMMIT;
+
+----
+-- Check radix sort, used for large in-memory sorts whose leading key has a
+-- specialized comparator
+----
+
+CREATE TEMP TABLE radix_sort (id int, i4 int4, i8 int8, t text);
+INSERT INTO radix_sort
+  SELECT g,
+         CASE WHEN g % 100 <> 0 THEN g * 7919 % 10007 - 5000 END,
+         (g * 7919 % 10007)::int8 * 1000000007 - 5000000000,
+         md5(g::text)
+  FROM generate_series(1, 20000) g;
+
+-- Count adjacent values that are out of order in the output of a query
+-- returning one column, not relying on another sort to do so, and report
+-- how NULLs were placed.
+CREATE FUNCTION radix_sort_check(query text, descending bool DEFAULT false,
+                                 OUT n bigint, OUT misordered bigint,
+                                 OUT null_boundaries bigint,
+                                 OUT nulls_first bool)
+LANGUAGE plpgsql AS
+$$
+BEGIN
+  EXECUTE format('SELECT count(*),
+                         count(*) FILTER (WHERE prev %s cur),
+                         count(*) FILTER (WHERE rn > 1 AND
+                                          (prev IS NULL) <> (cur IS NULL)),
+                         bool_or(cur IS NULL) FILTER (WHERE rn = 1)
+                  FROM (SELECT cur, lag(cur) OVER () AS prev,
+                               row_number() OVER () AS rn
+                        FROM (%s) s(cur)) w',
+                 CASE WHEN descending THEN '<' ELSE '>' END, query)
+    INTO n, misordered, null_boundaries, nulls_first;
+END
+$$;
+
+BEGIN;
+SET LOCAL work_mem = '64MB';
+SELECT * FROM radix_sort_check('SELECT i4 FROM radix_sort ORDER BY i4');
+SELECT * FROM radix_sort_check('SELECT i4 FROM radix_sort ORDER BY i4 NULLS FIRST');
+SELECT * FROM radix_sort_check('SELECT i4 FROM radix_sort ORDER BY i4 DESC', true);
+SELECT * FROM radix_sort_check('SELECT i4 FROM radix_sort ORDER BY i4 DESC NULLS LAST', true);
+SELECT * FROM radix_sort_check('SELECT i8 FROM radix_sort ORDER BY i8');
+SELECT * FROM radix_sort_check('SELECT i8 FROM radix_sort ORDER BY i8 DESC', true);
+SELECT * FROM radix_sort_check('SELECT t COLLATE "C" FROM radix_sort ORDER BY 1');
+SELECT * FROM radix_sort_check('SELECT t COLLATE "C" FROM radix_sort ORDER BY 1 DESC', true);
+-- many ties on the leading key, broken by the second one
+SELECT * FROM radix_sort_check('SELECT (i4 % 10, id) FROM radix_sort ORDER BY i4 % 10, id');
+SELECT * FROM radix_sort_check('SELECT (i8 % 3, id) FROM radix_sort ORDER BY i8 % 3 DESC, id DESC', true);
+COMMIT;
+
+DROP FUNCTION radix_sort_check(text, bool);
@@ -1951,3 +1951,65 @@ $$ LANGUAGE SQL STABLE;
 
 EXPLAIN (costs off) SELECT * FROM pg_temp.f(2);
 SELECT * FROM pg_temp.f(2);
+
+--
+-- Aggregates with a moving frame head and no inverse transition function
+-- use segment trees if the trees for the partition fit in work_mem.  Check
+-- them, and the regular method used otherwise, against plain aggregation.
+--
+CREATE TEMP TABLE segtree_t AS
+  SELECT i, i / 10 AS v,
+         CASE WHEN i % 7 = 0 OR i BETWEEN 100 AND 120 THEN NULL
+              ELSE i * 37 % 101 END AS x
+  FROM generate_series(1, 5000) i;
+CREATE INDEX ON segtree_t (i);
+CREATE INDEX ON segtree_t (v);
+ANALYZE segtree_t;
+
+CREATE FUNCTION segtree_check(frame text, cond text,
+                              OUT nrows bigint, OUT mismatches bigint)
+LANGUAGE plpgsql AS
+$$
+BEGIN
+  EXECUTE format('SELECT count(*),
+                         count(*) FILTER (WHERE (s.mn, s.mx, s.bo) IS DISTINCT
+                                          FROM (r.mn, r.mx, r.bo))
+                  FROM (SELECT i, v, min(x) OVER w AS mn, max(x) OVER w AS mx,
+                               bit_or(x) OVER w AS bo
+                        FROM segtree_t WINDOW w AS (%s)) s,
+                       LATERAL (SELECT min(x) AS mn, max(x) AS mx,
+                                       bit_or(x) AS bo
+                                FROM segtree_t t WHERE %s) r',
+                 frame, cond)
+    INTO nrows, mismatches;
+END
+$$;
+
+SELECT * FROM segtree_check('ORDER BY i ROWS BETWEEN 3 PRECEDING AND 2 FOLLOWING',
+                            't.i BETWEEN s.i - 3 AND s.i + 2');
+SELECT * FROM segtree_check('ORDER BY i ROWS BETWEEN 5 FOLLOWING AND 9 FOLLOWING',
+                            't.i BETWEEN s.i + 5 AND s.i + 9');
+SELECT * FROM segtree_check('ORDER BY v RANGE BETWEEN 2 PRECEDING AND 1 FOLLOWING',
+                            't.v BETWEEN s.v - 2 AND s.v + 1');
+SELECT * FROM segtree_check('ORDER BY v GROUPS BETWEEN 1 PRECEDING AND CURRENT ROW',
+                            't.v BETWEEN s.v - 1 AND s.v');
+SELECT * FROM segtree_check('PARTITION BY i % 3 ORDER BY i
+                             ROWS BETWEEN 2 PRECEDING AND 2 FOLLOWING',
+                            't.i % 3 = s.i % 3 AND t.i BETWEEN s.i - 6 AND s.i + 6');
+-- EXCLUDE always uses the regular method
+SELECT * FROM segtree_check('ORDER BY i ROWS BETWEEN 3 PRECEDING AND 2 FOLLOWING
+                             EXCLUDE CURRENT ROW',
+                            't.i BETWEEN s.i - 3 AND s.i + 2 AND t.i <> s.i');
+SELECT * FROM segtree_check('ORDER BY v RANGE BETWEEN 1 PRECEDING AND 1 FOLLOWING
+                             EXCLUDE GROUP',
+                            't.v BETWEEN s.v - 1 AND s.v + 1 AND t.v <> s.v');
+-- so do partitions whose trees don't fit in work_mem
+SET work_mem = '64kB';
+SELECT * FROM segtree_check('ORDER BY i ROWS BETWEEN 3 PRECEDING AND 2 FOLLOWING',
+                            't.i BETWEEN s.i - 3 AND s.i + 2');
+SELECT * FROM segtree_check('ORDER BY v RANGE BETWEEN 2 PRECEDING AND 1 FOLLOWING',
+                            't.v BETWEEN s.v - 2 AND s.v + 1');
+RESET work_mem;
+
+DROP FUNCTION segtree_check(text, text);
+DROP TABLE segtree_t;
@@ -0,0 +1,135 @@
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Check that ssl_session_tickets lets clients resume TLS sessions.  libpq
+# doesn't keep sessions across connections, so this uses "openssl s_client",
+# which can save a session to a file and offer it again on a later
+# connection.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+use IPC::Run;
+use Time::HiRes qw(usleep);
+
+use FindBin;
+use lib $FindBin::RealBin;
+
+use SSL::Server;
+
+if ($ENV{with_ssl} ne 'openssl')
+{
+	plan skip_all => 'OpenSSL not supported by this build';
+}
+elsif (!$ENV{PG_TEST_EXTRA} || $ENV{PG_TEST_EXTRA} !~ /\bssl\b/)
+{
+	plan skip_all =>
+	  'Potentially unsafe test SSL not enabled in PG_TEST_EXTRA';
+}
+elsif (!$ENV{OPENSSL})
+{
+	plan skip_all => 'openssl command not available';
+}
+
+my $ssl_server = SSL::Server->new();
+
+# This is the hostname used to connect to the server.
+my $SERVERHOSTADDR = '127.0.0.1';
+# This is the pattern to use in pg_hba.conf to match incoming connections.
+my $SERVERHOSTCIDR = '127.0.0.1/32';
+
+#### Set up the server.
+
+note "setting up data directory";
+my $node = PostgreSQL::Test::Cluster->new('primary');
+$node->init;
+
+# PGHOST is enforced here to set up the node, subsequent connections
+# will use a dedicated connection string.
+$ENV{PGHOST} = $node->host;
+$ENV{PGPORT} = $node->port;
+$node->start;
+
+$ssl_server->configure_test_server_for_ssl($node, $SERVERHOSTADDR,
+	$SERVERHOSTCIDR, 'trust');
+$ssl_server->switch_server_cert($node, certfile => 'server-cn-only');
+
+my $connstr =
+  "sslkey=invalid sslcert=invalid sslrootcert=invalid sslcrl=invalid sslcrldir=invalid "
+  . "sslmode=require dbname=trustdb hostaddr=$SERVERHOSTADDR host=localhost user=ssltestuser";
+
+my $session_file = PostgreSQL::Test::Utils::tempdir() . '/session.pem';
+
+# Reload the configuration and wait until new connections see it.  The
+# postmaster rebuilds the SSL context before it starts any new backend.
+sub reload_and_wait
+{
+	my $load_time = $node->safe_psql('trustdb', 'SELECT pg_conf_load_time()',
+		connstr => $connstr);
+
+	$node->reload;
+
+	my $max_attempts = 10 * $PostgreSQL::Test::Utils::timeout_default;
+	foreach my $attempt (1 .. $max_attempts)
+	{
+		return
+		  if $node->safe_psql(
+			'trustdb',
+			"SELECT pg_conf_load_time() > '$load_time'",
+			connstr => $connstr) eq 't';
+		usleep(100_000);
+	}
+	die "timed out waiting for the configuration to be reloaded";
+}
+
+# Perform a TLS 1.2 handshake with the server and return the session status
+# reported by s_client, "New" or "Reused".  TLS 1.2 is used because the
+# ticket is then sent during the handshake, before s_client exits.
+sub handshake
+{
+	my ($sess_option) = @_;
+	my ($stdout, $stderr);
+
+	IPC::Run::run [
+		$ENV{OPENSSL}, 's_client',
+		'-connect', "$SERVERHOSTADDR:" . $node->port,
+		'-starttls', 'postgres',
+		'-tls1_2', $sess_option,
+		$session_file
+	  ],
+	  '<', \'',
+	  '>', \$stdout,
+	  '2>', \$stderr;
+
+	return $1 if $stdout =~ /^(New|Reused), /m;
+	return "failed: $stderr";
+}
+
+# Older versions of s_client don't know the PostgreSQL protocol
+if (handshake('-sess_out') =~ /^failed/)
+{
+	plan skip_all => 'openssl s_client does not support -starttls postgres';
+}
+
+# By default, the server issues no tickets and keeps no session cache
+is(handshake('-sess_out'), 'New', 'first handshake without tickets');
+is(handshake('-sess_in'), 'New', 'session not resumed without tickets');
+
+# With tickets enabled, a later connection resumes the session, even though
+# it is served by a different backend
+$node->append_conf('postgresql.conf', 'ssl_session_tickets = on');
+reload_and_wait();
+is( $node->safe_psql(
+		'trustdb', 'SHOW ssl_session_tickets', connstr => $connstr),
+	'on',
+	'ssl_session_tickets set');
+
+is(handshake('-sess_out'), 'New', 'first handshake with tickets');
+is(handshake('-sess_in'), 'Reused', 'session resumed with a ticket');
+
+# A reload generates new ticket keys, so outstanding tickets stop working
+reload_and_wait();
+is(handshake('-sess_in'), 'New', 'ticket not accepted after a reload');
+
+done_testing();
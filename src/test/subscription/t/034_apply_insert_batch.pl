@@ -0,0 +1,178 @@
+
+# Copyright (c) 2024, PostgreSQL Global Development Group
+
+# Tests for batching of consecutive INSERTs in the apply worker: AFTER ROW
+# triggers, interleaving with other changes, and errors detected while a
+# batch is applied, together with SKIP and retry after such errors.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $offset = 0;
+
+# Wait for the subscription to be disabled by an error, check what was
+# reported, and return the finish LSN of the failed transaction.
+sub wait_for_batch_error
+{
+	my ($node_subscriber, $key, $msg) = @_;
+
+	$node_subscriber->poll_query_until('postgres',
+		"SELECT subenabled = false FROM pg_subscription WHERE subname = 'sub'"
+	) or die "Timed out while waiting for subscriber to be disabled";
+
+	$offset = $node_subscriber->wait_for_log(
+		qr/ERROR: ( [A-Z0-9]+:)? duplicate key value violates unique constraint "tab_pkey"/,
+		$offset);
+
+	my $contents = slurp_file($node_subscriber->logfile, $offset);
+	like($contents, qr/DETAIL: ( [A-Z0-9]+:)? Key \(a\)=\($key\) already exists/,
+		"$msg: conflicting key is reported");
+	$contents =~
+	  qr/processing remote data for replication origin \"pg_\d+\" during message type "INSERT" for replication target relation "public.tab" in transaction \d+, finished at ([[:xdigit:]]+\/[[:xdigit:]]+)/
+	  or die "could not get error-LSN";
+
+	return $1;
+}
+
+# Create publisher node.  Set a low value of logical_decoding_work_mem so
+# that large transactions are streamed.
+my $node_publisher = PostgreSQL::Test::Cluster->new('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->append_conf('postgresql.conf',
+	'logical_decoding_work_mem = 64kB');
+$node_publisher->start;
+
+# Create subscriber node
+my $node_subscriber = PostgreSQL::Test::Cluster->new('subscriber');
+$node_subscriber->init;
+$node_subscriber->start;
+
+$node_publisher->safe_psql('postgres',
+	"CREATE TABLE tab (a int PRIMARY KEY, b text)");
+
+# On the subscriber, log every inserted row with an AFTER ROW trigger that
+# fires during replication too.
+$node_subscriber->safe_psql(
+	'postgres', qq[
+CREATE TABLE tab (a int PRIMARY KEY, b text);
+CREATE TABLE tab_log (seq bigserial, a int);
+CREATE FUNCTION tab_log_func() RETURNS trigger LANGUAGE plpgsql AS \$\$
+BEGIN
+  INSERT INTO tab_log (a) VALUES (NEW.a);
+  RETURN NULL;
+END;
+\$\$;
+CREATE TRIGGER tab_log_trig AFTER INSERT ON tab
+  FOR EACH ROW EXECUTE FUNCTION tab_log_func();
+ALTER TABLE tab ENABLE ALWAYS TRIGGER tab_log_trig;
+]);
+
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+$node_publisher->safe_psql('postgres', "CREATE PUBLICATION pub FOR TABLE tab");
+$node_subscriber->safe_psql('postgres',
+	"CREATE SUBSCRIPTION sub CONNECTION '$publisher_connstr' PUBLICATION pub WITH (disable_on_error = true, streaming = on)"
+);
+$node_subscriber->wait_for_subscription_sync($node_publisher, 'sub');
+
+# A transaction large enough to fill several batches.  The triggers must
+# have fired once per row, in insertion order.
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab SELECT g, 'row ' || g FROM generate_series(1, 2500) g");
+$node_publisher->wait_for_catchup('sub');
+
+my $result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), min(a), max(a) FROM tab");
+is($result, qq(2500|1|2500), 'batched inserts are applied');
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), bool_and(a = rn) FROM (SELECT a, row_number() OVER (ORDER BY seq) AS rn FROM tab_log) s"
+);
+is($result, qq(2500|t), 'AFTER ROW triggers fire once per row, in order');
+
+# Changes other than INSERT must see the rows batched before them.
+$node_publisher->safe_psql(
+	'postgres', qq[
+BEGIN;
+INSERT INTO tab SELECT g, 'row ' || g FROM generate_series(2501, 2510) g;
+UPDATE tab SET b = 'updated' WHERE a = 2505;
+INSERT INTO tab SELECT g, 'row ' || g FROM generate_series(2511, 2520) g;
+DELETE FROM tab WHERE a = 2515;
+COMMIT;
+]);
+$node_publisher->wait_for_catchup('sub');
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), count(*) FILTER (WHERE b = 'updated') FROM tab WHERE a > 2500"
+);
+is($result, qq(19|1), 'UPDATE and DELETE see the batched inserts before them');
+
+# A transaction that is streamed, and applied from the spool file at commit.
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab SELECT g, repeat('x', 100) FROM generate_series(10001, 15000) g"
+);
+$node_publisher->wait_for_catchup('sub');
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) FROM tab WHERE a > 10000");
+is($result, qq(5000), 'batched inserts from a streamed transaction are applied');
+
+# A unique violation in the middle of a batch.  The error must be reported
+# against the INSERT and the target relation, with the finish LSN that SKIP
+# needs, and nothing from the failed transaction may remain.
+$node_subscriber->safe_psql('postgres', "INSERT INTO tab VALUES (3005, 'local')");
+$offset = -s $node_subscriber->logfile;
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab SELECT g, 'row ' || g FROM generate_series(3001, 3010) g");
+
+my $lsn = wait_for_batch_error($node_subscriber, 3005, 'skip');
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) FROM tab WHERE a BETWEEN 3001 AND 3010");
+is($result, qq(1), 'failed batch leaves no rows behind');
+
+# Skipping the failed transaction works as before.
+$node_subscriber->safe_psql('postgres',
+	"ALTER SUBSCRIPTION sub SKIP (lsn = '$lsn')");
+$node_subscriber->safe_psql('postgres', "ALTER SUBSCRIPTION sub ENABLE");
+$node_subscriber->poll_query_until('postgres',
+	"SELECT subskiplsn = '0/0' FROM pg_subscription WHERE subname = 'sub'");
+$offset = $node_subscriber->wait_for_log(
+	qr/LOG: ( [A-Z0-9]+:)? logical replication completed skipping transaction at LSN $lsn/,
+	$offset);
+
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab SELECT g, 'row ' || g FROM generate_series(3011, 3012) g");
+$node_publisher->wait_for_catchup('sub');
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) FROM tab WHERE a BETWEEN 3001 AND 3012");
+is($result, qq(3), 'transaction with a failed batch is skipped');
+
+# Retrying after the conflict is resolved applies the whole transaction.
+$node_subscriber->safe_psql('postgres', "INSERT INTO tab VALUES (4005, 'local')");
+$node_publisher->safe_psql('postgres',
+	"INSERT INTO tab SELECT g, 'row ' || g FROM generate_series(4001, 4010) g");
+
+wait_for_batch_error($node_subscriber, 4005, 'retry');
+
+$node_subscriber->safe_psql('postgres', "DELETE FROM tab WHERE a = 4005");
+$node_subscriber->safe_psql('postgres', "ALTER SUBSCRIPTION sub ENABLE");
+$node_publisher->wait_for_catchup('sub');
+
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*), count(*) FILTER (WHERE b = 'local') FROM tab WHERE a BETWEEN 4001 AND 4010"
+);
+is($result, qq(10|0), 'transaction with a failed batch is applied on retry');
+
+# The triggers fired for the local row and for each applied row, but not
+# for anything that was rolled back.
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) FROM tab_log WHERE a BETWEEN 3001 AND 4010");
+is($result, qq(14), 'AFTER ROW triggers of failed batches are not kept');
+
+$node_subscriber->stop('fast');
+$node_publisher->stop('fast');
+
+done_testing();